@@ -679,6 +679,7 @@ Status DirectSession::RunInternal(
   args.run_all_kernels_inline = pool == nullptr;
   args.start_time_usecs = start_time_usecs;
   args.deadline = deadline;
+  args.use_step_arena = run_options.experimental().use_step_arena();
 
   const bool do_trace = (run_options.trace_level() > RunOptions::NO_TRACE);
 
@@ -1403,6 +1404,10 @@ Status DirectSession::CreateExecutors(
     params.device = device;
     params.session_metadata = session_metadata;
     params.function_library = lib;
+    params.use_static_memory_plan =
+        options_.config.experimental().use_static_memory_plan();
+    params.schedule_by_critical_path =
+        options_.config.experimental().schedule_by_critical_path();
     auto opseg = device->op_segment();
     params.create_kernel =
         [this, lib, opseg](const std::shared_ptr<const NodeProperties>& props,
@@ -1699,6 +1704,7 @@ Status DirectSession::CreateGraphs(
   };
   popts.flib_def = flib_def->get();
   popts.control_flow_added = false;
+  popts.assign_rendezvous_slots = true;
 
   std::unordered_map<string, GraphDef> partitions;
   TF_RETURN_IF_ERROR(Partition(popts, &client_graph->graph, &partitions));
@@ -795,6 +795,49 @@ TEST_F(DirectSessionMinusAXTest, UseRunHandlerPool) {
   EXPECT_FLOAT_EQ(5.0, mat(0, 0));
 }
 
+TEST(DirectSessionTest, UseStepArena) {
+  Graph graph(OpRegistry::Global());
+  Node* a;
+  TF_ASSERT_OK(NodeBuilder("a", "Placeholder")
+                   .Attr("shape", TensorShape({2, 2}))
+                   .Attr("dtype", DT_FLOAT)
+                   .Finalize(&graph, &a));
+  // `b` and `c` are only consumed within the step, and so are allocated from
+  // the step arena, unlike the fetched `d`.
+  Node* b = test::graph::Matmul(&graph, a, a, false, false);
+  Node* c = test::graph::Unary(&graph, "Neg", b);
+  Node* d = test::graph::Matmul(&graph, c, a, false, false);
+  GraphDef def;
+  graph.ToGraphDef(&def);
+
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def));
+
+  RunOptions run_options;
+  run_options.set_trace_level(RunOptions::SOFTWARE_TRACE);
+  run_options.mutable_experimental()->set_use_step_arena(true);
+  for (int i = 0; i < 2; ++i) {
+    RunMetadata run_metadata;
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run(
+        run_options,
+        {{"a:0", test::AsTensor<float>({1, 2, 3, 4}, TensorShape({2, 2}))}},
+        {d->name() + ":0"}, {}, &outputs, &run_metadata));
+    ASSERT_EQ(1, outputs.size());
+    test::ExpectTensorEqual<float>(
+        outputs[0],
+        test::AsTensor<float>({-37, -54, -81, -118}, TensorShape({2, 2})));
+
+    ASSERT_EQ(run_metadata.step_stats().dev_stats_size(), 1);
+    const StepArenaStats& arena_stats =
+        run_metadata.step_stats().dev_stats(0).step_arena_stats();
+    EXPECT_GT(arena_stats.num_allocations(), 0);
+    EXPECT_EQ(arena_stats.num_blocks(), 1);
+    EXPECT_EQ(arena_stats.num_escaped_blocks(), 0);
+  }
+}
+
 TEST(DirectSessionTest, KeepsStateAcrossRunsOfSession) {
   GraphDef def;
   Graph g(OpRegistry::Global());
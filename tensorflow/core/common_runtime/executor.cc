@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <atomic>
 #include <memory>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -35,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/propagator_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -152,9 +154,26 @@ class ExecutorImpl : public Executor {
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
     kernel_stats_.Initialize(immutable_state_.graph_view());
+    if (immutable_state_.params().schedule_by_critical_path) {
+      kernel_stats_.InitializeCriticalPaths(immutable_state_.graph_view());
+    }
     return OkStatus();
   }
 
+  // Returns the critical path length of every node, indexed by node id.
+  //
+  // REQUIRES: params().schedule_by_critical_path.
+  std::vector<uint64> CriticalPathLengths() const {
+    const GraphView& gview = immutable_state_.graph_view();
+    std::vector<uint64> lengths(gview.num_nodes(), 0);
+    for (int32_t i = 0; i < gview.num_nodes(); ++i) {
+      if (gview.node(i)) {
+        lengths[i] = kernel_stats_.CriticalPathLength(*gview.node(i));
+      }
+    }
+    return lengths;
+  }
+
  private:
   void RunAsyncInternal(const Args& args, DoneCallback done) override;
 
@@ -210,6 +229,86 @@ class ExecutorImpl : public Executor {
       cost_estimate.store(new_estimate, std::memory_order_relaxed);
     }
 
+    // Computes an order of the nodes in which every node comes before the
+    // destinations of its output edges, ignoring the back edges out of
+    // NextIteration nodes, and the initial critical path lengths.
+    void InitializeCriticalPaths(const GraphView& gview) {
+      const int32_t num_nodes = gview.num_nodes();
+      std::vector<int32> num_pending(num_nodes, 0);
+      auto for_each_successor = [&gview](const NodeItem& item, auto fn) {
+        if (item.is_next_iteration) return;
+        for (const EdgeInfo& e : item.output_edges()) fn(e.dst_id);
+        for (const ControlEdgeInfo& e : item.output_control_edges()) {
+          fn(e.dst_id);
+        }
+      };
+      for (int32_t i = 0; i < num_nodes; ++i) {
+        if (gview.node(i) == nullptr) continue;
+        for_each_successor(*gview.node(i), [&num_pending](int dst_id) {
+          ++num_pending[dst_id];
+        });
+      }
+      for (int32_t i = 0; i < num_nodes; ++i) {
+        if (gview.node(i) != nullptr && num_pending[i] == 0) {
+          topological_order_.push_back(i);
+        }
+      }
+      for (size_t i = 0; i < topological_order_.size(); ++i) {
+        for_each_successor(*gview.node(topological_order_[i]),
+                           [this, &num_pending](int dst_id) {
+                             if (--num_pending[dst_id] == 0) {
+                               topological_order_.push_back(dst_id);
+                             }
+                           });
+      }
+      critical_path_lengths_ =
+          std::make_unique<std::atomic_uint_fast64_t[]>(num_nodes);
+      UpdateCriticalPathLengths(gview);
+    }
+
+    // Recomputes, for every node, the sum of the cost estimates of the
+    // kernels with an expensive marker on the costliest path from the node
+    // to the end of the graph. Until their costs are measured, this is
+    // proportional to the number of such kernels on the path.
+    //
+    // REQUIRES: InitializeCriticalPaths() was called.
+    void UpdateCriticalPathLengths(const GraphView& gview) {
+      for (auto it = topological_order_.rbegin();
+           it != topological_order_.rend(); ++it) {
+        const NodeItem& item = *gview.node(*it);
+        uint64 successor_length = 0;
+        if (!item.is_next_iteration) {
+          for (const EdgeInfo& e : item.output_edges()) {
+            successor_length =
+                std::max<uint64>(successor_length,
+                                 critical_path_lengths_[e.dst_id].load(
+                                     std::memory_order_relaxed));
+          }
+          for (const ControlEdgeInfo& e : item.output_control_edges()) {
+            successor_length =
+                std::max<uint64>(successor_length,
+                                 critical_path_lengths_[e.dst_id].load(
+                                     std::memory_order_relaxed));
+          }
+        }
+        const uint64 cost =
+            is_expensive_[*it]
+                ? cost_estimates_[*it].load(std::memory_order_relaxed)
+                : 0;
+        critical_path_lengths_[*it].store(successor_length + cost,
+                                          std::memory_order_relaxed);
+      }
+    }
+
+    // Returns the estimated cost of the costliest path from the given node
+    // to the end of the graph, including the node itself.
+    //
+    // REQUIRES: InitializeCriticalPaths() was called.
+    uint64 CriticalPathLength(const NodeItem& node) const {
+      return critical_path_lengths_[node.node_id].load(
+          std::memory_order_relaxed);
+    }
+
    private:
     // Initial time (in CPU cycles) we expect an operation to take.  Used to
     // determine whether an operation should be place in a threadpool.
@@ -221,10 +320,19 @@ class ExecutorImpl : public Executor {
     std::vector<bool> is_expensive_;
     // std::unique_ptr<std::atomic<bool>[]> is_expensive_;
     std::unique_ptr<std::atomic_uint_fast64_t[]> cost_estimates_;
+
+    // Only initialized if the executor schedules by critical path.
+    std::vector<int32> topological_order_;
+    std::unique_ptr<std::atomic_uint_fast64_t[]> critical_path_lengths_;
   };
 
+  // The number of steps after which the critical path lengths are recomputed
+  // from the latest cost estimates.
+  static constexpr int64_t kCriticalPathUpdateInterval = 100;
+
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  std::atomic<int64_t> num_runs_{0};
 
   ExecutorImpl(const ExecutorImpl&) = delete;
   void operator=(const ExecutorImpl&) = delete;
@@ -397,6 +505,12 @@ class ExecutorState {
   Executor::Args::Runner runner_;
   bool sync_on_finish_;
   const bool run_all_kernels_inline_;
+  // True if ready nodes are dispatched in decreasing order of critical path
+  // length.
+  const bool schedule_by_critical_path_;
+  // Holds a reference if not null. Serves the temporaries of non-stateful
+  // kernels and the step-local outputs, and is reset when the step ends.
+  StepArenaAllocator* step_arena_ = nullptr;
 
   PropagatorStateType propagator_;
 
@@ -446,6 +560,10 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       runner_(args.runner),
       sync_on_finish_(args.sync_on_finish),
       run_all_kernels_inline_(args.run_all_kernels_inline),
+      // The ordered propagator fixes the order of the ready nodes.
+      schedule_by_critical_path_(
+          immutable_state.params().schedule_by_critical_path &&
+          !std::is_same<PropagatorStateType, OrderedPropagatorState>::value),
       propagator_(immutable_state, step_id_, vlog_),
       num_outstanding_ops_(0) {
   if (args.user_intra_op_threadpool != nullptr) {
@@ -453,6 +571,10 @@ ExecutorState<PropagatorStateType>::ExecutorState(
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  if (args.use_step_arena &&
+      immutable_state_.params().device->device_type() == DEVICE_CPU) {
+    step_arena_ = new StepArenaAllocator("step_arena");
+  }
 }
 
 template <class PropagatorStateType>
@@ -461,6 +583,16 @@ ExecutorState<PropagatorStateType>::~ExecutorState() {
     device_context_->Unref();
   }
   delete slice_reader_cache_;
+  if (step_arena_) {
+    step_arena_->Reset();
+    if (stats_collector_) {
+      StepArenaStats arena_stats;
+      step_arena_->GetStepArenaStats(&arena_stats);
+      stats_collector_->SaveStepArenaStats(
+          immutable_state_.params().device->name(), arena_stats);
+    }
+    step_arena_->Unref();
+  }
 }
 
 template <class PropagatorStateType>
@@ -914,6 +1046,8 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
       params->output_attr_array = item.output_attrs();
       params->forward_from_array = item.forward_from();
       params->outputs_required_array = item.outputs_required.get();
+      params->step_arena = item.is_stateful ? nullptr : step_arena_;
+      params->step_local_output_array = item.outputs_step_local.get();
       params->inputs = *inputs;
       params->input_alloc_attrs = input_alloc_attrs;
 
@@ -1278,6 +1412,18 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
     scheduled_nsec = nodestats::NowInNsec();
   }
 
+  if (schedule_by_critical_path_ && ready->size() > 1) {
+    // The batch of ready nodes is local to this thread, so it is sorted
+    // without synchronization.
+    std::stable_sort(ready->begin(), ready->end(),
+                     [this](const TaggedNode& a, const TaggedNode& b) {
+                       return kernel_stats_->CriticalPathLength(
+                                  a.get_node_item()) >
+                              kernel_stats_->CriticalPathLength(
+                                  b.get_node_item());
+                     });
+  }
+
   if (run_all_kernels_inline_) {
     if (inline_ready == nullptr) {
       // Schedule all ready kernels from a single closure. This ensure that,
@@ -1309,6 +1455,10 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
         if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
           // Inline this inexpensive node.
           inline_ready->push_back(tagged_node);
+        } else if (schedule_by_critical_path_ && curr_expensive_node) {
+          // Keep the first expensive node, which has the longest critical
+          // path, as the candidate to run inline.
+          expensive_nodes.push_back(tagged_node);
         } else {
           if (curr_expensive_node) {
             expensive_nodes.push_back(*curr_expensive_node);
@@ -1320,6 +1470,8 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
     if (curr_expensive_node) {
       if (inline_ready->empty()) {
         inline_ready->push_back(*curr_expensive_node);
+      } else if (schedule_by_critical_path_) {
+        expensive_nodes.insert(expensive_nodes.begin(), *curr_expensive_node);
       } else {
         // There are inline nodes to run already. We dispatch this expensive
         // node to other thread.
@@ -1508,6 +1660,12 @@ void ExecutorState<PropagatorStateType>::Finish() {
 }
 
 void ExecutorImpl::RunAsyncInternal(const Args& args, DoneCallback done) {
+  if (immutable_state_.params().schedule_by_critical_path &&
+      num_runs_.fetch_add(1, std::memory_order_relaxed) %
+              kCriticalPathUpdateInterval ==
+          kCriticalPathUpdateInterval - 1) {
+    kernel_stats_.UpdateCriticalPathLengths(immutable_state_.graph_view());
+  }
   if (OpOrderDeterminismRequired()) {
     (new ExecutorState<OrderedPropagatorState>(args, immutable_state_,
                                                &kernel_stats_))
@@ -1536,6 +1694,19 @@ Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
   return s;
 }
 
+Status CriticalPathLengthsForTest(const LocalExecutorParams& params,
+                                  const Graph& graph,
+                                  std::vector<uint64>* lengths) {
+  if (!params.schedule_by_critical_path) {
+    return errors::InvalidArgument(
+        "The executor does not schedule by critical path.");
+  }
+  ExecutorImpl impl(params);
+  TF_RETURN_IF_ERROR(impl.Initialize(graph));
+  *lengths = impl.CriticalPathLengths();
+  return OkStatus();
+}
+
 Status CreateNonCachedKernel(Device* device, FunctionLibraryRuntime* flib,
                              const std::shared_ptr<const NodeProperties>& props,
                              int graph_def_version, OpKernel** kernel) {
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_EXECUTOR_H_
 
 #include <optional>
+#include <vector>
 
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
@@ -124,6 +125,11 @@ class Executor {
     // If true, all kernels will be treated as "inexpensive", and hence executed
     // on the scheduling thread.
     bool run_all_kernels_inline = false;
+
+    // If true and the device is a CPU, allocates the temporaries of
+    // non-stateful kernels and the step-local outputs from a per-step arena.
+    // See `StepArenaAllocator`.
+    bool use_step_arena = false;
   };
   typedef std::function<void(const Status&)> DoneCallback;
 
@@ -160,6 +166,13 @@ class Executor {
 ::tensorflow::Status NewLocalExecutor(const LocalExecutorParams& params,
                                       const Graph& graph, Executor** executor);
 
+// Returns in "*lengths", indexed by node id, the critical path lengths that an
+// executor created from "params", which must schedule by critical path,
+// computes for "graph" before running any kernel. Exposed for testing.
+::tensorflow::Status CriticalPathLengthsForTest(
+    const LocalExecutorParams& params, const Graph& graph,
+    std::vector<uint64>* lengths);
+
 // A class to help run multiple executors in parallel and wait until
 // all of them are complete.
 //
@@ -77,11 +77,11 @@ class ExecutorTest : public ::testing::Test {
     delete exec_;
   }
 
-  // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
-    const int version = graph->versions().producer();
+  // Returns the parameters of an executor running a graph of 'version'.
+  LocalExecutorParams Params(int version) {
     LocalExecutorParams params;
     params.device = device_.get();
+    params.schedule_by_critical_path = schedule_by_critical_path_;
     params.create_kernel =
         [this, version](const std::shared_ptr<const NodeProperties>& props,
                         OpKernel** kernel) {
@@ -91,9 +91,15 @@ class ExecutorTest : public ::testing::Test {
     params.delete_kernel = [](OpKernel* kernel) {
       DeleteNonCachedKernel(kernel);
     };
+    return params;
+  }
+
+  // Resets executor_ with a new executor based on a graph 'gdef'.
+  void Create(std::unique_ptr<const Graph> graph) {
     rendez_ = NewLocalRendezvous();
     delete exec_;
-    TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    TF_CHECK_OK(
+        NewLocalExecutor(Params(graph->versions().producer()), *graph, &exec_));
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
   }
 
@@ -106,6 +112,7 @@ class ExecutorTest : public ::testing::Test {
   }
 
   thread::ThreadPool* thread_pool_ = nullptr;
+  bool schedule_by_critical_path_ = false;
   std::unique_ptr<Device> device_;
   Executor* exec_ = nullptr;
   StepStatsCollector step_stats_collector_;
@@ -266,6 +273,73 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeScheduledByCriticalPath) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(256, g.get());
+  schedule_by_critical_path_ = true;
+  Create(std::move(g));
+  // Runs past the first recomputation of the critical paths from the
+  // measured kernel costs.
+  for (int step = 0; step <= 100; ++step) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               V(step), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(256.0 * step, V(out));
+  }
+}
+
+TEST_F(ExecutorTest, DispatchesLongestCriticalPathFirst) {
+  // c -> a1 -> a2 -> a3
+  //   \-> b1
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto c = test::graph::Constant(g.get(), V(1.0));
+  auto a1 = test::graph::Unary(g.get(), "Neg", c);
+  auto a2 = test::graph::Unary(g.get(), "Neg", a1);
+  auto a3 = test::graph::Unary(g.get(), "Neg", a2);
+  auto b1 = test::graph::Unary(g.get(), "Neg", c);
+  schedule_by_critical_path_ = true;
+
+  // Until their costs are measured, all the kernels with an expensive marker
+  // count the same, and the constant counts for nothing.
+  std::vector<uint64> lengths;
+  TF_ASSERT_OK(CriticalPathLengthsForTest(Params(g->versions().producer()),
+                                          *g, &lengths));
+  const uint64 unit = lengths[a3->id()];
+  EXPECT_GT(unit, 0);
+  EXPECT_EQ(lengths[b1->id()], unit);
+  EXPECT_EQ(lengths[a2->id()], 2 * unit);
+  EXPECT_EQ(lengths[a1->id()], 3 * unit);
+  EXPECT_EQ(lengths[c->id()], 3 * unit);
+
+  const std::vector<string> branch_nodes = {a1->name(), a2->name(),
+                                            a3->name(), b1->name()};
+  Create(std::move(g));
+  // A single thread runs the kernels one at a time, in the order in which
+  // they are dispatched.
+  thread::ThreadPool pool(Env::Default(), "dispatch", 1);
+  runner_ = [&pool](std::function<void()> fn) { pool.Schedule(std::move(fn)); };
+  TF_ASSERT_OK(Run(rendez_));
+  step_stats_collector_.Finalize();
+
+  std::vector<string> order;
+  for (const DeviceStepStats& dev_stats : step_stats_.dev_stats()) {
+    for (const NodeExecStats& node_stats : dev_stats.node_stats()) {
+      if (std::find(branch_nodes.begin(), branch_nodes.end(),
+                    node_stats.node_name()) != branch_nodes.end()) {
+        order.push_back(node_stats.node_name());
+      }
+    }
+  }
+  // The expensive a1 and b1 become ready together: a1, at the head of the
+  // longest path, runs inline, and b1 only once the a-chain is done.
+  EXPECT_EQ(order, branch_nodes);
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
@@ -400,6 +401,13 @@ Allocator* GPUProcessState::GetGpuHostAllocator(const GPUOptions& options,
     tsl::BFCAllocator::Options allocator_opts;
     allocator_opts.allow_growth =
         !options.experimental().gpu_host_mem_disallow_growth();
+    int64_t cpu_cache_bytes = 0;
+    Status cache_status = tsl::ReadInt64FromEnvVar(
+        "TF_GPU_HOST_BFC_CPU_CACHE_BYTES", 0, &cpu_cache_bytes);
+    if (!cache_status.ok()) {
+      LOG(ERROR) << "GetGpuHostAllocator: " << cache_status.message();
+    }
+    allocator_opts.cpu_cache_bytes = std::max<int64_t>(cpu_cache_bytes, 0);
     tsl::Allocator* allocator =
         new tsl::BFCAllocator(absl::WrapUnique(sub_allocator), mem_limit_bytes,
                               /*name=*/"gpu_host_bfc", allocator_opts);
@@ -85,6 +85,7 @@ struct NodeItem {
                                     // node's input types.
   bool is_distributed_communication : 1;  // True iff the op is registered to
                                           // use distributed communication.
+  bool is_stateful : 1;  // True iff node->op_def().is_stateful()
 
   // The kernel for this node.
   OpKernel* kernel = nullptr;
@@ -111,6 +112,11 @@ struct NodeItem {
   // is true if and only if the ith output is consumed by another node.
   std::unique_ptr<bool[]> outputs_required;
 
+  // If non-null, contains an array of num_outputs bools, where the ith bool
+  // is true if and only if the ith output is only consumed by non-stateful
+  // kernels within the step, and so may be allocated from the step arena.
+  std::unique_ptr<bool[]> outputs_step_local;
+
   gtl::MutableArraySlice<EdgeInfo> mutable_output_edges() {
     return gtl::MutableArraySlice<EdgeInfo>(output_edge_base(),
                                             num_output_edges);
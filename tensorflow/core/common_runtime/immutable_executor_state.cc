@@ -15,7 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 
+#include <algorithm>
+
 #include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/step_local_outputs.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
@@ -196,6 +199,7 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
     item->is_recv_or_switch = IsRecv(n) || IsSwitch(n);
     item->is_next_iteration = IsNextIteration(n);
     item->is_distributed_communication = IsDistributedCommunication(n);
+    item->is_stateful = n->op_def().is_stateful();
 
     // Compute the maximum values we'll store for this node in the
     // pending counts data structure, and allocate a handle in
@@ -256,6 +260,8 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
     }
   }
 
+  InitializeStepLocalOutputs(graph);
+
   // Initialize PendingCounts only after pending_ids_[node.id] is initialized
   // for all nodes.
   InitializePending(&graph, cf_info);
@@ -350,6 +356,26 @@ Status ImmutableExecutorState::BuildControlFlowInfo(const Graph* g,
   return OkStatus();
 }
 
+void ImmutableExecutorState::InitializeStepLocalOutputs(const Graph& graph) {
+  // Kernels may still forward a step-local input buffer to an escaping
+  // output, in which case the arena block holding it is freed with the
+  // forwarded tensor rather than at the end of the step.
+  const std::vector<std::vector<bool>> step_local = FindStepLocalOutputs(graph);
+  for (const Node* n : graph.nodes()) {
+    if (IsSink(n)) continue;
+    const std::vector<bool>& node_step_local = step_local[n->id()];
+    if (std::find(node_step_local.begin(), node_step_local.end(), true) ==
+        node_step_local.end()) {
+      continue;
+    }
+    NodeItem* item = gview_.node(n->id());
+    item->outputs_step_local.reset(new bool[n->num_outputs()]);
+    for (int i = 0; i < n->num_outputs(); ++i) {
+      item->outputs_step_local[i] = node_step_local[i];
+    }
+  }
+}
+
 void ImmutableExecutorState::InitializePending(const Graph* graph,
                                                const ControlFlowInfo& cf_info) {
   for (auto& it : cf_info.unique_frame_names) {
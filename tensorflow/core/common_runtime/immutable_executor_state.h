@@ -125,6 +125,10 @@ class ImmutableExecutorState {
   static Status BuildControlFlowInfo(const Graph* graph,
                                      ControlFlowInfo* cf_info);
   void InitializePending(const Graph* graph, const ControlFlowInfo& cf_info);
+  // Sets `NodeItem::outputs_step_local` for the outputs of non-stateful nodes
+  // that only reach non-stateful kernels, directly or through nodes that
+  // alias their inputs (e.g. Identity or Reshape).
+  void InitializeStepLocalOutputs(const Graph& graph);
 
   FrameInfo* EnsureFrameInfo(const string& fname);
 
@@ -50,6 +50,15 @@ struct LocalExecutorParams {
 
   // Whether control flow nodes are allowed to be executed synchronously.
   bool allow_control_flow_sync_execution = false;
+
+  // Whether the executor may place kernel outputs in memory planned ahead of
+  // the step. Only supported by the single-threaded executor on CPU.
+  bool use_static_memory_plan = false;
+
+  // Whether the executor dispatches ready nodes in decreasing order of the
+  // estimated cost of their longest path to the end of the graph. Only
+  // supported by the default executor.
+  bool schedule_by_critical_path = false;
 };
 
 }  // end namespace tensorflow
@@ -66,6 +66,7 @@ Status PartitionFunctionGraph(
     }
   };
   partition_options.control_flow_added = false;
+  partition_options.assign_rendezvous_slots = true;
   partition_options.get_tensor_name_attr = get_tensor_name_attr;
 
   return Partition(partition_options, graph, partitions);
@@ -15,18 +15,26 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/single_threaded_executor.h"
 
+#include <algorithm>
+#include <memory>
 #include <utility>
 
 #include "tensorflow/core/common_runtime/entry.h"
 #include "tensorflow/core/common_runtime/executor.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+#include "tensorflow/core/common_runtime/step_local_outputs.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 
@@ -64,6 +72,7 @@ namespace {
 
 typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
 typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
+typedef gtl::InlinedVector<Allocator*, 4> AllocatorVec;
 
 static const string& kSingleThreadedExecutor =
     *new string("SINGLE_THREADED_EXECUTOR");
@@ -80,6 +89,9 @@ class SingleThreadedExecutorImpl : public Executor {
     for (const ConstTensorKernelState& kernel_state : const_tensor_kernels_) {
       params_.delete_kernel(kernel_state.kernel);
     }
+    for (StaticMemoryArena* arena : free_memory_arenas_) {
+      arena->Unref();
+    }
   }
 
   Status Initialize(const Graph& graph) {
@@ -251,10 +263,26 @@ class SingleThreadedExecutorImpl : public Executor {
     } else {
       total_num_inputs_ = 0;
     }
+
+    if (params_.use_static_memory_plan &&
+        params_.device->device_type() == DEVICE_CPU) {
+      InitializeMemoryPlanning(graph, nodes_with_kernels, node_to_index_map);
+    }
     return OkStatus();
   }
 
   Status Run(const Args& args) override {
+    // Declared before `inputs`, so that the step's tensors are released before
+    // the arena.
+    bool step_succeeded = false;
+    StaticMemoryArena* memory_arena = AcquireMemoryArena();
+    auto memory_arena_cleanup =
+        gtl::MakeCleanup([this, memory_arena, &step_succeeded] {
+          if (memory_arena != nullptr) {
+            ReleaseMemoryArena(memory_arena, step_succeeded);
+          }
+        });
+
     // The inputs to each kernel are stored contiguously in `inputs`.
     //
     // We use `kernels_[i].input_start_index` and `kernels_[i].num_inputs` to
@@ -294,6 +322,7 @@ class SingleThreadedExecutorImpl : public Executor {
     // OpKernelContext to take the TensorValueVec as a pointer into `inputs`.
     TensorValueVec node_inputs;
     AllocatorAttributeVec input_alloc_attrs;
+    AllocatorVec output_allocators;
 
     // Override intra op thread pool if requested.
     Device* device = params_.device;
@@ -439,6 +468,18 @@ class SingleThreadedExecutorImpl : public Executor {
       params.input_alloc_attrs = input_alloc_attrs;
       params.op_kernel = kernel_state.kernel;
       params.output_attr_array = kernel_state.output_alloc_attrs.data();
+      params.planned_output_allocator_array = nullptr;
+      if (memory_arena != nullptr && !kernel_state.planned_outputs.empty()) {
+        output_allocators.clear();
+        output_allocators.resize(num_outputs, nullptr);
+        for (size_t j = 0; j < num_outputs; ++j) {
+          if (kernel_state.planned_outputs[j] >= 0) {
+            output_allocators[j] =
+                memory_arena->allocator(kernel_state.planned_outputs[j]);
+          }
+        }
+        params.planned_output_allocator_array = output_allocators.data();
+      }
       OpKernelContext ctx(&params, num_outputs);
 
       // Actually execute the kernel.
@@ -481,6 +522,7 @@ class SingleThreadedExecutorImpl : public Executor {
         delete val.tensor;
       }
     }
+    step_succeeded = true;
     return OkStatus();
   }
 
@@ -494,6 +536,81 @@ class SingleThreadedExecutorImpl : public Executor {
     args.runner([this, args, done]() { done(Run(args)); });
   }
 
+  // Selects the kernel outputs that may be placed by a static memory plan,
+  // namely those that are not expected to outlive the step, and computes their
+  // lifetimes in the kernel order. A tensor is live from the kernel that
+  // produces it until the last kernel that consumes it has run.
+  void InitializeMemoryPlanning(
+      const Graph& graph, const std::vector<Node*>& nodes_with_kernels,
+      const absl::flat_hash_map<Node*, size_t>& node_to_index_map) {
+    const std::vector<std::vector<bool>> step_local =
+        FindStepLocalOutputs(graph);
+    for (size_t i = 0; i < kernels_.size(); ++i) {
+      const Node* n = nodes_with_kernels[i];
+      KernelState& kernel_state = kernels_[i];
+      for (size_t j = 0; j < kernel_state.num_outputs; ++j) {
+        if (!step_local[n->id()][j]) continue;
+        if (kernel_state.planned_outputs.empty()) {
+          kernel_state.planned_outputs.resize(kernel_state.num_outputs, -1);
+        }
+        kernel_state.planned_outputs[j] = planned_tensors_.size();
+        StaticMemoryPlan::TensorLifetime lifetime;
+        lifetime.first_use = i;
+        lifetime.last_use = i;
+        planned_tensors_.push_back(lifetime);
+      }
+      if (kernel_state.planned_outputs.empty()) continue;
+      for (const Edge* e : n->out_edges()) {
+        if (e->IsControlEdge()) continue;
+        const int planned_index = kernel_state.planned_outputs[e->src_output()];
+        if (planned_index < 0) continue;
+        StaticMemoryPlan::TensorLifetime& lifetime =
+            planned_tensors_[planned_index];
+        lifetime.last_use =
+            std::max<int>(lifetime.last_use, node_to_index_map.at(e->dst()));
+      }
+    }
+  }
+
+  // Returns the arena to allocate planned outputs from in a step, or nullptr
+  // if memory planning is disabled. Until a plan is built, the arena only
+  // records the sizes of the outputs.
+  StaticMemoryArena* AcquireMemoryArena() {
+    if (planned_tensors_.empty()) return nullptr;
+    mutex_lock l(memory_plan_mu_);
+    if (!free_memory_arenas_.empty()) {
+      StaticMemoryArena* arena = free_memory_arenas_.back();
+      free_memory_arenas_.pop_back();
+      return arena;
+    }
+    return new StaticMemoryArena(
+        memory_plan_, planned_tensors_.size(),
+        params_.device->GetAllocator(AllocatorAttributes()));
+  }
+
+  // Builds the memory plan from the sizes recorded in `arena` after the first
+  // successful step, and keeps `arena` for later steps if no tensor allocated
+  // from it is alive.
+  void ReleaseMemoryArena(StaticMemoryArena* arena, bool step_succeeded) {
+    mutex_lock l(memory_plan_mu_);
+    if (memory_plan_ == nullptr && step_succeeded) {
+      std::vector<StaticMemoryPlan::TensorLifetime> tensors = planned_tensors_;
+      for (size_t i = 0; i < tensors.size(); ++i) {
+        tensors[i].size = arena->requested_size(i);
+      }
+      memory_plan_ =
+          std::make_shared<const StaticMemoryPlan>(std::move(tensors));
+      VLOG(1) << "Planned " << memory_plan_->buffer_size() << " bytes for "
+              << planned_tensors_.size() << " outputs on "
+              << params_.device->name();
+    }
+    if (arena->plan() != nullptr && arena->RefCountIsOne()) {
+      free_memory_arenas_.push_back(arena);
+    } else {
+      arena->Unref();
+    }
+  }
+
   const LocalExecutorParams params_;
 
   // All following members are read-only after Initialize().
@@ -527,6 +644,10 @@ class SingleThreadedExecutorImpl : public Executor {
     // Memory space information for each output of `kernel`.
     std::vector<AllocatorAttributes>
         output_alloc_attrs;  // Length = `num_outputs`.
+
+    // For the `j`th output of `kernel`, the index of its tensor in the static
+    // memory plan, or -1. Empty if no output of `kernel` is planned.
+    std::vector<int> planned_outputs;  // Length = `num_outputs` or 0.
   };
   std::vector<KernelState> kernels_;
 
@@ -567,6 +688,19 @@ class SingleThreadedExecutorImpl : public Executor {
   // `RunAsync()` for details.
   std::vector<AllocatorAttributes>
       input_alloc_attrs_;  // Length = `total_num_inputs_`.
+
+  // The lifetimes of the tensors in the static memory plan, without their
+  // sizes. Empty if memory planning is disabled.
+  std::vector<StaticMemoryPlan::TensorLifetime> planned_tensors_;
+
+  mutex memory_plan_mu_;
+  // Built at the end of the first successful step, from the sizes of the
+  // outputs allocated in it.
+  std::shared_ptr<const StaticMemoryPlan> memory_plan_
+      TF_GUARDED_BY(memory_plan_mu_);
+  // Arenas for `memory_plan_` that are not used by any step.
+  std::vector<StaticMemoryArena*> free_memory_arenas_
+      TF_GUARDED_BY(memory_plan_mu_);
 };
 
 class SingleThreadedExecutorRegistrar {
@@ -17,6 +17,7 @@ limitations under the License.
 #include <functional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "tensorflow/core/common_runtime/device.h"
@@ -90,6 +91,7 @@ class ExecutorTest : public ::testing::Test {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
+    params.use_static_memory_plan = use_static_memory_plan_;
     params.create_kernel =
         [this, mock_fn = std::move(mock_fn), version](
             const std::shared_ptr<const NodeProperties>& props,
@@ -152,6 +154,7 @@ class ExecutorTest : public ::testing::Test {
   }
 
   std::unique_ptr<Device> device_;
+  bool use_static_memory_plan_ = false;
   std::unique_ptr<Executor> exec_ = nullptr;
   Executor::Args::Runner runner_;
   Rendezvous* rendez_ = nullptr;
@@ -277,6 +280,40 @@ TEST_F(ExecutorTest, SelfAdd) {
   EXPECT_EQ(1024.0, V(retvals[0]));  // b=v10=2*v9=4*v8=...=1024*a=1024.0
 }
 
+TEST_F(ExecutorTest, StaticMemoryPlan) {
+  // v1 = a + a, v2 = v1 + v1, ..., v10 = v9 + v9, so that v9 can reuse the
+  // memory of v7, and so on.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto v = test::graph::Arg(g.get(), 0, DT_FLOAT);
+  for (int i = 1; i <= 10; ++i) {
+    v = test::graph::Add(g.get(), v, v);
+  }
+  test::graph::Retval(g.get(), 0, v);
+  FixupSourceAndSinkEdges(g.get());
+  use_static_memory_plan_ = true;
+  Create(std::move(g));
+
+  // The first step records the sizes of the outputs. The others allocate
+  // them from the plan, except for the step in which they are larger than
+  // planned.
+  const std::vector<int64_t> sizes = {16, 16, 64, 16};
+  for (int step = 0; step < sizes.size(); ++step) {
+    Tensor a(DT_FLOAT, TensorShape({sizes[step]}));
+    for (int64_t i = 0; i < sizes[step]; ++i) {
+      a.flat<float>()(i) = step + i;
+    }
+    FunctionCallFrame call_frame({DT_FLOAT}, {DT_FLOAT});
+    TF_ASSERT_OK(call_frame.SetArgs({a}));
+    TF_ASSERT_OK(Run(&call_frame));
+    std::vector<Tensor> retvals;
+    TF_ASSERT_OK(call_frame.ConsumeRetvals(&retvals, false));
+    ASSERT_EQ(retvals[0].NumElements(), sizes[step]);
+    for (int64_t i = 0; i < sizes[step]; ++i) {
+      EXPECT_EQ(retvals[0].flat<float>()(i), 1024.0f * (step + i));
+    }
+  }
+}
+
 // Builds a graph which adds N copies of one variable "in". I.e.,
 //     a + a + a + ... + a
 // The returned graph is parenthesized ramdonly. I.e.,
@@ -0,0 +1,166 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
+
+namespace tensorflow {
+
+namespace {
+
+constexpr size_t RoundUp(size_t n, size_t multiple) {
+  return (n + multiple - 1) / multiple * multiple;
+}
+
+bool LifetimesOverlap(const StaticMemoryPlan::TensorLifetime& a,
+                      const StaticMemoryPlan::TensorLifetime& b) {
+  return a.first_use <= b.last_use && b.first_use <= a.last_use;
+}
+
+}  // namespace
+
+StaticMemoryPlan::StaticMemoryPlan(std::vector<TensorLifetime> tensors)
+    : tensors_(std::move(tensors)),
+      offsets_(tensors_.size(), 0),
+      predecessors_(tensors_.size()) {
+  std::vector<int> order;
+  for (int i = 0; i < num_tensors(); ++i) {
+    if (tensors_[i].size > 0) order.push_back(i);
+  }
+  std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+    return tensors_[a].size > tensors_[b].size;
+  });
+
+  auto end_offset = [this](int i) {
+    return offsets_[i] +
+           RoundUp(tensors_[i].size, Allocator::kAllocatorAlignment);
+  };
+  // The tensors placed so far, in increasing order of offset.
+  std::vector<int> placed;
+  for (int i : order) {
+    const size_t size =
+        RoundUp(tensors_[i].size, Allocator::kAllocatorAlignment);
+    size_t best_offset = std::numeric_limits<size_t>::max();
+    size_t best_gap = std::numeric_limits<size_t>::max();
+    size_t current_offset = 0;
+    for (int j : placed) {
+      if (!LifetimesOverlap(tensors_[i], tensors_[j])) continue;
+      if (current_offset + size <= offsets_[j]) {
+        const size_t gap = offsets_[j] - current_offset;
+        if (gap < best_gap) {
+          best_offset = current_offset;
+          best_gap = gap;
+        }
+      }
+      current_offset = std::max(current_offset, end_offset(j));
+    }
+    if (best_offset == std::numeric_limits<size_t>::max()) {
+      best_offset = current_offset;
+    }
+    offsets_[i] = best_offset;
+    buffer_size_ = std::max(buffer_size_, best_offset + size);
+    placed.insert(std::upper_bound(placed.begin(), placed.end(), i,
+                                   [this](int a, int b) {
+                                     return offsets_[a] < offsets_[b];
+                                   }),
+                  i);
+  }
+
+  for (int i : placed) {
+    for (int j : placed) {
+      if (tensors_[j].last_use < tensors_[i].first_use &&
+          offsets_[j] < end_offset(i) && offsets_[i] < end_offset(j)) {
+        predecessors_[i].push_back(j);
+      }
+    }
+  }
+}
+
+StaticMemoryArena::StaticMemoryArena(
+    std::shared_ptr<const StaticMemoryPlan> plan, int num_tensors,
+    Allocator* fallback)
+    : plan_(std::move(plan)),
+      fallback_(fallback),
+      slots_(new Slot[num_tensors]) {
+  DCHECK(plan_ == nullptr || plan_->num_tensors() == num_tensors);
+  for (int i = 0; i < num_tensors; ++i) {
+    slots_[i].arena = this;
+    slots_[i].index = i;
+  }
+  if (plan_ != nullptr && plan_->buffer_size() > 0) {
+    buffer_ = static_cast<char*>(port::AlignedMalloc(
+        plan_->buffer_size(), Allocator::kAllocatorAlignment));
+    if (buffer_ == nullptr) {
+      LOG(WARNING) << "Failed to allocate " << plan_->buffer_size()
+                   << " bytes for a static memory plan.";
+    }
+  }
+}
+
+StaticMemoryArena::~StaticMemoryArena() {
+  if (buffer_ != nullptr) port::AlignedFree(buffer_);
+}
+
+void* StaticMemoryArena::Allocate(int i, size_t alignment, size_t num_bytes) {
+  Slot& slot = slots_[i];
+  size_t requested_size = slot.requested_size.load(std::memory_order_relaxed);
+  while (requested_size < num_bytes &&
+         !slot.requested_size.compare_exchange_weak(
+             requested_size, num_bytes, std::memory_order_relaxed)) {
+  }
+
+  if (buffer_ != nullptr && num_bytes > 0 &&
+      num_bytes <= plan_->tensor(i).size &&
+      alignment <= Allocator::kAllocatorAlignment) {
+    bool predecessors_freed = true;
+    for (int j : plan_->predecessors(i)) {
+      if (slots_[j].in_use.load(std::memory_order_acquire)) {
+        predecessors_freed = false;
+        break;
+      }
+    }
+    if (predecessors_freed &&
+        !slot.in_use.exchange(true, std::memory_order_acq_rel)) {
+      Ref();
+      num_planned_allocations_.fetch_add(1, std::memory_order_relaxed);
+      return buffer_ + plan_->offset(i);
+    }
+  }
+
+  void* ptr = fallback_->AllocateRaw(alignment, num_bytes);
+  if (ptr != nullptr) {
+    Ref();
+    num_fallback_allocations_.fetch_add(1, std::memory_order_relaxed);
+  }
+  return ptr;
+}
+
+void StaticMemoryArena::Deallocate(int i, void* ptr) {
+  if (buffer_ != nullptr && ptr == buffer_ + plan_->offset(i) &&
+      plan_->tensor(i).size > 0) {
+    slots_[i].in_use.store(false, std::memory_order_release);
+  } else {
+    fallback_->DeallocateRaw(ptr);
+  }
+  // May delete `this`.
+  Unref();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,154 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/macros.h"
+
+namespace tensorflow {
+
+// Assigns every tensor produced by a fixed schedule of kernels an offset in a
+// single buffer, such that tensors whose lifetimes overlap do not overlap in
+// memory.
+//
+// Tensors are placed greedily in decreasing order of size, as in TFLite's
+// ArenaPlanner: each one goes into the smallest gap that fits it between the
+// already placed tensors whose lifetimes overlap its own, or after all of
+// them.
+class StaticMemoryPlan {
+ public:
+  // A tensor to place. It is live from the kernel at position `first_use` of
+  // the schedule through the one at position `last_use`, inclusive. Tensors
+  // of size zero are not placed.
+  struct TensorLifetime {
+    size_t size = 0;
+    int first_use = 0;
+    int last_use = 0;
+  };
+
+  explicit StaticMemoryPlan(std::vector<TensorLifetime> tensors);
+
+  int num_tensors() const { return tensors_.size(); }
+  const TensorLifetime& tensor(int i) const { return tensors_[i]; }
+
+  // The offset of tensor `i` in the buffer, which is a multiple of
+  // `Allocator::kAllocatorAlignment`.
+  size_t offset(int i) const { return offsets_[i]; }
+
+  // The tensors that die before tensor `i` is produced and whose memory
+  // overlaps its own. Tensor `i` may only be placed at its offset once none
+  // of them is referenced anymore.
+  const std::vector<int>& predecessors(int i) const {
+    return predecessors_[i];
+  }
+
+  // The size of the buffer.
+  size_t buffer_size() const { return buffer_size_; }
+
+ private:
+  const std::vector<TensorLifetime> tensors_;
+  std::vector<size_t> offsets_;
+  std::vector<std::vector<int>> predecessors_;
+  size_t buffer_size_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticMemoryPlan);
+};
+
+// The memory of one step executed with a `StaticMemoryPlan`. The executor
+// passes `allocator(i)` to the kernel that produces tensor `i`.
+//
+// That allocator returns the planned location of the tensor when the request
+// fits in the planned size and none of the tensor's predecessors in the plan
+// is still allocated, e.g. because a kernel forwarded its buffer to a tensor
+// that lives longer than planned. Otherwise, including when the arena was
+// created without a plan, it falls back to the given allocator. It also
+// records the size of the largest request, from which the executor builds
+// its plan.
+//
+// Every allocation holds a reference on the arena, so a tensor that outlives
+// the step keeps the buffer alive. The executor may reuse the arena for
+// another step once it holds the only reference.
+class StaticMemoryArena : public core::RefCounted {
+ public:
+  // `fallback` must outlive the arena. If `plan` is null, all requests
+  // fall back.
+  StaticMemoryArena(std::shared_ptr<const StaticMemoryPlan> plan,
+                    int num_tensors, Allocator* fallback);
+
+  const StaticMemoryPlan* plan() const { return plan_.get(); }
+
+  Allocator* allocator(int i) { return &slots_[i]; }
+
+  // The size of the largest request for tensor `i` that was made to this
+  // arena.
+  size_t requested_size(int i) const {
+    return slots_[i].requested_size.load(std::memory_order_relaxed);
+  }
+
+  // The number of requests that were served from the buffer, and that fell
+  // back, respectively.
+  int64_t num_planned_allocations() const {
+    return num_planned_allocations_.load(std::memory_order_relaxed);
+  }
+  int64_t num_fallback_allocations() const {
+    return num_fallback_allocations_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  class Slot : public Allocator {
+   public:
+    std::string Name() override { return "static_memory_arena"; }
+    void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+      return arena->Allocate(index, alignment, num_bytes);
+    }
+    void DeallocateRaw(void* ptr) override { arena->Deallocate(index, ptr); }
+    AllocatorMemoryType GetMemoryType() const override {
+      return arena->fallback_->GetMemoryType();
+    }
+
+    StaticMemoryArena* arena = nullptr;
+    int index = 0;
+    // True while the planned location of the tensor is allocated.
+    std::atomic<bool> in_use{false};
+    std::atomic<size_t> requested_size{0};
+  };
+
+  ~StaticMemoryArena() override;
+
+  void* Allocate(int i, size_t alignment, size_t num_bytes);
+  void Deallocate(int i, void* ptr);
+
+  const std::shared_ptr<const StaticMemoryPlan> plan_;
+  Allocator* const fallback_;
+  // Null if there is no plan or the buffer could not be allocated.
+  char* buffer_ = nullptr;
+  std::unique_ptr<Slot[]> slots_;
+
+  std::atomic<int64_t> num_planned_allocations_{0};
+  std::atomic<int64_t> num_fallback_allocations_{0};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticMemoryArena);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
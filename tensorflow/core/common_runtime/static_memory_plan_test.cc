@@ -0,0 +1,170 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+StaticMemoryPlan::TensorLifetime Lifetime(size_t size, int first_use,
+                                          int last_use) {
+  StaticMemoryPlan::TensorLifetime lifetime;
+  lifetime.size = size;
+  lifetime.first_use = first_use;
+  lifetime.last_use = last_use;
+  return lifetime;
+}
+
+TEST(StaticMemoryPlanTest, ReusesMemoryOfDeadTensors) {
+  // A chain in which each tensor is consumed by the next kernel.
+  StaticMemoryPlan plan({Lifetime(1000, 0, 1), Lifetime(500, 1, 2),
+                         Lifetime(1000, 2, 3), Lifetime(200, 3, 3)});
+  EXPECT_EQ(plan.offset(0), 0);
+  EXPECT_EQ(plan.offset(2), 0);
+  EXPECT_EQ(plan.offset(1), 1024);
+  // Fits in the memory of tensor 1, which is dead by then.
+  EXPECT_EQ(plan.offset(3), 1024);
+  EXPECT_EQ(plan.buffer_size(), 1536);
+
+  EXPECT_TRUE(plan.predecessors(0).empty());
+  EXPECT_TRUE(plan.predecessors(1).empty());
+  EXPECT_EQ(plan.predecessors(2), std::vector<int>({0}));
+  EXPECT_EQ(plan.predecessors(3), std::vector<int>({1}));
+}
+
+TEST(StaticMemoryPlanTest, PlacesOverlappingLifetimesApart) {
+  StaticMemoryPlan plan(
+      {Lifetime(100, 0, 2), Lifetime(300, 1, 2), Lifetime(200, 2, 2)});
+  EXPECT_EQ(plan.offset(1), 0);
+  EXPECT_EQ(plan.offset(2), 320);
+  EXPECT_EQ(plan.offset(0), 576);
+  EXPECT_EQ(plan.buffer_size(), 704);
+}
+
+TEST(StaticMemoryPlanTest, PicksTheSmallestGap) {
+  // Tensors 0 and 1 die after the first kernel, leaving gaps of 1024 and 256
+  // bytes between tensors 2, 3 and 4, which live throughout.
+  StaticMemoryPlan plan({Lifetime(1024, 0, 0), Lifetime(256, 0, 0),
+                         Lifetime(2048, 0, 2), Lifetime(512, 0, 2),
+                         Lifetime(240, 0, 2), Lifetime(200, 1, 2)});
+  EXPECT_EQ(plan.offset(2), 0);
+  EXPECT_EQ(plan.offset(0), 2048);
+  EXPECT_EQ(plan.offset(3), 3072);
+  EXPECT_EQ(plan.offset(1), 3584);
+  EXPECT_EQ(plan.offset(4), 3840);
+  EXPECT_EQ(plan.offset(5), 3584);
+  EXPECT_EQ(plan.buffer_size(), 4096);
+  EXPECT_EQ(plan.predecessors(5), std::vector<int>({1}));
+}
+
+TEST(StaticMemoryPlanTest, DoesNotPlaceEmptyTensors) {
+  StaticMemoryPlan plan({Lifetime(0, 0, 1), Lifetime(64, 1, 1)});
+  EXPECT_EQ(plan.offset(1), 0);
+  EXPECT_EQ(plan.buffer_size(), 64);
+  EXPECT_TRUE(plan.predecessors(1).empty());
+}
+
+TEST(StaticMemoryArenaTest, RecordsSizesWithoutAPlan) {
+  auto* arena = new StaticMemoryArena(nullptr, 2, cpu_allocator());
+  void* ptr = arena->allocator(1)->AllocateRaw(64, 100);
+  ASSERT_NE(ptr, nullptr);
+  arena->allocator(1)->DeallocateRaw(ptr);
+  EXPECT_EQ(arena->requested_size(0), 0);
+  EXPECT_EQ(arena->requested_size(1), 100);
+  EXPECT_EQ(arena->num_planned_allocations(), 0);
+  EXPECT_EQ(arena->num_fallback_allocations(), 1);
+  EXPECT_TRUE(arena->RefCountIsOne());
+  arena->Unref();
+}
+
+TEST(StaticMemoryArenaTest, ServesPlannedLocations) {
+  auto plan = std::make_shared<const StaticMemoryPlan>(
+      std::vector<StaticMemoryPlan::TensorLifetime>(
+          {Lifetime(1000, 0, 1), Lifetime(500, 1, 2), Lifetime(1000, 2, 2)}));
+  auto* arena = new StaticMemoryArena(plan, 3, cpu_allocator());
+  core::ScopedUnref unref(arena);
+
+  char* t0 = static_cast<char*>(arena->allocator(0)->AllocateRaw(64, 1000));
+  char* t1 = static_cast<char*>(arena->allocator(1)->AllocateRaw(64, 400));
+  ASSERT_NE(t0, nullptr);
+  ASSERT_NE(t1, nullptr);
+  EXPECT_EQ(t1 - t0, 1024);
+  arena->allocator(0)->DeallocateRaw(t0);
+  char* t2 = static_cast<char*>(arena->allocator(2)->AllocateRaw(64, 1000));
+  EXPECT_EQ(t2, t0);
+  arena->allocator(1)->DeallocateRaw(t1);
+  arena->allocator(2)->DeallocateRaw(t2);
+  EXPECT_EQ(arena->num_planned_allocations(), 3);
+  EXPECT_EQ(arena->num_fallback_allocations(), 0);
+  EXPECT_TRUE(arena->RefCountIsOne());
+}
+
+TEST(StaticMemoryArenaTest, FallsBackWhenThePlanDoesNotHold) {
+  auto plan = std::make_shared<const StaticMemoryPlan>(
+      std::vector<StaticMemoryPlan::TensorLifetime>(
+          {Lifetime(1000, 0, 0), Lifetime(1000, 1, 1)}));
+  auto* arena = new StaticMemoryArena(plan, 2, cpu_allocator());
+  core::ScopedUnref unref(arena);
+
+  // Larger than planned.
+  void* t0 = arena->allocator(0)->AllocateRaw(64, 2000);
+  ASSERT_NE(t0, nullptr);
+  arena->allocator(0)->DeallocateRaw(t0);
+  t0 = arena->allocator(0)->AllocateRaw(64, 1000);
+  ASSERT_NE(t0, nullptr);
+  EXPECT_EQ(arena->num_planned_allocations(), 1);
+
+  // Tensor 0 outlives its planned lifetime, so tensor 1 may not reuse its
+  // memory.
+  void* t1 = arena->allocator(1)->AllocateRaw(64, 1000);
+  ASSERT_NE(t1, nullptr);
+  EXPECT_NE(t1, t0);
+  std::memset(t1, 1, 1000);
+  arena->allocator(1)->DeallocateRaw(t1);
+  EXPECT_EQ(arena->num_fallback_allocations(), 2);
+
+  arena->allocator(0)->DeallocateRaw(t0);
+  t1 = arena->allocator(1)->AllocateRaw(64, 1000);
+  EXPECT_EQ(t1, t0);
+  arena->allocator(1)->DeallocateRaw(t1);
+  EXPECT_EQ(arena->requested_size(0), 2000);
+}
+
+TEST(StaticMemoryArenaTest, TensorsOutliveTheArena) {
+  auto plan = std::make_shared<const StaticMemoryPlan>(
+      std::vector<StaticMemoryPlan::TensorLifetime>({Lifetime(64, 0, 0)}));
+  auto* arena = new StaticMemoryArena(plan, 1, cpu_allocator());
+  Tensor t(arena->allocator(0), DT_FLOAT, TensorShape({16}));
+  t.flat<float>().setConstant(42.0f);
+  EXPECT_FALSE(arena->RefCountIsOne());
+  arena->Unref();
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_EQ(t.flat<float>()(i), 42.0f);
+  }
+  // Frees the arena.
+  t = Tensor();
+}
+
+}  // namespace
+}  // namespace tensorflow
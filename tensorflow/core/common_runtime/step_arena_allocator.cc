@@ -0,0 +1,161 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <algorithm>
+#include <new>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
+
+namespace tensorflow {
+
+// Header at the start of every block. Blocks are aligned to `kBlockSize`, and
+// all allocations start less than `kBlockSize` bytes into their block, so the
+// header of an allocation is found by masking its address.
+struct StepArenaAllocator::Block {
+  StepArenaAllocator* arena;
+  // Total size of the block, including this header.
+  size_t size;
+  // Offset of the next allocation. May run past `size` once the block is full.
+  std::atomic<size_t> offset;
+  // Number of live allocations, plus one while the arena bumps from the block.
+  std::atomic<int64_t> refs;
+};
+
+namespace {
+
+constexpr size_t RoundUp(size_t n, size_t multiple) {
+  return (n + multiple - 1) / multiple * multiple;
+}
+
+}  // namespace
+
+const size_t StepArenaAllocator::kHeaderSize =
+    RoundUp(sizeof(Block), kAllocatorAlignment);
+
+StepArenaAllocator::StepArenaAllocator(const std::string& name)
+    : name_(name) {}
+
+StepArenaAllocator::~StepArenaAllocator() {
+  // Every block holds a reference on the arena.
+  DCHECK_EQ(num_live_blocks_.load(), 0);
+}
+
+void* StepArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  const size_t rounded_bytes =
+      RoundUp(std::max<size_t>(num_bytes, 1), kAllocatorAlignment);
+  if (alignment > kAllocatorAlignment ||
+      rounded_bytes > kMaxArenaAllocationSize) {
+    return AllocateDedicated(alignment, rounded_bytes);
+  }
+
+  void* ptr = nullptr;
+  {
+    tf_shared_lock l(mu_);
+    if (current_ != nullptr) ptr = TryBump(current_, rounded_bytes);
+  }
+  if (ptr == nullptr) {
+    mutex_lock l(mu_);
+    // Another thread may have installed a new block in the meantime.
+    if (current_ != nullptr) ptr = TryBump(current_, rounded_bytes);
+    if (ptr == nullptr) {
+      Block* block = NewBlock(kBlockSize - kHeaderSize);
+      if (block == nullptr) return nullptr;
+      if (current_ != nullptr) UnrefBlock(current_);
+      current_ = block;
+      ptr = TryBump(block, rounded_bytes);
+    }
+  }
+  num_allocations_.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes_.fetch_add(rounded_bytes, std::memory_order_relaxed);
+  return ptr;
+}
+
+void* StepArenaAllocator::AllocateDedicated(size_t alignment,
+                                            size_t num_bytes) {
+  if (alignment > kMaxArenaAllocationSize) {
+    LOG(ERROR) << "Step arena " << name_ << " does not support an alignment of "
+               << alignment << " bytes.";
+    return nullptr;
+  }
+  const size_t data_offset = std::max(kHeaderSize, alignment);
+  Block* block = NewBlock(data_offset - kHeaderSize + num_bytes);
+  if (block == nullptr) return nullptr;
+  // The only reference on the block is the allocation itself.
+  block->offset.store(block->size, std::memory_order_relaxed);
+  num_allocations_.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes_.fetch_add(num_bytes, std::memory_order_relaxed);
+  return reinterpret_cast<char*>(block) + data_offset;
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  Block* block = reinterpret_cast<Block*>(reinterpret_cast<uintptr_t>(ptr) &
+                                          ~(uintptr_t{kBlockSize} - 1));
+  DCHECK_EQ(block->arena, this);
+  // May delete `this`.
+  UnrefBlock(block);
+}
+
+void StepArenaAllocator::Reset() {
+  mutex_lock l(mu_);
+  if (current_ != nullptr) {
+    // The caller holds a reference on the arena, so this does not delete it.
+    UnrefBlock(current_);
+    current_ = nullptr;
+  }
+}
+
+void StepArenaAllocator::GetStepArenaStats(StepArenaStats* stats) const {
+  stats->set_num_allocations(num_allocations_.load(std::memory_order_relaxed));
+  stats->set_allocated_bytes(allocated_bytes_.load(std::memory_order_relaxed));
+  stats->set_num_blocks(num_blocks_.load(std::memory_order_relaxed));
+  stats->set_num_escaped_blocks(
+      num_live_blocks_.load(std::memory_order_relaxed));
+}
+
+StepArenaAllocator::Block* StepArenaAllocator::NewBlock(size_t num_bytes) {
+  const size_t size = kHeaderSize + num_bytes;
+  void* mem = port::AlignedMalloc(size, kBlockSize);
+  if (mem == nullptr) return nullptr;
+  Block* block = new (mem) Block;
+  block->arena = this;
+  block->size = size;
+  block->offset.store(kHeaderSize, std::memory_order_relaxed);
+  block->refs.store(1, std::memory_order_relaxed);
+  Ref();
+  num_blocks_.fetch_add(1, std::memory_order_relaxed);
+  num_live_blocks_.fetch_add(1, std::memory_order_relaxed);
+  return block;
+}
+
+void* StepArenaAllocator::TryBump(Block* block, size_t num_bytes) {
+  const size_t offset =
+      block->offset.fetch_add(num_bytes, std::memory_order_relaxed);
+  if (offset + num_bytes > block->size) return nullptr;
+  block->refs.fetch_add(1, std::memory_order_relaxed);
+  return reinterpret_cast<char*>(block) + offset;
+}
+
+void StepArenaAllocator::UnrefBlock(Block* block) {
+  if (block->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+  StepArenaAllocator* arena = block->arena;
+  arena->num_live_blocks_.fetch_sub(1, std::memory_order_relaxed);
+  block->~Block();
+  port::AlignedFree(block);
+  arena->Unref();
+}
+
+}  // namespace tensorflow
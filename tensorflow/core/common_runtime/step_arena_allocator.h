@@ -0,0 +1,102 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <atomic>
+#include <string>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A bump-pointer allocator of host memory whose allocations are expected to
+// die within one step. The executor creates one per step and routes to it the
+// temporaries of non-stateful kernels and the outputs that the graph proves
+// are only consumed within the step.
+//
+// Memory is carved from blocks of `kBlockSize` bytes with a single atomic
+// add. A block is freed as a whole once the arena has moved past it (or has
+// been reset) and every allocation in it has been deallocated, so a tensor
+// that outlives the step only keeps its own block alive. Every block holds a
+// reference on the arena, which therefore stays valid until the last tensor
+// allocated from it is destroyed.
+//
+// Thread-safe.
+class StepArenaAllocator : public Allocator, public core::RefCounted {
+ public:
+  // The size and alignment of the blocks. Requests larger than
+  // `kMaxArenaAllocationSize` get a block of their own.
+  static constexpr size_t kBlockSize = 1 << 20;
+  static constexpr size_t kMaxArenaAllocationSize = kBlockSize / 4;
+
+  explicit StepArenaAllocator(const std::string& name);
+
+  std::string Name() override { return name_; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return AllocatorMemoryType::kHostPageable;
+  }
+
+  // Releases the arena's hold on its current block at the end of the step.
+  // Blocks that still contain live allocations are freed when the last of
+  // them is deallocated. Subsequent allocations start a new block.
+  void Reset() TF_LOCKS_EXCLUDED(mu_);
+
+  // Fills in `stats` with the allocation counts of this arena. The number of
+  // escaped blocks is only meaningful after `Reset()`.
+  void GetStepArenaStats(StepArenaStats* stats) const;
+
+ private:
+  struct Block;
+
+  // The size of the header at the start of every block.
+  static const size_t kHeaderSize;
+
+  ~StepArenaAllocator() override;
+
+  // Returns a new block of at least `num_bytes` bytes after its header,
+  // holding one reference for the arena.
+  Block* NewBlock(size_t num_bytes);
+  // Bumps `num_bytes` bytes from `block`, or returns nullptr if it is full.
+  static void* TryBump(Block* block, size_t num_bytes);
+  // Allocates a block for a single allocation of `num_bytes` bytes.
+  void* AllocateDedicated(size_t alignment, size_t num_bytes);
+  // Drops one reference on `block` and frees it if none remain.
+  static void UnrefBlock(Block* block);
+
+  const std::string name_;
+
+  mutable mutex mu_;
+  // The block that allocations are bumped from, or nullptr. Replaced under an
+  // exclusive lock on `mu_` and read under a shared one.
+  Block* current_ TF_GUARDED_BY(mu_) = nullptr;
+
+  std::atomic<int64_t> num_allocations_{0};
+  std::atomic<int64_t> allocated_bytes_{0};
+  std::atomic<int64_t> num_blocks_{0};
+  std::atomic<int64_t> num_live_blocks_{0};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArenaAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
@@ -0,0 +1,187 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace {
+
+StepArenaStats GetStats(const StepArenaAllocator& arena) {
+  StepArenaStats stats;
+  arena.GetStepArenaStats(&stats);
+  return stats;
+}
+
+TEST(StepArenaAllocatorTest, BumpsFromOneBlock) {
+  StepArenaAllocator* arena = new StepArenaAllocator("test");
+  core::ScopedUnref unref(arena);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 100; ++i) {
+    const size_t num_bytes = 100 + i % 28;
+    void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, num_bytes);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % Allocator::kAllocatorAlignment,
+              0);
+    std::memset(ptr, i, num_bytes);
+    ptrs.push_back(ptr);
+  }
+  for (size_t i = 1; i < ptrs.size(); ++i) {
+    EXPECT_GT(ptrs[i], ptrs[i - 1]);
+  }
+  for (void* ptr : ptrs) {
+    arena->DeallocateRaw(ptr);
+  }
+  arena->Reset();
+
+  StepArenaStats stats = GetStats(*arena);
+  EXPECT_EQ(stats.num_allocations(), 100);
+  EXPECT_EQ(stats.allocated_bytes(), 100 * 128);
+  EXPECT_EQ(stats.num_blocks(), 1);
+  EXPECT_EQ(stats.num_escaped_blocks(), 0);
+}
+
+TEST(StepArenaAllocatorTest, StartsNewBlocksWhenFull) {
+  StepArenaAllocator* arena = new StepArenaAllocator("test");
+  core::ScopedUnref unref(arena);
+  constexpr size_t kNumBytes = StepArenaAllocator::kMaxArenaAllocationSize;
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 10; ++i) {
+    ptrs.push_back(arena->AllocateRaw(Allocator::kAllocatorAlignment,
+                                      kNumBytes));
+    ASSERT_NE(ptrs.back(), nullptr);
+    std::memset(ptrs.back(), i, kNumBytes);
+  }
+  // Full blocks are freed as soon as their allocations are, before the end of
+  // the step.
+  for (void* ptr : ptrs) {
+    arena->DeallocateRaw(ptr);
+  }
+  // Three allocations fit in a block, after its header.
+  StepArenaStats stats = GetStats(*arena);
+  EXPECT_EQ(stats.num_blocks(), 4);
+  EXPECT_EQ(stats.num_escaped_blocks(), 1);
+  arena->Reset();
+  EXPECT_EQ(GetStats(*arena).num_escaped_blocks(), 0);
+}
+
+TEST(StepArenaAllocatorTest, LargeAllocationsGetDedicatedBlocks) {
+  StepArenaAllocator* arena = new StepArenaAllocator("test");
+  core::ScopedUnref unref(arena);
+  constexpr size_t kNumBytes = 3 * StepArenaAllocator::kBlockSize;
+  void* large = arena->AllocateRaw(Allocator::kAllocatorAlignment, kNumBytes);
+  ASSERT_NE(large, nullptr);
+  std::memset(large, 1, kNumBytes);
+  void* small = arena->AllocateRaw(Allocator::kAllocatorAlignment, 64);
+  ASSERT_NE(small, nullptr);
+  void* aligned = arena->AllocateRaw(4096, 64);
+  ASSERT_NE(aligned, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 4096, 0);
+  EXPECT_EQ(GetStats(*arena).num_blocks(), 3);
+
+  arena->DeallocateRaw(large);
+  arena->DeallocateRaw(aligned);
+  arena->DeallocateRaw(small);
+  arena->Reset();
+  EXPECT_EQ(GetStats(*arena).num_escaped_blocks(), 0);
+}
+
+TEST(StepArenaAllocatorTest, TensorsOutliveTheStep) {
+  StepArenaAllocator* arena = new StepArenaAllocator("test");
+  Tensor t(arena, DT_FLOAT, TensorShape({16}));
+  Tensor temp(arena, DT_FLOAT, TensorShape({16}));
+  t.flat<float>().setConstant(42.0f);
+  temp = Tensor();
+
+  // The step ends while `t` is alive, e.g. because it was fetched.
+  arena->Reset();
+  EXPECT_EQ(GetStats(*arena).num_escaped_blocks(), 1);
+  arena->Unref();
+
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_EQ(t.flat<float>()(i), 42.0f);
+  }
+  // Frees the block, and the arena with it.
+  t = Tensor();
+}
+
+TEST(StepArenaAllocatorTest, Threaded) {
+  StepArenaAllocator* arena = new StepArenaAllocator("test");
+  core::ScopedUnref unref(arena);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 8);
+    for (int t = 0; t < 8; ++t) {
+      pool.Schedule([arena, t]() {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 1000; ++i) {
+          const size_t num_bytes = 64 + 256 * ((i + t) % 16);
+          void* ptr =
+              arena->AllocateRaw(Allocator::kAllocatorAlignment, num_bytes);
+          ASSERT_NE(ptr, nullptr);
+          std::memset(ptr, t, num_bytes);
+          ptrs.push_back(ptr);
+          if (ptrs.size() > 16) {
+            EXPECT_EQ(*static_cast<char*>(ptrs.front()), t);
+            arena->DeallocateRaw(ptrs.front());
+            ptrs.erase(ptrs.begin());
+          }
+        }
+        for (void* ptr : ptrs) {
+          arena->DeallocateRaw(ptr);
+        }
+      });
+    }
+  }
+  arena->Reset();
+  StepArenaStats stats = GetStats(*arena);
+  EXPECT_EQ(stats.num_allocations(), 8 * 1000);
+  EXPECT_EQ(stats.num_escaped_blocks(), 0);
+}
+
+// Allocates and frees `state.range(0)` small temporaries per step, from the
+// step arena or from the CPU allocator.
+void BM_StepTemporaries(::testing::benchmark::State& state) {
+  const int num_temporaries = state.range(0);
+  const bool use_arena = state.range(1);
+  for (auto s : state) {
+    StepArenaAllocator* arena = new StepArenaAllocator("bm");
+    Allocator* allocator = use_arena ? arena : cpu_allocator();
+    for (int i = 0; i < num_temporaries; ++i) {
+      Tensor temp(allocator, DT_FLOAT, TensorShape({64 + i % 64}));
+      tensorflow::testing::DoNotOptimize(temp.data());
+    }
+    arena->Reset();
+    arena->Unref();
+  }
+  state.SetItemsProcessed(state.iterations() * num_temporaries);
+}
+
+BENCHMARK(BM_StepTemporaries)
+    ->ArgPair(1000, false)
+    ->ArgPair(1000, true)
+    ->ArgPair(10000, false)
+    ->ArgPair(10000, true);
+
+}  // namespace
+}  // namespace tensorflow
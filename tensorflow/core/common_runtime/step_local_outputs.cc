@@ -0,0 +1,87 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_local_outputs.h"
+
+#include <algorithm>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/types.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Returns true if `node` may output one of its inputs as is, so that the
+// input lives as long as the output.
+bool MayAliasInputs(const Node* node) {
+  static const auto* const kAliasingOps =
+      new absl::flat_hash_set<absl::string_view>(
+          {"Bitcast", "EnsureShape", "ExpandDims", "IdentityN",
+           "PreventGradient", "Reshape", "Snapshot", "Squeeze",
+           "StopGradient"});
+  return node->IsIdentity() || node->IsControlFlow() ||
+         node->IsFunctionCall() || kAliasingOps->contains(node->type_string());
+}
+
+}  // namespace
+
+std::vector<std::vector<bool>> FindStepLocalOutputs(const Graph& graph) {
+  // `escapes[id][i]` is true if output `i` of node `id` may be retained beyond
+  // the step, e.g. by a variable, a queue or a fetch.
+  std::vector<std::vector<bool>> escapes(graph.num_node_ids());
+  std::vector<const Node*> worklist;
+  for (const Node* n : graph.nodes()) {
+    if (n->IsSink()) continue;
+    std::vector<bool>& node_escapes = escapes[n->id()];
+    node_escapes.assign(n->num_outputs(), n->op_def().is_stateful());
+    for (int i = 0; i < n->num_outputs(); ++i) {
+      if (IsRefType(n->output_type(i))) node_escapes[i] = true;
+    }
+    for (const Edge* e : n->out_edges()) {
+      if (e->IsControlEdge()) continue;
+      if (e->dst()->op_def().is_stateful()) {
+        node_escapes[e->src_output()] = true;
+      }
+    }
+    worklist.push_back(n);
+  }
+  // The inputs of an aliasing node escape if any of its outputs does.
+  while (!worklist.empty()) {
+    const Node* n = worklist.back();
+    worklist.pop_back();
+    const std::vector<bool>& node_escapes = escapes[n->id()];
+    if (!MayAliasInputs(n) ||
+        std::find(node_escapes.begin(), node_escapes.end(), true) ==
+            node_escapes.end()) {
+      continue;
+    }
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge()) continue;
+      std::vector<bool>& src_escapes = escapes[e->src()->id()];
+      if (!src_escapes[e->src_output()]) {
+        src_escapes[e->src_output()] = true;
+        worklist.push_back(e->src());
+      }
+    }
+  }
+
+  for (std::vector<bool>& node_escapes : escapes) {
+    node_escapes.flip();
+  }
+  return escapes;
+}
+
+}  // namespace tensorflow
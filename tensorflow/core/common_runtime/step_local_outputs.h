@@ -0,0 +1,38 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_LOCAL_OUTPUTS_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_LOCAL_OUTPUTS_H_
+
+#include <vector>
+
+#include "tensorflow/core/graph/graph.h"
+
+namespace tensorflow {
+
+// Returns, for each node of `graph` indexed by id, one element per output
+// that is true iff the output is not expected to outlive the step. That is
+// the case for the outputs of non-stateful nodes that are not refs and only
+// reach non-stateful nodes, directly or through nodes that alias their inputs
+// (e.g. Identity or Reshape). Variables, queues and the `_Retval` nodes of
+// fetches are all stateful.
+//
+// This is a heuristic: kernels may still forward an input buffer to an output
+// that outlives the step, so memory handed out on the strength of it must
+// stay valid until it is deallocated.
+std::vector<std::vector<bool>> FindStepLocalOutputs(const Graph& graph);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_LOCAL_OUTPUTS_H_
@@ -424,6 +424,23 @@ void StepStatsCollector::SaveThreadName(const string& device,
   }
 }
 
+void StepStatsCollector::SaveStepArenaStats(const string& device,
+                                            const StepArenaStats& stats) {
+  mutex_lock l(mu_);
+  if (finalized_) {
+    LOG(WARNING) << "step arena stats saved after finalize will not be "
+                    "collected.";
+  }
+  StepArenaStats& device_stats = step_arena_stats_[device];
+  device_stats.set_num_allocations(device_stats.num_allocations() +
+                                   stats.num_allocations());
+  device_stats.set_allocated_bytes(device_stats.allocated_bytes() +
+                                   stats.allocated_bytes());
+  device_stats.set_num_blocks(device_stats.num_blocks() + stats.num_blocks());
+  device_stats.set_num_escaped_blocks(device_stats.num_escaped_blocks() +
+                                      stats.num_escaped_blocks());
+}
+
 NodeExecStatsInterface* StepStatsCollector::CreateNodeExecStats(
     const NodeDef* node) {
   // Only collect statistics for non-transfer nodes.
@@ -557,5 +574,14 @@ void StepStatsCollector::FinalizeInternal() {
       (*dss->mutable_thread_names())[thread_name.first] = thread_name.second;
     }
   }
+  for (const auto& device_arena : step_arena_stats_) {
+    if (dev_stats_pb.find(device_arena.first) == dev_stats_pb.end()) {
+      DeviceStepStats* ndev_stat = step_stats_->add_dev_stats();
+      ndev_stat->set_device(device_arena.first);
+      dev_stats_pb[device_arena.first] = ndev_stat;
+    }
+    *dev_stats_pb.at(device_arena.first)->mutable_step_arena_stats() =
+        device_arena.second;
+  }
 }
 }  // namespace tensorflow
@@ -36,6 +36,7 @@ class Graph;
 class NodeDef;
 class NodeExecStats;
 class OpKernelContext;
+class StepArenaStats;
 class StepStats;
 class StepStatsCollector;
 class Tensor;
@@ -149,6 +150,11 @@ class StepStatsCollectorInterface {
   // "ResourceExhaustedError: OOM when allocating tensor ...
   // on /job:localhost/replica:0/task:0/device:GPU:0 by allocator GPU_0_bfc"
   virtual string ReportAllocsOnResourceExhausted(absl::string_view err) = 0;
+
+  // Records the statistics of the step arena of an executor on `device`. The
+  // default implementation drops them.
+  virtual void SaveStepArenaStats(const string& device,
+                                  const StepArenaStats& stats) {}
 };
 
 // StepStatsCollector manages the collection of a StepStats object.
@@ -177,6 +183,9 @@ class StepStatsCollector : public StepStatsCollectorInterface {
 
   NodeExecStatsInterface* CreateNodeExecStats(const NodeDef* node) override;
   string ReportAllocsOnResourceExhausted(absl::string_view err) override;
+  // Accumulates the statistics of all the step arenas of `device`.
+  void SaveStepArenaStats(const string& device,
+                          const StepArenaStats& stats) override;
 
   // The following 2 Finalize methods populate the StepStats passed
   // from the constructor. Calling it more than once won't have any effect.
@@ -199,6 +208,8 @@ class StepStatsCollector : public StepStatsCollectorInterface {
   bool finalized_ TF_GUARDED_BY(mu_);
   std::unordered_map<string, NodeStatsVector> dev_stats_ TF_GUARDED_BY(mu_);
   std::unordered_map<string, ThreadNamesMap> thread_names_ TF_GUARDED_BY(mu_);
+  std::unordered_map<string, StepArenaStats> step_arena_stats_
+      TF_GUARDED_BY(mu_);
   StepStats* step_stats_ TF_GUARDED_BY(mu_);
   uint64 collected_nodes_ TF_GUARDED_BY(mu_) = 0;
 };
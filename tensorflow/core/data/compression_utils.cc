@@ -15,18 +15,28 @@ limitations under the License.
 #include "tensorflow/core/data/compression_utils.h"
 
 #include <limits>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/types.h"
 
+// zstd is not a dependency of the portable builds, which only support snappy.
+#if !defined(IS_MOBILE_PLATFORM)
+#include "dictBuilder/zdict.h"  // from @net_zstd
+#include "zstd.h"  // from @net_zstd
+#endif  // !IS_MOBILE_PLATFORM
+
 namespace tensorflow {
 namespace data {
 namespace {
@@ -34,7 +44,12 @@ namespace {
 // Increment this when making changes to the `CompressedElement` proto. The
 // `UncompressElement` function will determine what to read according to the
 // version.
-constexpr int kCompressedElementVersion = 0;
+//
+// Version 1 added the `codec` and `dictionary_id` fields. Snappy-compressed
+// elements are still written with version 0, so that they remain readable by
+// binaries that predate version 1.
+constexpr int kCompressedElementVersion = 1;
+constexpr int kSnappyCompressedElementVersion = 0;
 
 }  // namespace
 
@@ -61,8 +76,19 @@ class Iov {
   size_t num_bytes_;
 };
 
-Status CompressElement(const std::vector<Tensor>& element,
-                       CompressedElement* out) {
+namespace {
+
+// The uncompressed bytes of an element, as an iov array pointing into the
+// element's tensors and into `nonmemcpyable`.
+struct ElementPieces {
+  std::unique_ptr<Iov> iov;
+  tstring nonmemcpyable;
+};
+
+// Builds the iov array of the tensor data of `element`, and fills out the
+// per-component metadata in `out`.
+void GetElementPieces(const std::vector<Tensor>& element,
+                      CompressedElement* out, ElementPieces* pieces) {
   // First pass: preprocess the non`memcpy`able tensors.
   size_t num_string_tensors = 0;
   size_t num_string_tensor_strings = 0;
@@ -86,8 +112,11 @@ Status CompressElement(const std::vector<Tensor>& element,
   // string).
   // - All other tensors are serialized and copied into a string (a `tstring`
   // for access to `resize_unitialized`).
-  Iov iov{element.size() + num_string_tensor_strings - num_string_tensors};
-  tstring nonmemcpyable;
+  pieces->iov = std::make_unique<Iov>(element.size() +
+                                      num_string_tensor_strings -
+                                      num_string_tensors);
+  Iov& iov = *pieces->iov;
+  tstring& nonmemcpyable = pieces->nonmemcpyable;
   nonmemcpyable.resize_uninitialized(total_nonmemcpyable_size);
   char* nonmemcpyable_pos = nonmemcpyable.mdata();
   int nonmemcpyable_component_index = 0;
@@ -119,28 +148,272 @@ Status CompressElement(const std::vector<Tensor>& element,
       metadata->add_uncompressed_bytes(proto.ByteSizeLong());
     }
   }
+}
+
+#if !defined(IS_MOBILE_PLATFORM)
+template <typename T, size_t (*Free)(T*)>
+struct ZstdDeleter {
+  void operator()(T* ctx) const { Free(ctx); }
+};
+using ZstdCCtxPtr =
+    std::unique_ptr<ZSTD_CCtx, ZstdDeleter<ZSTD_CCtx, ZSTD_freeCCtx>>;
+using ZstdDCtxPtr =
+    std::unique_ptr<ZSTD_DCtx, ZstdDeleter<ZSTD_DCtx, ZSTD_freeDCtx>>;
+
+Status ZstdError(absl::string_view operation, size_t code) {
+  return errors::Internal("Failed to ", operation,
+                          " using zstd: ", ZSTD_getErrorName(code));
+}
+
+// Compresses the bytes of `iov` into `output` as a single zstd frame.
+Status ZstdCompress(Iov& iov, const CompressElementOptions& options,
+                    std::string* output) {
+  ZstdCCtxPtr cctx(ZSTD_createCCtx());
+  if (cctx == nullptr) {
+    return errors::ResourceExhausted("Failed to create a zstd context.");
+  }
+  size_t ret = ZSTD_CCtx_setParameter(cctx.get(), ZSTD_c_compressionLevel,
+                                      options.compression_level);
+  if (ZSTD_isError(ret)) {
+    return ZstdError("set the compression level", ret);
+  }
+  // Records the uncompressed size in the frame header.
+  ret = ZSTD_CCtx_setPledgedSrcSize(cctx.get(), iov.NumBytes());
+  if (ZSTD_isError(ret)) {
+    return ZstdError("set the uncompressed size", ret);
+  }
+  if (!options.dictionary.empty()) {
+    ret = ZSTD_CCtx_loadDictionary(cctx.get(), options.dictionary.data(),
+                                   options.dictionary.size());
+    if (ZSTD_isError(ret)) {
+      return ZstdError("load the dictionary", ret);
+    }
+  }
+
+  // A single frame of the bound size always fits the whole element, but the
+  // loops below grow the output rather than relying on it.
+  output->resize(ZSTD_compressBound(iov.NumBytes()));
+  ZSTD_outBuffer out = {&(*output)[0], output->size(), 0};
+  auto compress_stream = [&](ZSTD_inBuffer* in,
+                             ZSTD_EndDirective mode) -> Status {
+    while (true) {
+      if (out.pos == out.size) {
+        output->resize(output->size() * 2 + ZSTD_CStreamOutSize());
+        out.dst = &(*output)[0];
+        out.size = output->size();
+      }
+      const size_t remaining =
+          ZSTD_compressStream2(cctx.get(), &out, in, mode);
+      if (ZSTD_isError(remaining)) {
+        return ZstdError("compress", remaining);
+      }
+      if (mode == ZSTD_e_end ? remaining == 0 : in->pos == in->size) {
+        return OkStatus();
+      }
+    }
+  };
+  const iovec* pieces = iov.Data();
+  for (size_t i = 0; i < iov.NumPieces(); ++i) {
+    if (pieces[i].iov_len == 0) continue;
+    ZSTD_inBuffer in = {pieces[i].iov_base, pieces[i].iov_len, 0};
+    TF_RETURN_IF_ERROR(compress_stream(&in, ZSTD_e_continue));
+  }
+  ZSTD_inBuffer end = {nullptr, 0, 0};
+  TF_RETURN_IF_ERROR(compress_stream(&end, ZSTD_e_end));
+  output->resize(out.pos);
+  return OkStatus();
+}
+
+// Uncompresses the zstd frame in `input` into the pieces of `iov`.
+Status ZstdUncompress(absl::string_view input, absl::string_view dictionary,
+                      Iov& iov) {
+  const unsigned long long uncompressed_size =  // NOLINT(runtime/int)
+      ZSTD_getFrameContentSize(input.data(), input.size());
+  if (uncompressed_size == ZSTD_CONTENTSIZE_ERROR ||
+      uncompressed_size == ZSTD_CONTENTSIZE_UNKNOWN) {
+    return errors::Internal(
+        "Could not get zstd uncompressed length. Compressed data size: ",
+        input.size());
+  }
+  if (uncompressed_size != iov.NumBytes()) {
+    return errors::Internal("Uncompressed size mismatch. Zstd expects ",
+                            uncompressed_size,
+                            " whereas the tensor metadata suggests ",
+                            iov.NumBytes());
+  }
+  ZstdDCtxPtr dctx(ZSTD_createDCtx());
+  if (dctx == nullptr) {
+    return errors::ResourceExhausted("Failed to create a zstd context.");
+  }
+  if (!dictionary.empty()) {
+    const size_t ret = ZSTD_DCtx_loadDictionary(
+        dctx.get(), dictionary.data(), dictionary.size());
+    if (ZSTD_isError(ret)) {
+      return ZstdError("load the dictionary", ret);
+    }
+  }
+
+  ZSTD_inBuffer in = {input.data(), input.size(), 0};
+  // Zero once the whole frame has been uncompressed and flushed.
+  size_t frame_remaining = 1;
+  // Calls `ZSTD_decompressStream` until `out` is full, or until the frame is
+  // done when `out` is empty. Returns an error if the input runs out first.
+  auto uncompress = [&](ZSTD_outBuffer* out) -> Status {
+    while (true) {
+      const size_t prev_in_pos = in.pos;
+      const size_t prev_out_pos = out->pos;
+      frame_remaining = ZSTD_decompressStream(dctx.get(), out, &in);
+      if (ZSTD_isError(frame_remaining)) {
+        return ZstdError("uncompress", frame_remaining);
+      }
+      if (out->size == 0 ? frame_remaining == 0 : out->pos == out->size) {
+        return OkStatus();
+      }
+      if (in.pos == prev_in_pos && out->pos == prev_out_pos) {
+        return errors::DataLoss("Truncated zstd compressed data.");
+      }
+    }
+  };
+  const iovec* pieces = iov.Data();
+  for (size_t i = 0; i < iov.NumPieces(); ++i) {
+    if (pieces[i].iov_len == 0) continue;
+    ZSTD_outBuffer out = {pieces[i].iov_base, pieces[i].iov_len, 0};
+    TF_RETURN_IF_ERROR(uncompress(&out));
+  }
+  if (frame_remaining != 0) {
+    // Consumes the end of the frame.
+    ZSTD_outBuffer end = {nullptr, 0, 0};
+    TF_RETURN_IF_ERROR(uncompress(&end));
+  }
+  if (in.pos != in.size) {
+    return errors::Internal("Found ", in.size - in.pos,
+                            " unexpected bytes after the zstd frame.");
+  }
+  return OkStatus();
+}
+
+// Returns the ID of a zstd dictionary, or 0 if `dictionary` is empty.
+unsigned ZstdDictionaryId(absl::string_view dictionary) {
+  return ZSTD_getDictID_fromDict(dictionary.data(), dictionary.size());
+}
+#else
+Status ZstdUnsupported() {
+  return errors::Unimplemented(
+      "zstd compression is not supported on mobile platforms.");
+}
+
+Status ZstdCompress(Iov& iov, const CompressElementOptions& options,
+                    std::string* output) {
+  return ZstdUnsupported();
+}
+
+Status ZstdUncompress(absl::string_view input, absl::string_view dictionary,
+                      Iov& iov) {
+  return ZstdUnsupported();
+}
+
+unsigned ZstdDictionaryId(absl::string_view dictionary) { return 0; }
+#endif  // !IS_MOBILE_PLATFORM
 
-  if (iov.NumBytes() > kuint32max) {
-    return errors::OutOfRange("Encountered dataset element of size ",
-                              iov.NumBytes(),
-                              ", exceeding the 4GB Snappy limit.");
+// The dictionaries registered with `RegisterZstdDictionary`, keyed by ID.
+struct ZstdDictionaryRegistry {
+  mutex mu;
+  absl::flat_hash_map<unsigned, std::shared_ptr<const std::string>>
+      dictionaries TF_GUARDED_BY(mu);
+};
+
+ZstdDictionaryRegistry& GetZstdDictionaryRegistry() {
+  static auto* registry = new ZstdDictionaryRegistry();
+  return *registry;
+}
+
+// Returns the registered dictionary with ID `dictionary_id`, or nullptr.
+std::shared_ptr<const std::string> FindZstdDictionary(unsigned dictionary_id) {
+  ZstdDictionaryRegistry& registry = GetZstdDictionaryRegistry();
+  tf_shared_lock l(registry.mu);
+  auto it = registry.dictionaries.find(dictionary_id);
+  if (it == registry.dictionaries.end()) {
+    return nullptr;
   }
-  if (!port::Snappy_CompressFromIOVec(iov.Data(), iov.NumBytes(),
-                                      out->mutable_data())) {
-    return errors::Internal("Failed to compress using snappy.");
+  return it->second;
+}
+
+}  // namespace
+
+Status CompressElement(const std::vector<Tensor>& element,
+                       const CompressElementOptions& options,
+                       CompressedElement* out) {
+  ElementPieces pieces;
+  GetElementPieces(element, out, &pieces);
+  Iov& iov = *pieces.iov;
+
+  switch (options.codec) {
+    case CompressedElement::SNAPPY:
+      if (iov.NumBytes() > kuint32max) {
+        return errors::OutOfRange("Encountered dataset element of size ",
+                                  iov.NumBytes(),
+                                  ", exceeding the 4GB Snappy limit.");
+      }
+      if (!port::Snappy_CompressFromIOVec(iov.Data(), iov.NumBytes(),
+                                          out->mutable_data())) {
+        return errors::Internal("Failed to compress using snappy.");
+      }
+      out->set_version(kSnappyCompressedElementVersion);
+      break;
+    case CompressedElement::ZSTD:
+      TF_RETURN_IF_ERROR(ZstdCompress(iov, options, out->mutable_data()));
+      out->set_version(kCompressedElementVersion);
+      out->set_codec(CompressedElement::ZSTD);
+      if (!options.dictionary.empty()) {
+        out->set_dictionary_id(ZstdDictionaryId(options.dictionary));
+      }
+      break;
+    default:
+      return errors::InvalidArgument(
+          "Unsupported compression codec: ",
+          CompressedElement::Codec_Name(options.codec));
   }
-  out->set_version(kCompressedElementVersion);
   VLOG(3) << "Compressed element from " << iov.NumBytes() << " bytes to "
           << out->data().size() << " bytes";
   return OkStatus();
 }
 
+Status CompressElement(const std::vector<Tensor>& element,
+                       CompressedElement* out) {
+  return CompressElement(element, CompressElementOptions(), out);
+}
+
 Status UncompressElement(const CompressedElement& compressed,
+                         absl::string_view dictionary,
                          std::vector<Tensor>* out) {
-  if (compressed.version() != kCompressedElementVersion) {
+  if (compressed.version() < 0 ||
+      compressed.version() > kCompressedElementVersion) {
     return errors::Internal("Unsupported compressed element version: ",
                             compressed.version());
   }
+  // Version 0 elements are always compressed with snappy, and have no codec.
+  const CompressedElement::Codec codec =
+      compressed.version() == 0 ? CompressedElement::SNAPPY
+                                : compressed.codec();
+  std::shared_ptr<const std::string> registered_dictionary;
+  if (codec == CompressedElement::ZSTD && compressed.dictionary_id() != 0) {
+    if (dictionary.empty()) {
+      registered_dictionary = FindZstdDictionary(compressed.dictionary_id());
+      if (registered_dictionary == nullptr) {
+        return errors::FailedPrecondition(
+            "The compressed element requires zstd dictionary ",
+            compressed.dictionary_id(), ", but no dictionary was provided.");
+      }
+      dictionary = *registered_dictionary;
+    }
+    const unsigned dictionary_id = ZstdDictionaryId(dictionary);
+    if (dictionary_id != compressed.dictionary_id()) {
+      return errors::FailedPrecondition(
+          "The compressed element requires zstd dictionary ",
+          compressed.dictionary_id(), ", but got dictionary ", dictionary_id,
+          ".");
+    }
+  }
   int num_components = compressed.component_metadata_size();
   out->clear();
   out->reserve(num_components);
@@ -191,22 +464,34 @@ Status UncompressElement(const CompressedElement& compressed,
 
   // Step 2: Uncompress into the iovec.
   const std::string& compressed_data = compressed.data();
-  size_t uncompressed_size;
-  if (!port::Snappy_GetUncompressedLength(
-          compressed_data.data(), compressed_data.size(), &uncompressed_size)) {
-    return errors::Internal(
-        "Could not get snappy uncompressed length. Compressed data size: ",
-        compressed_data.size());
-  }
-  if (uncompressed_size != static_cast<size_t>(iov.NumBytes())) {
-    return errors::Internal(
-        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
-        " whereas the tensor metadata suggests ", iov.NumBytes());
-  }
-  if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
-                                      compressed_data.size(), iov.Data(),
-                                      iov.NumPieces())) {
-    return errors::Internal("Failed to perform snappy decompression.");
+  switch (codec) {
+    case CompressedElement::SNAPPY: {
+      size_t uncompressed_size;
+      if (!port::Snappy_GetUncompressedLength(compressed_data.data(),
+                                              compressed_data.size(),
+                                              &uncompressed_size)) {
+        return errors::Internal(
+            "Could not get snappy uncompressed length. Compressed data size: ",
+            compressed_data.size());
+      }
+      if (uncompressed_size != static_cast<size_t>(iov.NumBytes())) {
+        return errors::Internal(
+            "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
+            " whereas the tensor metadata suggests ", iov.NumBytes());
+      }
+      if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
+                                          compressed_data.size(), iov.Data(),
+                                          iov.NumPieces())) {
+        return errors::Internal("Failed to perform snappy decompression.");
+      }
+      break;
+    }
+    case CompressedElement::ZSTD:
+      TF_RETURN_IF_ERROR(ZstdUncompress(compressed_data, dictionary, iov));
+      break;
+    default:
+      return errors::Internal("Unsupported compression codec: ",
+                              CompressedElement::Codec_Name(codec));
   }
 
   // Third pass: deserialize nonstring, non`memcpy`able tensors.
@@ -231,6 +516,70 @@ Status UncompressElement(const CompressedElement& compressed,
   return OkStatus();
 }
 
+Status UncompressElement(const CompressedElement& compressed,
+                         std::vector<Tensor>* out) {
+  return UncompressElement(compressed, /*dictionary=*/"", out);
+}
+
+Status RegisterZstdDictionary(absl::string_view dictionary) {
+#if defined(IS_MOBILE_PLATFORM)
+  return ZstdUnsupported();
+#else
+  const unsigned dictionary_id = ZstdDictionaryId(dictionary);
+  if (dictionary_id == 0) {
+    return errors::InvalidArgument(
+        "Only zstd dictionaries with an ID can be registered, e.g. from "
+        "TrainZstdDictionary.");
+  }
+  ZstdDictionaryRegistry& registry = GetZstdDictionaryRegistry();
+  mutex_lock l(registry.mu);
+  auto [it, inserted] = registry.dictionaries.try_emplace(dictionary_id);
+  if (inserted) {
+    it->second = std::make_shared<const std::string>(dictionary);
+  } else if (*it->second != dictionary) {
+    return errors::AlreadyExists("A different zstd dictionary with ID ",
+                                 dictionary_id, " is already registered.");
+  }
+  return OkStatus();
+#endif  // IS_MOBILE_PLATFORM
+}
+
+Status TrainZstdDictionary(const std::vector<std::vector<Tensor>>& samples,
+                           size_t max_dictionary_size,
+                           std::string* dictionary) {
+#if defined(IS_MOBILE_PLATFORM)
+  return ZstdUnsupported();
+#else
+  // ZDICT expects the samples concatenated in a single buffer.
+  std::string buffer;
+  std::vector<size_t> sample_sizes;
+  sample_sizes.reserve(samples.size());
+  for (const auto& element : samples) {
+    CompressedElement metadata;
+    ElementPieces pieces;
+    GetElementPieces(element, &metadata, &pieces);
+    const iovec* iov = pieces.iov->Data();
+    for (size_t i = 0; i < pieces.iov->NumPieces(); ++i) {
+      buffer.append(static_cast<const char*>(iov[i].iov_base),
+                    iov[i].iov_len);
+    }
+    sample_sizes.push_back(pieces.iov->NumBytes());
+  }
+  dictionary->resize(max_dictionary_size);
+  const size_t size = ZDICT_trainFromBuffer(
+      &(*dictionary)[0], dictionary->size(), buffer.data(),
+      sample_sizes.data(), sample_sizes.size());
+  if (ZDICT_isError(size)) {
+    dictionary->clear();
+    return errors::InvalidArgument("Failed to train a zstd dictionary on ",
+                                   samples.size(),
+                                   " elements: ", ZDICT_getErrorName(size));
+  }
+  dictionary->resize(size);
+  return OkStatus();
+#endif  // IS_MOBILE_PLATFORM
+}
+
 REGISTER_UNARY_VARIANT_DECODE_FUNCTION(CompressedElement,
                                        "tensorflow.data.CompressedElement");
 
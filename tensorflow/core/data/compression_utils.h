@@ -15,8 +15,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_COMPRESSION_UTILS_H_
 #define TENSORFLOW_CORE_DATA_COMPRESSION_UTILS_H_
 
+#include <string>
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/status.h"
@@ -24,19 +26,60 @@ limitations under the License.
 namespace tensorflow {
 namespace data {
 
+// Options for compressing a dataset element.
+struct CompressElementOptions {
+  // The codec to compress the element with.
+  CompressedElement::Codec codec = CompressedElement::SNAPPY;
+  // The zstd compression level. Higher levels compress better but slower.
+  // Negative levels are faster than level 1, and are the best choice when
+  // latency matters more than the compression ratio. Ignored for snappy.
+  int compression_level = 3;
+  // An optional zstd dictionary, e.g. from `TrainZstdDictionary`. Elements
+  // compressed with a dictionary can only be uncompressed with the same
+  // dictionary. Ignored for snappy.
+  absl::string_view dictionary;
+};
+
 // Compresses the components of `element` into the `CompressedElement` proto.
 //
 // In addition to writing the actual compressed bytes, `Compress` fills
 // out the per-component metadata for the `CompressedElement`.
 //
-// Returns an error if the uncompressed size of the element exceeds 4GB.
+// With snappy compression, returns an error if the uncompressed size of the
+// element exceeds 4GB.
+Status CompressElement(const std::vector<Tensor>& element,
+                       const CompressElementOptions& options,
+                       CompressedElement* out);
+
+// Compresses `element` with snappy.
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out);
 
 // Uncompresses a `CompressedElement` into a vector of tensor components.
+// `dictionary` must be the dictionary the element was compressed with, if any.
 Status UncompressElement(const CompressedElement& compressed,
+                         absl::string_view dictionary,
                          std::vector<Tensor>* out);
 
+// Uncompresses a `CompressedElement` compressed without a dictionary, or with
+// a dictionary registered with `RegisterZstdDictionary`.
+Status UncompressElement(const CompressedElement& compressed,
+                         std::vector<Tensor>* out);
+
+// Registers a zstd dictionary for the lifetime of the process, so that the
+// elements compressed with it can be uncompressed without being passed the
+// dictionary, e.g. by tf.data service clients, which receive the dictionary
+// with the dataset metadata. Registering the same dictionary again is a no-op.
+Status RegisterZstdDictionary(absl::string_view dictionary);
+
+// Trains a zstd dictionary of at most `max_dictionary_size` bytes on the
+// sample elements in `samples`. The dictionary can then be passed to
+// `CompressElement` and `UncompressElement` to improve the compression ratio
+// of small elements that have similar contents. Training needs a few
+// thousand samples, and fails if there are too few.
+Status TrainZstdDictionary(const std::vector<std::vector<Tensor>>& samples,
+                           size_t max_dictionary_size, std::string* dictionary);
+
 }  // namespace data
 }  // namespace tensorflow
 
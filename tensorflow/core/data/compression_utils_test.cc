@@ -17,6 +17,7 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/platform/test.h"
@@ -98,15 +99,121 @@ TEST_P(ParameterizedCompressionUtilsTest, VersionMismatch) {
   CompressedElement compressed;
   TF_ASSERT_OK(CompressElement(element, &compressed));
 
-  compressed.set_version(1);
+  compressed.set_version(2);
   std::vector<Tensor> round_trip_element;
   EXPECT_THAT(UncompressElement(compressed, &round_trip_element),
               StatusIs(error::INTERNAL));
 }
 
+TEST_P(ParameterizedCompressionUtilsTest, ZstdRoundTrip) {
+  std::vector<Tensor> element = GetParam();
+  for (int compression_level : {-5, 3, 19}) {
+    CompressElementOptions options;
+    options.codec = CompressedElement::ZSTD;
+    options.compression_level = compression_level;
+    CompressedElement compressed;
+    TF_ASSERT_OK(CompressElement(element, options, &compressed));
+    EXPECT_EQ(compressed.version(), 1);
+    EXPECT_EQ(compressed.codec(), CompressedElement::ZSTD);
+    std::vector<Tensor> round_trip_element;
+    TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+    TF_EXPECT_OK(
+        ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+  }
+}
+
+TEST_P(ParameterizedCompressionUtilsTest, ZstdCorruptData) {
+  std::vector<Tensor> element = GetParam();
+  CompressElementOptions options;
+  options.codec = CompressedElement::ZSTD;
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, options, &compressed));
+
+  compressed.mutable_data()->resize(compressed.data().size() / 2);
+  std::vector<Tensor> round_trip_element;
+  EXPECT_FALSE(UncompressElement(compressed, &round_trip_element).ok());
+}
+
 INSTANTIATE_TEST_SUITE_P(Instantiation, ParameterizedCompressionUtilsTest,
                          ::testing::ValuesIn(TestCases()));
 
+std::vector<std::vector<Tensor>> DictionarySamples() {
+  std::vector<std::vector<Tensor>> samples;
+  for (int64_t i = 0; i < 2000; ++i) {
+    samples.push_back(
+        {CreateTensor<tstring>(
+             TensorShape{2}, {absl::StrCat("user_", i % 97, "_country_",
+                                           i % 3 == 0 ? "DE" : "US"),
+                              absl::StrCat("clicks: ", i * 31 % 1000)}),
+         CreateTensor<int64_t>(TensorShape{2}, {i % 10, i % 7})});
+  }
+  return samples;
+}
+
+TEST(CompressionUtilsTest, ZstdDictionary) {
+  std::vector<std::vector<Tensor>> samples = DictionarySamples();
+  std::string dictionary;
+  TF_ASSERT_OK(TrainZstdDictionary(samples, /*max_dictionary_size=*/4096,
+                                   &dictionary));
+  ASSERT_FALSE(dictionary.empty());
+
+  CompressElementOptions options;
+  options.codec = CompressedElement::ZSTD;
+  CompressedElement without_dictionary;
+  TF_ASSERT_OK(CompressElement(samples[5], options, &without_dictionary));
+  options.dictionary = dictionary;
+  CompressedElement with_dictionary;
+  TF_ASSERT_OK(CompressElement(samples[5], options, &with_dictionary));
+  EXPECT_NE(with_dictionary.dictionary_id(), 0);
+  EXPECT_LT(with_dictionary.data().size(), without_dictionary.data().size());
+
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(
+      UncompressElement(with_dictionary, dictionary, &round_trip_element));
+  TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(samples[5], round_trip_element,
+                                               /*compare_order=*/true));
+  EXPECT_THAT(UncompressElement(with_dictionary, &round_trip_element),
+              StatusIs(error::FAILED_PRECONDITION,
+                       HasSubstr("no dictionary was provided")));
+}
+
+TEST(CompressionUtilsTest, RegisteredZstdDictionary) {
+  std::vector<std::vector<Tensor>> samples = DictionarySamples();
+  // Not the dictionary of the ZstdDictionary test, which must not be
+  // registered.
+  std::string dictionary;
+  TF_ASSERT_OK(TrainZstdDictionary(samples, /*max_dictionary_size=*/3072,
+                                   &dictionary));
+  CompressElementOptions options;
+  options.codec = CompressedElement::ZSTD;
+  options.dictionary = dictionary;
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(samples[5], options, &compressed));
+
+  TF_ASSERT_OK(RegisterZstdDictionary(dictionary));
+  TF_ASSERT_OK(RegisterZstdDictionary(dictionary));
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(samples[5], round_trip_element,
+                                               /*compare_order=*/true));
+
+  std::string other_dictionary = dictionary;
+  other_dictionary.back() ^= 1;
+  EXPECT_THAT(RegisterZstdDictionary(other_dictionary),
+              StatusIs(error::ALREADY_EXISTS));
+  EXPECT_THAT(RegisterZstdDictionary("not a dictionary"),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST(CompressionUtilsTest, ZstdDictionaryTooFewSamples) {
+  std::vector<std::vector<Tensor>> samples = {
+      CreateTensors<int64_t>(TensorShape{1}, {{1}})};
+  std::string dictionary;
+  EXPECT_THAT(TrainZstdDictionary(samples, /*max_dictionary_size=*/4096,
+                                  &dictionary),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -91,6 +91,7 @@ constexpr char kShuffleAndRepeatFusionOpt[] = "shuffle_and_repeat_fusion";
 constexpr char kFilterFusionOpt[] = "filter_fusion";
 constexpr char kMapAndFilterFusionOpt[] = "map_and_filter_fusion";
 constexpr char kMapFusionOpt[] = "map_fusion";
+constexpr char kMapVectorizationOpt[] = "map_vectorization";
 constexpr char kParallelBatchOpt[] = "parallel_batch";
 constexpr char kAutotuneBufferSizesOpt[] = "autotune_buffer_sizes";
 constexpr char kDisablePrefetchLegacyAutotuneOpt[] =
@@ -192,6 +193,14 @@ void DefaultOptimizationGraphRewrites(
       optimization_disabled->insert(kMapFusionOpt);
     }
   }
+  if (optimization_options.optional_map_vectorization_case() ==
+      OptimizationOptions::kMapVectorization) {
+    if (optimization_options.map_vectorization()) {
+      optimization_enabled->insert(kMapVectorizationOpt);
+    } else {
+      optimization_disabled->insert(kMapVectorizationOpt);
+    }
+  }
   if (optimization_options.optional_noop_elimination_case() ==
       OptimizationOptions::kNoopElimination) {
     if (optimization_options.noop_elimination()) {
@@ -917,6 +926,18 @@ bool ShouldUsePrivateThreadPool(const Options& options) {
          ThreadingOptions::kPrivateThreadpoolSize;
 }
 
+bool ShouldUseNumaAwareThreading(const Options& options) {
+  return options.threading_options().optional_numa_aware_case() ==
+             ThreadingOptions::kNumaAware &&
+         options.threading_options().numa_aware();
+}
+
+bool ShouldUseWorkStealingScheduler(const Options& options) {
+  return options.threading_options().optional_work_stealing_case() ==
+             ThreadingOptions::kWorkStealing &&
+         options.threading_options().work_stealing();
+}
+
 bool ShouldUseAutotuning(const Options& options) {
   return options.autotune_options().optional_enabled_case() !=
              AutotuneOptions::kEnabled ||
@@ -348,6 +348,14 @@ bool ShouldConfigureMaxIntraOpParallelism(const Options& options);
 // Determines whether private threadpool should be used.
 bool ShouldUsePrivateThreadPool(const Options& options);
 
+// Determines whether the threads and memory of the input pipeline should be
+// confined to a single NUMA node.
+bool ShouldUseNumaAwareThreading(const Options& options);
+
+// Determines whether the work of the input pipeline should be scheduled on the
+// work-stealing scheduler shared by the process.
+bool ShouldUseWorkStealingScheduler(const Options& options);
+
 // Determines whether autotuning should be used.
 bool ShouldUseAutotuning(const Options& options);
 
@@ -0,0 +1,111 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/numa_utils.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/numa.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// The topology reported by the platform.
+class PlatformNumaTopology : public NumaTopology {
+ public:
+  int NumNodes() const override {
+    return port::NUMAEnabled() ? port::NUMANumNodes() : 1;
+  }
+
+  int GetThreadNodeAffinity() const override {
+    return port::NUMAGetThreadNodeAffinity();
+  }
+
+  void SetThreadNodeAffinity(int node) const override {
+    port::NUMASetThreadNodeAffinity(node);
+  }
+
+  int MaxParallelism(int node) const override {
+    return port::MaxParallelism(node);
+  }
+
+  Allocator* HostAllocator(int node) const override {
+    return cpu_allocator(node);
+  }
+};
+
+}  // namespace
+
+const NumaTopology* NumaTopology::Default() {
+  static const NumaTopology* topology = new PlatformNumaTopology();
+  return topology;
+}
+
+int NumaNodeForPipeline(const NumaTopology& topology) {
+  const int num_nodes = topology.NumNodes();
+  if (num_nodes < 2) {
+    return port::kNUMANoAffinity;
+  }
+  const int node = topology.GetThreadNodeAffinity();
+  if (node != port::kNUMANoAffinity) {
+    return node;
+  }
+  static std::atomic<int> next_node(0);
+  return next_node.fetch_add(1, std::memory_order_relaxed) % num_nodes;
+}
+
+NumaThreadFactory::NumaThreadFactory(std::shared_ptr<ThreadFactory> base,
+                                     int numa_node,
+                                     const NumaTopology* topology)
+    : base_(std::move(base)), numa_node_(numa_node), topology_(topology) {}
+
+std::unique_ptr<Thread> NumaThreadFactory::StartThread(
+    const std::string& name, std::function<void()> fn) {
+  auto bound_fn = [numa_node = numa_node_, topology = topology_,
+                   fn = std::move(fn)]() {
+    const int previous_node = topology->GetThreadNodeAffinity();
+    topology->SetThreadNodeAffinity(numa_node);
+    fn();
+    topology->SetThreadNodeAffinity(previous_node);
+  };
+  if (base_) {
+    return base_->StartThread(name, std::move(bound_fn));
+  }
+  return std::unique_ptr<Thread>(
+      Env::Default()->StartThread({}, name, std::move(bound_fn)));
+}
+
+std::function<Allocator*(AllocatorAttributes)> NumaAllocatorGetter(
+    std::function<Allocator*(AllocatorAttributes)> allocator_getter,
+    int numa_node, const NumaTopology* topology) {
+  return [numa_node, topology, allocator_getter = std::move(allocator_getter)](
+             AllocatorAttributes attrs) {
+    Allocator* allocator = allocator_getter(attrs);
+    if (allocator->GetMemoryType() == AllocatorMemoryType::kHostPageable) {
+      return topology->HostAllocator(numa_node);
+    }
+    return allocator;
+  };
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,91 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_NUMA_UTILS_H_
+#define TENSORFLOW_CORE_DATA_NUMA_UTILS_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/thread_factory.h"
+
+namespace tensorflow {
+namespace data {
+
+// The NUMA topology of the host, which NUMA-aware input pipelines run on.
+// Tests replace it with a fake topology.
+class NumaTopology {
+ public:
+  virtual ~NumaTopology() = default;
+
+  // Returns the topology of the host.
+  static const NumaTopology* Default();
+
+  // Returns the number of NUMA nodes, or 1 if NUMA is not enabled.
+  virtual int NumNodes() const = 0;
+
+  // Returns the node the calling thread is bound to, or
+  // `port::kNUMANoAffinity`.
+  virtual int GetThreadNodeAffinity() const = 0;
+
+  // Binds the calling thread to `node`, or unbinds it if `node` is
+  // `port::kNUMANoAffinity`.
+  virtual void SetThreadNodeAffinity(int node) const = 0;
+
+  // Returns the number of threads which can run in parallel on `node`.
+  virtual int MaxParallelism(int node) const = 0;
+
+  // Returns the allocator of host memory local to `node`.
+  virtual Allocator* HostAllocator(int node) const = 0;
+};
+
+// Returns the NUMA node to run a new input pipeline on: the node of the calling
+// thread if it is bound to one, so that the pipeline produces its elements on
+// the node that consumes them, and otherwise the next node in round-robin
+// order, so that pipelines are spread across nodes. Returns
+// `port::kNUMANoAffinity` if the host has a single node.
+int NumaNodeForPipeline(const NumaTopology& topology);
+
+// Starts logical threads bound to a NUMA node. The threads of `base` may be
+// shared with other pipelines, so the binding only lasts for the duration of
+// the thread function, after which the previous binding is restored. Starts
+// threads with the default `Env` if `base` is null.
+class NumaThreadFactory : public ThreadFactory {
+ public:
+  // Does not take ownership of `topology`, which must outlive the threads.
+  NumaThreadFactory(std::shared_ptr<ThreadFactory> base, int numa_node,
+                    const NumaTopology* topology);
+
+  std::unique_ptr<Thread> StartThread(const std::string& name,
+                                      std::function<void()> fn) override;
+
+ private:
+  const std::shared_ptr<ThreadFactory> base_;
+  const int numa_node_;
+  const NumaTopology* const topology_;
+};
+
+// Returns an allocator getter which allocates host-pageable memory from the
+// allocator of `numa_node`, and other memory, e.g. device memory, from
+// `allocator_getter`. Does not take ownership of `topology`.
+std::function<Allocator*(AllocatorAttributes)> NumaAllocatorGetter(
+    std::function<Allocator*(AllocatorAttributes)> allocator_getter,
+    int numa_node, const NumaTopology* topology);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_NUMA_UTILS_H_
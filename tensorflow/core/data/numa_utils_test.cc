@@ -0,0 +1,200 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/numa_utils.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/data/unbounded_thread_pool.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// The node the calling thread is bound to in `FakeNumaTopology`.
+thread_local int thread_node = port::kNUMANoAffinity;
+
+// An allocator which counts its allocations.
+class FakeAllocator : public Allocator {
+ public:
+  explicit FakeAllocator(AllocatorMemoryType memory_type)
+      : memory_type_(memory_type) {}
+
+  std::string Name() override { return "fake"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocations_;
+    return port::AlignedMalloc(num_bytes, alignment);
+  }
+
+  void DeallocateRaw(void* ptr) override { port::AlignedFree(ptr); }
+
+  AllocatorMemoryType GetMemoryType() const override { return memory_type_; }
+
+  int num_allocations() const { return num_allocations_; }
+
+ private:
+  const AllocatorMemoryType memory_type_;
+  int num_allocations_ = 0;
+};
+
+// A NUMA topology of `num_nodes` nodes with `num_cores_per_node` cores each.
+class FakeNumaTopology : public NumaTopology {
+ public:
+  FakeNumaTopology(int num_nodes, int num_cores_per_node)
+      : num_nodes_(num_nodes), num_cores_per_node_(num_cores_per_node) {
+    for (int i = 0; i < num_nodes; ++i) {
+      allocators_.push_back(std::make_unique<FakeAllocator>(
+          AllocatorMemoryType::kHostPageable));
+    }
+  }
+
+  int NumNodes() const override { return num_nodes_; }
+
+  int GetThreadNodeAffinity() const override { return thread_node; }
+
+  void SetThreadNodeAffinity(int node) const override { thread_node = node; }
+
+  int MaxParallelism(int node) const override { return num_cores_per_node_; }
+
+  Allocator* HostAllocator(int node) const override {
+    return allocators_[node].get();
+  }
+
+  FakeAllocator* allocator(int node) const { return allocators_[node].get(); }
+
+ private:
+  const int num_nodes_;
+  const int num_cores_per_node_;
+  std::vector<std::unique_ptr<FakeAllocator>> allocators_;
+};
+
+// Starts threads which are bound to `node` before they run their function,
+// and records the node they are bound to after it.
+class BoundThreadFactory : public ThreadFactory {
+ public:
+  explicit BoundThreadFactory(int node) : node_(node) {}
+
+  std::unique_ptr<Thread> StartThread(const std::string& name,
+                                      std::function<void()> fn) override {
+    return std::unique_ptr<Thread>(Env::Default()->StartThread(
+        {}, name, [this, fn = std::move(fn)]() {
+          thread_node = node_;
+          fn();
+          node_after_ = thread_node;
+        }));
+  }
+
+  // Returns the node the last thread was bound to after its function.
+  int node_after() const { return node_after_; }
+
+ private:
+  const int node_;
+  int node_after_ = port::kNUMANoAffinity;
+};
+
+TEST(NumaUtilsTest, SingleNode) {
+  FakeNumaTopology topology(/*num_nodes=*/1, /*num_cores_per_node=*/4);
+  EXPECT_EQ(NumaNodeForPipeline(topology), port::kNUMANoAffinity);
+}
+
+TEST(NumaUtilsTest, NodeOfBoundThread) {
+  FakeNumaTopology topology(/*num_nodes=*/4, /*num_cores_per_node=*/4);
+  thread_node = 2;
+  EXPECT_EQ(NumaNodeForPipeline(topology), 2);
+  thread_node = port::kNUMANoAffinity;
+}
+
+TEST(NumaUtilsTest, RoundRobinNodes) {
+  FakeNumaTopology topology(/*num_nodes=*/2, /*num_cores_per_node=*/4);
+  const int node = NumaNodeForPipeline(topology);
+  EXPECT_GE(node, 0);
+  EXPECT_LT(node, 2);
+  EXPECT_EQ(NumaNodeForPipeline(topology), 1 - node);
+}
+
+TEST(NumaUtilsTest, ThreadFactoryBindsThreads) {
+  FakeNumaTopology topology(/*num_nodes=*/2, /*num_cores_per_node=*/4);
+  UnboundedThreadPool pool(Env::Default(), "numa_test");
+  NumaThreadFactory factory(pool.get_thread_factory(), /*numa_node=*/1,
+                            &topology);
+  const int kNumThreads = 4;
+  std::vector<int> nodes(kNumThreads, port::kNUMANoAffinity);
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int i = 0; i < kNumThreads; ++i) {
+      threads.push_back(factory.StartThread(
+          "numa_thread", [&nodes, i]() { nodes[i] = thread_node; }));
+    }
+  }
+  for (int node : nodes) {
+    EXPECT_EQ(node, 1);
+  }
+}
+
+TEST(NumaUtilsTest, ThreadFactoryWithoutBase) {
+  FakeNumaTopology topology(/*num_nodes=*/2, /*num_cores_per_node=*/4);
+  NumaThreadFactory factory(/*base=*/nullptr, /*numa_node=*/1, &topology);
+  int node = port::kNUMANoAffinity;
+  factory.StartThread("numa_thread", [&node]() { node = thread_node; });
+  EXPECT_EQ(node, 1);
+}
+
+TEST(NumaUtilsTest, ThreadFactoryRestoresBinding) {
+  FakeNumaTopology topology(/*num_nodes=*/2, /*num_cores_per_node=*/4);
+  auto base = std::make_shared<BoundThreadFactory>(/*node=*/0);
+  NumaThreadFactory factory(base, /*numa_node=*/1, &topology);
+  int node = port::kNUMANoAffinity;
+  factory.StartThread("numa_thread", [&node]() { node = thread_node; });
+  EXPECT_EQ(node, 1);
+  EXPECT_EQ(base->node_after(), 0);
+}
+
+TEST(NumaUtilsTest, AllocatorGetter) {
+  FakeNumaTopology topology(/*num_nodes=*/2, /*num_cores_per_node=*/4);
+  FakeAllocator host_allocator(AllocatorMemoryType::kHostPageable);
+  FakeAllocator device_allocator(AllocatorMemoryType::kDevice);
+  auto allocator_getter = NumaAllocatorGetter(
+      [&](AllocatorAttributes attrs) -> Allocator* {
+        return attrs.on_host() ? &host_allocator : &device_allocator;
+      },
+      /*numa_node=*/1, &topology);
+
+  AllocatorAttributes host_attrs;
+  host_attrs.set_on_host(true);
+  Allocator* allocator = allocator_getter(host_attrs);
+  EXPECT_EQ(allocator, topology.allocator(1));
+  void* ptr = allocator->AllocateRaw(Allocator::kAllocatorAlignment,
+                                     /*num_bytes=*/64);
+  allocator->DeallocateRaw(ptr);
+  EXPECT_EQ(topology.allocator(1)->num_allocations(), 1);
+  EXPECT_EQ(topology.allocator(0)->num_allocations(), 0);
+  EXPECT_EQ(host_allocator.num_allocations(), 0);
+
+  // Device memory is not allocated on the node.
+  EXPECT_EQ(allocator_getter(AllocatorAttributes()), &device_allocator);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
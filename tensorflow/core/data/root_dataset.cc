@@ -25,7 +25,9 @@ limitations under the License.
 
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/numa_utils.h"
 #include "tensorflow/core/data/rewrite_utils.h"
+#include "tensorflow/core/data/work_stealing_scheduler.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/framework/model.h"
@@ -33,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/stringprintf.h"
@@ -71,6 +74,8 @@ void SetRootDatasetParams(const Options& options, RootDataset::Params* params) {
     params->private_threadpool_size =
         options.threading_options().private_threadpool_size();
   }
+  params->numa_aware = ShouldUseNumaAwareThreading(options);
+  params->work_stealing = ShouldUseWorkStealingScheduler(options);
   params->autotune = ShouldUseAutotuning(options);
   params->autotune_algorithm = model::AutotuneAlgorithm::DEFAULT;
   auto experiments = GetExperiments();
@@ -172,12 +177,26 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
           value_or_default(dataset()->params_.max_intra_op_parallelism, 0,
                            port::MaxParallelism());
     }
-    if (dataset()->params_.private_threadpool_size >= 0) {
+    if (dataset()->params_.numa_aware) {
+      numa_node_ = NumaNodeForPipeline(*NumaTopology::Default());
+      VLOG(2) << "Running input pipeline on NUMA node " << numa_node_;
+    }
+    if (dataset()->params_.private_threadpool_size >= 0 ||
+        numa_node_ != port::kNUMANoAffinity) {
+      // A NUMA-aware pipeline gets a private threadpool bound to its node,
+      // sized to the cores of that node unless the size is set explicitly.
+      const int max_parallelism =
+          NumaTopology::Default()->MaxParallelism(numa_node_);
       threadpool_size_ =
           value_or_default(dataset()->params_.private_threadpool_size, 0,
-                           port::MaxParallelism());
+                           max_parallelism);
+      if (threadpool_size_ < 0) {
+        threadpool_size_ = max_parallelism;
+      }
+      ThreadOptions thread_options;
+      thread_options.numa_node = numa_node_;
       thread_pool_ = std::make_unique<thread::ThreadPool>(
-          Env::Default(), ThreadOptions{}, "data_private_threadpool",
+          Env::Default(), thread_options, "data_private_threadpool",
           threadpool_size_);
     }
     cancellation_manager_ = std::make_unique<CancellationManager>();
@@ -315,16 +334,51 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
     // been set to a valid model in `Initialize()` if autotuning is on. We
     // should simply set `params.model` to `model_` here.
     params.model = model_;
-    if (dataset()->params_.private_threadpool_size >= 0) {
+    if (thread_pool_) {
       params.runner = [pool = thread_pool_.get()](std::function<void()> c) {
         pool->Schedule(std::move(c));
       };
       params.runner_threadpool_size = threadpool_size_;
+    } else if (dataset()->params_.work_stealing) {
+      WorkStealingScheduler* scheduler = WorkStealingScheduler::Global();
+      params.runner = [scheduler](std::function<void()> c) {
+        scheduler->Schedule(std::move(c));
+      };
+      params.runner_threadpool_size = scheduler->NumThreads();
+      // Parallel iterators bind their runner to their model node, so that
+      // the scheduler prioritizes their work by the state of their buffers.
+      params.node_runner_factory =
+          [scheduler,
+           max_parallelism =
+               dataset()->params_.max_intra_op_parallelism >= 0
+                   ? max_intra_op_parallelism_
+                   : -1](std::shared_ptr<model::Node> node) {
+            std::function<void(std::function<void()>)> runner =
+                [scheduler, node = std::move(node)](std::function<void()> c) {
+                  scheduler->Schedule(std::move(c), node);
+                };
+            if (max_parallelism >= 0) {
+              runner = RunnerWithMaxParallelism(std::move(runner),
+                                                max_parallelism);
+            }
+            return runner;
+          };
     }
     if (dataset()->params_.max_intra_op_parallelism >= 0) {
       params.runner =
           RunnerWithMaxParallelism(params.runner, max_intra_op_parallelism_);
     }
+    if (numa_node_ != port::kNUMANoAffinity) {
+      params.thread_factory = std::make_shared<NumaThreadFactory>(
+          params.thread_factory, numa_node_, NumaTopology::Default());
+      // Elements produced in host memory are allocated on the node of the
+      // pipeline. Other memory types, e.g. device memory, are unchanged.
+      if (params.allocator_getter) {
+        params.allocator_getter =
+            NumaAllocatorGetter(std::move(params.allocator_getter),
+                                numa_node_, NumaTopology::Default());
+      }
+    }
     return params;
   }
 
@@ -365,6 +419,8 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
   std::unique_ptr<Thread> model_thread_ TF_GUARDED_BY(mu_);
   int64_t max_intra_op_parallelism_;
   int64_t threadpool_size_;
+  // The NUMA node the pipeline runs on, if `numa_aware` is set.
+  int numa_node_ = port::kNUMANoAffinity;
   std::unique_ptr<thread::ThreadPool> thread_pool_;
 
   // The end time of the previous `GetNextInternal` call.
@@ -40,6 +40,13 @@ class RootDataset : public DatasetBase {
     int64_t autotune_ram_budget_from_options;
     int64_t max_intra_op_parallelism = 1;
     int64_t private_threadpool_size = 0;
+    // Whether to run the threads of the pipeline on a single NUMA node and to
+    // allocate its elements from memory local to that node.
+    bool numa_aware = false;
+    // Whether to schedule the work of the pipeline on the work-stealing
+    // scheduler shared by the process. Ignored if the pipeline has a private
+    // threadpool.
+    bool work_stealing = false;
 
     int64_t ComputeInitialAutotuneRamBudget() const {
       if (autotune_ram_budget_from_options > 0) {
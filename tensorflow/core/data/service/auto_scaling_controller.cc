@@ -0,0 +1,236 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/auto_scaling_controller.h"
+
+#include <algorithm>
+#include <csignal>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_replace.h"
+#include "absl/time/time.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/net.h"
+#include "tsl/platform/subprocess.h"
+#include "tsl/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+LocalProcessWorkerLauncher::LocalProcessWorkerLauncher(
+    const std::vector<std::string>& argv)
+    : argv_(argv) {}
+
+LocalProcessWorkerLauncher::~LocalProcessWorkerLauncher() {
+  tsl::mutex_lock l(mu_);
+  for (auto& [port, process] : processes_) {
+    process->Kill(SIGTERM);
+    process->Wait();
+  }
+}
+
+tsl::Status LocalProcessWorkerLauncher::AddWorkers(int64_t num_workers) {
+  if (argv_.empty()) {
+    return absl::FailedPreconditionError(
+        "The tf.data service worker command line is empty.");
+  }
+  tsl::mutex_lock l(mu_);
+  for (int64_t i = 0; i < num_workers; ++i) {
+    int port = tsl::internal::PickUnusedPortOrDie();
+    std::vector<std::string> argv;
+    argv.reserve(argv_.size());
+    for (const std::string& arg : argv_) {
+      argv.push_back(
+          absl::StrReplaceAll(arg, {{"%port%", absl::StrCat(port)}}));
+    }
+    auto process = std::make_unique<tsl::SubProcess>();
+    process->SetProgram(argv[0], argv);
+    process->SetChannelAction(tsl::CHAN_STDOUT, tsl::ACTION_DUPPARENT);
+    process->SetChannelAction(tsl::CHAN_STDERR, tsl::ACTION_DUPPARENT);
+    if (!process->Start()) {
+      return absl::InternalError(
+          absl::StrCat("Failed to start tf.data service worker: ",
+                       absl::StrJoin(argv, " ")));
+    }
+    LOG(INFO) << "Started tf.data service worker on port " << port;
+    processes_[port] = std::move(process);
+  }
+  return tsl::OkStatus();
+}
+
+tsl::Status LocalProcessWorkerLauncher::RemoveWorker(
+    const std::string& worker_address) {
+  int port = 0;
+  size_t port_start = worker_address.rfind(':');
+  if (port_start == std::string::npos ||
+      !absl::SimpleAtoi(worker_address.substr(port_start + 1), &port)) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Failed to parse the port of worker address ", worker_address));
+  }
+  std::unique_ptr<tsl::SubProcess> process;
+  {
+    tsl::mutex_lock l(mu_);
+    auto it = processes_.find(port);
+    if (it == processes_.end()) {
+      return absl::NotFoundError(absl::StrCat(
+          "Worker with address ", worker_address, " was not launched locally"));
+    }
+    process = std::move(it->second);
+    processes_.erase(it);
+  }
+  process->Kill(SIGTERM);
+  process->Wait();
+  LOG(INFO) << "Stopped tf.data service worker " << worker_address;
+  return tsl::OkStatus();
+}
+
+std::string ScalingDecision::DebugString() const {
+  return absl::StrCat("target_num_workers: ", target_num_workers,
+                      ", num_workers_to_add: ", num_workers_to_add,
+                      ", workers_to_drain: [",
+                      absl::StrJoin(workers_to_drain, ", "),
+                      "], workers_to_remove: [",
+                      absl::StrJoin(workers_to_remove, ", "), "]");
+}
+
+AutoScalingController::AutoScalingController(
+    const AutoScalingOptions& options, std::unique_ptr<WorkerLauncher> launcher)
+    : options_(options), launcher_(std::move(launcher)) {
+  DCHECK_LE(options_.min_workers, options_.max_workers);
+  DCHECK_GT(options_.max_step, 0);
+}
+
+ScalingDecision AutoScalingController::Recommend(
+    const std::vector<WorkerLoad>& workers,
+    std::optional<int64_t> optimal_number_of_workers,
+    std::optional<double> buffer_fill, absl::Time now) const
+    TF_LOCKS_EXCLUDED(mu_) {
+  ScalingDecision decision;
+  std::vector<WorkerLoad> active_workers;
+  tsl::mutex_lock l(mu_);
+  for (const WorkerLoad& worker : workers) {
+    auto removed = removed_workers_.find(worker.address);
+    if (removed != removed_workers_.end() &&
+        worker.last_heartbeat <= removed->second) {
+      continue;
+    }
+    auto it = draining_workers_.find(worker.address);
+    if (it == draining_workers_.end()) {
+      active_workers.push_back(worker);
+    } else if (worker.num_tasks == 0 ||
+               now - it->second >= options_.drain_timeout) {
+      decision.workers_to_remove.push_back(worker.address);
+    }
+  }
+
+  const int64_t current_num_workers = active_workers.size();
+  decision.target_num_workers = current_num_workers;
+  if (now - last_scaling_time_ < options_.cooldown) {
+    return decision;
+  }
+
+  int64_t target = optimal_number_of_workers.value_or(current_num_workers);
+  if (buffer_fill.has_value()) {
+    if (*buffer_fill < options_.starved_buffer_fill) {
+      target = std::max(target, current_num_workers + 1);
+    } else if (*buffer_fill > options_.saturated_buffer_fill) {
+      target = std::min(target, current_num_workers);
+    }
+  }
+  target = std::clamp(target, current_num_workers - options_.max_step,
+                      current_num_workers + options_.max_step);
+  target = std::clamp(target, options_.min_workers, options_.max_workers);
+  decision.target_num_workers = target;
+
+  if (target > current_num_workers) {
+    decision.num_workers_to_add = target - current_num_workers;
+  } else if (target < current_num_workers) {
+    // Drains the least loaded workers, which finish draining first.
+    std::sort(active_workers.begin(), active_workers.end(),
+              [](const WorkerLoad& a, const WorkerLoad& b) {
+                if (a.num_tasks != b.num_tasks) {
+                  return a.num_tasks < b.num_tasks;
+                }
+                return a.address < b.address;
+              });
+    // Workers whose tasks cannot be moved are kept.
+    int64_t num_workers_to_drain = current_num_workers - target;
+    for (const WorkerLoad& worker : active_workers) {
+      if (num_workers_to_drain == 0) {
+        break;
+      }
+      if (worker.drainable) {
+        decision.workers_to_drain.push_back(worker.address);
+        --num_workers_to_drain;
+      }
+    }
+    decision.target_num_workers = target + num_workers_to_drain;
+  }
+  return decision;
+}
+
+tsl::Status AutoScalingController::Actuate(const ScalingDecision& decision,
+                                           absl::Time now)
+    TF_LOCKS_EXCLUDED(mu_) {
+  if (decision.IsEmpty()) {
+    return tsl::OkStatus();
+  }
+  VLOG(1) << "tf.data service auto-scaling decision: "
+          << decision.DebugString();
+  {
+    tsl::mutex_lock l(mu_);
+    if (decision.num_workers_to_add > 0 || !decision.workers_to_drain.empty()) {
+      last_scaling_time_ = now;
+    }
+    for (const std::string& worker_address : decision.workers_to_drain) {
+      draining_workers_.emplace(worker_address, now);
+    }
+  }
+
+  tsl::Status status;
+  if (decision.num_workers_to_add > 0) {
+    status.Update(launcher_->AddWorkers(decision.num_workers_to_add));
+  }
+  for (const std::string& worker_address : decision.workers_to_remove) {
+    tsl::Status s = launcher_->RemoveWorker(worker_address);
+    if (!s.ok()) {
+      // Keeps draining the worker, so that removing it is retried.
+      status.Update(s);
+      continue;
+    }
+    tsl::mutex_lock l(mu_);
+    draining_workers_.erase(worker_address);
+    removed_workers_[worker_address] = now;
+  }
+  return status;
+}
+
+bool AutoScalingController::IsDraining(const std::string& worker_address) const
+    TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  return draining_workers_.contains(worker_address);
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,176 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_AUTO_SCALING_CONTROLLER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_AUTO_SCALING_CONTROLLER_H_
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/time/time.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/status.h"
+#include "tsl/platform/subprocess.h"
+#include "tsl/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Starts and stops tf.data service workers on behalf of the
+// `AutoScalingController`. Implementations may block; they are never called
+// while the dispatcher holds its lock.
+class WorkerLauncher {
+ public:
+  virtual ~WorkerLauncher() = default;
+
+  // Starts `num_workers` new workers. The workers are expected to register
+  // with the dispatcher on their own.
+  virtual tsl::Status AddWorkers(int64_t num_workers) = 0;
+
+  // Stops the worker with `worker_address`. It is called once the worker has
+  // been drained, or its drain has timed out.
+  virtual tsl::Status RemoveWorker(const std::string& worker_address) = 0;
+};
+
+// Launches workers as processes on the dispatcher's host.
+//
+// Each worker runs `argv`, in which the substring "%port%" is replaced with an
+// unused port. The worker address is expected to end with ":<port>", so that
+// `RemoveWorker` can find the process serving it.
+class LocalProcessWorkerLauncher : public WorkerLauncher {
+ public:
+  explicit LocalProcessWorkerLauncher(const std::vector<std::string>& argv);
+  ~LocalProcessWorkerLauncher() override;
+
+  tsl::Status AddWorkers(int64_t num_workers) override;
+  tsl::Status RemoveWorker(const std::string& worker_address) override;
+
+ private:
+  const std::vector<std::string> argv_;
+
+  tsl::mutex mu_;
+  // Map from port to the worker process listening on it.
+  absl::flat_hash_map<int, std::unique_ptr<tsl::SubProcess>> processes_
+      TF_GUARDED_BY(mu_);
+};
+
+struct AutoScalingOptions {
+  // Bounds on the number of active (non-draining) workers.
+  int64_t min_workers = 1;
+  int64_t max_workers = std::numeric_limits<int64_t>::max();
+  // Maximum number of workers added or drained by one decision.
+  int64_t max_step = 16;
+  // Consumers whose buffers are on average less full than this are starved:
+  // the controller adds a worker even if `AutoScaler` does not ask for one, and
+  // never drains workers.
+  double starved_buffer_fill = 0.2;
+  // Consumers whose buffers are on average fuller than this do not wait for
+  // data: the controller does not add workers.
+  double saturated_buffer_fill = 0.8;
+  // Minimum time between two scaling actions. It should be larger than the
+  // time it takes a new worker to start and report its processing times.
+  absl::Duration cooldown = absl::Minutes(2);
+  // Draining workers are stopped after this long, even if they still have
+  // tasks. It bounds the drain if moving a task away from the worker stalls.
+  absl::Duration drain_timeout = absl::Minutes(10);
+};
+
+// State of a registered worker, as seen by the dispatcher.
+struct WorkerLoad {
+  std::string address;
+  // Number of tasks of unfinished iterations assigned to the worker.
+  int64_t num_tasks = 0;
+  // Time of the latest heartbeat of the worker.
+  absl::Time last_heartbeat = absl::InfinitePast();
+  // False if some of the tasks cannot be moved to other workers, e.g. tasks
+  // reading a static or dynamic shard, or round-robin tasks. Such workers are
+  // never drained.
+  bool drainable = true;
+};
+
+struct ScalingDecision {
+  // Target number of active workers.
+  int64_t target_num_workers = 0;
+  // Number of workers to start.
+  int64_t num_workers_to_add = 0;
+  // Workers to stop receiving new tasks, and to stop once they have no tasks.
+  std::vector<std::string> workers_to_drain;
+  // Draining workers which can be stopped.
+  std::vector<std::string> workers_to_remove;
+
+  bool IsEmpty() const {
+    return num_workers_to_add == 0 && workers_to_drain.empty() &&
+           workers_to_remove.empty();
+  }
+  std::string DebugString() const;
+};
+
+// Acts on the estimate of `MultipleIterationsAutoScaler`, by adding or draining
+// workers through a `WorkerLauncher`.
+//
+// The estimate is checked against the fill of the consumers' element buffers:
+// starved consumers show that more workers are needed regardless of the
+// estimate, and full buffers show that consumers do not wait for data. Workers
+// are drained before they are stopped: the dispatcher stops assigning them new
+// tasks, and they are stopped once they have no tasks left.
+//
+// AutoScalingController is thread-safe.
+class AutoScalingController {
+ public:
+  AutoScalingController(const AutoScalingOptions& options,
+                        std::unique_ptr<WorkerLauncher> launcher);
+
+  // Returns the scaling actions to take at time `now`, given the registered
+  // `workers`, the `optimal_number_of_workers` estimated by the `AutoScaler`,
+  // and the mean `buffer_fill` of the consumers, between 0 and 1.
+  ScalingDecision Recommend(const std::vector<WorkerLoad>& workers,
+                            std::optional<int64_t> optimal_number_of_workers,
+                            std::optional<double> buffer_fill,
+                            absl::Time now) const TF_LOCKS_EXCLUDED(mu_);
+
+  // Takes the actions of `decision`. Workers being drained are reported by
+  // `IsDraining` until they are removed.
+  tsl::Status Actuate(const ScalingDecision& decision, absl::Time now)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns true if the worker with `worker_address` is being drained.
+  bool IsDraining(const std::string& worker_address) const
+      TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  const AutoScalingOptions options_;
+  const std::unique_ptr<WorkerLauncher> launcher_;
+
+  mutable tsl::mutex mu_;
+  // Time of the last scaling action.
+  absl::Time last_scaling_time_ TF_GUARDED_BY(mu_) = absl::InfinitePast();
+  // Map from the address of a draining worker to the time its drain started.
+  absl::flat_hash_map<std::string, absl::Time> draining_workers_
+      TF_GUARDED_BY(mu_);
+  // Map from the address of a removed worker to the time it was stopped. The
+  // dispatcher keeps a stopped worker until it misses its heartbeats.
+  absl::flat_hash_map<std::string, absl::Time> removed_workers_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_AUTO_SCALING_CONTROLLER_H_
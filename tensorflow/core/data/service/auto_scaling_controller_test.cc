@@ -0,0 +1,277 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/auto_scaling_controller.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/status.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tsl::testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// Records the calls of the controller instead of starting processes.
+class FakeWorkerLauncher : public WorkerLauncher {
+ public:
+  tsl::Status AddWorkers(int64_t num_workers) override {
+    num_added_workers_ += num_workers;
+    return tsl::OkStatus();
+  }
+
+  tsl::Status RemoveWorker(const std::string& worker_address) override {
+    if (!remove_status_.ok()) {
+      return remove_status_;
+    }
+    removed_workers_.push_back(worker_address);
+    return tsl::OkStatus();
+  }
+
+  int64_t num_added_workers_ = 0;
+  std::vector<std::string> removed_workers_;
+  tsl::Status remove_status_;
+};
+
+const absl::Time kStart = absl::FromUnixSeconds(1000);
+
+// Returns `num_workers` workers named "worker_<i>", with `i` tasks each.
+std::vector<WorkerLoad> Workers(int64_t num_workers) {
+  std::vector<WorkerLoad> workers;
+  for (int64_t i = 0; i < num_workers; ++i) {
+    workers.push_back({absl::StrCat("worker_", i), /*num_tasks=*/i, kStart});
+  }
+  return workers;
+}
+
+class AutoScalingControllerTest : public ::testing::Test {
+ protected:
+  void CreateController(const AutoScalingOptions& options) {
+    auto launcher = std::make_unique<FakeWorkerLauncher>();
+    launcher_ = launcher.get();
+    controller_ =
+        std::make_unique<AutoScalingController>(options, std::move(launcher));
+  }
+
+  FakeWorkerLauncher* launcher_ = nullptr;
+  std::unique_ptr<AutoScalingController> controller_;
+};
+
+TEST_F(AutoScalingControllerTest, NoEstimate) {
+  CreateController(AutoScalingOptions());
+  ScalingDecision decision = controller_->Recommend(
+      Workers(3), /*optimal_number_of_workers=*/std::nullopt,
+      /*buffer_fill=*/std::nullopt, kStart);
+  EXPECT_TRUE(decision.IsEmpty());
+  EXPECT_EQ(decision.target_num_workers, 3);
+}
+
+TEST_F(AutoScalingControllerTest, AddWorkersUpToEstimate) {
+  CreateController(AutoScalingOptions());
+  ScalingDecision decision = controller_->Recommend(
+      Workers(3), /*optimal_number_of_workers=*/5, /*buffer_fill=*/0.5, kStart);
+  EXPECT_EQ(decision.target_num_workers, 5);
+  EXPECT_EQ(decision.num_workers_to_add, 2);
+  EXPECT_THAT(decision.workers_to_drain, IsEmpty());
+  TF_ASSERT_OK(controller_->Actuate(decision, kStart));
+  EXPECT_EQ(launcher_->num_added_workers_, 2);
+}
+
+TEST_F(AutoScalingControllerTest, StarvedBuffers) {
+  CreateController(AutoScalingOptions());
+  ScalingDecision decision = controller_->Recommend(
+      Workers(3), /*optimal_number_of_workers=*/2, /*buffer_fill=*/0.1, kStart);
+  EXPECT_EQ(decision.num_workers_to_add, 1);
+  EXPECT_THAT(decision.workers_to_drain, IsEmpty());
+  decision = controller_->Recommend(
+      Workers(3), /*optimal_number_of_workers=*/std::nullopt,
+      /*buffer_fill=*/0.1, kStart);
+  EXPECT_EQ(decision.num_workers_to_add, 1);
+}
+
+TEST_F(AutoScalingControllerTest, SaturatedBuffers) {
+  CreateController(AutoScalingOptions());
+  ScalingDecision decision = controller_->Recommend(
+      Workers(3), /*optimal_number_of_workers=*/5, /*buffer_fill=*/0.9, kStart);
+  EXPECT_TRUE(decision.IsEmpty());
+  decision = controller_->Recommend(
+      Workers(3), /*optimal_number_of_workers=*/2, /*buffer_fill=*/0.9, kStart);
+  EXPECT_THAT(decision.workers_to_drain, ElementsAre("worker_0"));
+}
+
+TEST_F(AutoScalingControllerTest, Cooldown) {
+  AutoScalingOptions options;
+  options.cooldown = absl::Minutes(1);
+  CreateController(options);
+  ScalingDecision decision = controller_->Recommend(
+      Workers(3), /*optimal_number_of_workers=*/4, std::nullopt, kStart);
+  TF_ASSERT_OK(controller_->Actuate(decision, kStart));
+
+  decision = controller_->Recommend(Workers(4), /*optimal_number_of_workers=*/6,
+                                    std::nullopt, kStart + absl::Seconds(30));
+  EXPECT_TRUE(decision.IsEmpty());
+  decision = controller_->Recommend(Workers(4), /*optimal_number_of_workers=*/6,
+                                    std::nullopt, kStart + absl::Minutes(1));
+  EXPECT_EQ(decision.num_workers_to_add, 2);
+}
+
+TEST_F(AutoScalingControllerTest, Bounds) {
+  AutoScalingOptions options;
+  options.min_workers = 2;
+  options.max_workers = 10;
+  options.max_step = 3;
+  CreateController(options);
+  EXPECT_EQ(controller_
+                ->Recommend(Workers(5), /*optimal_number_of_workers=*/20,
+                            std::nullopt, kStart)
+                .target_num_workers,
+            8);
+  EXPECT_EQ(controller_
+                ->Recommend(Workers(9), /*optimal_number_of_workers=*/20,
+                            std::nullopt, kStart)
+                .target_num_workers,
+            10);
+  EXPECT_EQ(controller_
+                ->Recommend(Workers(5), /*optimal_number_of_workers=*/1,
+                            std::nullopt, kStart)
+                .target_num_workers,
+            2);
+  EXPECT_EQ(controller_
+                ->Recommend(Workers(0), /*optimal_number_of_workers=*/1,
+                            std::nullopt, kStart)
+                .num_workers_to_add,
+            2);
+}
+
+TEST_F(AutoScalingControllerTest, DrainLeastLoadedWorkers) {
+  CreateController(AutoScalingOptions());
+  std::vector<WorkerLoad> workers = Workers(4);
+  workers[3].num_tasks = 0;
+  ScalingDecision decision = controller_->Recommend(
+      workers, /*optimal_number_of_workers=*/2, std::nullopt, kStart);
+  EXPECT_THAT(decision.workers_to_drain, ElementsAre("worker_0", "worker_3"));
+  TF_ASSERT_OK(controller_->Actuate(decision, kStart));
+  EXPECT_TRUE(controller_->IsDraining("worker_0"));
+  EXPECT_FALSE(controller_->IsDraining("worker_1"));
+  EXPECT_FALSE(controller_->IsDraining("worker_2"));
+  EXPECT_TRUE(controller_->IsDraining("worker_3"));
+  EXPECT_THAT(launcher_->removed_workers_, IsEmpty());
+}
+
+TEST_F(AutoScalingControllerTest, DoNotDrainUndrainableWorkers) {
+  CreateController(AutoScalingOptions());
+  std::vector<WorkerLoad> workers = Workers(4);
+  workers[0].drainable = false;
+  workers[2].drainable = false;
+  ScalingDecision decision = controller_->Recommend(
+      workers, /*optimal_number_of_workers=*/1, std::nullopt, kStart);
+  EXPECT_THAT(decision.workers_to_drain, ElementsAre("worker_1", "worker_3"));
+  EXPECT_EQ(decision.target_num_workers, 2);
+}
+
+TEST_F(AutoScalingControllerTest, RemoveDrainedWorkers) {
+  AutoScalingOptions options;
+  options.cooldown = absl::ZeroDuration();
+  options.drain_timeout = absl::Minutes(10);
+  CreateController(options);
+  std::vector<WorkerLoad> workers = Workers(3);
+  ScalingDecision decision = controller_->Recommend(
+      workers, /*optimal_number_of_workers=*/1, std::nullopt, kStart);
+  EXPECT_THAT(decision.workers_to_drain, ElementsAre("worker_0", "worker_1"));
+  TF_ASSERT_OK(controller_->Actuate(decision, kStart));
+
+  // "worker_1" still has a task.
+  decision = controller_->Recommend(workers, /*optimal_number_of_workers=*/1,
+                                    std::nullopt, kStart + absl::Minutes(1));
+  EXPECT_THAT(decision.workers_to_remove, ElementsAre("worker_0"));
+  EXPECT_THAT(decision.workers_to_drain, IsEmpty());
+  EXPECT_EQ(decision.num_workers_to_add, 0);
+  TF_ASSERT_OK(controller_->Actuate(decision, kStart + absl::Minutes(1)));
+  EXPECT_THAT(launcher_->removed_workers_, ElementsAre("worker_0"));
+  EXPECT_FALSE(controller_->IsDraining("worker_0"));
+
+  // The dispatcher keeps the stopped worker until it misses its heartbeats.
+  decision = controller_->Recommend(workers, /*optimal_number_of_workers=*/1,
+                                    std::nullopt, kStart + absl::Minutes(2));
+  EXPECT_TRUE(decision.IsEmpty());
+
+  // "worker_1" is stopped once its drain times out.
+  decision = controller_->Recommend(workers, /*optimal_number_of_workers=*/1,
+                                    std::nullopt, kStart + absl::Minutes(10));
+  EXPECT_THAT(decision.workers_to_remove, ElementsAre("worker_1"));
+}
+
+TEST_F(AutoScalingControllerTest, RetryFailedRemoval) {
+  AutoScalingOptions options;
+  options.cooldown = absl::ZeroDuration();
+  CreateController(options);
+  std::vector<WorkerLoad> workers = Workers(2);
+  ScalingDecision decision = controller_->Recommend(
+      workers, /*optimal_number_of_workers=*/1, std::nullopt, kStart);
+  TF_ASSERT_OK(controller_->Actuate(decision, kStart));
+
+  launcher_->remove_status_ = absl::UnavailableError("Failed to stop worker");
+  decision = controller_->Recommend(workers, /*optimal_number_of_workers=*/1,
+                                    std::nullopt, kStart);
+  EXPECT_THAT(decision.workers_to_remove, ElementsAre("worker_0"));
+  EXPECT_THAT(controller_->Actuate(decision, kStart),
+              StatusIs(absl::StatusCode::kUnavailable));
+  EXPECT_TRUE(controller_->IsDraining("worker_0"));
+
+  launcher_->remove_status_ = tsl::OkStatus();
+  decision = controller_->Recommend(workers, /*optimal_number_of_workers=*/1,
+                                    std::nullopt, kStart);
+  EXPECT_THAT(decision.workers_to_remove, ElementsAre("worker_0"));
+  TF_ASSERT_OK(controller_->Actuate(decision, kStart));
+  EXPECT_THAT(launcher_->removed_workers_, ElementsAre("worker_0"));
+}
+
+TEST_F(AutoScalingControllerTest, RestartedWorker) {
+  AutoScalingOptions options;
+  options.cooldown = absl::ZeroDuration();
+  CreateController(options);
+  std::vector<WorkerLoad> workers = Workers(2);
+  ScalingDecision decision = controller_->Recommend(
+      workers, /*optimal_number_of_workers=*/1, std::nullopt, kStart);
+  TF_ASSERT_OK(controller_->Actuate(decision, kStart));
+  decision = controller_->Recommend(workers, /*optimal_number_of_workers=*/1,
+                                    std::nullopt, kStart + absl::Seconds(1));
+  TF_ASSERT_OK(controller_->Actuate(decision, kStart + absl::Seconds(1)));
+  EXPECT_THAT(launcher_->removed_workers_, ElementsAre("worker_0"));
+
+  // A worker heartbeating from the same address after its removal is active.
+  workers[0].last_heartbeat = kStart + absl::Seconds(2);
+  decision = controller_->Recommend(workers, /*optimal_number_of_workers=*/2,
+                                    std::nullopt, kStart + absl::Seconds(2));
+  EXPECT_TRUE(decision.IsEmpty());
+  EXPECT_EQ(decision.target_num_workers, 2);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
 #include "tensorflow/core/data/service/grpc_util.h"
+#include "tensorflow/core/data/service/shm_data_transfer.h"
 #include "tensorflow/core/data/service/worker_client.h"
 #include "tensorflow/core/data/service/worker_impl.h"
 #include "tensorflow/core/data/utils.h"
@@ -380,6 +381,13 @@ DataServiceClient::CreateWorkerClient(const TaskInfo& task_info) {
     return CreateAlternativeWorkerClientWithGrpcFallback(transfer_server,
                                                          task_info);
   }
+  if (StatusOr<DataTransferServerInfo> shm_transfer_server =
+          GetTransferServer(kShmTransferProtocol, task_info);
+      shm_transfer_server.ok() &&
+      IsLocalShmTransferServer(*shm_transfer_server)) {
+    return CreateAlternativeWorkerClientWithGrpcFallback(*shm_transfer_server,
+                                                         task_info);
+  }
   if (std::string default_protocol = DefaultDataTransferProtocol();
       default_protocol != kGrpcTransferProtocol) {
     StatusOr<DataTransferServerInfo> transfer_server =
@@ -442,6 +450,13 @@ void DataServiceClient::Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
     mutex_lock l(mu_);
     double target_processing_time_nsec = ctx_->GetTargetProcessingTimeNsec();
     req.set_target_processing_time_nsec(target_processing_time_nsec);
+    // Round-robin reads pre-allocate results for outstanding requests, so
+    // `results_` does not reflect how many elements are buffered.
+    if (!IsCoordinatedRead() && max_outstanding_requests_ > 0) {
+      double buffer_fill =
+          static_cast<double>(results_.size()) / max_outstanding_requests_;
+      req.set_buffer_fill(std::min(buffer_fill, 1.0));
+    }
   }
   ClientHeartbeatResponse resp;
   Status s = dispatcher_->ClientHeartbeat(req, resp);
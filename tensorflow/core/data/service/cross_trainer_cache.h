@@ -15,19 +15,29 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <deque>
 #include <functional>
+#include <iterator>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -46,6 +56,12 @@ namespace data {
 // collected when the cache becomes full. Consequently, trainers read from a
 // sliding window through the dataset and may not read the full dataset.
 //
+// Optionally, the cache has a second tier on local disk: elements leaving the
+// memory tier are serialized, compressed, and appended to segment files
+// instead of being discarded, so that trainers which fall behind the memory
+// tier keep reading the same data as the others. The disk tier has its own
+// byte budget, and discards its oldest segment when it is full.
+//
 // The `CrossTrainerCache` class is thread-safe.
 //
 // Example usage:
@@ -89,6 +105,32 @@ class CachableSequence {
 
   // Returns the estimated size of the element in bytes.
   virtual size_t GetElementSizeBytes(const ElementType&) const = 0;
+
+  // Serializes an element moved to the disk tier of the cache. Only required
+  // if the cache has a disk tier.
+  virtual StatusOr<std::string> Serialize(const ElementType&) const {
+    return errors::Unimplemented(
+        "The cachable sequence does not support the cross-trainer cache disk "
+        "tier.");
+  }
+
+  // Parses an element serialized by `Serialize`. May be called concurrently.
+  virtual StatusOr<ElementType> Deserialize(absl::string_view) const {
+    return errors::Unimplemented(
+        "The cachable sequence does not support the cross-trainer cache disk "
+        "tier.");
+  }
+};
+
+// Options of the disk tier of a `CrossTrainerCache`.
+struct CrossTrainerCacheDiskOptions {
+  // Local directory for the segment files. The disk tier is disabled if empty.
+  std::string directory;
+  // Maximum size of the disk tier in bytes, after compression.
+  size_t max_size_bytes = 0;
+  // Segments are closed once they reach this size. The disk tier frees space
+  // one segment at a time.
+  size_t segment_size_bytes = 64 << 20;
 };
 
 // Sliding-window cache shared across concurrent trainers.
@@ -101,6 +143,13 @@ class CrossTrainerCache {
   explicit CrossTrainerCache(
       size_t max_cache_size_bytes,
       std::unique_ptr<CachableSequence<ElementType>> cachable_sequence);
+
+  // Creates a `CrossTrainerCache` which moves elements evicted from memory to
+  // the disk tier described by `disk_options`.
+  CrossTrainerCache(
+      size_t max_cache_size_bytes,
+      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+      const CrossTrainerCacheDiskOptions& disk_options);
   virtual ~CrossTrainerCache() = default;
   CrossTrainerCache(const CrossTrainerCache&) = delete;
   CrossTrainerCache& operator=(const CrossTrainerCache&) = delete;
@@ -121,9 +170,51 @@ class CrossTrainerCache {
   bool IsCancelled() const;
 
  private:
+  // Location of an element in a disk segment.
+  struct DiskEntry {
+    uint64_t offset = 0;
+    uint64_t size_bytes = 0;
+    bool compressed = false;
+  };
+
+  // A file holding consecutive elements of the disk tier. The file is deleted
+  // when the segment is discarded, and no reader uses it any more. Segments
+  // are only destroyed without holding `mu_`.
+  struct DiskSegment {
+    ~DiskSegment();
+
+    std::string filename;
+    // Index of the first element of the segment within the dataset.
+    size_t start_index = 0;
+    // Guarded by `mu_` once the segment is in `disk_segments_`.
+    std::vector<DiskEntry> entries;
+    size_t size_bytes = 0;
+    // Only used by the thread extending the cache. Null once the segment is
+    // full.
+    std::unique_ptr<WritableFile> writer;
+    std::unique_ptr<RandomAccessFile> reader;
+  };
+
+  // A serialized element to be written to the disk tier.
+  struct SerializedElement {
+    std::string data;
+    bool compressed = false;
+  };
+
+  // An element written to the disk tier, to be added to `disk_segments_`.
+  struct DiskWrite {
+    std::shared_ptr<DiskSegment> segment;
+    // True if the element is the first one of `segment`.
+    bool new_segment = false;
+    DiskEntry entry;
+  };
+
   struct CacheQueryResult {
     std::shared_ptr<const ElementType> element;
-    bool cache_hit;
+    bool cache_hit = false;
+    // Set if the element has to be read from this disk segment.
+    std::shared_ptr<const DiskSegment> disk_segment;
+    DiskEntry disk_entry;
   };
 
   // Returns the next element and metrics about this query.
@@ -138,22 +229,58 @@ class CrossTrainerCache {
   // the cached elements).
   size_t GetElementIndex(const std::string& trainer_id);
 
-  // Returns the next element for `trainer_id`.
-  StatusOr<std::shared_ptr<const ElementType>> GetElement(
-      const std::string& trainer_id);
+  // Returns the next element for `trainer_id`, or its location on disk.
+  StatusOr<CacheQueryResult> GetElement(const std::string& trainer_id);
+
+  // Reads the element at `entry` of `segment`.
+  StatusOr<std::shared_ptr<const ElementType>> ReadFromDisk(
+      const DiskSegment& segment, const DiskEntry& entry) const;
 
   // Reads a new element and writes it into the cache.
   Status ExtendCache();
 
+  // Serializes the elements `FreeSpace` will evict from memory to insert an
+  // element of `new_element_size_bytes`. Sets `start_index` to the index of
+  // the first of them.
+  StatusOr<std::vector<SerializedElement>> SerializeElementsToFree(
+      size_t new_element_size_bytes, size_t& start_index);
+
+  // Appends `elements`, starting at `start_index`, to the segment files of the
+  // disk tier, without holding the lock. Records the written elements in
+  // `disk_writes`, which is shorter than `elements` if writing fails.
+  Status WriteToDisk(const std::vector<SerializedElement>& elements,
+                     size_t start_index, std::vector<DiskWrite>& disk_writes);
+
   // Frees old elements to keep the cache size below `max_cache_size_bytes_`.
   // `new_element_size_bytes` is the size of the new element being inserted.
-  void FreeSpace(size_t new_element_size_bytes);
+  // If the cache has a disk tier, `disk_writes` holds the elements to free
+  // which have been written to disk, and `disk_status` the result of writing
+  // the others. Segments discarded from the disk tier are moved to
+  // `discarded_segments`, to be deleted after releasing the lock.
+  void FreeSpace(size_t new_element_size_bytes,
+                 const std::vector<DiskWrite>& disk_writes,
+                 const Status& disk_status,
+                 std::vector<std::shared_ptr<DiskSegment>>& discarded_segments);
+
+  // Adds the element at `memory_start_index_`, written by `disk_write`, to the
+  // disk tier, and discards old segments to keep the disk tier within its
+  // budget.
+  void AddToDiskTier(
+      const DiskWrite& disk_write,
+      std::vector<std::shared_ptr<DiskSegment>>& discarded_segments);
+
+  // Discards all segments of the disk tier.
+  void ClearDiskTier(
+      std::vector<std::shared_ptr<DiskSegment>>& discarded_segments);
+
+  bool HasDiskTier() const { return !disk_options_.directory.empty(); }
 
   // Records the cache hit rate and cache size.
   void RecordMetrics(const CacheQueryResult& result);
 
   // Maximum cache size in bytes.
   const size_t max_cache_size_bytes_;
+  const CrossTrainerCacheDiskOptions disk_options_;
 
   // The element sequence over which the sliding window cache operates.
   std::unique_ptr<CachableSequence<ElementType>> cachable_sequence_;
@@ -165,17 +292,28 @@ class CrossTrainerCache {
   // return this status.
   Status status_ TF_GUARDED_BY(mu_) = OkStatus();
 
-  // `cache_` stores the cached elements.
+  // `cache_` stores the elements cached in memory. `disk_segments_` stores the
+  // elements before them, if the cache has a disk tier.
   std::deque<std::shared_ptr<const ElementType>> cache_ TF_GUARDED_BY(mu_);
   size_t cache_size_bytes_ TF_GUARDED_BY(mu_) = 0;
+  std::deque<std::shared_ptr<DiskSegment>> disk_segments_ TF_GUARDED_BY(mu_);
+  size_t disk_size_bytes_ TF_GUARDED_BY(mu_) = 0;
+  // Index of the first cached element, on disk or in memory.
   size_t cache_start_index_ TF_GUARDED_BY(mu_) = 0;
+  // Index of the first element cached in memory.
+  size_t memory_start_index_ TF_GUARDED_BY(mu_) = 0;
 
   // True if one thread is extending the cache.
   bool extending_cache_ TF_GUARDED_BY(mu_) = false;
 
+  // Segment the disk tier is appending to, and its size in bytes. Only
+  // accessed by the thread extending the cache.
+  std::shared_ptr<DiskSegment> writing_segment_;
+  size_t writing_segment_size_bytes_ = 0;
+
   // Maps trainer IDs to element indices. The indices are absolute indices
   // within the dataset. The actual index to use with `cache_` would be
-  // `trainer_to_element_index_map_[trainer_id] - cache_start_index_`.
+  // `trainer_to_element_index_map_[trainer_id] - memory_start_index_`.
   absl::flat_hash_map<std::string, size_t> trainer_to_element_index_map_
       TF_GUARDED_BY(mu_);
 };
@@ -184,7 +322,16 @@ template <class ElementType>
 CrossTrainerCache<ElementType>::CrossTrainerCache(
     size_t max_cache_size_bytes,
     std::unique_ptr<CachableSequence<ElementType>> cachable_sequence)
+    : CrossTrainerCache(max_cache_size_bytes, std::move(cachable_sequence),
+                        CrossTrainerCacheDiskOptions()) {}
+
+template <class ElementType>
+CrossTrainerCache<ElementType>::CrossTrainerCache(
+    size_t max_cache_size_bytes,
+    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+    const CrossTrainerCacheDiskOptions& disk_options)
     : max_cache_size_bytes_(max_cache_size_bytes),
+      disk_options_(disk_options),
       cachable_sequence_(std::move(cachable_sequence)) {
   DCHECK_GT(max_cache_size_bytes, 0)
       << "CrossTrainerCache size must be greater than 0.";
@@ -192,6 +339,14 @@ CrossTrainerCache<ElementType>::CrossTrainerCache(
           << ByteSize::Bytes(max_cache_size_bytes) << " of memory.";
 }
 
+template <class ElementType>
+CrossTrainerCache<ElementType>::DiskSegment::~DiskSegment() {
+  if (writer) {
+    writer->Close().IgnoreError();
+  }
+  Env::Default()->DeleteFile(filename).IgnoreError();
+}
+
 template <class ElementType>
 StatusOr<std::shared_ptr<const ElementType>>
 CrossTrainerCache<ElementType>::Get(const std::string& trainer_id)
@@ -212,20 +367,17 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
     const std::string& trainer_id) {
   bool should_extend_cache = false;
   while (true) {
+    std::optional<CacheQueryResult> result;
     {
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(status_);
       if (IsElementReady(trainer_id)) {
-        TF_ASSIGN_OR_RETURN(std::shared_ptr<const ElementType> element,
-                            GetElement(trainer_id));
-        return CacheQueryResult{element,
-                                /*is_cache_hit=*/!should_extend_cache};
-      }
-
-      // Extends the cache or waits for another thread to extend the cache. When
-      // concurrent trainers wait for the next element, only one of them should
-      // extend the cache.
-      if (extending_cache_) {
+        TF_ASSIGN_OR_RETURN(result, GetElement(trainer_id));
+        result->cache_hit = !should_extend_cache;
+      } else if (extending_cache_) {
+        // Extends the cache or waits for another thread to extend the cache.
+        // When concurrent trainers wait for the next element, only one of them
+        // should extend the cache.
         should_extend_cache = false;
         cv_.wait(l);
       } else {
@@ -234,6 +386,16 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
       }
     }
 
+    if (result.has_value()) {
+      if (result->disk_segment) {
+        // Reads from disk without holding the lock.
+        TF_ASSIGN_OR_RETURN(
+            result->element,
+            ReadFromDisk(*result->disk_segment, result->disk_entry));
+      }
+      return *std::move(result);
+    }
+
     if (should_extend_cache) {
       Status s = ExtendCache();
       mutex_lock l(mu_);
@@ -247,11 +409,11 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
 template <class ElementType>
 bool CrossTrainerCache<ElementType>::IsElementReady(
     const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-  return GetElementIndex(trainer_id) < cache_start_index_ + cache_.size();
+  return GetElementIndex(trainer_id) < memory_start_index_ + cache_.size();
 }
 
 template <class ElementType>
-StatusOr<std::shared_ptr<const ElementType>>
+StatusOr<typename CrossTrainerCache<ElementType>::CacheQueryResult>
 CrossTrainerCache<ElementType>::GetElement(const std::string& trainer_id)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   size_t element_index = GetElementIndex(trainer_id);
@@ -261,12 +423,62 @@ CrossTrainerCache<ElementType>::GetElement(const std::string& trainer_id)
         element_index);
   }
 
-  std::shared_ptr<const ElementType> result =
-      cache_[element_index - cache_start_index_];
+  CacheQueryResult result;
+  if (element_index >= memory_start_index_) {
+    result.element = cache_[element_index - memory_start_index_];
+  } else {
+    // Finds the last segment starting at or before `element_index`.
+    auto it = std::upper_bound(
+        disk_segments_.begin(), disk_segments_.end(), element_index,
+        [](size_t index, const std::shared_ptr<DiskSegment>& segment) {
+          return index < segment->start_index;
+        });
+    DCHECK(it != disk_segments_.begin());
+    const DiskSegment& segment = **std::prev(it);
+    result.disk_segment = *std::prev(it);
+    result.disk_entry = segment.entries[element_index - segment.start_index];
+  }
   trainer_to_element_index_map_[trainer_id] = element_index + 1;
   return result;
 }
 
+template <class ElementType>
+StatusOr<std::shared_ptr<const ElementType>>
+CrossTrainerCache<ElementType>::ReadFromDisk(const DiskSegment& segment,
+                                             const DiskEntry& entry) const {
+  std::string buffer;
+  buffer.resize(entry.size_bytes);
+  StringPiece data;
+  TF_RETURN_IF_ERROR(segment.reader->Read(entry.offset, entry.size_bytes,
+                                          &data, buffer.data()));
+  if (data.size() != entry.size_bytes) {
+    return errors::DataLoss("Truncated tf.data service cross-trainer cache "
+                            "segment ",
+                            segment.filename);
+  }
+  std::string uncompressed;
+  if (entry.compressed) {
+    size_t uncompressed_size = 0;
+    if (!port::Snappy_GetUncompressedLength(data.data(), data.size(),
+                                            &uncompressed_size)) {
+      return errors::DataLoss("Corrupted tf.data service cross-trainer cache "
+                              "segment ",
+                              segment.filename);
+    }
+    uncompressed.resize(uncompressed_size);
+    if (!port::Snappy_Uncompress(data.data(), data.size(),
+                                 uncompressed.data())) {
+      return errors::DataLoss("Corrupted tf.data service cross-trainer cache "
+                              "segment ",
+                              segment.filename);
+    }
+    data = uncompressed;
+  }
+  TF_ASSIGN_OR_RETURN(ElementType element,
+                      cachable_sequence_->Deserialize(data));
+  return std::make_shared<const ElementType>(std::move(element));
+}
+
 template <class ElementType>
 size_t CrossTrainerCache<ElementType>::GetElementIndex(
     const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -289,31 +501,194 @@ Status CrossTrainerCache<ElementType>::ExtendCache() TF_LOCKS_EXCLUDED(mu_) {
         " and cache size: ", max_cache_size_bytes_);
   }
 
+  // Only the thread extending the cache removes elements from it, so the
+  // elements to free can be serialized and written without holding the lock.
+  std::vector<DiskWrite> disk_writes;
+  Status disk_status;
+  if (HasDiskTier()) {
+    size_t start_index = 0;
+    TF_ASSIGN_OR_RETURN(
+        std::vector<SerializedElement> serialized_elements,
+        SerializeElementsToFree(new_element_size_bytes, start_index));
+    disk_status = WriteToDisk(serialized_elements, start_index, disk_writes);
+  }
+
+  // Destroyed after releasing the lock, as it deletes files.
+  std::vector<std::shared_ptr<DiskSegment>> discarded_segments;
   mutex_lock l(mu_);
   TF_RETURN_IF_ERROR(status_);
-  FreeSpace(new_element_size_bytes);
+  FreeSpace(new_element_size_bytes, disk_writes, disk_status,
+            discarded_segments);
   cache_.push_back(std::make_shared<ElementType>(std::move(element)));
   cache_size_bytes_ += new_element_size_bytes;
   return OkStatus();
 }
 
 template <class ElementType>
-void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
+StatusOr<
+    std::vector<typename CrossTrainerCache<ElementType>::SerializedElement>>
+CrossTrainerCache<ElementType>::SerializeElementsToFree(
+    size_t new_element_size_bytes, size_t& start_index) TF_LOCKS_EXCLUDED(mu_) {
+  std::vector<std::shared_ptr<const ElementType>> elements_to_free;
+  {
+    mutex_lock l(mu_);
+    start_index = memory_start_index_;
+    size_t cache_size_bytes = cache_size_bytes_;
+    for (const auto& element : cache_) {
+      if (cache_size_bytes + new_element_size_bytes <= max_cache_size_bytes_) {
+        break;
+      }
+      elements_to_free.push_back(element);
+      cache_size_bytes -= cachable_sequence_->GetElementSizeBytes(*element);
+    }
+  }
+
+  std::vector<SerializedElement> serialized_elements;
+  serialized_elements.reserve(elements_to_free.size());
+  for (const auto& element : elements_to_free) {
+    TF_ASSIGN_OR_RETURN(std::string serialized,
+                        cachable_sequence_->Serialize(*element));
+    SerializedElement& result = serialized_elements.emplace_back();
+    // Already compressed elements are stored as is.
+    result.compressed =
+        port::Snappy_Compress(serialized.data(), serialized.size(),
+                              &result.data) &&
+        result.data.size() < serialized.size();
+    if (!result.compressed) {
+      result.data = std::move(serialized);
+    }
+  }
+  return serialized_elements;
+}
+
+template <class ElementType>
+Status CrossTrainerCache<ElementType>::WriteToDisk(
+    const std::vector<SerializedElement>& elements, size_t start_index,
+    std::vector<DiskWrite>& disk_writes) TF_LOCKS_EXCLUDED(mu_) {
+  Env* env = Env::Default();
+  for (size_t i = 0; i < elements.size(); ++i) {
+    const SerializedElement& element = elements[i];
+    DiskWrite disk_write;
+    if (!writing_segment_) {
+      auto segment = std::make_shared<DiskSegment>();
+      segment->filename =
+          io::JoinPath(disk_options_.directory, "cross_trainer_cache_");
+      if (!env->CreateUniqueFileName(&segment->filename, ".segment")) {
+        return errors::Internal("Failed to create a unique file name in ",
+                                disk_options_.directory);
+      }
+      segment->start_index = start_index + i;
+      TF_RETURN_IF_ERROR(
+          env->NewWritableFile(segment->filename, &segment->writer));
+      TF_RETURN_IF_ERROR(
+          env->NewRandomAccessFile(segment->filename, &segment->reader));
+      writing_segment_ = std::move(segment);
+      writing_segment_size_bytes_ = 0;
+      disk_write.new_segment = true;
+    }
+
+    Status s = writing_segment_->writer->Append(element.data);
+    if (s.ok()) {
+      // Makes the element visible to `reader`.
+      s = writing_segment_->writer->Flush();
+    }
+    if (s.ok() && writing_segment_size_bytes_ + element.data.size() >=
+                      disk_options_.segment_size_bytes) {
+      s = writing_segment_->writer->Close();
+      writing_segment_->writer.reset();
+    }
+    if (!s.ok()) {
+      writing_segment_.reset();
+      return s;
+    }
+    disk_write.segment = writing_segment_;
+    disk_write.entry.offset = writing_segment_size_bytes_;
+    disk_write.entry.size_bytes = element.data.size();
+    disk_write.entry.compressed = element.compressed;
+    disk_writes.push_back(std::move(disk_write));
+    writing_segment_size_bytes_ += element.data.size();
+    if (!writing_segment_->writer) {
+      writing_segment_.reset();
+    }
+  }
+  return OkStatus();
+}
+
+template <class ElementType>
+void CrossTrainerCache<ElementType>::FreeSpace(
+    size_t new_element_size_bytes, const std::vector<DiskWrite>& disk_writes,
+    const Status& disk_status,
+    std::vector<std::shared_ptr<DiskSegment>>& discarded_segments)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   size_t num_elements_discarded = 0;
   while (!cache_.empty() &&
          cache_size_bytes_ + new_element_size_bytes > max_cache_size_bytes_) {
+    if (num_elements_discarded < disk_writes.size()) {
+      AddToDiskTier(disk_writes[num_elements_discarded], discarded_segments);
+    } else if (num_elements_discarded == disk_writes.size() &&
+               !disk_status.ok()) {
+      // Drops the disk tier, so that it does not skip this element.
+      LOG(WARNING) << "Failed to write to the tf.data service cross-trainer "
+                   << "cache disk tier: " << disk_status;
+      ClearDiskTier(discarded_segments);
+    }
     size_t free_bytes =
         cachable_sequence_->GetElementSizeBytes(*cache_.front());
     cache_.pop_front();
     cache_size_bytes_ -= free_bytes;
-    ++cache_start_index_;
+    ++memory_start_index_;
     ++num_elements_discarded;
   }
+  cache_start_index_ = disk_segments_.empty()
+                           ? memory_start_index_
+                           : disk_segments_.front()->start_index;
 
   VLOG(3) << "Freed " << num_elements_discarded << " element(s) from "
           << "tf.data service cross-trainer cache. Memory usage: "
-          << ByteSize::Bytes(cache_size_bytes_) << ".";
+          << ByteSize::Bytes(cache_size_bytes_)
+          << ". Disk usage: " << ByteSize::Bytes(disk_size_bytes_) << ".";
+}
+
+template <class ElementType>
+void CrossTrainerCache<ElementType>::AddToDiskTier(
+    const DiskWrite& disk_write,
+    std::vector<std::shared_ptr<DiskSegment>>& discarded_segments)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (disk_write.new_segment) {
+    DCHECK_EQ(disk_write.segment->start_index, memory_start_index_);
+    disk_segments_.push_back(disk_write.segment);
+  } else if (disk_segments_.empty() ||
+             disk_segments_.back() != disk_write.segment) {
+    // The segment has been discarded while the element was being written.
+    return;
+  }
+
+  DiskSegment& segment = *disk_segments_.back();
+  DCHECK_EQ(segment.start_index + segment.entries.size(), memory_start_index_);
+  segment.entries.push_back(disk_write.entry);
+  segment.size_bytes += disk_write.entry.size_bytes;
+  disk_size_bytes_ += disk_write.entry.size_bytes;
+  while (!disk_segments_.empty() &&
+         disk_size_bytes_ > disk_options_.max_size_bytes) {
+    disk_size_bytes_ -= disk_segments_.front()->size_bytes;
+    if (disk_segments_.front() == writing_segment_) {
+      writing_segment_.reset();
+    }
+    discarded_segments.push_back(std::move(disk_segments_.front()));
+    disk_segments_.pop_front();
+  }
+}
+
+template <class ElementType>
+void CrossTrainerCache<ElementType>::ClearDiskTier(
+    std::vector<std::shared_ptr<DiskSegment>>& discarded_segments)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  for (auto& segment : disk_segments_) {
+    discarded_segments.push_back(std::move(segment));
+  }
+  disk_segments_.clear();
+  disk_size_bytes_ = 0;
+  writing_segment_.reset();
 }
 
 template <class ElementType>
@@ -340,12 +715,19 @@ template <class ElementType>
 void CrossTrainerCache<ElementType>::RecordMetrics(
     const CacheQueryResult& result) {
   metrics::RecordTFDataServiceCrossTrainerCacheQuery(result.cache_hit);
+  metrics::RecordTFDataServiceCrossTrainerCacheTierQuery(
+      result.disk_segment ? "disk" : "memory");
   size_t cache_size_bytes = 0;
+  size_t disk_size_bytes = 0;
   {
     mutex_lock l(mu_);
     cache_size_bytes = cache_size_bytes_;
+    disk_size_bytes = disk_size_bytes_;
   }
   metrics::RecordTFDataServiceCrossTrainerCacheSizeBytes(cache_size_bytes);
+  if (HasDiskTier()) {
+    metrics::RecordTFDataServiceCrossTrainerCacheDiskSizeBytes(disk_size_bytes);
+  }
 }
 
 }  // namespace data
@@ -22,7 +22,9 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
@@ -30,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
@@ -61,6 +64,23 @@ class InfiniteRange : public CachableSequence<int64_t> {
   int64_t next_ = 0;
 };
 
+// `InfiniteRange` which can be moved to the disk tier of the cache. The
+// serialized elements are zero-padded so that they are compressible.
+class SerializableRange : public InfiniteRange {
+ public:
+  StatusOr<std::string> Serialize(const int64_t& element) const override {
+    return absl::StrCat(std::string(100, '0'), element);
+  }
+
+  StatusOr<int64_t> Deserialize(absl::string_view serialized) const override {
+    int64_t element = 0;
+    if (!absl::SimpleAtoi(serialized, &element)) {
+      return errors::DataLoss("Failed to parse ", serialized);
+    }
+    return element;
+  }
+};
+
 class TensorDataset : public CachableSequence<Tensor> {
  public:
   StatusOr<Tensor> GetNext() override { return Tensor("Test Tensor"); }
@@ -285,6 +305,82 @@ TEST(CrossTrainerCacheTest, CacheSizeMetrics) {
   }
 }
 
+CrossTrainerCacheDiskOptions DiskOptions(absl::string_view name,
+                                         size_t max_size_bytes) {
+  CrossTrainerCacheDiskOptions disk_options;
+  disk_options.directory = io::JoinPath(::testing::TempDir(), name);
+  TF_CHECK_OK(Env::Default()->RecursivelyCreateDir(disk_options.directory));
+  disk_options.max_size_bytes = max_size_bytes;
+  disk_options.segment_size_bytes = 256;
+  return disk_options;
+}
+
+TEST(CrossTrainerCacheTest, SlowTrainersReadFromDisk) {
+  CellReader<int64_t> cell_reader(
+      "/tensorflow/data/service/cross_trainer_cache_tier_queries");
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<SerializableRange>(),
+      DiskOptions("SlowTrainersReadFromDisk", /*max_size_bytes=*/1 << 20));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  EXPECT_EQ(cell_reader.Delta("memory"), 100);
+  EXPECT_EQ(cell_reader.Delta("disk"), 0);
+
+  // The elements evicted from memory are read from disk.
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  EXPECT_EQ(cell_reader.Delta("memory"), 5);
+  EXPECT_EQ(cell_reader.Delta("disk"), 95);
+
+  // The slow trainer catches up with the fast trainer.
+  for (int i = 100; i < 110; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+}
+
+TEST(CrossTrainerCacheTest, DiskTierBudget) {
+  CellReader<int64_t> cell_reader(
+      "/tensorflow/data/service/cross_trainer_cache_disk_size_bytes");
+  // Every disk segment exceeds the budget, so it is discarded right away.
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<SerializableRange>(),
+      DiskOptions("DiskTierBudget", /*max_size_bytes=*/1));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+    EXPECT_EQ(cell_reader.Read(), 0);
+  }
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(Gt(94))));
+}
+
+TEST(CrossTrainerCacheTest, DiskSizeMetrics) {
+  CellReader<int64_t> cell_reader(
+      "/tensorflow/data/service/cross_trainer_cache_disk_size_bytes");
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<SerializableRange>(),
+      DiskOptions("DiskSizeMetrics", /*max_size_bytes=*/1 << 20));
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_THAT(cache.Get("Trainer 1"), IsOkAndHolds(Pointee(i)));
+    EXPECT_EQ(cell_reader.Read(), 0);
+  }
+  EXPECT_THAT(cache.Get("Trainer 1"), IsOkAndHolds(Pointee(5)));
+  EXPECT_THAT(cell_reader.Read(), Gt(0));
+}
+
+TEST(CrossTrainerCacheTest, DiskTierRequiresSerialization) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/sizeof(int64_t),
+      std::make_unique<InfiniteRange>(),
+      DiskOptions("DiskTierRequiresSerialization", /*max_size_bytes=*/1 << 20));
+  EXPECT_THAT(cache.Get("Trainer 1"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Trainer 1"), StatusIs(error::UNIMPLEMENTED));
+}
+
 TEST(CrossTrainerCacheTest, ConcurrentReaders) {
   size_t num_trainers = 10;
   size_t num_elements_to_read = 200;
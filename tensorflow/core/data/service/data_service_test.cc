@@ -18,10 +18,12 @@ limitations under the License.
 
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "tensorflow/core/data/service/auto_scaling_controller.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
 #include "tensorflow/core/data/service/export.pb.h"
+#include "tensorflow/core/data/service/server_lib.h"
 #include "tensorflow/core/data/service/test_cluster.h"
 #include "tensorflow/core/data/service/test_util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -33,6 +35,8 @@ limitations under the License.
 #include "tensorflow/core/platform/tstring.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/data_service.pb.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
 
 namespace tensorflow {
 namespace data {
@@ -43,6 +47,7 @@ using ::tensorflow::data::testing::RangeDataset;
 using ::tensorflow::data::testing::RangeDatasetWithShardHint;
 using ::tensorflow::data::testing::WaitWhile;
 using ::tensorflow::testing::IsOkAndHolds;
+using ::tensorflow::testing::StatusIs;
 using ::testing::ElementsAre;
 using ::testing::ElementsAreArray;
 using ::testing::HasSubstr;
@@ -320,6 +325,92 @@ TEST(DataServiceTest, WorkerStateExport) {
               SizeIs(1));
 }
 
+TEST(DataServiceTest, AutoScalingAddsWorkers) {
+  TestCluster::Config config;
+  config.num_workers = 1;
+  AutoScalingOptions auto_scaling_options;
+  auto_scaling_options.min_workers = 3;
+  auto_scaling_options.cooldown = absl::ZeroDuration();
+  config.auto_scaling_options = auto_scaling_options;
+  TestCluster cluster(config);
+  TF_ASSERT_OK(cluster.Initialize());
+  TF_ASSERT_OK(cluster.ScaleWorkers());
+  EXPECT_EQ(cluster.NumRunningWorkers(), 3);
+
+  DatasetClient<int64_t> dataset_client(cluster);
+  EXPECT_THAT(dataset_client.Read(RangeDataset(3), ProcessingModeDef::OFF,
+                                  TARGET_WORKERS_ANY),
+              IsOkAndHolds(UnorderedElementsAre(
+                  Pair(cluster.WorkerAddress(0), ElementsAre(0, 1, 2)),
+                  Pair(cluster.WorkerAddress(1), ElementsAre(0, 1, 2)),
+                  Pair(cluster.WorkerAddress(2), ElementsAre(0, 1, 2)))));
+}
+
+TEST(DataServiceTest, AutoScalingDrainsAndStopsWorkers) {
+  TestCluster::Config config;
+  config.num_workers = 3;
+  AutoScalingOptions auto_scaling_options;
+  auto_scaling_options.max_workers = 1;
+  auto_scaling_options.cooldown = absl::ZeroDuration();
+  config.auto_scaling_options = auto_scaling_options;
+  TestCluster cluster(config);
+  TF_ASSERT_OK(cluster.Initialize());
+
+  // Draining workers keep running, but are not assigned new tasks.
+  TF_ASSERT_OK(cluster.ScaleWorkers());
+  EXPECT_EQ(cluster.NumRunningWorkers(), 3);
+  DatasetClient<int64_t> dataset_client(cluster);
+  TF_ASSERT_OK_AND_ASSIGN(int64_t iteration_client_id,
+                          dataset_client.CreateIteration(RangeDataset(10)));
+  EXPECT_THAT(dataset_client.GetTasks(iteration_client_id),
+              IsOkAndHolds(SizeIs(1)));
+
+  // Workers without tasks are stopped.
+  TF_ASSERT_OK(cluster.ScaleWorkers());
+  EXPECT_EQ(cluster.NumRunningWorkers(), 1);
+  TF_ASSERT_OK(cluster.ScaleWorkers());
+  EXPECT_EQ(cluster.NumRunningWorkers(), 1);
+}
+
+TEST(DataServiceTest, AutoScalingDoesNotDrainDynamicShards) {
+  TestCluster::Config config;
+  config.num_workers = 3;
+  AutoScalingOptions auto_scaling_options;
+  auto_scaling_options.max_workers = 1;
+  auto_scaling_options.cooldown = absl::ZeroDuration();
+  config.auto_scaling_options = auto_scaling_options;
+  TestCluster cluster(config);
+  TF_ASSERT_OK(cluster.Initialize());
+
+  DatasetClient<int64_t> dataset_client(cluster);
+  TF_ASSERT_OK_AND_ASSIGN(
+      int64_t iteration_client_id,
+      dataset_client.CreateIteration(RangeDataset(10),
+                                     ProcessingModeDef::DYNAMIC));
+  EXPECT_THAT(dataset_client.GetTasks(iteration_client_id),
+              IsOkAndHolds(SizeIs(3)));
+
+  // Removing a task would lose the splits its worker has taken.
+  TF_ASSERT_OK(cluster.ScaleWorkers());
+  TF_ASSERT_OK(cluster.ScaleWorkers());
+  EXPECT_EQ(cluster.NumRunningWorkers(), 3);
+  EXPECT_THAT(dataset_client.GetTasks(iteration_client_id),
+              IsOkAndHolds(SizeIs(3)));
+}
+
+TEST(DataServiceTest, AutoScalingRequiresDynamicWorkers) {
+  experimental::DispatcherConfig config;
+  config.set_protocol("grpc");
+  config.add_worker_addresses("localhost");
+  std::unique_ptr<DispatchGrpcDataServer> dispatcher;
+  TF_ASSERT_OK(NewDispatchServer(config, dispatcher));
+  TF_ASSERT_OK(dispatcher->Start());
+  EXPECT_THAT(dispatcher->EnableAutoScaling(AutoScalingOptions(),
+                                            /*launcher=*/nullptr),
+              StatusIs(error::FAILED_PRECONDITION,
+                       HasSubstr("fixed list of worker addresses")));
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
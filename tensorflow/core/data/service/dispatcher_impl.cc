@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/hash_utils.h"
 #include "tensorflow/core/data/service/auto_scaler.h"
+#include "tensorflow/core/data/service/auto_scaling_controller.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/credentials_factory.h"
@@ -183,6 +184,17 @@ DispatcherConfig ApplyConfigDefaults(const DispatcherConfig& config) {
   }
   return new_config;
 }
+
+// Returns true if `task` can be removed from its worker while its consumers
+// keep reading the iteration from the other tasks. Sharded tasks cannot: a
+// static shard is only read by its worker, and removing a dynamically sharded
+// task would lose the splits the worker has taken but not produced yet.
+bool CanMoveTask(const Task& task) {
+  const Iteration& iteration = *task.iteration;
+  return !iteration.IsRoundRobin() &&
+         IsNoShard(iteration.job->processing_mode) &&
+         iteration.job->target_workers != TARGET_WORKERS_LOCAL;
+}
 }  // namespace
 
 DataServiceDispatcherImpl::DataServiceDispatcherImpl(
@@ -300,6 +312,46 @@ void DataServiceDispatcherImpl::Stop() TF_LOCKS_EXCLUDED(mu_) {
   }
 }
 
+Status DataServiceDispatcherImpl::EnableAutoScaling(
+    const AutoScalingOptions& options, std::unique_ptr<WorkerLauncher> launcher)
+    TF_LOCKS_EXCLUDED(mu_) {
+  if (!config_.worker_addresses().empty()) {
+    return errors::FailedPrecondition(
+        "tf.data service auto-scaling cannot be enabled when the dispatcher "
+        "has a fixed list of worker addresses.");
+  }
+  mutex_lock l(mu_);
+  auto_scaling_controller_ =
+      std::make_shared<AutoScalingController>(options, std::move(launcher));
+  return OkStatus();
+}
+
+Status DataServiceDispatcherImpl::ScaleWorkers() TF_LOCKS_EXCLUDED(mu_) {
+  // Serializes scaling decisions, so that each is based on the previous one.
+  mutex_lock scaling_lock(scaling_mu_);
+  std::shared_ptr<AutoScalingController> controller;
+  ScalingDecision decision;
+  {
+    mutex_lock l(mu_);
+    if (auto_scaling_controller_ == nullptr) {
+      return OkStatus();
+    }
+    controller = auto_scaling_controller_;
+    decision = controller->Recommend(
+        GetWorkerLoads(), auto_scaler_.GetOptimalNumberOfWorkers(),
+        GetMeanClientBufferFill(), absl::FromUnixMicros(env_->NowMicros()));
+  }
+  // Does not hold `mu_` while starting workers, since they register with the
+  // dispatcher.
+  Status s = controller->Actuate(decision,
+                                 absl::FromUnixMicros(env_->NowMicros()));
+  mutex_lock l(mu_);
+  for (const std::string& worker_address : decision.workers_to_drain) {
+    TF_RETURN_IF_ERROR(RemoveTasksFromDrainingWorker(worker_address));
+  }
+  return s;
+}
+
 size_t DataServiceDispatcherImpl::NumActiveIterations() TF_LOCKS_EXCLUDED(mu_) {
   mutex_lock l(mu_);
   size_t count = 0;
@@ -366,7 +418,8 @@ Status DataServiceDispatcherImpl::FindNewTasks(
   }
   for (const auto& iteration : state_.ListIterations()) {
     if (!assigned_iteration_ids.contains(iteration->iteration_id) &&
-        iteration->IsRoundRobin() && !iteration->finished) {
+        iteration->IsRoundRobin() && !iteration->finished &&
+        !IsDrainingWorker(worker_address)) {
       VLOG(1) << "Creating pending task for reconnected worker "
               << worker_address;
       TF_RETURN_IF_ERROR(CreatePendingTask(iteration, worker_address));
@@ -793,6 +846,7 @@ Status DataServiceDispatcherImpl::ReleaseIterationClient(
                  << " for Iteration " << iteration->iteration_id
                  << " from tf.data service AutoScaler: " << auto_scaler_status;
   }
+  client_buffer_fills_.erase(iteration_client_id);
   Update update;
   ReleaseIterationClientUpdate* release_iteration_client =
       update.mutable_release_iteration_client();
@@ -926,6 +980,9 @@ Status DataServiceDispatcherImpl::CreateTasksForIteration(
   tasks.clear();
   tasks.reserve(workers.size());
   for (const auto& worker : workers) {
+    if (IsDrainingWorker(worker->address)) {
+      continue;
+    }
     std::shared_ptr<const Task> task;
     TF_RETURN_IF_ERROR(CreateTask(iteration, worker->address, task));
     tasks.push_back(task);
@@ -1051,6 +1108,11 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
           << request->iteration_client_id();
   latest_client_heartbeats_time_[request->iteration_client_id()] =
       absl::FromUnixMicros(env_->NowMicros());
+  if (request->optional_buffer_fill_case() ==
+      ClientHeartbeatRequest::kBufferFill) {
+    client_buffer_fills_[request->iteration_client_id()] =
+        request->buffer_fill();
+  }
   std::shared_ptr<const Iteration> iteration;
   Status s = state_.IterationForIterationClientId(
       request->iteration_client_id(), iteration);
@@ -1366,39 +1428,45 @@ Status DataServiceDispatcherImpl::Apply(const Update& update)
 void DataServiceDispatcherImpl::MaintenanceThread() {
   int64_t next_check_micros = 0;
   while (true) {
-    mutex_lock l(mu_);
-    while (!cancelled_ && env_->NowMicros() < next_check_micros) {
-      int64_t remaining_micros = next_check_micros - env_->NowMicros();
-      maintenance_thread_cv_.wait_for(
-          l, std::chrono::microseconds(remaining_micros));
-    }
-    if (cancelled_) {
-      return;
-    }
     {
-      Status s = ReleaseMissingClients();
-      if (!s.ok()) {
-        LOG(WARNING) << "Error releasing missing clients: " << s;
+      mutex_lock l(mu_);
+      while (!cancelled_ && env_->NowMicros() < next_check_micros) {
+        int64_t remaining_micros = next_check_micros - env_->NowMicros();
+        maintenance_thread_cv_.wait_for(
+            l, std::chrono::microseconds(remaining_micros));
       }
-    }
-    {
-      Status s = auto_scaler_.UpdateOptimalNumberOfWorkersMetric(
-          state_.GetNumberOfRegisteredWorkers());
-      if (!s.ok()) {
-        LOG(WARNING) << "Error updating the optimal number of workers metric "
-                        "in tf.data service AutoScaler: "
-                     << s;
+      if (cancelled_) {
+        return;
       }
-    }
-    {
-      Status s = GcOldIterations();
-      if (!s.ok()) {
-        LOG(WARNING) << "Error garbage collecting old iterations: " << s;
+      {
+        Status s = ReleaseMissingClients();
+        if (!s.ok()) {
+          LOG(WARNING) << "Error releasing missing clients: " << s;
+        }
+      }
+      {
+        Status s = auto_scaler_.UpdateOptimalNumberOfWorkersMetric(
+            state_.GetNumberOfRegisteredWorkers());
+        if (!s.ok()) {
+          LOG(WARNING) << "Error updating the optimal number of workers metric "
+                          "in tf.data service AutoScaler: "
+                       << s;
+        }
       }
+      {
+        Status s = GcOldIterations();
+        if (!s.ok()) {
+          LOG(WARNING) << "Error garbage collecting old iterations: " << s;
+        }
+      }
+      DetectMissingWorkers();
+      next_check_micros =
+          env_->NowMicros() + (config_.job_gc_check_interval_ms() * 1000);
+    }
+    Status s = ScaleWorkers();
+    if (!s.ok()) {
+      LOG(WARNING) << "Error scaling tf.data service workers: " << s;
     }
-    DetectMissingWorkers();
-    next_check_micros =
-        env_->NowMicros() + (config_.job_gc_check_interval_ms() * 1000);
   }
 }
 
@@ -1430,6 +1498,7 @@ Status DataServiceDispatcherImpl::ReleaseMissingClients()
             absl::Milliseconds(config_.client_timeout_ms())) {
       LOG(INFO) << "Releasing timed-out client with id " << client_id;
       RemoveClientFromAutoScaler(client_id);
+      client_buffer_fills_.erase(client_id);
 
       Update update;
       ReleaseIterationClientUpdate* release_client =
@@ -1465,6 +1534,76 @@ void DataServiceDispatcherImpl::RemoveWorkerFromAutoScaler(
   }
 }
 
+bool DataServiceDispatcherImpl::IsDrainingWorker(
+    const std::string& worker_address) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  return auto_scaling_controller_ != nullptr &&
+         auto_scaling_controller_->IsDraining(worker_address);
+}
+
+std::vector<WorkerLoad> DataServiceDispatcherImpl::GetWorkerLoads() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::vector<WorkerLoad> worker_loads;
+  // Only considers workers which have not timed out.
+  for (const auto& [worker_address, last_heartbeat] :
+       latest_worker_heartbeats_time_) {
+    WorkerLoad& worker_load = worker_loads.emplace_back();
+    worker_load.address = worker_address;
+    worker_load.last_heartbeat = last_heartbeat;
+    std::vector<std::shared_ptr<const Task>> tasks;
+    if (!state_.TasksForWorker(worker_address, tasks).ok()) {
+      continue;
+    }
+    for (const auto& task : tasks) {
+      if (!task->iteration->finished) {
+        ++worker_load.num_tasks;
+        worker_load.drainable &= CanMoveTask(*task);
+      }
+    }
+  }
+  return worker_loads;
+}
+
+std::optional<double> DataServiceDispatcherImpl::GetMeanClientBufferFill()
+    const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (client_buffer_fills_.empty()) {
+    return std::nullopt;
+  }
+  double sum = 0.0;
+  for (const auto& [client_id, buffer_fill] : client_buffer_fills_) {
+    sum += buffer_fill;
+  }
+  return sum / client_buffer_fills_.size();
+}
+
+Status DataServiceDispatcherImpl::RemoveTasksFromDrainingWorker(
+    const std::string& worker_address) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::vector<std::shared_ptr<const Task>> tasks;
+  Status s = state_.TasksForWorker(worker_address, tasks);
+  if (errors::IsNotFound(s)) {
+    return OkStatus();
+  }
+  TF_RETURN_IF_ERROR(s);
+  for (const auto& task : tasks) {
+    const Iteration& iteration = *task->iteration;
+    if (iteration.finished || !CanMoveTask(*task)) {
+      continue;
+    }
+    VLOG(1) << "Removing task " << task->task_id << " from draining worker "
+            << worker_address;
+    Update update;
+    update.mutable_remove_task()->set_task_id(task->task_id);
+    TF_RETURN_IF_ERROR(Apply(update));
+    Status auto_scaler_status =
+        auto_scaler_.RemoveWorker(iteration.iteration_id, worker_address);
+    if (!auto_scaler_status.ok()) {
+      VLOG(1) << "Failed to remove worker with address " << worker_address
+              << " for Iteration " << iteration.iteration_id
+              << " from tf.data service AutoScaler: " << auto_scaler_status;
+    }
+  }
+  return OkStatus();
+}
+
 // TODO(b/250921378): Once snapshots have leases, inform snapshot managers.
 void DataServiceDispatcherImpl::DetectMissingWorkers()
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
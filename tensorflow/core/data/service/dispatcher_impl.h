@@ -27,6 +27,7 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/data/service/auto_scaler.h"
+#include "tensorflow/core/data/service/auto_scaling_controller.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dataset_store.h"
 #include "tensorflow/core/data/service/dispatcher.pb.h"
@@ -145,6 +146,18 @@ class DataServiceDispatcherImpl {
   // Stops the dispatcher. After stopping, RPCs should return without blocking.
   void Stop();
 
+  // Enables adding and draining workers according to the `AutoScaler`
+  // estimate, using `launcher` to start and stop workers. Workers are scaled
+  // periodically by the maintenance thread, or by calling `ScaleWorkers`.
+  // Fails if the dispatcher has a fixed list of worker addresses.
+  Status EnableAutoScaling(const AutoScalingOptions& options,
+                           std::unique_ptr<WorkerLauncher> launcher)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Takes one auto-scaling decision and acts on it. A no-op if auto-scaling is
+  // not enabled.
+  Status ScaleWorkers() TF_LOCKS_EXCLUDED(mu_);
+
   // Returns the number of active iterations.
   size_t NumActiveIterations() TF_LOCKS_EXCLUDED(mu_);
 
@@ -329,6 +342,22 @@ class DataServiceDispatcherImpl {
   // potentially associated with multiple iterations.
   void RemoveWorkerFromAutoScaler(const std::string& worker_address)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns true if the worker with `worker_address` is being drained by the
+  // auto-scaling controller, and should not get new tasks.
+  bool IsDrainingWorker(const std::string& worker_address) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns the load of each registered worker, for auto-scaling.
+  std::vector<WorkerLoad> GetWorkerLoads() const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns the mean buffer fill reported by active clients, if any.
+  std::optional<double> GetMeanClientBufferFill() const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Removes the tasks of a draining worker which other workers can make up for:
+  // tasks of non-coordinated iterations which do not shard their data, and may
+  // be read from any worker. The other tasks are kept until they finish, or
+  // the drain times out.
+  Status RemoveTasksFromDrainingWorker(const std::string& worker_address)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Checks for workers that haven't heartbeated recently and alerts the
   // snapshot managers.
   void DetectMissingWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -355,6 +384,8 @@ class DataServiceDispatcherImpl {
   // Uses a separate mutex for `GetSplit` requests. `GetSplit` may be blocking.
   // Locking `mu_` in `GetSplit` could block all other RPCs.
   mutable mutex get_split_mu_;
+  // Serializes `ScaleWorkers` calls. Acquired before `mu_`.
+  mutex scaling_mu_;
   bool started_ TF_GUARDED_BY(mu_) = false;
   bool cancelled_ TF_GUARDED_BY(mu_) = false;
 
@@ -396,6 +427,12 @@ class DataServiceDispatcherImpl {
   condition_variable maintenance_thread_cv_;
   std::unique_ptr<Thread> maintenance_thread_;
   MultipleIterationsAutoScaler auto_scaler_;
+  // Acts on the estimate of `auto_scaler_`. Null if auto-scaling is not
+  // enabled.
+  std::shared_ptr<AutoScalingController> auto_scaling_controller_
+      TF_GUARDED_BY(mu_);
+  // Map from client id to the latest buffer fill the client reported.
+  absl::flat_hash_map<int64_t, double> client_buffer_fills_ TF_GUARDED_BY(mu_);
 
   DataServiceDispatcherImpl(const DataServiceDispatcherImpl&) = delete;
   void operator=(const DataServiceDispatcherImpl&) = delete;
@@ -15,7 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/grpc_dispatcher_impl.h"
 
+#include <memory>
+#include <utility>
+
 #include "grpcpp/server_context.h"
+#include "tensorflow/core/data/service/auto_scaling_controller.h"
 #include "tensorflow/core/data/service/export.pb.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/protobuf/service_config.pb.h"
@@ -41,6 +45,14 @@ size_t GrpcDispatcherImpl::NumActiveIterations() {
   return impl_.NumActiveIterations();
 }
 
+Status GrpcDispatcherImpl::EnableAutoScaling(
+    const AutoScalingOptions& options,
+    std::unique_ptr<WorkerLauncher> launcher) {
+  return impl_.EnableAutoScaling(options, std::move(launcher));
+}
+
+Status GrpcDispatcherImpl::ScaleWorkers() { return impl_.ScaleWorkers(); }
+
 DispatcherStateExport GrpcDispatcherImpl::ExportState() const {
   return impl_.ExportState();
 }
@@ -16,7 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_GRPC_DISPATCHER_IMPL_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_GRPC_DISPATCHER_IMPL_H_
 
+#include <memory>
+
 #include "grpcpp/server_builder.h"
+#include "tensorflow/core/data/service/auto_scaling_controller.h"
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
 #include "tensorflow/core/data/service/dispatcher_impl.h"
 #include "tensorflow/core/data/service/export.pb.h"
@@ -39,6 +42,10 @@ class GrpcDispatcherImpl : public DispatcherService::Service {
 
   size_t NumActiveIterations();
 
+  Status EnableAutoScaling(const AutoScalingOptions& options,
+                           std::unique_ptr<WorkerLauncher> launcher);
+  Status ScaleWorkers();
+
   DispatcherStateExport ExportState() const;
 
 #define HANDLER(method)                                 \
@@ -159,6 +159,16 @@ size_t DispatchGrpcDataServer::NumActiveIterations() {
   return service_->NumActiveIterations();
 }
 
+Status DispatchGrpcDataServer::EnableAutoScaling(
+    const AutoScalingOptions& options,
+    std::unique_ptr<WorkerLauncher> launcher) {
+  return service_->EnableAutoScaling(options, std::move(launcher));
+}
+
+Status DispatchGrpcDataServer::ScaleWorkers() {
+  return service_->ScaleWorkers();
+}
+
 ServerStateExport DispatchGrpcDataServer::ExportState() const {
   ServerStateExport server_state_export;
   *server_state_export.mutable_dispatcher_state_export() =
@@ -22,6 +22,7 @@ limitations under the License.
 
 #include "grpcpp/server.h"
 #include "grpcpp/server_builder.h"
+#include "tensorflow/core/data/service/auto_scaling_controller.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/export.pb.h"
@@ -110,6 +111,14 @@ class DispatchGrpcDataServer : public GrpcDataServerBase {
   // Returns the number of active (non-finished) iterations running on the
   // dispatcher.
   size_t NumActiveIterations();
+  // Lets the dispatcher add and remove workers through `launcher`. Scaling
+  // decisions are taken periodically by the dispatcher, or by `ScaleWorkers`.
+  // Must be called after the server is started. Fails if the dispatcher has a
+  // fixed list of worker addresses.
+  Status EnableAutoScaling(const AutoScalingOptions& options,
+                           std::unique_ptr<WorkerLauncher> launcher);
+  // Takes a scaling decision now. No-op if auto-scaling is not enabled.
+  Status ScaleWorkers();
   // Returns information about all the streams for the snapshot at `path`.
   Status SnapshotStreams(const std::string& path,
                          std::vector<SnapshotStreamInfoWrapper>* streams);
@@ -0,0 +1,1169 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/platform.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tsl/platform/errors.h"
+
+#if !defined(PLATFORM_WINDOWS)
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif  // !PLATFORM_WINDOWS
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Parsed compatibility info of a shared memory transfer server, which is
+// serialized as "<host name>,<server pid>,<listener segment name>".
+struct ServerInfo {
+  std::string hostname;
+  int64_t pid = 0;
+  std::string listener_name;
+};
+
+std::string ServerInfoToString(const ServerInfo& info) {
+  return absl::StrCat(info.hostname, ",", info.pid, ",", info.listener_name);
+}
+
+StatusOr<ServerInfo> ParseServerInfo(const std::string& str) {
+  std::vector<std::string> parts = absl::StrSplit(str, ',');
+  ServerInfo info;
+  if (parts.size() != 3 || !absl::SimpleAtoi(parts[1], &info.pid)) {
+    return errors::InvalidArgument(
+        "Invalid shared memory data transfer server info: ", str);
+  }
+  info.hostname = std::move(parts[0]);
+  info.listener_name = std::move(parts[2]);
+  return info;
+}
+
+}  // namespace
+
+bool IsLocalShmTransferServer(const DataTransferServerInfo& info) {
+  if (info.protocol() != kShmTransferProtocol) {
+    return false;
+  }
+  StatusOr<ServerInfo> server_info = ParseServerInfo(info.compatibility_info());
+  return server_info.ok() && server_info->hostname == port::Hostname();
+}
+
+#if !defined(PLATFORM_WINDOWS)
+
+namespace {
+
+// Maximum length of a segment name, including the terminating null byte.
+// Names are kept short since some platforms limit them to 31 characters.
+constexpr size_t kMaxNameLength = 32;
+// Maximum number of clients which registered with a listener, but which the
+// server has not accepted yet.
+constexpr uint64_t kMaxPendingClients = 64;
+// How often waiting threads check whether they were cancelled, or whether the
+// process on the other side of a segment exited.
+constexpr int64_t kPollIntervalNanos = 100 * 1000 * 1000;
+
+// States of a channel. The client moves the channel from kIdle to kRequest,
+// and from kChunk to kConsumed; the server moves it from kRequest to kChunk,
+// kLastChunk or kError, and from kConsumed to kChunk or kLastChunk. The
+// client moves the channel back to kIdle after reading the last chunk or an
+// error.
+enum ChannelState : uint32_t {
+  // The client may send a request.
+  kIdle = 0,
+  // The buffer holds a serialized GetElementRequest.
+  kRequest = 1,
+  // The buffer holds a part of the response; more parts follow.
+  kChunk = 2,
+  // The buffer holds the last part of the response.
+  kLastChunk = 3,
+  // The client has read the current chunk.
+  kConsumed = 4,
+  // The buffer holds an error message, and `status_code` its code.
+  kError = 5,
+};
+
+// How a component is encoded in a response.
+enum ComponentEncoding : uint64_t {
+  // The tensor's bytes, for tensors whose type can be memcpy'ed.
+  kRaw = 0,
+  // A serialized TensorProto.
+  kTensorProto = 1,
+  // A serialized CompressedElement, held by a scalar variant tensor.
+  kCompressedElement = 2,
+};
+
+// A mutex and condition variable shared between processes.
+struct SharedLock {
+  pthread_mutex_t mu;
+  pthread_cond_t cv;
+};
+
+struct ListenerHeader {
+  SharedLock lock;
+  // Held by the server for as long as it runs.
+  pthread_mutex_t server_alive;
+  uint32_t closed;
+  // Clients in [tail, head) are pending, at index `i % kMaxPendingClients`.
+  uint64_t head;
+  uint64_t tail;
+  char pending[kMaxPendingClients][kMaxNameLength];
+};
+
+struct ChannelHeader {
+  SharedLock lock;
+  // Held by the client for as long as the channel is open.
+  pthread_mutex_t client_alive;
+  int64_t client_pid;
+  int64_t server_pid;
+  uint32_t state;
+  uint32_t client_closed;
+  uint32_t server_closed;
+  int32_t status_code;
+  // Number of bytes used in the buffer.
+  uint64_t size;
+  // Size of the buffer, which follows the header.
+  uint64_t capacity;
+};
+
+// The buffer of a channel is cache line aligned.
+constexpr size_t kChannelBufferOffset = (sizeof(ChannelHeader) + 63) & ~63;
+
+std::string NewSegmentName() {
+  return absl::StrCat("/tfd", getpid(), "_", absl::Hex(random::New64()));
+}
+
+Status InitSharedMutex(pthread_mutex_t* mu) {
+  pthread_mutexattr_t mu_attr;
+  pthread_mutexattr_init(&mu_attr);
+  pthread_mutexattr_setpshared(&mu_attr, PTHREAD_PROCESS_SHARED);
+#if defined(__linux__)
+  // Lets a process acquire the mutex if the other process exits while holding
+  // it.
+  pthread_mutexattr_setrobust(&mu_attr, PTHREAD_MUTEX_ROBUST);
+#endif  // __linux__
+  int error = pthread_mutex_init(mu, &mu_attr);
+  pthread_mutexattr_destroy(&mu_attr);
+  if (error != 0) {
+    return errors::IOError("Failed to initialize shared mutex", error);
+  }
+  return OkStatus();
+}
+
+Status InitSharedLock(SharedLock* lock) {
+  TF_RETURN_IF_ERROR(InitSharedMutex(&lock->mu));
+  pthread_condattr_t cv_attr;
+  pthread_condattr_init(&cv_attr);
+  pthread_condattr_setpshared(&cv_attr, PTHREAD_PROCESS_SHARED);
+  int error = pthread_cond_init(&lock->cv, &cv_attr);
+  pthread_condattr_destroy(&cv_attr);
+  if (error != 0) {
+    return errors::IOError("Failed to initialize shared condition variable",
+                           error);
+  }
+  return OkStatus();
+}
+
+void RecoverIfOwnerDied(int error, pthread_mutex_t* mu) {
+#if defined(__linux__)
+  if (error == EOWNERDEAD) {
+    // The process on the other side exited; callers notice it when checking
+    // whether it is alive.
+    pthread_mutex_consistent(mu);
+  }
+#endif  // __linux__
+}
+
+// Whether the process on the other side of a segment still holds its
+// `alive` mutex. The robust mutex is released by the kernel when its holder
+// exits, which, unlike `kill(pid, 0)`, also works when the processes are in
+// different PID namespaces, e.g. with a worker in a sidecar container. Other
+// platforms have no robust mutexes, and check `pid` instead.
+bool IsAlive(pthread_mutex_t* alive, int64_t pid) {
+#if defined(__linux__)
+  const int error = pthread_mutex_trylock(alive);
+  if (error == EBUSY) {
+    return true;
+  }
+  if (error == EOWNERDEAD) {
+    pthread_mutex_consistent(alive);
+  }
+  if (error == 0 || error == EOWNERDEAD) {
+    pthread_mutex_unlock(alive);
+  }
+  return false;
+#else
+  return kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM;
+#endif  // __linux__
+}
+
+// Holds an `alive` mutex until destroyed. A robust mutex is owned by a thread
+// rather than by a process, so it is held by a dedicated thread.
+class AliveMutexHolder {
+ public:
+  explicit AliveMutexHolder(pthread_mutex_t* alive) : alive_(alive) {
+    thread_ = absl::WrapUnique(Env::Default()->StartThread(
+        {}, "tf_data_shm_alive", [this] { Hold(); }));
+    held_.WaitForNotification();
+  }
+
+  ~AliveMutexHolder() {
+    {
+      mutex_lock l(mu_);
+      released_ = true;
+      cv_.notify_all();
+    }
+    thread_.reset();
+  }
+
+ private:
+  void Hold() {
+    RecoverIfOwnerDied(pthread_mutex_lock(alive_), alive_);
+    held_.Notify();
+    {
+      mutex_lock l(mu_);
+      while (!released_) {
+        cv_.wait(l);
+      }
+    }
+    pthread_mutex_unlock(alive_);
+  }
+
+  pthread_mutex_t* const alive_;
+  Notification held_;
+  mutex mu_;
+  condition_variable cv_;
+  bool released_ TF_GUARDED_BY(mu_) = false;
+  std::unique_ptr<Thread> thread_;
+
+  AliveMutexHolder(const AliveMutexHolder&) = delete;
+  void operator=(const AliveMutexHolder&) = delete;
+};
+
+class SharedMutexLock {
+ public:
+  explicit SharedMutexLock(SharedLock* lock) : lock_(lock) {
+    RecoverIfOwnerDied(pthread_mutex_lock(&lock_->mu), &lock_->mu);
+  }
+  ~SharedMutexLock() { pthread_mutex_unlock(&lock_->mu); }
+
+  // Waits for a notification, for at most `kPollIntervalNanos`.
+  void Wait() {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += kPollIntervalNanos;
+    deadline.tv_sec += deadline.tv_nsec / 1000000000;
+    deadline.tv_nsec %= 1000000000;
+    RecoverIfOwnerDied(
+        pthread_cond_timedwait(&lock_->cv, &lock_->mu, &deadline), &lock_->mu);
+  }
+
+  void NotifyAll() { pthread_cond_broadcast(&lock_->cv); }
+
+ private:
+  SharedLock* const lock_;
+
+  SharedMutexLock(const SharedMutexLock&) = delete;
+  void operator=(const SharedMutexLock&) = delete;
+};
+
+// A mapped POSIX shared memory segment.
+class SharedSegment {
+ public:
+  // Creates a segment of `size` zero bytes. The segment is unlinked when the
+  // returned object is destroyed.
+  static StatusOr<std::unique_ptr<SharedSegment>> Create(
+      const std::string& name, size_t size) {
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+      return errors::IOError(absl::StrCat("Failed to create ", name), errno);
+    }
+    if (ftruncate(fd, size) != 0) {
+      Status s =
+          errors::IOError(absl::StrCat("Failed to resize ", name), errno);
+      close(fd);
+      shm_unlink(name.c_str());
+      return s;
+    }
+    StatusOr<std::unique_ptr<SharedSegment>> segment = Map(name, fd, size);
+    if (!segment.ok()) {
+      shm_unlink(name.c_str());
+      return segment.status();
+    }
+    (*segment)->owner_ = true;
+    return segment;
+  }
+
+  // Opens an existing segment.
+  static StatusOr<std::unique_ptr<SharedSegment>> Open(
+      const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+      return errors::IOError(absl::StrCat("Failed to open ", name), errno);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      Status s = errors::IOError(absl::StrCat("Failed to stat ", name), errno);
+      close(fd);
+      return s;
+    }
+    return Map(name, fd, st.st_size);
+  }
+
+  ~SharedSegment() {
+    munmap(data_, size_);
+    if (owner_) {
+      shm_unlink(name_.c_str());
+    }
+  }
+
+  // Removes the name of the segment, which stays mapped until destroyed.
+  void Unlink() { shm_unlink(name_.c_str()); }
+
+  const std::string& name() const { return name_; }
+  char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  SharedSegment(const std::string& name, char* data, size_t size)
+      : name_(name), data_(data), size_(size) {}
+
+  // Maps the segment opened as `fd`, and closes `fd`.
+  static StatusOr<std::unique_ptr<SharedSegment>> Map(const std::string& name,
+                                                      int fd, size_t size) {
+    void* data =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int error = errno;
+    close(fd);
+    if (data == MAP_FAILED) {
+      return errors::IOError(absl::StrCat("Failed to map ", name), error);
+    }
+    return absl::WrapUnique(
+        new SharedSegment(name, static_cast<char*>(data), size));
+  }
+
+  const std::string name_;
+  char* const data_;
+  const size_t size_;
+  bool owner_ = false;
+};
+
+}  // namespace
+
+// The segment with which clients register their channel.
+class ShmListener {
+ public:
+  static StatusOr<std::unique_ptr<ShmListener>> Create(
+      const std::string& name) {
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<SharedSegment> segment,
+                        SharedSegment::Create(name, sizeof(ListenerHeader)));
+    auto listener = absl::WrapUnique(new ShmListener(std::move(segment)));
+    ListenerHeader* header = listener->header();
+    TF_RETURN_IF_ERROR(InitSharedLock(&header->lock));
+    TF_RETURN_IF_ERROR(InitSharedMutex(&header->server_alive));
+    listener->server_alive_ =
+        std::make_unique<AliveMutexHolder>(&header->server_alive);
+    return listener;
+  }
+
+  static StatusOr<std::unique_ptr<ShmListener>> Open(const std::string& name) {
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<SharedSegment> segment,
+                        SharedSegment::Open(name));
+    if (segment->size() != sizeof(ListenerHeader)) {
+      return errors::FailedPrecondition(
+          "Shared memory segment ", name,
+          " is not a tf.data service listener of this version.");
+    }
+    return absl::WrapUnique(new ShmListener(std::move(segment)));
+  }
+
+  // Registers the channel named `channel_name`.
+  Status Register(const std::string& channel_name) {
+    if (channel_name.size() >= kMaxNameLength) {
+      return errors::InvalidArgument("Channel name ", channel_name,
+                                     " is too long.");
+    }
+    ListenerHeader* header = this->header();
+    SharedMutexLock l(&header->lock);
+    if (header->closed) {
+      return errors::Unavailable("The tf.data service worker is shut down.");
+    }
+    if (header->head - header->tail >= kMaxPendingClients) {
+      return errors::Unavailable(
+          "Too many clients are connecting to the tf.data service worker.");
+    }
+    char* slot = header->pending[header->head % kMaxPendingClients];
+    memset(slot, 0, kMaxNameLength);
+    memcpy(slot, channel_name.data(), channel_name.size());
+    ++header->head;
+    l.NotifyAll();
+    return OkStatus();
+  }
+
+  // Returns the name of the next registered channel, or an empty string if no
+  // client registers within the poll interval.
+  std::string NextClient() {
+    ListenerHeader* header = this->header();
+    SharedMutexLock l(&header->lock);
+    if (header->head == header->tail) {
+      l.Wait();
+      if (header->head == header->tail) {
+        return "";
+      }
+    }
+    const char* slot = header->pending[header->tail % kMaxPendingClients];
+    std::string name(slot, strnlen(slot, kMaxNameLength));
+    ++header->tail;
+    return name;
+  }
+
+  // Makes further registrations fail.
+  void Close() {
+    ListenerHeader* header = this->header();
+    SharedMutexLock l(&header->lock);
+    header->closed = 1;
+  }
+
+  // Whether the server process `server_pid`, which created the listener, is
+  // still running.
+  bool IsServerAlive(int64_t server_pid) const {
+    return IsAlive(&header()->server_alive, server_pid);
+  }
+
+ private:
+  explicit ShmListener(std::unique_ptr<SharedSegment> segment)
+      : segment_(std::move(segment)) {}
+
+  ListenerHeader* header() const {
+    return reinterpret_cast<ListenerHeader*>(segment_->data());
+  }
+
+  const std::unique_ptr<SharedSegment> segment_;
+  // Set on the server side.
+  std::unique_ptr<AliveMutexHolder> server_alive_;
+};
+
+// The segment through which a client and the server exchange requests and
+// responses. Created by the client and opened by the server.
+class ShmChannel {
+ public:
+  // Creates the channel `name` on the client side, for the server which
+  // created `listener`.
+  static StatusOr<std::unique_ptr<ShmChannel>> Create(
+      const std::string& name, size_t buffer_size, int64_t server_pid,
+      std::unique_ptr<ShmListener> listener) {
+    TF_ASSIGN_OR_RETURN(
+        std::unique_ptr<SharedSegment> segment,
+        SharedSegment::Create(name, kChannelBufferOffset + buffer_size));
+    auto channel = absl::WrapUnique(
+        new ShmChannel(std::move(segment), /*is_server=*/false));
+    ChannelHeader* header = channel->header();
+    TF_RETURN_IF_ERROR(InitSharedLock(&header->lock));
+    TF_RETURN_IF_ERROR(InitSharedMutex(&header->client_alive));
+    channel->client_alive_ =
+        std::make_unique<AliveMutexHolder>(&header->client_alive);
+    channel->listener_ = std::move(listener);
+    header->client_pid = getpid();
+    header->server_pid = server_pid;
+    header->state = kIdle;
+    header->capacity = buffer_size;
+    return channel;
+  }
+
+  // Opens the channel `name` on the server side, and unlinks its name.
+  static StatusOr<std::unique_ptr<ShmChannel>> Open(const std::string& name) {
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<SharedSegment> segment,
+                        SharedSegment::Open(name));
+    segment->Unlink();
+    if (segment->size() < kChannelBufferOffset) {
+      return errors::FailedPrecondition("Shared memory segment ", name,
+                                        " is not a tf.data service channel.");
+    }
+    auto channel = absl::WrapUnique(
+        new ShmChannel(std::move(segment), /*is_server=*/true));
+    ChannelHeader* header = channel->header();
+    if (header->server_pid != getpid() ||
+        header->capacity != channel->segment_->size() - kChannelBufferOffset) {
+      return errors::FailedPrecondition("Shared memory segment ", name,
+                                        " is not a channel of this server.");
+    }
+    return channel;
+  }
+
+  ~ShmChannel() {
+    ChannelHeader* header = this->header();
+    SharedMutexLock l(&header->lock);
+    if (is_server_) {
+      header->server_closed = 1;
+    } else {
+      header->client_closed = 1;
+    }
+    l.NotifyAll();
+  }
+
+  // Registers the channel with the server, on the client side.
+  Status Register() { return listener_->Register(name()); }
+
+  const std::string& name() const { return segment_->name(); }
+  char* buffer() const { return segment_->data() + kChannelBufferOffset; }
+  size_t capacity() const { return header()->capacity; }
+  size_t size() const { return header()->size; }
+
+  // Moves the channel to `state`, with `size` bytes used in the buffer.
+  void SetState(ChannelState state, size_t size) {
+    ChannelHeader* header = this->header();
+    SharedMutexLock l(&header->lock);
+    header->state = state;
+    header->size = size;
+    l.NotifyAll();
+  }
+
+  // Waits until the channel is in one of `states`, and returns that state.
+  // Fails if `cancelled` returns true, or if the other side exits or closes
+  // the channel.
+  StatusOr<ChannelState> WaitForState(
+      std::initializer_list<ChannelState> states,
+      const std::function<bool()>& cancelled) {
+    ChannelHeader* header = this->header();
+    SharedMutexLock l(&header->lock);
+    while (true) {
+      for (ChannelState state : states) {
+        if (header->state == state) {
+          return state;
+        }
+      }
+      if (cancelled()) {
+        return errors::Cancelled("Shared memory data transfer was cancelled.");
+      }
+      if (is_server_ &&
+          (header->client_closed ||
+           !IsAlive(&header->client_alive, header->client_pid))) {
+        return errors::Unavailable("The tf.data service client disconnected.");
+      }
+      if (!is_server_ && (header->server_closed ||
+                          !listener_->IsServerAlive(header->server_pid))) {
+        return errors::Unavailable("The tf.data service worker disconnected.");
+      }
+      l.Wait();
+    }
+  }
+
+  // Sends `status` to the client in place of a response.
+  void SendError(const Status& status) {
+    const size_t size = std::min(status.message().size(), capacity());
+    memcpy(buffer(), status.message().data(), size);
+    ChannelHeader* header = this->header();
+    SharedMutexLock l(&header->lock);
+    header->status_code = static_cast<int32_t>(status.code());
+    header->state = kError;
+    header->size = size;
+    l.NotifyAll();
+  }
+
+  // Returns the error sent by the server.
+  Status ReceivedError() const {
+    return Status(static_cast<absl::StatusCode>(header()->status_code),
+                  absl::string_view(buffer(), size()));
+  }
+
+ private:
+  ShmChannel(std::unique_ptr<SharedSegment> segment, bool is_server)
+      : segment_(std::move(segment)), is_server_(is_server) {}
+
+  ChannelHeader* header() const {
+    return reinterpret_cast<ChannelHeader*>(segment_->data());
+  }
+
+  const std::unique_ptr<SharedSegment> segment_;
+  const bool is_server_;
+  // Set on the client side.
+  std::unique_ptr<ShmListener> listener_;
+  std::unique_ptr<AliveMutexHolder> client_alive_;
+};
+
+namespace {
+
+// Writes a response to a channel, in chunks of at most the channel's capacity.
+class ChunkWriter {
+ public:
+  ChunkWriter(ShmChannel& channel, std::function<bool()> cancelled)
+      : channel_(channel), cancelled_(std::move(cancelled)) {}
+
+  Status Write(const char* data, size_t n) {
+    while (n > 0) {
+      if (size_ == channel_.capacity()) {
+        TF_RETURN_IF_ERROR(Flush());
+      }
+      const size_t count = std::min(n, channel_.capacity() - size_);
+      memcpy(channel_.buffer() + size_, data, count);
+      size_ += count;
+      data += count;
+      n -= count;
+    }
+    return OkStatus();
+  }
+
+  // Sends the last chunk of the response.
+  void Finish() { channel_.SetState(kLastChunk, size_); }
+
+ private:
+  // Sends a full chunk, and waits for the client to read it.
+  Status Flush() {
+    channel_.SetState(kChunk, size_);
+    size_ = 0;
+    return channel_.WaitForState({kConsumed}, cancelled_).status();
+  }
+
+  ShmChannel& channel_;
+  const std::function<bool()> cancelled_;
+  size_t size_ = 0;
+};
+
+// Reads a response from a channel.
+class ChunkReader {
+ public:
+  ChunkReader(ShmChannel& channel, std::function<bool()> cancelled)
+      : channel_(channel), cancelled_(std::move(cancelled)) {}
+
+  Status Read(char* data, size_t n) {
+    while (n > 0) {
+      if (offset_ == size_) {
+        TF_RETURN_IF_ERROR(NextChunk());
+      }
+      const size_t count = std::min(n, size_ - offset_);
+      memcpy(data, channel_.buffer() + offset_, count);
+      offset_ += count;
+      data += count;
+      n -= count;
+    }
+    return OkStatus();
+  }
+
+  // Checks that the response was read entirely, and makes the channel ready
+  // for the next request.
+  Status Finish() {
+    if (!last_ || offset_ != size_) {
+      return errors::DataLoss(
+          "Unexpected data at the end of a shared memory response.");
+    }
+    channel_.SetState(kIdle, 0);
+    return OkStatus();
+  }
+
+  // Whether the last error was sent by the server, rather than caused by the
+  // transfer itself.
+  bool server_error() const { return server_error_; }
+
+ private:
+  Status NextChunk() {
+    if (last_) {
+      return errors::DataLoss("Truncated shared memory response.");
+    }
+    if (started_) {
+      channel_.SetState(kConsumed, 0);
+    }
+    started_ = true;
+    TF_ASSIGN_OR_RETURN(
+        ChannelState state,
+        channel_.WaitForState({kChunk, kLastChunk, kError}, cancelled_));
+    if (state == kError) {
+      server_error_ = true;
+      Status status = channel_.ReceivedError();
+      channel_.SetState(kIdle, 0);
+      return status;
+    }
+    size_ = channel_.size();
+    offset_ = 0;
+    last_ = state == kLastChunk;
+    return OkStatus();
+  }
+
+  ShmChannel& channel_;
+  const std::function<bool()> cancelled_;
+  size_t size_ = 0;
+  size_t offset_ = 0;
+  bool started_ = false;
+  bool last_ = false;
+  bool server_error_ = false;
+};
+
+// A response is a fixed64 header size, the header, then each component's
+// bytes. The header holds the element index, the end of sequence and skip
+// bits, and for each component its encoding, dtype, dims and byte size.
+Status WriteResult(const GetElementResult& result, ChunkWriter& writer) {
+  std::string header;
+  core::PutVarint64(&header, result.element_index);
+  header.push_back(result.end_of_sequence ? 1 : 0);
+  header.push_back(result.skip ? 1 : 0);
+  core::PutVarint64(&header, result.components.size());
+  std::vector<ComponentEncoding> encodings(result.components.size(), kRaw);
+  // Serialized components, for those which cannot be sent raw.
+  std::vector<std::string> serialized(result.components.size());
+  for (size_t i = 0; i < result.components.size(); ++i) {
+    const Tensor& component = result.components[i];
+    ComponentEncoding& encoding = encodings[i];
+    size_t size = component.TotalBytes();
+    const CompressedElement* compressed = nullptr;
+    if (component.dtype() == DT_VARIANT && component.NumElements() == 1) {
+      compressed = component.scalar<Variant>()().get<CompressedElement>();
+    }
+    if (compressed != nullptr) {
+      encoding = kCompressedElement;
+      compressed->SerializeToString(&serialized[i]);
+      size = serialized[i].size();
+    } else if (!DataTypeCanUseMemcpy(component.dtype())) {
+      encoding = kTensorProto;
+      TensorProto proto;
+      component.AsProtoTensorContent(&proto);
+      proto.SerializeToString(&serialized[i]);
+      size = serialized[i].size();
+    }
+    core::PutVarint64(&header, encoding);
+    core::PutVarint64(&header, component.dtype());
+    core::PutVarint64(&header, component.dims());
+    for (int64_t dim : component.shape().dim_sizes()) {
+      core::PutVarint64(&header, dim);
+    }
+    core::PutVarint64(&header, size);
+  }
+
+  char header_size[sizeof(uint64_t)];
+  core::EncodeFixed64(header_size, header.size());
+  TF_RETURN_IF_ERROR(writer.Write(header_size, sizeof(header_size)));
+  TF_RETURN_IF_ERROR(writer.Write(header.data(), header.size()));
+  for (size_t i = 0; i < result.components.size(); ++i) {
+    if (encodings[i] == kRaw) {
+      StringPiece data = result.components[i].tensor_data();
+      TF_RETURN_IF_ERROR(writer.Write(data.data(), data.size()));
+    } else {
+      TF_RETURN_IF_ERROR(
+          writer.Write(serialized[i].data(), serialized[i].size()));
+    }
+  }
+  writer.Finish();
+  return OkStatus();
+}
+
+Status ReadComponent(StringPiece* header, ChunkReader& reader,
+                     Tensor* component) {
+  uint64_t encoding, dtype, dims, size;
+  if (!core::GetVarint64(header, &encoding) ||
+      !core::GetVarint64(header, &dtype) ||
+      dtype > static_cast<uint64_t>(DataType_MAX) ||
+      !DataType_IsValid(static_cast<int>(dtype)) ||
+      !core::GetVarint64(header, &dims) ||
+      dims > static_cast<uint64_t>(TensorShape::MaxDimensions())) {
+    return errors::DataLoss("Invalid shared memory response header.");
+  }
+  std::vector<int64_t> dim_sizes(dims);
+  for (int64_t& dim : dim_sizes) {
+    uint64_t dim_size;
+    if (!core::GetVarint64(header, &dim_size)) {
+      return errors::DataLoss("Invalid shared memory response header.");
+    }
+    dim = static_cast<int64_t>(dim_size);
+  }
+  if (!core::GetVarint64(header, &size)) {
+    return errors::DataLoss("Invalid shared memory response header.");
+  }
+  TensorShape shape;
+  TF_RETURN_IF_ERROR(TensorShapeUtils::MakeShape(dim_sizes, &shape));
+
+  if (encoding == kRaw) {
+    const DataType type = static_cast<DataType>(dtype);
+    if (!DataTypeCanUseMemcpy(type)) {
+      return errors::DataLoss("Invalid shared memory response header.");
+    }
+    *component = Tensor(type, shape);
+    if (component->TotalBytes() != size) {
+      return errors::DataLoss("Invalid shared memory response header.");
+    }
+    return reader.Read(const_cast<char*>(component->tensor_data().data()),
+                       size);
+  }
+  std::string serialized;
+  serialized.resize(size);
+  TF_RETURN_IF_ERROR(reader.Read(serialized.data(), size));
+  if (encoding == kCompressedElement) {
+    CompressedElement compressed;
+    if (!compressed.ParseFromString(serialized)) {
+      return errors::DataLoss("Failed to parse compressed element.");
+    }
+    *component = Tensor(DT_VARIANT, TensorShape{});
+    component->scalar<Variant>()() = std::move(compressed);
+    return OkStatus();
+  }
+  TensorProto proto;
+  if (encoding != kTensorProto || !proto.ParseFromString(serialized) ||
+      !component->FromProto(proto)) {
+    return errors::DataLoss("Failed to parse tensor.");
+  }
+  return OkStatus();
+}
+
+Status ReadResult(ChunkReader& reader, GetElementResult& result) {
+  char header_size[sizeof(uint64_t)];
+  TF_RETURN_IF_ERROR(reader.Read(header_size, sizeof(header_size)));
+  std::string header_buffer;
+  header_buffer.resize(core::DecodeFixed64(header_size));
+  TF_RETURN_IF_ERROR(reader.Read(header_buffer.data(), header_buffer.size()));
+
+  StringPiece header(header_buffer);
+  uint64_t element_index, num_components;
+  if (!core::GetVarint64(&header, &element_index) || header.size() < 2) {
+    return errors::DataLoss("Invalid shared memory response header.");
+  }
+  result.element_index = static_cast<int64_t>(element_index);
+  result.end_of_sequence = header[0] != 0;
+  result.skip = header[1] != 0;
+  header.remove_prefix(2);
+  if (!core::GetVarint64(&header, &num_components)) {
+    return errors::DataLoss("Invalid shared memory response header.");
+  }
+  result.components.clear();
+  for (uint64_t i = 0; i < num_components; ++i) {
+    result.components.emplace_back();
+    TF_RETURN_IF_ERROR(
+        ReadComponent(&header, reader, &result.components.back()));
+  }
+  return reader.Finish();
+}
+
+}  // namespace
+
+ShmDataTransferServer::ShmDataTransferServer(GetElementT get_element)
+    : get_element_(std::move(get_element)) {}
+
+ShmDataTransferServer::~ShmDataTransferServer() {
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+  }
+  if (listener_) {
+    listener_->Close();
+  }
+  accept_thread_.reset();
+  absl::flat_hash_map<int64_t, std::unique_ptr<Thread>> client_threads;
+  {
+    mutex_lock l(mu_);
+    client_threads = std::move(client_threads_);
+  }
+  // Joins the threads.
+  client_threads.clear();
+}
+
+Status ShmDataTransferServer::Start() {
+  listener_name_ = NewSegmentName();
+  TF_ASSIGN_OR_RETURN(listener_, ShmListener::Create(listener_name_));
+  accept_thread_ = absl::WrapUnique(Env::Default()->StartThread(
+      {}, "tf_data_shm_transfer_server", [this] { AcceptClients(); }));
+  return OkStatus();
+}
+
+StatusOr<std::string> ShmDataTransferServer::GetCompatibilityInfo() const {
+  if (!listener_) {
+    return errors::FailedPrecondition(
+        "The shared memory data transfer server has not been started.");
+  }
+  ServerInfo info;
+  info.hostname = port::Hostname();
+  info.pid = getpid();
+  info.listener_name = listener_name_;
+  return ServerInfoToString(info);
+}
+
+bool ShmDataTransferServer::IsCancelled() {
+  mutex_lock l(mu_);
+  return cancelled_;
+}
+
+void ShmDataTransferServer::AcceptClients() {
+  while (!IsCancelled()) {
+    std::vector<std::unique_ptr<Thread>> finished_threads;
+    {
+      mutex_lock l(mu_);
+      for (int64_t client_id : finished_clients_) {
+        finished_threads.push_back(std::move(client_threads_[client_id]));
+        client_threads_.erase(client_id);
+      }
+      finished_clients_.clear();
+    }
+    // Joins the threads of disconnected clients.
+    finished_threads.clear();
+
+    const std::string channel_name = listener_->NextClient();
+    if (channel_name.empty()) {
+      continue;
+    }
+    StatusOr<std::unique_ptr<ShmChannel>> channel =
+        ShmChannel::Open(channel_name);
+    if (!channel.ok()) {
+      LOG(WARNING) << "Failed to accept shared memory data transfer client: "
+                   << channel.status();
+      continue;
+    }
+    mutex_lock l(mu_);
+    if (cancelled_) {
+      return;
+    }
+    const int64_t client_id = next_client_id_++;
+    // `std::function` requires a copyable functor.
+    std::shared_ptr<ShmChannel> shared_channel = std::move(*channel);
+    client_threads_[client_id] = absl::WrapUnique(Env::Default()->StartThread(
+        {}, "tf_data_shm_transfer_client", [this, client_id, shared_channel] {
+          ServeClient(client_id, *shared_channel);
+        }));
+  }
+}
+
+void ShmDataTransferServer::ServeClient(int64_t client_id,
+                                        ShmChannel& channel) {
+  auto cancelled = [this] { return IsCancelled(); };
+  while (true) {
+    Status s = channel.WaitForState({kRequest}, cancelled).status();
+    GetElementRequest req;
+    if (s.ok() && !req.ParseFromArray(channel.buffer(), channel.size())) {
+      s = errors::DataLoss("Failed to parse GetElementRequest.");
+    }
+    if (!s.ok()) {
+      VLOG(2) << "Stopped serving shared memory data transfer client: " << s;
+      break;
+    }
+    GetElementResult result;
+    s = get_element_(&req, &result);
+    if (!s.ok()) {
+      channel.SendError(s);
+      continue;
+    }
+    ChunkWriter writer(channel, cancelled);
+    s = WriteResult(result, writer);
+    if (!s.ok()) {
+      VLOG(2) << "Stopped serving shared memory data transfer client: " << s;
+      break;
+    }
+  }
+  mutex_lock l(mu_);
+  finished_clients_.push_back(client_id);
+}
+
+ShmDataTransferClient::ShmDataTransferClient(size_t buffer_size)
+    : buffer_size_(buffer_size) {}
+
+ShmDataTransferClient::~ShmDataTransferClient() = default;
+
+Status ShmDataTransferClient::CheckCompatibility(
+    const std::string& server_compatibility_info) const {
+  return Connect(server_compatibility_info);
+}
+
+Status ShmDataTransferClient::Connect(
+    const std::string& server_compatibility_info) const {
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<ShmChannel> channel,
+                      CreateChannel(server_compatibility_info));
+  mutex_lock l(mu_);
+  server_compatibility_info_ = server_compatibility_info;
+  channel_ = std::move(channel);
+  return OkStatus();
+}
+
+StatusOr<std::unique_ptr<ShmChannel>> ShmDataTransferClient::CreateChannel(
+    const std::string& server_compatibility_info) const {
+  TF_ASSIGN_OR_RETURN(ServerInfo server_info,
+                      ParseServerInfo(server_compatibility_info));
+  if (server_info.hostname != port::Hostname()) {
+    return errors::FailedPrecondition(
+        "The tf.data service worker runs on host ", server_info.hostname,
+        ", but shared memory data transfer requires it to run on this host (",
+        port::Hostname(), ").");
+  }
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<ShmListener> listener,
+                      ShmListener::Open(server_info.listener_name));
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<ShmChannel> channel,
+                      ShmChannel::Create(NewSegmentName(), buffer_size_,
+                                         server_info.pid, std::move(listener)));
+  TF_RETURN_IF_ERROR(channel->Register());
+  return channel;
+}
+
+Status ShmDataTransferClient::GetElement(const GetElementRequest& req,
+                                         GetElementResult& result) {
+  VLOG(3) << "GetElement for task " << req.task_id() << " from shared memory "
+          << "worker server.";
+  if (IsCancelled()) {
+    return errors::Cancelled("Client was cancelled.");
+  }
+  mutex_lock l(mu_);
+  if (!channel_) {
+    // The previous channel broke. Connecting again only succeeds if the
+    // worker still runs; otherwise, the error is not retriable, so that the
+    // data service client falls back to gRPC.
+    if (server_compatibility_info_.empty()) {
+      return errors::FailedPrecondition(
+          "The shared memory connection to the tf.data service worker is not "
+          "established.");
+    }
+    StatusOr<std::unique_ptr<ShmChannel>> channel =
+        CreateChannel(server_compatibility_info_);
+    if (!channel.ok()) {
+      return errors::FailedPrecondition(
+          "Failed to reconnect to the tf.data service worker through shared "
+          "memory: ",
+          channel.status().ToString());
+    }
+    channel_ = std::move(*channel);
+  }
+  const size_t request_size = req.ByteSizeLong();
+  if (request_size > channel_->capacity()) {
+    return errors::InvalidArgument("GetElementRequest of ", request_size,
+                                   " bytes does not fit in the ",
+                                   channel_->capacity(),
+                                   " bytes shared memory buffer.");
+  }
+  req.SerializeToArray(channel_->buffer(), request_size);
+  int64_t start_time_us = env_->NowMicros();
+  channel_->SetState(kRequest, request_size);
+  ChunkReader reader(*channel_, [this] { return IsCancelled(); });
+  Status s = ReadResult(reader, result);
+  if (!s.ok() && !reader.server_error()) {
+    // The channel is in an unknown state, so it is not reused.
+    channel_.reset();
+    return s;
+  }
+  TF_RETURN_IF_ERROR(s);
+  metrics::RecordTFDataServiceGetElementDuration(
+      kShmTransferProtocol, env_->NowMicros() - start_time_us);
+  return OkStatus();
+}
+
+void ShmDataTransferClient::TryCancel() {
+  VLOG(2) << "Cancel ShmDataTransferClient.";
+  mutex_lock l(cancel_mu_);
+  cancelled_ = true;
+}
+
+bool ShmDataTransferClient::IsCancelled() const {
+  mutex_lock l(cancel_mu_);
+  return cancelled_;
+}
+
+#else  // PLATFORM_WINDOWS
+
+class ShmListener {};
+class ShmChannel {};
+
+ShmDataTransferServer::ShmDataTransferServer(GetElementT get_element)
+    : get_element_(std::move(get_element)) {}
+
+ShmDataTransferServer::~ShmDataTransferServer() = default;
+
+Status ShmDataTransferServer::Start() {
+  return errors::Unimplemented(
+      "Shared memory data transfer is not supported on Windows.");
+}
+
+StatusOr<std::string> ShmDataTransferServer::GetCompatibilityInfo() const {
+  return errors::Unimplemented(
+      "Shared memory data transfer is not supported on Windows.");
+}
+
+ShmDataTransferClient::ShmDataTransferClient(size_t buffer_size)
+    : buffer_size_(buffer_size) {}
+
+ShmDataTransferClient::~ShmDataTransferClient() = default;
+
+Status ShmDataTransferClient::CheckCompatibility(
+    const std::string& server_compatibility_info) const {
+  return errors::Unimplemented(
+      "Shared memory data transfer is not supported on Windows.");
+}
+
+Status ShmDataTransferClient::GetElement(const GetElementRequest& req,
+                                         GetElementResult& result) {
+  return errors::Unimplemented(
+      "Shared memory data transfer is not supported on Windows.");
+}
+
+void ShmDataTransferClient::TryCancel() {}
+
+#endif  // PLATFORM_WINDOWS
+
+class ShmTransferServerRegistrar {
+ public:
+  ShmTransferServerRegistrar() {
+    DataTransferServer::Register(
+        kShmTransferProtocol,
+        [](DataTransferServer::GetElementT get_element,
+           std::shared_ptr<DataTransferServer>* out) {
+          *out = std::make_shared<ShmDataTransferServer>(get_element);
+          return OkStatus();
+        });
+  }
+};
+static ShmTransferServerRegistrar shm_server_registrar;
+
+class ShmTransferClientRegistrar {
+ public:
+  ShmTransferClientRegistrar() {
+    DataTransferClient::Register(
+        kShmTransferProtocol, [](DataTransferClient::Config config,
+                                 std::unique_ptr<DataTransferClient>* out) {
+          *out = std::make_unique<ShmDataTransferClient>();
+          return OkStatus();
+        });
+  }
+};
+static ShmTransferClientRegistrar shm_client_registrar;
+
+}  // namespace data
+}  // namespace tensorflow
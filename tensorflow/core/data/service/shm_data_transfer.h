@@ -0,0 +1,141 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Data transfer protocol for clients running on the same host as the tf.data
+// service worker. Elements are passed through POSIX shared memory instead of
+// being serialized to protos and sent over a loopback gRPC connection.
+//
+// The server creates a listener segment, whose name it advertises in its
+// compatibility info together with the host name. Each client creates its own
+// channel segment and registers it with the listener; the server then serves
+// the client's requests from a dedicated thread. Responses are streamed
+// through the channel's buffer: a small header describes each component (its
+// dtype, shape and byte size), followed by the raw tensor bytes. A memcpy-able
+// tensor is copied once into shared memory by the worker and once out of it by
+// the client, with no proto encoding. Elements larger than the buffer are sent
+// in several chunks.
+//
+// The data service client uses this protocol automatically when a worker
+// started with `data_transfer_protocol="shm"` runs on the same host, and
+// falls back to gRPC otherwise.
+constexpr const char kShmTransferProtocol[] = "shm";
+
+class ShmChannel;
+class ShmListener;
+
+// Returns true if `info` describes a shared memory transfer server running on
+// this host.
+bool IsLocalShmTransferServer(const DataTransferServerInfo& info);
+
+class ShmDataTransferServer : public DataTransferServer {
+ public:
+  explicit ShmDataTransferServer(GetElementT get_element);
+  ~ShmDataTransferServer() override;
+
+  Status Start() override;
+
+  // The shared memory server does not listen on a port.
+  int Port() const override { return 0; }
+
+  StatusOr<std::string> GetCompatibilityInfo() const override;
+
+ private:
+  // Accepts clients registering with the listener until the server is
+  // destroyed.
+  void AcceptClients();
+  // Serves the requests of the client of `channel`.
+  void ServeClient(int64_t client_id, ShmChannel& channel);
+  bool IsCancelled() TF_LOCKS_EXCLUDED(mu_);
+
+  const GetElementT get_element_;
+  std::string listener_name_;
+  std::unique_ptr<ShmListener> listener_;
+  std::unique_ptr<Thread> accept_thread_;
+
+  mutex mu_;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  int64_t next_client_id_ TF_GUARDED_BY(mu_) = 0;
+  // Threads serving connected clients, by client id.
+  absl::flat_hash_map<int64_t, std::unique_ptr<Thread>> client_threads_
+      TF_GUARDED_BY(mu_);
+  // Clients whose thread has finished, and can be joined.
+  std::vector<int64_t> finished_clients_ TF_GUARDED_BY(mu_);
+};
+
+class ShmDataTransferClient : public DataTransferClient {
+ public:
+  // Size of the shared buffer of each client.
+  static constexpr size_t kDefaultBufferSize = 16 << 20;
+
+  explicit ShmDataTransferClient(size_t buffer_size = kDefaultBufferSize);
+  ~ShmDataTransferClient() override;
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResult& result) override;
+
+  void TryCancel() override;
+
+  // Connects to the server described by `server_compatibility_info`, so that
+  // a client on another host, or one which cannot map the server's shared
+  // memory, fails before any element is read.
+  Status CheckCompatibility(
+      const std::string& server_compatibility_info) const override;
+
+ private:
+  Status Connect(const std::string& server_compatibility_info) const
+      TF_LOCKS_EXCLUDED(mu_);
+  // Creates a channel and registers it with the server.
+  StatusOr<std::unique_ptr<ShmChannel>> CreateChannel(
+      const std::string& server_compatibility_info) const;
+  bool IsCancelled() const TF_LOCKS_EXCLUDED(cancel_mu_);
+
+  const size_t buffer_size_;
+
+  mutable mutex mu_;
+  // Set by `CheckCompatibility`, and used to connect again if the connection
+  // breaks.
+  mutable std::string server_compatibility_info_ TF_GUARDED_BY(mu_);
+  // Set by `CheckCompatibility`, and reset if the connection breaks.
+  mutable std::unique_ptr<ShmChannel> channel_ TF_GUARDED_BY(mu_);
+
+  mutable mutex cancel_mu_;
+  bool cancelled_ TF_GUARDED_BY(cancel_mu_) = false;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
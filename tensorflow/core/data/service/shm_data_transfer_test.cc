@@ -0,0 +1,241 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+using ::testing::HasSubstr;
+
+// Small enough for most elements to be sent in several chunks.
+constexpr size_t kBufferSize = 256;
+
+// Returns element `index` of the test dataset: an int64 vector of `index`
+// values, and a string scalar.
+GetElementResult TestElement(int64_t index) {
+  GetElementResult result;
+  std::vector<int64_t> values(index);
+  for (int64_t i = 0; i < index; ++i) {
+    values[i] = index * i;
+  }
+  result.components.push_back(
+      test::AsTensor<int64_t>(values, TensorShape({index})));
+  result.components.push_back(
+      test::AsScalar<tstring>(absl::StrCat("element ", index)));
+  result.element_index = index;
+  return result;
+}
+
+Status GetTestElement(const GetElementRequest* req, GetElementResult* result) {
+  if (req->task_id() < 0) {
+    return errors::NotFound("Task ", req->task_id(), " not found.");
+  }
+  if (req->task_id() == 0) {
+    result->end_of_sequence = true;
+    return OkStatus();
+  }
+  *result = TestElement(req->task_id());
+  return OkStatus();
+}
+
+StatusOr<std::unique_ptr<ShmDataTransferClient>> ConnectClient(
+    const ShmDataTransferServer& server, size_t buffer_size = kBufferSize) {
+  auto client = std::make_unique<ShmDataTransferClient>(buffer_size);
+  TF_ASSIGN_OR_RETURN(std::string compatibility_info,
+                      server.GetCompatibilityInfo());
+  TF_RETURN_IF_ERROR(client->CheckCompatibility(compatibility_info));
+  return client;
+}
+
+GetElementRequest Request(int64_t task_id) {
+  GetElementRequest req;
+  req.set_task_id(task_id);
+  return req;
+}
+
+void ExpectEqual(const GetElementResult& result,
+                 const GetElementResult& expected) {
+  EXPECT_EQ(result.element_index, expected.element_index);
+  EXPECT_EQ(result.end_of_sequence, expected.end_of_sequence);
+  EXPECT_EQ(result.skip, expected.skip);
+  ASSERT_EQ(result.components.size(), expected.components.size());
+  for (size_t i = 0; i < result.components.size(); ++i) {
+    test::ExpectEqual(result.components[i], expected.components[i]);
+  }
+}
+
+TEST(ShmDataTransferTest, GetElements) {
+  ShmDataTransferServer server(GetTestElement);
+  TF_ASSERT_OK(server.Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ShmDataTransferClient> client,
+                          ConnectClient(server));
+  // Element sizes range from less than one chunk to many chunks.
+  for (int64_t task_id : {1, 2, 31, 32, 33, 1000}) {
+    GetElementResult result;
+    TF_ASSERT_OK(client->GetElement(Request(task_id), result));
+    ExpectEqual(result, TestElement(task_id));
+  }
+  GetElementResult result;
+  TF_ASSERT_OK(client->GetElement(Request(0), result));
+  EXPECT_TRUE(result.end_of_sequence);
+  EXPECT_TRUE(result.components.empty());
+}
+
+TEST(ShmDataTransferTest, CompressedElement) {
+  CompressedElement compressed;
+  compressed.set_data(std::string(1000, 'a'));
+  compressed.set_version(1);
+  ShmDataTransferServer server(
+      [&compressed](const GetElementRequest* req, GetElementResult* result) {
+        Tensor tensor(DT_VARIANT, TensorShape{});
+        tensor.scalar<Variant>()() = compressed;
+        result->components.push_back(std::move(tensor));
+        return OkStatus();
+      });
+  TF_ASSERT_OK(server.Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ShmDataTransferClient> client,
+                          ConnectClient(server));
+  GetElementResult result;
+  TF_ASSERT_OK(client->GetElement(Request(1), result));
+  ASSERT_EQ(result.components.size(), 1);
+  const CompressedElement* received =
+      result.components[0].scalar<Variant>()().get<CompressedElement>();
+  ASSERT_NE(received, nullptr);
+  EXPECT_EQ(received->data(), compressed.data());
+  EXPECT_EQ(received->version(), 1);
+}
+
+TEST(ShmDataTransferTest, ServerError) {
+  ShmDataTransferServer server(GetTestElement);
+  TF_ASSERT_OK(server.Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ShmDataTransferClient> client,
+                          ConnectClient(server));
+  GetElementResult result;
+  EXPECT_THAT(client->GetElement(Request(-1), result),
+              StatusIs(error::NOT_FOUND, HasSubstr("Task -1 not found")));
+  // The client can still read after an error from the server.
+  TF_ASSERT_OK(client->GetElement(Request(10), result));
+  ExpectEqual(result, TestElement(10));
+}
+
+TEST(ShmDataTransferTest, MultipleClients) {
+  ShmDataTransferServer server(GetTestElement);
+  TF_ASSERT_OK(server.Start());
+  std::vector<std::unique_ptr<ShmDataTransferClient>> clients;
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ShmDataTransferClient> client,
+                            ConnectClient(server));
+    clients.push_back(std::move(client));
+  }
+  for (int64_t task_id = 1; task_id < 10; ++task_id) {
+    GetElementResult result;
+    TF_ASSERT_OK(clients[task_id % clients.size()]->GetElement(
+        Request(task_id), result));
+    ExpectEqual(result, TestElement(task_id));
+  }
+}
+
+TEST(ShmDataTransferTest, Cancel) {
+  ShmDataTransferServer server(GetTestElement);
+  TF_ASSERT_OK(server.Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ShmDataTransferClient> client,
+                          ConnectClient(server));
+  client->TryCancel();
+  GetElementResult result;
+  EXPECT_THAT(client->GetElement(Request(1), result),
+              StatusIs(error::CANCELLED));
+}
+
+TEST(ShmDataTransferTest, ServerShutdown) {
+  auto server = std::make_unique<ShmDataTransferServer>(GetTestElement);
+  TF_ASSERT_OK(server->Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ShmDataTransferClient> client,
+                          ConnectClient(*server));
+  GetElementResult result;
+  TF_ASSERT_OK(client->GetElement(Request(1), result));
+  server.reset();
+  EXPECT_THAT(client->GetElement(Request(1), result),
+              StatusIs(error::UNAVAILABLE));
+  // Connecting again fails, with an error that makes the data service client
+  // fall back to gRPC.
+  EXPECT_THAT(client->GetElement(Request(1), result),
+              StatusIs(error::FAILED_PRECONDITION, HasSubstr("reconnect")));
+}
+
+TEST(ShmDataTransferTest, ServerOnAnotherHost) {
+  ShmDataTransferServer server(GetTestElement);
+  TF_ASSERT_OK(server.Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::string compatibility_info,
+                          server.GetCompatibilityInfo());
+  const std::string other_host_info =
+      absl::StrCat("not-", compatibility_info);
+
+  ShmDataTransferClient client;
+  EXPECT_THAT(client.CheckCompatibility(other_host_info),
+              StatusIs(error::FAILED_PRECONDITION, HasSubstr("this host")));
+  EXPECT_THAT(client.CheckCompatibility("invalid"),
+              StatusIs(error::INVALID_ARGUMENT));
+
+  DataTransferServerInfo info;
+  info.set_protocol(kShmTransferProtocol);
+  info.set_compatibility_info(compatibility_info);
+  EXPECT_TRUE(IsLocalShmTransferServer(info));
+  info.set_compatibility_info(other_host_info);
+  EXPECT_FALSE(IsLocalShmTransferServer(info));
+}
+
+TEST(ShmDataTransferTest, RegisteredProtocol) {
+  std::shared_ptr<DataTransferServer> server;
+  TF_ASSERT_OK(
+      DataTransferServer::Build(kShmTransferProtocol, GetTestElement, &server));
+  TF_ASSERT_OK(server->Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::string compatibility_info,
+                          server->GetCompatibilityInfo());
+  std::unique_ptr<DataTransferClient> client;
+  TF_ASSERT_OK(DataTransferClient::Build(
+      kShmTransferProtocol, {kShmTransferProtocol, /*address=*/""}, &client));
+  TF_ASSERT_OK(client->CheckCompatibility(compatibility_info));
+  GetElementResult result;
+  TF_ASSERT_OK(client->GetElement(Request(5), result));
+  ExpectEqual(result, TestElement(5));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/hash.h"
 #include "tsl/platform/path.h"
 #include "tsl/platform/statusor.h"
 #include "tsl/platform/threadpool.h"
@@ -117,10 +118,18 @@ absl::Status ParallelTFRecordWriter::WriteFile() ABSL_LOCKS_EXCLUDED(mu_) {
   TF_ASSIGN_OR_RETURN(const std::string filename, GetUniqueFile());
   snapshot_util::TFRecordWriter writer(filename, compression_);
   TF_RETURN_IF_ERROR(writer.Initialize(env_));
+  uint64_t fingerprint = 0;
   while (ShouldWriteFile(filename)) {
-    TF_RETURN_IF_ERROR(WriteRecord(filename, writer));
+    TF_RETURN_IF_ERROR(WriteRecord(filename, writer, fingerprint));
   }
   TF_RETURN_IF_ERROR(writer.Close());
+  {
+    absl::MutexLock l(&mu_);
+    auto iterator = file_stats_.find(filename);
+    if (iterator != file_stats_.end()) {
+      iterator->second.fingerprint = fingerprint;
+    }
+  }
   return DeleteEmptyFile(filename);
 }
 
@@ -136,7 +145,8 @@ bool ParallelTFRecordWriter::ShouldWriteFile(const std::string& filename) const
 }
 
 absl::Status ParallelTFRecordWriter::WriteRecord(
-    const std::string& filename, snapshot_util::TFRecordWriter& writer) {
+    const std::string& filename, snapshot_util::TFRecordWriter& writer,
+    uint64_t& fingerprint) {
   TF_ASSIGN_OR_RETURN(std::optional<std::vector<Tensor>> record,
                       GetNextRecord(filename));
   if (!record.has_value()) {
@@ -145,6 +155,8 @@ absl::Status ParallelTFRecordWriter::WriteRecord(
 
   tsl::profiler::TraceMe activity("WriteTFRecord",
                                   tsl::profiler::TraceMeLevel::kInfo);
+  TF_ASSIGN_OR_RETURN(uint64_t record_fingerprint, Fingerprint(*record));
+  fingerprint = tsl::Hash64Combine(fingerprint, record_fingerprint);
   TF_RETURN_IF_ERROR(writer.WriteTensors(*std::move(record)));
   return absl::OkStatus();
 }
@@ -70,10 +70,12 @@ class ParallelTFRecordWriter {
   // blocks until there is enough space to buffer the record.
   absl::Status Write(std::vector<Tensor> record);
 
-  // File stats: number of records in a file and the estimated size of the file.
+  // File stats: number of records in a file, the estimated size of the file,
+  // and the fingerprint of its records in the order they were written.
   struct FileStats {
     int64_t num_records = 0;
     ByteSize estimated_size;
+    uint64_t fingerprint = 0;
   };
   using FileToStatsMap = absl::flat_hash_map<std::string, FileStats>;
 
@@ -97,9 +99,11 @@ class ParallelTFRecordWriter {
   // Whether the file can hold more records without exceeding `max_file_size_`.
   bool ShouldWriteFile(const std::string& filename) const;
 
-  // Writes one record to file.
+  // Writes one record to file, and combines its fingerprint into
+  // `fingerprint`.
   absl::Status WriteRecord(const std::string& filename,
-                           snapshot_util::TFRecordWriter& writer);
+                           snapshot_util::TFRecordWriter& writer,
+                           uint64_t& fingerprint);
 
   // Gets the next record from the buffer to write. Returns `std::nullopt` if
   // there are no more records to write.
@@ -51,6 +51,7 @@ using ::testing::Field;
 using ::testing::Gt;
 using ::testing::IsEmpty;
 using ::testing::Le;
+using ::testing::Ne;
 using ::testing::SizeIs;
 using ::testing::UnorderedElementsAreArray;
 using ::tsl::testing::IsOkAndHolds;
@@ -301,6 +302,27 @@ TEST(ParallelTFRecordWriterTest, CannotWriteFinalizedWriter) {
   client_thread.reset();
 }
 
+TEST(ParallelTFRecordWriterTest, Fingerprint) {
+  auto write_range = [](int64_t range) -> absl::StatusOr<uint64_t> {
+    TF_ASSIGN_OR_RETURN(std::string test_dir, TestDir());
+    ParallelTFRecordWriter parallel_tfrecord_writer(
+        test_dir, tsl::io::compression::kNone, tsl::Env::Default(),
+        ByteSize::GB(1), /*num_write_threads=*/1);
+    RangeIterator range_iterator(range);
+    TF_ASSIGN_OR_RETURN(ParallelTFRecordWriter::FileToStatsMap file_stats,
+                        WriteRecords(parallel_tfrecord_writer, range_iterator));
+    if (file_stats.size() != 1) {
+      return absl::InternalError("Expected one file.");
+    }
+    return file_stats.begin()->second.fingerprint;
+  };
+
+  // Files with the same records have the same fingerprint.
+  TF_ASSERT_OK_AND_ASSIGN(uint64_t fingerprint, write_range(10));
+  EXPECT_THAT(write_range(10), IsOkAndHolds(fingerprint));
+  EXPECT_THAT(write_range(11), IsOkAndHolds(Ne(fingerprint)));
+}
+
 TEST(ParallelTFRecordWriterTest, DirectoryDoesNotExist) {
   ParallelTFRecordWriter parallel_tfrecord_writer("/directory/does/not/exists",
                                                   tsl::io::compression::kNone,
@@ -14,7 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -26,6 +28,7 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "tsl/platform/errors.h"
 #include "tsl/platform/path.h"
 
 namespace tensorflow {
@@ -35,6 +38,7 @@ namespace {
 constexpr const char kDoneFileName[] = "DONE";
 constexpr const char kErrorFileName[] = "ERROR";
 constexpr const char kWorkerFileName[] = "owner_worker";
+constexpr const char kChunkManifestFileName[] = "chunk_manifest";
 constexpr const char kSnapshotMetadataFileName[] = "snapshot.metadata";
 constexpr const char kDatasetDefFileName[] = "dataset_def.proto";
 constexpr const char kDatasetSpecFileName[] = "dataset_spec.pb";
@@ -44,6 +48,7 @@ constexpr const char kCheckpointsDirectoryName[] = "checkpoints";
 constexpr const char kCommittedChunksDirectoryName[] = "chunks";
 constexpr const char kUncommittedChunksDirectoryName[] = "uncommitted_chunks";
 constexpr int64_t kUnknownNumElements = -1;
+constexpr size_t kFingerprintLength = 16;
 
 }  // namespace
 
@@ -169,12 +174,16 @@ absl::StatusOr<std::tuple<int64_t, int64_t, int64_t>> ParseChunkFilename(
     absl::string_view chunk_filename) {
   std::vector<std::string> tokens = absl::StrSplit(chunk_filename, '_');
   int64_t stream_index = 0, stream_chunk_index = 0, chunk_num_elements = 0;
-  if (tokens.size() != 4 || tokens[0] != "chunk" ||
+  uint64_t chunk_fingerprint = 0;
+  if ((tokens.size() != 4 && tokens.size() != 5) || tokens[0] != "chunk" ||
       !absl::SimpleAtoi(tokens[1], &stream_index) || stream_index < 0 ||
       !absl::SimpleAtoi(tokens[2], &stream_chunk_index) ||
       stream_chunk_index < 0 ||
       !absl::SimpleAtoi(tokens[3], &chunk_num_elements) ||
-      (chunk_num_elements < 0 && chunk_num_elements != kUnknownNumElements)) {
+      (chunk_num_elements < 0 && chunk_num_elements != kUnknownNumElements) ||
+      (tokens.size() == 5 &&
+       (tokens[4].size() != kFingerprintLength ||
+        !absl::SimpleHexAtoi(tokens[4], &chunk_fingerprint)))) {
     return absl::InvalidArgumentError(absl::StrCat(
         "Invalid chunk file name: ", chunk_filename,
         ". Expected "
@@ -183,6 +192,26 @@ absl::StatusOr<std::tuple<int64_t, int64_t, int64_t>> ParseChunkFilename(
   return std::make_tuple(stream_index, stream_chunk_index, chunk_num_elements);
 }
 
+absl::StatusOr<std::optional<uint64_t>> ParseChunkFingerprint(
+    absl::string_view chunk_filename) {
+  TF_RETURN_IF_ERROR(ParseChunkFilename(chunk_filename).status());
+  std::vector<absl::string_view> tokens = absl::StrSplit(chunk_filename, '_');
+  uint64_t chunk_fingerprint = 0;
+  if (tokens.size() != 5 ||
+      !absl::SimpleHexAtoi(tokens[4], &chunk_fingerprint)) {
+    return std::nullopt;
+  }
+  return chunk_fingerprint;
+}
+
+std::string ChunkFilename(int64_t stream_index, int64_t stream_chunk_index,
+                          int64_t chunk_num_elements,
+                          uint64_t chunk_fingerprint) {
+  return absl::StrCat("chunk_", stream_index, "_", stream_chunk_index, "_",
+                      chunk_num_elements, "_",
+                      absl::Hex(chunk_fingerprint, absl::kZeroPad16));
+}
+
 std::string SnapshotMetadataFilePath(absl::string_view snapshot_path_) {
   return tsl::io::JoinPath(snapshot_path_, kSnapshotMetadataFileName);
 }
@@ -210,6 +239,12 @@ std::string StreamWorkerFilePath(absl::string_view stream_path) {
   return tsl::io::JoinPath(stream_path, kWorkerFileName);
 }
 
+std::string ChunkManifestFilePath(absl::string_view snapshot_path,
+                                  int64_t stream_index) {
+  return tsl::io::JoinPath(StreamDirectory(snapshot_path, stream_index),
+                           kChunkManifestFileName);
+}
+
 std::string SnapshotDoneFilePath(absl::string_view snapshot_path) {
   return tsl::io::JoinPath(snapshot_path, kDoneFileName);
 }
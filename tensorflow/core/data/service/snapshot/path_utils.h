@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_PATH_UTILS_H_
 
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -86,10 +87,25 @@ absl::StatusOr<std::pair<int64_t, int64_t>> ParseCheckpointFilename(
 
 // Returns a tuple of {stream_index, stream_chunk_index, chunk_num_elements} of
 // the chunk. The expected format of `chunk_filename` is:
-// chunk_<stream_index>_<stream_chunk_index>_<chunk_num_elements>
+// chunk_<stream_index>_<stream_chunk_index>_<chunk_num_elements>, optionally
+// followed by _<chunk_fingerprint>.
 absl::StatusOr<std::tuple<int64_t, int64_t, int64_t>> ParseChunkFilename(
     absl::string_view chunk_filename);
 
+// Returns the fingerprint of the elements of the chunk, or `std::nullopt` if
+// the chunk was committed without one. The expected format of `chunk_filename`
+// is the one of `ChunkFilename`.
+absl::StatusOr<std::optional<uint64_t>> ParseChunkFingerprint(
+    absl::string_view chunk_filename);
+
+// Returns the file name of a committed chunk whose elements have fingerprint
+// `chunk_fingerprint`. The format is:
+// chunk_<stream_index>_<stream_chunk_index>_<chunk_num_elements>_<fingerprint>
+// where the fingerprint is written as 16 hexadecimal digits.
+std::string ChunkFilename(int64_t stream_index, int64_t stream_chunk_index,
+                          int64_t chunk_num_elements,
+                          uint64_t chunk_fingerprint);
+
 // Returns the path of the DONE file of a snapshot stream.
 std::string StreamDoneFilePath(absl::string_view snapshot_path,
                                int64_t stream_index);
@@ -101,6 +117,10 @@ std::string StreamWorkerFilePath(absl::string_view snapshot_path,
 // Returns the path of the owner_worker file of a snapshot stream.
 std::string StreamWorkerFilePath(absl::string_view stream_path);
 
+// Returns the path of the chunk manifest of a snapshot stream.
+std::string ChunkManifestFilePath(absl::string_view snapshot_path,
+                                  int64_t stream_index);
+
 // Returns the path of the DONE file of a snapshot.
 std::string SnapshotDoneFilePath(absl::string_view snapshot_path);
 
@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
 
+#include <cstdint>
+#include <optional>
+
 #include "tsl/platform/status_matchers.h"
 #include "tsl/platform/test.h"
 #include "tsl/protobuf/error_codes.pb.h"
@@ -22,9 +25,11 @@ namespace tensorflow {
 namespace data {
 namespace {
 
+using ::testing::Eq;
 using ::testing::FieldsAre;
 using ::testing::HasSubstr;
 using ::testing::MatchesRegex;
+using ::testing::Optional;
 using ::testing::Pair;
 using tsl::testing::IsOkAndHolds;
 using tsl::testing::StatusIs;
@@ -182,6 +187,19 @@ TEST(PathUtilsTest, ParseChunkFilename) {
               IsOkAndHolds(FieldsAre(0, 1, 2)));
   EXPECT_THAT(ParseChunkFilename("chunk_0_1_-1"),
               IsOkAndHolds(FieldsAre(0, 1, -1)));
+  EXPECT_THAT(ParseChunkFilename("chunk_0_1_2_00000000deadbeef"),
+              IsOkAndHolds(FieldsAre(0, 1, 2)));
+}
+
+TEST(PathUtilsTest, ChunkFilename) {
+  EXPECT_EQ(ChunkFilename(/*stream_index=*/0, /*stream_chunk_index=*/1,
+                          /*chunk_num_elements=*/2,
+                          /*chunk_fingerprint=*/0xdeadbeef),
+            "chunk_0_1_2_00000000deadbeef");
+  EXPECT_THAT(ParseChunkFingerprint(ChunkFilename(0, 1, 2, ~uint64_t{0})),
+              IsOkAndHolds(Optional(~uint64_t{0})));
+  EXPECT_THAT(ParseChunkFingerprint("chunk_0_1_2"),
+              IsOkAndHolds(Eq(std::nullopt)));
 }
 
 TEST(PathUtilsTest, InvalidChunkFilename) {
@@ -205,6 +223,13 @@ TEST(PathUtilsTest, InvalidChunkFilename) {
                        HasSubstr("Expected "
                                  "chunk_<stream_index>_<stream_chunk_index>_<"
                                  "chunk_num_elements>")));
+  EXPECT_THAT(ParseChunkFilename("chunk_0_1_2_deadbeef"),
+              StatusIs(error::INVALID_ARGUMENT,
+                       HasSubstr("Expected "
+                                 "chunk_<stream_index>_<stream_chunk_index>_<"
+                                 "chunk_num_elements>")));
+  EXPECT_THAT(ParseChunkFingerprint("chunk_0_1_2_xxxxxxxxxxxxxxxx"),
+              StatusIs(error::INVALID_ARGUMENT));
 }
 
 TEST(PathUtilsTest, StreamDoneFilePath) {
@@ -212,6 +237,12 @@ TEST(PathUtilsTest, StreamDoneFilePath) {
               MatchesRegex("/path/to/snapshot.streams.stream_0.DONE"));
 }
 
+TEST(PathUtilsTest, ChunkManifestFilePath) {
+  EXPECT_THAT(
+      ChunkManifestFilePath("/path/to/snapshot", /*stream_index=*/0),
+      MatchesRegex("/path/to/snapshot.streams.stream_0.chunk_manifest"));
+}
+
 TEST(PathUtilsTest, StreamWorkerFilePath) {
   EXPECT_THAT(StreamWorkerFilePath("/path/to/snapshot", /*stream_index=*/0),
               MatchesRegex("/path/to/snapshot.streams.stream_0.owner_worker"));
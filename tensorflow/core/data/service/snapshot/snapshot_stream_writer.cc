@@ -43,6 +43,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/mutex.h"
 #include "tsl/platform/path.h"
@@ -53,6 +54,8 @@ namespace tensorflow {
 namespace data {
 namespace {
 
+using ::tensorflow::data::experimental::DistributedSnapshotChunkManifest;
+
 constexpr int64_t kTFRecordReaderOutputBufferSize = 512 << 20;  // 512MB
 constexpr int64_t kUnknownNumElements = -1;
 
@@ -214,24 +217,47 @@ absl::Status SnapshotStreamWriter::WriteRecord(ParallelTFRecordWriter& writer) {
 
 absl::Status SnapshotStreamWriter::Commit(
     const ParallelTFRecordWriter::FileToStatsMap& file_stats) {
+  // Records the chunks in the manifest before writing the checkpoint, so that
+  // a restarted worker knows the names of the chunks it should commit. Only
+  // the chunks of this commit are recorded, so that the manifest does not grow
+  // with the stream.
+  manifest_.Clear();
+  int64_t chunk_index = chunk_index_;
+  for (const auto& [file, stats] : file_stats) {
+    DistributedSnapshotChunkManifest::Chunk* chunk = manifest_.add_chunks();
+    chunk->set_chunk_index(chunk_index++);
+    chunk->set_num_elements(stats.num_records);
+    chunk->set_fingerprint(stats.fingerprint);
+    chunk->set_uncommitted_filename(std::string(tsl::io::Basename(file)));
+  }
+  TF_RETURN_IF_ERROR(AtomicallyWriteBinaryProto(params_.ChunkManifestFilePath(),
+                                                manifest_, params_.env));
+
   // Writes the checkpoint before committing the chunks. Once the checkpoint is
   // written, the chunks before the checkpoint are considered done. If the
   // worker restarts before committing the files in `file_stats`, the restarted
   // worker should commit the uncommitted chunks (see SyncCheckpointWithChunks).
   TF_RETURN_IF_ERROR(Save(file_stats));
 
-  // Commits all chunks since the last commit.
+  // Commits all chunks since the last commit, in the order of their indices.
+  int i = 0;
   for (const auto& [file, stats] : file_stats) {
     std::string committed_chunk_path =
         tsl::io::JoinPath(params_.CommittedChunksDirectory(),
-                          absl::StrCat("chunk_", params_.stream_index, "_",
-                                       chunk_index_++, "_", stats.num_records));
+                          CommittedChunkFilename(manifest_.chunks(i++)));
     TF_RETURN_IF_ERROR(params_.env->RenameFile(file, committed_chunk_path));
   }
+  chunk_index_ = chunk_index;
   last_commit_time_ = absl::FromUnixMicros(params_.env->NowMicros());
   return absl::OkStatus();
 }
 
+std::string SnapshotStreamWriter::CommittedChunkFilename(
+    const DistributedSnapshotChunkManifest::Chunk& chunk) const {
+  return ChunkFilename(params_.stream_index, chunk.chunk_index(),
+                       chunk.num_elements(), chunk.fingerprint());
+}
+
 absl::Status SnapshotStreamWriter::FinalizeStream(absl::Status status) {
   if (status.ok()) {
     status = WriteDoneFile();
@@ -354,6 +380,7 @@ absl::Status SnapshotStreamWriter::Restore() {
   if (absl::IsNotFound(checkpoint_name.status())) {
     // No checkpoint has been written. Deletes any uncommitted chunks.
     // Otherwise, it may attempt to write an existing file.
+    TF_RETURN_IF_ERROR(ReadManifest(/*checkpoint_index=*/std::nullopt));
     return SyncCheckpointWithChunks(/*checkpoint_index=*/std::nullopt,
                                     kUnknownNumElements);
   }
@@ -368,6 +395,7 @@ absl::Status SnapshotStreamWriter::Restore() {
   TF_ASSIGN_OR_RETURN(auto checkpoint_name_tokens,
                       ParseCheckpointFilename(*checkpoint_name));
   auto [checkpoint_index, checkpoint_num_elements] = checkpoint_name_tokens;
+  TF_RETURN_IF_ERROR(ReadManifest(checkpoint_index));
   TF_RETURN_IF_ERROR(
       SyncCheckpointWithChunks(checkpoint_index, checkpoint_num_elements));
   chunk_index_ = checkpoint_index;
@@ -377,6 +405,25 @@ absl::Status SnapshotStreamWriter::Restore() {
   return absl::OkStatus();
 }
 
+absl::Status SnapshotStreamWriter::ReadManifest(
+    std::optional<int64_t> checkpoint_index) {
+  manifest_.Clear();
+  if (!checkpoint_index.has_value() ||
+      !params_.env->FileExists(params_.ChunkManifestFilePath()).ok()) {
+    return absl::OkStatus();
+  }
+  TF_RETURN_IF_ERROR(tsl::ReadBinaryProto(
+      params_.env, params_.ChunkManifestFilePath(), &manifest_));
+  // The worker may have failed after recording chunks in the manifest but
+  // before checkpointing them. They will be written again.
+  while (manifest_.chunks_size() > 0 &&
+         manifest_.chunks(manifest_.chunks_size() - 1).chunk_index() >=
+             *checkpoint_index) {
+    manifest_.mutable_chunks()->RemoveLast();
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::string> SnapshotStreamWriter::LastCheckpointName() const {
   TF_ASSIGN_OR_RETURN(std::vector<std::string> checkpoint_names,
                       GetChildren(params_.CheckpointsDirectory(), params_.env));
@@ -412,6 +459,12 @@ absl::Status SnapshotStreamWriter::SyncCheckpointWithChunks(
 
   TF_ASSIGN_OR_RETURN(int64_t last_committed_chunk_index,
                       LastCommittedChunkIndex());
+  absl::flat_hash_map<std::string,
+                      const DistributedSnapshotChunkManifest::Chunk*>
+      manifest_chunks;
+  for (const auto& chunk : manifest_.chunks()) {
+    manifest_chunks[chunk.uncommitted_filename()] = &chunk;
+  }
   int64_t next_chunk_index = last_committed_chunk_index + 1;
   for (const std::string& uncommitted_chunk : uncommitted_chunks) {
     std::string uncommitted_chunk_filename = tsl::io::JoinPath(
@@ -420,13 +473,23 @@ absl::Status SnapshotStreamWriter::SyncCheckpointWithChunks(
                         GetUncommittedChunkIndex(uncommitted_chunk));
     if (checkpoint_index.has_value() &&
         uncommitted_chunk_index < *checkpoint_index) {
-      int64_t chunk_num_elements = (next_chunk_index == *checkpoint_index - 1)
-                                       ? checkpoint_num_elements
-                                       : kUnknownNumElements;
+      // Chunks recorded in the manifest keep their index, number of elements,
+      // and fingerprint. The others were written without a manifest.
+      std::string committed_chunk_name;
+      auto manifest_chunk = manifest_chunks.find(uncommitted_chunk);
+      if (manifest_chunk != manifest_chunks.end()) {
+        committed_chunk_name = CommittedChunkFilename(*manifest_chunk->second);
+      } else {
+        int64_t chunk_num_elements =
+            (next_chunk_index == *checkpoint_index - 1)
+                ? checkpoint_num_elements
+                : kUnknownNumElements;
+        committed_chunk_name =
+            absl::StrCat("chunk_", params_.stream_index, "_", next_chunk_index,
+                         "_", chunk_num_elements);
+      }
       std::string committed_chunk_filename = tsl::io::JoinPath(
-          params_.CommittedChunksDirectory(),
-          absl::StrCat("chunk_", params_.stream_index, "_", next_chunk_index,
-                       "_", chunk_num_elements));
+          params_.CommittedChunksDirectory(), committed_chunk_name);
       TF_RETURN_IF_ERROR(params_.env->RenameFile(uncommitted_chunk_filename,
                                                  committed_chunk_filename));
       ++next_chunk_index;
@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/protobuf/service_config.pb.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/mutex.h"
 #include "tsl/platform/thread_annotations.h"
@@ -88,6 +89,10 @@ struct SnapshotWriterParams {
     return tensorflow::data::CheckpointsDirectory(snapshot_path, stream_index);
   }
 
+  std::string ChunkManifestFilePath() const {
+    return tensorflow::data::ChunkManifestFilePath(snapshot_path, stream_index);
+  }
+
   std::string DebugString() const {
     return absl::Substitute(
         "SnapshotWriterParams { base_path: $0, stream: $1, compression: $2 }",
@@ -103,11 +108,12 @@ struct SnapshotWriterParams {
 //   - snapshot.metadata
 //   - dataset_def.proto
 //   - chunks
-//     - chunk_<stream_index>_<chunk_index>_<num_elements>
+//     - chunk_<stream_index>_<chunk_index>_<num_elements>_<fingerprint>
 //   - streams
 //     - stream_0
 //       - DONE
 //       - ERROR
+//       - chunk_manifest
 //       - splits
 //         - split_<local_split_index>_<global_split_index>
 //       - uncommitted chunks
@@ -115,6 +121,12 @@ struct SnapshotWriterParams {
 //       - checkpoints
 //         - checkpoint_<chunk_index>_<num_elements>
 //
+// Committed chunks are named after the fingerprint of their elements, in the
+// order they were written to the chunk. Chunks with the same fingerprint have
+// the same content, within and across snapshots. The chunk manifest records
+// the chunks being committed, so that a restarted worker commits them under
+// the same names.
+//
 // This class is thread-safe.
 class SnapshotStreamWriter {
  public:
@@ -173,6 +185,14 @@ class SnapshotStreamWriter {
   // Commits the chunks since the last commit.
   absl::Status Commit(const ParallelTFRecordWriter::FileToStatsMap& file_stats);
 
+  // Returns the file name of the committed chunk for `chunk`.
+  std::string CommittedChunkFilename(
+      const experimental::DistributedSnapshotChunkManifest::Chunk& chunk) const;
+
+  // Reads the chunk manifest of the stream, if it has been written, dropping
+  // the chunks at/after `checkpoint_index`, which were not committed.
+  absl::Status ReadManifest(std::optional<int64_t> checkpoint_index);
+
   // Writes a DONE file when the stream is finished. Writes an ERROR file if it
   // failed.
   absl::Status FinalizeStream(absl::Status status);
@@ -219,6 +239,8 @@ class SnapshotStreamWriter {
 
   // Index of the next chunk to write.
   int64_t chunk_index_ = 0;
+  // The chunks of the latest commit.
+  experimental::DistributedSnapshotChunkManifest manifest_;
   // Timestamp when the last chunks are committed.
   absl::Time last_commit_time_ = absl::Now();
 
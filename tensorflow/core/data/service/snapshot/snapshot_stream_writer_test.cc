@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/data/standalone.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/lib/io/compression.h"
 #include "tsl/lib/monitoring/cell_reader.h"
@@ -48,10 +49,14 @@ namespace tensorflow {
 namespace data {
 namespace {
 
+using ::testing::Contains;
 using ::testing::HasSubstr;
 using ::testing::IsEmpty;
+using ::testing::IsSupersetOf;
+using ::testing::Not;
 using ::testing::SizeIs;
 using ::testing::UnorderedElementsAre;
+using ::testing::UnorderedElementsAreArray;
 using ::testing::ValuesIn;
 using ::tsl::monitoring::testing::CellReader;
 using ::tsl::testing::IsOkAndHolds;
@@ -222,6 +227,75 @@ TEST_P(SnapshotStreamWriterParameterizedTest, WriteSnapshotChunks) {
               IsOkAndHolds(UnorderedElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9)));
 }
 
+TEST_P(SnapshotStreamWriterParameterizedTest, WriteChunkManifest) {
+  int64_t range = 10;
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
+                          TestIterator(testing::RangeDataset(range)));
+
+  TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, CreateSnapshotDirectory());
+  SnapshotWriterParams writer_params{snapshot_path, /*stream_index=*/0,
+                                     Compression(), Env::Default(),
+                                     /*max_chunk_size=*/ByteSize::Bytes(1)};
+  SnapshotStreamWriter snapshot_writer(writer_params, std::move(iterator));
+  EXPECT_THAT(snapshot_writer.Wait(), IsOkAndHolds(true));
+
+  // The manifest records the chunks of the last commit, which are committed
+  // under the names of their fingerprints.
+  experimental::DistributedSnapshotChunkManifest manifest;
+  TF_ASSERT_OK(tsl::ReadBinaryProto(
+      Env::Default(), writer_params.ChunkManifestFilePath(), &manifest));
+  EXPECT_THAT(manifest.chunks(), Not(IsEmpty()));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::string> committed_chunks,
+      GetChildren(writer_params.CommittedChunksDirectory(), Env::Default()));
+  EXPECT_THAT(committed_chunks, SizeIs(range));
+  for (const auto& chunk : manifest.chunks()) {
+    EXPECT_EQ(chunk.num_elements(), 1);
+    EXPECT_THAT(committed_chunks,
+                Contains(ChunkFilename(/*stream_index=*/0, chunk.chunk_index(),
+                                       chunk.num_elements(),
+                                       chunk.fingerprint())));
+  }
+}
+
+TEST_P(SnapshotStreamWriterParameterizedTest, SameElementsSameChunkNames) {
+  // Returns the fingerprints of the chunks of a snapshot of `range`, which has
+  // one element per chunk.
+  auto chunk_fingerprints =
+      [this](int64_t range) -> absl::StatusOr<std::vector<uint64_t>> {
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<StandaloneTaskIterator> iterator,
+                        TestIterator(testing::RangeDataset(range)));
+    TF_ASSIGN_OR_RETURN(std::string snapshot_path, CreateSnapshotDirectory());
+    SnapshotWriterParams writer_params{snapshot_path, /*stream_index=*/0,
+                                       Compression(), Env::Default(),
+                                       /*max_chunk_size=*/ByteSize::Bytes(1)};
+    SnapshotStreamWriter snapshot_writer(writer_params, std::move(iterator));
+    TF_RETURN_IF_ERROR(snapshot_writer.Wait().status());
+    TF_ASSIGN_OR_RETURN(
+        std::vector<std::string> chunks,
+        GetChildren(writer_params.CommittedChunksDirectory(), Env::Default()));
+    std::vector<uint64_t> fingerprints;
+    for (const std::string& chunk : chunks) {
+      TF_ASSIGN_OR_RETURN(std::optional<uint64_t> fingerprint,
+                          ParseChunkFingerprint(chunk));
+      if (!fingerprint.has_value()) {
+        return absl::InternalError(
+            absl::StrCat("Chunk ", chunk, " has no fingerprint."));
+      }
+      fingerprints.push_back(*fingerprint);
+    }
+    return fingerprints;
+  };
+
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<uint64_t> fingerprints,
+                          chunk_fingerprints(/*range=*/5));
+  EXPECT_THAT(chunk_fingerprints(/*range=*/5),
+              IsOkAndHolds(UnorderedElementsAreArray(fingerprints)));
+  // The first 5 elements of a larger snapshot have the same chunks.
+  EXPECT_THAT(chunk_fingerprints(/*range=*/10),
+              IsOkAndHolds(IsSupersetOf(fingerprints)));
+}
+
 TEST_P(SnapshotStreamWriterParameterizedTest, WriteDoneFile) {
   int64_t range = 10;
   TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
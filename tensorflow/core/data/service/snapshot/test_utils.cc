@@ -17,6 +17,7 @@ limitations under the License.
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -52,12 +53,9 @@ absl::StatusOr<std::string> CreateTmpDirectory() {
 }
 
 absl::StatusOr<int64_t> CommittedChunkIndex(const std::string& chunk_file) {
-  std::vector<std::string> tokens = absl::StrSplit(chunk_file, '_');
-  int64_t result = 0;
-  if (tokens.size() != 4 || !absl::SimpleAtoi(tokens[2], &result)) {
-    return absl::InternalError("Invalid");
-  }
-  return result;
+  TF_ASSIGN_OR_RETURN(auto chunk_filename_tokens,
+                      ParseChunkFilename(chunk_file));
+  return std::get<1>(chunk_filename_tokens);
 }
 
 absl::StatusOr<int64_t> CheckpointIndex(const std::string& checkpoint_file) {
@@ -14,14 +14,19 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/snapshot/utils.h"
 
+#include <cstdint>
 #include <vector>
 
+#include "absl/status/statusor.h"
 #include "absl/strings/match.h"
 #include "absl/strings/string_view.h"
+#include "tensorflow/core/data/hash_utils.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/types.pb.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/hash.h"
 #include "tsl/platform/status.h"
 
 namespace tensorflow {
@@ -37,5 +42,21 @@ ByteSize EstimatedSize(const std::vector<Tensor>& tensors) {
   return byte_size;
 }
 
+absl::StatusOr<uint64_t> Fingerprint(const std::vector<Tensor>& tensors) {
+  uint64_t fingerprint = 0;
+  for (const Tensor& tensor : tensors) {
+    uint64 tensor_fingerprint = 0;
+    if (tensor.dtype() == DT_VARIANT) {
+      TensorProto proto;
+      tensor.AsProtoTensorContent(&proto);
+      tensor_fingerprint = Hash64(proto.SerializeAsString());
+    } else {
+      TF_RETURN_IF_ERROR(HashTensor(tensor, &tensor_fingerprint));
+    }
+    fingerprint = Hash64Combine(fingerprint, tensor_fingerprint);
+  }
+  return fingerprint;
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -15,8 +15,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_UTILS_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_UTILS_H_
 
+#include <cstdint>
 #include <vector>
 
+#include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -27,6 +29,10 @@ namespace data {
 
 ByteSize EstimatedSize(const std::vector<Tensor>& tensors);
 
+// Returns a fingerprint of the element made of `tensors`, which identifies its
+// content. Variant tensors are fingerprinted by their serialized content.
+absl::StatusOr<uint64_t> Fingerprint(const std::vector<Tensor>& tensors);
+
 }  // namespace data
 }  // namespace tensorflow
 
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/snapshot/utils.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -28,12 +29,17 @@ limitations under the License.
 #include "tsl/platform/errors.h"
 #include "tsl/platform/protobuf.h"
 #include "tsl/platform/status.h"
+#include "tsl/platform/status_matchers.h"
 #include "tsl/platform/test.h"
+#include "tsl/platform/tstring.h"
 
 namespace tensorflow {
 namespace data {
 namespace {
 
+using ::testing::Not;
+using ::tsl::testing::IsOkAndHolds;
+
 TEST(UtilsTest, EstimatedSizeBytes) {
   // int64 Tensor of size 1000.
   Tensor tensor(DT_INT64, TensorShape({10, 100}));
@@ -71,6 +77,31 @@ TEST(UtilsTest, EmptyTensor) {
   EXPECT_GT(EstimatedSize({Tensor()}), ByteSize::Bytes(0));
 }
 
+TEST(UtilsTest, Fingerprint) {
+  Tensor a(int64_t{1}), b(int64_t{2});
+  Tensor s(tstring("a"));
+  TF_ASSERT_OK_AND_ASSIGN(uint64_t ab, Fingerprint({a, b}));
+  EXPECT_THAT(Fingerprint({Tensor(int64_t{1}), Tensor(int64_t{2})}),
+              IsOkAndHolds(ab));
+  EXPECT_THAT(Fingerprint({b, a}), IsOkAndHolds(Not(ab)));
+  EXPECT_THAT(Fingerprint({a, s}), IsOkAndHolds(Not(ab)));
+}
+
+TEST(UtilsTest, VariantFingerprint) {
+  std::unique_ptr<CompressedElement> compressed{
+      protobuf::Arena::CreateMessage<CompressedElement>(nullptr)};
+  compressed->set_data(std::string(1000, 'a'));
+  Tensor a(DT_VARIANT, TensorShape({}));
+  a.scalar<Variant>()() = *compressed;
+  compressed->set_data(std::string(1000, 'b'));
+  Tensor b(DT_VARIANT, TensorShape({}));
+  b.scalar<Variant>()() = *compressed;
+
+  TF_ASSERT_OK_AND_ASSIGN(uint64_t fingerprint, Fingerprint({a}));
+  EXPECT_THAT(Fingerprint({a}), IsOkAndHolds(fingerprint));
+  EXPECT_THAT(Fingerprint({b}), IsOkAndHolds(Not(fingerprint)));
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
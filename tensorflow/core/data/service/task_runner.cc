@@ -17,9 +17,11 @@ limitations under the License.
 #include <algorithm>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/cross_trainer_cache.h"
@@ -31,7 +33,9 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
@@ -100,8 +104,12 @@ Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
         worker_config.cross_trainer_cache_size_bytes() > 0
             ? worker_config.cross_trainer_cache_size_bytes()
             : kDefaultCrossTrainerCacheSizeBytes;
-    out = std::make_unique<CachingTaskRunner>(std::move(iterator),
-                                              max_cache_size_bytes);
+    CrossTrainerCacheDiskOptions disk_options;
+    disk_options.directory = worker_config.cross_trainer_cache_disk_dir();
+    disk_options.max_size_bytes =
+        worker_config.cross_trainer_cache_disk_size_bytes();
+    out = std::make_unique<CachingTaskRunner>(
+        std::move(iterator), max_cache_size_bytes, disk_options);
   } else {
     out = std::make_unique<FirstComeFirstServedTaskRunner>(std::move(iterator));
   }
@@ -175,11 +183,23 @@ std::shared_ptr<model::Model> FirstComeFirstServedTaskRunner::model() const {
 
 CachingTaskRunner::CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
                                      size_t max_cache_size_bytes)
+    : CachingTaskRunner(std::move(iterator), max_cache_size_bytes,
+                        CrossTrainerCacheDiskOptions()) {}
+
+CachingTaskRunner::CachingTaskRunner(
+    std::unique_ptr<TaskIterator> iterator, size_t max_cache_size_bytes,
+    const CrossTrainerCacheDiskOptions& disk_options)
     : fcfs_task_runner_(std::move(iterator)),
       cache_(max_cache_size_bytes,
-             std::make_unique<GetElementResultSequence>(fcfs_task_runner_)) {
+             std::make_unique<GetElementResultSequence>(fcfs_task_runner_),
+             disk_options) {
   LOG(INFO) << "Initialized tf.data service cross-trainer cache with "
             << ByteSize::Bytes(max_cache_size_bytes) << " of memory.";
+  if (!disk_options.directory.empty()) {
+    LOG(INFO) << "Initialized tf.data service cross-trainer cache disk tier "
+              << "with " << ByteSize::Bytes(disk_options.max_size_bytes)
+              << " in " << disk_options.directory << ".";
+  }
 }
 
 CachingTaskRunner::~CachingTaskRunner() { Cancel(); }
@@ -213,6 +233,67 @@ size_t CachingTaskRunner::GetElementResultSequence::GetElementSizeBytes(
   return element.EstimatedMemoryUsageBytes();
 }
 
+StatusOr<std::string> CachingTaskRunner::GetElementResultSequence::Serialize(
+    const GetElementResult& element) const {
+  GetElementResponse resp;
+  resp.set_element_index(element.element_index);
+  resp.set_end_of_sequence(element.end_of_sequence);
+  resp.set_skip_task(element.skip);
+  const std::vector<Tensor>& components = element.components;
+  const CompressedElement* compressed = nullptr;
+  if (components.size() == 1 && components[0].dtype() == DT_VARIANT &&
+      TensorShapeUtils::IsScalar(components[0].shape())) {
+    compressed = components[0].scalar<Variant>()().get<CompressedElement>();
+  }
+  if (compressed != nullptr) {
+    *resp.mutable_compressed() = *compressed;
+  } else {
+    for (const auto& component : components) {
+      component.AsProtoTensorContent(
+          resp.mutable_uncompressed()->add_components());
+    }
+  }
+  std::string serialized;
+  if (!resp.SerializeToString(&serialized)) {
+    return errors::Internal(
+        "Failed to serialize tf.data service cross-trainer cache element.");
+  }
+  return serialized;
+}
+
+StatusOr<GetElementResult>
+CachingTaskRunner::GetElementResultSequence::Deserialize(
+    absl::string_view serialized) const {
+  GetElementResponse resp;
+  if (!resp.ParseFromArray(serialized.data(), serialized.size())) {
+    return errors::DataLoss(
+        "Failed to parse tf.data service cross-trainer cache element.");
+  }
+  GetElementResult result;
+  result.element_index = resp.element_index();
+  result.end_of_sequence = resp.end_of_sequence();
+  result.skip = resp.skip_task();
+  switch (resp.element_case()) {
+    case GetElementResponse::kCompressed: {
+      Tensor tensor(DT_VARIANT, TensorShape{});
+      tensor.scalar<Variant>()() = std::move(*resp.mutable_compressed());
+      result.components.push_back(std::move(tensor));
+      break;
+    }
+    case GetElementResponse::kUncompressed:
+      for (const auto& component : resp.uncompressed().components()) {
+        result.components.emplace_back();
+        if (!result.components.back().FromProto(component)) {
+          return errors::DataLoss("Failed to parse tensor.");
+        }
+      }
+      break;
+    case GetElementResponse::ELEMENT_NOT_SET:
+      break;
+  }
+  return result;
+}
+
 void CachingTaskRunner::Cancel() {
   VLOG(2) << "Cancelling tf.data service cross-trainer cache task.";
   if (!cache_.IsCancelled()) {
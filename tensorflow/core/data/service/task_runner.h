@@ -17,8 +17,10 @@ limitations under the License.
 
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/cross_trainer_cache.h"
 #include "tensorflow/core/data/service/data_transfer.h"
@@ -154,6 +156,11 @@ class CachingTaskRunner : public TaskRunner {
  public:
   explicit CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
                              size_t max_cache_size_bytes);
+  // Creates a `CachingTaskRunner` whose cache moves elements evicted from
+  // memory to the disk tier described by `disk_options`.
+  CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
+                    size_t max_cache_size_bytes,
+                    const CrossTrainerCacheDiskOptions& disk_options);
   ~CachingTaskRunner() override;
 
   // Gets the next element from the cross-trainer cache, blocking if the data is
@@ -179,6 +186,12 @@ class CachingTaskRunner : public TaskRunner {
         FirstComeFirstServedTaskRunner& fcfs_task_runner);
     StatusOr<GetElementResult> GetNext() override;
     size_t GetElementSizeBytes(const GetElementResult& element) const override;
+    // Serializes elements as `GetElementResponse` protos for the disk tier of
+    // the cache.
+    StatusOr<std::string> Serialize(
+        const GetElementResult& element) const override;
+    StatusOr<GetElementResult> Deserialize(
+        absl::string_view serialized) const override;
 
    private:
     FirstComeFirstServedTaskRunner& fcfs_task_runner_;
@@ -64,8 +64,11 @@ Status TestCluster::Initialize() {
     dispatcher_config.set_fault_tolerant_mode(true);
   }
   dispatcher_config.set_protocol(kProtocol);
-  for (int i = 0; i < num_workers_; ++i) {
-    dispatcher_config.add_worker_addresses("localhost");
+  // Auto-scaling requires a dynamic set of workers.
+  if (!config_.auto_scaling_options.has_value()) {
+    for (int i = 0; i < num_workers_; ++i) {
+      dispatcher_config.add_worker_addresses("localhost");
+    }
   }
   dispatcher_config.set_deployment_mode(DEPLOYMENT_MODE_COLOCATED);
   dispatcher_config.set_job_gc_check_interval_ms(
@@ -80,6 +83,11 @@ Status TestCluster::Initialize() {
   for (int i = 0; i < num_workers_; ++i) {
     TF_RETURN_IF_ERROR(AddWorker());
   }
+  if (config_.auto_scaling_options.has_value()) {
+    TF_RETURN_IF_ERROR(dispatcher_->EnableAutoScaling(
+        *config_.auto_scaling_options,
+        std::make_unique<TestClusterWorkerLauncher>(*this)));
+  }
   return OkStatus();
 }
 
@@ -116,11 +124,12 @@ void TestCluster::StopWorker(size_t index) {
   DCHECK_GE(index, 0);
   DCHECK_LT(index, worker_addresses_.size());
   workers_[index]->Stop();
+  stopped_workers_.insert(index);
 }
 
 void TestCluster::StopWorkers() {
-  for (std::unique_ptr<WorkerGrpcDataServer>& worker : workers_) {
-    worker->Stop();
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    StopWorker(i);
   }
 }
 
@@ -132,5 +141,24 @@ ServerStateExport TestCluster::ExportWorkerState(size_t index) const {
   return workers_[index]->ExportState();
 }
 
+Status TestClusterWorkerLauncher::AddWorkers(int64_t num_workers) {
+  for (int64_t i = 0; i < num_workers; ++i) {
+    TF_RETURN_IF_ERROR(cluster_.AddWorker());
+  }
+  return OkStatus();
+}
+
+Status TestClusterWorkerLauncher::RemoveWorker(
+    const std::string& worker_address) {
+  for (size_t i = 0; i < cluster_.NumWorkers(); ++i) {
+    if (cluster_.WorkerAddress(i) == worker_address) {
+      cluster_.StopWorker(i);
+      return OkStatus();
+    }
+  }
+  return errors::NotFound("Worker ", worker_address,
+                          " is not in the test cluster.");
+}
+
 }  // namespace data
 }  // namespace tensorflow
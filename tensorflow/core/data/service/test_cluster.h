@@ -23,8 +23,10 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/types/optional.h"
+#include "tensorflow/core/data/service/auto_scaling_controller.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/dispatcher.pb.h"
@@ -55,6 +57,10 @@ class TestCluster {
     int64_t job_gc_check_interval_ms = 0;
     int64_t job_gc_timeout_ms = 0;
     std::string work_dir;
+    // If set, the dispatcher adds and stops workers of this cluster. Scaling
+    // decisions are taken by `ScaleWorkers`, and by the dispatcher every
+    // `job_gc_check_interval_ms`.
+    std::optional<AutoScalingOptions> auto_scaling_options;
   };
 
   // Creates a new test cluster with a dispatcher and `num_workers` workers.
@@ -67,8 +73,12 @@ class TestCluster {
   Status Initialize();
   // Adds a new worker to the cluster.
   Status AddWorker(std::optional<int> port = std::nullopt);
-  // Returns the number of workers in this cluster.
+  // Returns the number of workers in this cluster, including stopped ones.
   size_t NumWorkers() const { return workers_.size(); }
+  // Returns the number of workers which have not been stopped.
+  size_t NumRunningWorkers() const {
+    return workers_.size() - stopped_workers_.size();
+  }
   // Returns the port number of a worker.
   int WorkerBoundPort(size_t worker_index) const {
     return workers_[worker_index]->BoundPort();
@@ -89,6 +99,10 @@ class TestCluster {
   // Stops all workers.
   void StopWorkers();
 
+  // Asks the dispatcher to take an auto-scaling decision now. Requires
+  // `Config::auto_scaling_options`.
+  Status ScaleWorkers() { return dispatcher_->ScaleWorkers(); }
+
   // Returns the server state exports.
   ServerStateExport ExportDispatcherState() const;
   ServerStateExport ExportWorkerState(size_t index) const;
@@ -101,6 +115,23 @@ class TestCluster {
   std::string dispatcher_address_;
   std::vector<std::unique_ptr<WorkerGrpcDataServer>> workers_;
   std::vector<std::string> worker_addresses_;
+  // Indices of the workers stopped by `StopWorker`.
+  absl::flat_hash_set<size_t> stopped_workers_;
+};
+
+// Adds and stops the workers of a `TestCluster` on behalf of the dispatcher's
+// auto-scaling controller. The cluster must outlive the launcher. It should not
+// be modified by the test while the dispatcher scales it.
+class TestClusterWorkerLauncher : public WorkerLauncher {
+ public:
+  explicit TestClusterWorkerLauncher(TestCluster& cluster)
+      : cluster_(cluster) {}
+
+  Status AddWorkers(int64_t num_workers) override;
+  Status RemoveWorker(const std::string& worker_address) override;
+
+ private:
+  TestCluster& cluster_;
 };
 
 // A test utility to provide a `DatasetDef` to a `TestCluster` and generate data
@@ -135,7 +166,10 @@ class DatasetClient {
       ProcessingModeDef::ShardingPolicy sharding_policy,
       TargetWorkers target_workers);
   // Creates an iteration and returns the iteration client ID.
-  StatusOr<int64_t> CreateIteration(const DatasetDef& dataset);
+  StatusOr<int64_t> CreateIteration(
+      const DatasetDef& dataset,
+      ProcessingModeDef::ShardingPolicy sharding_policy =
+          ProcessingModeDef::OFF);
   // Gets the tasks for iteration `iteration_client_id`. The iteration has one
   // task processed by every worker.
   StatusOr<std::vector<TaskInfo>> GetTasks(int64_t iteration_client_id);
@@ -214,10 +248,11 @@ StatusOr<int64_t> DatasetClient<T>::CreateIteration(
 }
 
 template <class T>
-StatusOr<int64_t> DatasetClient<T>::CreateIteration(const DatasetDef& dataset) {
+StatusOr<int64_t> DatasetClient<T>::CreateIteration(
+    const DatasetDef& dataset,
+    ProcessingModeDef::ShardingPolicy sharding_policy) {
   TF_ASSIGN_OR_RETURN(const std::string dataset_id, RegisterDataset(dataset));
-  return CreateIteration(dataset_id, ProcessingModeDef::OFF,
-                         TARGET_WORKERS_ANY);
+  return CreateIteration(dataset_id, sharding_policy, TARGET_WORKERS_ANY);
 }
 
 template <class T>
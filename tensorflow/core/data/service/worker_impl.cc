@@ -236,6 +236,14 @@ Status DataServiceWorkerImpl::ValidateWorkerConfig() const {
                       config_.worker_tags().end(), ", "),
         "}");
   }
+  if (!config_.cross_trainer_cache_disk_dir().empty() &&
+      config_.cross_trainer_cache_disk_size_bytes() <= 0) {
+    return errors::FailedPrecondition(
+        "The cross-trainer cache disk tier in ",
+        config_.cross_trainer_cache_disk_dir(),
+        " requires a positive cross_trainer_cache_disk_size_bytes. Got ",
+        config_.cross_trainer_cache_disk_size_bytes(), ".");
+  }
   return OkStatus();
 }
 
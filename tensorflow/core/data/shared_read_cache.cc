@@ -0,0 +1,384 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/shared_read_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+#include "tsl/lib/io/zlib_block_inputstream.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr int64_t kDefaultCapacityMB = 256;
+
+void DeleteBlock(const Slice& key, void* value) {
+  delete static_cast<std::shared_ptr<const std::string>*>(value);
+}
+
+}  // namespace
+
+// A file whose reads are served by the blocks of a `SharedReadCache`.
+class SharedReadCache::CachedFile : public RandomAccessFile {
+ public:
+  CachedFile(SharedReadCache* cache, const std::string& filename,
+             std::unique_ptr<RandomAccessFile> file, uint64 file_size,
+             int64_t mtime_nsec)
+      : cache_(cache),
+        filename_(filename),
+        key_prefix_(absl::StrCat(filename, "\n", file_size, "\n", mtime_nsec,
+                                 "\n")),
+        file_(std::move(file)),
+        file_size_(file_size) {}
+
+  Status Name(StringPiece* result) const override {
+    *result = filename_;
+    return OkStatus();
+  }
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    const uint64 end = std::min<uint64>(offset + n, file_size_);
+    size_t bytes_read = 0;
+    while (offset + bytes_read < end) {
+      const uint64 position = offset + bytes_read;
+      const uint64 index = position / cache_->block_size_;
+      Block block;
+      Status s = cache_->GetBlock(key_prefix_, *file_, file_size_, index,
+                                  &block);
+      if (!s.ok()) {
+        *result = StringPiece(scratch, bytes_read);
+        return s;
+      }
+      const size_t block_offset = position - index * cache_->block_size_;
+      if (block_offset >= block->size()) {
+        // The file was truncated after it was opened.
+        break;
+      }
+      const size_t length =
+          std::min<uint64>(block->size() - block_offset, end - position);
+      memcpy(scratch + bytes_read, block->data() + block_offset, length);
+      bytes_read += length;
+    }
+    *result = StringPiece(scratch, bytes_read);
+    if (bytes_read < n) {
+      return errors::OutOfRange("Read fewer bytes than requested from ",
+                                filename_);
+    }
+    return OkStatus();
+  }
+
+ private:
+  SharedReadCache* const cache_;
+  const std::string filename_;
+  const std::string key_prefix_;
+  const std::unique_ptr<RandomAccessFile> file_;
+  const uint64 file_size_;
+};
+
+// The decompressed contents of a file, shared by the readers of the file.
+struct SharedReadCache::DecompressionStream {
+  DecompressionStream(std::unique_ptr<RandomAccessFile> file,
+                      const io::ZlibCompressionOptions& zlib_options)
+      : file(std::move(file)),
+        stream(std::make_unique<tsl::io::ZlibBlockInputStream>(
+            this->file.get(), new io::RandomAccessInputStream(this->file.get()),
+            zlib_options, /*thread_pool=*/nullptr,
+            /*max_blocks_in_flight=*/1)) {}
+
+  const std::unique_ptr<RandomAccessFile> file;
+  mutex mu;
+  // `stream` borrows `file`, so it is destroyed first.
+  const std::unique_ptr<io::InputStreamInterface> stream TF_PT_GUARDED_BY(mu);
+  // Index of the next block decompressed from `stream`.
+  uint64 next_index TF_GUARDED_BY(mu) = 0;
+};
+
+// A file whose reads are served by the decompressed blocks of a
+// `SharedReadCache`.
+class SharedReadCache::DecompressedFile : public RandomAccessFile {
+ public:
+  DecompressedFile(SharedReadCache* cache, const std::string& filename,
+                   const std::string& key_prefix,
+                   std::shared_ptr<DecompressionStream> stream)
+      : cache_(cache),
+        filename_(filename),
+        key_prefix_(key_prefix),
+        stream_(std::move(stream)) {}
+
+  Status Name(StringPiece* result) const override {
+    *result = filename_;
+    return OkStatus();
+  }
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    size_t bytes_read = 0;
+    while (bytes_read < n) {
+      const uint64 position = offset + bytes_read;
+      const uint64 index = position / cache_->block_size_;
+      Block block;
+      Status s = cache_->GetDecompressedBlock(key_prefix_, stream_.get(),
+                                              index, &block);
+      if (!s.ok()) {
+        *result = StringPiece(scratch, bytes_read);
+        return s;
+      }
+      const size_t block_offset = position - index * cache_->block_size_;
+      if (block_offset >= block->size()) {
+        break;
+      }
+      const size_t length =
+          std::min<uint64>(block->size() - block_offset, n - bytes_read);
+      memcpy(scratch + bytes_read, block->data() + block_offset, length);
+      bytes_read += length;
+    }
+    *result = StringPiece(scratch, bytes_read);
+    if (bytes_read < n) {
+      return errors::OutOfRange("Read fewer bytes than requested from ",
+                                filename_);
+    }
+    return OkStatus();
+  }
+
+ private:
+  SharedReadCache* const cache_;
+  const std::string filename_;
+  const std::string key_prefix_;
+  const std::shared_ptr<DecompressionStream> stream_;
+};
+
+SharedReadCache::SharedReadCache(size_t capacity, size_t block_size)
+    : block_size_(block_size), cache_(table::NewLRUCache(capacity)) {
+  DCHECK_GT(block_size_, 0);
+}
+
+SharedReadCache::~SharedReadCache() = default;
+
+SharedReadCache* SharedReadCache::Global() {
+  static SharedReadCache* cache = [] {
+    int64_t capacity_mb = kDefaultCapacityMB;
+    Status s = ReadInt64FromEnvVar("TF_DATA_SHARED_READ_CACHE_SIZE_MB",
+                                   kDefaultCapacityMB, &capacity_mb);
+    if (!s.ok()) {
+      LOG(ERROR) << "SharedReadCache: " << s.message();
+    }
+    return new SharedReadCache(std::max<int64_t>(capacity_mb, 0) << 20);
+  }();
+  return cache;
+}
+
+Status SharedReadCache::NewRandomAccessFile(
+    Env* env, const std::string& filename,
+    std::unique_ptr<RandomAccessFile>* result) {
+  FileStatistics stat;
+  TF_RETURN_IF_ERROR(env->Stat(filename, &stat));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  *result = std::make_unique<CachedFile>(this, filename, std::move(file),
+                                         stat.length, stat.mtime_nsec);
+  return OkStatus();
+}
+
+Status SharedReadCache::NewDecompressedFile(
+    Env* env, const std::string& filename,
+    const io::ZlibCompressionOptions& zlib_options,
+    std::unique_ptr<RandomAccessFile>* result) {
+  FileStatistics stat;
+  TF_RETURN_IF_ERROR(env->Stat(filename, &stat));
+  // The window bits tell zlib from gzip streams. Unlike the keys of the
+  // compressed blocks, the key prefix has a fourth, non-numeric field.
+  const std::string key_prefix =
+      absl::StrCat(filename, "\n", stat.length, "\n", stat.mtime_nsec, "\nz",
+                   zlib_options.window_bits, "\n");
+  std::shared_ptr<DecompressionStream> stream;
+  {
+    mutex_lock l(mu_);
+    auto it = decompression_streams_.find(key_prefix);
+    if (it != decompression_streams_.end()) {
+      stream = it->second.lock();
+    }
+  }
+  if (stream == nullptr) {
+    std::unique_ptr<RandomAccessFile> file;
+    TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+    auto new_stream =
+        std::make_shared<DecompressionStream>(std::move(file), zlib_options);
+    mutex_lock l(mu_);
+    // Drops the streams of the files which are no longer open.
+    for (auto it = decompression_streams_.begin();
+         it != decompression_streams_.end();) {
+      if (it->second.expired()) {
+        decompression_streams_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+    // Another reader may have opened the file in the meantime.
+    std::weak_ptr<DecompressionStream>& entry =
+        decompression_streams_[key_prefix];
+    stream = entry.lock();
+    if (stream == nullptr) {
+      stream = std::move(new_stream);
+      entry = stream;
+    }
+  }
+  *result = std::make_unique<DecompressedFile>(this, filename, key_prefix,
+                                               std::move(stream));
+  return OkStatus();
+}
+
+Status SharedReadCache::GetBlock(const std::string& key_prefix,
+                                 const RandomAccessFile& file,
+                                 uint64 file_size, uint64 index,
+                                 Block* block) {
+  const std::string key = absl::StrCat(key_prefix, index);
+  if ((*block = Lookup(key)) != nullptr) {
+    ++num_block_hits_;
+    return OkStatus();
+  }
+
+  std::shared_ptr<PendingRead> pending_read;
+  {
+    mutex_lock l(mu_);
+    // Looks the block up again, in case a concurrent read completed since.
+    if ((*block = Lookup(key)) != nullptr) {
+      ++num_block_hits_;
+      return OkStatus();
+    }
+    auto it = pending_reads_.find(key);
+    if (it != pending_reads_.end()) {
+      pending_read = it->second;
+      while (!pending_read->done) {
+        pending_read->cv.wait(l);
+      }
+      ++num_block_hits_;
+      *block = pending_read->block;
+      return pending_read->status;
+    }
+    pending_read = std::make_shared<PendingRead>();
+    pending_reads_.emplace(key, pending_read);
+  }
+
+  Status s = ReadBlock(file, file_size, index, block);
+  ++num_block_reads_;
+  if (s.ok()) {
+    cache_->Release(cache_->Insert(key, new Block(*block), (*block)->size(),
+                                   &DeleteBlock));
+  }
+  {
+    mutex_lock l(mu_);
+    pending_read->done = true;
+    pending_read->status = s;
+    pending_read->block = *block;
+    pending_reads_.erase(key);
+  }
+  pending_read->cv.notify_all();
+  return s;
+}
+
+Status SharedReadCache::GetDecompressedBlock(const std::string& key_prefix,
+                                             DecompressionStream* stream,
+                                             uint64 index, Block* block) {
+  if ((*block = Lookup(absl::StrCat(key_prefix, index))) != nullptr) {
+    ++num_block_hits_;
+    return OkStatus();
+  }
+
+  // Readers which miss wait for the stream, then find the blocks decompressed
+  // by the readers before them in the cache.
+  mutex_lock l(stream->mu);
+  if ((*block = Lookup(absl::StrCat(key_prefix, index))) != nullptr) {
+    ++num_block_hits_;
+    return OkStatus();
+  }
+  if (stream->next_index > index) {
+    // The block was evicted: decompresses the file again from the start.
+    TF_RETURN_IF_ERROR(stream->stream->Reset());
+    stream->next_index = 0;
+  }
+  // Caches the blocks on the way, for the readers behind this one.
+  while (stream->next_index <= index) {
+    tstring data;
+    Status s = stream->stream->ReadNBytes(block_size_, &data);
+    if (!s.ok() && !errors::IsOutOfRange(s)) {
+      // Leaves the stream at a block boundary for the next reader.
+      stream->stream->Reset().IgnoreError();
+      stream->next_index = 0;
+      return s;
+    }
+    if (data.empty()) {
+      break;
+    }
+    *block = std::make_shared<const std::string>(data.data(), data.size());
+    ++num_block_reads_;
+    cache_->Release(cache_->Insert(absl::StrCat(key_prefix, stream->next_index),
+                                   new Block(*block), (*block)->size(),
+                                   &DeleteBlock));
+    ++stream->next_index;
+    if (data.size() < block_size_) {
+      break;
+    }
+  }
+  if (stream->next_index <= index) {
+    // The block is past the end of the decompressed contents.
+    *block = std::make_shared<const std::string>();
+  }
+  return OkStatus();
+}
+
+Status SharedReadCache::ReadBlock(const RandomAccessFile& file,
+                                  uint64 file_size, uint64 index,
+                                  Block* block) const {
+  const uint64 offset = index * block_size_;
+  const size_t length =
+      offset < file_size ? std::min<uint64>(block_size_, file_size - offset)
+                         : 0;
+  auto data = std::make_shared<std::string>(length, '\0');
+  StringPiece result;
+  Status s = file.Read(offset, length, &result, data->data());
+  // A short read means that the file was truncated after it was opened.
+  if (!s.ok() && !errors::IsOutOfRange(s)) {
+    return s;
+  }
+  if (result.data() != data->data()) {
+    memmove(data->data(), result.data(), result.size());
+  }
+  data->resize(result.size());
+  *block = std::move(data);
+  return OkStatus();
+}
+
+SharedReadCache::Block SharedReadCache::Lookup(const std::string& key) const {
+  table::Cache::Handle* handle = cache_->Lookup(key);
+  if (handle == nullptr) {
+    return nullptr;
+  }
+  Block block = *static_cast<Block*>(cache_->Value(handle));
+  cache_->Release(handle);
+  return block;
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,143 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SHARED_READ_CACHE_H_
+#define TENSORFLOW_CORE_DATA_SHARED_READ_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/lib/io/cache.h"
+#include "tensorflow/core/lib/io/zlib_compression_options.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// A cache of file contents, shared by the readers of a process.
+//
+// Files opened through the cache are read in blocks of `block_size` bytes,
+// which are kept in an LRU cache of `capacity` bytes. Blocks are keyed by the
+// file name, size and modification time, so that a rewritten file is not read
+// from stale blocks. When several readers miss the same block at once, one of
+// them reads it and the others wait for its result. Input pipelines which read
+// the same files concurrently, e.g. the pipelines of several trainers in a
+// process, or a training and an evaluation pipeline, then read each block
+// once.
+//
+// Compressed files can also be opened as their decompressed contents, whose
+// blocks are cached instead of the compressed ones, so that the readers of a
+// file share its decompression as well as its reads.
+//
+// Cached blocks are reference counted: evicting a block does not invalidate
+// it for the readers which are copying from it.
+//
+// This class is thread-safe.
+class SharedReadCache {
+ public:
+  static constexpr size_t kDefaultBlockSize = 1 << 20;  // 1MB
+
+  SharedReadCache(size_t capacity, size_t block_size = kDefaultBlockSize);
+  ~SharedReadCache();
+
+  SharedReadCache(const SharedReadCache&) = delete;
+  SharedReadCache& operator=(const SharedReadCache&) = delete;
+
+  // Returns the cache shared by the process. Its capacity is 256MB, unless set
+  // in MB by the `TF_DATA_SHARED_READ_CACHE_SIZE_MB` environment variable.
+  static SharedReadCache* Global();
+
+  // Opens `filename` for reading through the cache. The returned file must
+  // not outlive the cache.
+  Status NewRandomAccessFile(Env* env, const std::string& filename,
+                             std::unique_ptr<RandomAccessFile>* result);
+
+  // Opens `filename`, compressed with `zlib_options`, as its decompressed
+  // contents, through the cache. The file is decompressed once for all of its
+  // readers, unless its blocks are evicted before they are read. Reads past
+  // the end of the decompressed contents return OutOfRange. The returned file
+  // must not outlive the cache.
+  Status NewDecompressedFile(Env* env, const std::string& filename,
+                             const io::ZlibCompressionOptions& zlib_options,
+                             std::unique_ptr<RandomAccessFile>* result)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of blocks read from files, or decompressed.
+  int64_t num_block_reads() const { return num_block_reads_; }
+
+  // Returns the number of blocks served from the cache, or from the read of
+  // another reader.
+  int64_t num_block_hits() const { return num_block_hits_; }
+
+ private:
+  class CachedFile;
+  class DecompressedFile;
+  struct DecompressionStream;
+  using Block = std::shared_ptr<const std::string>;
+
+  // A block read in progress, which other readers of the block wait for.
+  struct PendingRead {
+    condition_variable cv;
+    bool done = false;
+    Status status;
+    Block block;
+  };
+
+  // Returns in `block` the block `index` of `file`, whose blocks are keyed by
+  // `key_prefix`. Reads the block from `file` if it is not cached.
+  Status GetBlock(const std::string& key_prefix, const RandomAccessFile& file,
+                  uint64 file_size, uint64 index, Block* block)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns in `block` the block `index` of the decompressed contents of
+  // `stream`, whose blocks are keyed by `key_prefix`. Decompresses `stream`
+  // up to the block if it is not cached. The block is empty past the end of
+  // the contents.
+  Status GetDecompressedBlock(const std::string& key_prefix,
+                              DecompressionStream* stream, uint64 index,
+                              Block* block);
+
+  // Reads block `index` of `file` into `block`.
+  Status ReadBlock(const RandomAccessFile& file, uint64 file_size,
+                   uint64 index, Block* block) const;
+
+  // Returns the block cached for `key`, or nullptr if it is not cached.
+  Block Lookup(const std::string& key) const;
+
+  const size_t block_size_;
+  const std::unique_ptr<table::Cache> cache_;
+
+  mutex mu_;
+  absl::flat_hash_map<std::string, std::shared_ptr<PendingRead>> pending_reads_
+      TF_GUARDED_BY(mu_);
+  // The decompression streams of the files opened by `NewDecompressedFile`,
+  // by key prefix, while they are open.
+  absl::flat_hash_map<std::string, std::weak_ptr<DecompressionStream>>
+      decompression_streams_ TF_GUARDED_BY(mu_);
+
+  std::atomic<int64_t> num_block_reads_{0};
+  std::atomic<int64_t> num_block_hits_{0};
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SHARED_READ_CACHE_H_
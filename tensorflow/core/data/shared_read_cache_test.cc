@@ -0,0 +1,252 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/shared_read_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/zlib_compression_options.h"
+#include "tensorflow/core/lib/io/zlib_outputbuffer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::string WriteTestFile(const std::string& name,
+                          const std::string& contents) {
+  const std::string filename = io::JoinPath(testing::TmpDir(), name);
+  TF_CHECK_OK(WriteStringToFile(Env::Default(), filename, contents));
+  return filename;
+}
+
+std::string WriteGzipTestFile(const std::string& name,
+                              const std::string& contents) {
+  const std::string filename = io::JoinPath(testing::TmpDir(), name);
+  std::unique_ptr<WritableFile> file;
+  TF_CHECK_OK(Env::Default()->NewWritableFile(filename, &file));
+  io::ZlibOutputBuffer out(file.get(), /*input_buffer_bytes=*/256,
+                           /*output_buffer_bytes=*/256,
+                           io::ZlibCompressionOptions::GZIP());
+  TF_CHECK_OK(out.Init());
+  TF_CHECK_OK(out.Append(contents));
+  TF_CHECK_OK(out.Close());
+  return filename;
+}
+
+std::string Read(const RandomAccessFile& file, uint64 offset, size_t n,
+                 Status* status) {
+  std::string scratch(n, '\0');
+  StringPiece result;
+  *status = file.Read(offset, n, &result, scratch.data());
+  return std::string(result);
+}
+
+TEST(SharedReadCacheTest, Read) {
+  const std::string filename = WriteTestFile("read", "0123456789");
+  SharedReadCache cache(/*capacity=*/1 << 20, /*block_size=*/4);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(cache.NewRandomAccessFile(Env::Default(), filename, &file));
+
+  Status s;
+  EXPECT_EQ(Read(*file, 0, 10, &s), "0123456789");
+  TF_EXPECT_OK(s);
+  EXPECT_EQ(Read(*file, 3, 6, &s), "345678");
+  TF_EXPECT_OK(s);
+  EXPECT_EQ(Read(*file, 8, 5, &s), "89");
+  EXPECT_TRUE(errors::IsOutOfRange(s));
+  EXPECT_EQ(Read(*file, 12, 5, &s), "");
+  EXPECT_TRUE(errors::IsOutOfRange(s));
+  EXPECT_EQ(cache.num_block_reads(), 3);
+
+  StringPiece name;
+  TF_ASSERT_OK(file->Name(&name));
+  EXPECT_EQ(name, filename);
+}
+
+TEST(SharedReadCacheTest, ShareBlocksBetweenFiles) {
+  const std::string filename = WriteTestFile("share", std::string(100, 'a'));
+  SharedReadCache cache(/*capacity=*/1 << 20, /*block_size=*/10);
+  std::unique_ptr<RandomAccessFile> file1, file2;
+  TF_ASSERT_OK(cache.NewRandomAccessFile(Env::Default(), filename, &file1));
+  TF_ASSERT_OK(cache.NewRandomAccessFile(Env::Default(), filename, &file2));
+
+  Status s;
+  EXPECT_EQ(Read(*file1, 0, 100, &s), std::string(100, 'a'));
+  TF_EXPECT_OK(s);
+  EXPECT_EQ(Read(*file2, 0, 100, &s), std::string(100, 'a'));
+  TF_EXPECT_OK(s);
+  EXPECT_EQ(cache.num_block_reads(), 10);
+  EXPECT_EQ(cache.num_block_hits(), 10);
+}
+
+TEST(SharedReadCacheTest, NoCapacity) {
+  const std::string filename = WriteTestFile("uncached", "0123456789");
+  SharedReadCache cache(/*capacity=*/0, /*block_size=*/4);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(cache.NewRandomAccessFile(Env::Default(), filename, &file));
+
+  Status s;
+  EXPECT_EQ(Read(*file, 0, 10, &s), "0123456789");
+  TF_EXPECT_OK(s);
+  EXPECT_EQ(Read(*file, 0, 10, &s), "0123456789");
+  TF_EXPECT_OK(s);
+  EXPECT_EQ(cache.num_block_reads(), 6);
+  EXPECT_EQ(cache.num_block_hits(), 0);
+}
+
+TEST(SharedReadCacheTest, RewrittenFile) {
+  const std::string filename = WriteTestFile("rewrite", "0123456789");
+  SharedReadCache cache(/*capacity=*/1 << 20, /*block_size=*/4);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(cache.NewRandomAccessFile(Env::Default(), filename, &file));
+  Status s;
+  EXPECT_EQ(Read(*file, 0, 10, &s), "0123456789");
+
+  // The file size changes, in case its modification time does not.
+  WriteTestFile("rewrite", "abcdefghijkl");
+  TF_ASSERT_OK(cache.NewRandomAccessFile(Env::Default(), filename, &file));
+  EXPECT_EQ(Read(*file, 0, 12, &s), "abcdefghijkl");
+  TF_EXPECT_OK(s);
+}
+
+TEST(SharedReadCacheTest, ConcurrentReaders) {
+  const int kNumReaders = 8;
+  std::string contents;
+  for (int i = 0; i < 1000; ++i) {
+    contents += static_cast<char>('a' + i % 26);
+  }
+  const std::string filename = WriteTestFile("concurrent", contents);
+  SharedReadCache cache(/*capacity=*/1 << 20, /*block_size=*/64);
+  std::vector<std::string> results(kNumReaders);
+  {
+    thread::ThreadPool pool(Env::Default(), "readers", kNumReaders);
+    for (int i = 0; i < kNumReaders; ++i) {
+      pool.Schedule([&cache, &filename, &results, i]() {
+        std::unique_ptr<RandomAccessFile> file;
+        TF_CHECK_OK(
+            cache.NewRandomAccessFile(Env::Default(), filename, &file));
+        Status s;
+        for (uint64 offset = 0; offset < 1000; offset += 100) {
+          results[i] += Read(*file, offset, 100, &s);
+          TF_CHECK_OK(s);
+        }
+      });
+    }
+  }
+  for (const std::string& result : results) {
+    EXPECT_EQ(result, contents);
+  }
+  // Every block is read once, whether or not the readers miss it together.
+  EXPECT_EQ(cache.num_block_reads(), 16);
+}
+
+TEST(SharedReadCacheTest, DecompressedFile) {
+  const std::string filename = WriteGzipTestFile("gzip", "0123456789");
+  SharedReadCache cache(/*capacity=*/1 << 20, /*block_size=*/4);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(cache.NewDecompressedFile(Env::Default(), filename,
+                                         io::ZlibCompressionOptions::GZIP(),
+                                         &file));
+
+  Status s;
+  EXPECT_EQ(Read(*file, 0, 10, &s), "0123456789");
+  TF_EXPECT_OK(s);
+  EXPECT_EQ(Read(*file, 3, 6, &s), "345678");
+  TF_EXPECT_OK(s);
+  EXPECT_EQ(Read(*file, 8, 5, &s), "89");
+  EXPECT_TRUE(errors::IsOutOfRange(s));
+  EXPECT_EQ(Read(*file, 12, 5, &s), "");
+  EXPECT_TRUE(errors::IsOutOfRange(s));
+  EXPECT_EQ(cache.num_block_reads(), 3);
+}
+
+TEST(SharedReadCacheTest, ShareDecompressionBetweenFiles) {
+  const std::string contents(100, 'a');
+  const std::string filename = WriteGzipTestFile("gzip_share", contents);
+  SharedReadCache cache(/*capacity=*/1 << 20, /*block_size=*/10);
+  std::unique_ptr<RandomAccessFile> file1, file2;
+  TF_ASSERT_OK(cache.NewDecompressedFile(Env::Default(), filename,
+                                         io::ZlibCompressionOptions::GZIP(),
+                                         &file1));
+  TF_ASSERT_OK(cache.NewDecompressedFile(Env::Default(), filename,
+                                         io::ZlibCompressionOptions::GZIP(),
+                                         &file2));
+
+  Status s;
+  EXPECT_EQ(Read(*file1, 0, 100, &s), contents);
+  TF_EXPECT_OK(s);
+  EXPECT_EQ(Read(*file2, 0, 100, &s), contents);
+  TF_EXPECT_OK(s);
+  EXPECT_EQ(cache.num_block_reads(), 10);
+  EXPECT_EQ(cache.num_block_hits(), 10);
+}
+
+TEST(SharedReadCacheTest, DecompressEvictedBlocksAgain) {
+  const std::string filename = WriteGzipTestFile("gzip_evict", "0123456789");
+  SharedReadCache cache(/*capacity=*/0, /*block_size=*/4);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(cache.NewDecompressedFile(Env::Default(), filename,
+                                         io::ZlibCompressionOptions::GZIP(),
+                                         &file));
+
+  Status s;
+  EXPECT_EQ(Read(*file, 4, 6, &s), "456789");
+  TF_EXPECT_OK(s);
+  EXPECT_EQ(Read(*file, 0, 6, &s), "012345");
+  TF_EXPECT_OK(s);
+}
+
+TEST(SharedReadCacheTest, ConcurrentDecompressedReaders) {
+  const int kNumReaders = 8;
+  std::string contents;
+  for (int i = 0; i < 1000; ++i) {
+    contents += static_cast<char>('a' + i % 26);
+  }
+  const std::string filename = WriteGzipTestFile("gzip_concurrent", contents);
+  SharedReadCache cache(/*capacity=*/1 << 20, /*block_size=*/64);
+  std::vector<std::string> results(kNumReaders);
+  {
+    thread::ThreadPool pool(Env::Default(), "readers", kNumReaders);
+    for (int i = 0; i < kNumReaders; ++i) {
+      pool.Schedule([&cache, &filename, &results, i]() {
+        std::unique_ptr<RandomAccessFile> file;
+        TF_CHECK_OK(cache.NewDecompressedFile(
+            Env::Default(), filename, io::ZlibCompressionOptions::GZIP(),
+            &file));
+        Status s;
+        for (uint64 offset = 0; offset < 1000; offset += 100) {
+          results[i] += Read(*file, offset, 100, &s);
+          TF_CHECK_OK(s);
+        }
+      });
+    }
+  }
+  for (const std::string& result : results) {
+    EXPECT_EQ(result, contents);
+  }
+  // The file is decompressed once for all the readers.
+  EXPECT_EQ(cache.num_block_reads(), 16);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
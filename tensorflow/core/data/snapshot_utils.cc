@@ -28,8 +28,10 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
@@ -143,13 +145,28 @@ TFRecordWriter::TFRecordWriter(const std::string& filename,
 Status TFRecordWriter::Initialize(tensorflow::Env* env) {
   TF_RETURN_IF_ERROR(env->NewAppendableFile(filename_, &dest_));
 
+  // Zstd compresses the tensors rather than the record stream.
+  const std::string record_compression_type =
+      compression_type_ == kZstdCompression ? io::compression::kNone
+                                            : compression_type_;
   record_writer_ = std::make_unique<io::RecordWriter>(
       dest_.get(), io::RecordWriterOptions::CreateRecordWriterOptions(
-                       /*compression_type=*/compression_type_));
+                       /*compression_type=*/record_compression_type));
   return OkStatus();
 }
 
 Status TFRecordWriter::WriteTensors(const std::vector<Tensor>& tensors) {
+  if (compression_type_ == kZstdCompression) {
+    CompressElementOptions options;
+    options.codec = CompressedElement::ZSTD;
+    for (const auto& tensor : tensors) {
+      CompressedElement compressed;
+      TF_RETURN_IF_ERROR(CompressElement({tensor}, options, &compressed));
+      TF_RETURN_IF_ERROR(
+          record_writer_->WriteRecord(compressed.SerializeAsString()));
+    }
+    return OkStatus();
+  }
   for (const auto& tensor : tensors) {
     TensorProto proto;
     tensor.AsProtoTensorContent(&proto);
@@ -748,8 +765,10 @@ TFRecordReaderImpl::TFRecordReaderImpl(
 
 Status TFRecordReaderImpl::Initialize(Env* env) {
   TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename_, &file_));
+  const std::string record_compression_type =
+      compression_ == kZstdCompression ? io::compression::kNone : compression_;
   auto options = io::RecordReaderOptions::CreateRecordReaderOptions(
-      /*compression_type=*/compression_);
+      /*compression_type=*/record_compression_type);
 #if !defined(IS_SLIM_BUILD)
   if (output_buffer_size_.has_value()) {
     options.snappy_options.output_buffer_size = *output_buffer_size_;
@@ -782,6 +801,22 @@ StatusOr<std::vector<Tensor>> TFRecordReaderImpl::GetTensors() {
 }
 
 StatusOr<Tensor> TFRecordReaderImpl::Parse(const tstring& record) {
+  if (compression_ == kZstdCompression) {
+    CompressedElement compressed;
+    if (!compressed.ParseFromArray(record.data(), record.size())) {
+      return errors::DataLoss(
+          "Unable to parse compressed tensor from stored proto in file: ",
+          filename_, ", record ", offset_);
+    }
+    std::vector<Tensor> tensors;
+    TF_RETURN_IF_ERROR(UncompressElement(compressed, &tensors));
+    if (tensors.size() != 1) {
+      return errors::DataLoss("Expected a single tensor in file: ", filename_,
+                              ", record ", offset_, ", but got ",
+                              tensors.size());
+    }
+    return std::move(tensors[0]);
+  }
   TensorProto proto;
   if (!proto.ParseFromArray(record.data(), record.size())) {
     return errors::DataLoss(
@@ -62,6 +62,11 @@ constexpr char kModeRead[] = "read";
 constexpr char kModePassthrough[] = "passthrough";
 constexpr char kShardDirectorySuffix[] = ".shard";
 
+// Compression type of `TFRecordWriter` and `TFRecordReaderImpl` that
+// compresses each tensor with zstd, as a `CompressedElement`, instead of
+// compressing the record stream.
+constexpr char kZstdCompression[] = "ZSTD";
+
 enum Mode { READER = 0, WRITER = 1, PASSTHROUGH = 2 };
 
 // Returns the name of the "hash" directory for the given base path and hash ID.
@@ -251,7 +256,7 @@ class TFRecordReaderImpl {
   // Constructs a `TFRecordReaderImpl`.
   // `filename` is the file to read from.
   // `compression_type` is the compression method, as defined in
-  // tensorflow/tsl/lib/io/compression.h.
+  // tensorflow/tsl/lib/io/compression.h, or `kZstdCompression`.
   // `output_buffer_size` specifies the buffer size required by Snappy/Zlib
   // compression algorithms. Ignored if compression is not enabled.
   TFRecordReaderImpl(const std::string& filename, const string& compression,
@@ -97,6 +97,7 @@ TEST(SnapshotUtilTest, CombinationRoundTripTest) {
   SnapshotRoundTrip(io::compression::kNone, 2);
   SnapshotRoundTrip(io::compression::kGzip, 2);
   SnapshotRoundTrip(io::compression::kSnappy, 2);
+  SnapshotRoundTrip(kZstdCompression, 2);
 }
 
 TEST(SnapshotUtilTest, MetadataFileRoundTrip) {
@@ -170,11 +171,16 @@ void SnapshotTFRecordReaderGzipBenchmark(::testing::benchmark::State& state) {
   SnapshotReaderBenchmarkLoop(state, io::compression::kGzip, 2);
 }
 
+void SnapshotTFRecordReaderZstdBenchmark(::testing::benchmark::State& state) {
+  SnapshotReaderBenchmarkLoop(state, kZstdCompression, 2);
+}
+
 BENCHMARK(SnapshotCustomReaderNoneBenchmark);
 BENCHMARK(SnapshotCustomReaderGzipBenchmark);
 BENCHMARK(SnapshotCustomReaderSnappyBenchmark);
 BENCHMARK(SnapshotTFRecordReaderNoneBenchmark);
 BENCHMARK(SnapshotTFRecordReaderGzipBenchmark);
+BENCHMARK(SnapshotTFRecordReaderZstdBenchmark);
 
 void SnapshotWriterBenchmarkLoop(::testing::benchmark::State& state,
                                  std::string compression_type, int version) {
@@ -221,12 +227,17 @@ void SnapshotTFRecordWriterSnappyBenchmark(::testing::benchmark::State& state) {
   SnapshotWriterBenchmarkLoop(state, io::compression::kSnappy, 2);
 }
 
+void SnapshotTFRecordWriterZstdBenchmark(::testing::benchmark::State& state) {
+  SnapshotWriterBenchmarkLoop(state, kZstdCompression, 2);
+}
+
 BENCHMARK(SnapshotCustomWriterNoneBenchmark);
 BENCHMARK(SnapshotCustomWriterGzipBenchmark);
 BENCHMARK(SnapshotCustomWriterSnappyBenchmark);
 BENCHMARK(SnapshotTFRecordWriterNoneBenchmark);
 BENCHMARK(SnapshotTFRecordWriterGzipBenchmark);
 BENCHMARK(SnapshotTFRecordWriterSnappyBenchmark);
+BENCHMARK(SnapshotTFRecordWriterZstdBenchmark);
 
 }  // namespace
 }  // namespace snapshot_util
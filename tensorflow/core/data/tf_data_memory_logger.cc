@@ -76,6 +76,17 @@ void LogDatasetMemoryUsage() {
       VLOG(4) << "Dataset " << i << " (no name set): " << usage_string;
     }
   }
+  for (const auto& cache_collector :
+       TfDatazMetricsRegistry::GetCacheMetricCollectors()) {
+    VLOG(4) << "Cache " << cache_collector->name() << ": "
+            << strings::HumanReadableNumBytes(
+                   cache_collector->GetMemoryBytes())
+            << " in memory, "
+            << strings::HumanReadableNumBytes(
+                   cache_collector->GetSpilledBytes())
+            << " spilled, " << cache_collector->GetHits() << " hits, "
+            << cache_collector->GetMisses() << " misses";
+  }
 }
 
 void MemoryLoggerThread() {
@@ -143,6 +143,13 @@ TfDatazMetricsCollectors& tfdataz_metric_collectors() {
   static auto& collectors = *new TfDatazMetricsCollectors();
   return collectors;
 }
+
+using TfDatazCacheMetricsCollectors =
+    absl::flat_hash_set<std::shared_ptr<TfDatazCacheMetricsCollector>>;
+TfDatazCacheMetricsCollectors& tfdataz_cache_metric_collectors() {
+  static auto& collectors = *new TfDatazCacheMetricsCollectors();
+  return collectors;
+}
 }  // namespace
 
 void TfDatazMetricsRegistry::Register(
@@ -163,5 +170,23 @@ TfDatazMetricsRegistry::GetIteratorMetricCollectors() {
   return tfdataz_metric_collectors();
 }
 
+void TfDatazMetricsRegistry::RegisterCache(
+    std::shared_ptr<TfDatazCacheMetricsCollector> collector) {
+  mutex_lock l(*get_tfdataz_metrics_registry_lock());
+  tfdataz_cache_metric_collectors().insert(collector);
+}
+
+void TfDatazMetricsRegistry::DeregisterCache(
+    std::shared_ptr<TfDatazCacheMetricsCollector> collector) {
+  mutex_lock l(*get_tfdataz_metrics_registry_lock());
+  tfdataz_cache_metric_collectors().erase(collector);
+}
+
+absl::flat_hash_set<std::shared_ptr<TfDatazCacheMetricsCollector>>
+TfDatazMetricsRegistry::GetCacheMetricCollectors() {
+  mutex_lock l(*get_tfdataz_metrics_registry_lock());
+  return tfdataz_cache_metric_collectors();
+}
+
 }  // namespace data
 }  // namespace tensorflow
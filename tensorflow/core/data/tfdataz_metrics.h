@@ -15,10 +15,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_TFDATAZ_METRICS_H_
 #define TENSORFLOW_CORE_DATA_TFDATAZ_METRICS_H_
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
@@ -121,6 +123,47 @@ class TfDatazMetricsCollector {
   ApproximateLatencyEstimator latency_estimator_;
 };
 
+// Collects and exports the metrics of a memory-bounded tf.data cache to
+// /tfdataz. All methods are thread-safe.
+class TfDatazCacheMetricsCollector {
+ public:
+  explicit TfDatazCacheMetricsCollector(std::string name)
+      : name_(std::move(name)) {}
+
+  // Records that an element was served from the in-memory tier.
+  void RecordHit() { hits_.fetch_add(1, std::memory_order_relaxed); }
+
+  // Records that an element was served from the spill file.
+  void RecordMiss() { misses_.fetch_add(1, std::memory_order_relaxed); }
+
+  // Adjusts the number of (compressed) bytes held in memory.
+  void RecordMemoryBytes(int64_t delta) {
+    memory_bytes_.fetch_add(delta, std::memory_order_relaxed);
+  }
+
+  // Adjusts the number of (compressed) bytes held in the spill file.
+  void RecordSpilledBytes(int64_t delta) {
+    spilled_bytes_.fetch_add(delta, std::memory_order_relaxed);
+  }
+
+  const std::string& name() const { return name_; }
+  int64_t GetHits() const { return hits_.load(std::memory_order_relaxed); }
+  int64_t GetMisses() const { return misses_.load(std::memory_order_relaxed); }
+  int64_t GetMemoryBytes() const {
+    return memory_bytes_.load(std::memory_order_relaxed);
+  }
+  int64_t GetSpilledBytes() const {
+    return spilled_bytes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  const std::string name_;
+  std::atomic<int64_t> hits_ = 0;
+  std::atomic<int64_t> misses_ = 0;
+  std::atomic<int64_t> memory_bytes_ = 0;
+  std::atomic<int64_t> spilled_bytes_ = 0;
+};
+
 // Thread-safe global registry for the /tfdataz metrics. All callers to
 // `TfDatazMetricsRegistry` use the same instance to register and deregister
 // iterator's `TfDatazMetricsCollector`.
@@ -137,6 +180,20 @@ class TfDatazMetricsRegistry {
   // Returns all the registered `TfDatazMetricsCollector`s.
   static absl::flat_hash_set<std::shared_ptr<TfDatazMetricsCollector>>
   GetIteratorMetricCollectors();
+
+  // Registers a cache specific `TfDatazCacheMetricsCollector` in the global
+  // TfDatazMetricsRegistry.
+  static void RegisterCache(
+      std::shared_ptr<TfDatazCacheMetricsCollector> collector);
+
+  // Deregisters a cache specific `TfDatazCacheMetricsCollector` from the
+  // global TfDatazMetricsRegistry.
+  static void DeregisterCache(
+      std::shared_ptr<TfDatazCacheMetricsCollector> collector);
+
+  // Returns all the registered `TfDatazCacheMetricsCollector`s.
+  static absl::flat_hash_set<std::shared_ptr<TfDatazCacheMetricsCollector>>
+  GetCacheMetricCollectors();
 };
 
 }  // namespace data
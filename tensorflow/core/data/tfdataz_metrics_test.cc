@@ -231,6 +231,36 @@ TEST(TfDatazMetricsRegistryTest, Deregister) {
   EXPECT_EQ(TfDatazMetricsRegistry::GetIteratorMetricCollectors().size(), 0);
 }
 
+TEST(TfDatazCacheMetricsCollectorTest, RecordMetrics) {
+  TfDatazCacheMetricsCollector collector("cache");
+  collector.RecordHit();
+  collector.RecordHit();
+  collector.RecordMiss();
+  collector.RecordMemoryBytes(100);
+  collector.RecordMemoryBytes(-40);
+  collector.RecordSpilledBytes(30);
+  EXPECT_EQ(collector.name(), "cache");
+  EXPECT_EQ(collector.GetHits(), 2);
+  EXPECT_EQ(collector.GetMisses(), 1);
+  EXPECT_EQ(collector.GetMemoryBytes(), 60);
+  EXPECT_EQ(collector.GetSpilledBytes(), 30);
+}
+
+TEST(TfDatazMetricsRegistryTest, RegisterAndDeregisterCache) {
+  auto collector_one = std::make_shared<TfDatazCacheMetricsCollector>("one");
+  auto collector_two = std::make_shared<TfDatazCacheMetricsCollector>("two");
+  TfDatazMetricsRegistry::RegisterCache(collector_one);
+  TfDatazMetricsRegistry::RegisterCache(collector_two);
+  EXPECT_EQ(TfDatazMetricsRegistry::GetCacheMetricCollectors().size(), 2);
+  // Cache collectors are tracked separately from iterator collectors.
+  EXPECT_EQ(TfDatazMetricsRegistry::GetIteratorMetricCollectors().size(), 0);
+
+  TfDatazMetricsRegistry::DeregisterCache(collector_one);
+  EXPECT_EQ(TfDatazMetricsRegistry::GetCacheMetricCollectors().size(), 1);
+  TfDatazMetricsRegistry::DeregisterCache(collector_two);
+  EXPECT_EQ(TfDatazMetricsRegistry::GetCacheMetricCollectors().size(), 0);
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -0,0 +1,175 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/work_stealing_scheduler.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// The worker thread the current thread runs, if any.
+struct CurrentWorker {
+  const WorkStealingScheduler* scheduler = nullptr;
+  int index = -1;
+};
+
+thread_local CurrentWorker current_worker;
+
+}  // namespace
+
+WorkStealingScheduler::WorkStealingScheduler(Env* env, const std::string& name,
+                                             int num_threads) {
+  DCHECK_GT(num_threads, 0);
+  workers_.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  for (int i = 0; i < num_threads; ++i) {
+    workers_[i]->thread.reset(
+        env->StartThread({}, name, [this, i]() { WorkerLoop(i); }));
+  }
+}
+
+WorkStealingScheduler::~WorkStealingScheduler() {
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker->thread.reset();
+  }
+}
+
+WorkStealingScheduler* WorkStealingScheduler::Global() {
+  static WorkStealingScheduler* scheduler = new WorkStealingScheduler(
+      Env::Default(), "tf_data_work_stealing_scheduler",
+      port::MaxParallelism());
+  return scheduler;
+}
+
+void WorkStealingScheduler::Schedule(std::function<void()> fn,
+                                     std::shared_ptr<model::Node> node) {
+  int index = current_worker.index;
+  if (current_worker.scheduler != this) {
+    index = next_worker_.fetch_add(1) % workers_.size();
+  }
+  {
+    Worker& worker = *workers_[index];
+    mutex_lock l(worker.mu);
+    worker.tasks.push_back({std::move(fn), std::move(node)});
+  }
+  num_pending_tasks_.fetch_add(1);
+  if (num_sleeping_workers_.load() > 0) {
+    mutex_lock l(mu_);
+    cv_.notify_one();
+  }
+}
+
+double WorkStealingScheduler::Priority(const model::Node* node) {
+  if (node == nullptr) {
+    return 0.0;
+  }
+  int64_t depth = 0;
+  for (const model::Node* output = node->output(); output != nullptr;
+       output = output->output()) {
+    ++depth;
+  }
+  double capacity = 0.0;
+  StatusOr<double> buffer_size = node->ParameterValue(model::kBufferSize);
+  if (buffer_size.ok()) {
+    capacity = *buffer_size;
+  } else {
+    StatusOr<double> parallelism = node->ParameterValue(model::kParallelism);
+    if (parallelism.ok()) {
+      capacity = *parallelism;
+    }
+  }
+  double fill = 0.0;
+  if (capacity > 0.0) {
+    fill = std::min(1.0, node->buffered_elements() / capacity);
+  }
+  return depth + kBufferFillWeight * fill;
+}
+
+void WorkStealingScheduler::WorkerLoop(int index) {
+  current_worker = {this, index};
+  while (true) {
+    Task task;
+    if (PopTask(index, &task) || StealTask(index, &task)) {
+      num_pending_tasks_.fetch_sub(1);
+      task.fn();
+      continue;
+    }
+    mutex_lock l(mu_);
+    num_sleeping_workers_.fetch_add(1);
+    while (num_pending_tasks_.load() == 0 && !cancelled_) {
+      cv_.wait(l);
+    }
+    num_sleeping_workers_.fetch_sub(1);
+    if (num_pending_tasks_.load() == 0 && cancelled_) {
+      return;
+    }
+  }
+}
+
+bool WorkStealingScheduler::PopTask(int index, Task* task) {
+  Worker& worker = *workers_[index];
+  mutex_lock l(worker.mu);
+  if (worker.tasks.empty()) {
+    return false;
+  }
+  // Prefers the most recent tasks, whose inputs are the most likely to still
+  // be in the cache of the core.
+  auto best = worker.tasks.end() - 1;
+  double best_priority = Priority(best->node.get());
+  const int num_candidates =
+      std::min<int>(kMaxCandidates, worker.tasks.size());
+  for (int i = 1; i < num_candidates && best_priority > 0.0; ++i) {
+    auto it = worker.tasks.end() - 1 - i;
+    const double priority = Priority(it->node.get());
+    if (priority < best_priority) {
+      best = it;
+      best_priority = priority;
+    }
+  }
+  *task = std::move(*best);
+  worker.tasks.erase(best);
+  return true;
+}
+
+bool WorkStealingScheduler::StealTask(int index, Task* task) {
+  const int num_workers = workers_.size();
+  for (int i = 1; i < num_workers; ++i) {
+    Worker& victim = *workers_[(index + i) % num_workers];
+    mutex_lock l(victim.mu);
+    if (!victim.tasks.empty()) {
+      *task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace data
+}  // namespace tensorflow
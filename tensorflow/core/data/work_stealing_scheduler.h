@@ -0,0 +1,121 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_WORK_STEALING_SCHEDULER_H_
+#define TENSORFLOW_CORE_DATA_WORK_STEALING_SCHEDULER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// A scheduler for the work of the parallel iterators of input pipelines, meant
+// to be shared by all the pipelines of a process so that they do not
+// oversubscribe the cores of the host.
+//
+// Each worker thread owns a deque of tasks. Tasks scheduled from a worker are
+// pushed to the deque of that worker, other tasks are spread across workers.
+// A worker runs tasks from its own deque, and steals the oldest task of
+// another worker when its deque is empty.
+//
+// A task may be scheduled on behalf of a node of the model of its pipeline.
+// Among the most recent tasks of its deque, a worker runs the one whose node
+// is the closest to the consumer of the pipeline and has the emptiest buffer
+// (see `Priority`). Priorities are computed when tasks are picked, so that
+// they follow the buffers of the pipeline as they fill and drain.
+//
+// This class is thread-safe.
+class WorkStealingScheduler {
+ public:
+  // Creates a scheduler running `num_threads` worker threads.
+  WorkStealingScheduler(Env* env, const std::string& name, int num_threads);
+
+  // Runs the pending tasks and stops the worker threads.
+  ~WorkStealingScheduler();
+
+  WorkStealingScheduler(const WorkStealingScheduler&) = delete;
+  WorkStealingScheduler& operator=(const WorkStealingScheduler&) = delete;
+
+  // Returns the scheduler shared by the process, with one worker thread per
+  // schedulable core.
+  static WorkStealingScheduler* Global();
+
+  // Schedules `fn` on behalf of `node`, which may be null for work which is
+  // not attributed to a node.
+  void Schedule(std::function<void()> fn,
+                std::shared_ptr<model::Node> node = nullptr);
+
+  int NumThreads() const { return workers_.size(); }
+
+  // Returns the priority of work done on behalf of `node`; lower values run
+  // first. It is the number of nodes between `node` and the consumer, plus
+  // the fill ratio of the buffer of `node` weighted by
+  // `kBufferFillWeight`. A node with a full buffer thereby yields to the node
+  // feeding it if the buffer of the latter is empty. Unattributed work has
+  // priority 0.
+  static double Priority(const model::Node* node);
+
+ private:
+  static constexpr double kBufferFillWeight = 1.5;
+  // The number of most recent tasks of its deque a worker picks from.
+  static constexpr int kMaxCandidates = 16;
+
+  struct Task {
+    std::function<void()> fn;
+    std::shared_ptr<model::Node> node;
+  };
+
+  struct Worker {
+    mutex mu;
+    std::deque<Task> tasks TF_GUARDED_BY(mu);
+    std::unique_ptr<Thread> thread;
+  };
+
+  void WorkerLoop(int index);
+
+  // Removes the task of highest priority among the most recent tasks of
+  // worker `index`, returning false if it has none.
+  bool PopTask(int index, Task* task);
+
+  // Removes the oldest task of another worker than `index`, returning false
+  // if they have none.
+  bool StealTask(int index, Task* task);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  // The number of tasks in the deques of the workers.
+  std::atomic<int64_t> num_pending_tasks_{0};
+  std::atomic<int64_t> num_sleeping_workers_{0};
+  // Spreads the tasks scheduled outside of the workers.
+  std::atomic<uint64_t> next_worker_{0};
+
+  mutex mu_;
+  condition_variable cv_;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_WORK_STEALING_SCHEDULER_H_
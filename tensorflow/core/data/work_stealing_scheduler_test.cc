@@ -0,0 +1,254 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/work_stealing_scheduler.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Returns a node with a tunable `buffer_size` parameter of `buffer_size`,
+// whose output is `output`.
+std::shared_ptr<model::Node> MakeNode(int64_t id, int64_t buffer_size,
+                                      std::shared_ptr<model::Node> output) {
+  return model::MakeAsyncKnownRatioNode(
+      {id, "Prefetch", output},
+      /*ratio=*/1,
+      {model::MakeParameter(
+          model::kBufferSize,
+          std::make_shared<model::SharedState>(buffer_size, nullptr, nullptr),
+          /*min=*/1, /*max=*/buffer_size)});
+}
+
+TEST(WorkStealingSchedulerTest, RunsAllTasks) {
+  const int kNumTasks = 1000;
+  std::atomic<int> count(0);
+  {
+    WorkStealingScheduler scheduler(Env::Default(), "test", /*num_threads=*/4);
+    EXPECT_EQ(scheduler.NumThreads(), 4);
+    for (int i = 0; i < kNumTasks; ++i) {
+      scheduler.Schedule([&count]() { ++count; });
+    }
+  }
+  EXPECT_EQ(count, kNumTasks);
+}
+
+TEST(WorkStealingSchedulerTest, RunsNestedTasks) {
+  const int kNumTasks = 100;
+  std::atomic<int> count(0);
+  {
+    WorkStealingScheduler scheduler(Env::Default(), "test", /*num_threads=*/4);
+    for (int i = 0; i < kNumTasks; ++i) {
+      scheduler.Schedule([&scheduler, &count]() {
+        for (int j = 0; j < 10; ++j) {
+          scheduler.Schedule([&count]() { ++count; });
+        }
+      });
+    }
+  }
+  EXPECT_EQ(count, kNumTasks * 10);
+}
+
+TEST(WorkStealingSchedulerTest, StealsFromBusyWorkers) {
+  WorkStealingScheduler scheduler(Env::Default(), "test", /*num_threads=*/2);
+  Notification blocked, unblock, done;
+  // The nested task is pushed to the deque of the blocked worker, and is run
+  // by the other worker.
+  scheduler.Schedule([&]() {
+    scheduler.Schedule([&done]() { done.Notify(); });
+    blocked.Notify();
+    unblock.WaitForNotification();
+  });
+  blocked.WaitForNotification();
+  done.WaitForNotification();
+  unblock.Notify();
+}
+
+TEST(WorkStealingSchedulerTest, Priority) {
+  std::shared_ptr<model::Node> root = MakeNode(1, 4, nullptr);
+  std::shared_ptr<model::Node> middle = MakeNode(2, 4, root);
+  std::shared_ptr<model::Node> leaf = MakeNode(3, 4, middle);
+  EXPECT_EQ(WorkStealingScheduler::Priority(nullptr), 0.0);
+  EXPECT_EQ(WorkStealingScheduler::Priority(root.get()), 0.0);
+  EXPECT_EQ(WorkStealingScheduler::Priority(middle.get()), 1.0);
+  EXPECT_EQ(WorkStealingScheduler::Priority(leaf.get()), 2.0);
+
+  middle->record_buffer_event(/*bytes_delta=*/0, /*elements_delta=*/2);
+  EXPECT_EQ(WorkStealingScheduler::Priority(middle.get()), 1.75);
+  // A full buffer yields to the empty buffer upstream.
+  middle->record_buffer_event(/*bytes_delta=*/0, /*elements_delta=*/2);
+  EXPECT_EQ(WorkStealingScheduler::Priority(middle.get()), 2.5);
+  EXPECT_LT(WorkStealingScheduler::Priority(leaf.get()),
+            WorkStealingScheduler::Priority(middle.get()));
+}
+
+TEST(WorkStealingSchedulerTest, RunsHighestPriorityTaskFirst) {
+  std::shared_ptr<model::Node> root = MakeNode(1, 4, nullptr);
+  std::shared_ptr<model::Node> leaf = MakeNode(2, 4, root);
+  std::vector<int64_t> order;
+  mutex mu;
+  {
+    WorkStealingScheduler scheduler(Env::Default(), "test", /*num_threads=*/1);
+    Notification unblock;
+    scheduler.Schedule([&unblock]() { unblock.WaitForNotification(); });
+    for (const auto& node : {leaf, root, leaf}) {
+      scheduler.Schedule(
+          [&order, &mu, id = node->id()]() {
+            mutex_lock l(mu);
+            order.push_back(id);
+          },
+          node);
+    }
+    unblock.Notify();
+  }
+  EXPECT_EQ(order, std::vector<int64_t>({1, 2, 2}));
+}
+
+// A synthetic pipeline of `kNumStages` stages with bounded buffers. Each task
+// of a stage takes an element from the buffer of the stage upstream, burns
+// CPU, and puts an element into the buffer of its stage. The consumer takes
+// elements from the buffer of the last stage.
+class SyntheticPipeline {
+ public:
+  static constexpr int kNumStages = 6;
+  static constexpr int kBufferSize = 8;
+
+  // Creates a pipeline whose tasks run with `runner`, which is given the
+  // model node of the stage of each task.
+  explicit SyntheticPipeline(
+      std::function<void(std::function<void()>, std::shared_ptr<model::Node>)>
+          runner)
+      : runner_(std::move(runner)), buffered_(kNumStages, 0),
+        in_flight_(kNumStages, 0) {
+    std::shared_ptr<model::Node> output;
+    for (int i = kNumStages - 1; i >= 0; --i) {
+      nodes_.insert(nodes_.begin(), MakeNode(i, kBufferSize, output));
+      output = nodes_.front();
+    }
+  }
+
+  // Waits for all the tasks to complete.
+  ~SyntheticPipeline() {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    while (num_in_flight_ > 0) {
+      cv_.wait(l);
+    }
+  }
+
+  // Consumes one element from the last stage.
+  void GetNext() {
+    mutex_lock l(mu_);
+    ScheduleTasksLocked();
+    while (buffered_[kNumStages - 1] == 0) {
+      cv_.wait(l);
+    }
+    TakeLocked(kNumStages - 1);
+    ScheduleTasksLocked();
+  }
+
+ private:
+  // Schedules the tasks of the stages whose buffer, including elements in
+  // flight, is not full, and whose input is available.
+  void ScheduleTasksLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    for (int stage = 0; stage < kNumStages && !cancelled_; ++stage) {
+      while (buffered_[stage] + in_flight_[stage] < kBufferSize &&
+             (stage == 0 || buffered_[stage - 1] > 0)) {
+        if (stage > 0) {
+          TakeLocked(stage - 1);
+        }
+        ++in_flight_[stage];
+        ++num_in_flight_;
+        runner_([this, stage]() { RunTask(stage); }, nodes_[stage]);
+      }
+    }
+  }
+
+  void TakeLocked(int stage) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    --buffered_[stage];
+    nodes_[stage]->record_buffer_event(0, -1);
+  }
+
+  void RunTask(int stage) {
+    // Upstream stages are cheaper, so that they would run ahead of the
+    // consumer if they were not bounded by their buffers.
+    volatile double x = 1.0;
+    for (int i = 0; i < 2000 * (stage + 1); ++i) {
+      x = x * 1.0000001 + 1e-9;
+    }
+    mutex_lock l(mu_);
+    --in_flight_[stage];
+    ++buffered_[stage];
+    nodes_[stage]->record_buffer_event(0, 1);
+    --num_in_flight_;
+    ScheduleTasksLocked();
+    cv_.notify_all();
+  }
+
+  const std::function<void(std::function<void()>,
+                           std::shared_ptr<model::Node>)>
+      runner_;
+  std::vector<std::shared_ptr<model::Node>> nodes_;
+  mutex mu_;
+  condition_variable cv_;
+  std::vector<int> buffered_ TF_GUARDED_BY(mu_);
+  std::vector<int> in_flight_ TF_GUARDED_BY(mu_);
+  int num_in_flight_ TF_GUARDED_BY(mu_) = 0;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+};
+
+// Consumes a 6-stage synthetic pipeline, whose tasks run either on a plain
+// thread pool (`state.range(0) == 0`) or on the work-stealing scheduler.
+void BM_SyntheticPipeline(::testing::benchmark::State& state) {
+  const bool work_stealing = state.range(0);
+  const int num_threads = state.range(1);
+  WorkStealingScheduler scheduler(Env::Default(), "bm", num_threads);
+  thread::ThreadPool pool(Env::Default(), "bm", num_threads);
+  SyntheticPipeline pipeline(
+      [&](std::function<void()> fn, std::shared_ptr<model::Node> node) {
+        if (work_stealing) {
+          scheduler.Schedule(std::move(fn), std::move(node));
+        } else {
+          pool.Schedule(std::move(fn));
+        }
+      });
+  for (auto s : state) {
+    pipeline.GetNext();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_SyntheticPipeline)
+    ->ArgPair(0, 4)
+    ->ArgPair(1, 4)
+    ->ArgPair(0, 16)
+    ->ArgPair(1, 16);
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
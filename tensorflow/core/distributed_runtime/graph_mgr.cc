@@ -180,6 +180,7 @@ Status GraphMgr::InitItem(const string& handle, const GraphDef& gdef,
   };
   popts.flib_def = item->lib_def.get();
   popts.control_flow_added = true;
+  popts.assign_rendezvous_slots = true;
   popts.scheduling_for_recvs = graph_options.enable_recv_scheduling();
   TF_RETURN_IF_ERROR(Partition(popts, &graph, &partitions));
   if (popts.scheduling_for_recvs) {
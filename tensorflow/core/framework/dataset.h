@@ -666,6 +666,7 @@ class IteratorContext {
           interleave_depth(ctx->interleave_depth()),
           is_restoring(ctx->is_restoring()),
           model(ctx->model()),
+          node_runner_factory(ctx->node_runner_factory()),
           ram_budget_manager(ctx->ram_budget_manager()),
           resource_mgr(ctx->resource_mgr()),
           runner(*(ctx->runner())),
@@ -736,6 +737,13 @@ class IteratorContext {
     // If non-null, identifies the object used for performance modeling.
     std::shared_ptr<model::Model> model = nullptr;
 
+    // If set, returns the runner to use in place of `runner` for the work of
+    // the iterator modeled by the given node, so that a scheduler shared by
+    // the iterators of a pipeline can prioritize their work.
+    std::function<std::function<void(std::function<void()>)>(
+        std::shared_ptr<model::Node>)>
+        node_runner_factory = nullptr;
+
     // Manager for the ram budget when using autotune.
     std::shared_ptr<model::RamBudgetManager> ram_budget_manager = nullptr;
 
@@ -835,6 +843,20 @@ class IteratorContext {
 
   const std::shared_ptr<model::Model>& model() const { return params_.model; }
 
+  const std::function<std::function<void(std::function<void()>)>(
+      std::shared_ptr<model::Node>)>&
+  node_runner_factory() const {
+    return params_.node_runner_factory;
+  }
+
+  // Makes `runner()` schedule work on behalf of `node`, if the context has a
+  // node runner factory.
+  void BindRunnerToNode(std::shared_ptr<model::Node> node) {
+    if (params_.node_runner_factory) {
+      params_.runner = params_.node_runner_factory(std::move(node));
+    }
+  }
+
   const std::shared_ptr<model::RamBudgetManager>& ram_budget_manager() {
     return params_.ram_budget_manager;
   }
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/local_rendezvous.h"
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <utility>
@@ -118,6 +119,28 @@ void LocalRendezvous::ItemQueue::push_back(Item* item) {
   }
 }
 
+struct LocalRendezvous::Slot {
+  // Hash of the key that claimed the slot, or zero.
+  std::atomic<uint64> key_hash{0};
+  // `kEmptySlot`, the address of the waiting item, tagged with `kRecvTag`
+  // if it is a Recv, or `kConsumedSlot` once the item was consumed.
+  std::atomic<uintptr_t> state{0};
+};
+
+namespace {
+
+constexpr uintptr_t kEmptySlot = 0;
+constexpr uintptr_t kConsumedSlot = 2;
+// Tells the type of the waiting item from the state of its slot, since the
+// item may only be dereferenced once it was taken out of the slot.
+constexpr uintptr_t kRecvTag = 1;
+
+bool IsItem(uintptr_t state) {
+  return state != kEmptySlot && state != kConsumedSlot;
+}
+
+}  // namespace
+
 LocalRendezvous::~LocalRendezvous() {
   // Before destroying this rendezvous instance, make sure all the done-callback
   // calls have finished and the tensors have been released from the queue.
@@ -135,15 +158,228 @@ LocalRendezvous::~LocalRendezvous() {
       table_not_empty = true;
     }
   }
+  {
+    mutex_lock l(slot_callback_mu_);
+    while (pending_slot_callback_counter_.load(std::memory_order_acquire) !=
+           0) {
+      pending_slot_callback_cond_var_.wait_for(l,
+                                               std::chrono::milliseconds(50));
+    }
+  }
+  Slot* slots = slots_.load(std::memory_order_acquire);
+  if (slots != nullptr) {
+    for (int i = 0; i < kNumSlots; ++i) {
+      if (IsItem(slots[i].state.load(std::memory_order_acquire))) {
+        table_not_empty = true;
+      }
+    }
+  }
   if (table_not_empty) {
     DoAbort(absl::CancelledError("LocalRendezvous deleted"));
   }
+  delete[] slots;
 }
 
 namespace {
 uint64 KeyHash(const StringPiece& k) { return Hash64(k.data(), k.size()); }
+
+activity_watcher::ActivityScope MakeActivityScope(
+    const char* name, const void* rendezvous,
+    const Rendezvous::ParsedKey& key, uint64 key_hash) {
+  return activity_watcher::ActivityScope(
+      [&]() {
+        return std::make_unique<activity_watcher::Activity>(
+            name, activity_watcher::ActivityCategory::kRendezvous,
+            activity_watcher::Activity::Attributes{
+                {"Rendezvous", absl::StrFormat("%p", rendezvous)},
+                {"key", std::string(key.FullKey())},
+                {"key_hash", absl::StrCat(key_hash)},
+            });
+      },
+      /*level=*/1);
+}
 }  // namespace
 
+LocalRendezvous::Slot* LocalRendezvous::ClaimSlot(
+    const Rendezvous::Args& args, uint64 key_hash) {
+  if (args.rendezvous_slot <= 0 || key_hash == 0) return nullptr;
+  Slot* slots = slots_.load(std::memory_order_acquire);
+  if (slots == nullptr) {
+    Slot* new_slots = new Slot[kNumSlots];
+    if (slots_.compare_exchange_strong(slots, new_slots,
+                                       std::memory_order_acq_rel)) {
+      slots = new_slots;
+    } else {
+      delete[] new_slots;
+    }
+  }
+  Slot* slot = &slots[args.rendezvous_slot % kNumSlots];
+  uint64 claimed = slot->key_hash.load(std::memory_order_acquire);
+  if (claimed == 0 &&
+      slot->key_hash.compare_exchange_strong(claimed, key_hash,
+                                             std::memory_order_acq_rel)) {
+    return slot;
+  }
+  return claimed == key_hash ? slot : nullptr;
+}
+
+void LocalRendezvous::FinishSlotCallback() {
+  if (pending_slot_callback_counter_.fetch_sub(
+          1, std::memory_order_acq_rel) == 1) {
+    mutex_lock l(slot_callback_mu_);
+    pending_slot_callback_cond_var_.notify_all();
+  }
+}
+
+bool LocalRendezvous::SendToSlot(Slot* slot, const Rendezvous::ParsedKey& key,
+                                 uint64 key_hash,
+                                 const Rendezvous::Args& send_args,
+                                 const Tensor& val, bool is_dead) {
+  std::unique_ptr<Item> send_item;
+  uintptr_t state = slot->state.load(std::memory_order_acquire);
+  while (true) {
+    if (state == kEmptySlot) {
+      if (send_item == nullptr) {
+        send_item = std::make_unique<Item>(
+            tsl::core::GetNewRef(rc_owner_), send_args, val, is_dead,
+            MakeActivityScope("LocalRendezvous::Send", this, key, key_hash));
+      }
+      if (slot->state.compare_exchange_weak(
+              state, reinterpret_cast<uintptr_t>(send_item.get()),
+              std::memory_order_acq_rel)) {
+        DVLOG(2) << "Enqueue Send Item in slot (key:" << key.FullKey()
+                 << "). ";
+        send_item.release();
+        return true;
+      }
+    } else if (IsItem(state) && (state & kRecvTag)) {
+      if (slot->state.compare_exchange_weak(state, kConsumedSlot,
+                                            std::memory_order_acq_rel)) {
+        break;
+      }
+    } else {
+      // An earlier Send waits in, or already went through, the slot.
+      return false;
+    }
+  }
+
+  DVLOG(2) << "Consume Recv Item from slot (key:" << key.FullKey() << "). ";
+  Item* item = reinterpret_cast<Item*>(state & ~kRecvTag);
+  pending_slot_callback_counter_.fetch_add(1, std::memory_order_relaxed);
+  (*item->recv_state.waiter)(OkStatus(), send_args, item->args, val, is_dead);
+  FinishSlotCallback();
+  // Delete the item at last since it may unref and destruct the rendezvous.
+  delete item;
+  return true;
+}
+
+bool LocalRendezvous::RecvFromSlot(Slot* slot,
+                                   const Rendezvous::ParsedKey& key,
+                                   uint64 key_hash,
+                                   const Rendezvous::Args& recv_args,
+                                   Rendezvous::DoneCallback* done) {
+  uintptr_t state = slot->state.load(std::memory_order_acquire);
+  while (IsItem(state) && !(state & kRecvTag)) {
+    if (slot->state.compare_exchange_weak(state, kConsumedSlot,
+                                          std::memory_order_acq_rel)) {
+      DVLOG(2) << "Consume Send Item from slot (key:" << key.FullKey()
+               << "). ";
+      Item* item = reinterpret_cast<Item*>(state);
+      pending_slot_callback_counter_.fetch_add(1, std::memory_order_relaxed);
+      (*done)(OkStatus(), item->args, recv_args, *item->send_state.value,
+              item->send_state.is_dead);
+      FinishSlotCallback();
+      // Delete the item at last since it may unref and destruct the
+      // rendezvous.
+      delete item;
+      return true;
+    }
+  }
+  if (state != kEmptySlot) {
+    // An earlier Recv waits in, or already went through, the slot.
+    return false;
+  }
+
+  // Wait in the slot. Unlike in the table, the cancellation callback is
+  // registered before the item is published, so it has to cope with the
+  // item not being in the slot yet, or anymore.
+  CancellationManager* cm = recv_args.cancellation_manager;
+  CancellationToken token = CancellationManager::kInvalidToken;
+  Rendezvous::DoneCallback waiter;
+  if (cm != nullptr) {
+    token = cm->get_cancellation_token();
+    // NOTE(mrry): We must wrap `done` with code that deregisters the
+    // cancellation callback before calling the `done` callback, because the
+    // cancellation manager may no longer be live after `done` is called.
+    waiter = [cm, token, done = std::move(*done)](
+                 const Status& s, const Rendezvous::Args& send_args,
+                 const Rendezvous::Args& recv_args, const Tensor& v,
+                 bool dead) {
+      cm->TryDeregisterCallback(token);
+      done(s, send_args, recv_args, v, dead);
+    };
+  } else {
+    waiter = std::move(*done);
+  }
+  auto recv_item = std::make_unique<Item>(
+      tsl::core::GetNewRef(rc_owner_), recv_args, std::move(waiter), token,
+      MakeActivityScope("LocalRendezvous::RecvAsync", this, key, key_hash));
+  const uintptr_t recv_state =
+      reinterpret_cast<uintptr_t>(recv_item.get()) | kRecvTag;
+  if (cm != nullptr &&
+      !cm->RegisterCallback(token, [this, slot, recv_state] {
+        CancelSlotWaiter(slot, recv_state);
+      })) {
+    (*recv_item->recv_state.waiter)(
+        StatusGroup::MakeDerived(errors::Cancelled("RecvAsync is cancelled.")),
+        Rendezvous::Args(), recv_args, Tensor(), /*is_dead=*/false);
+    return true;
+  }
+
+  while (!slot->state.compare_exchange_weak(state, recv_state,
+                                            std::memory_order_acq_rel)) {
+    if (state == kEmptySlot) continue;
+    if (IsItem(state) && !(state & kRecvTag) &&
+        slot->state.compare_exchange_strong(state, kConsumedSlot,
+                                            std::memory_order_acq_rel)) {
+      DVLOG(2) << "Consume Send Item from slot (key:" << key.FullKey()
+               << "). ";
+      Item* item = reinterpret_cast<Item*>(state);
+      pending_slot_callback_counter_.fetch_add(1, std::memory_order_relaxed);
+      (*recv_item->recv_state.waiter)(OkStatus(), item->args, recv_args,
+                                      *item->send_state.value,
+                                      item->send_state.is_dead);
+      FinishSlotCallback();
+      recv_item.reset();
+      delete item;
+      return true;
+    }
+    // Another Recv got ahead of this one, or the rendezvous was aborted.
+    if (cm != nullptr) cm->TryDeregisterCallback(token);
+    *done = std::move(*recv_item->recv_state.waiter);
+    return false;
+  }
+  DVLOG(2) << "Enqueue Recv Item in slot (key:" << key.FullKey() << "). ";
+  recv_item.release();
+  // The cancellation callback may have run before the item was published.
+  if (cm != nullptr && (cm->IsCancelling() || cm->IsCancelled())) {
+    CancelSlotWaiter(slot, recv_state);
+  }
+  return true;
+}
+
+void LocalRendezvous::CancelSlotWaiter(Slot* slot, uintptr_t state) {
+  if (!slot->state.compare_exchange_strong(state, kConsumedSlot,
+                                           std::memory_order_acq_rel)) {
+    return;
+  }
+  Item* item = reinterpret_cast<Item*>(state & ~kRecvTag);
+  (*item->recv_state.waiter)(
+      StatusGroup::MakeDerived(errors::Cancelled("RecvAsync is cancelled.")),
+      Rendezvous::Args(), item->args, Tensor(), /*is_dead=*/false);
+  delete item;
+}
+
 Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
                              const Rendezvous::Args& send_args,
                              const Tensor& val, const bool is_dead) {
@@ -162,6 +398,12 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
 
   TF_RETURN_IF_ERROR(status());
 
+  Slot* slot = ClaimSlot(send_args, key_hash);
+  if (slot != nullptr &&
+      SendToSlot(slot, key, key_hash, send_args, val, is_dead)) {
+    return OkStatus();
+  }
+
   int bucket_index = key_hash % num_buckets_;
   auto& bucket = table_buckets_[bucket_index];
   bucket.mu.lock();
@@ -237,6 +479,11 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
     return;
   }
 
+  Slot* slot = ClaimSlot(recv_args, key_hash);
+  if (slot != nullptr && RecvFromSlot(slot, key, key_hash, recv_args, &done)) {
+    return;
+  }
+
   int bucket_index = key_hash % num_buckets_;
   auto& bucket = table_buckets_[bucket_index];
   bucket.mu.lock();
@@ -405,6 +652,24 @@ void LocalRendezvous::DoAbort(const Status& status) {
 
   // Keeps one Item to make sure the current rendezvous won't be destructed.
   std::unique_ptr<Item> to_delete;
+  Slot* slots = slots_.load(std::memory_order_acquire);
+  if (slots != nullptr) {
+    for (int i = 0; i < kNumSlots; ++i) {
+      // Sends and Recvs that arrive in the meantime use the table.
+      const uintptr_t state =
+          slots[i].state.exchange(kConsumedSlot, std::memory_order_acq_rel);
+      if (!IsItem(state)) continue;
+      Item* item = reinterpret_cast<Item*>(state & ~kRecvTag);
+      if (state & kRecvTag) {
+        (*item->recv_state.waiter)(status, Rendezvous::Args(),
+                                   Rendezvous::Args(), Tensor(), false);
+        LOG(INFO) << "Local rendezvous recv item cancelled. Slot: " << i;
+      } else {
+        LOG(INFO) << "Local rendezvous send item cancelled. Slot: " << i;
+      }
+      to_delete.reset(item);
+    }
+  }
   for (int i = 0; i < num_buckets_; ++i) {
     auto& bucket = table_buckets_[i];
     Table table;
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 #define TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -70,6 +72,23 @@ class LocalRendezvous {
   tsl::core::RefCountPtr<Rendezvous> GetOwnerRefCountPtr();
 
   struct Item;
+  struct Slot;
+
+  // Returns the slot in which the Send and the Recv of `key_hash` meet, or
+  // nullptr if they use the table because `args` has no rendezvous slot or
+  // another key claimed it first.
+  Slot* ClaimSlot(const Rendezvous::Args& args, uint64 key_hash);
+  // Return false, without side effects, if the operation must use the table
+  // instead because the slot was already used for an earlier one.
+  bool SendToSlot(Slot* slot, const Rendezvous::ParsedKey& key,
+                  uint64 key_hash, const Rendezvous::Args& send_args,
+                  const Tensor& val, bool is_dead);
+  bool RecvFromSlot(Slot* slot, const Rendezvous::ParsedKey& key,
+                    uint64 key_hash, const Rendezvous::Args& recv_args,
+                    Rendezvous::DoneCallback* done);
+  // Cancels the Recv waiting in `slot` as `state`, unless it is gone.
+  void CancelSlotWaiter(Slot* slot, uintptr_t state);
+  void FinishSlotCallback();
 
   // By invariant, the item queue under each key is of the form
   //   [item.type == kSend]* meaning each item is a sent message.
@@ -100,6 +119,21 @@ class LocalRendezvous {
 
   // Immutable set of buckets. This uses less memory than std::vector.
   const std::unique_ptr<TableBucket[]> table_buckets_;
+
+  // The first Send and the first Recv of a key with a rendezvous slot (see
+  // `Rendezvous::Args`) meet in slot `rendezvous_slot % kNumSlots` with
+  // atomic operations instead of the locked table. The first key that uses a
+  // slot claims it for good; later Sends and Recvs of that key, and all
+  // those of other keys that map to the slot, use the table. Allocated on
+  // first use.
+  static constexpr int kNumSlots = 1024;
+  std::atomic<Slot*> slots_{nullptr};
+
+  // Tracks the number of pending done-callbacks of matches in the slots.
+  std::atomic<int> pending_slot_callback_counter_{0};
+  mutex slot_callback_mu_;
+  condition_variable pending_slot_callback_cond_var_;
+
   mutex mu_;
   Status status_ TF_GUARDED_BY(mu_);
 
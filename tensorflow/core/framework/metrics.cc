@@ -214,6 +214,18 @@ auto* tf_data_service_cross_trainer_cache_size_bytes =
         "/tensorflow/data/service/cross_trainer_cache_size_bytes",
         "tf.data service cross-trainer cache memory usage in bytes.");
 
+auto* tf_data_service_cross_trainer_cache_tier_queries_counter =
+    tsl::monitoring::Counter<1>::New(
+        "/tensorflow/data/service/cross_trainer_cache_tier_queries",
+        "tf.data service cross-trainer cache queries counter, by the cache "
+        "tier serving the query.",
+        "tier");
+
+auto* tf_data_service_cross_trainer_cache_disk_size_bytes =
+    tsl::monitoring::Gauge<int64_t, 0>::New(
+        "/tensorflow/data/service/cross_trainer_cache_disk_size_bytes",
+        "tf.data service cross-trainer cache disk usage in bytes.");
+
 auto* tf_data_service_snapshot_bytes_committed =
     tsl::monitoring::Counter<0>::New(
         "/tensorflow/data/service/snapshot_bytes_committed",
@@ -627,6 +639,16 @@ void RecordTFDataServiceCrossTrainerCacheSizeBytes(size_t bytes) {
       static_cast<int64_t>(bytes));
 }
 
+void RecordTFDataServiceCrossTrainerCacheTierQuery(const string& tier) {
+  tf_data_service_cross_trainer_cache_tier_queries_counter->GetCell(tier)
+      ->IncrementBy(1);
+}
+
+void RecordTFDataServiceCrossTrainerCacheDiskSizeBytes(size_t bytes) {
+  tf_data_service_cross_trainer_cache_disk_size_bytes->GetCell()->Set(
+      static_cast<int64_t>(bytes));
+}
+
 void RecordTFDataServiceSnapshotBytesCommitted(int64_t bytes) {
   tf_data_service_snapshot_bytes_committed->GetCell()->IncrementBy(bytes);
 }
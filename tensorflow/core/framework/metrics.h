@@ -181,6 +181,13 @@ void RecordTFDataServiceCrossTrainerCacheQuery(bool cache_hit);
 // Records tf.data service cross-trainer cache memory usage in bytes.
 void RecordTFDataServiceCrossTrainerCacheSizeBytes(size_t bytes);
 
+// Records which tier of the tf.data service cross-trainer cache served a query.
+// `tier` is "memory" or "disk".
+void RecordTFDataServiceCrossTrainerCacheTierQuery(const string& tier);
+
+// Records tf.data service cross-trainer cache disk usage in bytes.
+void RecordTFDataServiceCrossTrainerCacheDiskSizeBytes(size_t bytes);
+
 // Records tf.data distributed snapshot bytes committed.
 void RecordTFDataServiceSnapshotBytesCommitted(int64_t bytes);
 
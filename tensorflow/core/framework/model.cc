@@ -40,6 +40,9 @@ namespace model {
 
 constexpr int64_t Model::kOptimizationPeriodMinMs;
 constexpr int64_t Model::kOptimizationPeriodMaxMs;
+constexpr double Model::kTailLatencyMinChange;
+constexpr int ProcessingTimeHistogram::kNumBuckets;
+constexpr double ProcessingTimeHistogram::kDecayThreshold;
 
 namespace {
 
@@ -64,6 +67,14 @@ constexpr double kBufferDownsizeMultipliter = 0.9;
 // upsizing.
 constexpr int64_t kBufferLowWatermarkThreshold = 2;
 
+// Upper limit of the first bucket of `ProcessingTimeHistogram`, and the ratio
+// between the limits of consecutive buckets.
+constexpr double kHistogramFirstBucketLimitNsec = 1.0e3;
+constexpr double kHistogramBucketGrowth = 1.3;
+// Minimum number of elements a node must have recorded for its processing time
+// percentiles to be used by the `TAIL_LATENCY` algorithm.
+constexpr double kTailLatencyMinElements = 16.0;
+
 constexpr char kDataService[] = "DataService";
 constexpr char kFlatMap[] = "FlatMap";
 constexpr char kInterleave[] = "Interleave";
@@ -1382,7 +1393,71 @@ class AsyncUnknownRatio : public AsyncRatio {
 
 }  // namespace
 
+double ProcessingTimeHistogram::BucketLimit(int index) {
+  return kHistogramFirstBucketLimitNsec *
+         std::pow(kHistogramBucketGrowth, index);
+}
+
+void ProcessingTimeHistogram::Add(double time_nsec) {
+  int index = 0;
+  if (time_nsec > kHistogramFirstBucketLimitNsec) {
+    index = static_cast<int>(
+        std::ceil(std::log(time_nsec / kHistogramFirstBucketLimitNsec) /
+                  std::log(kHistogramBucketGrowth)));
+    index = std::min(index, kNumBuckets - 1);
+  }
+  buckets_[index] += 1.0;
+  count_ += 1.0;
+  if (count_ >= kDecayThreshold) {
+    for (double& bucket : buckets_) {
+      bucket /= 2.0;
+    }
+    count_ /= 2.0;
+  }
+}
+
+double ProcessingTimeHistogram::Percentile(double percentile) const {
+  if (count_ == 0.0) {
+    return 0.0;
+  }
+  const double threshold = count_ * std::clamp(percentile, 0.0, 100.0) / 100.0;
+  double cumulative = 0.0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    if (buckets_[i] == 0.0) {
+      continue;
+    }
+    if (cumulative + buckets_[i] >= threshold) {
+      const double lower = i == 0 ? 0.0 : BucketLimit(i - 1);
+      const double upper = BucketLimit(i);
+      return lower + (upper - lower) * (threshold - cumulative) / buckets_[i];
+    }
+    cumulative += buckets_[i];
+  }
+  return BucketLimit(kNumBuckets - 1);
+}
+
+void ProcessingTimeHistogram::ToProto(ModelProto::Node* node_proto) const {
+  if (count_ == 0.0) {
+    return;
+  }
+  *node_proto->mutable_processing_time_histogram() = {buckets_.begin(),
+                                                      buckets_.end()};
+}
+
+void ProcessingTimeHistogram::FromProto(const ModelProto::Node& node_proto) {
+  if (node_proto.processing_time_histogram_size() != kNumBuckets) {
+    return;
+  }
+  count_ = 0.0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    buckets_[i] = node_proto.processing_time_histogram(i);
+    count_ += buckets_[i];
+  }
+}
+
 thread_local int64_t Node::work_start_;
+thread_local const Node* Node::element_work_node_;
+thread_local int64_t Node::element_work_;
 
 std::shared_ptr<Parameter> MakeParameter(const string& name,
                                          std::shared_ptr<SharedState> state,
@@ -1844,6 +1919,18 @@ double Node::TotalProcessingTimeForInputs(
   return sum;
 }
 
+void Node::SetProcessingTimeToPercentile(double percentile) {
+  mutex_lock l(mu_);
+  if (processing_time_histogram_.count() < kTailLatencyMinElements) {
+    return;
+  }
+  const double element_processing_time =
+      processing_time_histogram_.Percentile(percentile);
+  processing_time_ = static_cast<int64_t>(element_processing_time *
+                                          static_cast<double>(num_elements_));
+  processing_time_ema_ = element_processing_time;
+}
+
 double Node::SelfProcessingTimeLocked() const {
   if (num_elements_ == 0) {
     return 0;
@@ -2039,6 +2126,7 @@ std::shared_ptr<Node> Node::SnapshotHelper(
       }
       cloned_current->previous_processing_time_ = previous_processing_time_;
       cloned_current->processing_time_ema_ = processing_time_ema_;
+      cloned_current->processing_time_histogram_ = processing_time_histogram_;
     }
   }
 
@@ -2099,6 +2187,7 @@ Status Node::ToProto(ModelProto::Node* node_proto) const {
   node_proto->set_num_elements(num_elements_);
   node_proto->set_processing_time(processing_time_);
   node_proto->set_record_metrics(record_metrics_);
+  processing_time_histogram_.ToProto(node_proto);
 
   // Produce protos for all parameters.
   for (auto const& parameter : parameters_) {
@@ -2166,6 +2255,7 @@ Status Node::FromProtoHelper(ModelProto::Node node_proto,
   {
     mutex_lock l(node->mu_);
     node->UpdateProcessingTimeEma();
+    node->processing_time_histogram_.FromProto(node_proto);
   }
   return OkStatus();
 }
@@ -2351,6 +2441,10 @@ void Model::Optimize(AutotuneAlgorithm algorithm,
       OptimizeStageBased(snapshot, optimization_params, cancellation_manager,
                          ram_budget_manager);
       break;
+    case AutotuneAlgorithm::TAIL_LATENCY:
+      OptimizeTailLatency(snapshot, optimization_params, cancellation_manager,
+                          ram_budget_manager);
+      break;
     default:
       VLOG(2) << "Autotuning algorithm was not recognized. Aborting "
                  "optimization.";
@@ -2622,7 +2716,8 @@ void Model::OptimizeHillClimbHelper(
     std::shared_ptr<Node> snapshot,
     const OptimizationParams& optimization_params,
     CancellationManager* cancellation_manager, int64_t ram_budget,
-    RamBudgetManager& ram_budget_manager, StopPredicate should_stop) {
+    RamBudgetManager& ram_budget_manager, StopPredicate should_stop,
+    ApplyPredicate should_apply) {
   VLOG(2) << "Starting optimization of tunable parameters with Hill Climb.";
   const double processing_time = TotalProcessingTime(snapshot);
   auto parameters = CollectTunableParameters(snapshot);
@@ -2702,6 +2797,9 @@ void Model::OptimizeHillClimbHelper(
     // Take a hill-climb step
     best_parameter->value++;
   }
+  if (should_apply && !should_apply(parameters)) {
+    return;
+  }
   if (ram_budget_manager.RequestModelAllocation(
           TotalMaximumBufferedBytes(snapshot))) {
     // Note that `ram_budget` is only a snapshot of
@@ -3084,6 +3182,89 @@ void Model::OptimizeHillClimb(std::shared_ptr<Node> snapshot,
                           should_stop);
 }
 
+void Model::OptimizeTailLatency(std::shared_ptr<Node> snapshot,
+                                const OptimizationParams& optimization_params,
+                                CancellationManager* cancellation_manager,
+                                RamBudgetManager& ram_budget_manager) {
+  // The snapshot is a copy, so its processing times can be replaced with the
+  // tail processing times.
+  Node::NodeVector nodes =
+      snapshot->CollectNodes(TraversalOrder::BFS, IsAnyNode);
+  nodes.push_back(snapshot);
+  for (auto& node : nodes) {
+    node->SetProcessingTimeToPercentile(kTailLatencyPercentile);
+  }
+  auto should_stop = [&optimization_params](const ModelParameters& parameters,
+                                            double processing_time,
+                                            double output_time,
+                                            double buffered_bytes) {
+    const bool all_max = AreAllParametersMax(parameters);
+    const bool output_time_budget_exceeded =
+        output_time < processing_time / optimization_params.cpu_budget();
+    const bool ram_budget_exceeded =
+        buffered_bytes > optimization_params.ram_budget();
+    if (all_max) {
+      metrics::RecordTFDataAutotuneStoppingCriteria("all_max");
+    }
+    if (output_time_budget_exceeded) {
+      metrics::RecordTFDataAutotuneStoppingCriteria("output_time");
+    }
+    if (ram_budget_exceeded) {
+      metrics::RecordTFDataAutotuneStoppingCriteria("max_buffered_bytes");
+    }
+    return all_max || output_time_budget_exceeded || ram_budget_exceeded;
+  };
+  auto should_apply = [this, &snapshot, &optimization_params](
+                          const ModelParameters& parameters) {
+    // Evaluates the current parameter values on the same snapshot, and then
+    // restores the new values.
+    std::vector<double> new_values;
+    new_values.reserve(parameters.size());
+    bool changed = false;
+    for (auto& [node_name, parameter] : parameters) {
+      new_values.push_back(parameter->value);
+      double current_value;
+      {
+        tf_shared_lock l(*parameter->state->mu);
+        current_value = parameter->state->value;
+      }
+      if (current_value == kAutotune) {
+        // The parameters have not been tuned yet.
+        return true;
+      }
+      changed |= current_value != parameter->value;
+      parameter->value = current_value;
+    }
+    if (!changed) {
+      return false;
+    }
+    const double current_output_time =
+        OutputTime(snapshot, optimization_params.model_input_time(),
+                   /*gradients=*/nullptr);
+    const double current_buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+    for (size_t i = 0; i < parameters.size(); ++i) {
+      parameters[i].second->value = new_values[i];
+    }
+    if (current_buffered_bytes > optimization_params.ram_budget()) {
+      return true;
+    }
+    const double new_output_time =
+        OutputTime(snapshot, optimization_params.model_input_time(),
+                   /*gradients=*/nullptr);
+    const double change = std::abs(new_output_time - current_output_time);
+    if (change <= kTailLatencyMinChange * current_output_time) {
+      VLOG(2) << "Keeping the current parameter values, since the new values "
+                 "change the tail output time only from "
+              << current_output_time << " to " << new_output_time << " ns.";
+      return false;
+    }
+    return true;
+  };
+  OptimizeHillClimbHelper(snapshot, optimization_params, cancellation_manager,
+                          optimization_params.ram_budget(), ram_budget_manager,
+                          should_stop, should_apply);
+}
+
 void Model::OptimizeMaxParallelism(
     std::shared_ptr<Node> snapshot,
     const OptimizationParams& optimization_params,
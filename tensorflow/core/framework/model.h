@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_FRAMEWORK_MODEL_H_
 
 #include <algorithm>
+#include <array>
 #include <cstdint>
 #include <deque>
 #include <functional>
@@ -73,6 +74,10 @@ constexpr double kRamBudgetShare = 0.5;
 // average of processing time per element.
 constexpr double kProcessingTimeEmaWeight = 0.1;
 
+// Percentile of the per-element processing time which the `TAIL_LATENCY`
+// autotune algorithm optimizes for.
+constexpr double kTailLatencyPercentile = 99.0;
+
 enum class TraversalOrder {
   BFS = 0,
   REVERSE_BFS = 1,
@@ -253,6 +258,41 @@ class RamBudgetManager {
   int64_t model_allocated_ TF_GUARDED_BY(mu_) = 0;
 };
 
+// Histogram of the per-element processing time of a node, in nanoseconds.
+//
+// Bucket limits grow exponentially from 1 microsecond. To follow changes in the
+// cost of elements, all counts are halved once their total reaches
+// `kDecayThreshold`, so that the histogram reflects the last few thousand
+// elements. The class is not thread-safe.
+class ProcessingTimeHistogram {
+ public:
+  static constexpr int kNumBuckets = 64;
+
+  // Records an element which took `time_nsec` to process.
+  void Add(double time_nsec);
+
+  // Returns the `percentile` (between 0 and 100) of the recorded processing
+  // times, interpolated within buckets. Returns 0 if nothing was recorded.
+  double Percentile(double percentile) const;
+
+  // Returns the decayed number of recorded elements.
+  double count() const { return count_; }
+
+  void ToProto(ModelProto::Node* node_proto) const;
+  // Restores the counts from `node_proto`. Ignores histograms with a different
+  // number of buckets.
+  void FromProto(const ModelProto::Node& node_proto);
+
+ private:
+  static constexpr double kDecayThreshold = 4096.0;
+
+  // Returns the upper limit of the bucket at `index`.
+  static double BucketLimit(int index);
+
+  std::array<double, kNumBuckets> buckets_ = {};
+  double count_ = 0.0;
+};
+
 // Abstract representation of a TensorFlow input pipeline node. It collects
 // information about inputs to this node, processing time spent executing the
 // node logic, number of elements produced by the node, various other
@@ -344,6 +384,7 @@ class Node {
   // Increments the aggregate processing time by the given delta.
   void add_processing_time(int64_t delta) TF_LOCKS_EXCLUDED(mu_) {
     processing_time_ += delta;
+    AddElementWork(delta);
   }
 
   // Returns an indication whether autotuning is enabled for this node.
@@ -430,6 +471,14 @@ class Node {
     return processing_time_;
   }
 
+  // Returns the `percentile` of the per-element processing time of the
+  // recently produced elements, or 0 if none was recorded.
+  double ProcessingTimePercentile(double percentile) const
+      TF_LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    return processing_time_histogram_.Percentile(percentile);
+  }
+
   // Records that the node consumed the given number of bytes.
   void record_bytes_consumed(int64_t num_bytes) {
     bytes_consumed_ += num_bytes;
@@ -454,6 +503,9 @@ class Node {
       int64_t high_watermark =
           std::max(buffered_elements_high_, buffered_elements_);
       buffered_elements_high_ = high_watermark;
+      if (elements_delta > 0) {
+        RecordElementWork();
+      }
     }
   }
 
@@ -477,6 +529,7 @@ class Node {
     // TODO(jsimsa): Use DCHECK_NE(work_start_, 0) here.
     if (work_start_ != 0) {
       processing_time_ += time_nanos - work_start_;
+      AddElementWork(time_nanos - work_start_);
       work_start_ = 0;
     } else {
       VLOG(1) << "Encountered a stop event without a matching start event.";
@@ -579,6 +632,12 @@ class Node {
   // Returns the per-element processing time in nanoseconds spent in this node.
   double SelfProcessingTime() const TF_LOCKS_EXCLUDED(mu_);
 
+  // Sets the processing time of this node as if every element it produced had
+  // cost the `percentile` of the recently recorded per-element processing
+  // times. Nodes which recorded too few elements are left unchanged. This is
+  // meant for snapshots, to model the tail latency of the pipeline.
+  void SetProcessingTimeToPercentile(double percentile) TF_LOCKS_EXCLUDED(mu_);
+
   // Returns the total number of bytes buffered in all nodes in the subtree for
   // which autotuning is enabled.
   double TotalBufferedBytes() const TF_LOCKS_EXCLUDED(mu_);
@@ -671,7 +730,34 @@ class Node {
     std::atomic<int64_t> recorded_num_elements_;
   };
 
+  // Adds `delta` nanoseconds of work done by the current thread to the element
+  // it is producing, if this node is asynchronous.
+  void AddElementWork(int64_t delta) {
+    if (!IsAsync()) {
+      return;
+    }
+    if (element_work_node_ != this) {
+      element_work_node_ = this;
+      element_work_ = 0;
+    }
+    element_work_ += delta;
+  }
+
+  // Adds the work done by the current thread since it last produced an element
+  // of this asynchronous node to the processing time histogram.
+  void RecordElementWork() TF_LOCKS_EXCLUDED(mu_) {
+    if (element_work_node_ != this) {
+      return;
+    }
+    const int64_t element_work = element_work_;
+    element_work_ = 0;
+    mutex_lock l(mu_);
+    processing_time_histogram_.Add(static_cast<double>(element_work));
+  }
+
   // Computes the exponential moving average of processing time per element.
+  // For synchronous nodes, which produce one element at a time, also adds the
+  // processing time of the element to the histogram.
   void UpdateProcessingTimeEma() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     if (previous_processing_time_ == 0) {
       if (num_elements_ > 0) {
@@ -682,10 +768,16 @@ class Node {
         processing_time_ema_ = static_cast<double>(processing_time_);
       }
     } else {
+      const double element_processing_time =
+          static_cast<double>(processing_time_ - previous_processing_time_);
       processing_time_ema_ =
           (1.0 - kProcessingTimeEmaWeight) * processing_time_ema_ +
-          kProcessingTimeEmaWeight *
-              static_cast<double>(processing_time_ - previous_processing_time_);
+          kProcessingTimeEmaWeight * element_processing_time;
+      // Elements of asynchronous nodes are produced concurrently, so their
+      // processing times are recorded by the producing threads instead.
+      if (!IsAsync()) {
+        processing_time_histogram_.Add(element_processing_time);
+      }
     }
     previous_processing_time_ = processing_time_;
   }
@@ -810,6 +902,13 @@ class Node {
   // to `Node::record_start()` (for any node).
   static thread_local int64_t work_start_;  // Will be initialized to zero.
 
+  // Stores the work done by the current thread for the asynchronous node
+  // `element_work_node_` since the thread last produced one of its elements.
+  // Only a node's own work is included: switching to another asynchronous
+  // node, e.g. an input, drops the work recorded so far.
+  static thread_local const Node* element_work_node_;
+  static thread_local int64_t element_work_;
+
   mutable mutex mu_;
   const int64_t id_;
   const string name_;
@@ -840,6 +939,8 @@ class Node {
   // exponential moving average.
   int64_t previous_processing_time_ TF_GUARDED_BY(mu_) = 0;
   double processing_time_ema_ TF_GUARDED_BY(mu_) = 0.0;
+  // Histogram of the per-element processing time.
+  ProcessingTimeHistogram processing_time_histogram_ TF_GUARDED_BY(mu_);
 
   // Inputs of this node. These can represent an iterator created from the input
   // dataset but also other input iterators (e.g. created by the user-defined
@@ -1026,6 +1127,12 @@ class Model {
   // estimated output time, and estimated number of buffers bytes.
   using StopPredicate =
       std::function<bool(const ModelParameters&, double, double, double)>;
+  // Determines whether the optimized parameter values should be applied.
+  using ApplyPredicate = std::function<bool(const ModelParameters&)>;
+
+  // Minimum relative change of the modeled tail output time for which the
+  // `TAIL_LATENCY` algorithm applies new parameter values.
+  static constexpr double kTailLatencyMinChange = 0.1;
 
   static constexpr int64_t kOptimizationPeriodMinMs = 10;
   static constexpr int64_t kOptimizationPeriodMaxMs =
@@ -1073,13 +1180,15 @@ class Model {
                                CancellationManager* cancellation_manager);
 
   // Helper method for implementing hill-climb optimization that can be
-  // parametrized by a predicate to use for stopping the optimization.
+  // parametrized by a predicate to use for stopping the optimization, and by a
+  // predicate deciding whether to apply the resulting parameter values.
   void OptimizeHillClimbHelper(std::shared_ptr<Node> snapshot,
                                const OptimizationParams& optimization_params,
                                CancellationManager* cancellation_manager,
                                int64_t ram_budget,
                                RamBudgetManager& ram_budget_manager,
-                               StopPredicate should_stop);
+                               StopPredicate should_stop,
+                               ApplyPredicate should_apply = nullptr);
 
   // This optimization algorithm starts by setting all tunable parallelism
   // parameters to the minimum value. It then repeatedly identifies the
@@ -1092,6 +1201,19 @@ class Model {
                          CancellationManager* cancellation_manager,
                          RamBudgetManager& ram_budget_manager);
 
+  // This optimization behaves similarly to the hill climb optimization, but
+  // models every element as costing the `kTailLatencyPercentile` of the
+  // processing times recently recorded by its node, instead of their mean.
+  // This sizes parallelism and buffers for the slow elements of pipelines with
+  // heavy-tailed per-element costs. To converge to stable parameters despite
+  // noisy measurements, new parameter values are only applied if they change
+  // the modeled tail output time by more than `kTailLatencyMinChange`, or if
+  // the current values exceed the RAM budget.
+  void OptimizeTailLatency(std::shared_ptr<Node> snapshot,
+                           const OptimizationParams& optimization_params,
+                           CancellationManager* cancellation_manager,
+                           RamBudgetManager& ram_budget_manager);
+
   // This optimization behaves similarly to the hill climb optimization but uses
   // a relaxed stoping condition, allowing the optimization to oversubscribe
   // CPU.
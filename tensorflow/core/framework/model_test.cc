@@ -23,14 +23,17 @@ limitations under the License.
 #include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace data {
@@ -1358,7 +1361,165 @@ TEST_P(OptimizeZeroRamBudgetTest, Model) {
 }
 
 INSTANTIATE_TEST_SUITE_P(Test, OptimizeZeroRamBudgetTest,
-                         ::testing::Values(0, 1, 2, 3));
+                         ::testing::Values(0, 1, 2, 3, 5));
+
+TEST(ProcessingTimeHistogramTest, Percentiles) {
+  ProcessingTimeHistogram histogram;
+  EXPECT_EQ(histogram.Percentile(50), 0.0);
+  for (int i = 0; i < 99; ++i) {
+    histogram.Add(1.0e6);
+  }
+  histogram.Add(1.0e8);
+  EXPECT_EQ(histogram.count(), 100);
+  // Percentiles are exact up to the width of a bucket.
+  EXPECT_NEAR(histogram.Percentile(50), 1.0e6, 0.3e6);
+  EXPECT_NEAR(histogram.Percentile(99), 1.0e6, 0.3e6);
+  EXPECT_GT(histogram.Percentile(99.5), 0.7e8);
+  EXPECT_NEAR(histogram.Percentile(100), 1.0e8, 0.3e8);
+}
+
+TEST(ProcessingTimeHistogramTest, Decay) {
+  ProcessingTimeHistogram histogram;
+  for (int i = 0; i < 4096; ++i) {
+    histogram.Add(1.0e6);
+  }
+  EXPECT_LT(histogram.count(), 4096);
+  for (int i = 0; i < 8192; ++i) {
+    histogram.Add(1.0e8);
+  }
+  // The histogram follows the recent processing times.
+  EXPECT_LT(histogram.count(), 4096);
+  EXPECT_GT(histogram.Percentile(50), 0.7e8);
+}
+
+TEST(ProcessingTimeHistogramTest, Node) {
+  std::shared_ptr<Node> source = model::MakeSourceNode({0, "source", nullptr});
+  for (int i = 0; i < 100; ++i) {
+    source->add_processing_time(i < 90 ? 1000000 : 10000000);
+    source->record_element();
+  }
+  EXPECT_NEAR(source->ProcessingTimePercentile(50), 1.0e6, 0.3e6);
+  EXPECT_NEAR(source->ProcessingTimePercentile(99), 1.0e7, 0.3e7);
+
+  std::shared_ptr<Node> snapshot = source->Snapshot();
+  EXPECT_EQ(snapshot->ProcessingTimePercentile(99),
+            source->ProcessingTimePercentile(99));
+  snapshot->SetProcessingTimeToPercentile(99);
+  EXPECT_NEAR(snapshot->SelfProcessingTime(),
+              source->ProcessingTimePercentile(99), 1.0e3);
+  EXPECT_LT(source->SelfProcessingTime(), 2.0e6);
+
+  ModelProto::Node node_proto;
+  TF_ASSERT_OK(source->ToProto(&node_proto));
+  EXPECT_EQ(node_proto.processing_time_histogram_size(),
+            ProcessingTimeHistogram::kNumBuckets);
+  std::shared_ptr<Node> restored;
+  TF_ASSERT_OK(Node::FromProto(node_proto, nullptr, &restored));
+  EXPECT_EQ(restored->ProcessingTimePercentile(50),
+            source->ProcessingTimePercentile(50));
+  EXPECT_EQ(restored->ProcessingTimePercentile(99),
+            source->ProcessingTimePercentile(99));
+}
+
+TEST(ProcessingTimeHistogramTest, ParallelNode) {
+  std::shared_ptr<Node> node = model::MakeAsyncKnownRatioNode(
+      {0, "ParallelMap", nullptr}, /*ratio=*/1, /*parameters=*/{});
+  constexpr int kNumThreads = 4;
+  constexpr int kNumElementsPerThread = 25;
+  {
+    thread::ThreadPool pool(Env::Default(), "producers", kNumThreads);
+    for (int i = 0; i < kNumThreads; ++i) {
+      pool.Schedule([node, i]() {
+        for (int j = 0; j < kNumElementsPerThread; ++j) {
+          // Every 10th element takes 10ms of work instead of 1ms, in two
+          // steps separated by 5ms of waiting.
+          const int64_t work = j % 10 == 9 ? 10000000 : 1000000;
+          const int64_t start =
+              1 + (i * kNumElementsPerThread + j) * int64_t{100000000};
+          node->record_start(start);
+          node->record_stop(start + work / 2);
+          node->record_start(start + work / 2 + 5000000);
+          node->record_stop(start + work + 5000000);
+          node->record_buffer_event(/*bytes_delta=*/0, /*elements_delta=*/1);
+        }
+      });
+    }
+  }
+  for (int i = 0; i < kNumThreads * kNumElementsPerThread; ++i) {
+    node->record_buffer_event(/*bytes_delta=*/0, /*elements_delta=*/-1);
+    node->record_element();
+  }
+  // The consumer gets the elements after they have all been produced, so the
+  // processing time between two of them says nothing about the element cost.
+  EXPECT_NEAR(node->ProcessingTimePercentile(50), 1.0e6, 0.3e6);
+  EXPECT_NEAR(node->ProcessingTimePercentile(99), 1.0e7, 0.3e7);
+}
+
+// Adds to `model` a parallel map with a tunable parallelism, which has
+// produced 1000 elements. Every 20th element took `slow_time_nsec` to produce,
+// and the others `fast_time_nsec`.
+std::shared_ptr<Node> AddParallelMapNode(Model& model, int64_t id,
+                                         std::shared_ptr<Node> parent,
+                                         int64_t fast_time_nsec,
+                                         int64_t slow_time_nsec) {
+  std::shared_ptr<Node> node = model::MakeAsyncKnownRatioNode(
+      {id, strings::StrCat("ParallelMap", id), parent}, /*ratio=*/1,
+      {model::MakeParameter(
+          "parallelism",
+          std::make_shared<SharedState>(
+              /*value=*/model::kAutotune, std::make_shared<mutex>(),
+              std::make_shared<condition_variable>()),
+          /*min=*/1, /*max=*/16)});
+  model.AddNode([&node](model::Node::Args args) { return node; }, node->name(),
+                parent, &node);
+  for (int i = 0; i < 1000; ++i) {
+    node->add_processing_time(i % 20 == 19 ? slow_time_nsec : fast_time_nsec);
+    node->record_buffer_event(/*bytes_delta=*/0, /*elements_delta=*/1);
+    node->record_buffer_event(/*bytes_delta=*/0, /*elements_delta=*/-1);
+    node->record_element();
+  }
+  return node;
+}
+
+// Adds to `model` two parallel maps with the same mean processing time of 2ms
+// per element. The processing time of the input map is heavy-tailed: one
+// element in 20 takes 21ms.
+void AddHeavyTailedPipeline(Model& model, std::shared_ptr<Node>* uniform_map,
+                            std::shared_ptr<Node>* heavy_tailed_map) {
+  *uniform_map = AddParallelMapNode(model, /*id=*/1, /*parent=*/nullptr,
+                                    /*fast_time_nsec=*/2000000,
+                                    /*slow_time_nsec=*/2000000);
+  *heavy_tailed_map = AddParallelMapNode(model, /*id=*/2, *uniform_map,
+                                         /*fast_time_nsec=*/1000000,
+                                         /*slow_time_nsec=*/21000000);
+}
+
+TEST(OptimizeTailLatencyTest, ParallelizesHeavyTailedNode) {
+  model::Model model;
+  std::shared_ptr<Node> uniform_map, heavy_tailed_map;
+  AddHeavyTailedPipeline(model, &uniform_map, &heavy_tailed_map);
+
+  CancellationManager cancellation_manager;
+  RamBudgetManager ram_budget_manager(/*total_ram_budget=*/1 << 30);
+  model.Optimize(AutotuneAlgorithm::TAIL_LATENCY, CpuBudgetFunc(8),
+                 /*ram_budget_share=*/1.0, /*fixed_ram_budget=*/1 << 30,
+                 /*model_input_time=*/0, ram_budget_manager,
+                 &cancellation_manager);
+  const double uniform_parallelism = uniform_map->parameter_value(kParallelism);
+  const double heavy_tailed_parallelism =
+      heavy_tailed_map->parameter_value(kParallelism);
+  EXPECT_GE(uniform_parallelism, 1);
+  EXPECT_GT(heavy_tailed_parallelism, uniform_parallelism);
+
+  // Optimizing again without new elements keeps the parameter values.
+  model.Optimize(AutotuneAlgorithm::TAIL_LATENCY, CpuBudgetFunc(8),
+                 /*ram_budget_share=*/1.0, /*fixed_ram_budget=*/1 << 30,
+                 /*model_input_time=*/0, ram_budget_manager,
+                 &cancellation_manager);
+  EXPECT_EQ(uniform_map->parameter_value(kParallelism), uniform_parallelism);
+  EXPECT_EQ(heavy_tailed_map->parameter_value(kParallelism),
+            heavy_tailed_parallelism);
+}
 
 TEST(RecordTimeTest, RecordTimeTest) {
   std::shared_ptr<Node> source = model::MakeSourceNode({});
@@ -3548,6 +3709,77 @@ TEST(RamBudgetManagerTest, RequestAllocationsWithBudgetAdjustment) {
   EXPECT_TRUE(rbm.RequestLegacyPrefetchBytes(4));
 }
 
+// Returns the model snapshots to replay: the files in the directory named by
+// the `TF_DATA_MODEL_REPLAY_DIR` environment variable, or a synthetic
+// heavy-tailed pipeline if it is not set. Snapshots are `ModelProto`s, as
+// written by `Model::Save` or exported by the `/tensorflow/data/model` gauge.
+std::vector<string> ModelSnapshotFiles() {
+  std::vector<string> files;
+  Env* env = Env::Default();
+  const char* replay_dir = std::getenv("TF_DATA_MODEL_REPLAY_DIR");
+  if (replay_dir != nullptr) {
+    TF_CHECK_OK(env->GetMatchingPaths(io::JoinPath(replay_dir, "*"), &files));
+    return files;
+  }
+  model::Model model;
+  std::shared_ptr<Node> uniform_map, heavy_tailed_map;
+  AddHeavyTailedPipeline(model, &uniform_map, &heavy_tailed_map);
+  ModelProto::OptimizationParams optimization_params;
+  optimization_params.set_cpu_budget(8);
+  optimization_params.set_ram_budget(1 << 30);
+  string file;
+  CHECK(env->LocalTempFilename(&file));
+  TF_CHECK_OK(
+      model.Save(file, model.output()->Snapshot(), optimization_params));
+  files.push_back(file);
+  return files;
+}
+
+// Replays model snapshots with the autotune algorithm `state.range(0)`, and
+// reports the mean parallelism it chooses.
+void BM_ReplayModelSnapshots(::testing::benchmark::State& state) {
+  const auto algorithm = static_cast<AutotuneAlgorithm>(state.range(0));
+  const std::vector<string> files = ModelSnapshotFiles();
+  double total_parallelism = 0.0;
+  int64_t num_parallelism_parameters = 0;
+  for (auto s : state) {
+    for (const string& file : files) {
+      state.PauseTiming();
+      std::unique_ptr<Model> model;
+      ModelProto::OptimizationParams optimization_params;
+      TF_CHECK_OK(Model::Load(file, &model, &optimization_params));
+      const int64_t cpu_budget =
+          std::max<int64_t>(optimization_params.cpu_budget(), 1);
+      CancellationManager cancellation_manager;
+      RamBudgetManager ram_budget_manager(optimization_params.ram_budget());
+      state.ResumeTiming();
+      model->Optimize(algorithm, CpuBudgetFunc(cpu_budget),
+                      /*ram_budget_share=*/1.0,
+                      /*fixed_ram_budget=*/optimization_params.ram_budget(),
+                      optimization_params.model_input_time(),
+                      ram_budget_manager, &cancellation_manager);
+      state.PauseTiming();
+      for (auto& [node_name, parameter] :
+           model->output()->CollectTunableParameters()) {
+        if (parameter->name == kParallelism) {
+          tf_shared_lock l(*parameter->state->mu);
+          total_parallelism += parameter->state->value;
+          ++num_parallelism_parameters;
+        }
+      }
+      state.ResumeTiming();
+    }
+  }
+  if (num_parallelism_parameters > 0) {
+    state.counters["mean_parallelism"] =
+        total_parallelism / num_parallelism_parameters;
+  }
+}
+BENCHMARK(BM_ReplayModelSnapshots)
+    ->Arg(AutotuneAlgorithm::HILL_CLIMB)
+    ->Arg(AutotuneAlgorithm::STAGE_BASED)
+    ->Arg(AutotuneAlgorithm::TAIL_LATENCY);
+
 }  // namespace
 }  // namespace model
 }  // namespace data
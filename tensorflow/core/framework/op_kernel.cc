@@ -380,6 +380,11 @@ Allocator* OpKernelContext::get_allocator(AllocatorAttributes attr) {
   } else {
     allocator = params_->device->GetAllocator(attr);
   }
+  return maybe_wrap_tracking_allocator(allocator);
+}
+
+Allocator* OpKernelContext::maybe_wrap_tracking_allocator(
+    Allocator* allocator) {
   if (TF_PREDICT_FALSE(track_allocations())) {
     DCHECK(tracking_state_);
     mutex_lock lock(tracking_state_->mu);
@@ -757,10 +762,23 @@ Status OpKernelContext::allocate_output(StringPiece name,
   return allocate_output(start, shape, tensor, attr);
 }
 
+Allocator* OpKernelContext::get_allocator(
+    AllocatorAttributes attr, const AllocationAttributes& allocation_attr,
+    Allocator* step_allocator) {
+  // Step allocators only serve plain host memory.
+  if (step_allocator != nullptr && attr.scope_id <= 0 &&
+      !attr.gpu_compatible() && !attr.nic_compatible() &&
+      allocation_attr.freed_by_func == nullptr) {
+    return maybe_wrap_tracking_allocator(step_allocator);
+  }
+  return get_allocator(attr);
+}
+
 Status OpKernelContext::allocate_tensor(
     DataType type, const TensorShape& shape, Tensor* out_tensor,
-    AllocatorAttributes attr, const AllocationAttributes& allocation_attr) {
-  Allocator* a = get_allocator(attr);
+    AllocatorAttributes attr, const AllocationAttributes& allocation_attr,
+    Allocator* step_allocator) {
+  Allocator* a = get_allocator(attr, allocation_attr, step_allocator);
   Tensor new_tensor(
       a, type, shape,
       AllocationAttributes(
@@ -819,7 +837,17 @@ Status OpKernelContext::allocate_output(int index, const TensorShape& shape,
       op_kernel().name_view().data(), step_id(), "output", type,
       [&shape]() { return shape.DebugString(); });
   auto output_tensor = std::make_unique<Tensor>();
-  Status s = allocate_tensor(type, shape, output_tensor.get(), attr);
+  Allocator* step_allocator = nullptr;
+  if (params_->planned_output_allocator_array != nullptr) {
+    step_allocator = params_->planned_output_allocator_array[index];
+  }
+  if (step_allocator == nullptr &&
+      params_->step_local_output_array != nullptr &&
+      params_->step_local_output_array[index]) {
+    step_allocator = params_->step_arena;
+  }
+  Status s = allocate_tensor(type, shape, output_tensor.get(), attr,
+                             AllocationAttributes(), step_allocator);
   if (s.ok()) {
     outputs_[index] = TensorValue(output_tensor.release());
     *output = outputs_[index].tensor;
@@ -849,10 +877,11 @@ Status OpKernelContext::allocate_temp(
   profiler::ScopedMemoryDebugAnnotation op_annotation(
       op_kernel().name_view().data(), step_id(), "temp", type,
       [&shape]() { return shape.DebugString(); });
-  Status s =
-      allocate_tensor(type, shape, out_temp, allocator_attr, allocation_attr);
+  Status s = allocate_tensor(type, shape, out_temp, allocator_attr,
+                             allocation_attr, params_->step_arena);
   if (track_allocations() && s.ok() && out_temp->TotalBytes() > 0) {
-    Allocator* a = get_allocator(allocator_attr);
+    Allocator* a =
+        get_allocator(allocator_attr, allocation_attr, params_->step_arena);
     if (a->TracksAllocationSizes()) {
       int64_t alloc_size = a->AllocatedSize(out_temp->tensor_data().data());
       record_temp_memory_allocation(alloc_size, *out_temp);
@@ -693,6 +693,22 @@ class OpKernelContext {
     // outputs are required.
     bool* outputs_required_array = nullptr;
 
+    // If not null, an allocator for memory that does not outlive the step.
+    // Temporaries, and the outputs marked in `step_local_output_array`, are
+    // allocated from it unless their attributes require another allocator.
+    Allocator* step_arena = nullptr;
+
+    // Array indexed by output number for this node; the ith bool is true iff
+    // the ith output may be allocated from `step_arena`. If null, no output
+    // may.
+    const bool* step_local_output_array = nullptr;
+
+    // Array indexed by output number for this node. If not null, and the ith
+    // element is not null, the ith output is allocated from it instead of
+    // from `step_arena`. Used to place outputs in memory planned ahead of the
+    // step.
+    Allocator* const* planned_output_allocator_array = nullptr;
+
     // For access to distributed coordination service.
     tsl::CoordinationServiceAgent* coordination_service_agent = nullptr;
   };
@@ -1271,9 +1287,22 @@ class OpKernelContext {
                            AllocationAttributes());
   }
 
+  // If not null, `step_allocator` serves memory that does not outlive the
+  // step, e.g. `params_->step_arena`, and is used if it may serve the tensor.
   Status allocate_tensor(DataType type, const TensorShape& shape,
                          Tensor* out_tensor, AllocatorAttributes allocator_attr,
-                         const AllocationAttributes& allocation_attr);
+                         const AllocationAttributes& allocation_attr,
+                         Allocator* step_allocator = nullptr);
+
+  // Returns the allocator for a tensor with the given attributes, which is
+  // `step_allocator` if it is not null and may serve the tensor.
+  Allocator* get_allocator(AllocatorAttributes attr,
+                           const AllocationAttributes& allocation_attr,
+                           Allocator* step_allocator);
+
+  // Returns `allocator`, wrapped in a `TrackingAllocator` if allocations are
+  // tracked.
+  Allocator* maybe_wrap_tracking_allocator(Allocator* allocator);
 
   // Helpers for `set_output()`.
 
@@ -53,6 +53,10 @@ class RendezvousInterface {
     DeviceContext* device_context = nullptr;
     AllocatorAttributes alloc_attrs;
     CancellationManager* cancellation_manager = nullptr;  // not owned.
+    // If positive, the "_rendezvous_slot" the graph partitioner assigned to
+    // the Send/Recv pair, which is the same for both sides. A local
+    // rendezvous may use it to match the pair without its hash table.
+    int64_t rendezvous_slot = 0;
   };
 
   // Parses the key constructed by CreateKey and parse src/dst device
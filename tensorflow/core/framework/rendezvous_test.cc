@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/rendezvous.h"
 
+#include <vector>
+
 #include "absl/status/status.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/cancellation.h"
@@ -28,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -394,6 +397,161 @@ TEST_F(LocalRendezvousTest, AbortThenRecvOrSend) {
   EXPECT_TRUE(absl::IsAborted(rendez_->Recv(KeyFoo(), args, &val, &val_dead)));
 }
 
+Rendezvous::Args SlotArgs(int64_t rendezvous_slot) {
+  Rendezvous::Args args;
+  args.rendezvous_slot = rendezvous_slot;
+  return args;
+}
+
+TEST_F(LocalRendezvousTest, SlotSendRecv) {
+  TF_ASSERT_OK(rendez_->Send(KeyFoo(), SlotArgs(1), V("hello"), false));
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  TF_ASSERT_OK(rendez_->Recv(KeyFoo(), SlotArgs(1), &val, &is_dead));
+  EXPECT_EQ("hello", V(val));
+}
+
+TEST_F(LocalRendezvousTest, SlotRecvSend) {
+  SchedClosure([this]() {
+    Env::Default()->SleepForMicroseconds(10000);
+    TF_ASSERT_OK(rendez_->Send(KeyFoo(), SlotArgs(1), V("hello"), false));
+  });
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  TF_ASSERT_OK(rendez_->Recv(KeyFoo(), SlotArgs(1), &val, &is_dead));
+  EXPECT_EQ("hello", V(val));
+}
+
+TEST_F(LocalRendezvousTest, SlotSharedByTwoKeys) {
+  // "bar" finds the slot claimed by "foo", and uses the table.
+  TF_ASSERT_OK(rendez_->Send(KeyFoo(), SlotArgs(7), V("foo"), false));
+  TF_ASSERT_OK(rendez_->Send(KeyBar(), SlotArgs(7), V("bar"), false));
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  TF_ASSERT_OK(rendez_->Recv(KeyBar(), SlotArgs(7), &val, &is_dead));
+  EXPECT_EQ("bar", V(val));
+  TF_ASSERT_OK(rendez_->Recv(KeyFoo(), SlotArgs(7), &val, &is_dead));
+  EXPECT_EQ("foo", V(val));
+}
+
+TEST_F(LocalRendezvousTest, SlotMultiSends) {
+  // Only the first message goes through the slot, and the others must be
+  // received in order after it.
+  static const int N = 100;
+  const auto& key_foo = KeyFoo();
+  SchedClosure([=]() {
+    for (int i = 0; i < N; ++i) {
+      TF_ASSERT_OK(
+          rendez_->Send(key_foo, SlotArgs(1), V(strings::StrCat(i)), false));
+      RandomSleep();
+    }
+  });
+  Tensor val;
+  bool val_dead;
+  for (int i = 0; i < N; ++i) {
+    TF_ASSERT_OK(rendez_->Recv(key_foo, SlotArgs(1), &val, &val_dead));
+    EXPECT_EQ(strings::StrCat(i), V(val));
+    RandomSleep();
+  }
+}
+
+TEST_F(LocalRendezvousTest, SlotRandomSendRecv) {
+  static const int N = 100;
+  random::PhiloxRandom philox(testing::RandomSeed(), 17);
+  random::SimplePhilox rnd(&philox);
+  BlockingState state;
+  state.counter = N;
+  for (int i = 0; i < N; ++i) {
+    int micros = 100 + rnd.Uniform(1000);
+    SchedClosure([this, i, micros]() {
+      Env::Default()->SleepForMicroseconds(micros);
+      TF_ASSERT_OK(rendez_->Send(MakeKey(strings::StrCat(i)), SlotArgs(i + 1),
+                                 V(strings::StrCat(i)), false));
+    });
+    auto recv_done = [&state, i](const Status& status,
+                                 const Rendezvous::Args& sender_args,
+                                 const Rendezvous::Args& recver_args,
+                                 const Tensor& val, const bool val_dead) {
+      EXPECT_EQ(strings::StrCat(i), V(val));
+      bool done = false;
+      {
+        mutex_lock l(state.lock);
+        state.counter--;
+        if (state.counter == 0) {
+          done = true;
+        }
+      }
+      if (done) {
+        state.done.Notify();
+      }
+    };
+    micros = 100 + rnd.Uniform(1000);
+    SchedClosure([this, i, micros, recv_done]() {
+      Env::Default()->SleepForMicroseconds(micros);
+      rendez_->RecvAsync(MakeKey(strings::StrCat(i)), SlotArgs(i + 1),
+                         recv_done);
+    });
+  }
+
+  state.done.WaitForNotification();
+}
+
+TEST_F(LocalRendezvousTest, SlotCancelBeforeRecv) {
+  auto* cm = new CancellationManager();
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  Rendezvous::Args args = SlotArgs(1);
+  args.cancellation_manager = cm;
+  cm->StartCancel();
+  auto s = rendez_->Recv(KeyFoo(), args, &val, &is_dead);
+  EXPECT_TRUE(absl::IsCancelled(s));
+  EXPECT_EQ("RecvAsync is cancelled.", s.message());
+  delete cm;
+}
+
+TEST_F(LocalRendezvousTest, SlotCancelAfterRecv) {
+  auto* cm = new CancellationManager();
+  Notification n;
+  SchedClosure([cm, &n]() {
+    Env::Default()->SleepForMicroseconds(10000);
+    cm->StartCancel();
+    n.Notify();
+  });
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  Rendezvous::Args args = SlotArgs(1);
+  args.cancellation_manager = cm;
+  auto s = rendez_->Recv(KeyFoo(), args, &val, &is_dead);
+  EXPECT_TRUE(absl::IsCancelled(s));
+  n.WaitForNotification();
+  delete cm;
+
+  // The slot is used up, so a later message for the key uses the table.
+  TF_ASSERT_OK(rendez_->Send(KeyFoo(), SlotArgs(1), V("hello"), false));
+  TF_ASSERT_OK(rendez_->Recv(KeyFoo(), SlotArgs(1), &val, &is_dead));
+  EXPECT_EQ("hello", V(val));
+}
+
+TEST_F(LocalRendezvousTest, SlotRecvAbort) {
+  rendez_->Ref();
+  SchedClosure([this]() {
+    Env::Default()->SleepForMicroseconds(10000);
+    rendez_->StartAbort(errors::Aborted(""));  // abort
+    rendez_->Unref();
+  });
+  Tensor val(DT_STRING);
+  bool val_dead = false;
+  Status status = rendez_->Recv(KeyFoo(), SlotArgs(1), &val, &val_dead);
+  EXPECT_TRUE(absl::IsAborted(status));
+}
+
+TEST_F(LocalRendezvousTest, SlotSendAndDelete) {
+  Rendezvous* rendez = NewLocalRendezvous();
+  TF_ASSERT_OK(rendez->Send(KeyFoo(), SlotArgs(1), V("hello"), false));
+  // Frees the pending message.
+  rendez->Unref();
+}
+
 class DummyDeviceContext : public DeviceContext {
  public:
   explicit DummyDeviceContext(int stream_id) : stream_id_(stream_id) {}
@@ -478,6 +636,48 @@ void BM_RecvSend(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_RecvSend);
 
+// Sends `state.range(0)` tensors from as many threads to one receiver, with
+// a rendezvous slot per key if `state.range(1)` is true.
+void BM_FanIn(::testing::benchmark::State& state) {
+  const int num_keys = state.range(0);
+  const bool use_slots = state.range(1);
+  std::vector<Rendezvous::ParsedKey> keys;
+  for (int i = 0; i < num_keys; ++i) {
+    keys.push_back(MakeKey(strings::StrCat("key", i)));
+  }
+  thread::ThreadPool* pool = new thread::ThreadPool(Env::Default(), "test", 8);
+  Tensor orig = V("val");
+
+  for (auto s : state) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    BlockingCounter counter(num_keys);
+    for (int i = 0; i < num_keys; ++i) {
+      pool->Schedule([rendez, &keys, &orig, use_slots, i]() {
+        TF_CHECK_OK(rendez->Send(keys[i], SlotArgs(use_slots ? i + 1 : 0),
+                                 orig, false));
+      });
+      rendez->RecvAsync(
+          keys[i], SlotArgs(use_slots ? i + 1 : 0),
+          [&counter](const Status& status,
+                     const Rendezvous::Args& /*send_args*/,
+                     const Rendezvous::Args& /*recv_args*/,
+                     const Tensor& /*tensor*/, bool /*is_dead*/) {
+            TF_CHECK_OK(status);
+            counter.DecrementCount();
+          });
+    }
+    counter.Wait();
+    rendez->Unref();
+  }
+  state.SetItemsProcessed(num_keys * state.iterations());
+  delete pool;
+}
+BENCHMARK(BM_FanIn)
+    ->ArgPair(100, false)
+    ->ArgPair(100, true)
+    ->ArgPair(1000, false)
+    ->ArgPair(1000, true);
+
 void BM_PingPong(::testing::benchmark::State& state) {
   const int messages_count = state.range(0);
   auto* cm = new CancellationManager();
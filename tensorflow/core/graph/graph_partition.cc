@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/graph/graph_partition.h"
 
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <queue>
@@ -322,6 +323,12 @@ NodeDef* AddRecv(const PartitionOptions& opts, const GraphInfo& g_info,
   }
 }
 
+// Returns a process-wide unique, positive rendezvous slot id.
+int64_t NewRendezvousSlot() {
+  static std::atomic<int64_t>* next_slot = new std::atomic<int64_t>(1);
+  return next_slot->fetch_add(1, std::memory_order_relaxed);
+}
+
 NodeDef* AddDummyConst(const PartitionOptions& opts, GraphDef* gdef,
                        const Edge* edge, Status* status) {
   const Node* src = edge->src();
@@ -1159,6 +1166,16 @@ Status Partition(const PartitionOptions& opts, Graph* g,
                               tensor_name_attr, &status);
       if (!status.ok()) return status;
 
+      // Only pairs within one address space meet in the same local
+      // rendezvous.
+      if (opts.assign_rendezvous_slots &&
+          DeviceNameUtils::IsSameAddressSpace(
+              src->assigned_device_name(), dst->assigned_device_name())) {
+        const int64_t slot = NewRendezvousSlot();
+        AddNodeAttr("_rendezvous_slot", slot, send);
+        AddNodeAttr("_rendezvous_slot", slot, real_recv);
+      }
+
       // Fix up the control flow edge.
       // NOTE(yuanbyu): 'real_recv' must be the real recv node.
       if (src_graph == dst_graph) {
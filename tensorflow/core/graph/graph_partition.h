@@ -80,6 +80,12 @@ struct PartitionOptions {
   // Optional customized function to compute the "tensor_name" attr value of
   // Send/Recv ops inserted during partitioning.
   std::function<string(const Edge*)> get_tensor_name_attr = nullptr;
+
+  // If true, each Send/Recv pair between devices in the same address space
+  // gets a process-wide unique "_rendezvous_slot" attr, with which the pair
+  // meets in a dedicated slot of the local rendezvous instead of its hash
+  // table.
+  bool assign_rendezvous_slots = false;
 };
 
 // Partition "input" graph into a set of graphs, one per location.
@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/graph/graph_partition.h"
 
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -83,7 +85,8 @@ string DeviceName(const Node* node) {
 }
 
 void Partition(const GraphDef& graph_def,
-               std::unordered_map<string, GraphDef>* partitions) {
+               std::unordered_map<string, GraphDef>* partitions,
+               bool assign_rendezvous_slots = false) {
   Graph g(OpRegistry::Global());
   GraphConstructorOptions opts;
   TF_CHECK_OK(ConvertGraphDefToGraph(opts, graph_def, &g));
@@ -103,6 +106,7 @@ void Partition(const GraphDef& graph_def,
   popts.get_incarnation = [](const string& name) {
     return (name[0] - 'A') + 100;
   };
+  popts.assign_rendezvous_slots = assign_rendezvous_slots;
   Status s = Partition(popts, &g, partitions);
   CHECK(s.ok()) << s;
 
@@ -563,6 +567,35 @@ TEST_F(GraphPartitionTest, SetIncarnation) {
   }
 }
 
+TEST_F(GraphPartitionTest, AssignRendezvousSlots) {
+  Output a1 = FloatInput(in_.WithOpName("A1"));
+  Output c1 = FloatInput(
+      in_.WithOpName("C1").WithDevice("/job:b/replica:0/task:0/cpu:0"));
+  Combine(in_.WithOpName("B2"), a1, c1);
+  Partition(ToGraphDef(), &partitions_, /*assign_rendezvous_slots=*/true);
+  EXPECT_EQ(3, partitions_.size());
+
+  // The slots of the Sends and Recvs, by their source node.
+  std::map<string, std::vector<int64_t>> slots;
+  for (const auto& kv : partitions_) {
+    for (const NodeDef& ndef : kv.second.node()) {
+      if (ndef.op() != "_Send" && ndef.op() != "_Recv") continue;
+      string src;
+      TF_ASSERT_OK(GetNodeAttr(ndef, "_src", &src));
+      int64_t slot = 0;
+      if (GetNodeAttr(ndef, "_rendezvous_slot", &slot).ok()) {
+        slots[src].push_back(slot);
+      }
+    }
+  }
+  // Only the pair within task 0 of job "a" gets a slot, the same on both
+  // sides.
+  EXPECT_EQ(slots.count("C1"), 0);
+  ASSERT_EQ(slots["A1"].size(), 2);
+  EXPECT_GT(slots["A1"][0], 0);
+  EXPECT_EQ(slots["A1"][0], slots["A1"][1]);
+}
+
 TEST_F(GraphPartitionTest, GraphDebugInfo) {
   GraphDef graph_def;
   Output a1 = FloatInput(in_.WithOpName("A1"));
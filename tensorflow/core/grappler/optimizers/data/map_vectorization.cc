@@ -0,0 +1,422 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kBatchDataset[] = "BatchDataset";
+constexpr char kBatchDatasetV2[] = "BatchDatasetV2";
+constexpr char kMapDataset[] = "MapDataset";
+constexpr char kParallelMapDataset[] = "ParallelMapDataset";
+constexpr char kParallelMapDatasetV2[] = "ParallelMapDatasetV2";
+constexpr char kParseExampleV2[] = "ParseExampleV2";
+constexpr char kOutputShapes[] = "output_shapes";
+constexpr char kOutputTypes[] = "output_types";
+
+bool IsBatch(const NodeDef& node) {
+  return node.op() == kBatchDataset || node.op() == kBatchDatasetV2;
+}
+
+bool IsMap(const NodeDef& node) {
+  return node.op() == kMapDataset || node.op() == kParallelMapDataset ||
+         node.op() == kParallelMapDatasetV2;
+}
+
+// Returns true if `node` runs an element-wise op which broadcasts its inputs.
+// Ops which can fail on some elements, such as integer division, are excluded:
+// once vectorized, the failure of one element would fail the whole batch.
+// Placeholder attrs of `node` are resolved with `function_attrs`.
+bool IsVectorizableOp(
+    const NodeDef& node,
+    const protobuf::Map<string, AttrValue>& function_attrs) {
+  static const auto* const kVectorizableOps = new absl::flat_hash_set<string>(
+      {"Abs", "Add", "AddV2", "Cast", "Ceil", "Cos", "Equal", "Erf", "Exp",
+       "Expm1", "Floor", "Greater", "GreaterEqual", "Identity", "IsFinite",
+       "IsInf", "IsNan", "Less", "LessEqual", "Log", "Log1p", "LogicalAnd",
+       "LogicalNot", "LogicalOr", "Maximum", "Minimum", "Mul", "Neg",
+       "NotEqual", "Relu", "Relu6", "Rint", "Round", "Rsqrt", "SelectV2",
+       "Sigmoid", "Sign", "Sin", "Softplus", "Sqrt", "Square",
+       "SquaredDifference", "Sub", "Tan", "Tanh"});
+  if (kVectorizableOps->contains(node.op())) {
+    return true;
+  }
+  if (node.op() != "RealDiv") {
+    return false;
+  }
+  // Integer division fails on division by zero.
+  const AttrValue* type = gtl::FindOrNull(node.attr(), "T");
+  if (type != nullptr && !type->placeholder().empty()) {
+    type = gtl::FindOrNull(function_attrs, type->placeholder());
+  }
+  return type != nullptr && type->value_case() == AttrValue::kType &&
+         (DataTypeIsFloating(type->type()) || DataTypeIsComplex(type->type()));
+}
+
+// A value computed by a function which is applied to a batch of elements.
+struct VectorizedValue {
+  // Whether the value has a leading batch dimension.
+  bool batched;
+  // Shape of the value, excluding the batch dimension.
+  std::vector<int64_t> dims;
+};
+
+// Returns true if `node`, a ParseExampleV2 node whose inputs have the values
+// `inputs`, parses a single serialized example per element into dense features
+// of fully defined shapes, and adds the values of these features to `values`.
+// Parsing the batch of examples then computes the batch of the features of each
+// example, in a single pass which writes them into the batched outputs.
+bool VectorizeParseExample(
+    const NodeDef& node, const std::vector<const VectorizedValue*>& inputs,
+    absl::flat_hash_map<string, VectorizedValue>* values) {
+  const AttrValue* num_sparse = gtl::FindOrNull(node.attr(), "num_sparse");
+  const AttrValue* ragged_value_types =
+      gtl::FindOrNull(node.attr(), "ragged_value_types");
+  const AttrValue* dense_shapes = gtl::FindOrNull(node.attr(), "dense_shapes");
+  if (num_sparse == nullptr || num_sparse->value_case() != AttrValue::kI ||
+      num_sparse->i() != 0 || ragged_value_types == nullptr ||
+      !ragged_value_types->placeholder().empty() ||
+      ragged_value_types->list().type_size() != 0 || dense_shapes == nullptr ||
+      !dense_shapes->placeholder().empty()) {
+    return false;
+  }
+  // The inputs are the serialized examples, their names, the keys of the
+  // features, and the defaults of the dense features. Only the examples are
+  // batched, and the names must be empty.
+  if (inputs.size() < 5 || !inputs[0]->batched || !inputs[0]->dims.empty() ||
+      inputs[1]->batched || inputs[1]->dims != std::vector<int64_t>{0}) {
+    return false;
+  }
+  for (size_t i = 2; i < inputs.size(); ++i) {
+    if (inputs[i]->batched) {
+      return false;
+    }
+  }
+  for (int i = 0; i < dense_shapes->list().shape_size(); ++i) {
+    const TensorShapeProto& shape = dense_shapes->list().shape(i);
+    if (shape.unknown_rank()) {
+      return false;
+    }
+    VectorizedValue value = {/*batched=*/true, /*dims=*/{}};
+    for (const TensorShapeProto::Dim& dim : shape.dim()) {
+      if (dim.size() < 0) {
+        return false;
+      }
+      value.dims.push_back(dim.size());
+    }
+    (*values)[absl::StrCat(node.name(), ":dense_values:", i)] =
+        std::move(value);
+  }
+  return true;
+}
+
+// Returns the shapes of the components of the elements produced by `node`, or
+// an empty vector if any of them is not fully defined.
+std::vector<std::vector<int64_t>> GetComponentShapes(const NodeDef& node) {
+  std::vector<std::vector<int64_t>> component_shapes;
+  const AttrValue* shapes = gtl::FindOrNull(node.attr(), kOutputShapes);
+  if (shapes == nullptr) {
+    return {};
+  }
+  for (const TensorShapeProto& shape : shapes->list().shape()) {
+    if (shape.unknown_rank()) {
+      return {};
+    }
+    std::vector<int64_t>& dims = component_shapes.emplace_back();
+    for (const TensorShapeProto::Dim& dim : shape.dim()) {
+      if (dim.size() < 0) {
+        return {};
+      }
+      dims.push_back(dim.size());
+    }
+  }
+  return component_shapes;
+}
+
+// Broadcasts `dims` and `*broadcast_dims` into `*broadcast_dims`. Returns false
+// if they are incompatible.
+bool Broadcast(const std::vector<int64_t>& dims,
+               std::vector<int64_t>* broadcast_dims) {
+  if (dims.size() > broadcast_dims->size()) {
+    broadcast_dims->insert(broadcast_dims->begin(),
+                           dims.size() - broadcast_dims->size(), 1);
+  }
+  const size_t offset = broadcast_dims->size() - dims.size();
+  for (size_t i = 0; i < dims.size(); ++i) {
+    int64_t& broadcast_dim = (*broadcast_dims)[offset + i];
+    if (broadcast_dim == 1) {
+      broadcast_dim = dims[i];
+    } else if (dims[i] != 1 && dims[i] != broadcast_dim) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns true if applying `function`, instantiated with `function_attrs`, to
+// a batch of elements, whose components have the given fully defined
+// `shapes`, computes the batch of the results of `function` applied to each
+// element.
+//
+// This holds if every node of `function` is an element-wise op, its batched
+// inputs have the same shape, and its other inputs broadcast to that shape:
+// broadcasting then aligns the inputs of every element in the batch the same
+// way as for a single element. Nodes which parse an example per element into
+// dense features also batch, see `VectorizeParseExample()`.
+bool IsVectorizable(const FunctionDef& function,
+                    const protobuf::Map<string, AttrValue>& function_attrs,
+                    const std::vector<std::vector<int64_t>>& shapes) {
+  const OpDef& signature = function.signature();
+  if (signature.is_stateful() ||
+      signature.input_arg_size() != static_cast<int>(shapes.size())) {
+    return false;
+  }
+  absl::flat_hash_map<string, VectorizedValue> values;
+  for (int i = 0; i < signature.input_arg_size(); ++i) {
+    const OpDef::ArgDef& arg = signature.input_arg(i);
+    if (!arg.number_attr().empty() || !arg.type_list_attr().empty()) {
+      return false;
+    }
+    values[arg.name()] = {/*batched=*/true, shapes[i]};
+  }
+  // Function inputs are either argument names, or "node:output:index". The
+  // outputs of a node have the same value, unless they are keyed separately.
+  auto find_value = [&values](const string& input) -> const VectorizedValue* {
+    const VectorizedValue* value = gtl::FindOrNull(values, input);
+    if (value != nullptr) {
+      return value;
+    }
+    return gtl::FindOrNull(values, input.substr(0, input.find(':')));
+  };
+
+  // Nodes of a function are not sorted, so they are visited until the values
+  // of all their inputs are known.
+  std::vector<const NodeDef*> pending;
+  for (const NodeDef& node : function.node_def()) {
+    pending.push_back(&node);
+  }
+  while (!pending.empty()) {
+    std::vector<const NodeDef*> next_pending;
+    for (const NodeDef* node : pending) {
+      if (node->op() == "Const") {
+        const AttrValue* value = gtl::FindOrNull(node->attr(), "value");
+        if (value == nullptr || value->tensor().tensor_shape().unknown_rank()) {
+          return false;
+        }
+        VectorizedValue& const_value = values[node->name()];
+        const_value.batched = false;
+        for (const TensorShapeProto::Dim& dim :
+             value->tensor().tensor_shape().dim()) {
+          const_value.dims.push_back(dim.size());
+        }
+        continue;
+      }
+      const bool is_parse_example = node->op() == kParseExampleV2;
+      if (!is_parse_example && !IsVectorizableOp(*node, function_attrs)) {
+        return false;
+      }
+      std::vector<const VectorizedValue*> inputs;
+      bool ready = true;
+      for (const string& input : node->input()) {
+        if (IsControlInput(input)) {
+          return false;
+        }
+        const VectorizedValue* value = find_value(input);
+        if (value == nullptr) {
+          ready = false;
+          break;
+        }
+        inputs.push_back(value);
+      }
+      if (!ready) {
+        next_pending.push_back(node);
+        continue;
+      }
+      if (is_parse_example) {
+        if (!VectorizeParseExample(*node, inputs, &values)) {
+          return false;
+        }
+        continue;
+      }
+      const std::vector<int64_t>* batched_dims = nullptr;
+      std::vector<int64_t> unbatched_dims;
+      for (const VectorizedValue* value : inputs) {
+        if (!value->batched) {
+          if (!Broadcast(value->dims, &unbatched_dims)) {
+            return false;
+          }
+        } else if (batched_dims == nullptr) {
+          batched_dims = &value->dims;
+        } else if (*batched_dims != value->dims) {
+          return false;
+        }
+      }
+      if (batched_dims == nullptr) {
+        values[node->name()] = {/*batched=*/false, std::move(unbatched_dims)};
+        continue;
+      }
+      std::vector<int64_t> dims = *batched_dims;
+      if (!Broadcast(unbatched_dims, &dims) || dims != *batched_dims) {
+        return false;
+      }
+      values[node->name()] = {/*batched=*/true, std::move(dims)};
+    }
+    if (next_pending.size() == pending.size()) {
+      // The remaining nodes depend on values which are never computed.
+      return false;
+    }
+    pending = std::move(next_pending);
+  }
+
+  for (const OpDef::ArgDef& output_arg : signature.output_arg()) {
+    const string* ret = gtl::FindOrNull(function.ret(), output_arg.name());
+    if (ret == nullptr) {
+      return false;
+    }
+    const VectorizedValue* value = find_value(*ret);
+    if (value == nullptr || !value->batched) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns a batch node which batches the input of `map_node` instead of its
+// output. The shapes of its elements are the shapes of the elements of
+// `map_input`, with the batch dimension of `batch_node`.
+NodeDef MakeBatchNode(const NodeDef& batch_node, const NodeDef& map_node,
+                      const NodeDef& map_input, MutableGraphView* graph) {
+  NodeDef new_batch = batch_node;
+  graph_utils::SetUniqueGraphNodeName(batch_node.op(), graph->graph(),
+                                      &new_batch);
+  new_batch.set_input(0, map_node.input(0));
+  graph_utils::CopyAttribute(kOutputTypes, map_input, &new_batch);
+
+  const auto& batched_shapes = batch_node.attr().at(kOutputShapes).list();
+  const auto& element_shapes = map_input.attr().at(kOutputShapes).list();
+  AttrValue output_shapes;
+  for (int i = 0; i < element_shapes.shape_size(); ++i) {
+    TensorShapeProto* shape = output_shapes.mutable_list()->add_shape();
+    // Batches of unknown size have an unknown batch dimension.
+    TensorShapeProto::Dim* batch_dim = shape->add_dim();
+    batch_dim->set_size(-1);
+    if (i < batched_shapes.shape_size() &&
+        batched_shapes.shape(i).dim_size() > 0) {
+      *batch_dim = batched_shapes.shape(i).dim(0);
+    }
+    for (const auto& dim : element_shapes.shape(i).dim()) {
+      *shape->add_dim() = dim;
+    }
+  }
+  (*new_batch.mutable_attr())[kOutputShapes] = std::move(output_shapes);
+  return new_batch;
+}
+
+// Returns a map node which applies the function of `map_node` to the batches
+// produced by `new_batch_node`.
+NodeDef MakeMapNode(const NodeDef& map_node, const NodeDef& batch_node,
+                    const NodeDef& new_batch_node, MutableGraphView* graph) {
+  NodeDef new_map = map_node;
+  graph_utils::SetUniqueGraphNodeName(map_node.op(), graph->graph(), &new_map);
+  new_map.set_input(0, new_batch_node.name());
+  graph_utils::CopyShapesAndTypesAttrs(batch_node, &new_map);
+  return new_map;
+}
+
+}  // namespace
+
+Status MapVectorization::OptimizeAndCollectStats(Cluster* cluster,
+                                                 const GrapplerItem& item,
+                                                 GraphDef* output,
+                                                 OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+
+  for (const NodeDef& node : item.graph.node()) {
+    if (!IsBatch(node)) {
+      continue;
+    }
+    const NodeDef& batch_node = node;
+    NodeDef* map_node = graph_utils::GetInputNode(batch_node, graph);
+    if (map_node == nullptr || !IsMap(*map_node)) {
+      continue;
+    }
+    // The output of the map must not be consumed by other nodes, and the map
+    // function must not have captured inputs, which would not be batched.
+    if (graph.GetFanouts(*map_node, /*include_controlled_nodes=*/true)
+                .size() != 1 ||
+        map_node->attr().at("Targuments").list().type_size() > 0 ||
+        !batch_node.attr().contains(kOutputShapes)) {
+      continue;
+    }
+    NodeDef* map_input = graph_utils::GetInputNode(*map_node, graph);
+    if (map_input == nullptr || !map_input->attr().contains(kOutputTypes)) {
+      continue;
+    }
+    const std::vector<std::vector<int64_t>> shapes =
+        GetComponentShapes(*map_input);
+    const NameAttrList& map_function = map_node->attr().at("f").func();
+    const FunctionDef* function = function_library.Find(map_function.name());
+    if (shapes.empty() || function == nullptr ||
+        !IsVectorizable(*function, map_function.attr(), shapes)) {
+      continue;
+    }
+
+    NodeDef* new_batch_node = graph.AddNode(
+        MakeBatchNode(batch_node, *map_node, *map_input, &graph));
+    NodeDef* new_map_node = graph.AddNode(
+        MakeMapNode(*map_node, batch_node, *new_batch_node, &graph));
+    TF_RETURN_IF_ERROR(
+        graph.UpdateFanouts(batch_node.name(), new_map_node->name()));
+
+    nodes_to_delete.insert(map_node->name());
+    nodes_to_delete.insert(batch_node.name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapVectorization, "map_vectorization");
+
+}  // namespace grappler
+}  // namespace tensorflow
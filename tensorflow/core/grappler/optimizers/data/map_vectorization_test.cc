@@ -0,0 +1,342 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+// Returns a dataset node producing elements with components of `shapes`.
+NodeDef MakeSourceNode(StringPiece name,
+                       const std::vector<PartialTensorShape>& shapes) {
+  const std::vector<DataType> types(shapes.size(), DT_INT64);
+  return NDef(name, "TensorSliceDataset", {"tensors"},
+              {{"output_shapes", gtl::ArraySlice<PartialTensorShape>(shapes)},
+               {"output_types", gtl::ArraySlice<DataType>(types)}});
+}
+
+NodeDef MakeBatchNode(StringPiece name, StringPiece input_node_name,
+                      const std::vector<PartialTensorShape>& shapes) {
+  const std::vector<DataType> types(shapes.size(), DT_INT64);
+  return NDef(name, "BatchDatasetV2",
+              {string(input_node_name), "batch_size", "drop_remainder"},
+              {{"parallel_copy", false},
+               {"output_shapes", gtl::ArraySlice<PartialTensorShape>(shapes)},
+               {"output_types", gtl::ArraySlice<DataType>(types)}});
+}
+
+// Returns a function named `name` which divides its input, of type `type`, by
+// two.
+FunctionDef XDivTwo(const string& name, DataType type) {
+  return FunctionDefHelper::Define(
+      name, {absl::StrCat("x: ", DataTypeString(type))},
+      {absl::StrCat("y: ", DataTypeString(type))}, {},
+      {{{"two"}, "Const", {}, {{"value", test::AsScalar<int64_t>(2)},
+                               {"dtype", DT_INT64}}},
+       {{"scale"}, "Cast", {"two"}, {{"SrcT", DT_INT64}, {"DstT", type}}},
+       {{"y"}, "RealDiv", {"x", "scale"}, {{"T", type}}}});
+}
+
+// Returns a function named `name` which parses a serialized example into
+// int64 dense features of `dense_shapes`, and `num_sparse` sparse features,
+// and returns the dense features.
+FunctionDef ParseExample(const string& name,
+                         const std::vector<PartialTensorShape>& dense_shapes,
+                         int64_t num_sparse) {
+  const int num_dense = dense_shapes.size();
+  std::vector<string> out_def;
+  std::vector<std::pair<string, string>> ret_def;
+  std::vector<string> parse_inputs = {
+      "serialized", "names:output:0", "sparse_keys:output:0",
+      "dense_keys:output:0", "ragged_keys:output:0"};
+  std::vector<tstring> sparse_keys, dense_keys;
+  for (int i = 0; i < num_sparse; ++i) {
+    sparse_keys.push_back(absl::StrCat("sparse", i));
+  }
+  for (int i = 0; i < num_dense; ++i) {
+    dense_keys.push_back(absl::StrCat("dense", i));
+    out_def.push_back(absl::StrCat("y", i, ": int64"));
+    ret_def.emplace_back(absl::StrCat("y", i),
+                         absl::StrCat("parse:dense_values:", i));
+    parse_inputs.push_back("default:output:0");
+  }
+  const std::vector<DataType> sparse_types(num_sparse, DT_INT64);
+  const std::vector<DataType> dense_types(num_dense, DT_INT64);
+  return FunctionDefHelper::Create(
+      name, {"serialized: string"}, out_def, {},
+      {{{"names"},
+        "Const",
+        {},
+        {{"value", test::AsTensor<tstring>({}, TensorShape({0}))},
+         {"dtype", DT_STRING}}},
+       {{"sparse_keys"},
+        "Const",
+        {},
+        {{"value", test::AsTensor<tstring>(sparse_keys, {num_sparse})},
+         {"dtype", DT_STRING}}},
+       {{"dense_keys"},
+        "Const",
+        {},
+        {{"value", test::AsTensor<tstring>(dense_keys, {num_dense})},
+         {"dtype", DT_STRING}}},
+       {{"ragged_keys"},
+        "Const",
+        {},
+        {{"value", test::AsTensor<tstring>({}, TensorShape({0}))},
+         {"dtype", DT_STRING}}},
+       {{"default"},
+        "Const",
+        {},
+        {{"value", test::AsTensor<int64_t>({}, TensorShape({0}))},
+         {"dtype", DT_INT64}}},
+       {{"parse"},
+        "ParseExampleV2",
+        parse_inputs,
+        {{"Tdense", gtl::ArraySlice<DataType>(dense_types)},
+         {"num_sparse", num_sparse},
+         {"sparse_types", gtl::ArraySlice<DataType>(sparse_types)},
+         {"ragged_value_types", DataTypeSlice()},
+         {"ragged_split_types", DataTypeSlice()},
+         {"dense_shapes", gtl::ArraySlice<PartialTensorShape>(dense_shapes)}}}},
+      ret_def);
+}
+
+GrapplerItem MakePipeline(const std::vector<PartialTensorShape>& shapes,
+                          StringPiece function_name) {
+  std::vector<PartialTensorShape> batched_shapes;
+  for (const PartialTensorShape& shape : shapes) {
+    batched_shapes.push_back(PartialTensorShape({5}).Concatenate(shape));
+  }
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("tensors", "Const", {}, {{"value", 0}, {"dtype", DT_INT64}}),
+       NDef("batch_size", "Const", {}, {{"value", 5}, {"dtype", DT_INT64}}),
+       NDef("drop_remainder", "Const", {},
+            {{"value", true}, {"dtype", DT_BOOL}}),
+       MakeSourceNode("source", shapes),
+       graph_tests_utils::MakeMapNode("map", "source", function_name),
+       MakeBatchNode("batch", "map", batched_shapes),
+       NDef("Sink", "Identity", {"batch"}, {})},
+      // FunctionLib
+      {
+          test::function::XTimesTwo(),
+          test::function::XAddY(),
+          test::function::RandomUniform(),
+          test::function::Unique(),
+          XDivTwo("XDivTwoFloat", DT_FLOAT),
+          XDivTwo("XDivTwoInt64", DT_INT64),
+          ParseExample("ParseDense",
+                       {PartialTensorShape({}), PartialTensorShape({2, 3})},
+                       /*num_sparse=*/0),
+          ParseExample("ParseVarLenDense", {PartialTensorShape({-1})},
+                       /*num_sparse=*/0),
+          ParseExample("ParseSparse", {PartialTensorShape({3})},
+                       /*num_sparse=*/1),
+      });
+  item.fetch.push_back("Sink");
+  return item;
+}
+
+TEST(MapVectorizationTest, VectorizeElementwiseFunction) {
+  GrapplerItem item = MakePipeline({PartialTensorShape({3})}, "XTimesTwo");
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("batch", output));
+  const NodeDef& new_batch = output.node(
+      graph_utils::FindGraphNodeWithOp("BatchDatasetV2", output));
+  const NodeDef& new_map =
+      output.node(graph_utils::FindGraphNodeWithOp("MapDataset", output));
+  const NodeDef& sink =
+      output.node(graph_utils::FindGraphNodeWithName("Sink", output));
+  EXPECT_EQ(new_batch.input(0), "source");
+  EXPECT_EQ(new_batch.input(1), "batch_size");
+  EXPECT_EQ(new_batch.input(2), "drop_remainder");
+  EXPECT_EQ(new_map.input(0), new_batch.name());
+  EXPECT_EQ(sink.input(0), new_map.name());
+
+  // The new batch node batches the elements of the source, and the new map
+  // node produces the batches of the original batch node.
+  const NodeDef& batch =
+      item.graph.node(graph_utils::FindGraphNodeWithName("batch", item.graph));
+  AttrValue expected_batch_shapes;
+  SetAttrValue(
+      gtl::ArraySlice<PartialTensorShape>({PartialTensorShape({5, 3})}),
+      &expected_batch_shapes);
+  EXPECT_TRUE(AreAttrValuesEqual(new_batch.attr().at("output_shapes"),
+                                 expected_batch_shapes));
+  EXPECT_TRUE(AreAttrValuesEqual(new_map.attr().at("output_shapes"),
+                                 batch.attr().at("output_shapes")));
+  EXPECT_TRUE(AreAttrValuesEqual(new_map.attr().at("output_types"),
+                                 batch.attr().at("output_types")));
+  EXPECT_EQ(new_map.attr().at("f").func().name(), "XTimesTwo");
+}
+
+class ComponentShapesTest
+    : public ::testing::TestWithParam<
+          std::tuple<std::vector<PartialTensorShape>, bool>> {};
+
+TEST_P(ComponentShapesTest, MapVectorizationTest) {
+  const std::vector<PartialTensorShape> shapes = std::get<0>(GetParam());
+  const bool vectorized = std::get<1>(GetParam());
+  GrapplerItem item = MakePipeline(shapes, "XAddY");
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(graph_utils::ContainsGraphNodeWithName("map", output),
+            !vectorized);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Test, ComponentShapesTest,
+    ::testing::Values(
+        std::make_tuple(
+            std::vector<PartialTensorShape>{PartialTensorShape({}),
+                                            PartialTensorShape({})},
+            true),
+        std::make_tuple(
+            std::vector<PartialTensorShape>{PartialTensorShape({2, 4}),
+                                            PartialTensorShape({2, 4})},
+            true),
+        // Elements whose shapes differ may not be batched before the map.
+        std::make_tuple(
+            std::vector<PartialTensorShape>{PartialTensorShape({2, -1}),
+                                            PartialTensorShape({2, 4})},
+            false),
+        std::make_tuple(
+            std::vector<PartialTensorShape>{PartialTensorShape({2, 1}),
+                                            PartialTensorShape({1, 4})},
+            false),
+        // Adding a scalar to a vector broadcasts differently once batched.
+        std::make_tuple(
+            std::vector<PartialTensorShape>{PartialTensorShape({}),
+                                            PartialTensorShape({4})},
+            false),
+        std::make_tuple(
+            std::vector<PartialTensorShape>{PartialTensorShape(),
+                                            PartialTensorShape()},
+            false)));
+
+class NonVectorizableFunctionTest : public ::testing::TestWithParam<string> {};
+
+TEST_P(NonVectorizableFunctionTest, MapVectorizationTest) {
+  GrapplerItem item = MakePipeline({PartialTensorShape({})}, GetParam());
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+INSTANTIATE_TEST_SUITE_P(Test, NonVectorizableFunctionTest,
+                         ::testing::Values("RandomUniformFn", "GetUnique"));
+
+TEST(MapVectorizationTest, FloatingPointDivision) {
+  GrapplerItem item = MakePipeline({PartialTensorShape({})}, "XDivTwoFloat");
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+}
+
+// Integer division by zero fails, which would fail the whole batch.
+TEST(MapVectorizationTest, IntegerDivision) {
+  GrapplerItem item = MakePipeline({PartialTensorShape({})}, "XDivTwoInt64");
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+}
+
+// Parsing a batch of examples into dense features writes the features straight
+// into the batches.
+TEST(MapVectorizationTest, ParseExampleIntoDenseFeatures) {
+  GrapplerItem item = MakePipeline({PartialTensorShape({})}, "ParseDense");
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("batch", output));
+  const NodeDef& new_batch = output.node(
+      graph_utils::FindGraphNodeWithOp("BatchDatasetV2", output));
+  const NodeDef& new_map =
+      output.node(graph_utils::FindGraphNodeWithOp("MapDataset", output));
+  EXPECT_EQ(new_batch.input(0), "source");
+  EXPECT_EQ(new_map.input(0), new_batch.name());
+  EXPECT_EQ(new_map.attr().at("f").func().name(), "ParseDense");
+}
+
+class NonVectorizableParseExampleTest
+    : public ::testing::TestWithParam<string> {};
+
+TEST_P(NonVectorizableParseExampleTest, MapVectorizationTest) {
+  GrapplerItem item = MakePipeline({PartialTensorShape({})}, GetParam());
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+// Variable-length dense features are padded to the longest example of the
+// batch, and sparse features are not batched the same way as their examples.
+INSTANTIATE_TEST_SUITE_P(Test, NonVectorizableParseExampleTest,
+                         ::testing::Values("ParseVarLenDense", "ParseSparse"));
+
+// Examples which are not scalars would be parsed as a batch of batches.
+TEST(MapVectorizationTest, ParseExampleOfVector) {
+  GrapplerItem item = MakePipeline({PartialTensorShape({2})}, "ParseDense");
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+}
+
+TEST(MapVectorizationTest, MapWithOtherConsumers) {
+  GrapplerItem item = MakePipeline({PartialTensorShape({})}, "XTimesTwo");
+  *item.graph.add_node() = NDef("Sink2", "Identity", {"map"}, {});
+  item.fetch.push_back("Sink2");
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
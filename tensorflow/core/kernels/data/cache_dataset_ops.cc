@@ -22,8 +22,10 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/data/tfdataz_metrics.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
@@ -35,6 +37,8 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
@@ -50,6 +54,8 @@ namespace data {
 /* static */ constexpr const char* const CacheDatasetOp::kFileName;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputTypes;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const CacheDatasetOp::kMemoryBudget;
+/* static */ constexpr const char* const CacheDatasetOp::kSpillDirectory;
 
 namespace {
 
@@ -68,12 +74,61 @@ constexpr char kCacheCompleted[] = "cache_completed";
 constexpr char kIndex[] = "index";
 constexpr char kImpl[] = "Impl";
 constexpr char kCacheDataset[] = "CacheDataset";
+constexpr char kBoundedMemoryDatasetPrefix[] = "BoundedMemory";
+constexpr char kCacheSize[] = "cache_size";
+constexpr char kNumComponents[] = "num_components";
+constexpr char kComponent[] = "component";
+constexpr char kSpillFilePrefix[] = "tf_data_cache_";
+constexpr char kSpillFileSuffix[] = ".spill";
 constexpr char kIncompleteCacheErrorMessage[] =
     "The calling iterator did not fully read the dataset being cached. In "
     "order to avoid unexpected truncation of the dataset, the partially cached "
     "contents of the dataset  will be discarded. This can happen if you have "
     "an input pipeline similar to `dataset.cache().take(k).repeat()`. You "
     "should use `dataset.take(k).cache().repeat()` instead.";
+// Writes the first `num_elements` elements of `cache` to the checkpoint one at
+// a time, so that spilled elements are never all decompressed at once.
+Status WriteBoundedCacheToCheckpoint(IteratorStateWriter* writer,
+                                     const std::string& key_prefix,
+                                     int64_t num_elements,
+                                     BoundedMemoryCache* cache) {
+  TF_RETURN_IF_ERROR(writer->WriteScalar(key_prefix, kCacheSize, num_elements));
+  for (int64_t i = 0; i < num_elements; ++i) {
+    std::vector<Tensor> element;
+    TF_RETURN_IF_ERROR(cache->Get(i, &element));
+    std::string element_prefix = absl::StrCat(key_prefix, "::", i);
+    TF_RETURN_IF_ERROR(
+        writer->WriteScalar(element_prefix, kNumComponents, element.size()));
+    for (int j = 0; j < element.size(); ++j) {
+      TF_RETURN_IF_ERROR(writer->WriteTensor(
+          element_prefix, absl::StrCat(kComponent, "[", j, "]"), element[j]));
+    }
+  }
+  return OkStatus();
+}
+
+// Appends the elements written by `WriteBoundedCacheToCheckpoint` to `cache`.
+Status ReadBoundedCacheFromCheckpoint(IteratorContext* ctx,
+                                      IteratorStateReader* reader,
+                                      const std::string& key_prefix,
+                                      BoundedMemoryCache* cache) {
+  int64_t num_elements;
+  TF_RETURN_IF_ERROR(reader->ReadScalar(key_prefix, kCacheSize, &num_elements));
+  for (int64_t i = 0; i < num_elements; ++i) {
+    std::string element_prefix = absl::StrCat(key_prefix, "::", i);
+    int64_t num_components;
+    TF_RETURN_IF_ERROR(
+        reader->ReadScalar(element_prefix, kNumComponents, &num_components));
+    std::vector<Tensor> element(num_components);
+    for (int j = 0; j < num_components; ++j) {
+      TF_RETURN_IF_ERROR(reader->ReadTensor(
+          ctx->flr(), element_prefix, absl::StrCat(kComponent, "[", j, "]"),
+          &element[j]));
+    }
+    TF_RETURN_IF_ERROR(cache->Append(element));
+  }
+  return OkStatus();
+}
 }  // namespace
 
 class PartialCache {
@@ -1112,9 +1167,320 @@ class CacheDatasetOp::MemoryDatasetV2
   ResourceMgr* const resource_mgr_;  // Not owned.
 };
 
+// This version of memory dataset bounds the memory used by its cache. Cached
+// elements are compressed, and once they exceed `memory_budget` bytes the
+// remaining elements are spilled to a file. The dataset owns the cache, which
+// is shared across different iterations of the `repeat` transformation.
+class CacheDatasetOp::BoundedMemoryDataset : public DatasetBase {
+ public:
+  BoundedMemoryDataset(OpKernelContext* ctx, const DatasetBase* input,
+                       int64_t memory_budget, std::string spill_directory,
+                       std::string spill_filename, std::string metrics_name,
+                       Tensor resource_handle)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        memory_budget_(memory_budget),
+        spill_directory_(std::move(spill_directory)),
+        metrics_(std::make_shared<TfDatazCacheMetricsCollector>(
+            std::move(metrics_name))),
+        cache_(std::make_shared<BoundedMemoryCache>(
+            ctx->env(), memory_budget, std::move(spill_filename), metrics_)),
+        resource_handle_(std::move(resource_handle)) {
+    input_->Ref();
+    TfDatazMetricsRegistry::RegisterCache(metrics_);
+  }
+
+  ~BoundedMemoryDataset() override {
+    TfDatazMetricsRegistry::DeregisterCache(metrics_);
+    input_->Unref();
+  }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    name_utils::IteratorPrefixParams params;
+    params.dataset_prefix = kBoundedMemoryDatasetPrefix;
+    return std::make_unique<BoundedMemoryIterator>(
+        BoundedMemoryIterator::Params{
+            this, name_utils::IteratorPrefix(kDatasetType, prefix, params)},
+        cache_.get());
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return input_->output_shapes();
+  }
+
+  string DebugString() const override {
+    name_utils::DatasetDebugStringParams params;
+    params.dataset_prefix = kBoundedMemoryDatasetPrefix;
+    return name_utils::DatasetDebugString(kDatasetType, params);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    return input_->Cardinality(options);
+  };
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return OkStatus();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_node));
+    Node* filename_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(tstring(""), &filename_node));
+    Node* resource_handle_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddTensor(resource_handle_, &resource_handle_node));
+    AttrValue memory_budget;
+    b->BuildAttrValue(memory_budget_, &memory_budget);
+    AttrValue spill_directory;
+    b->BuildAttrValue(spill_directory_, &spill_directory);
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {input_node, filename_node, resource_handle_node},
+        {{kMemoryBudget, memory_budget}, {kSpillDirectory, spill_directory}},
+        output));
+    return OkStatus();
+  }
+
+ private:
+  class BoundedMemoryIterator : public DatasetIterator<BoundedMemoryDataset> {
+   public:
+    explicit BoundedMemoryIterator(const Params& params,
+                                   BoundedMemoryCache* cache)
+        : DatasetIterator<BoundedMemoryDataset>(params), cache_(cache) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      return InitializeIterator(ctx);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      return iterator_->GetNext(ctx, out_tensors, end_of_sequence);
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args),
+                                       /*ratio=*/1);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      if (cache_->IsCompleted()) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kCacheCompleted, ""));
+        TF_RETURN_IF_ERROR(WriteBoundedCacheToCheckpoint(
+            writer, prefix(), cache_->size(), cache_));
+      }
+      return SaveInput(ctx, writer, iterator_);
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      iterator_.reset();
+      cache_->Reset();
+      if (reader->Contains(prefix(), kCacheCompleted)) {
+        TF_RETURN_IF_ERROR(
+            ReadBoundedCacheFromCheckpoint(ctx, reader, prefix(), cache_));
+        TF_RETURN_IF_ERROR(cache_->Complete());
+      }
+      TF_RETURN_IF_ERROR(InitializeIterator(ctx));
+      return RestoreInput(ctx, reader, iterator_);
+    }
+
+   private:
+    class WriterIterator : public DatasetIterator<BoundedMemoryDataset> {
+     public:
+      explicit WriterIterator(const Params& params, BoundedMemoryCache* cache)
+          : DatasetIterator<BoundedMemoryDataset>(params), cache_(cache) {}
+
+      ~WriterIterator() override {
+        mutex_lock l(mu_);
+        if (owns_cache_) {
+          if (cache_->size() > 0 && !cache_->IsCompleted()) {
+            LOG(WARNING) << kIncompleteCacheErrorMessage;
+            cache_->Reset();
+          }
+          cache_->ReleaseWriter();
+        }
+      }
+
+      Status Initialize(IteratorContext* ctx) override {
+        mutex_lock l(mu_);
+        // If another iterator is already populating the cache, this iterator
+        // produces the input elements without caching them.
+        owns_cache_ = cache_->AcquireWriter();
+        return dataset()->input_->MakeIterator(ctx, this, prefix(),
+                                               &input_impl_);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
+        if (!owns_cache_) {
+          return OkStatus();
+        }
+        if (*end_of_sequence) {
+          if (!cache_->IsCompleted()) {
+            VLOG(2) << "Finalizing the cache because EOF has been reached.";
+            TF_RETURN_IF_ERROR(cache_->Complete());
+          }
+          return OkStatus();
+        }
+        TF_RETURN_IF_ERROR(cache_->Append(*out_tensors));
+        if (cache_->size() == dataset()->input_->Cardinality()) {
+          VLOG(2) << "Finalizing the cache because its size matches the "
+                     "expected input cardinality.";
+          TF_RETURN_IF_ERROR(cache_->Complete());
+        }
+        return OkStatus();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args),
+                                         /*ratio=*/1);
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        if (owns_cache_ && !cache_->IsCompleted()) {
+          TF_RETURN_IF_ERROR(WriteBoundedCacheToCheckpoint(
+              writer, prefix(), cache_->size(), cache_));
+        }
+        return SaveInput(ctx, writer, input_impl_);
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        if (owns_cache_ && reader->Contains(prefix(), kCacheSize)) {
+          TF_RETURN_IF_ERROR(
+              ReadBoundedCacheFromCheckpoint(ctx, reader, prefix(), cache_));
+        }
+        return RestoreInput(ctx, reader, input_impl_);
+      }
+
+     private:
+      mutex mu_;
+      std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+      BoundedMemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
+      bool owns_cache_ TF_GUARDED_BY(mu_) = false;
+    };  // WriterIterator
+
+    class ReaderIterator : public DatasetIterator<BoundedMemoryDataset> {
+     public:
+      explicit ReaderIterator(const Params& params, BoundedMemoryCache* cache)
+          : DatasetIterator<BoundedMemoryDataset>(params), cache_(cache) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        if (index_ >= static_cast<int64_t>(cache_->size())) {
+          *end_of_sequence = true;
+          return OkStatus();
+        }
+        TF_RETURN_IF_ERROR(cache_->Get(index_, out_tensors));
+        index_++;
+        *end_of_sequence = false;
+        return OkStatus();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args),
+                                         /*ratio=*/1);
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kIndex, index_));
+        return OkStatus();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        // kIndex will not be set if we are restoring from a checkpoint
+        // written by a WriterIterator that has completed its cache.
+        index_ = cache_->size();
+        if (reader->Contains(prefix(), kIndex)) {
+          TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kIndex, &index_));
+        }
+        return OkStatus();
+      }
+
+     private:
+      mutex mu_;
+      BoundedMemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
+      int64_t index_ TF_GUARDED_BY(mu_) = 0;
+    };  // ReaderIterator
+
+    Status InitializeIterator(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (cache_->IsCompleted()) {
+        iterator_ = std::make_unique<ReaderIterator>(
+            ReaderIterator::Params{dataset(), strings::StrCat(prefix(), kImpl)},
+            cache_);
+      } else {
+        iterator_ = std::make_unique<WriterIterator>(
+            WriterIterator::Params{dataset(), strings::StrCat(prefix(), kImpl)},
+            cache_);
+      }
+      TF_RETURN_IF_ERROR(iterator_->InitializeBase(ctx, this));
+      return iterator_->Initialize(ctx);
+    }
+
+    mutex mu_;
+    BoundedMemoryCache* cache_ TF_GUARDED_BY(mu_);  // not owned.
+    std::unique_ptr<IteratorBase> iterator_ TF_GUARDED_BY(mu_);
+  };  // BoundedMemoryIterator
+
+  const DatasetBase* const input_;
+  const int64_t memory_budget_;
+  const std::string spill_directory_;
+  const std::shared_ptr<TfDatazCacheMetricsCollector> metrics_;
+  const std::shared_ptr<BoundedMemoryCache> cache_;
+  const Tensor resource_handle_;
+};  // BoundedMemoryDataset
+
 CacheDatasetOp::CacheDatasetOp(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {
+  if (ctx->HasAttr(kMemoryBudget)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kMemoryBudget, &memory_budget_));
+    OP_REQUIRES(ctx, memory_budget_ >= 0,
+                errors::InvalidArgument("`memory_budget` must be >= 0, got ",
+                                        memory_budget_));
+  }
+  if (ctx->HasAttr(kSpillDirectory)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kSpillDirectory, &spill_directory_));
+  }
+}
 
 void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                                  DatasetBase** output) {
@@ -1126,7 +1492,25 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
     const string& container = ctx->resource_manager()->default_container();
     auto name = strings::StrCat(ctx->op_kernel().name(), "/", kMemoryCache, "_",
                                 resource_id_counter.fetch_add(1));
-    if (op_version_ == 2) {
+    if (op_version_ == 2 && memory_budget_ > 0) {
+      std::string spill_directory = spill_directory_;
+      if (spill_directory.empty()) {
+        std::vector<std::string> temp_directories;
+        ctx->env()->GetLocalTempDirectories(&temp_directories);
+        OP_REQUIRES(ctx, !temp_directories.empty(),
+                    errors::FailedPrecondition(
+                        "No `spill_directory` was given and no local "
+                        "temporary directory is available."));
+        spill_directory = temp_directories.front();
+      }
+      std::string spill_filename = io::JoinPath(
+          spill_directory,
+          strings::StrCat(kSpillFilePrefix, random::New64(), kSpillFileSuffix));
+      *output = new BoundedMemoryDataset(ctx, input, memory_budget_,
+                                         spill_directory_,
+                                         std::move(spill_filename), name,
+                                         ctx->input(2));
+    } else if (op_version_ == 2) {
       bool owns_resource = false;
       MemoryCacheManager* manager = nullptr;
       auto handle = HandleFromInput(ctx, 2);
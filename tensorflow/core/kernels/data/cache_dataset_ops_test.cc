@@ -14,9 +14,12 @@ limitations under the License.
 #include <string>
 #include <utility>
 
+#include "absl/strings/match.h"
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/data/tfdataz_metrics.h"
+#include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/platform/path.h"
 
 namespace tensorflow {
@@ -69,6 +72,54 @@ class CacheDatasetParams : public DatasetParams {
   string filename_;
 };
 
+class BoundedMemoryCacheDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  BoundedMemoryCacheDatasetParams(T input_dataset_params, int64_t memory_budget,
+                                  string spill_directory,
+                                  DataTypeVector output_dtypes,
+                                  std::vector<PartialTensorShape> output_shapes,
+                                  string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        memory_budget_(memory_budget),
+        spill_directory_(std::move(spill_directory)) {
+    op_version_ = 2;
+    input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {CreateTensor<tstring>(TensorShape({}), {""}),
+            CreateTensor<ResourceHandle>(TensorShape({}), {ResourceHandle()})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {CacheDatasetOp::kInputDataset, CacheDatasetOp::kFileName,
+                    "cache"};
+    return OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{"output_types", output_dtypes_},
+                    {"output_shapes", output_shapes_},
+                    {"metadata", ""},
+                    {CacheDatasetOp::kMemoryBudget, memory_budget_},
+                    {CacheDatasetOp::kSpillDirectory, spill_directory_}};
+    return OkStatus();
+  }
+
+  string dataset_type() const override { return CacheDatasetOp::kDatasetType; }
+
+  const string& spill_directory() const { return spill_directory_; }
+
+ private:
+  int64_t memory_budget_;
+  string spill_directory_;
+};
+
 class CacheDatasetOpTest : public DatasetOpsTestBase {
  public:
   Status Initialize(const DatasetParams& dataset_params) {
@@ -370,6 +421,94 @@ INSTANTIATE_TEST_CASE_P(CacheDatasetOpTest,
                         ParameterizedIteratorSaveAndRestoreTest,
                         ::testing::ValuesIn(IteratorSaveAndRestoreTestCases()));
 
+// Caches data in memory under a budget that only fits the first element, so
+// that the remaining elements are spilled to a file in a new directory.
+BoundedMemoryCacheDatasetParams BoundedMemoryCacheDatasetParams1() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64_t>(TensorShape{3, 3, 1},
+                                            {0, 1, 2, 3, 4, 5, 6, 7, 8})},
+      /*node_name=*/"tensor_slice");
+  return BoundedMemoryCacheDatasetParams(
+      std::move(tensor_slice_dataset_params),
+      /*memory_budget=*/64,
+      /*spill_directory=*/
+      io::JoinPath(testing::TmpDir(),
+                   strings::StrCat("spill_", random::New64())),
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({3, 1})}, kNodeName);
+}
+
+// Returns the metrics of the bounded memory cache created by `kNodeName`.
+std::shared_ptr<TfDatazCacheMetricsCollector> GetCacheMetrics() {
+  for (const auto& collector :
+       TfDatazMetricsRegistry::GetCacheMetricCollectors()) {
+    if (absl::StartsWith(collector->name(), kNodeName)) {
+      return collector;
+    }
+  }
+  return nullptr;
+}
+
+TEST_F(CacheDatasetOpTest, BoundedMemoryGetNext) {
+  auto dataset_params = BoundedMemoryCacheDatasetParams1();
+  TF_ASSERT_OK(
+      Env::Default()->RecursivelyCreateDir(dataset_params.spill_directory()));
+  TF_ASSERT_OK(DatasetOpsTestBase::Initialize(dataset_params));
+  std::shared_ptr<TfDatazCacheMetricsCollector> metrics = GetCacheMetrics();
+  ASSERT_NE(metrics, nullptr);
+  auto expected_outputs = CreateTensors<int64_t>(
+      TensorShape({3, 1}), {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}});
+
+  // The first iterator populates the cache and the second reads from it.
+  for (int i = 0; i < 2; ++i) {
+    if (i > 0) {
+      TF_ASSERT_OK(dataset_->MakeIterator(iterator_ctx_.get(),
+                                          /*parent=*/nullptr,
+                                          dataset_params.iterator_prefix(),
+                                          &iterator_));
+    }
+    bool end_of_sequence = false;
+    std::vector<Tensor> out_tensors;
+    while (!end_of_sequence) {
+      std::vector<Tensor> next;
+      TF_EXPECT_OK(
+          iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+      out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+    }
+    TF_EXPECT_OK(ExpectEqual(out_tensors, expected_outputs,
+                             /*compare_order=*/true));
+
+    // Only the first element fits in memory, the others are in the spill file.
+    EXPECT_GT(metrics->GetMemoryBytes(), 0);
+    EXPECT_LE(metrics->GetMemoryBytes(), 64);
+    EXPECT_GT(metrics->GetSpilledBytes(), 0);
+    std::vector<string> spill_files;
+    TF_ASSERT_OK(Env::Default()->GetMatchingPaths(
+        io::JoinPath(dataset_params.spill_directory(), "*.spill"),
+        &spill_files));
+    ASSERT_EQ(spill_files.size(), 1);
+    uint64 spill_file_size = 0;
+    TF_ASSERT_OK(
+        Env::Default()->GetFileSize(spill_files[0], &spill_file_size));
+    EXPECT_EQ(spill_file_size, static_cast<uint64>(metrics->GetSpilledBytes()));
+  }
+  // The second iterator read one element from memory, and two from disk.
+  EXPECT_EQ(metrics->GetHits(), 1);
+  EXPECT_EQ(metrics->GetMisses(), 2);
+}
+
+TEST_F(CacheDatasetOpTest, BoundedMemoryIteratorSaveAndRestore) {
+  auto dataset_params = BoundedMemoryCacheDatasetParams1();
+  TF_ASSERT_OK(
+      Env::Default()->RecursivelyCreateDir(dataset_params.spill_directory()));
+  TF_ASSERT_OK(DatasetOpsTestBase::Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorSaveAndRestore(
+      dataset_params.iterator_prefix(),
+      CreateTensors<int64_t>(TensorShape({3, 1}),
+                             {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}}),
+      /*breakpoints=*/{0, 2, 4, 11}, /*compare_order=*/true));
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -14,6 +14,12 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_ops.h"
 
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
@@ -68,6 +74,162 @@ const std::vector<std::vector<Tensor>>& MemoryCache::data() {
   return cache_;
 }
 
+BoundedMemoryCache::BoundedMemoryCache(
+    Env* env, int64_t memory_budget, std::string spill_filename,
+    std::shared_ptr<TfDatazCacheMetricsCollector> metrics)
+    : env_(env),
+      memory_budget_(memory_budget),
+      spill_filename_(std::move(spill_filename)),
+      metrics_(std::move(metrics)) {}
+
+BoundedMemoryCache::~BoundedMemoryCache() {
+  mutex_lock l(mu_);
+  ResetLocked();
+}
+
+Status BoundedMemoryCache::Append(const std::vector<Tensor>& element) {
+  CompressedElement compressed;
+  TF_RETURN_IF_ERROR(CompressElement(element, &compressed));
+  const int64_t num_bytes = compressed.ByteSizeLong();
+  mutex_lock l(mu_);
+  if (completed_) {
+    return errors::FailedPrecondition("Cannot append to a completed cache.");
+  }
+  // Elements are kept in memory until the budget is exhausted; after that,
+  // every element is spilled so that indices map to tiers by a single cutoff.
+  if (spilled_elements_.empty() &&
+      memory_bytes_ + num_bytes <= memory_budget_) {
+    memory_elements_.push_back(std::move(compressed));
+    memory_bytes_ += num_bytes;
+    metrics_->RecordMemoryBytes(num_bytes);
+    return OkStatus();
+  }
+  if (!spill_writer_) {
+    TF_RETURN_IF_ERROR(env_->NewWritableFile(spill_filename_, &spill_writer_));
+  }
+  std::string serialized = compressed.SerializeAsString();
+  TF_RETURN_IF_ERROR(spill_writer_->Append(serialized));
+  spilled_elements_.push_back({spilled_bytes_, serialized.size()});
+  spilled_bytes_ += serialized.size();
+  metrics_->RecordSpilledBytes(serialized.size());
+  return OkStatus();
+}
+
+Status BoundedMemoryCache::Complete() {
+  mutex_lock l(mu_);
+  if (completed_) {
+    return OkStatus();
+  }
+  if (spill_writer_) {
+    TF_RETURN_IF_ERROR(spill_writer_->Close());
+    spill_writer_.reset();
+    TF_RETURN_IF_ERROR(
+        env_->NewRandomAccessFile(spill_filename_, &spill_reader_));
+  }
+  completed_ = true;
+  return OkStatus();
+}
+
+bool BoundedMemoryCache::IsCompleted() {
+  tf_shared_lock l(mu_);
+  return completed_;
+}
+
+void BoundedMemoryCache::Reset() {
+  mutex_lock l(mu_);
+  ResetLocked();
+}
+
+void BoundedMemoryCache::ResetLocked() {
+  completed_ = false;
+  metrics_->RecordMemoryBytes(-memory_bytes_);
+  metrics_->RecordSpilledBytes(-static_cast<int64_t>(spilled_bytes_));
+  memory_elements_.clear();
+  memory_bytes_ = 0;
+  if (spill_writer_ || spill_reader_) {
+    spill_writer_.reset();
+    spill_reader_.reset();
+    Status s = env_->DeleteFile(spill_filename_);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to delete cache spill file " << spill_filename_
+                   << ": " << s;
+    }
+  }
+  spilled_elements_.clear();
+  spilled_bytes_ = 0;
+}
+
+Status BoundedMemoryCache::Get(int64_t index,
+                               std::vector<Tensor>* out_tensors) {
+  CompressedElement compressed;
+  bool read = false;
+  {
+    tf_shared_lock l(mu_);
+    if (index < memory_elements_.size()) {
+      metrics_->RecordHit();
+      return UncompressElement(memory_elements_[index], out_tensors);
+    }
+    if (completed_) {
+      TF_RETURN_IF_ERROR(ReadSpilledElementLocked(index, &compressed));
+      read = true;
+    }
+  }
+  if (!read) {
+    // A partially written cache is only read when its writer is checkpointed,
+    // so it is fine to serialize these reads.
+    mutex_lock l(mu_);
+    if (spill_writer_) {
+      TF_RETURN_IF_ERROR(spill_writer_->Flush());
+      if (!spill_reader_) {
+        TF_RETURN_IF_ERROR(
+            env_->NewRandomAccessFile(spill_filename_, &spill_reader_));
+      }
+    }
+    TF_RETURN_IF_ERROR(ReadSpilledElementLocked(index, &compressed));
+  }
+  metrics_->RecordMiss();
+  return UncompressElement(compressed, out_tensors);
+}
+
+Status BoundedMemoryCache::ReadSpilledElementLocked(
+    int64_t index, CompressedElement* compressed) {
+  const int64_t spilled_index = index - memory_elements_.size();
+  if (spilled_index < 0 || spilled_index >= spilled_elements_.size() ||
+      !spill_reader_) {
+    return errors::OutOfRange("Index ", index,
+                              " is out of range of the cache.");
+  }
+  const SpilledElement& element = spilled_elements_[spilled_index];
+  std::string scratch(element.size, '\0');
+  StringPiece data;
+  TF_RETURN_IF_ERROR(spill_reader_->Read(element.offset, element.size, &data,
+                                         scratch.data()));
+  if (!compressed->ParseFromArray(data.data(), data.size())) {
+    return errors::DataLoss("Failed to parse cached element ", index,
+                            " from ", spill_filename_);
+  }
+  return OkStatus();
+}
+
+bool BoundedMemoryCache::AcquireWriter() {
+  mutex_lock l(mu_);
+  if (completed_ || has_writer_) {
+    return false;
+  }
+  has_writer_ = true;
+  return true;
+}
+
+void BoundedMemoryCache::ReleaseWriter() {
+  mutex_lock l(mu_);
+  has_writer_ = false;
+}
+
+size_t BoundedMemoryCache::size() {
+  tf_shared_lock l(mu_);
+  return memory_elements_.size() + spilled_elements_.size();
+}
+
 AnonymousMemoryCacheHandleOp::AnonymousMemoryCacheHandleOp(
     OpKernelConstruction* ctx)
     : AnonymousResourceOp<MemoryCacheManager>(ctx,
@@ -16,8 +16,16 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/tfdataz_metrics.h"
+#include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
 
 namespace tensorflow {
 namespace data {
@@ -57,6 +65,75 @@ class MemoryCache {
   std::vector<std::vector<Tensor>> cache_ TF_GUARDED_BY(mu_);
 };
 
+// A thread-safe data structure for caching dataset elements under a memory
+// budget.
+//
+// Elements are snappy-compressed. Once the compressed elements held in memory
+// would exceed `memory_budget` bytes, all subsequent elements are appended to
+// `spill_filename` instead. A single writer, claimed through `AcquireWriter`,
+// populates the cache through `Append` and `Complete`, after which any number
+// of readers may call `Get` concurrently.
+class BoundedMemoryCache {
+ public:
+  BoundedMemoryCache(Env* env, int64_t memory_budget,
+                     std::string spill_filename,
+                     std::shared_ptr<TfDatazCacheMetricsCollector> metrics);
+  ~BoundedMemoryCache();
+
+  // Appends `element` to the cache. Must not be called once completed.
+  Status Append(const std::vector<Tensor>& element);
+
+  // Marks the cache as completed, flushing any spilled elements.
+  Status Complete();
+
+  // Returns whether the cache is completed.
+  bool IsCompleted();
+
+  // Discards all cached elements and deletes the spill file.
+  void Reset();
+
+  // Decompresses the element at the given index into `out_tensors`.
+  Status Get(int64_t index, std::vector<Tensor>* out_tensors);
+
+  // Returns the number of cached elements.
+  size_t size();
+
+  // Claims the right to populate the cache. Returns false if the cache is
+  // completed or another writer has already claimed it.
+  bool AcquireWriter();
+
+  // Gives up the right to populate the cache.
+  void ReleaseWriter();
+
+ private:
+  // Location of a spilled element in `spill_filename_`.
+  struct SpilledElement {
+    uint64 offset;
+    size_t size;
+  };
+
+  void ResetLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  Status ReadSpilledElementLocked(int64_t index, CompressedElement* compressed)
+      TF_SHARED_LOCKS_REQUIRED(mu_);
+
+  Env* const env_;
+  const int64_t memory_budget_;
+  const std::string spill_filename_;
+  const std::shared_ptr<TfDatazCacheMetricsCollector> metrics_;
+
+  mutex mu_;
+  bool completed_ TF_GUARDED_BY(mu_) = false;
+  bool has_writer_ TF_GUARDED_BY(mu_) = false;
+  std::vector<CompressedElement> memory_elements_ TF_GUARDED_BY(mu_);
+  int64_t memory_bytes_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<SpilledElement> spilled_elements_ TF_GUARDED_BY(mu_);
+  uint64 spilled_bytes_ TF_GUARDED_BY(mu_) = 0;
+  // Open while the cache is being written.
+  std::unique_ptr<WritableFile> spill_writer_ TF_GUARDED_BY(mu_);
+  // Open once the cache is completed.
+  std::unique_ptr<RandomAccessFile> spill_reader_ TF_GUARDED_BY(mu_);
+};
+
 // A resource wrapping a shared instance of a memory cache.
 class MemoryCacheManager : public ResourceBase {
  public:
@@ -0,0 +1,723 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/bucket_by_sequence_length_dataset_op.h"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/kernels/ragged_tensor_variant.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Constants declared in bucket_by_sequence_length_dataset_op.h and used both
+// here and in test cases.
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kInputDataset;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kBucketBoundaries;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kBucketBatchSizes;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kTokenBudget;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kAutotuneWindow;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kPaddingValues;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kLengthComponent;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kRagged;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kTinputTypes;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kOutputShapes;
+
+namespace {
+
+constexpr char kInputExhausted[] = "input_exhausted";
+constexpr char kTuned[] = "tuned";
+constexpr char kBoundaries[] = "boundaries";
+constexpr char kWindow[] = "window";
+constexpr char kBucket[] = "bucket";
+constexpr char kNumReadyBatches[] = "num_ready_batches";
+constexpr char kReadyBatch[] = "ready_batch";
+
+// Returns whether component `index` of the elements of `input` is batched into
+// a ragged tensor.
+bool IsRaggedComponent(const DatasetBase* input, bool ragged, size_t index) {
+  return ragged && input->output_shapes()[index].dims() > 0;
+}
+
+}  // namespace
+
+class BucketBySequenceLengthDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input,
+          std::vector<int64_t> bucket_boundaries,
+          std::vector<int64_t> bucket_batch_sizes, int64_t token_budget,
+          int64_t autotune_window, std::vector<Tensor> padding_values,
+          int64_t length_component, bool ragged,
+          const DataTypeVector& output_types,
+          const std::vector<PartialTensorShape>& output_shapes)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        bucket_boundaries_(std::move(bucket_boundaries)),
+        bucket_batch_sizes_(std::move(bucket_batch_sizes)),
+        token_budget_(token_budget),
+        autotune_window_(autotune_window),
+        padding_values_(std::move(padding_values)),
+        length_component_(length_component),
+        ragged_(ragged),
+        output_types_(output_types),
+        output_shapes_(output_shapes) {
+    input_->Ref();
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override { return output_types_; }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    int64_t n = input_->Cardinality(options);
+    if (n == kInfiniteCardinality || n == kUnknownCardinality) {
+      return n;
+    }
+    return n == 0 ? 0 : kUnknownCardinality;
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return OkStatus();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* bucket_boundaries = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(bucket_boundaries_, &bucket_boundaries));
+    Node* bucket_batch_sizes = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(bucket_batch_sizes_, &bucket_batch_sizes));
+    Node* token_budget = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(token_budget_, &token_budget));
+    Node* autotune_window = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(autotune_window_, &autotune_window));
+
+    std::vector<Node*> padding_values;
+    padding_values.reserve(padding_values_.size());
+    for (const Tensor& t : padding_values_) {
+      Node* node;
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padding_values.emplace_back(node);
+    }
+
+    AttrValue length_component;
+    b->BuildAttrValue(length_component_, &length_component);
+    AttrValue ragged;
+    b->BuildAttrValue(ragged_, &ragged);
+    AttrValue input_types;
+    b->BuildAttrValue(input_->output_dtypes(), &input_types);
+
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this,
+        {{0, input_graph_node},
+         {1, bucket_boundaries},
+         {2, bucket_batch_sizes},
+         {3, token_budget},
+         {4, autotune_window}},
+        {{5, padding_values}},
+        {{kLengthComponent, length_component},
+         {kRagged, ragged},
+         {kTinputTypes, input_types}},
+        output));
+    return OkStatus();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params),
+          boundaries_(params.dataset->bucket_boundaries_),
+          tuned_(params.dataset->autotune_window_ == 0),
+          buckets_(params.dataset->bucket_boundaries_.size() + 1) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      std::vector<std::vector<Tensor>> batch;
+      {
+        mutex_lock l(mu_);
+        while (ready_batches_.empty() && input_impl_) {
+          std::vector<Tensor> element;
+          bool end_of_input = false;
+          TF_RETURN_IF_ERROR(
+              input_impl_->GetNext(ctx, &element, &end_of_input));
+          if (end_of_input) {
+            input_impl_.reset();
+            TF_RETURN_IF_ERROR(FlushBuckets());
+          } else {
+            TF_RETURN_IF_ERROR(AddElement(std::move(element)));
+          }
+        }
+        if (ready_batches_.empty()) {
+          *end_of_sequence = true;
+          return OkStatus();
+        }
+        batch = std::move(ready_batches_.front());
+        ready_batches_.pop_front();
+      }
+      *end_of_sequence = false;
+      return CopyBatch(ctx, batch, out_tensors);
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeUnknownRatioNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), kInputExhausted, static_cast<int64_t>(!input_impl_)));
+      if (input_impl_) {
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      }
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(prefix(), kTuned, static_cast<int64_t>(tuned_)));
+      Tensor boundaries(DT_INT64, {static_cast<int64_t>(boundaries_.size())});
+      std::copy(boundaries_.begin(), boundaries_.end(),
+                boundaries.vec<int64_t>().data());
+      TF_RETURN_IF_ERROR(
+          writer->WriteTensor(prefix(), kBoundaries, boundaries));
+      TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(
+          writer, absl::StrCat(prefix(), "::", kWindow), window_));
+      for (size_t i = 0; i < buckets_.size(); ++i) {
+        TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(
+            writer, absl::StrCat(prefix(), "::", kBucket, "_", i),
+            buckets_[i].elements));
+      }
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), kNumReadyBatches,
+          static_cast<int64_t>(ready_batches_.size())));
+      for (size_t i = 0; i < ready_batches_.size(); ++i) {
+        TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(
+            writer, absl::StrCat(prefix(), "::", kReadyBatch, "_", i),
+            ready_batches_[i]));
+      }
+      return OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64_t input_exhausted;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kInputExhausted, &input_exhausted));
+      if (static_cast<bool>(input_exhausted)) {
+        input_impl_.reset();
+      } else {
+        TF_RETURN_IF_ERROR(
+            dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_));
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      }
+      int64_t tuned;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kTuned, &tuned));
+      tuned_ = static_cast<bool>(tuned);
+      Tensor boundaries;
+      TF_RETURN_IF_ERROR(
+          reader->ReadTensor(prefix(), kBoundaries, &boundaries));
+      if (boundaries.NumElements() !=
+          static_cast<int64_t>(boundaries_.size())) {
+        return errors::FailedPrecondition(
+            "The checkpoint has ", boundaries.NumElements(),
+            " bucket boundaries, but the dataset has ", boundaries_.size());
+      }
+      auto boundaries_t = boundaries.vec<int64_t>();
+      std::copy(boundaries_t.data(), boundaries_t.data() + boundaries_t.size(),
+                boundaries_.begin());
+      TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
+          ctx, reader, absl::StrCat(prefix(), "::", kWindow), &window_));
+      for (size_t i = 0; i < buckets_.size(); ++i) {
+        Bucket& bucket = buckets_[i];
+        TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
+            ctx, reader, absl::StrCat(prefix(), "::", kBucket, "_", i),
+            &bucket.elements));
+        bucket.max_length = 0;
+        bucket.total_length = 0;
+        for (const std::vector<Tensor>& element : bucket.elements) {
+          int64_t length;
+          TF_RETURN_IF_ERROR(Length(element, &length));
+          bucket.max_length = std::max(bucket.max_length, length);
+          bucket.total_length += length;
+        }
+      }
+      int64_t num_ready_batches;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kNumReadyBatches, &num_ready_batches));
+      ready_batches_.clear();
+      for (int64_t i = 0; i < num_ready_batches; ++i) {
+        std::vector<std::vector<Tensor>> batch;
+        TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
+            ctx, reader, absl::StrCat(prefix(), "::", kReadyBatch, "_", i),
+            &batch));
+        ready_batches_.push_back(std::move(batch));
+      }
+      return OkStatus();
+    }
+
+   private:
+    // The elements of a bucket which have not been batched yet.
+    struct Bucket {
+      std::vector<std::vector<Tensor>> elements;
+      // The length of the longest element of `elements`.
+      int64_t max_length = 0;
+      // The sum of the lengths of `elements`.
+      int64_t total_length = 0;
+    };
+
+    // Returns the number of tokens of a batch of the elements of `bucket`,
+    // plus `num_elements` elements of length `length`. It is the size of the
+    // padded batch, or the sum of the lengths of its elements if the batch is
+    // ragged.
+    int64_t Tokens(const Bucket& bucket, int64_t num_elements,
+                   int64_t length) const {
+      if (dataset()->ragged_) {
+        return bucket.total_length + num_elements * length;
+      }
+      return static_cast<int64_t>(bucket.elements.size() + num_elements) *
+             std::max(bucket.max_length, length);
+    }
+
+    // Returns the sequence length of `element` in `length`.
+    Status Length(const std::vector<Tensor>& element, int64_t* length) const {
+      const Tensor& component = element[dataset()->length_component_];
+      if (component.dims() < 1) {
+        return errors::InvalidArgument(
+            "The sequence length is the size of the first dimension of "
+            "component ",
+            dataset()->length_component_,
+            ", which must have a rank of at least 1, but got an element of "
+            "shape ",
+            component.shape().DebugString());
+      }
+      *length = component.dim_size(0);
+      return OkStatus();
+    }
+
+    // Adds `element` to the autotuning window, or to its bucket once the
+    // boundaries are tuned.
+    Status AddElement(std::vector<Tensor> element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (tuned_) {
+        return AddToBucket(std::move(element));
+      }
+      window_.push_back(std::move(element));
+      if (static_cast<int64_t>(window_.size()) < dataset()->autotune_window_) {
+        return OkStatus();
+      }
+      return TuneBoundaries();
+    }
+
+    // Chooses the bucket boundaries from the lengths of the elements of the
+    // window, so that each bucket receives the same number of them, then adds
+    // the elements of the window to their buckets.
+    Status TuneBoundaries() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      std::vector<int64_t> lengths;
+      lengths.reserve(window_.size());
+      for (const std::vector<Tensor>& element : window_) {
+        int64_t length;
+        TF_RETURN_IF_ERROR(Length(element, &length));
+        lengths.push_back(length);
+      }
+      std::sort(lengths.begin(), lengths.end());
+      if (!lengths.empty()) {
+        const size_t num_buckets = buckets_.size();
+        int64_t previous = 0;
+        for (size_t i = 0; i < boundaries_.size(); ++i) {
+          const size_t rank = (i + 1) * lengths.size() / num_buckets;
+          boundaries_[i] = std::max(
+              lengths[std::min(rank, lengths.size() - 1)], previous + 1);
+          previous = boundaries_[i];
+        }
+        VLOG(2) << "Tuned the bucket boundaries of " << prefix() << " to "
+                << absl::StrJoin(boundaries_, ",");
+      }
+      tuned_ = true;
+      std::vector<std::vector<Tensor>> window;
+      window.swap(window_);
+      for (std::vector<Tensor>& element : window) {
+        TF_RETURN_IF_ERROR(AddToBucket(std::move(element)));
+      }
+      return OkStatus();
+    }
+
+    // Adds `element` to the bucket of its length. A batch is ready when the
+    // bucket reaches its batch size or the token budget, and before adding an
+    // element would exceed the token budget.
+    Status AddToBucket(std::vector<Tensor> element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      int64_t length;
+      TF_RETURN_IF_ERROR(Length(element, &length));
+      const size_t index =
+          std::upper_bound(boundaries_.begin(), boundaries_.end(), length) -
+          boundaries_.begin();
+      Bucket& bucket = buckets_[index];
+      const int64_t token_budget = dataset()->token_budget_;
+      if (token_budget > 0 && !bucket.elements.empty() &&
+          Tokens(bucket, /*num_elements=*/1, length) > token_budget) {
+        FlushBucket(&bucket);
+      }
+      bucket.elements.push_back(std::move(element));
+      bucket.max_length = std::max(bucket.max_length, length);
+      bucket.total_length += length;
+      const std::vector<int64_t>& batch_sizes = dataset()->bucket_batch_sizes_;
+      const int64_t num_elements = bucket.elements.size();
+      if ((!batch_sizes.empty() && num_elements >= batch_sizes[index]) ||
+          (token_budget > 0 &&
+           Tokens(bucket, /*num_elements=*/0, /*length=*/0) >= token_budget)) {
+        FlushBucket(&bucket);
+      }
+      return OkStatus();
+    }
+
+    void FlushBucket(Bucket* bucket) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      ready_batches_.push_back(std::move(bucket->elements));
+      bucket->elements.clear();
+      bucket->max_length = 0;
+      bucket->total_length = 0;
+    }
+
+    // Batches the remaining elements once the input is exhausted.
+    Status FlushBuckets() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!tuned_) {
+        TF_RETURN_IF_ERROR(TuneBoundaries());
+      }
+      for (Bucket& bucket : buckets_) {
+        if (!bucket.elements.empty()) {
+          FlushBucket(&bucket);
+        }
+      }
+      return OkStatus();
+    }
+
+    // Copies the elements of `batch` into one output tensor per component.
+    Status CopyBatch(IteratorContext* ctx,
+                     const std::vector<std::vector<Tensor>>& batch,
+                     std::vector<Tensor>* out_tensors) {
+      const size_t num_components = batch[0].size();
+      out_tensors->reserve(num_components);
+      for (size_t i = 0; i < num_components; ++i) {
+        if (IsRaggedComponent(dataset()->input_, dataset()->ragged_, i)) {
+          TF_RETURN_IF_ERROR(CopyRaggedComponent(ctx, batch, i, out_tensors));
+        } else {
+          TF_RETURN_IF_ERROR(CopyPaddedComponent(ctx, batch, i, out_tensors));
+        }
+      }
+      return OkStatus();
+    }
+
+    // Copies component `index` of the elements of `batch` into a tensor padded
+    // to the largest size of the batch in each dimension.
+    Status CopyPaddedComponent(IteratorContext* ctx,
+                               const std::vector<std::vector<Tensor>>& batch,
+                               size_t index,
+                               std::vector<Tensor>* out_tensors) {
+      const int64_t batch_size = batch.size();
+      const int rank = batch[0][index].dims();
+      TensorShape component_shape = batch[0][index].shape();
+      for (const std::vector<Tensor>& element : batch) {
+        const TensorShape& shape = element[index].shape();
+        if (shape.dims() != rank) {
+          return errors::InvalidArgument(
+              "All elements in a batch must have the same rank for component ",
+              index, ": expected rank ", rank, " but got element with rank ",
+              shape.dims());
+        }
+        for (int dim = 0; dim < rank; ++dim) {
+          component_shape.set_dim(dim, std::max(component_shape.dim_size(dim),
+                                                shape.dim_size(dim)));
+        }
+      }
+      TensorShape batch_shape({batch_size});
+      batch_shape.AppendShape(component_shape);
+      out_tensors->emplace_back(ctx->allocator({}),
+                                dataset()->input_->output_dtypes()[index],
+                                batch_shape);
+      Tensor& batch_component = out_tensors->back();
+      TF_RETURN_IF_ERROR(batch_util::SetElementZero(
+          &batch_component, dataset()->padding_values_[index]));
+      for (int64_t i = 0; i < batch_size; ++i) {
+        if (batch[i][index].shape() == component_shape) {
+          TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
+              batch[i][index], &batch_component, i));
+        } else {
+          TF_RETURN_IF_ERROR(batch_util::CopyElementToLargerSlice(
+              batch[i][index], &batch_component, i));
+        }
+      }
+      return OkStatus();
+    }
+
+    // Copies component `index` of the elements of `batch` into a ragged tensor
+    // whose rows are the elements, encoded as a scalar variant tensor.
+    Status CopyRaggedComponent(IteratorContext* ctx,
+                               const std::vector<std::vector<Tensor>>& batch,
+                               size_t index,
+                               std::vector<Tensor>* out_tensors) {
+      const TensorShape& first_shape = batch[0][index].shape();
+      Tensor row_splits(ctx->allocator({}), DT_INT64,
+                        {static_cast<int64_t>(batch.size()) + 1});
+      auto row_splits_t = row_splits.vec<int64_t>();
+      row_splits_t(0) = 0;
+      for (size_t i = 0; i < batch.size(); ++i) {
+        const TensorShape& shape = batch[i][index].shape();
+        bool compatible = shape.dims() == first_shape.dims();
+        for (int dim = 1; compatible && dim < shape.dims(); ++dim) {
+          compatible = shape.dim_size(dim) == first_shape.dim_size(dim);
+        }
+        if (!compatible) {
+          return errors::InvalidArgument(
+              "All elements in a ragged batch must have the same shape for "
+              "component ",
+              index, " except in the first dimension, but got shapes ",
+              first_shape.DebugString(), " and ", shape.DebugString());
+        }
+        row_splits_t(i + 1) = row_splits_t(i) + shape.dim_size(0);
+      }
+      TensorShape values_shape = first_shape;
+      values_shape.set_dim(0, row_splits_t(batch.size()));
+      Tensor values(ctx->allocator({}),
+                    dataset()->input_->output_dtypes()[index], values_shape);
+      for (size_t i = 0; i < batch.size(); ++i) {
+        const Tensor& row = batch[i][index];
+        TF_RETURN_IF_ERROR(batch_util::CopyContiguousSlices(
+            row, /*src_offset=*/0, /*dst_offset=*/row_splits_t(i),
+            /*num_slices=*/row.dim_size(0), &values));
+      }
+      out_tensors->emplace_back(ctx->allocator({}), DT_VARIANT,
+                                TensorShape({}));
+      out_tensors->back().scalar<Variant>()() =
+          RaggedTensorVariant(std::move(values), {row_splits});
+      return OkStatus();
+    }
+
+    mutex mu_;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    // The bucket boundaries, which are replaced by tuned ones if
+    // `autotune_window` is positive.
+    std::vector<int64_t> boundaries_ TF_GUARDED_BY(mu_);
+    bool tuned_ TF_GUARDED_BY(mu_);
+    // The elements read while the boundaries are not tuned yet.
+    std::vector<std::vector<Tensor>> window_ TF_GUARDED_BY(mu_);
+    std::vector<Bucket> buckets_ TF_GUARDED_BY(mu_);
+    // The batches which are ready to be produced, in order.
+    std::deque<std::vector<std::vector<Tensor>>> ready_batches_
+        TF_GUARDED_BY(mu_);
+  };
+
+  const DatasetBase* const input_;
+  const std::vector<int64_t> bucket_boundaries_;
+  const std::vector<int64_t> bucket_batch_sizes_;
+  const int64_t token_budget_;
+  const int64_t autotune_window_;
+  const std::vector<Tensor> padding_values_;
+  const int64_t length_component_;
+  const bool ragged_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+};
+
+BucketBySequenceLengthDatasetOp::BucketBySequenceLengthDatasetOp(
+    OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kLengthComponent, &length_component_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kRagged, &ragged_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+}
+
+void BucketBySequenceLengthDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                                  DatasetBase* input,
+                                                  DatasetBase** output) {
+  const Tensor* bucket_boundaries_t;
+  OP_REQUIRES_OK(ctx, ctx->input(kBucketBoundaries, &bucket_boundaries_t));
+  OP_REQUIRES(ctx, TensorShapeUtils::IsVector(bucket_boundaries_t->shape()),
+              errors::InvalidArgument("`bucket_boundaries` must be a vector."));
+  std::vector<int64_t> bucket_boundaries;
+  int64_t previous = 0;
+  for (int64_t i = 0; i < bucket_boundaries_t->NumElements(); ++i) {
+    const int64_t boundary = bucket_boundaries_t->vec<int64_t>()(i);
+    OP_REQUIRES(
+        ctx, boundary > previous,
+        errors::InvalidArgument("`bucket_boundaries` must be positive and "
+                                "strictly increasing, but got ",
+                                bucket_boundaries_t->DebugString()));
+    bucket_boundaries.push_back(boundary);
+    previous = boundary;
+  }
+
+  int64_t token_budget;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kTokenBudget,
+                                                   &token_budget));
+  OP_REQUIRES(ctx, token_budget >= 0,
+              errors::InvalidArgument("`token_budget` must be non-negative."));
+
+  std::vector<int64_t> bucket_batch_sizes;
+  OP_REQUIRES_OK(ctx, ParseVectorArgument<int64_t>(ctx, kBucketBatchSizes,
+                                                   &bucket_batch_sizes));
+  if (bucket_batch_sizes.empty()) {
+    OP_REQUIRES(ctx, token_budget > 0,
+                errors::InvalidArgument(
+                    "`bucket_batch_sizes` may only be empty if `token_budget` "
+                    "is positive."));
+  } else {
+    OP_REQUIRES(ctx, bucket_batch_sizes.size() == bucket_boundaries.size() + 1,
+                errors::InvalidArgument(
+                    "`bucket_batch_sizes` must have one more element than "
+                    "`bucket_boundaries`, but got ",
+                    bucket_batch_sizes.size(), " batch sizes and ",
+                    bucket_boundaries.size(), " boundaries."));
+    for (int64_t batch_size : bucket_batch_sizes) {
+      OP_REQUIRES(ctx, batch_size > 0,
+                  errors::InvalidArgument(
+                      "`bucket_batch_sizes` must all be positive."));
+    }
+  }
+
+  int64_t autotune_window;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kAutotuneWindow,
+                                                   &autotune_window));
+  OP_REQUIRES(
+      ctx, autotune_window >= 0,
+      errors::InvalidArgument("`autotune_window` must be non-negative."));
+
+  const size_t num_components = input->output_dtypes().size();
+  OP_REQUIRES(ctx, length_component_ < static_cast<int64_t>(num_components),
+              errors::InvalidArgument(
+                  "`length_component` must be less than the number of "
+                  "components of the input elements (",
+                  num_components, "), but got ", length_component_));
+  OP_REQUIRES(ctx, input->output_shapes()[length_component_].dims() != 0,
+              errors::InvalidArgument(
+                  "Component ", length_component_,
+                  " of the input elements must have a rank of at least 1 to "
+                  "determine their sequence length."));
+
+  OpInputList padding_values_list;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddingValues, &padding_values_list));
+  OP_REQUIRES(ctx, padding_values_list.size() == num_components,
+              errors::InvalidArgument(
+                  "Number of padding values (", padding_values_list.size(),
+                  ") must match the number of components in the input "
+                  "dataset's elements (",
+                  num_components, ")"));
+  std::vector<Tensor> padding_values;
+  for (int i = 0; i < padding_values_list.size(); ++i) {
+    const Tensor& padding_value_t = padding_values_list[i];
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(padding_value_t.shape()),
+                errors::InvalidArgument("All padding values must be scalars"));
+    OP_REQUIRES(ctx, padding_value_t.dtype() == input->output_dtypes()[i],
+                errors::InvalidArgument(
+                    "Mismatched type between padding value ", i,
+                    " and input dataset's component ", i, ": ",
+                    DataTypeString(padding_value_t.dtype()), " vs. ",
+                    DataTypeString(input->output_dtypes()[i])));
+    padding_values.push_back(tensor::DeepCopy(padding_value_t));
+  }
+
+  OP_REQUIRES(ctx, output_types_.size() == num_components,
+              errors::InvalidArgument(
+                  "`output_types` must have one type per component of the "
+                  "input elements."));
+  for (size_t i = 0; i < num_components; ++i) {
+    if (ragged_) {
+      OP_REQUIRES(ctx, !input->output_shapes()[i].unknown_rank(),
+                  errors::InvalidArgument(
+                      "Ragged batching requires the rank of component ", i,
+                      " of the input elements to be known."));
+    }
+    const DataType expected_type = IsRaggedComponent(input, ragged_, i)
+                                       ? DT_VARIANT
+                                       : input->output_dtypes()[i];
+    OP_REQUIRES(ctx, output_types_[i] == expected_type,
+                errors::InvalidArgument(
+                    "Expected output type ", DataTypeString(expected_type),
+                    " for component ", i, ", but got ",
+                    DataTypeString(output_types_[i])));
+  }
+
+  *output = new Dataset(ctx, input, std::move(bucket_boundaries),
+                        std::move(bucket_batch_sizes), token_budget,
+                        autotune_window, std::move(padding_values),
+                        length_component_, ragged_, output_types_,
+                        output_shapes_);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(
+    Name("BucketBySequenceLengthDataset").Device(DEVICE_CPU),
+    BucketBySequenceLengthDatasetOp);
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
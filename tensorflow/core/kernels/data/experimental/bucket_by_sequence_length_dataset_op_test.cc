@@ -0,0 +1,335 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/bucket_by_sequence_length_dataset_op.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/kernels/ragged_tensor_variant.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "bucket_by_sequence_length_dataset";
+
+// Parameters of a `ListDataset` of (sequence, label) elements, whose sequences
+// have different lengths.
+class SequenceListDatasetParams : public DatasetParams {
+ public:
+  explicit SequenceListDatasetParams(
+      std::vector<std::vector<Tensor>> elements)
+      : DatasetParams({DT_INT64, DT_INT64},
+                      {PartialTensorShape({-1}), PartialTensorShape({})},
+                      "sequence_list_dataset") {
+    for (auto& element : elements) {
+      for (auto& tensor : element) {
+        input_types_.push_back(tensor.dtype());
+        tensors_.push_back(std::move(tensor));
+      }
+    }
+  }
+
+  std::vector<Tensor> GetInputTensors() const override { return tensors_; }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    input_names->clear();
+    for (int i = 0; i < tensors_.size(); ++i) {
+      input_names->emplace_back(absl::StrCat("tensors_", i));
+    }
+    return OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{"Tinput_types", input_types_},
+                    {"output_types", output_dtypes_},
+                    {"output_shapes", output_shapes_},
+                    {"metadata", ""}};
+    return OkStatus();
+  }
+
+  string dataset_type() const override { return "List"; }
+
+ private:
+  std::vector<Tensor> tensors_;
+  DataTypeVector input_types_;
+};
+
+class BucketBySequenceLengthDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  BucketBySequenceLengthDatasetParams(
+      T input_dataset_params, std::vector<int64_t> bucket_boundaries,
+      std::vector<int64_t> bucket_batch_sizes, int64_t token_budget,
+      int64_t autotune_window, int64_t length_component, bool ragged,
+      DataTypeVector output_dtypes,
+      std::vector<PartialTensorShape> output_shapes)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      kNodeName),
+        bucket_boundaries_(std::move(bucket_boundaries)),
+        bucket_batch_sizes_(std::move(bucket_batch_sizes)),
+        token_budget_(token_budget),
+        autotune_window_(autotune_window),
+        length_component_(length_component),
+        ragged_(ragged) {
+    input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {
+        CreateTensor<int64_t>(
+            TensorShape({static_cast<int64_t>(bucket_boundaries_.size())}),
+            bucket_boundaries_),
+        CreateTensor<int64_t>(
+            TensorShape({static_cast<int64_t>(bucket_batch_sizes_.size())}),
+            bucket_batch_sizes_),
+        CreateTensor<int64_t>(TensorShape({}), {token_budget_}),
+        CreateTensor<int64_t>(TensorShape({}), {autotune_window_}),
+        CreateTensor<int64_t>(TensorShape({}), {0}),
+        CreateTensor<int64_t>(TensorShape({}), {-1})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {BucketBySequenceLengthDatasetOp::kInputDataset,
+                    BucketBySequenceLengthDatasetOp::kBucketBoundaries,
+                    BucketBySequenceLengthDatasetOp::kBucketBatchSizes,
+                    BucketBySequenceLengthDatasetOp::kTokenBudget,
+                    BucketBySequenceLengthDatasetOp::kAutotuneWindow,
+                    absl::StrCat(
+                        BucketBySequenceLengthDatasetOp::kPaddingValues, "_0"),
+                    absl::StrCat(
+                        BucketBySequenceLengthDatasetOp::kPaddingValues, "_1")};
+    return OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{"length_component", length_component_},
+                    {"ragged", ragged_},
+                    {"Tinput_types", DataTypeVector({DT_INT64, DT_INT64})},
+                    {"output_types", output_dtypes_},
+                    {"output_shapes", output_shapes_},
+                    {"metadata", ""}};
+    return OkStatus();
+  }
+
+  string dataset_type() const override {
+    return BucketBySequenceLengthDatasetOp::kDatasetType;
+  }
+
+ private:
+  std::vector<int64_t> bucket_boundaries_;
+  std::vector<int64_t> bucket_batch_sizes_;
+  int64_t token_budget_;
+  int64_t autotune_window_;
+  int64_t length_component_;
+  bool ragged_;
+};
+
+class BucketBySequenceLengthDatasetOpTest : public DatasetOpsTestBase {};
+
+// Element `i` is a sequence of `lengths[i]` values `i + 1`, labeled `i`.
+SequenceListDatasetParams Sequences() {
+  const std::vector<int64_t> lengths = {1, 3, 2, 5, 1, 4};
+  std::vector<std::vector<Tensor>> elements;
+  for (int64_t i = 0; i < lengths.size(); ++i) {
+    elements.push_back(
+        {CreateTensor<int64_t>(TensorShape({lengths[i]}),
+                               std::vector<int64_t>(lengths[i], i + 1)),
+         CreateTensor<int64_t>(TensorShape({}), {i})});
+  }
+  return SequenceListDatasetParams(std::move(elements));
+}
+
+BucketBySequenceLengthDatasetParams PaddedParams(
+    std::vector<int64_t> bucket_boundaries,
+    std::vector<int64_t> bucket_batch_sizes, int64_t token_budget,
+    int64_t autotune_window) {
+  return BucketBySequenceLengthDatasetParams(
+      Sequences(), std::move(bucket_boundaries), std::move(bucket_batch_sizes),
+      token_budget, autotune_window,
+      /*length_component=*/0,
+      /*ragged=*/false,
+      /*output_dtypes=*/{DT_INT64, DT_INT64},
+      /*output_shapes=*/
+      {PartialTensorShape({-1, -1}), PartialTensorShape({-1})});
+}
+
+// Test case 1: fixed boundaries and batch sizes.
+BucketBySequenceLengthDatasetParams BatchSizesParams() {
+  return PaddedParams(/*bucket_boundaries=*/{3}, /*bucket_batch_sizes=*/{2, 2},
+                      /*token_budget=*/0, /*autotune_window=*/0);
+}
+
+// Test case 2: batch sizes chosen by a token budget.
+BucketBySequenceLengthDatasetParams TokenBudgetParams() {
+  return PaddedParams(/*bucket_boundaries=*/{3}, /*bucket_batch_sizes=*/{},
+                      /*token_budget=*/6, /*autotune_window=*/0);
+}
+
+// Test case 3: boundaries chosen from the lengths of the input, which are
+// fewer than the window.
+BucketBySequenceLengthDatasetParams AutotuneParams() {
+  return PaddedParams(/*bucket_boundaries=*/{100},
+                      /*bucket_batch_sizes=*/{2, 2},
+                      /*token_budget=*/0, /*autotune_window=*/100);
+}
+
+// Test case 4: boundaries chosen from a window smaller than the input.
+BucketBySequenceLengthDatasetParams SmallAutotuneWindowParams() {
+  return PaddedParams(/*bucket_boundaries=*/{100},
+                      /*bucket_batch_sizes=*/{2, 2},
+                      /*token_budget=*/0, /*autotune_window=*/2);
+}
+
+BucketBySequenceLengthDatasetParams RaggedParams() {
+  return BucketBySequenceLengthDatasetParams(
+      Sequences(), /*bucket_boundaries=*/{3}, /*bucket_batch_sizes=*/{2, 2},
+      /*token_budget=*/0, /*autotune_window=*/0,
+      /*length_component=*/0,
+      /*ragged=*/true,
+      /*output_dtypes=*/{DT_VARIANT, DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({}), PartialTensorShape({-1})});
+}
+
+// The batches of test cases 1 and 3: bucket 0 holds elements 0, 2 and 4, and
+// bucket 1 holds elements 1, 3 and 5.
+std::vector<Tensor> BatchSizesOutputs() {
+  return {CreateTensor<int64_t>(TensorShape({2, 2}), {1, 0, 3, 3}),
+          CreateTensor<int64_t>(TensorShape({2}), {0, 2}),
+          CreateTensor<int64_t>(TensorShape({2, 5}),
+                                {2, 2, 2, 0, 0, 4, 4, 4, 4, 4}),
+          CreateTensor<int64_t>(TensorShape({2}), {1, 3}),
+          CreateTensor<int64_t>(TensorShape({1, 1}), {5}),
+          CreateTensor<int64_t>(TensorShape({1}), {4}),
+          CreateTensor<int64_t>(TensorShape({1, 4}), {6, 6, 6, 6}),
+          CreateTensor<int64_t>(TensorShape({1}), {5})};
+}
+
+std::vector<GetNextTestCase<BucketBySequenceLengthDatasetParams>>
+GetNextTestCases() {
+  return {{/*dataset_params=*/BatchSizesParams(),
+           /*expected_outputs=*/BatchSizesOutputs()},
+          {/*dataset_params=*/TokenBudgetParams(),
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape({1, 3}), {2, 2, 2}),
+            CreateTensor<int64_t>(TensorShape({1}), {1}),
+            CreateTensor<int64_t>(TensorShape({3, 2}), {1, 0, 3, 3, 5, 0}),
+            CreateTensor<int64_t>(TensorShape({3}), {0, 2, 4}),
+            CreateTensor<int64_t>(TensorShape({1, 5}), {4, 4, 4, 4, 4}),
+            CreateTensor<int64_t>(TensorShape({1}), {3}),
+            CreateTensor<int64_t>(TensorShape({1, 4}), {6, 6, 6, 6}),
+            CreateTensor<int64_t>(TensorShape({1}), {5})}},
+          {/*dataset_params=*/AutotuneParams(),
+           /*expected_outputs=*/BatchSizesOutputs()},
+          // The boundary is the median of lengths 1 and 3.
+          {/*dataset_params=*/SmallAutotuneWindowParams(),
+           /*expected_outputs=*/BatchSizesOutputs()}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(BucketBySequenceLengthDatasetOpTest,
+                         BucketBySequenceLengthDatasetParams,
+                         GetNextTestCases())
+
+TEST_F(BucketBySequenceLengthDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = BatchSizesParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(BucketBySequenceLengthDatasetOp::kDatasetType)));
+}
+
+TEST_F(BucketBySequenceLengthDatasetOpTest, Ragged) {
+  auto dataset_params = RaggedParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  const std::vector<std::vector<int64_t>> expected_values = {
+      {1, 3, 3}, {2, 2, 2, 4, 4, 4, 4, 4}, {5}, {6, 6, 6, 6}};
+  const std::vector<std::vector<int64_t>> expected_row_splits = {
+      {0, 1, 3}, {0, 3, 8}, {0, 1}, {0, 4}};
+  const std::vector<std::vector<int64_t>> expected_labels = {
+      {0, 2}, {1, 3}, {4}, {5}};
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  for (int i = 0; i < expected_values.size(); ++i) {
+    out_tensors.clear();
+    TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                    &end_of_sequence));
+    ASSERT_FALSE(end_of_sequence);
+    ASSERT_EQ(out_tensors.size(), 2);
+    const RaggedTensorVariant* ragged =
+        out_tensors[0].scalar<Variant>()().get<RaggedTensorVariant>();
+    ASSERT_NE(ragged, nullptr);
+    ASSERT_EQ(ragged->ragged_rank(), 1);
+    const int64_t num_values = expected_values[i].size();
+    const int64_t num_rows = expected_labels[i].size();
+    TF_EXPECT_OK(ExpectEqual(
+        ragged->values(),
+        CreateTensor<int64_t>(TensorShape({num_values}), expected_values[i])));
+    TF_EXPECT_OK(ExpectEqual(ragged->splits(0),
+                             CreateTensor<int64_t>(TensorShape({num_rows + 1}),
+                                                   expected_row_splits[i])));
+    TF_EXPECT_OK(ExpectEqual(
+        out_tensors[1],
+        CreateTensor<int64_t>(TensorShape({num_rows}), expected_labels[i])));
+  }
+  out_tensors.clear();
+  TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                  &end_of_sequence));
+  EXPECT_TRUE(end_of_sequence);
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<BucketBySequenceLengthDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/BatchSizesParams(),
+           /*breakpoints=*/{0, 1, 3, 5},
+           /*expected_outputs=*/BatchSizesOutputs()},
+          {/*dataset_params=*/SmallAutotuneWindowParams(),
+           /*breakpoints=*/{0, 1, 3, 5},
+           /*expected_outputs=*/BatchSizesOutputs()}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(BucketBySequenceLengthDatasetOpTest,
+                                 BucketBySequenceLengthDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+TEST_F(BucketBySequenceLengthDatasetOpTest, InvalidArguments) {
+  std::vector<BucketBySequenceLengthDatasetParams> invalid_params = {
+      // The boundaries are not strictly increasing.
+      PaddedParams(/*bucket_boundaries=*/{3, 3},
+                   /*bucket_batch_sizes=*/{2, 2, 2},
+                   /*token_budget=*/0, /*autotune_window=*/0),
+      // There is no batch size per bucket.
+      PaddedParams(/*bucket_boundaries=*/{3}, /*bucket_batch_sizes=*/{2},
+                   /*token_budget=*/0, /*autotune_window=*/0),
+      // There are neither batch sizes nor a token budget.
+      PaddedParams(/*bucket_boundaries=*/{3}, /*bucket_batch_sizes=*/{},
+                   /*token_budget=*/0, /*autotune_window=*/0),
+      PaddedParams(/*bucket_boundaries=*/{3}, /*bucket_batch_sizes=*/{2, 2},
+                   /*token_budget=*/-1, /*autotune_window=*/0)};
+  for (const auto& dataset_params : invalid_params) {
+    EXPECT_EQ(Initialize(dataset_params).code(),
+              absl::StatusCode::kInvalidArgument);
+  }
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
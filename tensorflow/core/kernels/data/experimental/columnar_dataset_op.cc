@@ -0,0 +1,351 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/columnar_dataset_op.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/root_dataset.h"
+#include "tensorflow/core/data/split_utils.h"
+#include "tensorflow/core/framework/function_handle_cache.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/experimental/columnar_file.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/resource.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// See documentation in ../../ops/experimental_dataset_ops.cc for a high-level
+// description of the following op.
+
+/* static */ constexpr const char* const ColumnarDatasetOp::kDatasetType;
+/* static */ constexpr const char* const ColumnarDatasetOp::kFileNames;
+/* static */ constexpr const char* const ColumnarDatasetOp::kSelectCols;
+/* static */ constexpr const char* const ColumnarDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const ColumnarDatasetOp::kOutputShapes;
+
+class ColumnarDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, std::vector<std::string> filenames,
+          std::vector<int64_t> select_cols, std::vector<int64_t> columns,
+          std::vector<std::unique_ptr<ColumnarFileReader>> readers,
+          const DataTypeVector& output_types,
+          const std::vector<PartialTensorShape>& output_shapes)
+      : DatasetBase(DatasetContext(ctx)),
+        filenames_(std::move(filenames)),
+        select_cols_(std::move(select_cols)),
+        columns_(std::move(columns)),
+        readers_(std::move(readers)),
+        output_types_(output_types),
+        output_shapes_(output_shapes) {
+    file_offsets_.reserve(readers_.size() + 1);
+    file_offsets_.push_back(0);
+    for (const auto& reader : readers_) {
+      file_offsets_.push_back(file_offsets_.back() + reader->num_elements());
+    }
+  }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  Status MakeSplitProviders(std::vector<std::unique_ptr<SplitProvider>>*
+                                split_providers) const override {
+    split_providers->push_back(
+        std::make_unique<IndexSplitProvider>(num_elements()));
+    return OkStatus();
+  }
+
+  const DataTypeVector& output_dtypes() const override { return output_types_; }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    return num_elements();
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    return OkStatus();
+  }
+
+  Status CheckExternalState() const override { return OkStatus(); }
+
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    return GetElement(index, out_tensors);
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* filenames = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+    Node* select_cols = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(select_cols_, &select_cols));
+    TF_RETURN_IF_ERROR(b->AddDataset(this, {filenames, select_cols}, output));
+    return OkStatus();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    bool SymbolicCheckpointCompatible() const override { return true; }
+
+    Status Initialize(IteratorContext* ctx) override {
+      if (ctx->split_providers().empty()) {
+        split_provider_ =
+            std::make_shared<IndexSplitProvider>(dataset()->num_elements());
+      } else {
+        TF_ASSIGN_OR_RETURN(split_provider_,
+                            GetSingleSplitProvider(ctx, dataset()));
+      }
+      return OkStatus();
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      Tensor split;
+      TF_RETURN_IF_ERROR(split_provider_->GetNext(&split, end_of_sequence));
+      if (*end_of_sequence) {
+        return OkStatus();
+      }
+      return dataset()->GetElement(split.scalar<int64_t>()(), out_tensors);
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      return split_provider_->Save(
+          [this](const std::string& key) { return full_name(key); }, writer);
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      return split_provider_->Restore(
+          [this](const std::string& key) { return full_name(key); }, reader);
+    }
+
+   private:
+    std::shared_ptr<SplitProvider> split_provider_;
+  };
+
+  int64_t num_elements() const { return file_offsets_.back(); }
+
+  // Reads the selected columns of the element at `index` across all files.
+  Status GetElement(int64_t index, std::vector<Tensor>* out_tensors) const {
+    // The file holding `index` is the last one starting at or before it.
+    const auto it = std::upper_bound(file_offsets_.begin(),
+                                     file_offsets_.end(), index);
+    const size_t file_index = std::distance(file_offsets_.begin(), it) - 1;
+    return readers_[file_index]->Get(index - file_offsets_[file_index],
+                                     columns_, out_tensors);
+  }
+
+  const std::vector<std::string> filenames_;
+  // The `select_cols` input, which is empty to select all columns.
+  const std::vector<int64_t> select_cols_;
+  // The columns to read.
+  const std::vector<int64_t> columns_;
+  const std::vector<std::unique_ptr<ColumnarFileReader>> readers_;
+  // `file_offsets_[i]` is the global index of the first element of file `i`.
+  std::vector<int64_t> file_offsets_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+};
+
+ColumnarDatasetOp::ColumnarDatasetOp(OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+}
+
+void ColumnarDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                    DatasetBase** output) {
+  const Tensor* filenames_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kFileNames, &filenames_tensor));
+  OP_REQUIRES(
+      ctx, filenames_tensor->dims() <= 1,
+      errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+  std::vector<std::string> filenames;
+  filenames.reserve(filenames_tensor->NumElements());
+  for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+    filenames.push_back(filenames_tensor->flat<tstring>()(i));
+  }
+  std::vector<int64_t> select_cols;
+  OP_REQUIRES_OK(ctx, ParseVectorArgument<int64_t>(ctx, kSelectCols,
+                                                   &select_cols));
+
+  std::vector<std::unique_ptr<ColumnarFileReader>> readers;
+  readers.reserve(filenames.size());
+  for (const std::string& filename : filenames) {
+    std::unique_ptr<ColumnarFileReader> reader;
+    OP_REQUIRES_OK(ctx, ColumnarFileReader::Open(ctx->env(), filename,
+                                                 &reader));
+    readers.push_back(std::move(reader));
+  }
+
+  // All files must share the element spec of the first one.
+  std::vector<int64_t> columns = select_cols;
+  if (!readers.empty()) {
+    const ColumnarFileMetadata& metadata = readers[0]->metadata();
+    for (int i = 1; i < readers.size(); ++i) {
+      const ColumnarFileMetadata& other = readers[i]->metadata();
+      OP_REQUIRES(
+          ctx,
+          std::equal(metadata.dtypes().begin(), metadata.dtypes().end(),
+                     other.dtypes().begin(), other.dtypes().end()),
+          errors::InvalidArgument("Columnar files ", filenames[0], " and ",
+                                  filenames[i], " have different dtypes."));
+    }
+    if (columns.empty()) {
+      for (int64_t column = 0; column < metadata.dtypes_size(); ++column) {
+        columns.push_back(column);
+      }
+    }
+    DataTypeVector column_types;
+    for (int64_t column : columns) {
+      OP_REQUIRES(ctx, column >= 0 && column < metadata.dtypes_size(),
+                  errors::InvalidArgument(
+                      "`select_cols` contains column ", column, ", but ",
+                      filenames[0], " has ", metadata.dtypes_size(),
+                      " columns."));
+      column_types.push_back(metadata.dtypes(column));
+    }
+    OP_REQUIRES_OK(ctx, VerifyTypesMatch(output_types_, column_types));
+  }
+
+  *output = new Dataset(ctx, std::move(filenames), std::move(select_cols),
+                        std::move(columns), std::move(readers), output_types_,
+                        output_shapes_);
+}
+
+namespace {
+
+class DatasetToColumnarFileOp : public AsyncOpKernel {
+ public:
+  explicit DatasetToColumnarFileOp(OpKernelConstruction* ctx)
+      : AsyncOpKernel(ctx),
+        background_worker_(ctx->env(), "tf_data_to_columnar_file") {}
+
+  void ComputeAsync(OpKernelContext* ctx, DoneCallback done) override {
+    // The call to `iterator->GetNext()` may block and depend on an inter-op
+    // thread pool thread, so we issue the call using a background thread.
+    background_worker_.Schedule([this, ctx, done = std::move(done)]() {
+      OP_REQUIRES_OK_ASYNC(ctx, DoCompute(ctx), done);
+      done();
+    });
+  }
+
+ private:
+  Status DoCompute(OpKernelContext* ctx) {
+    tensorflow::ResourceTagger tag(kTFDataResourceTag,
+                                   ctx->op_kernel().type_string());
+    tstring filename;
+    TF_RETURN_IF_ERROR(
+        ParseScalarArgument<tstring>(ctx, "filename", &filename));
+    tstring compression;
+    TF_RETURN_IF_ERROR(
+        ParseScalarArgument<tstring>(ctx, "compression", &compression));
+    ColumnarFileWriterOptions options;
+    TF_RETURN_IF_ERROR(
+        ParseColumnarFileCompression(compression, &options.codec));
+    TF_RETURN_IF_ERROR(
+        ParseScalarArgument<int64_t>(ctx, "chunk_size", &options.chunk_size));
+    if (options.chunk_size <= 0) {
+      return errors::InvalidArgument("`chunk_size` must be positive, got ",
+                                     options.chunk_size, ".");
+    }
+
+    DatasetBase* dataset;
+    TF_RETURN_IF_ERROR(GetDatasetFromVariantTensor(ctx->input(0), &dataset));
+
+    IteratorContext::Params params(ctx);
+    FunctionHandleCache function_handle_cache(params.flr);
+    params.function_handle_cache = &function_handle_cache;
+    ResourceMgr resource_mgr;
+    params.resource_mgr = &resource_mgr;
+    CancellationManager cancellation_manager(ctx->cancellation_manager());
+    params.cancellation_manager = &cancellation_manager;
+
+    IteratorContext iter_ctx(std::move(params));
+    DatasetBase* finalized_dataset;
+    TF_RETURN_IF_ERROR(FinalizeDataset(ctx, dataset, &finalized_dataset));
+    core::ScopedUnref unref(finalized_dataset);
+
+    std::unique_ptr<IteratorBase> iterator;
+    TF_RETURN_IF_ERROR(finalized_dataset->MakeIterator(
+        &iter_ctx, /*parent=*/nullptr, "DatasetToColumnarFileIterator",
+        &iterator));
+
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(ctx->env()->NewWritableFile(filename, &file));
+    ColumnarFileWriter writer(file.get(), finalized_dataset->output_dtypes(),
+                              finalized_dataset->output_shapes(), options);
+    std::vector<Tensor> components;
+    bool end_of_sequence;
+    do {
+      TF_RETURN_IF_ERROR(
+          iterator->GetNext(&iter_ctx, &components, &end_of_sequence));
+      if (!end_of_sequence) {
+        TF_RETURN_IF_ERROR(writer.Write(components));
+      }
+      components.clear();
+    } while (!end_of_sequence);
+    TF_RETURN_IF_ERROR(writer.Finish());
+    return file->Close();
+  }
+
+  BackgroundWorker background_worker_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("ColumnarDataset").Device(DEVICE_CPU),
+                        ColumnarDatasetOp);
+REGISTER_KERNEL_BUILDER(Name("DatasetToColumnarFile").Device(DEVICE_CPU),
+                        DatasetToColumnarFileOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,299 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/columnar_file.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/io/iterator.h"
+#include "tensorflow/core/lib/io/table_options.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+// The number of decoded chunks cached per column.
+constexpr int64_t kCachedChunksPerColumn = 8;
+
+table::Options TableOptions() {
+  table::Options options;
+  // Chunks are compressed individually, as requested by the writer.
+  options.compression = table::kNoCompression;
+  return options;
+}
+
+}  // namespace
+
+std::string ColumnarFileChunkKey(int64_t chunk_index, int64_t column) {
+  // Fixed-width hex keys sort by chunk index, then by column.
+  return absl::StrFormat("%016x%08x", chunk_index, column);
+}
+
+Status ParseColumnarFileCompression(
+    const std::string& compression,
+    std::optional<CompressedElement::Codec>* codec) {
+  if (compression.empty() || compression == "NONE") {
+    codec->reset();
+    return OkStatus();
+  }
+  CompressedElement::Codec parsed;
+  if (!CompressedElement::Codec_Parse(compression, &parsed)) {
+    return errors::InvalidArgument(
+        "Unsupported compression for a columnar file: ", compression,
+        ". Must be one of \"\", \"NONE\", \"SNAPPY\" or \"ZSTD\".");
+  }
+  *codec = parsed;
+  return OkStatus();
+}
+
+ColumnarFileWriter::ColumnarFileWriter(
+    WritableFile* file, const DataTypeVector& dtypes,
+    const std::vector<PartialTensorShape>& shapes,
+    const ColumnarFileWriterOptions& options)
+    : dtypes_(dtypes),
+      shapes_(shapes),
+      options_(options),
+      builder_(TableOptions(), file),
+      columns_(dtypes.size()) {}
+
+Status ColumnarFileWriter::Write(const std::vector<Tensor>& element) {
+  if (element.size() != dtypes_.size()) {
+    return errors::InvalidArgument("Expected an element with ",
+                                   dtypes_.size(), " components, but got ",
+                                   element.size(), ".");
+  }
+  for (int i = 0; i < element.size(); ++i) {
+    if (element[i].dtype() != dtypes_[i]) {
+      return errors::InvalidArgument(
+          "Expected component ", i, " to have dtype ",
+          DataTypeString(dtypes_[i]), ", but got ",
+          DataTypeString(element[i].dtype()), ".");
+    }
+  }
+  for (int i = 0; i < element.size(); ++i) {
+    columns_[i].push_back(element[i]);
+  }
+  ++num_elements_;
+  if (num_elements_ % options_.chunk_size == 0) {
+    return FlushChunk();
+  }
+  return OkStatus();
+}
+
+Status ColumnarFileWriter::FlushChunk() {
+  if (columns_.empty() || columns_[0].empty()) {
+    return OkStatus();
+  }
+  for (int64_t column = 0; column < columns_.size(); ++column) {
+    std::string chunk;
+    if (options_.codec.has_value()) {
+      CompressElementOptions compress_options;
+      compress_options.codec = *options_.codec;
+      compress_options.compression_level = options_.compression_level;
+      CompressedElement compressed;
+      TF_RETURN_IF_ERROR(
+          CompressElement(columns_[column], compress_options, &compressed));
+      compressed.SerializeToString(&chunk);
+    } else {
+      UncompressedElement uncompressed;
+      for (const Tensor& tensor : columns_[column]) {
+        tensor.AsProtoTensorContent(uncompressed.add_components());
+      }
+      uncompressed.SerializeToString(&chunk);
+    }
+    builder_.Add(ColumnarFileChunkKey(num_chunks_, column), chunk);
+    // Ends the block, so that reading a chunk reads no other chunk.
+    builder_.Flush();
+    TF_RETURN_IF_ERROR(builder_.status());
+    columns_[column].clear();
+  }
+  ++num_chunks_;
+  return OkStatus();
+}
+
+Status ColumnarFileWriter::Finish() {
+  TF_RETURN_IF_ERROR(FlushChunk());
+  ColumnarFileMetadata metadata;
+  metadata.set_num_elements(num_elements_);
+  metadata.set_chunk_size(options_.chunk_size);
+  for (int i = 0; i < dtypes_.size(); ++i) {
+    metadata.add_dtypes(dtypes_[i]);
+    shapes_[i].AsProto(metadata.add_shapes());
+  }
+  if (options_.codec.has_value()) {
+    metadata.set_codec(*options_.codec);
+  }
+  builder_.Add(kColumnarFileMetadataKey, metadata.SerializeAsString());
+  return builder_.Finish();
+}
+
+ColumnarFileReader::ColumnarFileReader(std::string filename,
+                                       std::unique_ptr<RandomAccessFile> file,
+                                       table::Table* table)
+    : filename_(std::move(filename)), file_(std::move(file)), table_(table) {}
+
+ColumnarFileReader::~ColumnarFileReader() = default;
+
+Status ColumnarFileReader::Open(Env* env, const std::string& filename,
+                                std::unique_ptr<ColumnarFileReader>* reader) {
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  table::Table* table;
+  TF_RETURN_IF_ERROR(
+      table::Table::Open(TableOptions(), file.get(), file_size, &table));
+  // The reader takes ownership of `table` before anything else can fail.
+  reader->reset(new ColumnarFileReader(filename, std::move(file), table));
+  ColumnarFileReader& r = **reader;
+
+  std::unique_ptr<table::Iterator> iterator(r.table_->NewIterator());
+  iterator->Seek(kColumnarFileMetadataKey);
+  if (!iterator->Valid() || iterator->key() != kColumnarFileMetadataKey) {
+    TF_RETURN_IF_ERROR(iterator->status());
+    return errors::DataLoss("Columnar file ", filename,
+                            " has no metadata. Was it finished?");
+  }
+  if (!r.metadata_.ParseFromArray(iterator->value().data(),
+                                  iterator->value().size())) {
+    return errors::DataLoss("Failed to parse the metadata of columnar file ",
+                            filename, ".");
+  }
+  if (r.metadata_.dtypes_size() != r.metadata_.shapes_size() ||
+      r.metadata_.chunk_size() <= 0 || r.metadata_.num_elements() < 0) {
+    return errors::DataLoss("Invalid metadata in columnar file ", filename,
+                            ": ", r.metadata_.ShortDebugString());
+  }
+  return OkStatus();
+}
+
+Status ColumnarFileReader::Get(int64_t index,
+                               absl::Span<const int64_t> columns,
+                               std::vector<Tensor>* out) const {
+  if (index < 0 || index >= num_elements()) {
+    return errors::OutOfRange("Index ", index, " is out of range for the ",
+                              num_elements(), " elements of columnar file ",
+                              filename_, ".");
+  }
+  const int64_t chunk_index = index / metadata_.chunk_size();
+  const int64_t index_in_chunk = index % metadata_.chunk_size();
+  out->clear();
+  out->reserve(columns.size());
+  for (int64_t column : columns) {
+    if (column < 0 || column >= metadata_.dtypes_size()) {
+      return errors::InvalidArgument("Column ", column,
+                                     " does not exist in columnar file ",
+                                     filename_, ", which has ",
+                                     metadata_.dtypes_size(), " columns.");
+    }
+    const ChunkKey key(chunk_index, column);
+    {
+      mutex_lock l(mu_);
+      auto it = cache_.find(key);
+      if (it != cache_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        out->push_back(it->second->elements[index_in_chunk]);
+        continue;
+      }
+    }
+    std::vector<Tensor> elements;
+    TF_RETURN_IF_ERROR(ReadChunk(chunk_index, column, &elements));
+    if (index_in_chunk >= elements.size()) {
+      return errors::DataLoss("Chunk ", chunk_index, " of column ", column,
+                              " of columnar file ", filename_, " has ",
+                              elements.size(), " elements, expected more than ",
+                              index_in_chunk, ".");
+    }
+    out->push_back(elements[index_in_chunk]);
+    CacheChunk(key, std::move(elements));
+  }
+  return OkStatus();
+}
+
+int64_t ColumnarFileReader::num_decoded_chunks() const {
+  mutex_lock l(mu_);
+  return num_decoded_chunks_;
+}
+
+void ColumnarFileReader::CacheChunk(const ChunkKey& key,
+                                    std::vector<Tensor> elements) const {
+  mutex_lock l(mu_);
+  ++num_decoded_chunks_;
+  if (cache_.contains(key)) {
+    // Another thread decoded the same chunk concurrently.
+    return;
+  }
+  lru_.push_front(CachedChunk{key, std::move(elements)});
+  cache_[key] = lru_.begin();
+  while (lru_.size() > kCachedChunksPerColumn * metadata_.dtypes_size()) {
+    cache_.erase(lru_.back().key);
+    lru_.pop_back();
+  }
+}
+
+Status ColumnarFileReader::ReadChunk(int64_t chunk_index, int64_t column,
+                                     std::vector<Tensor>* elements) const {
+  const std::string key = ColumnarFileChunkKey(chunk_index, column);
+  std::unique_ptr<table::Iterator> iterator(table_->NewIterator());
+  iterator->Seek(key);
+  if (!iterator->Valid() || iterator->key() != key) {
+    TF_RETURN_IF_ERROR(iterator->status());
+    return errors::DataLoss("Chunk ", chunk_index, " of column ", column,
+                            " is missing from columnar file ", filename_,
+                            ".");
+  }
+  const StringPiece value = iterator->value();
+  if (metadata_.has_codec()) {
+    CompressedElement compressed;
+    if (!compressed.ParseFromArray(value.data(), value.size())) {
+      return errors::DataLoss("Failed to parse chunk ", chunk_index,
+                              " of column ", column, " of columnar file ",
+                              filename_, ".");
+    }
+    return UncompressElement(compressed, elements);
+  }
+  UncompressedElement uncompressed;
+  if (!uncompressed.ParseFromArray(value.data(), value.size())) {
+    return errors::DataLoss("Failed to parse chunk ", chunk_index,
+                            " of column ", column, " of columnar file ",
+                            filename_, ".");
+  }
+  elements->clear();
+  elements->reserve(uncompressed.components_size());
+  for (const TensorProto& proto : uncompressed.components()) {
+    elements->emplace_back();
+    if (!elements->back().FromProto(proto)) {
+      return errors::DataLoss("Failed to parse a tensor of chunk ",
+                              chunk_index, " of column ", column,
+                              " of columnar file ", filename_, ".");
+    }
+  }
+  return OkStatus();
+}
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
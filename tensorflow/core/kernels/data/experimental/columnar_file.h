@@ -0,0 +1,172 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COLUMNAR_FILE_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COLUMNAR_FILE_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/io/table.h"
+#include "tensorflow/core/lib/io/table_builder.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// A columnar file stores the elements of a dataset so that any element, or
+// any subset of its components, can be read without reading the rest of the
+// file.
+//
+// Each component of the elements is a column. The column is split into
+// chunks of `chunk_size` consecutive elements, each of which is optionally
+// compressed on its own. The chunks are stored in a `table::Table`, one
+// chunk per block, keyed by their chunk index and column index, so the
+// table's index block serves as the footer index of the file. The file's
+// `ColumnarFileMetadata` is stored under `kColumnarFileMetadataKey`.
+//
+// Reading an element reads and decodes the chunks holding it in the
+// requested columns, so random access costs one block read per column. The
+// reader caches a few recently decoded chunks per column, which serves
+// sequential reads and reads of nearby elements. Reads in a shuffled order
+// mostly miss the cache and decode a whole chunk per element, so files read in
+// a shuffled order should be written with a small `chunk_size`.
+
+// Key of the `ColumnarFileMetadata` in the table. Sorts after all chunk keys.
+constexpr char kColumnarFileMetadataKey[] = "~metadata";
+
+// Returns the table key of chunk `chunk_index` of column `column`.
+std::string ColumnarFileChunkKey(int64_t chunk_index, int64_t column);
+
+struct ColumnarFileWriterOptions {
+  // The number of elements per column chunk. Larger chunks compress better,
+  // smaller chunks make random access cheaper. Use a small chunk size, e.g.
+  // 16, for files which are read in a shuffled order.
+  int64_t chunk_size = 256;
+  // The codec to compress each chunk with, or none to not compress.
+  std::optional<CompressedElement::Codec> codec;
+  // The compression level for codecs that support it.
+  int compression_level = 3;
+};
+
+// Parses the `compression` argument of the columnar dataset ops, which is
+// empty or "NONE" for no compression, "SNAPPY", or "ZSTD".
+Status ParseColumnarFileCompression(
+    const std::string& compression,
+    std::optional<CompressedElement::Codec>* codec);
+
+// Writes elements to a columnar file. Buffers the elements of a chunk in
+// memory until the chunk is full. Not thread safe.
+class ColumnarFileWriter {
+ public:
+  // Does not take ownership of `file`, which must outlive the writer.
+  ColumnarFileWriter(WritableFile* file, const DataTypeVector& dtypes,
+                     const std::vector<PartialTensorShape>& shapes,
+                     const ColumnarFileWriterOptions& options);
+
+  // Appends `element` to the file.
+  Status Write(const std::vector<Tensor>& element);
+
+  // Writes the remaining elements and the metadata. Does not close the file.
+  Status Finish();
+
+ private:
+  // Writes the buffered elements as the next chunk of each column.
+  Status FlushChunk();
+
+  const DataTypeVector dtypes_;
+  const std::vector<PartialTensorShape> shapes_;
+  const ColumnarFileWriterOptions options_;
+  table::TableBuilder builder_;
+  // The buffered elements of the current chunk, per column.
+  std::vector<std::vector<Tensor>> columns_;
+  int64_t num_elements_ = 0;
+  int64_t num_chunks_ = 0;
+};
+
+// Reads elements of a columnar file. Thread safe.
+class ColumnarFileReader {
+ public:
+  static Status Open(Env* env, const std::string& filename,
+                     std::unique_ptr<ColumnarFileReader>* reader);
+
+  ~ColumnarFileReader();
+
+  const ColumnarFileMetadata& metadata() const { return metadata_; }
+  int64_t num_elements() const { return metadata_.num_elements(); }
+
+  // Reads the components in `columns` of the element at `index`, in the
+  // order of `columns`.
+  Status Get(int64_t index, absl::Span<const int64_t> columns,
+             std::vector<Tensor>* out) const;
+
+  // Returns the number of chunks read and decoded so far.
+  int64_t num_decoded_chunks() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // The chunk index and column of a chunk.
+  using ChunkKey = std::pair<int64_t, int64_t>;
+
+  struct CachedChunk {
+    ChunkKey key;
+    std::vector<Tensor> elements;
+  };
+
+  ColumnarFileReader(std::string filename,
+                     std::unique_ptr<RandomAccessFile> file,
+                     table::Table* table);
+
+  // Reads and decodes chunk `chunk_index` of `column`.
+  Status ReadChunk(int64_t chunk_index, int64_t column,
+                   std::vector<Tensor>* elements) const;
+
+  // Adds a decoded chunk to the cache, evicting the least recently used chunks
+  // if the cache is full.
+  void CacheChunk(const ChunkKey& key, std::vector<Tensor> elements) const
+      TF_LOCKS_EXCLUDED(mu_);
+
+  const std::string filename_;
+  const std::unique_ptr<RandomAccessFile> file_;
+  const std::unique_ptr<table::Table> table_;
+  ColumnarFileMetadata metadata_;
+
+  mutable mutex mu_;
+  // Recently decoded chunks, most recently used first.
+  mutable std::list<CachedChunk> lru_ TF_GUARDED_BY(mu_);
+  mutable absl::flat_hash_map<ChunkKey, std::list<CachedChunk>::iterator>
+      cache_ TF_GUARDED_BY(mu_);
+  mutable int64_t num_decoded_chunks_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COLUMNAR_FILE_H_
@@ -0,0 +1,209 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/columnar_file.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+#include "tsl/platform/status_matchers.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+using ::testing::HasSubstr;
+using ::tsl::testing::StatusIs;
+
+// Returns element `i` of the test dataset: an int64 scalar `i` and a string
+// vector whose size depends on `i`.
+std::vector<Tensor> TestElement(int64_t i) {
+  std::vector<tstring> strings(i % 4, absl::StrCat("element ", i));
+  return {CreateTensor<int64_t>(TensorShape({}), {i}),
+          CreateTensor<tstring>(TensorShape({static_cast<int64_t>(
+                                    strings.size())}),
+                                strings)};
+}
+
+Status WriteTestFile(const std::string& filename, int64_t num_elements,
+                     const ColumnarFileWriterOptions& options) {
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(Env::Default()->NewWritableFile(filename, &file));
+  ColumnarFileWriter writer(file.get(), {DT_INT64, DT_STRING},
+                            {PartialTensorShape({}), PartialTensorShape({-1})},
+                            options);
+  for (int64_t i = 0; i < num_elements; ++i) {
+    TF_RETURN_IF_ERROR(writer.Write(TestElement(i)));
+  }
+  TF_RETURN_IF_ERROR(writer.Finish());
+  return file->Close();
+}
+
+std::string TestFilename() {
+  return io::JoinPath(testing::TmpDir(),
+                      absl::StrCat("columnar_file_", random::New64()));
+}
+
+class ColumnarFileRoundTripTest
+    : public ::testing::TestWithParam<std::tuple<std::string, int64_t>> {
+ protected:
+  ColumnarFileWriterOptions Options() {
+    ColumnarFileWriterOptions options;
+    TF_CHECK_OK(
+        ParseColumnarFileCompression(std::get<0>(GetParam()), &options.codec));
+    options.chunk_size = std::get<1>(GetParam());
+    return options;
+  }
+};
+
+TEST_P(ColumnarFileRoundTripTest, RoundTrip) {
+  const int64_t num_elements = 20;
+  const std::string filename = TestFilename();
+  TF_ASSERT_OK(WriteTestFile(filename, num_elements, Options()));
+
+  std::unique_ptr<ColumnarFileReader> reader;
+  TF_ASSERT_OK(ColumnarFileReader::Open(Env::Default(), filename, &reader));
+  EXPECT_EQ(reader->num_elements(), num_elements);
+  EXPECT_EQ(reader->metadata().dtypes_size(), 2);
+  EXPECT_EQ(reader->metadata().has_codec(), Options().codec.has_value());
+  // Reads in a shuffled order, so that most reads switch chunks.
+  for (int64_t i = 0; i < num_elements; ++i) {
+    const int64_t index = (i * 7) % num_elements;
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(reader->Get(index, {0, 1}, &element));
+    TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(
+        element, TestElement(index), /*compare_order=*/true));
+  }
+}
+
+TEST_P(ColumnarFileRoundTripTest, Projection) {
+  const int64_t num_elements = 10;
+  const std::string filename = TestFilename();
+  TF_ASSERT_OK(WriteTestFile(filename, num_elements, Options()));
+
+  std::unique_ptr<ColumnarFileReader> reader;
+  TF_ASSERT_OK(ColumnarFileReader::Open(Env::Default(), filename, &reader));
+  for (int64_t i = 0; i < num_elements; ++i) {
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(reader->Get(i, {1}, &element));
+    TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(
+        element, {TestElement(i)[1]}, /*compare_order=*/true));
+    TF_ASSERT_OK(reader->Get(i, {1, 0}, &element));
+    TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(
+        element, {TestElement(i)[1], TestElement(i)[0]},
+        /*compare_order=*/true));
+  }
+}
+
+TEST(ColumnarFileTest, CachesRecentChunks) {
+  const std::string filename = TestFilename();
+  ColumnarFileWriterOptions options;
+  options.chunk_size = 4;
+  TF_ASSERT_OK(WriteTestFile(filename, /*num_elements=*/40, options));
+  std::unique_ptr<ColumnarFileReader> reader;
+  TF_ASSERT_OK(ColumnarFileReader::Open(Env::Default(), filename, &reader));
+
+  // Alternates between elements of a few chunks, which are decoded once.
+  std::vector<Tensor> element;
+  for (int64_t i = 0; i < 12; ++i) {
+    const int64_t index = (i % 3) * 12 + i / 3;
+    TF_ASSERT_OK(reader->Get(index, {0}, &element));
+    TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(
+        element, {TestElement(index)[0]}, /*compare_order=*/true));
+  }
+  EXPECT_EQ(reader->num_decoded_chunks(), 3);
+
+  // Reading every chunk evicts the least recently used chunks.
+  for (int64_t index = 0; index < 40; index += 4) {
+    TF_ASSERT_OK(reader->Get(index, {0, 1}, &element));
+  }
+  const int64_t num_decoded_chunks = reader->num_decoded_chunks();
+  TF_ASSERT_OK(reader->Get(0, {0}, &element));
+  EXPECT_EQ(reader->num_decoded_chunks(), num_decoded_chunks + 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Compression, ColumnarFileRoundTripTest,
+    ::testing::Combine(::testing::Values("", "SNAPPY", "ZSTD"),
+                       ::testing::Values(1, 3, 20, 256)));
+
+TEST(ColumnarFileTest, Empty) {
+  const std::string filename = TestFilename();
+  TF_ASSERT_OK(WriteTestFile(filename, /*num_elements=*/0,
+                             ColumnarFileWriterOptions()));
+  std::unique_ptr<ColumnarFileReader> reader;
+  TF_ASSERT_OK(ColumnarFileReader::Open(Env::Default(), filename, &reader));
+  EXPECT_EQ(reader->num_elements(), 0);
+  std::vector<Tensor> element;
+  EXPECT_THAT(reader->Get(0, {0}, &element),
+              StatusIs(error::OUT_OF_RANGE));
+}
+
+TEST(ColumnarFileTest, InvalidIndexAndColumn) {
+  const std::string filename = TestFilename();
+  TF_ASSERT_OK(WriteTestFile(filename, /*num_elements=*/5,
+                             ColumnarFileWriterOptions()));
+  std::unique_ptr<ColumnarFileReader> reader;
+  TF_ASSERT_OK(ColumnarFileReader::Open(Env::Default(), filename, &reader));
+  std::vector<Tensor> element;
+  EXPECT_THAT(reader->Get(-1, {0}, &element), StatusIs(error::OUT_OF_RANGE));
+  EXPECT_THAT(reader->Get(5, {0}, &element), StatusIs(error::OUT_OF_RANGE));
+  EXPECT_THAT(reader->Get(0, {2}, &element),
+              StatusIs(error::INVALID_ARGUMENT, HasSubstr("Column 2")));
+}
+
+TEST(ColumnarFileTest, WrongDtype) {
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(Env::Default()->NewWritableFile(TestFilename(), &file));
+  ColumnarFileWriter writer(file.get(), {DT_INT64}, {PartialTensorShape({})},
+                            ColumnarFileWriterOptions());
+  EXPECT_THAT(writer.Write({CreateTensor<float>(TensorShape({}), {1.0f})}),
+              StatusIs(error::INVALID_ARGUMENT, HasSubstr("dtype")));
+}
+
+TEST(ColumnarFileTest, UnfinishedFile) {
+  const std::string filename = TestFilename();
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, "not a table"));
+  std::unique_ptr<ColumnarFileReader> reader;
+  EXPECT_FALSE(
+      ColumnarFileReader::Open(Env::Default(), filename, &reader).ok());
+}
+
+TEST(ColumnarFileTest, InvalidCompression) {
+  std::optional<CompressedElement::Codec> codec;
+  EXPECT_THAT(ParseColumnarFileCompression("GZIP", &codec),
+              StatusIs(error::INVALID_ARGUMENT,
+                       HasSubstr("Unsupported compression")));
+  TF_EXPECT_OK(ParseColumnarFileCompression("NONE", &codec));
+  EXPECT_FALSE(codec.has_value());
+  TF_EXPECT_OK(ParseColumnarFileCompression("ZSTD", &codec));
+  EXPECT_EQ(codec, CompressedElement::ZSTD);
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/experimental/compression_ops.h"
 
+#include <string>
+#include <vector>
+
 #include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
@@ -25,15 +28,33 @@ namespace data {
 namespace experimental {
 
 CompressElementOp::CompressElementOp(OpKernelConstruction* ctx)
-    : OpKernel(ctx) {}
+    : OpKernel(ctx) {
+  if (ctx->HasAttr(kCodec)) {
+    std::string codec;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kCodec, &codec));
+    OP_REQUIRES(ctx, CompressedElement::Codec_Parse(codec, &codec_),
+                errors::InvalidArgument("Unsupported compression codec: ",
+                                        codec));
+  }
+  if (ctx->HasAttr(kCompressionLevel)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kCompressionLevel, &compression_level_));
+  }
+  if (ctx->HasAttr(kDictionary)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kDictionary, &dictionary_));
+  }
+}
 
 void CompressElementOp::Compute(OpKernelContext* ctx) {
   std::vector<Tensor> components;
   for (size_t i = 0; i < ctx->num_inputs(); ++i) {
     components.push_back(ctx->input(i));
   }
+  CompressElementOptions options;
+  options.codec = codec_;
+  options.compression_level = compression_level_;
+  options.dictionary = dictionary_;
   CompressedElement compressed;
-  OP_REQUIRES_OK(ctx, CompressElement(components, &compressed));
+  OP_REQUIRES_OK(ctx, CompressElement(components, options, &compressed));
 
   Tensor* output;
   OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
@@ -44,6 +65,9 @@ UncompressElementOp::UncompressElementOp(OpKernelConstruction* ctx)
     : OpKernel(ctx) {
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+  if (ctx->HasAttr(kDictionary)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kDictionary, &dictionary_));
+  }
 }
 
 void UncompressElementOp::Compute(OpKernelContext* ctx) {
@@ -67,7 +91,8 @@ void UncompressElementOp::Compute(OpKernelContext* ctx) {
           tensor.DebugString()));
 
   std::vector<Tensor> components;
-  OP_REQUIRES_OK(ctx, UncompressElement(*compressed, &components));
+  OP_REQUIRES_OK(ctx,
+                 UncompressElement(*compressed, dictionary_, &components));
   OP_REQUIRES(ctx, components.size() == output_types_.size(),
               errors::FailedPrecondition("Expected ", output_types_.size(),
                                          " outputs from uncompress, but got ",
@@ -15,7 +15,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COMPRESSION_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COMPRESSION_OPS_H_
 
+#include <string>
+#include <vector>
+
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/dataset.pb.h"
 
 namespace tensorflow {
 namespace data {
@@ -23,15 +27,25 @@ namespace experimental {
 
 class CompressElementOp : public OpKernel {
  public:
+  static constexpr const char* const kCodec = "codec";
+  static constexpr const char* const kCompressionLevel = "compression_level";
+  static constexpr const char* const kDictionary = "dictionary";
+
   explicit CompressElementOp(OpKernelConstruction* ctx);
 
   void Compute(OpKernelContext* ctx) override;
+
+ private:
+  CompressedElement::Codec codec_ = CompressedElement::SNAPPY;
+  int compression_level_ = 3;
+  std::string dictionary_;
 };
 
 class UncompressElementOp : public OpKernel {
  public:
   static constexpr const char* const kOutputTypes = "output_types";
   static constexpr const char* const kOutputShapes = "output_shapes";
+  static constexpr const char* const kDictionary = "dictionary";
 
   explicit UncompressElementOp(OpKernelConstruction* ctx);
 
@@ -40,6 +54,7 @@ class UncompressElementOp : public OpKernel {
  private:
   DataTypeVector output_types_;
   std::vector<PartialTensorShape> output_shapes_;
+  std::string dictionary_;
 };
 
 }  // namespace experimental
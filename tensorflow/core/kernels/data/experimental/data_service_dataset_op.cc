@@ -34,6 +34,7 @@ limitations under the License.
 #include "absl/strings/substitute.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/data/captured_function.h"
+#include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/service/client/common.h"
@@ -691,15 +692,26 @@ void DataServiceDatasetOp::MakeDataset(OpKernelContext* ctx,
   OP_REQUIRES_OK(ctx, metadata.status());
 
   bool should_uncompress = op_version_ >= 3 && uncompress_;
+  bool may_disable_compression = false;
   if (should_uncompress) {
     StatusOr<DataServiceMetadata::Compression> compression =
         GetValidatedCompression(dataset_id, *metadata);
     OP_REQUIRES_OK(ctx, compression.status());
+    may_disable_compression =
+        *compression == DataServiceMetadata::COMPRESSION_SNAPPY;
     should_uncompress =
         should_uncompress &&
-        (*compression == DataServiceMetadata::COMPRESSION_SNAPPY);
+        (*compression == DataServiceMetadata::COMPRESSION_SNAPPY ||
+         *compression == DataServiceMetadata::COMPRESSION_ZSTD);
+    // The uncompress function has no dictionary of its own: it finds the
+    // dictionary of the elements among the registered ones.
+    if (should_uncompress && !metadata->zstd_dictionary().empty()) {
+      OP_REQUIRES_OK(ctx, RegisterZstdDictionary(metadata->zstd_dictionary()));
+    }
   }
-  if (should_uncompress) {
+  // Zstd compression is chosen explicitly by the user, so only snappy
+  // compression may be disabled at runtime.
+  if (should_uncompress && may_disable_compression) {
     StatusOr<bool> disable_compression_at_runtime = DisableCompressionAtRuntime(
         data_transfer_protocol_, config->deployment_mode());
     OP_REQUIRES_OK(ctx, disable_compression_at_runtime.status());
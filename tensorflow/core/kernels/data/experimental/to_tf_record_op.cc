@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/resource.h"
@@ -34,7 +35,11 @@ class ToTFRecordOp : public AsyncOpKernel {
  public:
   explicit ToTFRecordOp(OpKernelConstruction* ctx)
       : AsyncOpKernel(ctx),
-        background_worker_(ctx->env(), "tf_data_to_tf_record") {}
+        background_worker_(ctx->env(), "tf_data_to_tf_record") {
+    if (ctx->HasAttr("write_index")) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("write_index", &write_index_));
+    }
+  }
 
   template <typename T>
   Status ParseScalarArgument(OpKernelContext* ctx,
@@ -68,11 +73,25 @@ class ToTFRecordOp : public AsyncOpKernel {
     tstring compression_type;
     TF_RETURN_IF_ERROR(ParseScalarArgument<tstring>(ctx, "compression_type",
                                                     &compression_type));
+    io::RecordWriterOptions options =
+        io::RecordWriterOptions::CreateRecordWriterOptions(compression_type);
+    // Index offsets refer to the uncompressed file, see record_index.h.
+    if (write_index_ &&
+        options.compression_type != io::RecordWriterOptions::NONE) {
+      return errors::InvalidArgument(
+          "write_index is not supported for compressed TFRecord files, but got "
+          "compression_type ",
+          compression_type);
+    }
     std::unique_ptr<WritableFile> file;
     TF_RETURN_IF_ERROR(ctx->env()->NewWritableFile(filename, &file));
-    auto writer = std::make_unique<io::RecordWriter>(
-        file.get(),
-        io::RecordWriterOptions::CreateRecordWriterOptions(compression_type));
+    std::unique_ptr<WritableFile> index_file;
+    if (write_index_) {
+      TF_RETURN_IF_ERROR(ctx->env()->NewWritableFile(
+          io::RecordIndexFilename(filename), &index_file));
+      options.index_file = index_file.get();
+    }
+    auto writer = std::make_unique<io::RecordWriter>(file.get(), options);
 
     DatasetBase* dataset;
     TF_RETURN_IF_ERROR(GetDatasetFromVariantTensor(ctx->input(0), &dataset));
@@ -119,10 +138,15 @@ class ToTFRecordOp : public AsyncOpKernel {
       }
       components.clear();
     } while (!end_of_sequence);
-    return OkStatus();
+    TF_RETURN_IF_ERROR(writer->Close());
+    if (index_file != nullptr) {
+      TF_RETURN_IF_ERROR(index_file->Close());
+    }
+    return file->Close();
   }
 
   BackgroundWorker background_worker_;
+  bool write_index_ = false;
 };
 
 REGISTER_KERNEL_BUILDER(Name("DatasetToTFRecord").Device(DEVICE_CPU),
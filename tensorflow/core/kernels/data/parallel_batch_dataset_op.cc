@@ -456,6 +456,7 @@ class ParallelBatchDatasetOp::Dataset : public DatasetBase {
         TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
       if (!runner_thread_) {
         auto new_ctx = std::make_shared<IteratorContext>(*ctx);
+        new_ctx->BindRunnerToNode(model_node());
         runner_thread_ =
             ctx->StartThread(kTFDataParallelBatch,
                              std::bind(&Iterator::RunnerThread, this, new_ctx));
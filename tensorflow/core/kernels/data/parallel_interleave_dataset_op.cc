@@ -728,6 +728,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       if (!threads_started_) {
         IncrementOutstandingThreads();
         auto ctx_copy = std::make_shared<IteratorContext>(*ctx);
+        ctx_copy->BindRunnerToNode(model_node());
         thread_pool_->Schedule(
             [this, ctx_copy]() { WorkerManagerThread(ctx_copy); });
         if (ctx->stats_aggregator()) {
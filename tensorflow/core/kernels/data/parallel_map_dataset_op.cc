@@ -453,6 +453,7 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
         TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
       if (!runner_thread_) {
         auto ctx_copy = std::make_shared<IteratorContext>(*ctx);
+        ctx_copy->BindRunnerToNode(model_node());
         runner_thread_ = ctx->StartThread(
             "tf_data_parallel_map",
             std::bind(&Iterator::RunnerThread, this, ctx_copy));
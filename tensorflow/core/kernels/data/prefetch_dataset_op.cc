@@ -15,10 +15,13 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/prefetch_dataset_op.h"
 
 #include <algorithm>
+#include <cstring>
 #include <deque>
 #include <limits>
 #include <string>
+#include <vector>
 
+#include "absl/algorithm/container.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/stats_utils.h"
@@ -28,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/stats_aggregator.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
 #include "tensorflow/core/kernels/data/prefetch_autotuner.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/strings/str_util.h"
@@ -52,6 +56,7 @@ namespace data {
 /* static */ constexpr const char* const PrefetchDatasetOp::kSlackPeriod;
 /* static */ constexpr const char* const PrefetchDatasetOp::kLegacyAutotune;
 /* static */ constexpr const char* const PrefetchDatasetOp::kBufferSizeMin;
+/* static */ constexpr const char* const PrefetchDatasetOp::kStageOnDevice;
 
 namespace {
 
@@ -68,13 +73,15 @@ constexpr char kErrorMessageSuffix[] = ".error_message";
 class PrefetchDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
-          int64_t slack_period, bool legacy_autotune, int64_t buffer_size_min)
+          int64_t slack_period, bool legacy_autotune, int64_t buffer_size_min,
+          bool stage_on_device)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         buffer_size_(buffer_size),
         slack_period_(slack_period),
         legacy_autotune_(legacy_autotune),
-        buffer_size_min_(buffer_size_min) {
+        buffer_size_min_(buffer_size_min),
+        stage_on_device_(stage_on_device) {
     input_->Ref();
   }
 
@@ -130,12 +137,15 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
     b->BuildAttrValue(legacy_autotune_, &legacy_autotune_attr);
     AttrValue buffer_size_min_attr;
     b->BuildAttrValue(buffer_size_min_, &buffer_size_min_attr);
+    AttrValue stage_on_device_attr;
+    b->BuildAttrValue(stage_on_device_, &stage_on_device_attr);
 
     TF_RETURN_IF_ERROR(
         b->AddDataset(this, {input_graph_node, buffer_size},
                       {std::make_pair(kSlackPeriod, slack_period_attr),
                        std::make_pair(kLegacyAutotune, legacy_autotune_attr),
-                       std::make_pair(kBufferSizeMin, buffer_size_min_attr)},
+                       std::make_pair(kBufferSizeMin, buffer_size_min_attr),
+                       std::make_pair(kStageOnDevice, stage_on_device_attr)},
                       output));
     return OkStatus();
   }
@@ -505,6 +515,7 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
       int num_produced = 0;
       while (true) {
         // 1. Wait for a slot in the buffer.
+        int64_t limit;
         {
           mutex_lock l(*mu_);
           while (!cancelled_ && buffer_.size() >= buffer_limit()) {
@@ -512,6 +523,7 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
             cond_var_->wait(l);
             RecordStart(ctx.get());
           }
+          limit = buffer_limit();
 
           if (cancelled_) {
             prefetch_thread_finished_ = true;
@@ -546,6 +558,13 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
           buffer_element.status = input_impl_->GetNext(
               ctx.get(), &buffer_element.value, &end_of_sequence);
           buffer_element.checkpoint.Merge(ctx->checkpoint());
+          if (dataset()->stage_on_device_ && buffer_element.status.ok() &&
+              !end_of_sequence) {
+            // Up to `limit` staged elements are buffered, and the consumer
+            // holds one more.
+            buffer_element.status =
+                Stage(ctx.get(), limit + 1, &buffer_element.value);
+          }
         }
         if (buffer_element.status.ok() && end_of_sequence) {
           mutex_lock l(*mu_);
@@ -566,6 +585,66 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
       }
     }
 
+    // Moves the tensors of `element` to host memory allocated by the device
+    // consuming the iterator, unless they are resident there already. The
+    // tensors of a staging slot are reused once no element refers to them;
+    // up to `max_slots` slots are created. If none is free, `element` is left
+    // as is.
+    Status Stage(IteratorContext* ctx, int64_t max_slots,
+                 std::vector<Tensor>* element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(input_mu_) {
+      AllocatorAttributes attrs;
+      attrs.set_on_host(true);
+      attrs.set_gpu_compatible(true);
+      Allocator* allocator = ctx->allocator(attrs);
+      auto is_free = [](const std::vector<Tensor>& slot) {
+        return absl::c_all_of(slot, [](const Tensor& staged) {
+          return !staged.IsInitialized() || staged.RefCountIsOne();
+        });
+      };
+      auto it = absl::c_find_if(staging_slots_, is_free);
+      if (it == staging_slots_.end()) {
+        if (static_cast<int64_t>(staging_slots_.size()) >= max_slots) {
+          return OkStatus();
+        }
+        it = staging_slots_.emplace(staging_slots_.end());
+      }
+      std::vector<Tensor>& slot = *it;
+      slot.resize(element->size());
+      for (size_t i = 0; i < element->size(); ++i) {
+        Tensor& tensor = (*element)[i];
+        if (!DataTypeCanUseMemcpy(tensor.dtype()) ||
+            IsResident(tensor, allocator)) {
+          continue;
+        }
+        Tensor& staged = slot[i];
+        if (!staged.IsInitialized() || staged.dtype() != tensor.dtype() ||
+            staged.shape() != tensor.shape()) {
+          staged = Tensor(allocator, tensor.dtype(), tensor.shape());
+          if (!staged.IsInitialized()) {
+            return errors::ResourceExhausted(
+                "Failed to allocate a staging tensor of shape ",
+                tensor.shape().DebugString(), " with ", allocator->Name());
+          }
+        }
+        if (tensor.TotalBytes() > 0) {
+          std::memcpy(staged.data(), tensor.data(), tensor.TotalBytes());
+        }
+        tensor = staged;
+      }
+      return OkStatus();
+    }
+
+    // Returns true if `tensor` is aligned and has been allocated by
+    // `allocator`.
+    static bool IsResident(const Tensor& tensor, Allocator* allocator) {
+      TensorDescription description;
+      tensor.FillDescription(&description);
+      return tensor.IsAligned() &&
+             description.allocation_description().allocator_name() ==
+                 allocator->Name();
+    }
+
     Status WriteStatus(IteratorStateWriter* writer, size_t index,
                        const Status& status) TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
       TF_RETURN_IF_ERROR(
@@ -617,6 +696,8 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
     // `input_impl_` so that `input_impl_` is destroyed first.
     std::unique_ptr<CancellationManager> cancellation_manager_;
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(input_mu_);
+    // The staged tensors of the last elements, if `stage_on_device_`.
+    std::vector<std::vector<Tensor>> staging_slots_ TF_GUARDED_BY(input_mu_);
     const std::shared_ptr<condition_variable> cond_var_;
     const int64_t buffer_size_min_;
     std::unique_ptr<PrefetchAutotuner> auto_tuner_ TF_GUARDED_BY(*mu_);
@@ -655,6 +736,10 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
   // parameter.
   const int64_t buffer_size_min_ = 0;
 
+  // Determines whether buffered elements are staged in memory allocated by the
+  // device consuming the iterator.
+  const bool stage_on_device_ = false;
+
   TraceMeMetadata traceme_metadata_;
 };
 
@@ -669,6 +754,9 @@ PrefetchDatasetOp::PrefetchDatasetOp(OpKernelConstruction* ctx)
   if (ctx->HasAttr(kBufferSizeMin)) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr(kBufferSizeMin, &buffer_size_min_));
   }
+  if (ctx->HasAttr(kStageOnDevice)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kStageOnDevice, &stage_on_device_));
+  }
   if (GetExperiments().contains("autotune_buffer_optimization")) {
     legacy_autotune_ = false;
     buffer_size_min_ = std::max(static_cast<int64_t>(1), buffer_size_min_);
@@ -690,7 +778,7 @@ void PrefetchDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
   }
 
   *output = new Dataset(ctx, input, buffer_size, slack_period_,
-                        legacy_autotune_, buffer_size_min_);
+                        legacy_autotune_, buffer_size_min_, stage_on_device_);
 }
 
 namespace {
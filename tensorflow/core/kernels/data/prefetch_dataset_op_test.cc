@@ -12,7 +12,14 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/prefetch_dataset_op.h"
 
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
 
 namespace tensorflow {
 namespace data {
@@ -29,13 +36,15 @@ class PrefetchDatasetParams : public DatasetParams {
                         DataTypeVector output_dtypes,
                         std::vector<PartialTensorShape> output_shapes,
                         int64_t slack_period, bool legacy_autotune,
-                        int64_t buffer_size_min, string node_name)
+                        int64_t buffer_size_min, bool stage_on_device,
+                        string node_name)
       : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
                       std::move(node_name)),
         buffer_size_(buffer_size),
         slack_period_(slack_period),
         legacy_autotune_(legacy_autotune),
-        buffer_size_min_(buffer_size_min) {
+        buffer_size_min_(buffer_size_min),
+        stage_on_device_(stage_on_device) {
     input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
     iterator_prefix_ =
         name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
@@ -61,6 +70,7 @@ class PrefetchDatasetParams : public DatasetParams {
     attr_vector->emplace_back("legacy_autotune", legacy_autotune_);
     attr_vector->emplace_back("buffer_size_min", buffer_size_min_);
     attr_vector->emplace_back("metadata", "");
+    attr_vector->emplace_back("stage_on_device", stage_on_device_);
     return OkStatus();
   }
 
@@ -73,6 +83,7 @@ class PrefetchDatasetParams : public DatasetParams {
   int64_t slack_period_;
   bool legacy_autotune_;
   int64_t buffer_size_min_;
+  bool stage_on_device_;
 };
 
 // Test case 1: positive buffer size.
@@ -89,6 +100,7 @@ PrefetchDatasetParams PrefetchDatasetParams1() {
       /*slack_period=*/0,
       /*legacy_autotune=*/true,
       /*buffer_size_min=*/0,
+      /*stage_on_device=*/false,
       /*node_name=*/kNodeName);
 }
 
@@ -106,6 +118,7 @@ PrefetchDatasetParams PrefetchDatasetParams2() {
       /*slack_period=*/0,
       /*legacy_autotune=*/true,
       /*buffer_size_min=*/0,
+      /*stage_on_device=*/false,
       /*node_name=*/kNodeName);
 }
 
@@ -123,6 +136,7 @@ PrefetchDatasetParams PrefetchDatasetParams3() {
       /*slack_period=*/0,
       /*legacy_autotune=*/true,
       /*buffer_size_min=*/0,
+      /*stage_on_device=*/false,
       /*node_name=*/kNodeName);
 }
 
@@ -140,6 +154,7 @@ PrefetchDatasetParams PrefetchDatasetParams4() {
       /*slack_period=*/5,
       /*legacy_autotune=*/true,
       /*buffer_size_min=*/0,
+      /*stage_on_device=*/false,
       /*node_name=*/kNodeName);
 }
 
@@ -157,6 +172,7 @@ PrefetchDatasetParams PrefetchDatasetParams5() {
       /*slack_period=*/5,
       /*legacy_autotune=*/false,
       /*buffer_size_min=*/0,
+      /*stage_on_device=*/false,
       /*node_name=*/kNodeName);
 }
 
@@ -174,6 +190,25 @@ PrefetchDatasetParams PrefetchDatasetParams6() {
       /*slack_period=*/0,
       /*legacy_autotune=*/true,
       /*buffer_size_min=*/3,
+      /*stage_on_device=*/false,
+      /*node_name=*/kNodeName);
+}
+
+// Test case 7: stage_on_device = true.
+PrefetchDatasetParams PrefetchDatasetParams7() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64_t>(TensorShape{10, 1},
+                                            {0, 1, 2, 3, 4, 5, 6, 7, 8, 9})},
+      /*node_name=*/"tensor_slice");
+  return PrefetchDatasetParams(
+      /*input_dataset_params=*/tensor_slice_dataset_params,
+      /*buffer_size=*/1,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({1})},
+      /*slack_period=*/0,
+      /*legacy_autotune=*/true,
+      /*buffer_size_min=*/0,
+      /*stage_on_device=*/true,
       /*node_name=*/kNodeName);
 }
 
@@ -190,6 +225,7 @@ PrefetchDatasetParams InvalidBufferSizePrefetchDatasetParams() {
       /*slack_period=*/0,
       /*legacy_autotune=*/true,
       /*buffer_size_min=*/0,
+      /*stage_on_device=*/false,
       /*node_name=*/kNodeName);
 }
 
@@ -221,6 +257,12 @@ std::vector<GetNextTestCase<PrefetchDatasetParams>> GetNextTestCases() {
       {/*dataset_params=*/
        PrefetchDatasetParams6(),
        /*expected_outputs=*/
+       CreateTensors<int64_t>(
+           TensorShape{1},
+           {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}})},
+      {/*dataset_params=*/
+       PrefetchDatasetParams7(),
+       /*expected_outputs=*/
        CreateTensors<int64_t>(
            TensorShape{1},
            {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}})}};
@@ -326,6 +368,106 @@ IteratorSaveAndRestoreTestCases() {
 ITERATOR_SAVE_AND_RESTORE_TEST_P(PrefetchDatasetOpTest, PrefetchDatasetParams,
                                  IteratorSaveAndRestoreTestCases())
 
+// An allocator standing for the host memory allocator of an accelerator, which
+// counts its allocations.
+class StagingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "staging"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocations_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  int64_t num_allocations() const { return num_allocations_; }
+
+ private:
+  std::atomic<int64_t> num_allocations_{0};
+};
+
+TEST_F(PrefetchDatasetOpTest, StageOnDevice) {
+  auto dataset_params = PrefetchDatasetParams7();
+  TF_ASSERT_OK(InitializeRuntime(dataset_params));
+  std::unique_ptr<TestDataset> dataset;
+  TF_ASSERT_OK(MakeDataset(dataset_params, &dataset));
+  std::unique_ptr<TestIterator> iterator;
+  TF_ASSERT_OK(MakeIterator(dataset_params, *dataset, &iterator));
+
+  StagingAllocator allocator;
+  IteratorContext::Params params(iterator->ctx());
+  params.allocator_getter = [&allocator](AllocatorAttributes attrs) {
+    return attrs.gpu_compatible() ? &allocator : cpu_allocator();
+  };
+  IteratorContext ctx(std::move(params));
+  int64_t expected = 0;
+  bool end_of_sequence = false;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator->iterator()->GetNext(&ctx, &next, &end_of_sequence));
+    if (end_of_sequence) {
+      break;
+    }
+    ASSERT_EQ(next.size(), 1);
+    TF_EXPECT_OK(
+        ExpectEqual(next[0], CreateTensor<int64_t>(TensorShape{1},
+                                                   {expected++})));
+    TensorDescription description;
+    next[0].FillDescription(&description);
+    EXPECT_EQ(description.allocation_description().allocator_name(),
+              "staging");
+  }
+  EXPECT_EQ(expected, 10);
+  // Elements are released before the next one is requested, so that the
+  // staging tensors are reused.
+  EXPECT_EQ(allocator.num_allocations(), 2);
+}
+
+TEST_F(PrefetchDatasetOpTest, StageOnDeviceWhileElementsAreHeld) {
+  auto dataset_params = PrefetchDatasetParams7();
+  TF_ASSERT_OK(InitializeRuntime(dataset_params));
+  std::unique_ptr<TestDataset> dataset;
+  TF_ASSERT_OK(MakeDataset(dataset_params, &dataset));
+  std::unique_ptr<TestIterator> iterator;
+  TF_ASSERT_OK(MakeIterator(dataset_params, *dataset, &iterator));
+
+  StagingAllocator allocator;
+  IteratorContext::Params params(iterator->ctx());
+  params.allocator_getter = [&allocator](AllocatorAttributes attrs) {
+    return attrs.gpu_compatible() ? &allocator : cpu_allocator();
+  };
+  IteratorContext ctx(std::move(params));
+  std::vector<Tensor> elements;
+  bool end_of_sequence = false;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator->iterator()->GetNext(&ctx, &next, &end_of_sequence));
+    if (!end_of_sequence) {
+      ASSERT_EQ(next.size(), 1);
+      elements.push_back(next[0]);
+    }
+  }
+  ASSERT_EQ(elements.size(), 10);
+  // The buffered element and the one held by the consumer are staged. Once
+  // the consumer holds on to both, no staging slot is free and the remaining
+  // elements are left as they are.
+  for (int64_t i = 0; i < 10; ++i) {
+    TF_EXPECT_OK(
+        ExpectEqual(elements[i], CreateTensor<int64_t>(TensorShape{1}, {i})));
+    TensorDescription description;
+    elements[i].FillDescription(&description);
+    EXPECT_EQ(description.allocation_description().allocator_name() ==
+                  "staging",
+              i < 2);
+  }
+  EXPECT_EQ(allocator.num_allocations(), 2);
+}
+
 TEST_F(PrefetchDatasetOpTest, InvalidBufferSize) {
   auto dataset_params = InvalidBufferSizePrefetchDatasetParams();
   EXPECT_EQ(Initialize(dataset_params).code(), error::INVALID_ARGUMENT);
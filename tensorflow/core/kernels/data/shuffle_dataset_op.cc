@@ -28,16 +28,21 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/random_seed_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/stringprintf.h"
 
 namespace tensorflow {
@@ -54,6 +59,9 @@ namespace data {
 /* static */ constexpr const char* const ShuffleDatasetOpBase::kOutputShapes;
 /* static */ constexpr const char* const
     ShuffleDatasetOpBase::kReshuffleEachIteration;
+/* static */ constexpr const char* const ShuffleDatasetOpBase::kSpillDirectory;
+/* static */ constexpr const char* const
+    ShuffleDatasetOpBase::kSpillMemoryBudget;
 
 /* static */ constexpr const char* const ShuffleDatasetOp::kDatasetType;
 
@@ -80,6 +88,14 @@ constexpr char kShuffleDatasetV2[] = "ShuffleDatasetV2";
 constexpr char kShuffleDatasetV3[] = "ShuffleDatasetV3";
 constexpr char kShuffleAndRepeatDatasetV1[] = "ShuffleAndRepeatDataset";
 constexpr char kShuffleAndRepeatDatasetV2[] = "ShuffleAndRepeatDatasetV2";
+constexpr char kEndOfInput[] = "end_of_input";
+constexpr char kNumRuns[] = "num_runs";
+constexpr char kRun[] = "run";
+constexpr char kRunSpilled[] = "run_spilled";
+// Version of the `snapshot_util` file format used for spilled runs. Version 2
+// writes TFRecords of `TensorProto`s, whose readers only hold a small input
+// buffer, so keeping one reader open per run does not break the memory bound.
+constexpr int kSpillFileVersion = 2;
 
 ShuffleDatasetOpBase::ShuffleDatasetOpBase(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx) {}
@@ -87,22 +103,56 @@ ShuffleDatasetOpBase::ShuffleDatasetOpBase(OpKernelConstruction* ctx)
 // Abstract base dataset that implements a shuffling iterator.
 class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
  public:
+  // Configures the optional spill-to-disk mode of the shuffle buffer.
+  struct SpillOptions {
+    // Local directory for scratch files. Spilling is disabled if empty.
+    std::string directory;
+    // Upper bound on the bytes of buffered elements held in memory.
+    int64_t memory_budget = 0;
+
+    bool enabled() const { return !directory.empty(); }
+  };
+
   ShuffleDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
                      int64_t buffer_size,
                      std::shared_ptr<SeedGenerator> seed_generator,
                      int64_t count)
+      : ShuffleDatasetBase(ctx, input, buffer_size, std::move(seed_generator),
+                           count, SpillOptions()) {}
+
+  ShuffleDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
+                     int64_t buffer_size,
+                     std::shared_ptr<SeedGenerator> seed_generator,
+                     int64_t count, SpillOptions spill_options)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         buffer_size_(buffer_size),
         seed_generator_(std::move(seed_generator)),
         count_(count),
+        spill_options_(std::move(spill_options)),
+        spill_root_(spill_options_.enabled()
+                        ? io::JoinPath(spill_options_.directory,
+                                       absl::StrCat("tf_data_shuffle_",
+                                                    random::New64()))
+                        : ""),
         traceme_metadata_(
             {{"buffer_size",
               strings::Printf("%lld", static_cast<long long>(buffer_size))}}) {
     input_->Ref();
   }
 
-  ~ShuffleDatasetBase() override { input_->Unref(); }
+  ~ShuffleDatasetBase() override {
+    input_->Unref();
+    if (!spill_root_.empty() && Env::Default()->FileExists(spill_root_).ok()) {
+      int64_t undeleted_files, undeleted_dirs;
+      Status s = Env::Default()->DeleteRecursively(
+          spill_root_, &undeleted_files, &undeleted_dirs);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to delete shuffle spill directory "
+                     << spill_root_ << ": " << s;
+      }
+    }
+  }
 
   virtual string op_type() const = 0;
 
@@ -160,6 +210,12 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
       const string& prefix) const override {
+    if (spill_options_.enabled()) {
+      return std::make_unique<SpillingIterator>(
+          SpillingIterator::Params{
+              this, name_utils::IteratorPrefix(op_type(), prefix)},
+          seed_generator_.get());
+    }
     return std::make_unique<Iterator>(
         Iterator::Params{this, name_utils::IteratorPrefix(op_type(), prefix)},
         seed_generator_.get());
@@ -581,6 +637,406 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
     bool data_produced_ TF_GUARDED_BY(mu_) = false;
   };
 
+  // Iterator used when spilling is enabled. Rather than maintaining a sliding
+  // window of `buffer_size` elements in memory, it consumes the input in
+  // windows of `buffer_size` elements (or of a whole epoch if the buffer size
+  // is unknown). Each window is cut into runs of roughly
+  // `spill_options_.memory_budget` bytes. Every run is shuffled in memory and,
+  // except for the last run of the window, written to a scratch file. The runs
+  // are then merged by repeatedly picking a run with probability proportional
+  // to the number of elements it has left, which yields a uniformly random
+  // permutation of the window while holding at most one run in memory.
+  //
+  // Checkpoints hold the remaining elements of every run, like the buffer of
+  // the in-memory iterator, so they do not depend on the scratch files. When
+  // restoring, the runs that had been spilled are spilled again.
+  class SpillingIterator : public DatasetIterator<ShuffleDatasetBase> {
+   public:
+    explicit SpillingIterator(const Params& params,
+                              SeedGenerator* seed_generator)
+        : DatasetIterator<ShuffleDatasetBase>(params),
+          seed_generator_(seed_generator),
+          file_prefix_(absl::StrCat("iterator_", random::New64())),
+          parent_generator_(seed_generator->seed(), seed_generator->seed2()),
+          generator_(&parent_generator_) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      seed_generator_->GenerateSeeds(&seed_, &seed2_);
+      ResetRngs();
+      return OkStatus();
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      while (num_remaining_ == 0) {
+        TF_RETURN_IF_ERROR(DeleteRuns(ctx));
+        if (end_of_input_) {
+          *end_of_sequence = true;
+          return OkStatus();
+        }
+        TF_RETURN_IF_ERROR(FillWindow(ctx));
+      }
+      *end_of_sequence = false;
+      // Choose a run with probability proportional to its number of remaining
+      // elements.
+      int64_t offset = Random() % num_remaining_;
+      for (auto& run : runs_) {
+        const int64_t run_remaining = run.num_elements - run.num_consumed;
+        if (offset < run_remaining) {
+          TF_RETURN_IF_ERROR(ReadFromRun(ctx, run, out_tensors));
+          num_remaining_--;
+          return OkStatus();
+        }
+        offset -= run_remaining;
+      }
+      return errors::Internal("Inconsistent shuffle run bookkeeping: ",
+                              num_remaining_, " elements remaining.");
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args),
+                                       /*ratio=*/1);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      // Save state needed to restore the random number generators.
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(prefix(), kEpochNumRandomSamples,
+                              seed_generator_->num_random_samples()));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kNumRandomSamples,
+                                             num_random_samples_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kSeed, seed_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kSeed2, seed2_));
+
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), kEndOfInputSequence, static_cast<int64_t>(!input_impl_)));
+      if (input_impl_) {
+        TF_RETURN_IF_ERROR(this->SaveInput(ctx, writer, input_impl_));
+      }
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kEpoch, epoch_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), kEndOfInput, static_cast<int64_t>(end_of_input_)));
+      if (data_produced_) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kDataProduced, ""));
+      }
+
+      // Save the remaining elements of the runs of the current window. Spilled
+      // runs are read back one at a time.
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kNumRuns, runs_.size()));
+      for (size_t i = 0; i < runs_.size(); ++i) {
+        const Run& run = runs_[i];
+        std::vector<std::vector<Tensor>> remaining;
+        if (run.filename.empty()) {
+          remaining.assign(memory_run_.begin() + run.num_consumed,
+                           memory_run_.end());
+        } else {
+          TF_RETURN_IF_ERROR(
+              ReadRemainingFromRun(Env::Default(), run, &remaining));
+        }
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            prefix(), absl::StrJoin(std::make_tuple(kRunSpilled, i), "_"),
+            static_cast<int64_t>(!run.filename.empty())));
+        TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(
+            writer,
+            absl::StrCat(prefix(), kColon,
+                         absl::StrJoin(std::make_tuple(kRun, i), "_")),
+            remaining));
+      }
+      return OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      // Restore the random number generators.
+      int64_t num_random_samples;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kEpochNumRandomSamples,
+                                            &num_random_samples));
+      seed_generator_->set_num_random_samples(num_random_samples);
+      seed_generator_->Reset();
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kNumRandomSamples,
+                                            &num_random_samples_));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kSeed, &seed_));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kSeed2, &seed2_));
+      ResetRngs();
+
+      int64_t input_empty;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kEndOfInputSequence, &input_empty));
+      if (static_cast<bool>(!input_empty)) {
+        TF_RETURN_IF_ERROR(this->dataset()->input_->MakeIterator(
+            ctx, this, this->prefix(), &input_impl_));
+        TF_RETURN_IF_ERROR(this->RestoreInput(ctx, reader, input_impl_));
+      } else {
+        input_impl_.reset();
+      }
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kEpoch, &epoch_));
+      int64_t end_of_input;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kEndOfInput, &end_of_input));
+      end_of_input_ = static_cast<bool>(end_of_input);
+      data_produced_ = reader->Contains(prefix(), kDataProduced);
+
+      int64_t num_runs;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kNumRuns, &num_runs));
+      TF_RETURN_IF_ERROR(DeleteRuns(ctx));
+      num_remaining_ = 0;
+      for (int64_t i = 0; i < num_runs; ++i) {
+        int64_t spilled;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            prefix(), absl::StrJoin(std::make_tuple(kRunSpilled, i), "_"),
+            &spilled));
+        std::vector<std::vector<Tensor>> elements;
+        TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
+            ctx, reader,
+            absl::StrCat(prefix(), kColon,
+                         absl::StrJoin(std::make_tuple(kRun, i), "_")),
+            &elements));
+        if (spilled) {
+          TF_RETURN_IF_ERROR(WriteRun(ctx, &elements));
+          continue;
+        }
+        for (const auto& element : elements) {
+          RecordBufferEnqueue(ctx, element);
+        }
+        Run memory_run;
+        memory_run.num_elements = elements.size();
+        num_remaining_ += elements.size();
+        runs_.push_back(std::move(memory_run));
+        memory_run_ = std::move(elements);
+      }
+      return OkStatus();
+    }
+
+    TraceMeMetadata GetTraceMeMetadata() const override {
+      return this->dataset()->traceme_metadata_;
+    }
+
+   private:
+    // A shuffled run of elements. Runs with an empty `filename` are held in
+    // `memory_run_`; all other runs have been spilled to `filename`.
+    struct Run {
+      std::string filename;
+      int64_t num_elements = 0;
+      int64_t num_consumed = 0;
+      // Lazily opened reader positioned at element `num_consumed`.
+      std::unique_ptr<snapshot_util::Reader> reader;
+    };
+
+    void ResetRngs() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      parent_generator_ = random::PhiloxRandom(seed_, seed2_);
+      generator_ =
+          random::SingleSampleAdapter<random::PhiloxRandom>(&parent_generator_);
+      generator_.Skip(num_random_samples_);
+    }
+
+    random::SingleSampleAdapter<random::PhiloxRandom>::ResultType Random()
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      num_random_samples_++;
+      return generator_();
+    }
+
+    bool IsShuffleAll() const {
+      return dataset()->buffer_size_ == kUnknownCardinality;
+    }
+
+    // Reads the next window of the input and splits it into shuffled runs.
+    Status FillWindow(IteratorContext* ctx) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      std::vector<std::vector<Tensor>> run;
+      int64_t run_bytes = 0;
+      int64_t num_read = 0;
+      while (IsShuffleAll() || num_read < dataset()->buffer_size_) {
+        if (!input_impl_) {
+          if (dataset()->count_ != -1 && epoch_ >= dataset()->count_) {
+            end_of_input_ = true;
+            break;
+          }
+          TF_RETURN_IF_ERROR(PrepareNextEpoch(ctx));
+        }
+        std::vector<Tensor> element;
+        bool end_of_input_sequence = false;
+        TF_RETURN_IF_ERROR(
+            input_impl_->GetNext(ctx, &element, &end_of_input_sequence));
+        if (end_of_input_sequence) {
+          input_impl_.reset();
+          if (ctx->split_providers().empty() && !data_produced_ &&
+              this->dataset()->count_ == -1) {
+            // Avoid looping forever over an input that produces no data.
+            end_of_input_ = true;
+            break;
+          }
+          if (IsShuffleAll()) {
+            break;
+          }
+          continue;
+        }
+        data_produced_ = true;
+        run_bytes += GetTotalBytes(element);
+        run.push_back(std::move(element));
+        num_read++;
+        if (run_bytes >= dataset()->spill_options_.memory_budget) {
+          TF_RETURN_IF_ERROR(SpillRun(ctx, &run));
+          run_bytes = 0;
+        }
+      }
+      if (!run.empty()) {
+        // Keep the last run of the window in memory.
+        ShuffleRun(&run);
+        for (const auto& element : run) {
+          RecordBufferEnqueue(ctx, element);
+        }
+        Run memory_run;
+        memory_run.num_elements = run.size();
+        num_remaining_ += run.size();
+        runs_.push_back(std::move(memory_run));
+        memory_run_ = std::move(run);
+      }
+      return OkStatus();
+    }
+
+    Status PrepareNextEpoch(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (epoch_ > 0) {
+        for (const auto& provider : ctx->split_providers()) {
+          TF_RETURN_IF_ERROR(provider->Reset());
+        }
+        // Reinitialize the RNG state for the next epoch.
+        num_random_samples_ = 0;
+        seed_generator_->GenerateSeeds(&seed_, &seed2_);
+        ResetRngs();
+      }
+      TF_RETURN_IF_ERROR(this->dataset()->input_->MakeIterator(
+          ctx, this, this->prefix(), &input_impl_));
+      epoch_++;
+      return OkStatus();
+    }
+
+    // Shuffles `run` in place using the Fisher-Yates algorithm.
+    void ShuffleRun(std::vector<std::vector<Tensor>>* run)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (int64_t i = run->size() - 1; i > 0; --i) {
+        const int64_t j = Random() % (i + 1);
+        std::swap((*run)[i], (*run)[j]);
+      }
+    }
+
+    // Shuffles `run` and writes it to a new scratch file.
+    Status SpillRun(IteratorContext* ctx, std::vector<std::vector<Tensor>>* run)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      ShuffleRun(run);
+      return WriteRun(ctx, run);
+    }
+
+    // Writes the already shuffled `run` to a new scratch file and appends it
+    // to `runs_`.
+    Status WriteRun(IteratorContext* ctx, std::vector<std::vector<Tensor>>* run)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      TF_RETURN_IF_ERROR(
+          ctx->env()->RecursivelyCreateDir(dataset()->spill_root_));
+      Run spilled_run;
+      spilled_run.filename = io::JoinPath(
+          dataset()->spill_root_,
+          absl::StrCat(file_prefix_, "_", num_spilled_runs_++, ".run"));
+      spilled_run.num_elements = run->size();
+      std::unique_ptr<snapshot_util::Writer> writer;
+      TF_RETURN_IF_ERROR(snapshot_util::Writer::Create(
+          ctx->env(), spilled_run.filename, io::compression::kNone,
+          kSpillFileVersion, dataset()->output_dtypes(), &writer));
+      for (const auto& element : *run) {
+        TF_RETURN_IF_ERROR(writer->WriteTensors(element));
+      }
+      TF_RETURN_IF_ERROR(writer->Close());
+      VLOG(2) << "Spilled " << run->size() << " shuffle buffer elements to "
+              << spilled_run.filename;
+      num_remaining_ += run->size();
+      runs_.push_back(std::move(spilled_run));
+      run->clear();
+      return OkStatus();
+    }
+
+    // Reads the elements of the spilled `run` that have not been produced,
+    // without moving its reader.
+    Status ReadRemainingFromRun(Env* env, const Run& run,
+                                std::vector<std::vector<Tensor>>* elements)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      std::unique_ptr<snapshot_util::Reader> reader;
+      TF_RETURN_IF_ERROR(snapshot_util::Reader::Create(
+          env, run.filename, io::compression::kNone, kSpillFileVersion,
+          dataset()->output_dtypes(), &reader));
+      TF_RETURN_IF_ERROR(reader->SkipRecords(run.num_consumed));
+      elements->resize(run.num_elements - run.num_consumed);
+      for (auto& element : *elements) {
+        TF_RETURN_IF_ERROR(reader->ReadTensors(&element));
+      }
+      return OkStatus();
+    }
+
+    Status ReadFromRun(IteratorContext* ctx, Run& run,
+                       std::vector<Tensor>* out_tensors)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (run.filename.empty()) {
+        *out_tensors = std::move(memory_run_[run.num_consumed]);
+        RecordBufferDequeue(ctx, *out_tensors);
+      } else {
+        if (!run.reader) {
+          TF_RETURN_IF_ERROR(snapshot_util::Reader::Create(
+              ctx->env(), run.filename, io::compression::kNone,
+              kSpillFileVersion, dataset()->output_dtypes(), &run.reader));
+          TF_RETURN_IF_ERROR(run.reader->SkipRecords(run.num_consumed));
+        }
+        TF_RETURN_IF_ERROR(run.reader->ReadTensors(out_tensors));
+      }
+      run.num_consumed++;
+      return OkStatus();
+    }
+
+    // Deletes the scratch files of the current window once it is drained.
+    Status DeleteRuns(IteratorContext* ctx) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (auto& run : runs_) {
+        if (run.filename.empty()) {
+          continue;
+        }
+        run.reader.reset();
+        Status s = ctx->env()->DeleteFile(run.filename);
+        if (!s.ok() && !errors::IsNotFound(s)) {
+          return s;
+        }
+      }
+      runs_.clear();
+      memory_run_.clear();
+      return OkStatus();
+    }
+
+    mutex mu_;
+    SeedGenerator* const seed_generator_ TF_GUARDED_BY(mu_);  // Not owned.
+    // Unique prefix for the names of the scratch files of this iterator.
+    const std::string file_prefix_;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_) = nullptr;
+    // The runs of the window currently being produced.
+    std::vector<Run> runs_ TF_GUARDED_BY(mu_);
+    std::vector<std::vector<Tensor>> memory_run_ TF_GUARDED_BY(mu_);
+    // Number of elements of the current window that have not been produced.
+    int64_t num_remaining_ TF_GUARDED_BY(mu_) = 0;
+    int64_t num_spilled_runs_ TF_GUARDED_BY(mu_) = 0;
+    int64_t epoch_ TF_GUARDED_BY(mu_) = 0;
+    int64_t seed_ TF_GUARDED_BY(mu_) = 0;
+    int64_t seed2_ TF_GUARDED_BY(mu_) = 0;
+    random::PhiloxRandom parent_generator_ TF_GUARDED_BY(mu_);
+    random::SingleSampleAdapter<random::PhiloxRandom> generator_
+        TF_GUARDED_BY(mu_);
+    int64_t num_random_samples_ TF_GUARDED_BY(mu_) = 0;
+    bool data_produced_ TF_GUARDED_BY(mu_) = false;
+    // Whether all epochs of the input have been consumed.
+    bool end_of_input_ TF_GUARDED_BY(mu_) = false;
+  };
+
   const DatasetBase* const input_;
   const int64_t buffer_size_;
   const std::shared_ptr<SeedGenerator> seed_generator_;
@@ -588,6 +1044,10 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   // fuse shuffle and repeat together, and make the shuffle dataset op
   // responsible for repeating as well.
   const int64_t count_;
+  const SpillOptions spill_options_;
+  // Directory owned by this dataset that holds the scratch files of all its
+  // iterators. It is removed when the dataset is destroyed.
+  const std::string spill_root_;
   const TraceMeMetadata traceme_metadata_;
   mutable mutex mu_;
   mutable std::vector<std::int64_t> shuffled_indices_ TF_GUARDED_BY(mu_);
@@ -713,8 +1173,10 @@ class ShuffleDatasetOp::DatasetV3 : public ShuffleDatasetBase {
  public:
   DatasetV3(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
             int64_t count, RandomSeeds&& seeds, SeedGeneratorManager* manager,
-            ResourceHandle&& resource_handle, bool owns_resource)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+            ResourceHandle&& resource_handle, bool owns_resource,
+            SpillOptions spill_options)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           std::move(spill_options)),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -753,12 +1215,19 @@ class ShuffleDatasetOp::DatasetV3 : public ShuffleDatasetBase {
     AttrValue reshuffle_each_iteration;
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
+    AttrValue spill_directory;
+    b->BuildAttrValue(spill_options_.directory, &spill_directory);
+    AttrValue spill_memory_budget;
+    b->BuildAttrValue(spill_options_.memory_budget, &spill_memory_budget);
     TF_RETURN_IF_ERROR(
         b->AddDataset(this,
                       {input_graph_node, buffer_size_node, seed_node,
                        seed2_node, resource_handle_node},  // Inputs
                       {std::make_pair(kReshuffleEachIteration,
-                                      reshuffle_each_iteration)},  // Attrs
+                                      reshuffle_each_iteration),
+                       std::make_pair(kSpillDirectory, spill_directory),
+                       std::make_pair(kSpillMemoryBudget,
+                                      spill_memory_budget)},  // Attrs
                       output));
     return OkStatus();
   }
@@ -785,6 +1254,16 @@ ShuffleDatasetOp::ShuffleDatasetOp(OpKernelConstruction* ctx)
     OP_REQUIRES_OK(
         ctx, ctx->GetAttr(kReshuffleEachIteration, &reshuffle_each_iteration_));
   }
+  if (ctx->HasAttr(kSpillDirectory)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kSpillDirectory, &spill_directory_));
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr(kSpillMemoryBudget, &spill_memory_budget_));
+    OP_REQUIRES(ctx, spill_directory_.empty() || spill_memory_budget_ > 0,
+                errors::InvalidArgument(
+                    "`spill_memory_budget` must be greater than zero when "
+                    "`spill_directory` is set, but got ",
+                    spill_memory_budget_));
+  }
 }
 
 void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
@@ -835,10 +1314,14 @@ void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
       OP_REQUIRES_OK(ctx, s);
     }
 
+    ShuffleDatasetBase::SpillOptions spill_options;
+    spill_options.directory = spill_directory_;
+    spill_options.memory_budget = spill_memory_budget_;
+
     // Ownership of manager is transferred onto `DatasetV3`.
-    *output = new ShuffleDatasetOp::DatasetV3(ctx, input, buffer_size, count,
-                                              std::move(seeds), manager,
-                                              std::move(handle), owns_resource);
+    *output = new ShuffleDatasetOp::DatasetV3(
+        ctx, input, buffer_size, count, std::move(seeds), manager,
+        std::move(handle), owns_resource, std::move(spill_options));
   } else if (op_version_ == 2) {
     auto handle = HandleFromInput(ctx, 2);
     SeedGeneratorManager* manager = nullptr;
@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_SHUFFLE_DATASET_OP_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_SHUFFLE_DATASET_OP_H_
 
+#include <string>
+
 #include "tensorflow/core/framework/dataset.h"
 
 namespace tensorflow {
@@ -30,6 +32,9 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
   static constexpr const char* const kOutputShapes = "output_shapes";
   static constexpr const char* const kReshuffleEachIteration =
       "reshuffle_each_iteration";
+  static constexpr const char* const kSpillDirectory = "spill_directory";
+  static constexpr const char* const kSpillMemoryBudget =
+      "spill_memory_budget";
 
   explicit ShuffleDatasetOpBase(OpKernelConstruction* ctx);
 
@@ -53,6 +58,10 @@ class ShuffleDatasetOp : public ShuffleDatasetOpBase {
   class DatasetV3;
   int op_version_ = 0;
   bool reshuffle_each_iteration_ = true;
+  // If non-empty, the shuffle buffer is spilled to scratch files in this
+  // directory, holding at most `spill_memory_budget_` bytes in memory.
+  std::string spill_directory_;
+  int64_t spill_memory_budget_ = 0;
 };
 
 class ShuffleAndRepeatDatasetOp : public ShuffleDatasetOpBase {
@@ -98,6 +98,68 @@ class ShuffleDatasetParams : public DatasetParams {
   bool reshuffle_each_iteration_;
 };
 
+// Parameters for `ShuffleDatasetV3` with the spill-to-disk mode enabled.
+class SpillingShuffleDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  SpillingShuffleDatasetParams(T input_dataset_params, int64_t buffer_size,
+                               int64_t seed, int64_t seed2,
+                               string spill_directory,
+                               int64_t spill_memory_budget,
+                               DataTypeVector output_dtypes,
+                               std::vector<PartialTensorShape> output_shapes,
+                               string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        buffer_size_(buffer_size),
+        seed_(seed),
+        seed2_(seed2),
+        spill_directory_(std::move(spill_directory)),
+        spill_memory_budget_(spill_memory_budget) {
+    op_version_ = 3;
+    input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {CreateTensor<int64_t>(TensorShape({}), {buffer_size_}),
+            CreateTensor<int64_t>(TensorShape({}), {seed_}),
+            CreateTensor<int64_t>(TensorShape({}), {seed2_}),
+            CreateTensor<ResourceHandle>(TensorShape({}), {ResourceHandle()})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {ShuffleDatasetOpBase::kInputDataset,
+                    ShuffleDatasetOpBase::kBufferSize,
+                    ShuffleDatasetOpBase::kSeed, ShuffleDatasetOpBase::kSeed2,
+                    "seed_generator"};
+    return OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{"output_types", output_dtypes_},
+                    {"output_shapes", output_shapes_},
+                    {"reshuffle_each_iteration", false},
+                    {"metadata", ""},
+                    {"spill_directory", spill_directory_},
+                    {"spill_memory_budget", spill_memory_budget_}};
+    return OkStatus();
+  }
+
+  string dataset_type() const override {
+    return ShuffleDatasetOp::kDatasetType;
+  }
+
+ private:
+  int64_t buffer_size_;
+  int64_t seed_;
+  int64_t seed2_;
+  string spill_directory_;
+  int64_t spill_memory_budget_;
+};
+
 class ShuffleDatasetOpTest : public DatasetOpsTestBase {};
 
 // Test case 1: test shuffle_dataset with reshuffle_each_iteration = false.
@@ -583,6 +645,133 @@ INSTANTIATE_TEST_CASE_P(ShuffleDatasetOpTest,
                         ParameterizedIteratorSaveAndRestoreTest,
                         ::testing::ValuesIn(IteratorSaveAndRestoreTestCases()));
 
+// Each scalar int64 element takes 8 bytes, so a budget of 24 bytes spills a
+// run every three elements.
+SpillingShuffleDatasetParams SpillingShuffleDatasetParams1() {
+  return SpillingShuffleDatasetParams(
+      RangeDatasetParams(0, 20, 1),
+      /*buffer_size=*/8,
+      /*seed=*/1,
+      /*seed2=*/2,
+      /*spill_directory=*/testing::TmpDir(),
+      /*spill_memory_budget=*/24,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kShuffleNodeName);
+}
+
+SpillingShuffleDatasetParams SpillingShuffleDatasetParamsShuffleAll() {
+  return SpillingShuffleDatasetParams(
+      RangeDatasetParams(0, 20, 1),
+      /*buffer_size=*/kUnknownCardinality,
+      /*seed=*/1,
+      /*seed2=*/2,
+      /*spill_directory=*/testing::TmpDir(),
+      /*spill_memory_budget=*/24,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kShuffleNodeName);
+}
+
+class ParameterizedSpillingShuffleTest
+    : public ShuffleDatasetOpTest,
+      public ::testing::WithParamInterface<SpillingShuffleDatasetParams> {};
+
+TEST_P(ParameterizedSpillingShuffleTest, ProducesPermutation) {
+  TF_ASSERT_OK(Initialize(GetParam()));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+  }
+  std::vector<Tensor> expected_outputs;
+  for (int64_t i = 0; i < 20; ++i) {
+    expected_outputs.push_back(CreateTensor<int64_t>(TensorShape({}), {i}));
+  }
+  TF_EXPECT_OK(ExpectEqual(out_tensors, expected_outputs,
+                           /*compare_order=*/false));
+}
+
+TEST_P(ParameterizedSpillingShuffleTest, IteratorSaveAndRestore) {
+  auto dataset_params = GetParam();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  // The seeds are fixed, so an uninterrupted pass defines the expected order.
+  bool end_of_sequence = false;
+  std::vector<Tensor> expected_outputs;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    expected_outputs.insert(expected_outputs.end(), next.begin(), next.end());
+  }
+  TF_ASSERT_OK(CheckIteratorSaveAndRestore(
+      dataset_params.iterator_prefix(), expected_outputs,
+      /*breakpoints=*/{0, 2, 7, 13, 25}, /*compare_order=*/true));
+}
+
+TEST_F(ShuffleDatasetOpTest, SpillingRestoresAfterDatasetIsDestroyed) {
+  auto dataset_params = SpillingShuffleDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  // The seeds are fixed, so an uninterrupted pass defines the expected order.
+  bool end_of_sequence = false;
+  std::vector<Tensor> expected_outputs;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    expected_outputs.insert(expected_outputs.end(), next.begin(), next.end());
+  }
+
+  // Stop in the middle of the first window, after two of its runs have been
+  // spilled, and save the iterator.
+  std::unique_ptr<TestDataset> dataset;
+  TF_ASSERT_OK(MakeDataset(dataset_params, &dataset));
+  std::unique_ptr<TestIterator> iterator;
+  TF_ASSERT_OK(MakeIterator(dataset_params, *dataset, &iterator));
+  std::vector<Tensor> out_tensors;
+  for (int i = 0; i < 5; ++i) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(iterator->GetNext(&next, &end_of_sequence));
+    out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+  }
+  std::unique_ptr<SerializationContext> serialization_ctx;
+  TF_ASSERT_OK(CreateSerializationContext(&serialization_ctx));
+  VariantTensorDataWriter writer;
+  TF_ASSERT_OK(iterator->iterator()->Save(serialization_ctx.get(), &writer));
+  std::vector<const VariantTensorData*> data;
+  writer.GetData(&data);
+
+  // Destroying the dataset deletes the scratch files of its runs.
+  iterator.reset();
+  dataset.reset();
+
+  TF_ASSERT_OK(MakeDataset(dataset_params, &dataset));
+  TF_ASSERT_OK(MakeIterator(dataset_params, *dataset, &iterator));
+  VariantTensorDataReader reader(data);
+  std::unique_ptr<IteratorBase> restored_iterator;
+  TF_ASSERT_OK(RestoreIterator(iterator->ctx(), &reader,
+                               dataset_params.iterator_prefix(),
+                               *dataset->dataset(), &restored_iterator));
+  end_of_sequence = false;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        restored_iterator->GetNext(iterator->ctx(), &next, &end_of_sequence));
+    out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+  }
+  TF_EXPECT_OK(ExpectEqual(out_tensors, expected_outputs,
+                           /*compare_order=*/true));
+}
+
+INSTANTIATE_TEST_CASE_P(
+    ShuffleDatasetOpTest, ParameterizedSpillingShuffleTest,
+    ::testing::ValuesIn(std::vector<SpillingShuffleDatasetParams>(
+        {SpillingShuffleDatasetParams1(),
+         SpillingShuffleDatasetParamsShuffleAll()})));
+
 TEST_F(ShuffleDatasetOpTest, InvalidArguments) {
   std::vector<ShuffleDatasetParams> dataset_params_vec(
       {ShuffleDatasetParamsWithInvalidBufferSize(),
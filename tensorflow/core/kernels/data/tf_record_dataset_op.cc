@@ -14,17 +14,31 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/strings/match.h"
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/shared_read_cache.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace data {
@@ -37,6 +51,10 @@ namespace data {
 /* static */ constexpr const char* const TFRecordDatasetOp::kCompressionType;
 /* static */ constexpr const char* const TFRecordDatasetOp::kBufferSize;
 /* static */ constexpr const char* const TFRecordDatasetOp::kByteOffsets;
+/* static */ constexpr const char* const TFRecordDatasetOp::kUseMemoryMap;
+/* static */ constexpr const char* const TFRecordDatasetOp::kUseIndex;
+/* static */ constexpr const char* const TFRecordDatasetOp::kUseSharedCache;
+/* static */ constexpr const char* const TFRecordDatasetOp::kAsyncReadahead;
 
 constexpr char kTFRecordDataset[] = "TFRecordDataset";
 constexpr char kCurrentFileIndex[] = "current_file_index";
@@ -54,20 +72,174 @@ bool is_cloud_tpu_gcs_fs() {
   return false;
 }
 
+namespace {
+
+// Inflates the blocks of block-compressed ZLIB and GZIP files for all TFRecord
+// datasets in the process.
+thread::ThreadPool* DecompressionThreadPool() {
+  static thread::ThreadPool* thread_pool = new thread::ThreadPool(
+      Env::Default(), "tf_record_inflate", port::MaxParallelism());
+  return thread_pool;
+}
+
+// Buffer of a scalar string tensor whose value is a view of a record in a
+// memory-mapped file. The buffer holds a reference to the mapping, so that the
+// view remains valid for as long as the tensor is alive.
+class MemmappedRecordBuffer : public TensorBuffer {
+ public:
+  MemmappedRecordBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                        StringPiece record)
+      : TensorBuffer(&value_), region_(std::move(region)) {
+    value_.assign_as_view(record.data(), record.size());
+  }
+
+  size_t size() const override { return sizeof(tstring); }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size());
+    proto->set_allocator_name("MemmappedRecordBuffer");
+  }
+
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  tstring value_;
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+};
+
+// Reads uncompressed TFRecords from a memory-mapped file. Unlike
+// `io::SequentialRecordReader`, records are not copied out of the file:
+// `ReadRecord` produces string tensors that alias the mapping.
+class MemmappedRecordReader {
+ public:
+  // `region` may be null for an empty file.
+  explicit MemmappedRecordReader(std::unique_ptr<ReadOnlyMemoryRegion> region)
+      : region_(std::move(region)) {}
+
+  // Reads the record at the current offset into `record` and advances the
+  // offset. Returns OUT_OF_RANGE at the end of the file.
+  Status ReadRecord(Tensor* record) {
+    StringPiece data;
+    TF_RETURN_IF_ERROR(ReadRecordView(&data));
+    *record = Tensor(DT_STRING, TensorShape({}),
+                     core::RefCountPtr<TensorBuffer>(
+                         new MemmappedRecordBuffer(region_, data)));
+    return OkStatus();
+  }
+
+  // Skips up to `num_to_skip` records, returning OUT_OF_RANGE if the end of
+  // the file is reached first.
+  Status SkipRecords(int num_to_skip, int* num_skipped) {
+    *num_skipped = 0;
+    StringPiece data;
+    while (*num_skipped < num_to_skip) {
+      TF_RETURN_IF_ERROR(ReadRecordView(&data));
+      ++*num_skipped;
+    }
+    return OkStatus();
+  }
+
+  uint64 TellOffset() const { return offset_; }
+
+  void SeekOffset(uint64 offset) { offset_ = offset; }
+
+ private:
+  using RecordReader = io::RecordReader;
+
+  Status ReadRecordView(StringPiece* record) {
+    const uint64 length = region_ ? region_->length() : 0;
+    if (offset_ >= length) {
+      return errors::OutOfRange("eof");
+    }
+    const uint64 remaining = length - offset_;
+    if (remaining < RecordReader::kHeaderSize + RecordReader::kFooterSize) {
+      return errors::DataLoss("truncated record at ", offset_);
+    }
+    const char* header = static_cast<const char*>(region_->data()) + offset_;
+    const uint32 masked_length_crc =
+        core::DecodeFixed32(header + sizeof(uint64));
+    if (crc32c::Unmask(masked_length_crc) !=
+        crc32c::Value(header, sizeof(uint64))) {
+      return errors::DataLoss("corrupted record at ", offset_);
+    }
+    const uint64 record_length = core::DecodeFixed64(header);
+    if (record_length > remaining - RecordReader::kHeaderSize -
+                            RecordReader::kFooterSize) {
+      return errors::DataLoss("truncated record at ", offset_);
+    }
+    const char* data = header + RecordReader::kHeaderSize;
+    const uint32 masked_data_crc = core::DecodeFixed32(data + record_length);
+    if (crc32c::Unmask(masked_data_crc) !=
+        crc32c::Value(data, record_length)) {
+      return errors::DataLoss("corrupted record at ", offset_);
+    }
+    *record = StringPiece(data, record_length);
+    offset_ += RecordReader::kHeaderSize + record_length +
+               RecordReader::kFooterSize;
+    return OkStatus();
+  }
+
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  uint64 offset_ = 0;
+};
+
+}  // namespace
+
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
                    const string& compression_type, int64_t buffer_size,
-                   std::vector<int64_t> byte_offsets, int op_version)
+                   std::vector<int64_t> byte_offsets, bool use_memory_map,
+                   bool use_index, bool use_shared_cache,
+                   bool async_readahead,
+                   std::vector<std::vector<io::RecordIndexEntry>> indexes,
+                   int op_version)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
             compression_type)),
         byte_offsets_(std::move(byte_offsets)),
+        use_memory_map_(use_memory_map),
+        use_index_(use_index),
+        use_shared_cache_(use_shared_cache),
+        async_readahead_(async_readahead),
+        indexes_(std::move(indexes)),
+        files_(indexes_.size()),
         op_version_(op_version) {
+    if (use_index_) {
+      file_offsets_.reserve(indexes_.size() + 1);
+      file_offsets_.push_back(0);
+      for (const auto& index : indexes_) {
+        file_offsets_.push_back(file_offsets_.back() + index.size());
+      }
+    }
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
+      // With `async_readahead`, the next buffer is read while the current
+      // one is parsed. Only local files support asynchronous reads; other
+      // file systems read synchronously and would only pay for the second
+      // buffer.
+      options_.async_readahead =
+          async_readahead &&
+          absl::c_all_of(filenames_, [](const string& filename) {
+            return !absl::StrContains(filename, "://") ||
+                   absl::StartsWith(filename, "file://");
+          });
+    }
+    if (options_.compression_type ==
+        io::RecordReaderOptions::ZLIB_COMPRESSION) {
+      // Block-compressed files are inflated ahead of the reader in parallel.
+      options_.decompression_thread_pool = DecompressionThreadPool();
+    }
+    reader_options_ = options_;
+    if (use_shared_cache_ && options_.compression_type ==
+                                 io::RecordReaderOptions::ZLIB_COMPRESSION) {
+      // The shared cache serves the records decompressed.
+      reader_options_.compression_type = io::RecordReaderOptions::NONE;
+      reader_options_.decompression_thread_pool = nullptr;
     }
   }
 
@@ -96,12 +268,44 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     return name_utils::DatasetDebugString(kDatasetType, params);
   }
 
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    if (!use_index_) {
+      return kUnknownCardinality;
+    }
+    return file_offsets_.back();
+  }
+
   Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
     return OkStatus();
   }
 
   Status CheckExternalState() const override { return OkStatus(); }
 
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    if (!use_index_) {
+      return errors::Unimplemented(
+          "Random access to a TFRecordDataset requires `use_index`.");
+    }
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    // The file holding `index` is the last one starting at or before it.
+    const size_t file_index =
+        std::upper_bound(file_offsets_.begin(), file_offsets_.end(), index) -
+        file_offsets_.begin() - 1;
+    RandomAccessFile* file;
+    TF_RETURN_IF_ERROR(GetFile(ctx->env(), file_index, &file));
+    Tensor record(ctx->get_allocator({}), DT_STRING, TensorShape({}));
+    TF_RETURN_IF_ERROR(io::ReadIndexedRecord(
+        file, indexes_[file_index][index - file_offsets_[file_index]],
+        &record.scalar<tstring>()()));
+    static monitoring::CounterCell* bytes_counter =
+        metrics::GetTFDataBytesReadCounter(kDatasetType);
+    bytes_counter->IncrementBy(record.scalar<tstring>()().size());
+    out_tensors->clear();
+    out_tensors->push_back(std::move(record));
+    return OkStatus();
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -112,8 +316,29 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
     Node* buffer_size = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
+    std::vector<std::pair<StringPiece, AttrValue>> attrs;
+    if (use_memory_map_) {
+      AttrValue use_memory_map;
+      b->BuildAttrValue(use_memory_map_, &use_memory_map);
+      attrs.emplace_back(kUseMemoryMap, use_memory_map);
+    }
+    if (use_index_) {
+      AttrValue use_index;
+      b->BuildAttrValue(use_index_, &use_index);
+      attrs.emplace_back(kUseIndex, use_index);
+    }
+    if (use_shared_cache_) {
+      AttrValue use_shared_cache;
+      b->BuildAttrValue(use_shared_cache_, &use_shared_cache);
+      attrs.emplace_back(kUseSharedCache, use_shared_cache);
+    }
+    if (async_readahead_) {
+      AttrValue async_readahead;
+      b->BuildAttrValue(async_readahead_, &async_readahead);
+      attrs.emplace_back(kAsyncReadahead, async_readahead);
+    }
     TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {filenames, compression_type, buffer_size}, output));
+        this, {filenames, compression_type, buffer_size}, attrs, output));
     Node* byte_offsets = nullptr;
     TF_RETURN_IF_ERROR(b->AddVector(byte_offsets_, &byte_offsets));
     return OkStatus();
@@ -134,11 +359,16 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       mutex_lock l(mu_);
       do {
         // We are currently processing a file, so try to read the next record.
-        if (reader_) {
-          out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
-                                    TensorShape({}));
-          Status s =
-              reader_->ReadRecord(&out_tensors->back().scalar<tstring>()());
+        if (reader_ || memmapped_reader_) {
+          Status s;
+          if (memmapped_reader_) {
+            out_tensors->emplace_back();
+            s = memmapped_reader_->ReadRecord(&out_tensors->back());
+          } else {
+            out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
+                                      TensorShape({}));
+            s = reader_->ReadRecord(&out_tensors->back().scalar<tstring>()());
+          }
           if (s.ok()) {
             static monitoring::CounterCell* bytes_counter =
                 metrics::GetTFDataBytesReadCounter(kDatasetType);
@@ -177,13 +407,20 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
                         bool* end_of_sequence, int* num_skipped) override {
       *num_skipped = 0;
       mutex_lock l(mu_);
+      if (dataset()->use_index_) {
+        return SkipWithIndexLocked(ctx->env(), num_to_skip, end_of_sequence,
+                                   num_skipped);
+      }
       do {
         // We are currently processing a file, so try to skip reading
         // the next (num_to_skip - *num_skipped) record.
-        if (reader_) {
+        if (reader_ || memmapped_reader_) {
           int last_num_skipped;
-          Status s = reader_->SkipRecords(num_to_skip - *num_skipped,
-                                          &last_num_skipped);
+          Status s = memmapped_reader_
+                         ? memmapped_reader_->SkipRecords(
+                               num_to_skip - *num_skipped, &last_num_skipped)
+                         : reader_->SkipRecords(num_to_skip - *num_skipped,
+                                                &last_num_skipped);
           *num_skipped += last_num_skipped;
           if (s.ok()) {
             *end_of_sequence = false;
@@ -229,6 +466,9 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       if (reader_) {
         TF_RETURN_IF_ERROR(
             writer->WriteScalar(prefix(), kOffset, reader_->TellOffset()));
+      } else if (memmapped_reader_) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            prefix(), kOffset, memmapped_reader_->TellOffset()));
       }
       return OkStatus();
     }
@@ -245,7 +485,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
         int64_t offset;
         TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kOffset, &offset));
         TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
-        TF_RETURN_IF_ERROR(reader_->SeekOffset(offset));
+        TF_RETURN_IF_ERROR(SeekOffsetLocked(offset));
       }
       return OkStatus();
     }
@@ -260,22 +500,104 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       }
 
       // Actually move on to next file.
-      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
-          TranslateFileName(dataset()->filenames_[current_file_index_]),
-          &file_));
-      reader_ = std::make_unique<io::SequentialRecordReader>(
-          file_.get(), dataset()->options_);
+      const string filename =
+          TranslateFileName(dataset()->filenames_[current_file_index_]);
+      if (dataset()->use_memory_map_) {
+        TF_RETURN_IF_ERROR(SetupMemmappedReaderLocked(env, filename));
+      }
+      if (!memmapped_reader_) {
+        TF_RETURN_IF_ERROR(
+            dataset()->NewRandomAccessFile(env, filename, &file_));
+        reader_ = std::make_unique<io::SequentialRecordReader>(
+            file_.get(), dataset()->reader_options_);
+      }
       if (!dataset()->byte_offsets_.empty()) {
         TF_RETURN_IF_ERROR(
-            reader_->SeekOffset(dataset()->byte_offsets_[current_file_index_]));
+            SeekOffsetLocked(dataset()->byte_offsets_[current_file_index_]));
       }
       return OkStatus();
     }
 
+    // Maps `filename` into memory and sets up `memmapped_reader_` to read from
+    // it. Leaves `memmapped_reader_` unset if the file system of `filename`
+    // does not support memory mapping.
+    Status SetupMemmappedReaderLocked(Env* env, const string& filename)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      uint64 file_size;
+      TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+      std::unique_ptr<ReadOnlyMemoryRegion> region;
+      // Empty files cannot be mapped, and contain no records anyway.
+      if (file_size > 0) {
+        Status s = env->NewReadOnlyMemoryRegionFromFile(filename, &region);
+        if (errors::IsUnimplemented(s)) {
+          VLOG(2) << "Falling back to buffered reads of " << filename
+                  << " because its file system does not support memory "
+                     "mapping: "
+                  << s;
+          return OkStatus();
+        }
+        TF_RETURN_IF_ERROR(s);
+      }
+      memmapped_reader_ =
+          std::make_unique<MemmappedRecordReader>(std::move(region));
+      return OkStatus();
+    }
+
+    // Skips records by seeking to the offsets in the record indexes, without
+    // reading the skipped records.
+    Status SkipWithIndexLocked(Env* env, int num_to_skip,
+                               bool* end_of_sequence, int* num_skipped)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      while (*num_skipped < num_to_skip) {
+        if (current_file_index_ == dataset()->filenames_.size()) {
+          *end_of_sequence = true;
+          return OkStatus();
+        }
+        const std::vector<io::RecordIndexEntry>& index =
+            dataset()->indexes_[current_file_index_];
+        // The position in `index` of the next record to read.
+        size_t next = 0;
+        if (reader_ || memmapped_reader_) {
+          const uint64 offset = reader_ ? reader_->TellOffset()
+                                        : memmapped_reader_->TellOffset();
+          next = std::lower_bound(index.begin(), index.end(), offset,
+                                  [](const io::RecordIndexEntry& entry,
+                                     uint64 offset) {
+                                    return entry.offset < offset;
+                                  }) -
+                 index.begin();
+        }
+        const size_t remaining = index.size() - next;
+        const size_t to_skip = num_to_skip - *num_skipped;
+        if (to_skip < remaining) {
+          if (!reader_ && !memmapped_reader_) {
+            TF_RETURN_IF_ERROR(SetupStreamsLocked(env));
+          }
+          TF_RETURN_IF_ERROR(SeekOffsetLocked(index[next + to_skip].offset));
+          *num_skipped += to_skip;
+          break;
+        }
+        *num_skipped += remaining;
+        ResetStreamsLocked();
+        ++current_file_index_;
+      }
+      *end_of_sequence = false;
+      return OkStatus();
+    }
+
+    Status SeekOffsetLocked(int64_t offset) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (memmapped_reader_) {
+        memmapped_reader_->SeekOffset(offset);
+        return OkStatus();
+      }
+      return reader_->SeekOffset(offset);
+    }
+
     // Resets all reader streams.
     void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       reader_.reset();
       file_.reset();
+      memmapped_reader_.reset();
     }
 
     mutex mu_;
@@ -285,18 +607,80 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     // we must destroy `reader_` before `file_`.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
+    // Set instead of `reader_` when reading a memory-mapped file.
+    std::unique_ptr<MemmappedRecordReader> memmapped_reader_
+        TF_GUARDED_BY(mu_);
   };
 
+  // Opens `filename`, through the process-wide read cache if
+  // `use_shared_cache_` is set. The cache decompresses zlib and gzip files
+  // once for all of their readers, which then read them with
+  // `reader_options_`.
+  Status NewRandomAccessFile(Env* env, const string& filename,
+                             std::unique_ptr<RandomAccessFile>* file) const {
+    if (use_shared_cache_ && options_.compression_type ==
+                                 io::RecordReaderOptions::ZLIB_COMPRESSION) {
+      return SharedReadCache::Global()->NewDecompressedFile(
+          env, filename, options_.zlib_options, file);
+    }
+    if (use_shared_cache_) {
+      return SharedReadCache::Global()->NewRandomAccessFile(env, filename,
+                                                            file);
+    }
+    return env->NewRandomAccessFile(filename, file);
+  }
+
+  // Returns the file at `file_index` for random access, opening it on first
+  // use.
+  Status GetFile(Env* env, size_t file_index, RandomAccessFile** file) const {
+    mutex_lock l(files_mu_);
+    if (!files_[file_index]) {
+      TF_RETURN_IF_ERROR(NewRandomAccessFile(
+          env, TranslateFileName(filenames_[file_index]), &files_[file_index]));
+    }
+    *file = files_[file_index].get();
+    return OkStatus();
+  }
+
   const std::vector<string> filenames_;
   const tstring compression_type_;
   io::RecordReaderOptions options_;
+  // The options of the sequential readers of the files opened by
+  // `NewRandomAccessFile()`.
+  io::RecordReaderOptions reader_options_;
   const std::vector<int64_t> byte_offsets_;
+  const bool use_memory_map_;
+  const bool use_index_;
+  const bool use_shared_cache_;
+  const bool async_readahead_;
+  // The record index of each file if `use_index_` is set, otherwise empty.
+  const std::vector<std::vector<io::RecordIndexEntry>> indexes_;
+  // `file_offsets_[i]` is the global index of the first record of file `i`.
+  std::vector<int64_t> file_offsets_;
+  mutable mutex files_mu_;
+  // Files opened by `Get`. Reads of a `RandomAccessFile` are thread safe, so
+  // the lock only guards opening them.
+  mutable std::vector<std::unique_ptr<RandomAccessFile>> files_
+      TF_GUARDED_BY(files_mu_);
   const int op_version_;
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
     : DatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kTFRecordDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kTFRecordDataset ? 1 : 2) {
+  if (ctx->HasAttr(kUseMemoryMap)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kUseMemoryMap, &use_memory_map_));
+  }
+  if (ctx->HasAttr(kUseIndex)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kUseIndex, &use_index_));
+  }
+  if (ctx->HasAttr(kUseSharedCache)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kUseSharedCache, &use_shared_cache_));
+  }
+  if (ctx->HasAttr(kAsyncReadahead)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kAsyncReadahead, &async_readahead_));
+  }
+}
 
 void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -321,6 +705,16 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
   tstring compression_type;
   OP_REQUIRES_OK(ctx, ParseScalarArgument<tstring>(ctx, kCompressionType,
                                                    &compression_type));
+  OP_REQUIRES(ctx, !use_memory_map_ || compression_type.empty(),
+              errors::InvalidArgument(
+                  "`use_memory_map` is only supported for uncompressed "
+                  "TFRecord files, but got compression type ",
+                  compression_type, "."));
+  // Memory mapped files are already shared through the page cache.
+  OP_REQUIRES(ctx, !use_memory_map_ || !use_shared_cache_,
+              errors::InvalidArgument(
+                  "`use_memory_map` cannot be combined with "
+                  "`use_shared_cache`."));
 
   int64_t buffer_size = -1;
   OP_REQUIRES_OK(ctx,
@@ -345,6 +739,28 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
     }
   }
 
+  // Reads the record index of each file, so that records can be skipped and
+  // read in any order.
+  std::vector<std::vector<io::RecordIndexEntry>> indexes;
+  if (use_index_) {
+    OP_REQUIRES(ctx, compression_type.empty(),
+                errors::InvalidArgument(
+                    "`use_index` is only supported for uncompressed TFRecord "
+                    "files, but got compression type ",
+                    compression_type, "."));
+    OP_REQUIRES(ctx, byte_offsets.empty(),
+                errors::InvalidArgument(
+                    "`use_index` cannot be combined with `byte_offsets`."));
+    indexes.resize(filenames.size());
+    for (size_t i = 0; i < filenames.size(); ++i) {
+      OP_REQUIRES_OK(
+          ctx, io::ReadRecordIndex(
+                   ctx->env(),
+                   io::RecordIndexFilename(TranslateFileName(filenames[i])),
+                   &indexes[i]));
+    }
+  }
+
   if (is_gcs_fs && is_cloud_tpu_gcs_fs() && buffer_size < kCloudTpuBlockSize) {
     VLOG(2) << "User buffer size is too small for reading Cloud TPU "
             << "TFRecords stored in GCS. Overriding " << buffer_size
@@ -361,7 +777,9 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
   }
 
   *output = new Dataset(ctx, std::move(filenames), compression_type,
-                        buffer_size, std::move(byte_offsets), op_version_);
+                        buffer_size, std::move(byte_offsets), use_memory_map_,
+                        use_index_, use_shared_cache_, async_readahead_,
+                        std::move(indexes), op_version_);
 }
 
 namespace {
@@ -27,6 +27,10 @@ class TFRecordDatasetOp : public DatasetOpKernel {
   static constexpr const char* const kCompressionType = "compression_type";
   static constexpr const char* const kBufferSize = "buffer_size";
   static constexpr const char* const kByteOffsets = "byte_offsets";
+  static constexpr const char* const kUseMemoryMap = "use_memory_map";
+  static constexpr const char* const kUseIndex = "use_index";
+  static constexpr const char* const kUseSharedCache = "use_shared_cache";
+  static constexpr const char* const kAsyncReadahead = "async_readahead";
 
   explicit TFRecordDatasetOp(OpKernelConstruction* ctx);
 
@@ -36,6 +40,10 @@ class TFRecordDatasetOp : public DatasetOpKernel {
  private:
   class Dataset;
   int op_version_;
+  bool use_memory_map_ = false;
+  bool use_index_ = false;
+  bool use_shared_cache_ = false;
+  bool async_readahead_ = false;
 };
 
 }  // namespace data
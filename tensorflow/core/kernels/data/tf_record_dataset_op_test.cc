@@ -15,7 +15,10 @@ limitations under the License.
 #include <string>
 
 #include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/data/shared_read_cache.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system.h"
 
@@ -46,13 +49,20 @@ class TFRecordDatasetParams : public DatasetParams {
  public:
   TFRecordDatasetParams(std::vector<tstring> filenames,
                         CompressionType compression_type, int64_t buffer_size,
-                        std::vector<int64_t> byte_offsets, string node_name)
+                        std::vector<int64_t> byte_offsets, string node_name,
+                        bool use_memory_map = false, bool use_index = false,
+                        bool use_shared_cache = false,
+                        bool async_readahead = false)
       : DatasetParams({DT_STRING}, {PartialTensorShape({})},
                       std::move(node_name)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         buffer_size_(buffer_size),
-        byte_offsets_(std::move(byte_offsets)) {
+        byte_offsets_(std::move(byte_offsets)),
+        use_memory_map_(use_memory_map),
+        use_index_(use_index),
+        use_shared_cache_(use_shared_cache),
+        async_readahead_(async_readahead) {
     op_version_ = 2;
   }
 
@@ -80,6 +90,13 @@ class TFRecordDatasetParams : public DatasetParams {
   Status GetAttributes(AttributeVector* attr_vector) const override {
     attr_vector->clear();
     attr_vector->emplace_back("metadata", "");
+    attr_vector->emplace_back(TFRecordDatasetOp::kUseMemoryMap,
+                              use_memory_map_);
+    attr_vector->emplace_back(TFRecordDatasetOp::kUseIndex, use_index_);
+    attr_vector->emplace_back(TFRecordDatasetOp::kUseSharedCache,
+                              use_shared_cache_);
+    attr_vector->emplace_back(TFRecordDatasetOp::kAsyncReadahead,
+                              async_readahead_);
     return OkStatus();
   }
 
@@ -92,6 +109,10 @@ class TFRecordDatasetParams : public DatasetParams {
   CompressionType compression_type_;
   int64_t buffer_size_;
   std::vector<int64_t> byte_offsets_;
+  bool use_memory_map_;
+  bool use_index_;
+  bool use_shared_cache_;
+  bool async_readahead_;
 };
 
 class TFRecordDatasetOpTest : public DatasetOpsTestBase {};
@@ -114,6 +135,34 @@ Status CreateTestFiles(const std::vector<tstring>& filenames,
   return OkStatus();
 }
 
+// Writes uncompressed TFRecord files along with their record indexes.
+Status CreateIndexedTestFiles(
+    const std::vector<tstring>& filenames,
+    const std::vector<std::vector<string>>& contents) {
+  if (filenames.size() != contents.size()) {
+    return tensorflow::errors::InvalidArgument(
+        "The number of files does not match with the contents");
+  }
+  Env* env = Env::Default();
+  for (int i = 0; i < filenames.size(); ++i) {
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(env->NewWritableFile(filenames[i], &file));
+    std::unique_ptr<WritableFile> index_file;
+    TF_RETURN_IF_ERROR(env->NewWritableFile(
+        io::RecordIndexFilename(filenames[i]), &index_file));
+    io::RecordWriterOptions options;
+    options.index_file = index_file.get();
+    io::RecordWriter writer(file.get(), options);
+    for (const string& record : contents[i]) {
+      TF_RETURN_IF_ERROR(writer.WriteRecord(record));
+    }
+    TF_RETURN_IF_ERROR(writer.Close());
+    TF_RETURN_IF_ERROR(file->Close());
+    TF_RETURN_IF_ERROR(index_file->Close());
+  }
+  return OkStatus();
+}
+
 // Test case 1: multiple text files with ZLIB compression.
 TFRecordDatasetParams TFRecordDatasetParams1() {
   std::vector<tstring> filenames = {
@@ -193,7 +242,94 @@ TFRecordDatasetParams TFRecordDatasetParams4() {
                                /*node_name=*/kNodeName);
 }
 
-// Test case 5: Read invalid byte_offsets for records.
+// Test case 5: multiple text files without compression, read through a memory
+// mapping.
+TFRecordDatasetParams TFRecordDatasetParams5() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_MMAP_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_MMAP_2")};
+  std::vector<std::vector<string>> contents = {{"1", "22", "333"},
+                                               {"a", "bb", "ccc"}};
+  CompressionType compression_type = CompressionType::UNCOMPRESSED;
+  if (!CreateTestFiles(filenames, contents, compression_type).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return TFRecordDatasetParams(filenames,
+                               /*compression_type=*/compression_type,
+                               /*buffer_size=*/10,
+                               /*byte_offsets=*/{},
+                               /*node_name=*/kNodeName,
+                               /*use_memory_map=*/true);
+}
+
+// Test case 6: multiple text files without compression, skipped and read in
+// any order through their record indexes.
+TFRecordDatasetParams TFRecordDatasetParams6() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_INDEXED_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_INDEXED_2")};
+  std::vector<std::vector<string>> contents = {{"1", "22", "333"},
+                                               {"a", "bb", "ccc"}};
+  absl::Status status = CreateIndexedTestFiles(filenames, contents);
+  TF_CHECK_OK(status) << "Failed to create the test files: "
+                      << absl::StrJoin(filenames, ", ") << ": " << status;
+  return TFRecordDatasetParams(filenames,
+                               /*compression_type=*/
+                               CompressionType::UNCOMPRESSED,
+                               /*buffer_size=*/10,
+                               /*byte_offsets=*/{},
+                               /*node_name=*/kNodeName,
+                               /*use_memory_map=*/false,
+                               /*use_index=*/true);
+}
+
+// Test case 7: multiple text files with GZIP compression, read through the
+// shared read cache.
+TFRecordDatasetParams TFRecordDatasetParams7() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_SHARED_CACHE_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_SHARED_CACHE_2")};
+  std::vector<std::vector<string>> contents = {{"1", "22", "333"},
+                                               {"a", "bb", "ccc"}};
+  CompressionType compression_type = CompressionType::GZIP;
+  absl::Status status = CreateTestFiles(filenames, contents, compression_type);
+  TF_CHECK_OK(status) << "Failed to create the test files: "
+                      << absl::StrJoin(filenames, ", ") << ": " << status;
+  return TFRecordDatasetParams(filenames,
+                               /*compression_type=*/compression_type,
+                               /*buffer_size=*/10,
+                               /*byte_offsets=*/{},
+                               /*node_name=*/kNodeName,
+                               /*use_memory_map=*/false,
+                               /*use_index=*/false,
+                               /*use_shared_cache=*/true);
+}
+
+// Test case 8: multiple text files without compression, read ahead
+// asynchronously and skipped through their record indexes.
+TFRecordDatasetParams TFRecordDatasetParams8() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_READAHEAD_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_READAHEAD_2")};
+  std::vector<std::vector<string>> contents = {{"1", "22", "333"},
+                                               {"a", "bb", "ccc"}};
+  absl::Status status = CreateIndexedTestFiles(filenames, contents);
+  TF_CHECK_OK(status) << "Failed to create the test files: "
+                      << absl::StrJoin(filenames, ", ") << ": " << status;
+  return TFRecordDatasetParams(filenames,
+                               /*compression_type=*/
+                               CompressionType::UNCOMPRESSED,
+                               /*buffer_size=*/10,
+                               /*byte_offsets=*/{},
+                               /*node_name=*/kNodeName,
+                               /*use_memory_map=*/false,
+                               /*use_index=*/true,
+                               /*use_shared_cache=*/false,
+                               /*async_readahead=*/true);
+}
+
+// Test case 9: Read invalid byte_offsets for records.
 TFRecordDatasetParams InvalidByteOffsets() {
   std::vector<tstring> filenames = {
       absl::StrCat(testing::TmpDir(), "/tf_record_UNCOMPRESSED_1")};
@@ -223,7 +359,19 @@ std::vector<GetNextTestCase<TFRecordDatasetParams>> GetNextTestCases() {
       {/*dataset_params=*/TFRecordDatasetParams4(),
        CreateTensors<tstring>(
            TensorShape({}),
-           {{"1"}, {"22"}, {"333"}, {"bb"}, {"ccc"}, {"zzz"}})}};
+           {{"1"}, {"22"}, {"333"}, {"bb"}, {"ccc"}, {"zzz"}})},
+      {/*dataset_params=*/TFRecordDatasetParams5(),
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams6(),
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams7(),
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams8(),
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})}};
 }
 
 ITERATOR_GET_NEXT_TEST_P(TFRecordDatasetOpTest, TFRecordDatasetParams,
@@ -261,6 +409,43 @@ std::vector<SkipTestCase<TFRecordDatasetParams>> SkipTestCases() {
            /*expected_outputs=*/
            CreateTensors<tstring>(TensorShape({}), {{"bb"}})},
           {/*dataset_params=*/TFRecordDatasetParams3(),
+           /*num_to_skip*/ 7, /*expected_num_skipped*/ 6},
+
+          {/*dataset_params=*/TFRecordDatasetParams5(),
+           /*num_to_skip*/ 2, /*expected_num_skipped*/ 2, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"333"}})},
+          {/*dataset_params=*/TFRecordDatasetParams5(),
+           /*num_to_skip*/ 4, /*expected_num_skipped*/ 4, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"bb"}})},
+          {/*dataset_params=*/TFRecordDatasetParams5(),
+           /*num_to_skip*/ 7, /*expected_num_skipped*/ 6},
+
+          {/*dataset_params=*/TFRecordDatasetParams6(),
+           /*num_to_skip*/ 2, /*expected_num_skipped*/ 2, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"333"}})},
+          {/*dataset_params=*/TFRecordDatasetParams6(),
+           /*num_to_skip*/ 3, /*expected_num_skipped*/ 3, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"a"}})},
+          {/*dataset_params=*/TFRecordDatasetParams6(),
+           /*num_to_skip*/ 4, /*expected_num_skipped*/ 4, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"bb"}})},
+          {/*dataset_params=*/TFRecordDatasetParams6(),
+           /*num_to_skip*/ 7, /*expected_num_skipped*/ 6},
+
+          {/*dataset_params=*/TFRecordDatasetParams8(),
+           /*num_to_skip*/ 2, /*expected_num_skipped*/ 2, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"333"}})},
+          {/*dataset_params=*/TFRecordDatasetParams8(),
+           /*num_to_skip*/ 4, /*expected_num_skipped*/ 4, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"bb"}})},
+          {/*dataset_params=*/TFRecordDatasetParams8(),
            /*num_to_skip*/ 7, /*expected_num_skipped*/ 6}};
 }
 
@@ -300,6 +485,35 @@ TEST_F(TFRecordDatasetOpTest, Cardinality) {
   TF_ASSERT_OK(CheckDatasetCardinality(kUnknownCardinality));
 }
 
+TEST_F(TFRecordDatasetOpTest, CardinalityWithIndex) {
+  auto dataset_params = TFRecordDatasetParams6();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(6));
+}
+
+TEST_F(TFRecordDatasetOpTest, RandomAccessWithIndex) {
+  auto dataset_params = TFRecordDatasetParams6();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<tstring> expected = {"1", "22", "333", "a", "bb", "ccc"};
+  for (int64_t i = expected.size() - 1; i >= 0; --i) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(dataset_->Get(dataset_ctx_.get(), i, &out_tensors));
+    ASSERT_EQ(out_tensors.size(), 1);
+    EXPECT_EQ(out_tensors[0].scalar<tstring>()(), expected[i]);
+  }
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(dataset_->Get(dataset_ctx_.get(), 6, &out_tensors).code(),
+            absl::StatusCode::kOutOfRange);
+}
+
+TEST_F(TFRecordDatasetOpTest, RandomAccessRequiresIndex) {
+  auto dataset_params = TFRecordDatasetParams5();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(dataset_->Get(dataset_ctx_.get(), 0, &out_tensors).code(),
+            absl::StatusCode::kUnimplemented);
+}
+
 TEST_F(TFRecordDatasetOpTest, IteratorOutputDtypes) {
   auto dataset_params = TFRecordDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
@@ -333,6 +547,80 @@ TEST_F(TFRecordDatasetOpTest, InvalidByteOffsetsToSeek) {
       absl::StatusCode::kDataLoss);
 }
 
+TEST_F(TFRecordDatasetOpTest, MemoryMapRequiresUncompressedFiles) {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_MMAP_ZLIB")};
+  TF_ASSERT_OK(CreateTestFiles(filenames, {{"1", "22", "333"}},
+                               CompressionType::ZLIB));
+  auto dataset_params = TFRecordDatasetParams(
+      filenames, /*compression_type=*/CompressionType::ZLIB,
+      /*buffer_size=*/10, /*byte_offsets=*/{}, /*node_name=*/kNodeName,
+      /*use_memory_map=*/true);
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST_F(TFRecordDatasetOpTest, IndexRequiresUncompressedFiles) {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_INDEXED_ZLIB")};
+  TF_ASSERT_OK(CreateTestFiles(filenames, {{"1", "22", "333"}},
+                               CompressionType::ZLIB));
+  auto dataset_params = TFRecordDatasetParams(
+      filenames, /*compression_type=*/CompressionType::ZLIB,
+      /*buffer_size=*/10, /*byte_offsets=*/{}, /*node_name=*/kNodeName,
+      /*use_memory_map=*/false, /*use_index=*/true);
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST_F(TFRecordDatasetOpTest, MissingIndex) {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_NO_INDEX")};
+  TF_ASSERT_OK(CreateTestFiles(filenames, {{"1", "22", "333"}},
+                               CompressionType::UNCOMPRESSED));
+  auto dataset_params = TFRecordDatasetParams(
+      filenames, /*compression_type=*/CompressionType::UNCOMPRESSED,
+      /*buffer_size=*/10, /*byte_offsets=*/{}, /*node_name=*/kNodeName,
+      /*use_memory_map=*/false, /*use_index=*/true);
+  EXPECT_EQ(Initialize(dataset_params).code(), absl::StatusCode::kNotFound);
+}
+
+TEST_F(TFRecordDatasetOpTest, MemoryMapAndSharedCache) {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_MMAP_SHARED_CACHE")};
+  TF_ASSERT_OK(CreateTestFiles(filenames, {{"1", "22", "333"}},
+                               CompressionType::UNCOMPRESSED));
+  auto dataset_params = TFRecordDatasetParams(
+      filenames, /*compression_type=*/CompressionType::UNCOMPRESSED,
+      /*buffer_size=*/10, /*byte_offsets=*/{}, /*node_name=*/kNodeName,
+      /*use_memory_map=*/true, /*use_index=*/false,
+      /*use_shared_cache=*/true);
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST_F(TFRecordDatasetOpTest, SharedCacheSharesReads) {
+  auto dataset_params = TFRecordDatasetParams7();
+  SharedReadCache* cache = SharedReadCache::Global();
+  for (int i = 0; i < 2; ++i) {
+    const int64_t num_block_reads = cache->num_block_reads();
+    const int64_t num_block_hits = cache->num_block_hits();
+    TF_ASSERT_OK(Initialize(dataset_params));
+    bool end_of_sequence = false;
+    std::vector<Tensor> out_tensors;
+    while (!end_of_sequence) {
+      TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                      &end_of_sequence));
+    }
+    if (i > 0) {
+      // The second pass over the files is served from the cache, without
+      // decompressing them again.
+      EXPECT_EQ(cache->num_block_reads(), num_block_reads);
+      EXPECT_GT(cache->num_block_hits(), num_block_hits);
+    }
+  }
+}
+
 std::vector<IteratorSaveAndRestoreTestCase<TFRecordDatasetParams>>
 IteratorSaveAndRestoreTestCases() {
   return {
@@ -346,6 +634,22 @@ IteratorSaveAndRestoreTestCases() {
        CreateTensors<tstring>(
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
       {/*dataset_params=*/TFRecordDatasetParams3(),
+       /*breakpoints=*/{0, 2, 7},
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams5(),
+       /*breakpoints=*/{0, 2, 7},
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams6(),
+       /*breakpoints=*/{0, 2, 7},
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams7(),
+       /*breakpoints=*/{0, 2, 7},
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams8(),
        /*breakpoints=*/{0, 2, 7},
        CreateTensors<tstring>(
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})}};
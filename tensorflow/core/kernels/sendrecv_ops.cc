@@ -77,6 +77,9 @@ SendOp::SendOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
   if (!ctx->GetAttr("_hostmem_sendrecv", &hostmem_sendrecv_).ok()) {
     hostmem_sendrecv_ = false;
   }
+  if (!ctx->GetAttr("_rendezvous_slot", &rendezvous_slot_).ok()) {
+    rendezvous_slot_ = 0;
+  }
 }
 
 void SendOp::Compute(OpKernelContext* ctx) {
@@ -94,7 +97,8 @@ void SendOp::Compute(OpKernelContext* ctx) {
 
   FrameAndIter frame_iter = GetFrameAndIter(ctx, hostmem_sendrecv_);
   if (frame_iter == FrameAndIter(0, 0)) {
-    // Use the cached rendezvous key.
+    // Use the cached rendezvous key. The slot, if any, is only valid for it.
+    args.rendezvous_slot = rendezvous_slot_;
     VLOG(2) << "Send " << parsed_key_.buf_ << " using "
             << reinterpret_cast<uintptr_t>(ctx->rendezvous());
     ctx->SetStatus(ctx->rendezvous()->Send(parsed_key_, args, ctx->input(0),
@@ -158,6 +162,9 @@ RecvOp::RecvOp(OpKernelConstruction* ctx) : AsyncOpKernel(ctx) {
   if (!ctx->GetAttr("_hostmem_sendrecv", &hostmem_sendrecv_).ok()) {
     hostmem_sendrecv_ = false;
   }
+  if (!ctx->GetAttr("_rendezvous_slot", &rendezvous_slot_).ok()) {
+    rendezvous_slot_ = 0;
+  }
 }
 
 string RecvOp::TraceString(const OpKernelContext& ctx, bool verbose) const {
@@ -206,6 +213,7 @@ void RecvOp::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
 
   FrameAndIter frame_iter = GetFrameAndIter(ctx, hostmem_sendrecv_);
   if (frame_iter == FrameAndIter(0, 0)) {
+    args.rendezvous_slot = rendezvous_slot_;
     VLOG(2) << "Recv " << parsed_key_.buf_ << " using "
             << reinterpret_cast<uintptr_t>(ctx->rendezvous());
     ctx->rendezvous()->RecvAsync(parsed_key_, args,
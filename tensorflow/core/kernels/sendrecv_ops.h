@@ -32,6 +32,8 @@ class SendOp : public OpKernel {
   string key_prefix_;
   Rendezvous::ParsedKey parsed_key_;
   bool hostmem_sendrecv_;
+  // Zero unless the partitioner assigned the pair a rendezvous slot.
+  int64_t rendezvous_slot_;
 
   SendOp(const SendOp&) = delete;
   void operator=(const SendOp&) = delete;
@@ -48,6 +50,8 @@ class RecvOp : public AsyncOpKernel {
   string key_prefix_;
   Rendezvous::ParsedKey parsed_key_;
   bool hostmem_sendrecv_;
+  // Zero unless the partitioner assigned the pair a rendezvous slot.
+  int64_t rendezvous_slot_;
 
   RecvOp(const RecvOp&) = delete;
   void operator=(const RecvOp&) = delete;
@@ -0,0 +1,34 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_RECORD_INDEX_H_
+#define TENSORFLOW_CORE_LIB_IO_RECORD_INDEX_H_
+
+#include "tsl/lib/io/record_index.h"
+
+namespace tensorflow {
+namespace io {
+// NOLINTBEGIN(misc-unused-using-decls)
+using tsl::io::kRecordIndexSuffix;
+using tsl::io::ReadIndexedRecord;
+using tsl::io::ReadRecordIndex;
+using tsl::io::RecordIndexEntry;
+using tsl::io::RecordIndexFilename;
+using tsl::io::RecordIndexWriter;
+// NOLINTEND(misc-unused-using-decls)
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_RECORD_INDEX_H_
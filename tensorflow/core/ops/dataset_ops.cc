@@ -220,6 +220,7 @@ REGISTER_OP("PrefetchDataset")
     .Attr("legacy_autotune: bool = true")
     .Attr("buffer_size_min: int = 0")
     .Attr("metadata: string = ''")
+    .Attr("stage_on_device: bool = false")
     .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
                                                            "output_types"))
     .SetShapeFn([](shape_inference::InferenceContext* c) {
@@ -643,6 +644,8 @@ REGISTER_OP("ShuffleDatasetV3")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
     .Attr("metadata: string = ''")
+    .Attr("spill_directory: string = ''")
+    .Attr("spill_memory_budget: int = 0")
     .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
                                                            "output_types"))
     .SetShapeFn([](shape_inference::InferenceContext* c) {
@@ -749,6 +752,8 @@ REGISTER_OP("CacheDatasetV2")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
     .Attr("metadata: string = ''")
+    .Attr("memory_budget: int = 0")
+    .Attr("spill_directory: string = ''")
     .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
                                                            "output_types"))
     .SetShapeFn([](shape_inference::InferenceContext* c) {
@@ -855,6 +860,10 @@ REGISTER_OP("TFRecordDatasetV2")
     .Input("buffer_size: int64")
     .Input("byte_offsets: int64")
     .Attr("metadata: string = ''")
+    .Attr("use_memory_map: bool = false")
+    .Attr("use_index: bool = false")
+    .Attr("use_shared_cache: bool = false")
+    .Attr("async_readahead: bool = false")
     .Output("handle: variant")
     .SetDoNotOptimize()  // TODO(b/123753214): See comment in dataset_ops.cc.
     .SetTypeConstructor(full_type::UnaryTensorContainer(TFT_DATASET,
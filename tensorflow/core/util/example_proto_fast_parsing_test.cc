@@ -15,12 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
+#include <limits>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -255,6 +257,43 @@ static string ExampleWithSomeFeatures() {
 
 TEST(FastParse, SomeFeatures) { TestCorrectness(ExampleWithSomeFeatures()); }
 
+// Returns an example with a single int64 feature "int64_list" holding
+// `values`.
+static string ExampleWithInt64List(const std::vector<int64_t>& values) {
+  Example example;
+  Int64List* int64_list =
+      (*example.mutable_features()->mutable_feature())["int64_list"]
+          .mutable_int64_list();
+  for (int64_t value : values) {
+    int64_list->add_value(value);
+  }
+  return Serialize(example);
+}
+
+TEST(FastParse, PackedInt64Varints) {
+  // Mixes long runs of single-byte varints with multi-byte and negative
+  // (10-byte) ones, so that all decoding paths are used.
+  std::vector<int64_t> values;
+  for (int i = 0; i < 40; ++i) {
+    values.push_back(i);
+  }
+  values.insert(values.end(), {128, 300, -1, 1LL << 40,
+                               std::numeric_limits<int64_t>::min(),
+                               std::numeric_limits<int64_t>::max()});
+  for (int i = 0; i < 9; ++i) {
+    values.push_back(127 - i);
+  }
+  TestCorrectness(ExampleWithInt64List(values));
+}
+
+TEST(FastParse, TruncatedPackedInt64Varint) {
+  string serialized = ExampleWithInt64List({1, 2, 300});
+  // Sets the continuation bit of the last byte of the last varint.
+  serialized.back() |= 0x80;
+  Example example;
+  EXPECT_FALSE(TestFastParse(serialized, &example));
+}
+
 static void AddDenseFeature(const char* feature_name, DataType dtype,
                             PartialTensorShape shape, bool variable_length,
                             size_t elements_per_stride,
@@ -277,6 +316,28 @@ static void AddSparseFeature(const char* feature_name, DataType dtype,
   new_feature.dtype = dtype;
 }
 
+TEST(FastParse, DenseInt64) {
+  const std::vector<int64_t> values = {0, 1, 127, 128, -1, 1LL << 50, 7, 8, 9};
+  std::vector<tstring> serialized(3, ExampleWithInt64List(values));
+  FastParseExampleConfig config;
+  AddDenseFeature("int64_list", DT_INT64, {9}, false, 9, &config);
+  Result result;
+  TF_ASSERT_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  ASSERT_EQ(result.dense_values.size(), 1);
+  const auto matrix = result.dense_values[0].matrix<int64_t>();
+  for (int i = 0; i < serialized.size(); ++i) {
+    for (int j = 0; j < values.size(); ++j) {
+      EXPECT_EQ(matrix(i, j), values[j]);
+    }
+  }
+
+  // A feature with more values than the dense shape is an error.
+  FastParseExampleConfig small_config;
+  AddDenseFeature("int64_list", DT_INT64, {4}, false, 4, &small_config);
+  EXPECT_FALSE(
+      FastParseExample(small_config, serialized, {}, nullptr, &result).ok());
+}
+
 TEST(FastParse, StatsCollection) {
   const size_t kNumExamples = 13;
   std::vector<tstring> serialized(kNumExamples, ExampleWithSomeFeatures());
@@ -419,6 +480,48 @@ TEST(FastParse, FuzzTest) {
   }
 }
 
+// Parses batches of examples with an int64 feature of `num_values` values,
+// which are single-byte varints if `small_values`, and multi-byte varints
+// otherwise. The feature is parsed as a fixed or variable length dense one.
+void BM_FastParseExampleInt64(::testing::benchmark::State& state) {
+  const int batch_size = state.range(0);
+  const int num_values = state.range(1);
+  const bool small_values = state.range(2);
+  const bool variable_length = state.range(3);
+
+  random::PhiloxRandom philox(1337);
+  random::SimplePhilox rng(&philox);
+  std::vector<int64_t> values(num_values);
+  for (int64_t& value : values) {
+    value = small_values ? rng.Uniform(128) : rng.Rand64() >> 16;
+  }
+  std::vector<tstring> serialized(batch_size, ExampleWithInt64List(values));
+  FastParseExampleConfig config;
+  if (variable_length) {
+    AddDenseFeature("int64_list", DT_INT64, {-1}, true, 1, &config);
+  } else {
+    AddDenseFeature("int64_list", DT_INT64, {num_values}, false, num_values,
+                    &config);
+  }
+  for (auto s : state) {
+    Result result;
+    TF_CHECK_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          batch_size * num_values);
+}
+
+BENCHMARK(BM_FastParseExampleInt64)
+    ->Args({128, 1, true, false})
+    ->Args({128, 64, true, false})
+    ->Args({128, 64, false, false})
+    ->Args({128, 1024, true, false})
+    ->Args({128, 1024, false, false})
+    ->Args({128, 64, true, true})
+    ->Args({128, 64, false, true})
+    ->Args({128, 1024, true, true})
+    ->Args({128, 1024, false, true});
+
 TEST(TestFastParseExample, Empty) {
   Result result;
   FastParseExampleConfig config;
@@ -0,0 +1,158 @@
+# Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the native bucket-by-sequence-length dataset."""
+from absl.testing import parameterized
+
+from tensorflow.python.data.experimental.ops import grouping
+from tensorflow.python.data.kernel_tests import checkpoint_test_base
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import combinations
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
+from tensorflow.python.framework import tensor_shape
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops.ragged import ragged_factory_ops
+from tensorflow.python.platform import test
+
+_LENGTHS = [1, 3, 2, 5, 1, 4]
+
+
+def _sequences():
+  """Returns (sequence, label) elements, where sequence `i` has `i + 1`s."""
+  return dataset_ops.Dataset.from_tensor_slices(
+      (_LENGTHS, list(range(len(_LENGTHS))))).map(
+          lambda length, label: (array_ops.fill([length], label + 1), label))
+
+
+class BucketBySequenceLengthDatasetTest(test_base.DatasetTestBase,
+                                        parameterized.TestCase):
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testBatchSizes(self):
+    dataset = grouping._BucketBySequenceLengthDataset(
+        _sequences(), bucket_boundaries=[3], bucket_batch_sizes=[2, 2])
+    self.assertEqual(
+        [[None, None], [None]],
+        [s.as_list() for s in dataset_ops.get_legacy_output_shapes(dataset)])
+    self.assertDatasetProduces(
+        dataset,
+        expected_output=[([[1, 0], [3, 3]], [0, 2]),
+                         ([[2, 2, 2, 0, 0], [4, 4, 4, 4, 4]], [1, 3]),
+                         ([[5]], [4]), ([[6, 6, 6, 6]], [5])])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testTokenBudget(self):
+    dataset = grouping._BucketBySequenceLengthDataset(
+        _sequences(), bucket_boundaries=[3], token_budget=6)
+    self.assertDatasetProduces(
+        dataset,
+        expected_output=[([[2, 2, 2]], [1]),
+                         ([[1, 0], [3, 3], [5, 0]], [0, 2, 4]),
+                         ([[4, 4, 4, 4, 4]], [3]), ([[6, 6, 6, 6]], [5])])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testAutotuneBoundaries(self):
+    # The boundary is tuned to the median length, 3.
+    dataset = grouping._BucketBySequenceLengthDataset(
+        _sequences(),
+        bucket_boundaries=[100],
+        bucket_batch_sizes=[2, 2],
+        autotune_window=len(_LENGTHS))
+    self.assertDatasetProduces(
+        dataset,
+        expected_output=[([[1, 0], [3, 3]], [0, 2]),
+                         ([[2, 2, 2, 0, 0], [4, 4, 4, 4, 4]], [1, 3]),
+                         ([[5]], [4]), ([[6, 6, 6, 6]], [5])])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testPaddingValues(self):
+    dataset = grouping._BucketBySequenceLengthDataset(
+        _sequences(),
+        bucket_boundaries=[3],
+        bucket_batch_sizes=[2, 2],
+        padding_values=(-1, 0))
+    self.assertDatasetProduces(
+        dataset.take(1), expected_output=[([[1, -1], [3, 3]], [0, 2])])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testRagged(self):
+    dataset = grouping._BucketBySequenceLengthDataset(
+        _sequences(),
+        bucket_boundaries=[3],
+        bucket_batch_sizes=[2, 2],
+        ragged=True)
+    self.assertDatasetProduces(
+        dataset,
+        expected_output=[
+            (ragged_factory_ops.constant_value([[1], [3, 3]]), [0, 2]),
+            (ragged_factory_ops.constant_value([[2, 2, 2], [4, 4, 4, 4, 4]]),
+             [1, 3]),
+            (ragged_factory_ops.constant_value([[5]]), [4]),
+            (ragged_factory_ops.constant_value([[6, 6, 6, 6]]), [5]),
+        ])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testInvalidBatchSizes(self):
+    with self.assertRaises(errors.InvalidArgumentError):
+      dataset = grouping._BucketBySequenceLengthDataset(
+          _sequences(), bucket_boundaries=[3], bucket_batch_sizes=[2])
+      self.evaluate(self.getNext(dataset)())
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testInvalidLengthComponent(self):
+    with self.assertRaises(errors.InvalidArgumentError):
+      dataset = grouping._BucketBySequenceLengthDataset(
+          _sequences(),
+          bucket_boundaries=[3],
+          bucket_batch_sizes=[2, 2],
+          length_component=1)
+      self.evaluate(self.getNext(dataset)())
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testUnknownBatchDimension(self):
+    dataset = grouping._BucketBySequenceLengthDataset(
+        dataset_ops.Dataset.range(4).map(
+            lambda x: array_ops.fill([x + 1], x)),
+        bucket_boundaries=[2],
+        bucket_batch_sizes=[2, 2])
+    self.assertEqual(
+        tensor_shape.TensorShape([None, None]),
+        dataset_ops.get_legacy_output_shapes(dataset))
+    self.assertEqual(dtypes.int64, dataset_ops.get_legacy_output_types(dataset))
+
+
+class BucketBySequenceLengthDatasetCheckpointTest(
+    checkpoint_test_base.CheckpointTestBase, parameterized.TestCase):
+
+  def _build_dataset(self, autotune_window):
+    return grouping._BucketBySequenceLengthDataset(
+        _sequences(),
+        bucket_boundaries=[3],
+        bucket_batch_sizes=[2, 2],
+        autotune_window=autotune_window)
+
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          checkpoint_test_base.default_test_combinations(),
+          combinations.combine(autotune_window=[0, 2])))
+  def test(self, verify_fn, autotune_window):
+    verify_fn(self, lambda: self._build_dataset(autotune_window),
+              num_outputs=4)
+
+
+if __name__ == "__main__":
+  test.main()
@@ -109,6 +109,20 @@ class CompressionOpsTest(test_base.DatasetTestBase, parameterized.TestCase):
     dataset = dataset.map(lambda x: compression_ops.uncompress(x, element_spec))
     self.assertDatasetProduces(dataset, [element])
 
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(element=_test_objects()),
+          combinations.combine(compression_level=[-5, 3, 19])))
+  def testZstdCompression(self, element, compression_level):
+    element = element._obj
+
+    compressed = compression_ops.compress(
+        element, codec="ZSTD", compression_level=compression_level)
+    uncompressed = compression_ops.uncompress(
+        compressed, structure.type_spec_from_value(element))
+    self.assertValuesEqual(element, self.evaluate(uncompressed))
+
   @combinations.generate(
       combinations.times(test_base.default_test_combinations()))
   def testCompressionOutputDTypeMismatch(self):
@@ -1317,7 +1317,7 @@ class DataServiceOpsGrpcDataTransferTest(
   @combinations.generate(
       combinations.times(
           test_base.default_test_combinations(),
-          combinations.combine(compression=[None, "AUTO"]),
+          combinations.combine(compression=[None, "AUTO", "ZSTD"]),
       )
   )
   def testDistributeCompression(self, compression):
@@ -1328,6 +1328,37 @@ class DataServiceOpsGrpcDataTransferTest(
     )
     self.assertDatasetProduces(ds, list(range(num_elements)))
 
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(zstd_compression_level=[-5, 19]),
+      )
+  )
+  def testDistributeZstdCompressionLevel(self, zstd_compression_level):
+    cluster = self.make_test_cluster(num_workers=1)
+    num_elements = 10
+    ds = dataset_ops.Dataset.range(num_elements)
+    options = options_lib.Options()
+    options.experimental_distribute.zstd_compression_level = (
+        zstd_compression_level)
+    ds = ds.with_options(options)
+    ds = self.make_distributed_dataset(ds, cluster, compression="ZSTD")
+    self.assertDatasetProduces(ds, list(range(num_elements)))
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testDistributeZstdDictionaryWithoutId(self):
+    cluster = self.make_test_cluster(num_workers=1)
+    ds = dataset_ops.Dataset.range(10)
+    options = options_lib.Options()
+    # Raw content, which zstd accepts as a dictionary, but which has no ID for
+    # the clients to find it by.
+    options.experimental_distribute.zstd_dictionary = b"0123456789" * 100
+    ds = ds.with_options(options)
+    ds = self.make_distributed_dataset(ds, cluster, compression="ZSTD")
+    with self.assertRaisesRegex(errors.InvalidArgumentError,
+                                "zstd dictionaries with an ID"):
+      self.getDatasetOutput(ds)
+
 
 if __name__ == "__main__":
   test.main()
@@ -56,7 +56,7 @@ class DistributedSaveTest(
   @combinations.generate(
       combinations.times(
           test_base.default_test_combinations(),
-          combinations.combine(compression=[None, "AUTO", "GZIP"])))
+          combinations.combine(compression=[None, "AUTO", "GZIP", "ZSTD"])))
   def testCompression(self, compression):
     cluster = data_service_test_base.TestCluster(num_workers=1)
     snapshot_dir = data_service_test_base.TempDir()
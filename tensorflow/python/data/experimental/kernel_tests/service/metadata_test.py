@@ -187,7 +187,8 @@ class DataServiceMetadataTest(data_service_test_base.TestBase,
 
   @combinations.generate(
       combinations.times(test_base.default_test_combinations(),
-                         combinations.combine(compression=[None, "AUTO"])))
+                         combinations.combine(
+                             compression=[None, "AUTO", "ZSTD"])))
   def testFromDatasetIdOmitsCompression(self, compression):
     cluster = data_service_test_base.TestCluster(
         num_workers=1, data_transfer_protocol="grpc")
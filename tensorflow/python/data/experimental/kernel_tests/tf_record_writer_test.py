@@ -25,6 +25,7 @@ from tensorflow.python.data.ops import readers
 from tensorflow.python.eager import def_function
 from tensorflow.python.framework import combinations
 from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
 from tensorflow.python.lib.io import python_io
 from tensorflow.python.lib.io import tf_record
 from tensorflow.python.ops import string_ops
@@ -84,6 +85,28 @@ class TFRecordWriterTest(test_base.DatasetTestBase, parameterized.TestCase):
         tf_record.tf_record_iterator(self._outputFilename(), options=options)):
       self.assertAllEqual(self._record(i), r)
 
+  @combinations.generate(test_base.default_test_combinations())
+  def testWriteIndex(self):
+    input_dataset = readers.TFRecordDataset(self._createFile())
+    self.evaluate(
+        writers.TFRecordWriter(self._outputFilename(),
+                               write_index=True).write(input_dataset))
+    for i, r in enumerate(tf_record.tf_record_iterator(self._outputFilename())):
+      self.assertAllEqual(self._record(i), r)
+    # One (offset, length) pair per record, then the record count and a crc.
+    self.assertEqual(
+        os.path.getsize(self._outputFilename() + ".idx"),
+        16 * self._num_records + 12)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testWriteIndexCompressed(self):
+    input_dataset = readers.TFRecordDataset(self._createFile())
+    with self.assertRaisesRegex(errors.InvalidArgumentError, "write_index"):
+      self.evaluate(
+          writers.TFRecordWriter(
+              self._outputFilename(), "GZIP",
+              write_index=True).write(input_dataset))
+
   @combinations.generate(test_base.default_test_combinations())
   def testFailDataset(self):
     with self.assertRaises(TypeError):
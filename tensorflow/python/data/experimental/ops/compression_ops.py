@@ -17,11 +17,17 @@ from tensorflow.python.data.util import structure
 from tensorflow.python.ops import gen_experimental_dataset_ops as ged_ops
 
 
-def compress(element):
+def compress(element, codec="SNAPPY", compression_level=3, dictionary=""):
   """Compress a dataset element.
 
   Args:
     element: A nested structure of types supported by Tensorflow.
+    codec: (Optional.) The codec to compress with, either `"SNAPPY"` or
+      `"ZSTD"`.
+    compression_level: (Optional.) The zstd compression level. Negative levels
+      are the fastest. Ignored for snappy.
+    dictionary: (Optional.) A zstd dictionary to compress with. The same
+      dictionary must be passed to `uncompress`. Ignored for snappy.
 
   Returns:
     A variant tensor representing the compressed element. This variant can be
@@ -29,10 +35,14 @@ def compress(element):
   """
   element_spec = structure.type_spec_from_value(element)
   tensor_list = structure.to_tensor_list(element_spec, element)
-  return ged_ops.compress_element(tensor_list)
+  return ged_ops.compress_element(
+      tensor_list,
+      codec=codec,
+      compression_level=compression_level,
+      dictionary=dictionary)
 
 
-def uncompress(element, output_spec):
+def uncompress(element, output_spec, dictionary=""):
   """Uncompress a compressed dataset element.
 
   Args:
@@ -40,6 +50,8 @@ def uncompress(element, output_spec):
       created by calling `compress`.
     output_spec: A nested structure of `tf.TypeSpec` representing the type(s) of
       the uncompressed element.
+    dictionary: (Optional.) The zstd dictionary the element was compressed
+      with, if any.
 
   Returns:
     The uncompressed element.
@@ -47,5 +59,8 @@ def uncompress(element, output_spec):
   flat_types = structure.get_flat_tensor_types(output_spec)
   flat_shapes = structure.get_flat_tensor_shapes(output_spec)
   tensor_list = ged_ops.uncompress_element(
-      element, output_types=flat_types, output_shapes=flat_shapes)
+      element,
+      output_types=flat_types,
+      output_shapes=flat_shapes,
+      dictionary=dictionary)
   return structure.from_tensor_list(output_spec, tensor_list)
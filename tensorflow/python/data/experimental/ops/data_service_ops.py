@@ -39,7 +39,9 @@ from tensorflow.python.saved_model import nested_structure_coder
 from tensorflow.python.util.tf_export import tf_export
 
 COMPRESSION_AUTO = "AUTO"
+COMPRESSION_ZSTD = "ZSTD"
 COMPRESSION_NONE = None
+_DEFAULT_ZSTD_COMPRESSION_LEVEL = 3
 _PARALLEL_EPOCHS = "parallel_epochs"
 _DISTRIBUTED_EPOCH = "distributed_epoch"
 
@@ -183,7 +185,7 @@ def _validate_job_name(job_name) -> None:
 
 
 def _validate_compression(compression) -> None:
-  valid_compressions = [COMPRESSION_AUTO, COMPRESSION_NONE]
+  valid_compressions = [COMPRESSION_AUTO, COMPRESSION_ZSTD, COMPRESSION_NONE]
   if compression not in valid_compressions:
     raise ValueError(f"Invalid `compression` argument: {compression}. "
                      f"Must be one of {valid_compressions}.")
@@ -193,10 +195,13 @@ def _get_compression_proto(
     compression) -> data_service_pb2.DataServiceMetadata.Compression:
   if compression == COMPRESSION_AUTO:
     return data_service_pb2.DataServiceMetadata.COMPRESSION_SNAPPY
+  if compression == COMPRESSION_ZSTD:
+    return data_service_pb2.DataServiceMetadata.COMPRESSION_ZSTD
   if compression == COMPRESSION_NONE:
     return data_service_pb2.DataServiceMetadata.COMPRESSION_OFF
+  valid_compressions = [COMPRESSION_AUTO, COMPRESSION_ZSTD, COMPRESSION_NONE]
   raise ValueError(f"Invalid `compression` argument: {compression}. "
-                   f"Must be one of {[COMPRESSION_AUTO, COMPRESSION_NONE]}.")
+                   f"Must be one of {valid_compressions}.")
 
 
 def _to_tensor(dataset_id) -> tensor.Tensor:
@@ -491,7 +496,11 @@ def _distribute(
       data with the tf.data service. By default, data is transferred using gRPC.
     compression: How to compress the dataset's elements before transferring them
       over the network. "AUTO" leaves the decision of how to compress up to the
-      tf.data service runtime. `None` indicates not to compress.
+      tf.data service runtime. "ZSTD" compresses with Zstandard, which is
+      slower than the default but compresses better, and is never disabled at
+      runtime. Its level and dictionary are set with
+      `tf.data.experimental.DistributeOptions`. `None` indicates not to
+      compress.
     cross_trainer_cache: (Optional.) If a `CrossTrainerCache` object is
       provided, dataset iteration will be shared across concurrently running
       trainers. See
@@ -749,7 +758,11 @@ def distribute(
       data with the tf.data service. By default, data is transferred using gRPC.
     compression: How to compress the dataset's elements before transferring them
       over the network. "AUTO" leaves the decision of how to compress up to the
-      tf.data service runtime. `None` indicates not to compress.
+      tf.data service runtime. "ZSTD" compresses with Zstandard, which is
+      slower than the default but compresses better, and is never disabled at
+      runtime. Its level and dictionary are set with
+      `tf.data.experimental.DistributeOptions`. `None` indicates not to
+      compress.
     cross_trainer_cache: (Optional.) If a `CrossTrainerCache` object is
       provided, dataset iteration will be shared across concurrently running
       trainers. See
@@ -797,7 +810,11 @@ def _register_dataset(
     dataset: A `tf.data.Dataset` to register with the tf.data service.
     compression: How to compress the dataset's elements before transferring them
       over the network. "AUTO" leaves the decision of how to compress up to the
-      tf.data service runtime. `None` indicates not to compress.
+      tf.data service runtime. "ZSTD" compresses with Zstandard, which is
+      slower than the default but compresses better, and is never disabled at
+      runtime. Its level and dictionary are set with
+      `tf.data.experimental.DistributeOptions`. `None` indicates not to
+      compress.
     dataset_id: (Optional.) By default, tf.data service generates a unique
       (string) ID for each registered dataset. If a `dataset_id` is provided, it
       will use the specified ID. If a dataset with a matching ID already exists,
@@ -823,16 +840,29 @@ def _register_dataset(
     encoded_spec = nested_structure_coder.encode_structure(
         dataset.element_spec).SerializeToString()
 
+  metadata = data_service_pb2.DataServiceMetadata(
+      element_spec=encoded_spec,
+      compression=_get_compression_proto(compression))
+
   if compression == COMPRESSION_AUTO:
     dataset = dataset.map(
         lambda *x: compression_ops.compress(x),
         num_parallel_calls=dataset_ops.AUTOTUNE)
+  elif compression == COMPRESSION_ZSTD:
+    # The clients uncompress the elements with the dictionary in the metadata.
+    distribute_options = dataset.options().experimental_distribute
+    level = distribute_options.zstd_compression_level
+    if level is None:
+      level = _DEFAULT_ZSTD_COMPRESSION_LEVEL
+    dictionary = distribute_options.zstd_dictionary or b""
+    metadata.zstd_compression_level = level
+    metadata.zstd_dictionary = dictionary
+    dataset = dataset.map(
+        lambda *x: compression_ops.compress(  # pylint: disable=g-long-lambda
+            x, codec="ZSTD", compression_level=level, dictionary=dictionary),
+        num_parallel_calls=dataset_ops.AUTOTUNE)
   dataset = dataset._apply_debug_options()  # pylint: disable=protected-access
 
-  metadata = data_service_pb2.DataServiceMetadata(
-      element_spec=encoded_spec,
-      compression=_get_compression_proto(compression))
-
   return gen_experimental_dataset_ops.register_dataset_v2(
       dataset._variant_tensor,  # pylint: disable=protected-access
       address=address,
@@ -883,7 +913,10 @@ def register_dataset(
     dataset: A `tf.data.Dataset` to register with the tf.data service.
     compression: (Optional.) How to compress the dataset's elements before
       transferring them over the network. "AUTO" leaves the decision of how to
-      compress up to the tf.data service runtime. `None` indicates not to
+      compress up to the tf.data service runtime. "ZSTD" compresses with
+      Zstandard, which is slower than the default but compresses better, and
+      is never disabled at runtime. Its level and dictionary are set with
+      `tf.data.experimental.DistributeOptions`. `None` indicates not to
       compress.
     dataset_id: (Optional.) By default, tf.data service generates a unique
       (string) ID for each registered dataset. If a `dataset_id` is provided, it
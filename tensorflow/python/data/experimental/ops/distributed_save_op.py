@@ -32,8 +32,9 @@ def distributed_save(dataset, path, dispatcher_address, compression="AUTO"):
       the tf.data service instance used to save `dataset`.
     compression: (Optional.) A string indicating whether and how to compress the
       `dataset` materialization.  If `"AUTO"`, the tf.data runtime decides which
-      algorithm to use.  If `"GZIP"` or `"SNAPPY"`, that specific algorithm is
-      used.  If `None`, the `dataset` materialization is not compressed.
+      algorithm to use.  If `"GZIP"`, `"SNAPPY"` or `"ZSTD"`, that specific
+      algorithm is used.  If `None`, the `dataset` materialization is not
+      compressed.
 
   Returns:
     An operation which when executed performs the distributed save.
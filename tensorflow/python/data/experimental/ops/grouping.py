@@ -14,6 +14,7 @@
 # ==============================================================================
 """Grouping dataset transformations."""
 from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.data.ops import padded_batch_op
 from tensorflow.python.data.ops import structured_function
 from tensorflow.python.data.util import nest
 from tensorflow.python.data.util import structure
@@ -21,6 +22,7 @@ from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import tensor_spec
 from tensorflow.python.ops import gen_experimental_dataset_ops as ged_ops
+from tensorflow.python.ops.ragged import ragged_tensor
 from tensorflow.python.util import deprecation
 from tensorflow.python.util.tf_export import tf_export
 
@@ -385,6 +387,101 @@ class _GroupByReducerDataset(dataset_ops.UnaryDataset):
     return "tf.data.experimental.group_by_reducer()"
 
 
+class _BucketBySequenceLengthDataset(dataset_ops.UnaryDataset):
+  """A `Dataset` that batches elements of similar sequence lengths.
+
+  Unlike `bucket_by_sequence_length()`, the bucketing runs in a single native
+  op: the sequence length of an element is the size of the first dimension of
+  its `length_component`-th component, so no Python function is traced.
+  """
+
+  def __init__(self,
+               input_dataset,
+               bucket_boundaries,
+               bucket_batch_sizes=None,
+               token_budget=0,
+               autotune_window=0,
+               length_component=0,
+               padding_values=None,
+               ragged=False,
+               name=None):
+    """Creates a `_BucketBySequenceLengthDataset`.
+
+    Args:
+      input_dataset: The input dataset, whose elements are tensors.
+      bucket_boundaries: `list<int>`, upper length boundaries of the buckets.
+      bucket_batch_sizes: (Optional.) `list<int>`, batch size per bucket, of
+        length `len(bucket_boundaries) + 1`. May be omitted if `token_budget`
+        is positive.
+      token_budget: (Optional.) The maximum number of tokens of a batch, or 0
+        for no budget. The tokens of a padded batch are its batch size times
+        its padded length, and the tokens of a ragged batch are the sum of the
+        lengths of its elements.
+      autotune_window: (Optional.) If positive, the number of elements whose
+        lengths are observed to replace `bucket_boundaries` with as many
+        quantiles of the observed lengths.
+      length_component: (Optional.) The index of the flattened component whose
+        first dimension is the sequence length.
+      padding_values: (Optional.) Scalars to pad each component with. Defaults
+        to padding with 0.
+      ragged: (Optional.) If `True`, components of rank at least 1 are batched
+        into `tf.RaggedTensor`s rather than padded.
+      name: (Optional.) A name for the tf.data operation.
+    """
+    self._input_dataset = input_dataset
+
+    def batched_spec(component_spec):
+      if not isinstance(component_spec, tensor_spec.TensorSpec):
+        raise TypeError(f"Bucketing by sequence length is only supported for "
+                        f"datasets that produce tensor elements, but got "
+                        f"`{component_spec}`.")
+      if ragged and component_spec.shape.rank != 0:
+        if component_spec.shape.rank is None:
+          raise ValueError("Ragged bucketing requires components of known "
+                           "rank.")
+        return ragged_tensor.RaggedTensorSpec(
+            [None, None] + component_spec.shape.as_list()[1:],
+            component_spec.dtype,
+            ragged_rank=1,
+            row_splits_dtype=dtypes.int64)
+      return tensor_spec.TensorSpec([None] + component_spec.shape.as_list(),
+                                    component_spec.dtype)
+
+    self._structure = nest.map_structure(batched_spec,
+                                         input_dataset.element_spec)
+    padding_values = padded_batch_op._padding_values_or_default(  # pylint: disable=protected-access
+        padding_values, input_dataset)
+    input_types = dataset_ops.get_legacy_output_types(input_dataset)
+    padding_values = nest.map_structure_up_to(
+        input_types,
+        padded_batch_op._padding_value_to_tensor,  # pylint: disable=protected-access
+        padding_values,
+        input_types)
+    if bucket_batch_sizes is None:
+      bucket_batch_sizes = []
+    self._name = name
+    variant_tensor = ged_ops.bucket_by_sequence_length_dataset(
+        input_dataset._variant_tensor,  # pylint: disable=protected-access
+        bucket_boundaries=ops.convert_to_tensor(
+            bucket_boundaries, dtype=dtypes.int64, name="bucket_boundaries"),
+        bucket_batch_sizes=ops.convert_to_tensor(
+            bucket_batch_sizes, dtype=dtypes.int64, name="bucket_batch_sizes"),
+        token_budget=ops.convert_to_tensor(
+            token_budget, dtype=dtypes.int64, name="token_budget"),
+        autotune_window=ops.convert_to_tensor(
+            autotune_window, dtype=dtypes.int64, name="autotune_window"),
+        padding_values=nest.flatten(padding_values),
+        length_component=length_component,
+        ragged=ragged,
+        **self._common_args)
+    super(_BucketBySequenceLengthDataset, self).__init__(input_dataset,
+                                                         variant_tensor)
+
+  @property
+  def element_spec(self):
+    return self._structure
+
+
 @tf_export("data.experimental.Reducer")
 class Reducer:
   """A reducer is used for reducing a set of elements.
@@ -71,7 +71,7 @@ class TFRecordWriter:
   ```
   """
 
-  def __init__(self, filename, compression_type=None):
+  def __init__(self, filename, compression_type=None, write_index=False):
     """Initializes a `TFRecordWriter`.
 
     Args:
@@ -79,6 +79,9 @@ class TFRecordWriter:
       compression_type: (Optional.) a string indicating what type of compression
         to use when writing the file. See `tf.io.TFRecordCompressionType` for
         what types of compression are available. Defaults to `None`.
+      write_index: (Optional.) a boolean indicating whether to also write a
+        record index to `filename + ".idx"`, which allows the file to be read
+        in any order. Not supported with compression. Defaults to `False`.
     """
     self._filename = ops.convert_to_tensor(
         filename, dtypes.string, name="filename")
@@ -87,6 +90,7 @@ class TFRecordWriter:
         compression_type,
         argument_default="",
         argument_dtype=dtypes.string)
+    self._write_index = write_index
 
   def write(self, dataset):
     """Writes a dataset to a TFRecord file.
@@ -123,4 +127,7 @@ class TFRecordWriter:
     # pylint: disable=protected-access
     dataset = dataset._apply_debug_options()
     return gen_experimental_dataset_ops.dataset_to_tf_record(
-        dataset._variant_tensor, self._filename, self._compression_type)
+        dataset._variant_tensor,
+        self._filename,
+        self._compression_type,
+        write_index=self._write_index)
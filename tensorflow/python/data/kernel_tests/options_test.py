@@ -138,6 +138,8 @@ class OptionsTest(test_base.DatasetTestBase, parameterized.TestCase):
     options.experimental_distribute.auto_shard_policy = (
         options_lib.AutoShardPolicy.DATA)
     options.experimental_distribute.num_devices = 1000
+    options.experimental_distribute.zstd_compression_level = -5
+    options.experimental_distribute.zstd_dictionary = b"dictionary"
     options.experimental_optimization.apply_default_optimizations = True
     options.experimental_optimization.filter_fusion = True
     options.experimental_optimization.filter_parallelization = True
@@ -146,6 +148,7 @@ class OptionsTest(test_base.DatasetTestBase, parameterized.TestCase):
     options.experimental_optimization.map_and_filter_fusion = True
     options.experimental_optimization.map_fusion = True
     options.experimental_optimization.map_parallelization = True
+    options.experimental_optimization.map_vectorization = True
     options.experimental_optimization.noop_elimination = True
     options.experimental_optimization.parallel_batch = True
     options.experimental_optimization.shuffle_and_repeat_fusion = True
@@ -154,6 +157,8 @@ class OptionsTest(test_base.DatasetTestBase, parameterized.TestCase):
     options.dataset_name = "test_name"
     options.threading.max_intra_op_parallelism = 30
     options.threading.private_threadpool_size = 40
+    options.threading.numa_aware = True
+    options.threading.work_stealing = True
     pb = options._to_proto()
     result = options_lib.Options()
     result._from_proto(pb)
@@ -288,6 +293,32 @@ class OptionsTest(test_base.DatasetTestBase, parameterized.TestCase):
     dataset = dataset.with_options(options, name="options")
     self.assertDatasetProduces(dataset, [42])
 
+  @combinations.generate(test_base.default_test_combinations())
+  def testNumaAware(self):
+    dataset = dataset_ops.Dataset.range(10)
+    dataset = dataset.map(lambda x: x * 2, num_parallel_calls=4)
+    options = options_lib.Options()
+    options.threading.numa_aware = True
+    dataset = dataset.with_options(options)
+    self.assertDatasetProduces(dataset, [x * 2 for x in range(10)])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testWorkStealing(self):
+    dataset = dataset_ops.Dataset.range(100)
+    dataset = dataset.map(lambda x: x * 2, num_parallel_calls=4)
+    dataset = dataset.batch(10, num_parallel_calls=2)
+    dataset = dataset.unbatch()
+    dataset = dataset.interleave(
+        lambda x: dataset_ops.Dataset.from_tensors(x).repeat(2),
+        cycle_length=2,
+        num_parallel_calls=2)
+    options = options_lib.Options()
+    options.threading.work_stealing = True
+    dataset = dataset.with_options(options)
+    self.assertDatasetProduces(
+        dataset, [x * 2 for x in range(100) for _ in range(2)],
+        assert_items_equal=True)
+
 
 if __name__ == "__main__":
   test.main()
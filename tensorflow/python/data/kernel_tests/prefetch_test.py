@@ -57,6 +57,16 @@ class PrefetchTest(test_base.DatasetTestBase, parameterized.TestCase):
         dataset, buffer_size, slack_period=slack_period)
     self.assertDatasetProduces(dataset, expected_output=range(100))
 
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         combinations.combine(buffer_size=[-1, 0, 1, 42])))
+  def testPrefetchStageOnDevice(self, buffer_size):
+    dataset = dataset_ops.Dataset.range(100).map(lambda x: (x, [x, x]))
+    dataset = prefetch_op._PrefetchDataset(  # pylint: disable=protected-access
+        dataset, buffer_size, stage_on_device=True)
+    self.assertDatasetProduces(
+        dataset, expected_output=[(x, [x, x]) for x in range(100)])
+
   @combinations.generate(combinations.combine(tf_api_version=1, mode="graph"))
   def testPrefetchCancellation(self):
 
@@ -5155,7 +5155,8 @@ def _resource_resolver(op, resource_reads, resource_writes):
 
   updated = False
   if op.type in [
-      "DatasetToSingleElement", "DatasetToTFRecord", "ReduceDataset"
+      "DatasetToColumnarFile", "DatasetToSingleElement", "DatasetToTFRecord",
+      "ReduceDataset"
   ]:
     reads, writes = _collect_resource_inputs(op)
     for inp in reads:
@@ -45,12 +45,18 @@ class AutotuneAlgorithm(enum.Enum):
 
   STAGE_BASED: In each optimization step, this algorithm chooses the worst
   bottleneck parameter and increases its value by 1.
+
+  TAIL_LATENCY: Similar to HILL_CLIMB but models each transformation by the
+  99th percentile of its per-element processing time instead of the mean, and
+  only changes parameters when doing so noticeably changes the modeled latency.
+  Suited to pipelines whose per-element cost is heavy-tailed.
   """
   DEFAULT = 0
   HILL_CLIMB = 1
   GRADIENT_DESCENT = 2
   MAX_PARALLELISM = 3
   STAGE_BASED = 4
+  TAIL_LATENCY = 5
 
   @classmethod
   def _to_proto(cls, obj):
@@ -64,9 +70,12 @@ class AutotuneAlgorithm(enum.Enum):
       return model_pb2.AutotuneAlgorithm.MAX_PARALLELISM
     if obj == cls.STAGE_BASED:
       return model_pb2.AutotuneAlgorithm.STAGE_BASED
+    if obj == cls.TAIL_LATENCY:
+      return model_pb2.AutotuneAlgorithm.TAIL_LATENCY
     raise ValueError(
         f"Invalid `obj.` Supported values include `DEFAULT`, `HILL_CLIMB` "
-        f"`GRADIENT_DESCENT`, and `STAGE_BASED`. Got {obj.name}.")
+        f"`GRADIENT_DESCENT`, `STAGE_BASED` and `TAIL_LATENCY`. "
+        f"Got {obj.name}.")
 
   @classmethod
   def _from_proto(cls, pb):
@@ -80,9 +89,11 @@ class AutotuneAlgorithm(enum.Enum):
       return cls.MAX_PARALLELISM
     if pb == model_pb2.AutotuneAlgorithm.STAGE_BASED:
       return cls.STAGE_BASED
+    if pb == model_pb2.AutotuneAlgorithm.TAIL_LATENCY:
+      return cls.TAIL_LATENCY
     raise ValueError(
         f"Invalid `pb.` Supported values include `DEFAULT`, `HILL_CLIMB`, "
-        f"`GRADIENT_DESCENT` and `STAGE_BASED`. Got {pb}.")
+        f"`GRADIENT_DESCENT`, `STAGE_BASED` and `TAIL_LATENCY`. Got {pb}.")
 
 
 @tf_export("data.experimental.AutoShardPolicy")
@@ -288,17 +299,41 @@ class DistributeOptions(options_lib.OptionsBase):
       "The number of devices attached to this input pipeline. This will be "
       "automatically set by `MultiDeviceIterator`.")
 
+  zstd_compression_level = options_lib.create_option(
+      name="zstd_compression_level",
+      ty=int,
+      docstring=
+      "The zstd compression level of the elements that the tf.data service "
+      "compresses with `compression=\"ZSTD\"`. Negative levels are the "
+      "fastest. If None, defaults to 3.")
+
+  zstd_dictionary = options_lib.create_option(
+      name="zstd_dictionary",
+      ty=bytes,
+      docstring=
+      "A zstd dictionary that the tf.data service compresses elements with, "
+      "when they are compressed with `compression=\"ZSTD\"`. The service "
+      "sends the dictionary to its clients to uncompress the elements.")
+
   def _to_proto(self):
     pb = dataset_options_pb2.DistributeOptions()
     pb.auto_shard_policy = AutoShardPolicy._to_proto(self.auto_shard_policy)  # pylint: disable=protected-access
     if self.num_devices is not None:
       pb.num_devices = self.num_devices
+    if self.zstd_compression_level is not None:
+      pb.zstd_compression_level = self.zstd_compression_level
+    if self.zstd_dictionary is not None:
+      pb.zstd_dictionary = self.zstd_dictionary
     return pb
 
   def _from_proto(self, pb):
     self.auto_shard_policy = AutoShardPolicy._from_proto(pb.auto_shard_policy)  # pylint: disable=protected-access
     if pb.WhichOneof("optional_num_devices") is not None:
       self.num_devices = pb.num_devices
+    if pb.WhichOneof("optional_zstd_compression_level") is not None:
+      self.zstd_compression_level = pb.zstd_compression_level
+    if pb.WhichOneof("optional_zstd_dictionary") is not None:
+      self.zstd_dictionary = pb.zstd_dictionary
 
 
 @tf_export("data.experimental.OptimizationOptions")
@@ -371,6 +406,15 @@ class OptimizationOptions(options_lib.OptionsBase):
       "Whether to parallelize stateless map transformations. If None, defaults "
       "to True.")
 
+  map_vectorization = options_lib.create_option(
+      name="map_vectorization",
+      ty=bool,
+      docstring=
+      "Whether to batch the input of map transformations followed by batch "
+      "transformations, so that map functions made of element-wise ops, or "
+      "parsing examples into fixed-shape dense features, are applied once per "
+      "batch. If None, defaults to False.")
+
   noop_elimination = options_lib.create_option(
       name="noop_elimination",
       ty=bool,
@@ -407,6 +451,8 @@ class OptimizationOptions(options_lib.OptionsBase):
       pb.map_fusion = self.map_fusion
     if self.map_parallelization is not None:
       pb.map_parallelization = self.map_parallelization
+    if self.map_vectorization is not None:
+      pb.map_vectorization = self.map_vectorization
     if self.noop_elimination is not None:
       pb.noop_elimination = self.noop_elimination
     if self.parallel_batch is not None:
@@ -432,6 +478,8 @@ class OptimizationOptions(options_lib.OptionsBase):
       self.map_fusion = pb.map_fusion
     if pb.WhichOneof("optional_map_parallelization") is not None:
       self.map_parallelization = pb.map_parallelization
+    if pb.WhichOneof("optional_map_vectorization") is not None:
+      self.map_vectorization = pb.map_vectorization
     if pb.WhichOneof("optional_noop_elimination") is not None:
       self.noop_elimination = pb.noop_elimination
     if pb.WhichOneof("optional_parallel_batch") is not None:
@@ -475,12 +523,37 @@ class ThreadingOptions(options_lib.OptionsBase):
       "The value 0 can be used to indicate that the threadpool size should be "
       "determined at runtime based on the number of available CPU cores.")
 
+  numa_aware = options_lib.create_option(
+      name="numa_aware",
+      ty=bool,
+      docstring=
+      "Whether to run the threads of each input pipeline on a single NUMA node "
+      "and to allocate its elements from memory local to that node. The node "
+      "is the one the consuming thread is bound to, if any; otherwise "
+      "pipelines are spread across nodes. Has no effect on hosts with a "
+      "single NUMA node. If None, defaults to False.")
+
+  work_stealing = options_lib.create_option(
+      name="work_stealing",
+      ty=bool,
+      docstring=
+      "Whether to run the work of the parallel transformations of the input "
+      "pipeline on a work-stealing scheduler shared by all the pipelines of "
+      "the process, instead of the inter-op threadpool. The scheduler runs the "
+      "work of the transformations closest to the consumer, and with the "
+      "emptiest buffers, first. Has no effect if the pipeline uses a private "
+      "threadpool. If None, defaults to False.")
+
   def _to_proto(self):
     pb = dataset_options_pb2.ThreadingOptions()
     if self.max_intra_op_parallelism is not None:
       pb.max_intra_op_parallelism = self.max_intra_op_parallelism
     if self.private_threadpool_size is not None:
       pb.private_threadpool_size = self.private_threadpool_size
+    if self.numa_aware is not None:
+      pb.numa_aware = self.numa_aware
+    if self.work_stealing is not None:
+      pb.work_stealing = self.work_stealing
     return pb
 
   def _from_proto(self, pb):
@@ -488,6 +561,10 @@ class ThreadingOptions(options_lib.OptionsBase):
       self.max_intra_op_parallelism = pb.max_intra_op_parallelism
     if pb.WhichOneof("optional_private_threadpool_size") is not None:
       self.private_threadpool_size = pb.private_threadpool_size
+    if pb.WhichOneof("optional_numa_aware") is not None:
+      self.numa_aware = pb.numa_aware
+    if pb.WhichOneof("optional_work_stealing") is not None:
+      self.work_stealing = pb.work_stealing
 
 
 @tf_export("data.Options")
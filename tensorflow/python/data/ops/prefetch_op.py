@@ -31,7 +31,12 @@ def _prefetch(input_dataset, buffer_size, name=None):  # pylint: disable=unused-
 class _PrefetchDataset(dataset_ops.UnaryUnchangedStructureDataset):
   """A `Dataset` that asynchronously prefetches its input."""
 
-  def __init__(self, input_dataset, buffer_size, slack_period=None, name=None):
+  def __init__(self,
+               input_dataset,
+               buffer_size,
+               slack_period=None,
+               stage_on_device=False,
+               name=None):
     """See `Dataset.prefetch()` for details."""
     self._input_dataset = input_dataset
     if buffer_size is None:
@@ -47,5 +52,6 @@ class _PrefetchDataset(dataset_ops.UnaryUnchangedStructureDataset):
           input_dataset._variant_tensor,
           buffer_size=self._buffer_size,
           slack_period=slack_period,
+          stage_on_device=stage_on_device,
           **self._common_args)
     super().__init__(input_dataset, variant_tensor)
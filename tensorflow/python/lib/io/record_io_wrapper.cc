@@ -323,7 +323,8 @@ PYBIND11_MODULE(_pywrap_record_io, m) {
   py::class_<RecordWriterOptions>(m, "RecordWriterOptions")
       .def(py::init(&RecordWriterOptions::CreateRecordWriterOptions))
       .def_readonly("compression_type", &RecordWriterOptions::compression_type)
-      .def_readonly("zlib_options", &RecordWriterOptions::zlib_options);
+      .def_readonly("zlib_options", &RecordWriterOptions::zlib_options)
+      .def_readwrite("zlib_block_size", &RecordWriterOptions::zlib_block_size);
 
   using tensorflow::MaybeRaiseRegisteredFromStatus;
 
@@ -53,7 +53,8 @@ class TFRecordOptions(object):
                compression_level=None,
                compression_method=None,
                mem_level=None,
-               compression_strategy=None):
+               compression_strategy=None,
+               zlib_block_size=None):
     # pylint: disable=line-too-long
     """Creates a `TFRecordOptions` instance.
 
@@ -73,17 +74,27 @@ class TFRecordOptions(object):
       compression_method: compression method or `None`.
       mem_level: 1 to 9, or `None`.
       compression_strategy: strategy or `None`. Default: Z_DEFAULT_STRATEGY.
+      zlib_block_size: int or `None`. Only valid with `"GZIP"` compression.
+        If set, records are compressed in independent gzip members of this
+        many uncompressed bytes, which `tf.data.TFRecordDataset` inflates in
+        parallel. The files remain readable as `"GZIP"` by other readers.
+        Default: a single stream.
 
     Returns:
       A `TFRecordOptions` object.
 
     Raises:
-      ValueError: If compression_type is invalid.
+      ValueError: If compression_type is invalid, or if zlib_block_size is set
+        without `"GZIP"` compression.
     """
     # pylint: enable=line-too-long
     # Check compression_type is valid, but for backwards compatibility don't
     # immediately convert to a string.
-    self.get_compression_type_string(compression_type)
+    compression_type_string = self.get_compression_type_string(
+        compression_type)
+    if zlib_block_size is not None and compression_type_string != "GZIP":
+      raise ValueError("zlib_block_size requires GZIP compression, got "
+                       f"compression_type {compression_type_string!r}.")
     self.compression_type = compression_type
     self.flush_mode = flush_mode
     self.input_buffer_size = input_buffer_size
@@ -93,6 +104,7 @@ class TFRecordOptions(object):
     self.compression_method = compression_method
     self.mem_level = mem_level
     self.compression_strategy = compression_strategy
+    self.zlib_block_size = zlib_block_size
 
   @classmethod
   def get_compression_type_string(cls, options):
@@ -142,6 +154,8 @@ class TFRecordOptions(object):
       options.zlib_options.mem_level = self.mem_level
     if self.compression_strategy is not None:
       options.zlib_options.compression_strategy = self.compression_strategy
+    if self.zlib_block_size is not None:
+      options.zlib_block_size = self.zlib_block_size
     return options
 
 
@@ -358,6 +358,24 @@ class TFRecordWriterZlibTest(TFCompressionTestCase):
     actual = list(tf_record.tf_record_iterator(gzfn, options=options))
     self.assertEqual(actual, original)
 
+  def testGzipBlocksReadWrite(self):
+    """Verify that block-compressed files are gzip compatible."""
+    original = [self._Record(0, i) for i in range(100)]
+    options = tf_record.TFRecordOptions(
+        TFRecordCompressionType.GZIP, zlib_block_size=64)
+    gzfn = self._WriteRecordsToFile(original, "gzip_blocks.tfrecord.gz",
+                                    options)
+    fn = self._GzipDecompressFile(gzfn, "gzip_blocks.tfrecord")
+
+    options = tf_record.TFRecordOptions(TFRecordCompressionType.NONE)
+    actual = list(tf_record.tf_record_iterator(fn, options=options))
+    self.assertEqual(actual, original)
+
+  def testZlibBlocksRejected(self):
+    with self.assertRaisesRegex(ValueError, "requires GZIP compression"):
+      tf_record.TFRecordOptions(
+          TFRecordCompressionType.ZLIB, zlib_block_size=64)
+
 
 class TFRecordIteratorTest(TFCompressionTestCase):
   """TFRecordIterator test"""
@@ -23,6 +23,7 @@ limitations under the License.
 #include "absl/strings/string_view.h"
 #include "tsl/framework/allocator_retry.h"
 #include "tsl/lib/core/bits.h"
+#include "tsl/platform/cpu_info.h"
 #include "tsl/platform/file_system.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/mutex.h"
@@ -84,6 +85,16 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
       CHECK_NE(BinForSize(bin_size * 2), BinFromIndex(b));
     }
   }
+
+  if (opts.cpu_cache_bytes > 0) {
+    const int num_cpus = std::max(port::NumTotalCPUs(), 1);
+    VLOG(1) << "Creating " << num_cpus << " CPU caches of "
+            << strings::HumanReadableNumBytes(opts.cpu_cache_bytes);
+    cpu_caches_.reserve(num_cpus);
+    for (int i = 0; i < num_cpus; ++i) {
+      cpu_caches_.push_back(std::make_unique<CpuCache>());
+    }
+  }
 }
 
 BFCAllocator::~BFCAllocator() {
@@ -264,6 +275,15 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes;
+  if (!cpu_caches_.empty() && allocation_attr.freed_by_func == nullptr &&
+      timing_counter_ == nullptr && num_bytes > 0 &&
+      RoundedBytes(num_bytes) <= kMaxCachedChunkSize) {
+    void* ptr = AllocateFromCpuCache(num_bytes);
+    if (ptr != nullptr) {
+      VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " " << ptr;
+      return ptr;
+    }
+  }
   void* result = [&] {
     if (!opts_.allow_retry_on_failure || !allocation_attr.retry_on_failure) {
       // If we have globally disabled retry-on-failure and fail to allocate an
@@ -466,6 +486,16 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     }
   }
 
+  // Return the chunks held by the CPU caches to the bins, where they may be
+  // coalesced into a chunk that fits.
+  if (DrainCpuCaches()) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
   // Reaching this point means that no chunks can satisfy the request. Also,
   // the unallocated bytes cannot satisfy the request. Before giving up, let's
   // try deallocating free regions so that suballocator can combine them with
@@ -603,12 +633,18 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
         // Update stats.
         ++stats_.num_allocs;
         stats_.bytes_in_use += chunk->size;
-        if (stats_.bytes_in_use > stats_.peak_bytes_in_use) {
-          VLOG(2) << "New Peak memory usage of " << stats_.bytes_in_use
+        bins_bytes_in_use_.store(stats_.bytes_in_use,
+                                 std::memory_order_relaxed);
+        // Chunks held by the CPU caches are not in use by anyone.
+        const int64_t bytes_in_use =
+            stats_.bytes_in_use -
+            cpu_cached_bytes_.load(std::memory_order_relaxed);
+        if (bytes_in_use > stats_.peak_bytes_in_use) {
+          VLOG(2) << "New Peak memory usage of " << bytes_in_use
                   << " bytes for " << Name();
         }
         stats_.peak_bytes_in_use =
-            std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+            std::max(stats_.peak_bytes_in_use, bytes_in_use);
         stats_.largest_alloc_size =
             std::max<std::size_t>(stats_.largest_alloc_size, chunk->size);
 
@@ -689,6 +725,11 @@ void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(4) << "[mem-debug] DeallocateRaw," << Name() << ","
           << (ptr ? RequestedSize(ptr) : 0) << "," << ptr << ","
           << tsl::CurrentStackTrace();
+  // Cached chunks are not returned to the bins, so there is no need to wake up
+  // allocations waiting for memory.
+  if (!cpu_caches_.empty() && DeallocateToCpuCache(ptr)) {
+    return;
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
@@ -728,6 +769,297 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   }
 }
 
+BFCAllocator::CpuCache* BFCAllocator::CurrentCpuCache() {
+  int cpu = port::GetCurrentCPU();
+  if (cpu < 0) {
+    // The current CPU is unknown on this platform, so each thread uses a
+    // cache of its own instead, shared round-robin if there are more threads
+    // than caches.
+    static std::atomic<int> next_thread_index{0};
+    static thread_local const int thread_index = next_thread_index++;
+    cpu = thread_index;
+  }
+  return cpu_caches_[cpu % cpu_caches_.size()].get();
+}
+
+BFCAllocator::CpuCacheChunkShard& BFCAllocator::CpuCacheChunkShardFor(
+    const void* ptr) const {
+  return cpu_cache_chunks_[(reinterpret_cast<uintptr_t>(ptr) >>
+                            kMinAllocationBits) %
+                           kNumCpuCacheChunkShards];
+}
+
+bool BFCAllocator::FindCpuCacheChunk(const void* ptr,
+                                     CpuCacheChunk* chunk) const {
+  if (cpu_caches_.empty()) {
+    return false;
+  }
+  CpuCacheChunkShard& shard = CpuCacheChunkShardFor(ptr);
+  mutex_lock shard_lock(shard.mu);
+  auto it = shard.chunks.find(ptr);
+  if (it == shard.chunks.end()) {
+    return false;
+  }
+  *chunk = it->second;
+  return true;
+}
+
+BFCAllocator::CpuCacheChunk BFCAllocator::ReleaseCpuCacheChunk(void* ptr) {
+  CpuCacheChunkShard& shard = CpuCacheChunkShardFor(ptr);
+  mutex_lock shard_lock(shard.mu);
+  auto it = shard.chunks.find(ptr);
+  CHECK(it != shard.chunks.end());
+  const CpuCacheChunk chunk = it->second;
+  shard.chunks.erase(it);
+  return chunk;
+}
+
+// Only takes `lock_`, in shared mode, on a hit if memory allocations are being
+// traced, since AddTraceMe() reads `stats_`.
+void* BFCAllocator::AllocateFromCpuCache(size_t num_bytes)
+    TF_NO_THREAD_SAFETY_ANALYSIS {
+  const size_t rounded_bytes = RoundedBytes(num_bytes);
+  CpuCache* cache = CurrentCpuCache();
+  void* ptr = nullptr;
+  {
+    mutex_lock cache_lock(cache->mu);
+    std::vector<void*>& chunks =
+        cache->chunks[CpuCacheSizeClass(rounded_bytes)];
+    if (!chunks.empty()) {
+      ptr = chunks.back();
+      chunks.pop_back();
+      cache->bytes -= rounded_bytes;
+      ++cache->num_allocs;
+      cache->largest_alloc_size = std::max<int64_t>(cache->largest_alloc_size,
+                                                    rounded_bytes);
+    }
+  }
+  if (ptr == nullptr) {
+    return RefillCpuCache(cache, rounded_bytes, num_bytes);
+  }
+
+  {
+    CpuCacheChunkShard& shard = CpuCacheChunkShardFor(ptr);
+    mutex_lock shard_lock(shard.mu);
+    CpuCacheChunk& chunk = shard.chunks[ptr];
+    DCHECK_EQ(chunk.size, rounded_bytes);
+    chunk.requested_size = num_bytes;
+    chunk.allocation_id = next_allocation_id_++;
+  }
+
+  // The chunk is now in use: update the peak with the bytes in use as of
+  // this allocation.
+  const int64_t cached_bytes =
+      cpu_cached_bytes_.fetch_sub(rounded_bytes, std::memory_order_relaxed) -
+      rounded_bytes;
+  const int64_t bytes_in_use =
+      bins_bytes_in_use_.load(std::memory_order_relaxed) - cached_bytes;
+  int64_t peak_bytes_in_use =
+      cpu_cache_peak_bytes_in_use_.load(std::memory_order_relaxed);
+  while (bytes_in_use > peak_bytes_in_use &&
+         !cpu_cache_peak_bytes_in_use_.compare_exchange_weak(
+             peak_bytes_in_use, bytes_in_use, std::memory_order_relaxed)) {
+  }
+
+  if (profiler::TraceMe::Active(profiler::TraceMeLevel::kInfo)) {
+    tf_shared_lock l(lock_);
+    AddTraceMe("MemoryAllocation", ptr, num_bytes, rounded_bytes);
+  }
+  return ptr;
+}
+
+void* BFCAllocator::RefillCpuCache(CpuCache* cache, size_t rounded_bytes,
+                                   size_t num_bytes) {
+  const BinNum bin_num = BinNumForSize(rounded_bytes);
+  mutex_lock l(lock_);
+  void* ptr =
+      FindChunkPtr(bin_num, rounded_bytes, num_bytes, /*freed_before=*/0);
+  if (ptr == nullptr) {
+    // Leave extending the pool, and reporting failures, to the general path.
+    return nullptr;
+  }
+  AddTraceMe("MemoryAllocation", ptr);
+
+  // FindChunkPtr() counts the chunks added to the cache in the statistics of
+  // allocations, but they are only counted once they are handed out.
+  const int64_t num_allocs = stats_.num_allocs;
+  const int64_t peak_bytes_in_use = stats_.peak_bytes_in_use;
+  const int64_t largest_alloc_size = stats_.largest_alloc_size;
+  size_t cached_bytes = 0;
+  {
+    mutex_lock cache_lock(cache->mu);
+    std::vector<void*>& chunks =
+        cache->chunks[CpuCacheSizeClass(rounded_bytes)];
+    for (int i = 1; i < kCpuCacheBatchSize &&
+                    cache->bytes + rounded_bytes <= opts_.cpu_cache_bytes;
+         ++i) {
+      void* cached_ptr = FindChunkPtr(bin_num, rounded_bytes,
+                                      /*num_bytes=*/0, /*freed_before=*/0);
+      if (cached_ptr == nullptr) {
+        break;
+      }
+      const ChunkHandle h = region_manager_.get_handle(cached_ptr);
+      const Chunk* chunk = ChunkFromHandle(h);
+      if (chunk->size != rounded_bytes) {
+        // The chunk was not worth splitting, so the bins have no chunk of this
+        // size class left.
+        FreeCachedChunk(h);
+        break;
+      }
+      {
+        CpuCacheChunkShard& shard = CpuCacheChunkShardFor(cached_ptr);
+        mutex_lock shard_lock(shard.mu);
+        shard.chunks[cached_ptr] = {h, chunk->size, chunk->requested_size,
+                                    chunk->allocation_id};
+      }
+      chunks.push_back(cached_ptr);
+      cache->bytes += rounded_bytes;
+      cached_bytes += rounded_bytes;
+    }
+  }
+  cpu_cached_bytes_.fetch_add(cached_bytes, std::memory_order_relaxed);
+  stats_.num_allocs = num_allocs;
+  stats_.peak_bytes_in_use = peak_bytes_in_use;
+  stats_.largest_alloc_size = largest_alloc_size;
+  return ptr;
+}
+
+// Like AllocateFromCpuCache(), only takes `lock_` in shared mode to trace the
+// deallocation, and to take ownership of a chunk not owned by the CPU caches
+// yet.
+bool BFCAllocator::DeallocateToCpuCache(void* ptr)
+    TF_NO_THREAD_SAFETY_ANALYSIS {
+  if (ptr == nullptr || timing_counter_ != nullptr) {
+    return false;
+  }
+  CpuCacheChunk chunk;
+  if (!FindCpuCacheChunk(ptr, &chunk)) {
+    tf_shared_lock l(lock_);
+    const ChunkHandle h = region_manager_.get_handle(ptr);
+    CHECK(h != kInvalidChunkHandle);
+    const Chunk* c = ChunkFromHandle(h);
+    if (c->size > kMaxCachedChunkSize) {
+      return false;
+    }
+    chunk = {h, c->size, c->requested_size, c->allocation_id};
+    CpuCacheChunkShard& shard = CpuCacheChunkShardFor(ptr);
+    mutex_lock shard_lock(shard.mu);
+    shard.chunks[ptr] = chunk;
+  }
+  if (profiler::TraceMe::Active(profiler::TraceMeLevel::kInfo)) {
+    tf_shared_lock l(lock_);
+    AddTraceMe("MemoryDeallocation", ptr, chunk.requested_size, chunk.size);
+  }
+  cpu_cached_bytes_.fetch_add(chunk.size, std::memory_order_relaxed);
+
+  CpuCache* cache = CurrentCpuCache();
+  std::vector<void*> evicted;
+  {
+    mutex_lock cache_lock(cache->mu);
+    cache->chunks[CpuCacheSizeClass(chunk.size)].push_back(ptr);
+    cache->bytes += chunk.size;
+    if (cache->bytes <= opts_.cpu_cache_bytes) {
+      return true;
+    }
+    // The cache is full: evict its oldest chunks, largest size classes first,
+    // until it is half full. The evicted chunks stay counted in
+    // `cache->bytes` and `cpu_cached_bytes_` until they are back in the bins,
+    // so that GetStats() does not count them as in use in the meantime.
+    size_t evicted_bytes = 0;
+    for (int size_class = kNumCpuCacheSizeClasses - 1;
+         size_class >= 0 &&
+         cache->bytes - evicted_bytes > opts_.cpu_cache_bytes / 2;
+         --size_class) {
+      std::vector<void*>& chunks = cache->chunks[size_class];
+      const size_t chunk_size = (size_class + 1) * kMinAllocationSize;
+      auto end = chunks.begin();
+      while (end != chunks.end() &&
+             cache->bytes - evicted_bytes > opts_.cpu_cache_bytes / 2) {
+        evicted_bytes += chunk_size;
+        ++end;
+      }
+      evicted.insert(evicted.end(), chunks.begin(), end);
+      chunks.erase(chunks.begin(), end);
+    }
+  }
+
+  {
+    mutex_lock l(lock_);
+    size_t evicted_bytes = 0;
+    for (void* evicted_ptr : evicted) {
+      const CpuCacheChunk evicted_chunk = ReleaseCpuCacheChunk(evicted_ptr);
+      evicted_bytes += evicted_chunk.size;
+      FreeCachedChunk(evicted_chunk.handle);
+    }
+    cpu_cached_bytes_.fetch_sub(evicted_bytes, std::memory_order_relaxed);
+    mutex_lock cache_lock(cache->mu);
+    cache->bytes -= evicted_bytes;
+  }
+  retry_helper_.NotifyDealloc();
+  return true;
+}
+
+bool BFCAllocator::DrainCpuCaches() {
+  if (cpu_caches_.empty()) {
+    return false;
+  }
+  bool drained = false;
+  for (const std::unique_ptr<CpuCache>& cache : cpu_caches_) {
+    mutex_lock cache_lock(cache->mu);
+    // Chunks evicted by a concurrent DeallocateToCpuCache() are no longer in
+    // `cache->chunks`, but still counted in `cache->bytes`.
+    size_t drained_bytes = 0;
+    for (std::vector<void*>& chunks : cache->chunks) {
+      for (void* ptr : chunks) {
+        const CpuCacheChunk chunk = ReleaseCpuCacheChunk(ptr);
+        drained_bytes += chunk.size;
+        FreeCachedChunk(chunk.handle);
+        drained = true;
+      }
+      chunks.clear();
+    }
+    cache->bytes -= drained_bytes;
+    cpu_cached_bytes_.fetch_sub(drained_bytes, std::memory_order_relaxed);
+  }
+
+  // The chunks handed out by the caches remain owned by them, but their
+  // metadata is needed in `chunks_` to render them.
+  for (CpuCacheChunkShard& shard : cpu_cache_chunks_) {
+    mutex_lock shard_lock(shard.mu);
+    for (const auto& [ptr, chunk] : shard.chunks) {
+      Chunk* c = ChunkFromHandle(chunk.handle);
+      c->requested_size = chunk.requested_size;
+      c->allocation_id = chunk.allocation_id;
+    }
+  }
+  FoldCpuCacheStats();
+  return drained;
+}
+
+void BFCAllocator::FoldCpuCacheStats() {
+  for (const std::unique_ptr<CpuCache>& cache : cpu_caches_) {
+    mutex_lock cache_lock(cache->mu);
+    stats_.num_allocs += cache->num_allocs;
+    cache->num_allocs = 0;
+    stats_.largest_alloc_size =
+        std::max(stats_.largest_alloc_size, cache->largest_alloc_size);
+    cache->largest_alloc_size = 0;
+  }
+  stats_.peak_bytes_in_use = std::max(
+      stats_.peak_bytes_in_use,
+      cpu_cache_peak_bytes_in_use_.exchange(0, std::memory_order_relaxed));
+}
+
+void BFCAllocator::FreeCachedChunk(ChunkHandle h) {
+  MarkFree(h);
+  if (timing_counter_) {
+    InsertFreeChunkIntoBin(h);
+    timestamped_chunks_.push_back(h);
+  } else {
+    InsertFreeChunkIntoBin(TryToCoalesce(h, false));
+  }
+}
+
 // Merges h1 and h2 when Chunk(h1)->next is h2 and Chunk(h2)->prev is c1.
 // We merge Chunk(h2) into Chunk(h1).
 void BFCAllocator::Merge(BFCAllocator::ChunkHandle h1,
@@ -811,6 +1143,7 @@ void BFCAllocator::MarkFree(BFCAllocator::ChunkHandle h) {
 
   // Updates the stats.
   stats_.bytes_in_use -= c->size;
+  bins_bytes_in_use_.store(stats_.bytes_in_use, std::memory_order_relaxed);
 
 #ifdef TENSORFLOW_MEM_DEBUG
   if (ShouldRecordOpName()) {
@@ -942,6 +1275,10 @@ bool BFCAllocator::TracksAllocationSizes() const { return true; }
 
 size_t BFCAllocator::RequestedSize(const void* ptr) const {
   CHECK(ptr);
+  CpuCacheChunk cached;
+  if (FindCpuCacheChunk(ptr, &cached)) {
+    return cached.requested_size;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -960,6 +1297,10 @@ size_t BFCAllocator::AllocatedSize(const void* ptr) const {
 }
 
 int64_t BFCAllocator::AllocationId(const void* ptr) const {
+  CpuCacheChunk cached;
+  if (FindCpuCacheChunk(ptr, &cached)) {
+    return cached.allocation_id;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -1141,6 +1482,7 @@ void BFCAllocator::MaybeWriteMemoryMap() {
 
 MemoryDump BFCAllocator::RecordMemoryMap() {
   mutex_lock l(lock_);
+  DrainCpuCaches();
   return RecordMemoryMapInternal();
 }
 
@@ -1212,13 +1554,18 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
-  return stats_;
+  FoldCpuCacheStats();
+  AllocatorStats stats = stats_;
+  stats.bytes_in_use -= cpu_cached_bytes_.load(std::memory_order_relaxed);
+  return stats;
 }
 
 bool BFCAllocator::ClearStats() {
   mutex_lock l(lock_);
+  FoldCpuCacheStats();
   stats_.num_allocs = 0;
-  stats_.peak_bytes_in_use = stats_.bytes_in_use;
+  stats_.peak_bytes_in_use =
+      stats_.bytes_in_use - cpu_cached_bytes_.load(std::memory_order_relaxed);
   stats_.largest_alloc_size = 0;
   return true;
 }
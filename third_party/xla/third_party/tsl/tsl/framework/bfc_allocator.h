@@ -17,12 +17,14 @@ limitations under the License.
 #define TENSORFLOW_TSL_FRAMEWORK_BFC_ALLOCATOR_H_
 
 #include <array>
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tsl/framework/allocator.h"
 #include "tsl/framework/allocator_retry.h"
@@ -68,6 +70,16 @@ class BFCAllocator : public Allocator {
     // Controls when a chunk should be split, if its size exceeds the requested
     // allocation size.
     double fragmentation_fraction = 0;
+
+    // If positive, freed chunks of at most 32KiB are kept in per-CPU caches
+    // of up to this many bytes each, and handed out again without taking the
+    // allocator-wide lock. Caches are refilled from and drained to the bins in
+    // batches. Allocations that pass a `freed_by_func`, and allocators with a
+    // timing counter, bypass the caches.
+    //
+    // GetStats() counts cached chunks in none of its statistics until they are
+    // handed out. RecordMemoryMap() drains the caches first.
+    size_t cpu_cache_bytes = 0;
   };
   BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
                const string& name, const Options& opts);
@@ -120,6 +132,52 @@ class BFCAllocator : public Allocator {
 
   void DeallocateRawInternal(void* ptr);
 
+  // A cache of freed chunks of at most kMaxCachedChunkSize bytes. The chunks
+  // of a cache remain in use as far as the bins are concerned. Their metadata
+  // is kept in `cpu_cache_chunks_` rather than `chunks_`, from the time they
+  // are first cached until they are returned to the bins, so that they are
+  // handed out and cached again without `lock_`.
+  struct CpuCache;
+  struct CpuCacheChunk;
+  struct CpuCacheChunkShard;
+
+  // Returns the shard of `cpu_cache_chunks_` that `ptr` belongs to.
+  CpuCacheChunkShard& CpuCacheChunkShardFor(const void* ptr) const;
+
+  // Sets `*chunk` to the metadata of the chunk at `ptr` if it is owned by the
+  // CPU caches, and returns whether it is.
+  bool FindCpuCacheChunk(const void* ptr, CpuCacheChunk* chunk) const;
+
+  // Removes the chunk at `ptr` from `cpu_cache_chunks_`, and returns its
+  // metadata.
+  CpuCacheChunk ReleaseCpuCacheChunk(void* ptr);
+
+  // Returns the cache of the CPU the calling thread runs on.
+  CpuCache* CurrentCpuCache();
+
+  // Returns a cached chunk of `RoundedBytes(num_bytes)` bytes, refilling the
+  // cache of the current CPU on a miss. Returns nullptr if the bins have no
+  // such chunk either.
+  void* AllocateFromCpuCache(size_t num_bytes);
+
+  // Allocates a chunk of `rounded_bytes` bytes from the bins, plus up to
+  // kCpuCacheBatchSize - 1 more that are added to `cache`.
+  void* RefillCpuCache(CpuCache* cache, size_t rounded_bytes,
+                       size_t num_bytes);
+
+  // Adds the chunk of `ptr` to the cache of the current CPU, returning the
+  // oldest cached chunks to the bins if the cache is full. Returns false if
+  // the chunk is too large to be cached.
+  bool DeallocateToCpuCache(void* ptr);
+
+  // Returns the chunks of all the caches to the bins, writes the metadata of
+  // the chunks they handed out back to `chunks_`, and folds their statistics
+  // into `stats_`. Returns true if any chunk was returned.
+  bool DrainCpuCaches() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Folds the statistics of the caches into `stats_`.
+  void FoldCpuCacheStats() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
   //
@@ -277,6 +335,46 @@ class BFCAllocator : public Allocator {
   static constexpr size_t kMinAllocationBits = 8;
   static constexpr size_t kMinAllocationSize = 1 << kMinAllocationBits;
 
+  // Chunks of up to kMaxCachedChunkSize bytes are cached, in one size class
+  // per multiple of kMinAllocationSize.
+  static constexpr size_t kMaxCachedChunkSize = 32 << 10;
+  static constexpr int kNumCpuCacheSizeClasses =
+      kMaxCachedChunkSize / kMinAllocationSize;
+  // The number of chunks a cache is refilled with on a miss.
+  static constexpr int kCpuCacheBatchSize = 8;
+
+  struct CpuCache {
+    mutex mu;
+    // The pointers to the cached chunks of each size class, oldest first.
+    std::vector<void*> chunks[kNumCpuCacheSizeClasses] TF_GUARDED_BY(mu);
+    // The total size of the cached chunks.
+    size_t bytes TF_GUARDED_BY(mu) = 0;
+    // The allocations served by this cache, and the largest of them, since
+    // its statistics were last folded into `stats_`.
+    int64_t num_allocs TF_GUARDED_BY(mu) = 0;
+    int64_t largest_alloc_size TF_GUARDED_BY(mu) = 0;
+  };
+
+  // The metadata of a chunk owned by the CPU caches.
+  struct CpuCacheChunk {
+    ChunkHandle handle = kInvalidChunkHandle;
+    size_t size = 0;
+    size_t requested_size = 0;
+    int64_t allocation_id = -1;
+  };
+
+  // The chunks owned by the CPU caches are sharded by address, so that
+  // threads handing out and caching different chunks rarely contend.
+  static constexpr int kNumCpuCacheChunkShards = 64;
+  struct CpuCacheChunkShard {
+    mutex mu;
+    absl::flat_hash_map<const void*, CpuCacheChunk> chunks TF_GUARDED_BY(mu);
+  };
+
+  static int CpuCacheSizeClass(size_t rounded_bytes) {
+    return rounded_bytes / kMinAllocationSize - 1;
+  }
+
   // BFCAllocator allocates memory into a collection of disjoint
   // AllocationRegions.  Each AllocationRegion corresponds to one call to
   // SubAllocator::Alloc().  (Actually, if a subsequent call to
@@ -511,6 +609,9 @@ class BFCAllocator : public Allocator {
 
   void MarkFree(ChunkHandle h) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Returns the in-use chunk `h` of a CPU cache to the bins.
+  void FreeCachedChunk(ChunkHandle h) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   ChunkHandle TryToCoalesce(ChunkHandle h, bool ignore_freed_at)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
@@ -607,8 +708,22 @@ class BFCAllocator : public Allocator {
   ChunkHandle free_chunks_list_ TF_GUARDED_BY(lock_);
 
   // Counter containing the next unique identifier to assign to a
-  // newly-created chunk.
-  int64_t next_allocation_id_ TF_GUARDED_BY(lock_);
+  // newly-created chunk. Atomic, since chunks are handed out by the CPU caches
+  // without `lock_`.
+  std::atomic<int64_t> next_allocation_id_;
+
+  // Empty unless `opts_.cpu_cache_bytes` is positive.
+  std::vector<std::unique_ptr<CpuCache>> cpu_caches_;
+  // The chunks owned by the CPU caches, whether cached or handed out.
+  mutable CpuCacheChunkShard cpu_cache_chunks_[kNumCpuCacheChunkShards];
+  // The total size of the chunks held by the CPU caches, which
+  // `stats_.bytes_in_use` includes but GetStats() does not.
+  std::atomic<int64_t> cpu_cached_bytes_{0};
+  // A copy of `stats_.bytes_in_use` that can be read without `lock_`.
+  std::atomic<int64_t> bins_bytes_in_use_{0};
+  // The peak number of bytes in use reached by handing out cached chunks,
+  // since it was last folded into `stats_.peak_bytes_in_use`.
+  std::atomic<int64_t> cpu_cache_peak_bytes_in_use_{0};
 
   // Stats.
   AllocatorStats stats_ TF_GUARDED_BY(lock_);
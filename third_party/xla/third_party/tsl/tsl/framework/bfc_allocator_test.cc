@@ -0,0 +1,273 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/framework/bfc_allocator.h"
+
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "tsl/platform/blocking_counter.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/mem.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
+#include "tsl/platform/threadpool.h"
+#include "tsl/protobuf/bfc_memory_map.pb.h"
+
+namespace tsl {
+namespace {
+
+// Allocates host memory with port::AlignedMalloc().
+class HostSubAllocator : public SubAllocator {
+ public:
+  HostSubAllocator() : SubAllocator({}, {}) {}
+
+  void* Alloc(size_t alignment, size_t num_bytes,
+              size_t* bytes_received) override {
+    *bytes_received = num_bytes;
+    return port::AlignedMalloc(num_bytes, Allocator::kAllocatorAlignment);
+  }
+
+  void Free(void* ptr, size_t num_bytes) override { port::AlignedFree(ptr); }
+
+  bool SupportsCoalescing() const override { return false; }
+};
+
+std::unique_ptr<BFCAllocator> MakeAllocator(size_t total_memory,
+                                            size_t cpu_cache_bytes) {
+  BFCAllocator::Options opts;
+  opts.allow_growth = false;
+  opts.allow_retry_on_failure = false;
+  opts.cpu_cache_bytes = cpu_cache_bytes;
+  return std::make_unique<BFCAllocator>(std::make_unique<HostSubAllocator>(),
+                                        total_memory, "host_bfc", opts);
+}
+
+TEST(BFCAllocatorCpuCacheTest, Stats) {
+  std::unique_ptr<BFCAllocator> a = MakeAllocator(1 << 20, 64 << 10);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 10; ++i) {
+    ptrs.push_back(a->AllocateRaw(Allocator::kAllocatorAlignment, 1000));
+    ASSERT_NE(ptrs.back(), nullptr);
+  }
+  for (int i = 0; i < 5; ++i) {
+    a->DeallocateRaw(ptrs[i]);
+  }
+  std::optional<AllocatorStats> stats = a->GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->num_allocs, 10);
+  EXPECT_EQ(stats->bytes_in_use, 5 * 1024);
+
+  // The freed chunks are reused from the caches.
+  for (int i = 0; i < 5; ++i) {
+    ptrs[i] = a->AllocateRaw(Allocator::kAllocatorAlignment, 900);
+    ASSERT_NE(ptrs[i], nullptr);
+    EXPECT_EQ(a->RequestedSize(ptrs[i]), 900);
+    EXPECT_EQ(a->AllocatedSize(ptrs[i]), 1024);
+  }
+  stats = a->GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->num_allocs, 15);
+  EXPECT_EQ(stats->bytes_in_use, 10 * 1024);
+
+  for (void* ptr : ptrs) {
+    a->DeallocateRaw(ptr);
+  }
+  stats = a->GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->bytes_in_use, 0);
+  EXPECT_TRUE(a->ClearStats());
+  stats = a->GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->num_allocs, 0);
+}
+
+// Runs the same allocations with and without CPU caches, which must not change
+// any statistic.
+TEST(BFCAllocatorCpuCacheTest, StatsMatchUncachedAllocator) {
+  std::unique_ptr<BFCAllocator> cached = MakeAllocator(1 << 20, 64 << 10);
+  std::unique_ptr<BFCAllocator> uncached = MakeAllocator(1 << 20, 0);
+  auto expect_same_stats = [&]() {
+    std::optional<AllocatorStats> cached_stats = cached->GetStats();
+    std::optional<AllocatorStats> uncached_stats = uncached->GetStats();
+    ASSERT_TRUE(cached_stats);
+    ASSERT_TRUE(uncached_stats);
+    EXPECT_EQ(cached_stats->num_allocs, uncached_stats->num_allocs);
+    EXPECT_EQ(cached_stats->bytes_in_use, uncached_stats->bytes_in_use);
+    EXPECT_EQ(cached_stats->peak_bytes_in_use,
+              uncached_stats->peak_bytes_in_use);
+    EXPECT_EQ(cached_stats->largest_alloc_size,
+              uncached_stats->largest_alloc_size);
+  };
+  for (BFCAllocator* a : {cached.get(), uncached.get()}) {
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 4; ++i) {
+      ptrs.push_back(a->AllocateRaw(Allocator::kAllocatorAlignment, 1000));
+    }
+    for (void* ptr : ptrs) {
+      a->DeallocateRaw(ptr);
+    }
+    ptrs.clear();
+    // Served by the cache, if any, and past the previous peak.
+    for (int i = 0; i < 6; ++i) {
+      ptrs.push_back(a->AllocateRaw(Allocator::kAllocatorAlignment, 900));
+      EXPECT_EQ(a->RequestedSize(ptrs.back()), 900);
+    }
+    for (void* ptr : ptrs) {
+      a->DeallocateRaw(ptr);
+    }
+  }
+  expect_same_stats();
+
+  EXPECT_TRUE(cached->ClearStats());
+  EXPECT_TRUE(uncached->ClearStats());
+  expect_same_stats();
+  for (BFCAllocator* a : {cached.get(), uncached.get()}) {
+    a->DeallocateRaw(a->AllocateRaw(Allocator::kAllocatorAlignment, 300));
+  }
+  expect_same_stats();
+  std::optional<AllocatorStats> stats = cached->GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->peak_bytes_in_use, 512);
+  EXPECT_EQ(stats->largest_alloc_size, 512);
+}
+
+TEST(BFCAllocatorCpuCacheTest, UniqueAllocationIds) {
+  std::unique_ptr<BFCAllocator> a = MakeAllocator(1 << 20, 64 << 10);
+  int64_t last_id = 0;
+  for (int i = 0; i < 100; ++i) {
+    void* ptr = a->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+    ASSERT_NE(ptr, nullptr);
+    const int64_t id = a->AllocationId(ptr);
+    EXPECT_GT(id, last_id);
+    last_id = id;
+    a->DeallocateRaw(ptr);
+  }
+}
+
+TEST(BFCAllocatorCpuCacheTest, MemoryMapExcludesCachedChunks) {
+  std::unique_ptr<BFCAllocator> a = MakeAllocator(1 << 20, 64 << 10);
+  void* in_use = a->AllocateRaw(Allocator::kAllocatorAlignment, 2048);
+  for (int i = 0; i < 10; ++i) {
+    a->DeallocateRaw(a->AllocateRaw(Allocator::kAllocatorAlignment, 512));
+  }
+  tensorflow::MemoryDump dump = a->RecordMemoryMap();
+  int num_chunks_in_use = 0;
+  for (const tensorflow::MemChunk& chunk : dump.chunk()) {
+    if (chunk.in_use()) {
+      ++num_chunks_in_use;
+      EXPECT_EQ(chunk.size(), 2048);
+    }
+  }
+  EXPECT_EQ(num_chunks_in_use, 1);
+  EXPECT_EQ(dump.stats().num_allocs(), 11);
+  EXPECT_EQ(dump.stats().bytes_in_use(), 2048);
+  a->DeallocateRaw(in_use);
+}
+
+TEST(BFCAllocatorCpuCacheTest, CachedChunksDoNotCauseOom) {
+  std::unique_ptr<BFCAllocator> a = MakeAllocator(1 << 20, 1 << 20);
+  std::vector<void*> ptrs;
+  void* ptr;
+  while ((ptr = a->AllocateRaw(Allocator::kAllocatorAlignment, 4096)) !=
+         nullptr) {
+    ptrs.push_back(ptr);
+  }
+  for (void* ptr : ptrs) {
+    a->DeallocateRaw(ptr);
+  }
+  // Needs the cached chunks to be returned to the bins and coalesced.
+  ptr = a->AllocateRaw(Allocator::kAllocatorAlignment, 768 << 10);
+  EXPECT_NE(ptr, nullptr);
+  a->DeallocateRaw(ptr);
+}
+
+TEST(BFCAllocatorCpuCacheTest, Threaded) {
+  std::unique_ptr<BFCAllocator> a = MakeAllocator(64 << 20, 64 << 10);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 8);
+    for (int t = 0; t < 8; ++t) {
+      pool.Schedule([&a, t]() {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 1000; ++i) {
+          const size_t num_bytes = 64 + 512 * ((i + t) % 32);
+          void* ptr =
+              a->AllocateRaw(Allocator::kAllocatorAlignment, num_bytes);
+          ASSERT_NE(ptr, nullptr);
+          std::memset(ptr, t, num_bytes);
+          ptrs.push_back(ptr);
+          if (ptrs.size() > 16) {
+            a->DeallocateRaw(ptrs.front());
+            ptrs.erase(ptrs.begin());
+          }
+        }
+        for (void* ptr : ptrs) {
+          a->DeallocateRaw(ptr);
+        }
+      });
+    }
+  }
+  std::optional<AllocatorStats> stats = a->GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->num_allocs, 8 * 1000);
+  EXPECT_EQ(stats->bytes_in_use, 0);
+}
+
+// Allocates and frees small tensors from `state.range(1)` threads, with CPU
+// caches of `state.range(0)` bytes.
+void BM_SmallAllocationsThreaded(::testing::benchmark::State& state) {
+  const size_t cpu_cache_bytes = state.range(0);
+  const int num_threads = state.range(1);
+  constexpr int kAllocationsPerThread = 10000;
+  std::unique_ptr<BFCAllocator> a = MakeAllocator(1 << 30, cpu_cache_bytes);
+  thread::ThreadPool pool(Env::Default(), "bm", num_threads);
+  for (auto s : state) {
+    BlockingCounter counter(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+      pool.Schedule([&a, &counter]() {
+        const std::vector<size_t> sizes = {64, 256, 1024, 4096, 512, 16384};
+        std::vector<void*> ptrs(8, nullptr);
+        for (int i = 0; i < kAllocationsPerThread; ++i) {
+          void*& ptr = ptrs[i % ptrs.size()];
+          if (ptr != nullptr) {
+            a->DeallocateRaw(ptr);
+          }
+          ptr = a->AllocateRaw(Allocator::kAllocatorAlignment,
+                               sizes[i % sizes.size()]);
+        }
+        for (void* ptr : ptrs) {
+          a->DeallocateRaw(ptr);
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * num_threads *
+                          kAllocationsPerThread);
+}
+
+BENCHMARK(BM_SmallAllocationsThreaded)
+    ->ArgPair(0, 1)
+    ->ArgPair(256 << 10, 1)
+    ->ArgPair(0, 16)
+    ->ArgPair(256 << 10, 16)
+    ->ArgPair(0, 64)
+    ->ArgPair(256 << 10, 64);
+
+}  // namespace
+}  // namespace tsl
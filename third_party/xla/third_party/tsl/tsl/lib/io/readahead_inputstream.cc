@@ -0,0 +1,194 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/readahead_inputstream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "tsl/platform/errors.h"
+#include "tsl/platform/mutex.h"
+
+namespace tsl {
+namespace io {
+
+struct ReadaheadInputStream::PendingRead {
+  mutex mu;
+  condition_variable cv;
+  bool done TF_GUARDED_BY(mu) = false;
+  Status status TF_GUARDED_BY(mu);
+  size_t bytes_read TF_GUARDED_BY(mu) = 0;
+};
+
+ReadaheadInputStream::ReadaheadInputStream(RandomAccessFile* file,
+                                           size_t buffer_bytes)
+    : file_(file), size_(buffer_bytes) {}
+
+ReadaheadInputStream::~ReadaheadInputStream() {
+  size_t unused;
+  WaitForReadahead(&unused).IgnoreError();
+}
+
+void ReadaheadInputStream::StartReadahead() {
+  next_.resize(size_);
+  pending_ = std::make_shared<PendingRead>();
+  char* scratch = &next_[0];
+  file_->ReadAsync(file_pos_, size_, scratch,
+                   [pending = pending_, scratch](const Status& s,
+                                                 StringPiece result) {
+                     if (result.data() != scratch) {
+                       memmove(scratch, result.data(), result.size());
+                     }
+                     mutex_lock l(pending->mu);
+                     pending->done = true;
+                     pending->status = s;
+                     pending->bytes_read = result.size();
+                     pending->cv.notify_all();
+                   });
+}
+
+Status ReadaheadInputStream::WaitForReadahead(size_t* bytes_read) {
+  *bytes_read = 0;
+  if (!pending_) {
+    return OkStatus();
+  }
+  std::shared_ptr<PendingRead> pending = std::move(pending_);
+  mutex_lock l(pending->mu);
+  while (!pending->done) {
+    pending->cv.wait(l);
+  }
+  *bytes_read = pending->bytes_read;
+  return pending->status;
+}
+
+Status ReadaheadInputStream::FillBuffer() {
+  if (!pending_) {
+    StartReadahead();
+  }
+  size_t bytes_read;
+  Status s = WaitForReadahead(&bytes_read);
+  buf_.swap(next_);
+  pos_ = 0;
+  limit_ = bytes_read;
+  file_pos_ += bytes_read;
+  if (s.ok()) {
+    StartReadahead();
+  } else {
+    file_status_ = s;
+  }
+  return s;
+}
+
+Status ReadaheadInputStream::ReadNBytes(int64_t bytes_to_read,
+                                        tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  result->clear();
+  result->reserve(bytes_to_read);
+  Status s;
+  while (result->size() < static_cast<size_t>(bytes_to_read)) {
+    if (pos_ == limit_) {
+      if (!file_status_.ok()) {
+        s = file_status_;
+        break;
+      }
+      s = FillBuffer();
+      if (limit_ == 0) {
+        break;
+      }
+    }
+    const size_t bytes_to_copy =
+        std::min<size_t>(limit_ - pos_, bytes_to_read - result->size());
+    result->append(buf_.data() + pos_, bytes_to_copy);
+    pos_ += bytes_to_copy;
+  }
+  // Filling the buffer might lead to a situation when we go past the end of
+  // the file leading to an OutOfRange() status return. But we might have
+  // obtained enough data to satisfy the function call. Returning OK then.
+  if (errors::IsOutOfRange(s) &&
+      (result->size() == static_cast<size_t>(bytes_to_read))) {
+    return OkStatus();
+  }
+  return s;
+}
+
+Status ReadaheadInputStream::SkipNBytes(int64_t bytes_to_skip) {
+  if (bytes_to_skip < 0) {
+    return errors::InvalidArgument("Can only skip forward, not ",
+                                   bytes_to_skip);
+  }
+  if (bytes_to_skip <= static_cast<int64_t>(limit_ - pos_)) {
+    pos_ += bytes_to_skip;
+    return OkStatus();
+  }
+  if (file_status_.ok()) {
+    // Moves the file position rather than reading the skipped bytes. Reading
+    // resumes at the last skipped byte, which tells whether the file is long
+    // enough.
+    const int64_t start = Tell();
+    DiscardBuffer(start + bytes_to_skip - 1);
+    Status s = FillBuffer();
+    if (limit_ > 0) {
+      pos_ = 1;
+      return OkStatus();
+    }
+    if (!errors::IsOutOfRange(s)) {
+      return s;
+    }
+    // The file ends within the skipped bytes. Skip up to its end, as
+    // buffered input streams do.
+    DiscardBuffer(start);
+  }
+  while (bytes_to_skip > 0) {
+    if (pos_ == limit_) {
+      if (!file_status_.ok()) {
+        return file_status_;
+      }
+      Status s = FillBuffer();
+      if (limit_ == 0) {
+        return s;
+      }
+    }
+    const size_t bytes_to_advance =
+        std::min<int64_t>(limit_ - pos_, bytes_to_skip);
+    pos_ += bytes_to_advance;
+    bytes_to_skip -= bytes_to_advance;
+  }
+  return OkStatus();
+}
+
+int64_t ReadaheadInputStream::Tell() const {
+  return file_pos_ - (limit_ - pos_);
+}
+
+Status ReadaheadInputStream::Reset() {
+  DiscardBuffer(0);
+  return OkStatus();
+}
+
+void ReadaheadInputStream::DiscardBuffer(int64_t offset) {
+  size_t unused;
+  WaitForReadahead(&unused).IgnoreError();
+  pos_ = 0;
+  limit_ = 0;
+  file_pos_ = offset;
+  file_status_ = OkStatus();
+}
+
+}  // namespace io
+}  // namespace tsl
@@ -0,0 +1,86 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_READAHEAD_INPUTSTREAM_H_
+#define TENSORFLOW_TSL_LIB_IO_READAHEAD_INPUTSTREAM_H_
+
+#include <memory>
+#include <string>
+
+#include "tsl/lib/io/inputstream_interface.h"
+#include "tsl/platform/file_system.h"
+
+namespace tsl {
+namespace io {
+
+// Provides a double buffer on top of a RandomAccessFile. While the caller
+// consumes one buffer, the next one is filled with
+// `RandomAccessFile::ReadAsync`, so that a few threads can keep reads of many
+// files in flight. A single instance of ReadaheadInputStream is NOT safe for
+// concurrent use by multiple threads.
+class ReadaheadInputStream : public InputStreamInterface {
+ public:
+  // Does not take ownership of `file`, which must outlive *this.
+  ReadaheadInputStream(RandomAccessFile* file, size_t buffer_bytes);
+
+  // Waits for the read in flight, if any.
+  ~ReadaheadInputStream() override;
+
+  Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+  Status SkipNBytes(int64_t bytes_to_skip) override;
+
+  int64_t Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  struct PendingRead;
+
+  // Starts reading the buffer following `buf_` into `next_`.
+  void StartReadahead();
+
+  // Waits for the read into `next_` and makes it the current buffer.
+  Status FillBuffer();
+
+  // Waits for the read in flight, if any, and returns its result.
+  Status WaitForReadahead(size_t* bytes_read);
+
+  // Drops the buffered data and the read in flight, and positions the
+  // stream at `offset` in the file.
+  void DiscardBuffer(int64_t offset);
+
+  RandomAccessFile* const file_;  // not owned.
+  const size_t size_;             // buffer size.
+  std::string buf_;               // the buffer being consumed.
+  std::string next_;              // the buffer being read ahead.
+  // buf_[pos_, limit_) holds the unconsumed data in the file.
+  size_t pos_ = 0;
+  size_t limit_ = 0;
+  // Offset in the file just past the end of `buf_`.
+  int64_t file_pos_ = 0;
+  // The read into `next_`, or null if no read is in flight.
+  std::shared_ptr<PendingRead> pending_;
+  // When EoF is reached, file_status_ contains the status to return.
+  Status file_status_ = OkStatus();
+
+  ReadaheadInputStream(const ReadaheadInputStream&) = delete;
+  void operator=(const ReadaheadInputStream&) = delete;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_READAHEAD_INPUTSTREAM_H_
@@ -0,0 +1,259 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/readahead_inputstream.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/blocking_counter.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+static std::vector<int> BufferSizes() {
+  return {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 65536};
+}
+
+TEST(ReadaheadInputStream, ReadNBytes) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    ReadaheadInputStream in(file.get(), buf_size);
+    tstring read;
+    EXPECT_EQ(0, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(3, &read));
+    EXPECT_EQ(read, "012");
+    EXPECT_EQ(3, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(0, &read));
+    EXPECT_EQ(read, "");
+    EXPECT_EQ(3, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(4, &read));
+    EXPECT_EQ(read, "3456");
+    EXPECT_EQ(7, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(3, &read));
+    EXPECT_EQ(read, "789");
+    EXPECT_EQ(10, in.Tell());
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(5, &read)));
+    EXPECT_EQ(read, "");
+    EXPECT_EQ(10, in.Tell());
+  }
+}
+
+TEST(ReadaheadInputStream, ReadPastEndOfFile) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    ReadaheadInputStream in(file.get(), buf_size);
+    tstring read;
+    TF_ASSERT_OK(in.ReadNBytes(8, &read));
+    EXPECT_EQ(read, "01234567");
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(5, &read)));
+    EXPECT_EQ(read, "89");
+    EXPECT_EQ(10, in.Tell());
+  }
+}
+
+TEST(ReadaheadInputStream, SkipNBytes) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    ReadaheadInputStream in(file.get(), buf_size);
+    tstring read;
+    TF_ASSERT_OK(in.SkipNBytes(3));
+    EXPECT_EQ(3, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(2, &read));
+    EXPECT_EQ(read, "34");
+    TF_ASSERT_OK(in.SkipNBytes(4));
+    EXPECT_EQ(9, in.Tell());
+    EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(5)));
+    EXPECT_EQ(10, in.Tell());
+  }
+}
+
+// Wraps a file and records the smallest offset read from it.
+class OffsetRecordingFile : public RandomAccessFile {
+ public:
+  explicit OffsetRecordingFile(RandomAccessFile* file) : file_(file) {}
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    min_offset_ = std::min(min_offset_, offset);
+    return file_->Read(offset, n, result, scratch);
+  }
+
+  uint64 min_offset() const { return min_offset_; }
+
+ private:
+  RandomAccessFile* const file_;
+  mutable uint64 min_offset_ = ~uint64{0};
+};
+
+TEST(ReadaheadInputStream, SkipNBytesDoesNotReadSkippedBytes) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  TF_ASSERT_OK(WriteStringToFile(env, fname, string(1 << 20, 'x') + "end"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  OffsetRecordingFile recording_file(file.get());
+  ReadaheadInputStream in(&recording_file, 16);
+  tstring read;
+  TF_ASSERT_OK(in.SkipNBytes(1 << 20));
+  EXPECT_EQ(1 << 20, in.Tell());
+  TF_ASSERT_OK(in.ReadNBytes(3, &read));
+  EXPECT_EQ(read, "end");
+  EXPECT_EQ(recording_file.min_offset(), (1 << 20) - 1);
+  EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(1)));
+  EXPECT_EQ((1 << 20) + 3, in.Tell());
+}
+
+TEST(ReadaheadInputStream, Reset) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    ReadaheadInputStream in(file.get(), buf_size);
+    tstring read;
+    TF_ASSERT_OK(in.ReadNBytes(4, &read));
+    EXPECT_EQ(read, "0123");
+    TF_ASSERT_OK(in.Reset());
+    EXPECT_EQ(0, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(10, &read));
+    EXPECT_EQ(read, "0123456789");
+    TF_ASSERT_OK(in.Reset());
+    TF_ASSERT_OK(in.ReadNBytes(3, &read));
+    EXPECT_EQ(read, "012");
+  }
+}
+
+TEST(ReadaheadInputStream, EmptyFile) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  TF_ASSERT_OK(WriteStringToFile(env, fname, ""));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  ReadaheadInputStream in(file.get(), 1024);
+  tstring read;
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+  EXPECT_EQ(0, in.Tell());
+}
+
+constexpr int kReadSize = 64 * 1024;
+
+// Writes `num_files` files of `file_size` bytes and opens them.
+void CreateFiles(int num_files, int file_size,
+                 std::vector<std::unique_ptr<RandomAccessFile>>* files) {
+  Env* env = Env::Default();
+  const string contents(file_size, 'x');
+  for (int i = 0; i < num_files; ++i) {
+    string fname;
+    ASSERT_TRUE(env->LocalTempFilename(&fname));
+    TF_ASSERT_OK(WriteStringToFile(env, fname, contents));
+    files->emplace_back();
+    TF_ASSERT_OK(env->NewRandomAccessFile(fname, &files->back()));
+  }
+}
+
+// Reads many files with blocking reads, using one thread per file in flight.
+void BM_BlockingReads(::testing::benchmark::State& state) {
+  const int num_files = state.range(0);
+  const int num_threads = state.range(1);
+  const int file_size = 4 * 1024 * 1024;
+  std::vector<std::unique_ptr<RandomAccessFile>> files;
+  CreateFiles(num_files, file_size, &files);
+  thread::ThreadPool pool(Env::Default(), "blocking_reads", num_threads);
+
+  for (auto s : state) {
+    BlockingCounter counter(num_files);
+    for (const auto& file : files) {
+      pool.Schedule([&file, &counter]() {
+        std::string scratch(kReadSize, '\0');
+        StringPiece result;
+        for (uint64 offset = 0;; offset += kReadSize) {
+          Status s = file->Read(offset, kReadSize, &result, &scratch[0]);
+          if (!s.ok()) break;
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  state.SetBytesProcessed(state.iterations() * num_files * file_size);
+}
+BENCHMARK(BM_BlockingReads)->ArgPair(16, 1)->ArgPair(16, 4)->ArgPair(16, 16);
+
+// Reads the same files from a single thread, keeping one read per file in
+// flight with `ReadaheadInputStream`.
+void BM_ReadaheadReads(::testing::benchmark::State& state) {
+  const int num_files = state.range(0);
+  const int file_size = 4 * 1024 * 1024;
+  std::vector<std::unique_ptr<RandomAccessFile>> files;
+  CreateFiles(num_files, file_size, &files);
+
+  for (auto s : state) {
+    std::vector<std::unique_ptr<ReadaheadInputStream>> streams;
+    for (const auto& file : files) {
+      streams.push_back(
+          std::make_unique<ReadaheadInputStream>(file.get(), kReadSize));
+    }
+    tstring result;
+    int num_remaining = num_files;
+    while (num_remaining > 0) {
+      for (auto& stream : streams) {
+        if (stream && !stream->ReadNBytes(kReadSize, &result).ok()) {
+          stream.reset();
+          --num_remaining;
+        }
+      }
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * num_files * file_size);
+}
+BENCHMARK(BM_ReadaheadReads)->Arg(16);
+
+}  // anonymous namespace
+}  // namespace io
+}  // namespace tsl
@@ -0,0 +1,128 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/record_index.h"
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "tsl/lib/hash/crc32c.h"
+#include "tsl/platform/coding.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/raw_coding.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+constexpr size_t kEntrySize = 2 * sizeof(uint64);
+constexpr size_t kFooterSize = sizeof(uint64) + sizeof(uint32);
+
+// Sizes of the framing of a TFRecord, see record_writer.h.
+constexpr size_t kRecordHeaderSize = sizeof(uint64) + sizeof(uint32);
+constexpr size_t kRecordFooterSize = sizeof(uint32);
+
+}  // namespace
+
+std::string RecordIndexFilename(const std::string& filename) {
+  return filename + kRecordIndexSuffix;
+}
+
+RecordIndexWriter::RecordIndexWriter(WritableFile* dest) : dest_(dest) {}
+
+Status RecordIndexWriter::Append(const RecordIndexEntry& entry) {
+  char buf[kEntrySize];
+  core::EncodeFixed64(buf, entry.offset);
+  core::EncodeFixed64(buf + sizeof(uint64), entry.length);
+  crc_ = crc32c::Extend(crc_, buf, sizeof(buf));
+  ++num_records_;
+  return dest_->Append(StringPiece(buf, sizeof(buf)));
+}
+
+Status RecordIndexWriter::Finish() {
+  char footer[kFooterSize];
+  core::EncodeFixed64(footer, num_records_);
+  const uint32 crc = crc32c::Extend(crc_, footer, sizeof(uint64));
+  core::EncodeFixed32(footer + sizeof(uint64), crc32c::Mask(crc));
+  return dest_->Append(StringPiece(footer, sizeof(footer)));
+}
+
+Status ReadRecordIndex(Env* env, const std::string& filename,
+                       std::vector<RecordIndexEntry>* entries) {
+  std::string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, filename, &contents));
+  if (contents.size() < kFooterSize ||
+      (contents.size() - kFooterSize) % kEntrySize != 0) {
+    return errors::DataLoss("Record index ", filename, " is truncated.");
+  }
+  const size_t footer_offset = contents.size() - kFooterSize;
+  const uint64 num_records = core::DecodeFixed64(&contents[footer_offset]);
+  const uint32 masked_crc =
+      core::DecodeFixed32(&contents[footer_offset + sizeof(uint64)]);
+  if (num_records != footer_offset / kEntrySize ||
+      crc32c::Unmask(masked_crc) !=
+          crc32c::Value(contents.data(), footer_offset + sizeof(uint64))) {
+    return errors::DataLoss("Record index ", filename, " is corrupted.");
+  }
+  entries->clear();
+  entries->reserve(num_records);
+  for (size_t offset = 0; offset < footer_offset; offset += kEntrySize) {
+    RecordIndexEntry entry;
+    entry.offset = core::DecodeFixed64(&contents[offset]);
+    entry.length = core::DecodeFixed64(&contents[offset + sizeof(uint64)]);
+    entries->push_back(entry);
+  }
+  return OkStatus();
+}
+
+Status ReadIndexedRecord(RandomAccessFile* file, const RecordIndexEntry& entry,
+                         tstring* record) {
+  if (entry.length >= SIZE_MAX - kRecordHeaderSize - kRecordFooterSize) {
+    return errors::DataLoss("record size too large at ", entry.offset);
+  }
+  const size_t n = kRecordHeaderSize + entry.length + kRecordFooterSize;
+  record->resize_uninitialized(n);
+  StringPiece result;
+  Status s = file->Read(entry.offset, n, &result, record->mdata());
+  if (result.size() != n) {
+    if (!s.ok() && !errors::IsOutOfRange(s)) {
+      return s;
+    }
+    return errors::DataLoss("truncated record at ", entry.offset);
+  }
+  const char* header = result.data();
+  const uint32 masked_length_crc =
+      core::DecodeFixed32(header + sizeof(uint64));
+  if (crc32c::Unmask(masked_length_crc) !=
+          crc32c::Value(header, sizeof(uint64)) ||
+      core::DecodeFixed64(header) != entry.length) {
+    return errors::DataLoss("corrupted record at ", entry.offset,
+                            ", or the record index does not match the file");
+  }
+  const char* data = header + kRecordHeaderSize;
+  const uint32 masked_data_crc = core::DecodeFixed32(data + entry.length);
+  if (crc32c::Unmask(masked_data_crc) != crc32c::Value(data, entry.length)) {
+    return errors::DataLoss("corrupted record at ", entry.offset);
+  }
+  // `result` may point into `record` or into memory owned by `file`.
+  memmove(record->mdata(), data, entry.length);
+  record->resize(entry.length);
+  return OkStatus();
+}
+
+}  // namespace io
+}  // namespace tsl
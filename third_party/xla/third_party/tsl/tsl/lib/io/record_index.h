@@ -0,0 +1,88 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_RECORD_INDEX_H_
+#define TENSORFLOW_TSL_LIB_IO_RECORD_INDEX_H_
+
+#include <string>
+#include <vector>
+
+#include "tsl/platform/env.h"
+#include "tsl/platform/file_system.h"
+#include "tsl/platform/status.h"
+#include "tsl/platform/tstring.h"
+#include "tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+// A record index lists the offset and length of every record of a TFRecord
+// file, so that records can be read in any order, and skipped without being
+// read. It is stored next to the TFRecord file, in a file with the same name
+// followed by `kRecordIndexSuffix`.
+//
+// Format of an index file:
+//  entry[num_records], each of which is
+//    uint64  offset of the record in the uncompressed stream of records
+//    uint64  length of the record's data
+//  uint64    num_records
+//  uint32    masked crc of all preceding bytes
+//
+// Offsets are file offsets for uncompressed TFRecord files only.
+constexpr char kRecordIndexSuffix[] = ".idx";
+
+struct RecordIndexEntry {
+  uint64 offset = 0;
+  uint64 length = 0;
+};
+
+// Returns the name of the index file of the TFRecord file `filename`.
+std::string RecordIndexFilename(const std::string& filename);
+
+// Writes a record index. Not thread safe.
+class RecordIndexWriter {
+ public:
+  // Does not take ownership of `dest`, which must outlive *this.
+  explicit RecordIndexWriter(WritableFile* dest);
+
+  // Appends the entry of the next record.
+  Status Append(const RecordIndexEntry& entry);
+
+  // Writes the footer of the index. Does *not* close the WritableFile.
+  Status Finish();
+
+ private:
+  WritableFile* const dest_;
+  uint64 num_records_ = 0;
+  uint32 crc_ = 0;
+
+  RecordIndexWriter(const RecordIndexWriter&) = delete;
+  void operator=(const RecordIndexWriter&) = delete;
+};
+
+// Reads the index file `filename` into `entries`. Returns DataLoss if the
+// file is truncated or corrupted.
+Status ReadRecordIndex(Env* env, const std::string& filename,
+                       std::vector<RecordIndexEntry>* entries);
+
+// Reads the record at `entry` of the uncompressed TFRecord file `file` into
+// `record` with a single read, verifying its checksums.
+Status ReadIndexedRecord(RandomAccessFile* file, const RecordIndexEntry& entry,
+                         tstring* record);
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_RECORD_INDEX_H_
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tsl/lib/io/buffered_inputstream.h"
 #include "tsl/lib/io/compression.h"
 #include "tsl/lib/io/random_inputstream.h"
+#include "tsl/lib/io/readahead_inputstream.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/raw_coding.h"
@@ -59,7 +60,9 @@ RecordReader::RecordReader(RandomAccessFile* file,
     : options_(options),
       input_stream_(new RandomAccessInputStream(file)),
       last_read_failed_(false) {
-  if (options.buffer_size > 0) {
+  if (options.buffer_size > 0 && options.async_readahead) {
+    input_stream_.reset(new ReadaheadInputStream(file, options.buffer_size));
+  } else if (options.buffer_size > 0) {
     input_stream_.reset(new BufferedInputStream(input_stream_.release(),
                                                 options.buffer_size, true));
   }
@@ -68,7 +71,14 @@ RecordReader::RecordReader(RandomAccessFile* file,
     LOG(FATAL) << "Compression is unsupported on mobile platforms.";
   }
 #else
-  if (options.compression_type == RecordReaderOptions::ZLIB_COMPRESSION) {
+  if (options.compression_type == RecordReaderOptions::ZLIB_COMPRESSION &&
+      options.decompression_thread_pool != nullptr) {
+    input_stream_.reset(new ZlibBlockInputStream(
+        file, input_stream_.release(), options.zlib_options,
+        options.decompression_thread_pool,
+        options.decompression_blocks_in_flight));
+  } else if (options.compression_type ==
+             RecordReaderOptions::ZLIB_COMPRESSION) {
     input_stream_.reset(new ZlibInputStream(
         input_stream_.release(), options.zlib_options.input_buffer_size,
         options.zlib_options.output_buffer_size, options.zlib_options, true));
@@ -22,6 +22,7 @@ limitations under the License.
 #if !defined(IS_SLIM_BUILD)
 #include "tsl/lib/io/snappy/snappy_compression_options.h"
 #include "tsl/lib/io/snappy/snappy_inputstream.h"
+#include "tsl/lib/io/zlib_block_inputstream.h"
 #include "tsl/lib/io/zlib_compression_options.h"
 #include "tsl/lib/io/zlib_inputstream.h"
 #endif  // IS_SLIM_BUILD
@@ -46,6 +47,11 @@ struct RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64_t buffer_size = 0;
 
+  // If true and buffer_size is non-zero, the next buffer_size bytes are read
+  // asynchronously with `RandomAccessFile::ReadAsync` while the current buffer
+  // is consumed.
+  bool async_readahead = false;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
@@ -53,6 +59,13 @@ struct RecordReaderOptions {
   // Options specific to compression.
   ZlibCompressionOptions zlib_options;
   SnappyCompressionOptions snappy_options;
+
+  // If non-null and compression_type is ZLIB_COMPRESSION, block-compressed
+  // files (see zlib_block_format.h) are inflated on this thread pool, with up
+  // to decompression_blocks_in_flight blocks read ahead of the reader. Other
+  // files are read as usual.
+  thread::ThreadPool* decompression_thread_pool = nullptr;
+  int64_t decompression_blocks_in_flight = 4;
 #endif  // IS_SLIM_BUILD
 };
 
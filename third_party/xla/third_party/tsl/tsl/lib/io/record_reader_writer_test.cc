@@ -24,12 +24,14 @@ limitations under the License.
 #include <vector>
 
 #include "tsl/lib/core/status_test_util.h"
+#include "tsl/lib/io/record_index.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/status.h"
 #include "tsl/platform/strcat.h"
 #include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
 
 namespace tsl {
 
@@ -343,6 +345,142 @@ TEST(RecordReaderWriterTest, TestZlib) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestZlibBlocks) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_zlib_blocks_test";
+  std::vector<string> records;
+  for (int i = 0; i < 100; ++i) {
+    records.push_back(strings::StrCat("record ", i, string(i, 'x')));
+  }
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriterOptions options =
+        io::RecordWriterOptions::CreateRecordWriterOptions("GZIP");
+    options.zlib_block_size = 64;
+    io::RecordWriter writer(file.get(), options);
+    for (const string& record : records) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Close());
+  }
+
+  thread::ThreadPool thread_pool(env, "inflate", 4);
+  // Read it back in parallel, and as a plain GZIP stream.
+  for (auto* pool : {&thread_pool, static_cast<thread::ThreadPool*>(nullptr)}) {
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    io::RecordReaderOptions options =
+        io::RecordReaderOptions::CreateRecordReaderOptions("GZIP");
+    options.decompression_thread_pool = pool;
+    io::RecordReader reader(read_file.get(), options);
+    uint64 offset = 0;
+    tstring record;
+    for (const string& expected : records) {
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ(expected, record);
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &record)));
+  }
+}
+
+// Blocks are gzip members, so ZLIB compression ignores the block size.
+TEST(RecordReaderWriterTest, TestZlibBlockSizeWithZlibCompression) {
+  Env* env = Env::Default();
+  string fname =
+      testing::TmpDir() + "/record_reader_writer_zlib_block_size_test";
+  std::vector<string> records;
+  for (int i = 0; i < 100; ++i) {
+    records.push_back(strings::StrCat("record ", i, string(i, 'x')));
+  }
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriterOptions options =
+        io::RecordWriterOptions::CreateRecordWriterOptions("ZLIB");
+    options.zlib_block_size = 64;
+    io::RecordWriter writer(file.get(), options);
+    for (const string& record : records) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Close());
+  }
+
+  thread::ThreadPool thread_pool(env, "inflate", 4);
+  for (auto* pool : {&thread_pool, static_cast<thread::ThreadPool*>(nullptr)}) {
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    io::RecordReaderOptions options =
+        io::RecordReaderOptions::CreateRecordReaderOptions("ZLIB");
+    options.decompression_thread_pool = pool;
+    io::RecordReader reader(read_file.get(), options);
+    uint64 offset = 0;
+    tstring record;
+    for (const string& expected : records) {
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ(expected, record);
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &record)));
+  }
+}
+
+TEST(RecordReaderWriterTest, TestIndex) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_index_test";
+  std::vector<string> records;
+  for (int i = 0; i < 20; ++i) {
+    records.push_back(strings::StrCat("record ", i, string(i, 'x')));
+  }
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    std::unique_ptr<WritableFile> index_file;
+    TF_CHECK_OK(
+        env->NewWritableFile(io::RecordIndexFilename(fname), &index_file));
+    io::RecordWriterOptions options;
+    options.index_file = index_file.get();
+    io::RecordWriter writer(file.get(), options);
+    for (const string& record : records) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(index_file->Close());
+  }
+
+  std::vector<io::RecordIndexEntry> entries;
+  TF_ASSERT_OK(
+      io::ReadRecordIndex(env, io::RecordIndexFilename(fname), &entries));
+  ASSERT_EQ(entries.size(), records.size());
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::RecordReader reader(read_file.get());
+  // Reads the records in reverse order, through both readers.
+  for (int i = records.size() - 1; i >= 0; --i) {
+    EXPECT_EQ(entries[i].length, records[i].size());
+    tstring record;
+    TF_ASSERT_OK(io::ReadIndexedRecord(read_file.get(), entries[i], &record));
+    EXPECT_EQ(records[i], record);
+    uint64 offset = entries[i].offset;
+    TF_ASSERT_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(records[i], record);
+  }
+
+  // A truncated index is rejected.
+  string index;
+  TF_CHECK_OK(ReadFileToString(env, io::RecordIndexFilename(fname), &index));
+  TF_CHECK_OK(WriteStringToFile(env, io::RecordIndexFilename(fname),
+                                index.substr(16)));
+  EXPECT_TRUE(errors::IsDataLoss(
+      io::ReadRecordIndex(env, io::RecordIndexFilename(fname), &entries)));
+  // So is an entry that does not match the file.
+  tstring record;
+  EXPECT_TRUE(errors::IsDataLoss(io::ReadIndexedRecord(
+      read_file.get(), {entries[0].offset, entries[0].length + 1}, &record)));
+}
+
 TEST(RecordReaderWriterTest, TestUseAfterClose) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_flush_close_test";
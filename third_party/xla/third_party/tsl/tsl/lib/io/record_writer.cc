@@ -27,6 +27,12 @@ bool IsZlibCompressed(const RecordWriterOptions& options) {
   return options.compression_type == RecordWriterOptions::ZLIB_COMPRESSION;
 }
 
+// Returns true if the zlib options ask for gzip framing, whose window bits are
+// offset by 16 past MAX_WBITS (15).
+bool IsGzipCompressed(const RecordWriterOptions& options) {
+  return IsZlibCompressed(options) && options.zlib_options.window_bits > 15;
+}
+
 bool IsSnappyCompressed(const RecordWriterOptions& options) {
   return options.compression_type == RecordWriterOptions::SNAPPY_COMPRESSION;
 }
@@ -60,12 +66,23 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
 RecordWriter::RecordWriter(WritableFile* dest,
                            const RecordWriterOptions& options)
     : dest_(dest), options_(options) {
+  if (options.index_file != nullptr) {
+    index_writer_ = std::make_unique<RecordIndexWriter>(options.index_file);
+  }
 #if defined(IS_SLIM_BUILD)
   if (options.compression_type != RecordWriterOptions::NONE) {
     LOG(FATAL) << "Compression is unsupported on mobile platforms.";
   }
 #else
-  if (IsZlibCompressed(options)) {
+  if (IsZlibCompressed(options) && options.zlib_block_size > 0 &&
+      !IsGzipCompressed(options)) {
+    LOG(WARNING) << "zlib_block_size is only supported with GZIP compression. "
+                 << "Writing a single ZLIB stream instead.";
+  }
+  if (IsGzipCompressed(options) && options.zlib_block_size > 0) {
+    dest_ = new ZlibBlockOutputBuffer(dest, options.zlib_block_size,
+                                      options.zlib_options);
+  } else if (IsZlibCompressed(options)) {
     ZlibOutputBuffer* zlib_output_buffer = new ZlibOutputBuffer(
         dest, options.zlib_options.input_buffer_size,
         options.zlib_options.output_buffer_size, options.zlib_options);
@@ -112,7 +129,8 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   PopulateFooter(footer, data.data(), data.size());
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  return AddToIndex(data.size());
 }
 
 #if defined(TF_CORD_SUPPORT)
@@ -132,19 +150,32 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
   PopulateFooter(footer, data);
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  return AddToIndex(data.size());
 }
 #endif
 
+Status RecordWriter::AddToIndex(size_t n) {
+  if (index_writer_ != nullptr) {
+    TF_RETURN_IF_ERROR(index_writer_->Append({offset_, n}));
+  }
+  offset_ += kHeaderSize + n + kFooterSize;
+  return OkStatus();
+}
+
 Status RecordWriter::Close() {
   if (dest_ == nullptr) return OkStatus();
+  Status s;
+  if (index_writer_ != nullptr) {
+    s = index_writer_->Finish();
+    index_writer_.reset();
+  }
   if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
-    Status s = dest_->Close();
+    s.Update(dest_->Close());
     delete dest_;
     dest_ = nullptr;
-    return s;
   }
-  return OkStatus();
+  return s;
 }
 
 Status RecordWriter::Flush() {
@@ -16,13 +16,17 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_LIB_IO_RECORD_WRITER_H_
 #define TENSORFLOW_TSL_LIB_IO_RECORD_WRITER_H_
 
+#include <memory>
+
 #include "tsl/lib/hash/crc32c.h"
+#include "tsl/lib/io/record_index.h"
 #include "tsl/platform/coding.h"
 #include "tsl/platform/status.h"
 #include "tsl/platform/stringpiece.h"
 #if !defined(IS_SLIM_BUILD)
 #include "tsl/lib/io/snappy/snappy_compression_options.h"
 #include "tsl/lib/io/snappy/snappy_outputbuffer.h"
+#include "tsl/lib/io/zlib_block_outputbuffer.h"
 #include "tsl/lib/io/zlib_compression_options.h"
 #include "tsl/lib/io/zlib_outputbuffer.h"
 #endif  // IS_SLIM_BUILD
@@ -48,10 +52,22 @@ struct RecordWriterOptions {
   static RecordWriterOptions CreateRecordWriterOptions(
       const string& compression_type);
 
+  // If not null, the writer appends an entry for each record to this file
+  // and finishes it on Close(), in the format of record_index.h. Not owned.
+  WritableFile* index_file = nullptr;
+
 #if !defined(IS_SLIM_BUILD)
   // Options specific to compression.
   io::ZlibCompressionOptions zlib_options;
   io::SnappyCompressionOptions snappy_options;
+
+  // If non-zero and zlib_options ask for GZIP compression, records are
+  // compressed in independent blocks of this many uncompressed bytes (see
+  // zlib_block_format.h), which RecordReader can inflate in parallel. The
+  // blocks are gzip members, so readers without block support can read the
+  // file as GZIP. Ignored with ZLIB compression, whose streams cannot be
+  // split into blocks that way.
+  int64_t zlib_block_size = 0;
 #endif  // IS_SLIM_BUILD
 };
 
@@ -113,6 +129,12 @@ class RecordWriter {
  private:
   WritableFile* dest_;
   RecordWriterOptions options_;
+  // Offset of the next record in the uncompressed stream of records.
+  uint64 offset_ = 0;
+  std::unique_ptr<RecordIndexWriter> index_writer_;
+
+  // Adds the record of `n` bytes just written to the index, if any.
+  Status AddToIndex(size_t n);
 
   inline static uint32 MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
@@ -0,0 +1,187 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/zlib_block_format.h"
+
+#include <zlib.h>
+
+#include <cstring>
+
+#include "tsl/platform/coding.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/raw_coding.h"
+#include "tsl/platform/strcat.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+constexpr char kGzipMagic[] = {'\x1f', '\x8b'};
+constexpr uint8 kDeflateMethod = 8;
+constexpr uint8 kFlagExtra = 4;
+constexpr uint8 kUnknownOs = 255;
+constexpr uint16 kExtraLength = 8;
+constexpr char kSubfieldId[] = {'T', 'F'};
+constexpr uint16 kSubfieldLength = 4;
+
+// Returns the base two logarithm of the window size requested by `options`,
+// which may ask for a zlib, gzip or raw stream.
+int WindowBits(const ZlibCompressionOptions& options) {
+  int window_bits = options.window_bits;
+  if (window_bits > MAX_WBITS) window_bits -= 16;
+  if (window_bits < 0) window_bits = -window_bits;
+  return window_bits == 0 ? MAX_WBITS : window_bits;
+}
+
+Status ZlibError(const char* function, const z_stream& stream, int error) {
+  string error_string =
+      strings::StrCat(function, "() failed with error ", error);
+  if (stream.msg != nullptr) {
+    strings::StrAppend(&error_string, ": ", stream.msg);
+  }
+  return errors::DataLoss(error_string);
+}
+
+}  // namespace
+
+Status CompressZlibBlock(StringPiece data,
+                         const ZlibCompressionOptions& options,
+                         std::string* output) {
+  if (data.size() > kMaxZlibBlockSize) {
+    return errors::InvalidArgument("Block of ", data.size(),
+                                   " bytes exceeds the maximum block size of ",
+                                   kMaxZlibBlockSize, " bytes.");
+  }
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  int error = deflateInit2(&stream, options.compression_level,
+                           options.compression_method, -WindowBits(options),
+                           options.mem_level, options.compression_strategy);
+  if (error != Z_OK) {
+    return ZlibError("deflateInit2", stream, error);
+  }
+
+  const size_t start = output->size();
+  const size_t bound = deflateBound(&stream, data.size());
+  output->resize(start + kZlibBlockHeaderSize + bound + kZlibBlockFooterSize);
+  char* header = &(*output)[start];
+  header[0] = kGzipMagic[0];
+  header[1] = kGzipMagic[1];
+  header[2] = kDeflateMethod;
+  header[3] = kFlagExtra;
+  memset(header + 4, 0, 5);  // MTIME and XFL
+  header[9] = static_cast<char>(kUnknownOs);
+  core::EncodeFixed16(header + 10, kExtraLength);
+  header[12] = kSubfieldId[0];
+  header[13] = kSubfieldId[1];
+  core::EncodeFixed16(header + 14, kSubfieldLength);
+
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = data.size();
+  stream.next_out = reinterpret_cast<Bytef*>(header + kZlibBlockHeaderSize);
+  stream.avail_out = bound;
+  error = deflate(&stream, Z_FINISH);
+  const size_t compressed_size = stream.total_out;
+  Status s = error == Z_STREAM_END ? OkStatus()
+                                   : ZlibError("deflate", stream, error);
+  deflateEnd(&stream);
+  if (!s.ok()) {
+    output->resize(start);
+    return s;
+  }
+
+  const size_t block_size =
+      kZlibBlockHeaderSize + compressed_size + kZlibBlockFooterSize;
+  core::EncodeFixed32(header + 16, block_size);
+  char* footer = header + kZlibBlockHeaderSize + compressed_size;
+  core::EncodeFixed32(
+      footer, crc32(0, reinterpret_cast<const Bytef*>(data.data()),
+                    data.size()));
+  core::EncodeFixed32(footer + 4, data.size());
+  output->resize(start + block_size);
+  return OkStatus();
+}
+
+Status ParseZlibBlockHeader(StringPiece header, uint32* block_size) {
+  if (header.size() < kZlibBlockHeaderSize || header[0] != kGzipMagic[0] ||
+      header[1] != kGzipMagic[1] ||
+      static_cast<uint8>(header[2]) != kDeflateMethod ||
+      static_cast<uint8>(header[3]) != kFlagExtra ||
+      core::DecodeFixed16(header.data() + 10) != kExtraLength ||
+      header[12] != kSubfieldId[0] || header[13] != kSubfieldId[1] ||
+      core::DecodeFixed16(header.data() + 14) != kSubfieldLength) {
+    return errors::InvalidArgument("Not a block-compressed zlib stream.");
+  }
+  *block_size = core::DecodeFixed32(header.data() + 16);
+  if (*block_size < kZlibBlockHeaderSize + kZlibBlockFooterSize) {
+    return errors::InvalidArgument("Invalid size of zlib block: ",
+                                   *block_size);
+  }
+  return OkStatus();
+}
+
+Status UncompressZlibBlock(StringPiece block, std::string* output) {
+  uint32 block_size;
+  Status s = ParseZlibBlockHeader(block, &block_size);
+  if (!s.ok() || block_size != block.size()) {
+    return errors::DataLoss("Corrupted zlib block header.");
+  }
+  const char* footer = block.data() + block.size() - kZlibBlockFooterSize;
+  const uint32 expected_crc = core::DecodeFixed32(footer);
+  const uint32 uncompressed_size = core::DecodeFixed32(footer + 4);
+  if (uncompressed_size > kMaxZlibBlockSize) {
+    return errors::DataLoss("Corrupted zlib block footer.");
+  }
+
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  int error = inflateInit2(&stream, -MAX_WBITS);
+  if (error != Z_OK) {
+    return ZlibError("inflateInit2", stream, error);
+  }
+  output->resize(uncompressed_size);
+  stream.next_in = reinterpret_cast<Bytef*>(
+      const_cast<char*>(block.data() + kZlibBlockHeaderSize));
+  stream.avail_in = block.size() - kZlibBlockHeaderSize - kZlibBlockFooterSize;
+  // Leave room for one extra byte, so that a corrupted block that inflates to
+  // more than `uncompressed_size` bytes is detected.
+  std::string overflow(1, '\0');
+  stream.next_out = reinterpret_cast<Bytef*>(&(*output)[0]);
+  stream.avail_out = uncompressed_size;
+  error = inflate(&stream, Z_FINISH);
+  if (error == Z_BUF_ERROR && stream.avail_out == 0) {
+    stream.next_out = reinterpret_cast<Bytef*>(&overflow[0]);
+    stream.avail_out = overflow.size();
+    error = inflate(&stream, Z_FINISH);
+  }
+  const size_t total_out = stream.total_out;
+  s = error == Z_STREAM_END ? OkStatus() : ZlibError("inflate", stream, error);
+  inflateEnd(&stream);
+  TF_RETURN_IF_ERROR(s);
+  if (total_out != uncompressed_size) {
+    return errors::DataLoss("Zlib block inflated to ", total_out,
+                            " bytes, but its footer records ",
+                            uncompressed_size, " bytes.");
+  }
+  const uint32 actual_crc = crc32(
+      0, reinterpret_cast<const Bytef*>(output->data()), output->size());
+  if (actual_crc != expected_crc) {
+    return errors::DataLoss("Zlib block checksum mismatch.");
+  }
+  return OkStatus();
+}
+
+}  // namespace io
+}  // namespace tsl
@@ -0,0 +1,73 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_ZLIB_BLOCK_FORMAT_H_
+#define TENSORFLOW_TSL_LIB_IO_ZLIB_BLOCK_FORMAT_H_
+
+#include <string>
+
+#include "tsl/lib/io/zlib_compression_options.h"
+#include "tsl/platform/status.h"
+#include "tsl/platform/stringpiece.h"
+#include "tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+// A block-compressed zlib stream is a sequence of gzip members (RFC 1952),
+// each of which holds an independently deflated block of the uncompressed
+// stream. Every member records its own size in an extra field of its header,
+// so the offsets of all blocks can be found by reading the headers alone and
+// the blocks can be inflated in parallel. Since concatenated gzip members are
+// a valid gzip stream, block-compressed files remain readable by
+// `ZlibInputStream` with `ZlibCompressionOptions::GZIP()`.
+//
+// Format of a single member:
+//  byte[10]  gzip header, with FLG.FEXTRA set
+//  uint16    length of the extra field (8)
+//  byte[2]   subfield id ('T', 'F')
+//  uint16    subfield length (4)
+//  uint32    size of the member, including header and footer
+//  byte[]    raw deflate data
+//  uint32    CRC-32 of the uncompressed block
+//  uint32    size of the uncompressed block
+//
+// All integers are little-endian.
+constexpr size_t kZlibBlockHeaderSize = 20;
+constexpr size_t kZlibBlockFooterSize = 8;
+
+// Upper bound on the uncompressed size of a block, which keeps the size of
+// the compressed member representable in its header.
+constexpr size_t kMaxZlibBlockSize = 1 << 30;
+
+// Deflates `data` into a single member, which is appended to `*output`.
+// Uses the level, strategy, memory level and window size of `options`.
+Status CompressZlibBlock(StringPiece data,
+                         const ZlibCompressionOptions& options,
+                         std::string* output);
+
+// Parses the first kZlibBlockHeaderSize bytes of a member and sets
+// `*block_size` to the size of the whole member. Returns InvalidArgument if
+// `header` does not start a member of a block-compressed stream.
+Status ParseZlibBlockHeader(StringPiece header, uint32* block_size);
+
+// Inflates the member `block` into `*output`, verifying its checksum.
+// Returns DataLoss if the member is corrupted.
+Status UncompressZlibBlock(StringPiece block, std::string* output);
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_ZLIB_BLOCK_FORMAT_H_
@@ -0,0 +1,206 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/zlib_block_inputstream.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tsl/lib/io/zlib_block_format.h"
+#include "tsl/lib/io/zlib_inputstream.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/mutex.h"
+
+namespace tsl {
+namespace io {
+
+struct ZlibBlockInputStream::Block {
+  mutex mu;
+  condition_variable cv;
+  bool done TF_GUARDED_BY(mu) = false;
+  Status status TF_GUARDED_BY(mu);
+  std::string data TF_GUARDED_BY(mu);
+};
+
+ZlibBlockInputStream::ZlibBlockInputStream(
+    RandomAccessFile* file, InputStreamInterface* input_stream,
+    const ZlibCompressionOptions& zlib_options, thread::ThreadPool* thread_pool,
+    int64_t max_blocks_in_flight)
+    : file_(file),
+      input_stream_(input_stream),
+      zlib_options_(zlib_options),
+      thread_pool_(thread_pool),
+      max_blocks_in_flight_(std::max<int64_t>(max_blocks_in_flight, 1)) {}
+
+ZlibBlockInputStream::~ZlibBlockInputStream() { WaitForBlocks(); }
+
+Status ZlibBlockInputStream::Init() {
+  char scratch[kZlibBlockHeaderSize];
+  StringPiece header;
+  Status s = file_->Read(0, kZlibBlockHeaderSize, &header, scratch);
+  if (!s.ok() && !errors::IsOutOfRange(s)) {
+    return s;
+  }
+  uint32 block_size;
+  if (!header.empty() && !ParseZlibBlockHeader(header, &block_size).ok()) {
+    fallback_stream_ = std::make_unique<ZlibInputStream>(
+        input_stream_.get(), zlib_options_.input_buffer_size,
+        zlib_options_.output_buffer_size, zlib_options_);
+  }
+  initialized_ = true;
+  return OkStatus();
+}
+
+void ZlibBlockInputStream::ScheduleBlocks() {
+  while (scan_status_.ok() &&
+         static_cast<int64_t>(blocks_.size()) < max_blocks_in_flight_) {
+    char scratch[kZlibBlockHeaderSize];
+    StringPiece header;
+    Status s = file_->Read(next_block_offset_, kZlibBlockHeaderSize, &header,
+                           scratch);
+    if (errors::IsOutOfRange(s) && header.empty()) {
+      scan_status_ = s;
+      break;
+    }
+    if (errors::IsOutOfRange(s)) {
+      scan_status_ = errors::DataLoss("Truncated zlib block at offset ",
+                                      next_block_offset_, ".");
+      break;
+    }
+    uint32 block_size;
+    if (s.ok()) {
+      s = ParseZlibBlockHeader(header, &block_size);
+      if (!s.ok()) {
+        s = errors::DataLoss("Corrupted zlib block at offset ",
+                             next_block_offset_, ": ", s.message());
+      }
+    }
+    if (!s.ok()) {
+      scan_status_ = s;
+      break;
+    }
+
+    auto block = std::make_shared<Block>();
+    blocks_.push_back(block);
+    auto read_block = [file = file_, block, offset = next_block_offset_,
+                       block_size]() {
+      std::string compressed(block_size, '\0');
+      StringPiece result;
+      Status s = file->Read(offset, block_size, &result, &compressed[0]);
+      if (errors::IsOutOfRange(s)) {
+        s = errors::DataLoss("Truncated zlib block at offset ", offset, ".");
+      }
+      std::string data;
+      if (s.ok()) {
+        s = UncompressZlibBlock(result, &data);
+      }
+      mutex_lock l(block->mu);
+      block->done = true;
+      block->status = s;
+      block->data = std::move(data);
+      block->cv.notify_all();
+    };
+    if (thread_pool_ != nullptr) {
+      thread_pool_->Schedule(std::move(read_block));
+    } else {
+      read_block();
+    }
+    next_block_offset_ += block_size;
+  }
+}
+
+Status ZlibBlockInputStream::NextBlock() {
+  if (blocks_.empty()) {
+    ScheduleBlocks();
+    if (blocks_.empty()) {
+      return scan_status_;
+    }
+  }
+  std::shared_ptr<Block> block = std::move(blocks_.front());
+  blocks_.pop_front();
+  {
+    mutex_lock l(block->mu);
+    while (!block->done) {
+      block->cv.wait(l);
+    }
+    TF_RETURN_IF_ERROR(block->status);
+    block_ = std::move(block->data);
+  }
+  pos_ = 0;
+  // Keep the pipeline full while the caller consumes this block.
+  ScheduleBlocks();
+  return OkStatus();
+}
+
+Status ZlibBlockInputStream::ReadNBytes(int64_t bytes_to_read,
+                                        tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  if (!initialized_) {
+    TF_RETURN_IF_ERROR(Init());
+  }
+  if (fallback_stream_) {
+    return fallback_stream_->ReadNBytes(bytes_to_read, result);
+  }
+  result->clear();
+  result->reserve(bytes_to_read);
+  while (result->size() < static_cast<size_t>(bytes_to_read)) {
+    if (pos_ == block_.size()) {
+      TF_RETURN_IF_ERROR(NextBlock());
+      continue;
+    }
+    const size_t n = std::min<size_t>(block_.size() - pos_,
+                                      bytes_to_read - result->size());
+    result->append(block_.data() + pos_, n);
+    pos_ += n;
+    bytes_read_ += n;
+  }
+  return OkStatus();
+}
+
+int64_t ZlibBlockInputStream::Tell() const {
+  if (fallback_stream_) {
+    return fallback_stream_->Tell();
+  }
+  return bytes_read_;
+}
+
+void ZlibBlockInputStream::WaitForBlocks() {
+  for (const auto& block : blocks_) {
+    mutex_lock l(block->mu);
+    while (!block->done) {
+      block->cv.wait(l);
+    }
+  }
+  blocks_.clear();
+}
+
+Status ZlibBlockInputStream::Reset() {
+  if (fallback_stream_) {
+    return fallback_stream_->Reset();
+  }
+  WaitForBlocks();
+  next_block_offset_ = 0;
+  scan_status_ = OkStatus();
+  block_.clear();
+  pos_ = 0;
+  bytes_read_ = 0;
+  return OkStatus();
+}
+
+}  // namespace io
+}  // namespace tsl
@@ -0,0 +1,122 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_ZLIB_BLOCK_INPUTSTREAM_H_
+#define TENSORFLOW_TSL_LIB_IO_ZLIB_BLOCK_INPUTSTREAM_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "tsl/lib/io/inputstream_interface.h"
+#include "tsl/lib/io/zlib_compression_options.h"
+#include "tsl/platform/file_system.h"
+#include "tsl/platform/status.h"
+#include "tsl/platform/threadpool.h"
+#include "tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+// Reads a block-compressed zlib stream (see zlib_block_format.h), inflating
+// the blocks ahead of the reader in parallel on a thread pool.
+//
+// Files that are not block-compressed are inflated with a `ZlibInputStream` on
+// the calling thread instead, so any stream accepted by `ZlibInputStream` with
+// the same options can be read.
+//
+// A given instance of an ZlibBlockInputStream is NOT safe for concurrent use
+// by multiple threads
+class ZlibBlockInputStream : public InputStreamInterface {
+ public:
+  // Keeps up to `max_blocks_in_flight` blocks read and inflated ahead of the
+  // reader, using `thread_pool`, or the calling thread if it is null.
+  // `input_stream` reads `file` from the start and is only used if the file
+  // is not block-compressed.
+  //
+  // Takes ownership of `input_stream`. Does not take ownership of `file` or
+  // `thread_pool`, which must outlive *this.
+  ZlibBlockInputStream(RandomAccessFile* file,
+                       InputStreamInterface* input_stream,
+                       const ZlibCompressionOptions& zlib_options,
+                       thread::ThreadPool* thread_pool,
+                       int64_t max_blocks_in_flight);
+
+  // Waits for the blocks in flight.
+  ~ZlibBlockInputStream() override;
+
+  // Reads bytes_to_read bytes into *result, overwriting *result.
+  //
+  // Return Status codes:
+  // OK:           If successful.
+  // OUT_OF_RANGE: If there are not enough bytes to read before
+  //               the end of the stream.
+  // DATA_LOSS:    If a block is corrupted.
+  // others:       If reading from the file failed.
+  Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+  int64_t Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  struct Block;
+
+  // Determines whether the file is block-compressed.
+  Status Init();
+
+  // Schedules reads of the following blocks until `max_blocks_in_flight_`
+  // blocks are in flight, the end of the file is reached, or scanning fails,
+  // in which case \`scan_status_\` is set.
+  void ScheduleBlocks();
+
+  // Makes the next block the current one. Returns OutOfRange at the end of
+  // the file.
+  Status NextBlock();
+
+  // Waits for all blocks in flight.
+  void WaitForBlocks();
+
+  RandomAccessFile* const file_;  // Not owned
+  const ZlibCompressionOptions zlib_options_;
+  thread::ThreadPool* const thread_pool_;  // Not owned
+  const int64_t max_blocks_in_flight_;
+  bool initialized_ = false;
+
+  std::unique_ptr<InputStreamInterface> input_stream_;
+  // Set if the file is not block-compressed.
+  std::unique_ptr<InputStreamInterface> fallback_stream_;
+
+  // Offset in the file of the next block to schedule.
+  uint64 next_block_offset_ = 0;
+  // Status of scanning the file for blocks. OutOfRange once the end of the
+  // file is reached.
+  Status scan_status_;
+  // Blocks in flight, in file order.
+  std::deque<std::shared_ptr<Block>> blocks_;
+  // block_[pos_..] holds the unread contents of the current block.
+  std::string block_;
+  size_t pos_ = 0;
+  // Number of uncompressed bytes read from this stream.
+  int64_t bytes_read_ = 0;
+
+  ZlibBlockInputStream(const ZlibBlockInputStream&) = delete;
+  void operator=(const ZlibBlockInputStream&) = delete;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_ZLIB_BLOCK_INPUTSTREAM_H_
@@ -0,0 +1,107 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/zlib_block_outputbuffer.h"
+
+#include <algorithm>
+
+#include "tsl/lib/io/zlib_block_format.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
+
+namespace tsl {
+namespace io {
+
+ZlibBlockOutputBuffer::ZlibBlockOutputBuffer(
+    WritableFile* file, size_t block_size,
+    const ZlibCompressionOptions& zlib_options)
+    : file_(file),
+      block_size_(std::min(std::max<size_t>(block_size, 1), kMaxZlibBlockSize)),
+      zlib_options_(zlib_options) {
+  block_.reserve(block_size_);
+}
+
+ZlibBlockOutputBuffer::~ZlibBlockOutputBuffer() {
+  if (!closed_) {
+    LOG(WARNING)
+        << "ZlibBlockOutputBuffer::Close() not called. Possible data loss";
+  }
+}
+
+Status ZlibBlockOutputBuffer::Append(StringPiece data) {
+  if (closed_) {
+    return errors::FailedPrecondition("Append() called after Close().");
+  }
+  while (!data.empty()) {
+    const size_t n = std::min(block_size_ - block_.size(), data.size());
+    block_.append(data.data(), n);
+    data.remove_prefix(n);
+    if (block_.size() == block_size_) {
+      TF_RETURN_IF_ERROR(WriteBlock());
+    }
+  }
+  return OkStatus();
+}
+
+#if defined(TF_CORD_SUPPORT)
+Status ZlibBlockOutputBuffer::Append(const absl::Cord& cord) {
+  for (absl::string_view fragment : cord.Chunks()) {
+    TF_RETURN_IF_ERROR(Append(fragment));
+  }
+  return OkStatus();
+}
+#endif
+
+Status ZlibBlockOutputBuffer::WriteBlock() {
+  if (block_.empty()) {
+    return OkStatus();
+  }
+  output_.clear();
+  TF_RETURN_IF_ERROR(CompressZlibBlock(block_, zlib_options_, &output_));
+  block_.clear();
+  return file_->Append(output_);
+}
+
+Status ZlibBlockOutputBuffer::Flush() {
+  if (closed_) {
+    return errors::FailedPrecondition("Flush() called after Close().");
+  }
+  TF_RETURN_IF_ERROR(WriteBlock());
+  return file_->Flush();
+}
+
+Status ZlibBlockOutputBuffer::Close() {
+  if (!closed_) {
+    TF_RETURN_IF_ERROR(WriteBlock());
+    closed_ = true;
+  }
+  return OkStatus();
+}
+
+Status ZlibBlockOutputBuffer::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+Status ZlibBlockOutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+Status ZlibBlockOutputBuffer::Tell(int64_t* position) {
+  return file_->Tell(position);
+}
+
+}  // namespace io
+}  // namespace tsl
@@ -0,0 +1,94 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_ZLIB_BLOCK_OUTPUTBUFFER_H_
+#define TENSORFLOW_TSL_LIB_IO_ZLIB_BLOCK_OUTPUTBUFFER_H_
+
+#include <string>
+
+#include "tsl/lib/io/zlib_compression_options.h"
+#include "tsl/platform/file_system.h"
+#include "tsl/platform/status.h"
+#include "tsl/platform/stringpiece.h"
+
+namespace tsl {
+namespace io {
+
+// Writes a block-compressed zlib stream (see zlib_block_format.h) to a file.
+// The input is cut into blocks of `block_size` uncompressed bytes, each of
+// which is deflated independently, so that readers can inflate the blocks in
+// parallel with `ZlibBlockInputStream`.
+//
+// A given instance of an ZlibBlockOutputBuffer is NOT safe for concurrent use
+// by multiple threads
+class ZlibBlockOutputBuffer : public WritableFile {
+ public:
+  // Does not take ownership of `file`. `block_size` must be positive and at
+  // most kMaxZlibBlockSize.
+  ZlibBlockOutputBuffer(WritableFile* file, size_t block_size,
+                        const ZlibCompressionOptions& zlib_options);
+
+  ~ZlibBlockOutputBuffer() override;
+
+  // Adds `data` to the current block, writing the block to the file once it
+  // holds `block_size` bytes.
+  Status Append(StringPiece data) override;
+
+#if defined(TF_CORD_SUPPORT)
+  Status Append(const absl::Cord& cord) override;
+#endif
+
+  // Writes the current block to the file, even if it is not full, and
+  // flushes the file.
+  Status Flush() override;
+
+  // Writes the current block to the file. This must be called before the
+  // destructor to avoid any data loss. Does not close the file.
+  //
+  // After calling this, any further calls to `Append()` or `Flush()` will
+  // fail.
+  Status Close() override;
+
+  // Returns the name of the underlying file.
+  Status Name(StringPiece* result) const override;
+
+  // Writes the current block to the file and syncs it.
+  Status Sync() override;
+
+  // Returns the write position in the underlying file. The position does not
+  // reflect the current block.
+  Status Tell(int64_t* position) override;
+
+ private:
+  // Compresses `block_`, if not empty, and appends it to the file.
+  Status WriteBlock();
+
+  WritableFile* file_;  // Not owned
+  const size_t block_size_;
+  const ZlibCompressionOptions zlib_options_;
+  bool closed_ = false;
+  // Uncompressed contents of the current block.
+  std::string block_;
+  // Buffer for the compressed block.
+  std::string output_;
+
+  ZlibBlockOutputBuffer(const ZlibBlockOutputBuffer&) = delete;
+  void operator=(const ZlibBlockOutputBuffer&) = delete;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_ZLIB_BLOCK_OUTPUTBUFFER_H_
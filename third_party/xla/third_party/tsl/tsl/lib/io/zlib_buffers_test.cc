@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/lib/io/random_inputstream.h"
+#include "tsl/lib/io/zlib_block_format.h"
+#include "tsl/lib/io/zlib_block_inputstream.h"
+#include "tsl/lib/io/zlib_block_outputbuffer.h"
 #include "tsl/lib/io/zlib_compression_options.h"
 #include "tsl/lib/io/zlib_inputstream.h"
 #include "tsl/lib/io/zlib_outputbuffer.h"
@@ -22,6 +25,7 @@ limitations under the License.
 #include "tsl/platform/errors.h"
 #include "tsl/platform/strcat.h"
 #include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
 
 namespace tsl {
 namespace io {
@@ -373,5 +377,115 @@ TEST(ZlibInputStream, TestSoftErrorOnDecompressGzip) {
   TestSoftErrorOnDecompress(CompressionOptions::GZIP());
 }
 
+void WriteBlockCompressedFile(Env* env, const string& fname, size_t block_size,
+                              const string& data) {
+  std::unique_ptr<WritableFile> file_writer;
+  TF_ASSERT_OK(env->NewWritableFile(fname, &file_writer));
+  ZlibBlockOutputBuffer out(file_writer.get(), block_size,
+                            CompressionOptions::GZIP());
+  // Appends that straddle block boundaries.
+  for (size_t pos = 0; pos < data.size(); pos += 333) {
+    TF_ASSERT_OK(out.Append(StringPiece(data).substr(pos, 333)));
+  }
+  TF_ASSERT_OK(out.Close());
+  TF_ASSERT_OK(file_writer->Close());
+}
+
+TEST(ZlibBlockBuffers, ReadsInParallel) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  thread::ThreadPool thread_pool(env, "inflate", 4);
+  for (auto file_size : NumCopies()) {
+    string data = GenTestString(file_size);
+    for (size_t block_size : {1, 100, 1000, 100000}) {
+      WriteBlockCompressedFile(env, fname, block_size, data);
+      std::unique_ptr<RandomAccessFile> file_reader;
+      TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+      for (auto* pool : {&thread_pool, static_cast<thread::ThreadPool*>(
+                                           nullptr)}) {
+        ZlibBlockInputStream in(
+            file_reader.get(), new RandomAccessInputStream(file_reader.get()),
+            CompressionOptions::GZIP(), pool, /*max_blocks_in_flight=*/3);
+        tstring result;
+        for (size_t pos = 0; pos < data.size(); pos += 777) {
+          const size_t n = std::min<size_t>(777, data.size() - pos);
+          TF_ASSERT_OK(in.ReadNBytes(n, &result));
+          EXPECT_EQ(result, data.substr(pos, n));
+          EXPECT_EQ(in.Tell(), pos + n);
+        }
+        EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &result)));
+
+        TF_ASSERT_OK(in.Reset());
+        TF_ASSERT_OK(in.SkipNBytes(data.size() / 2));
+        TF_ASSERT_OK(in.ReadNBytes(data.size() - data.size() / 2, &result));
+        EXPECT_EQ(result, data.substr(data.size() / 2));
+      }
+    }
+  }
+}
+
+TEST(ZlibBlockBuffers, ReadableAsGzip) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  string data = GenTestString(50);
+  WriteBlockCompressedFile(env, fname, 1000, data);
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  std::unique_ptr<RandomAccessInputStream> input_stream(
+      new RandomAccessInputStream(file_reader.get()));
+  ZlibInputStream in(input_stream.get(), 1000, 1000,
+                     CompressionOptions::GZIP());
+  tstring result;
+  TF_ASSERT_OK(in.ReadNBytes(data.size(), &result));
+  EXPECT_EQ(result, data);
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &result)));
+}
+
+TEST(ZlibBlockInputStream, FallsBackToStreaming) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  string data = GenTestString(50);
+  WriteCompressedFile(env, fname, 1000, 1000, CompressionOptions::GZIP(),
+                      data);
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  thread::ThreadPool thread_pool(env, "inflate", 4);
+  ZlibBlockInputStream in(
+      file_reader.get(), new RandomAccessInputStream(file_reader.get()),
+      CompressionOptions::GZIP(), &thread_pool, /*max_blocks_in_flight=*/3);
+  tstring result;
+  TF_ASSERT_OK(in.ReadNBytes(data.size(), &result));
+  EXPECT_EQ(result, data);
+  EXPECT_EQ(in.Tell(), data.size());
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &result)));
+}
+
+TEST(ZlibBlockInputStream, DetectsCorruptedBlocks) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  string data = GenTestString(50);
+  WriteBlockCompressedFile(env, fname, 1000, data);
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(env, fname, &contents));
+  // Corrupt the deflate data of the first block.
+  contents[kZlibBlockHeaderSize + 2] ^= 0x55;
+  TF_ASSERT_OK(WriteStringToFile(env, fname, contents));
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  thread::ThreadPool thread_pool(env, "inflate", 4);
+  ZlibBlockInputStream in(
+      file_reader.get(), new RandomAccessInputStream(file_reader.get()),
+      CompressionOptions::GZIP(), &thread_pool, /*max_blocks_in_flight=*/3);
+  tstring result;
+  EXPECT_TRUE(errors::IsDataLoss(in.ReadNBytes(data.size(), &result)));
+}
+
 }  // namespace io
 }  // namespace tsl
@@ -222,6 +222,13 @@ int NUMANumNodes() {
 void NUMASetThreadNodeAffinity(int node) {
 #ifdef TENSORFLOW_USE_NUMA
   if (HaveHWLocTopology()) {
+    if (node == kNUMANoAffinity) {
+      // Allow the thread to run on any processor of the machine.
+      hwloc_const_cpuset_t cpuset =
+          hwloc_topology_get_allowed_cpuset(hwloc_topology_handle);
+      hwloc_set_cpubind(hwloc_topology_handle, cpuset, HWLOC_CPUBIND_THREAD);
+      return;
+    }
     // Find the corresponding NUMA node topology object.
     hwloc_obj_t obj = GetHWLocTypeIndex(HWLOC_OBJ_NUMANODE, node);
     if (obj) {
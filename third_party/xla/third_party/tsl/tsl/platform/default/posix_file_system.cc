@@ -30,6 +30,7 @@ limitations under the License.
 #include <unistd.h>
 
 #include "tsl/platform/default/posix_file_system.h"
+#include "tsl/platform/default/posix_io_uring.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/file_system_helper.h"
@@ -45,7 +46,7 @@ using ::tsl::errors::IOError;
 // 128KB of copy buffer
 constexpr size_t kPosixCopyFileBufferSize = 128 * 1024;
 
-// pread() based random-access
+// pread() based random-access, with io_uring based asynchronous reads
 class PosixRandomAccessFile : public RandomAccessFile {
  private:
   string filename_;
@@ -97,6 +98,18 @@ class PosixRandomAccessFile : public RandomAccessFile {
     return s;
   }
 
+  // Served by io_uring where available, and by `Read` otherwise.
+  void ReadAsync(uint64 offset, size_t n, char* scratch,
+                 ReadCallback done) const override {
+    PosixIoUring* io_uring = PosixIoUring::Get();
+    if (io_uring == nullptr || n == 0) {
+      RandomAccessFile::ReadAsync(offset, n, scratch, std::move(done));
+      return;
+    }
+    ContinueReadAsync(io_uring, offset, n, scratch, /*bytes_read=*/0,
+                      std::move(done));
+  }
+
 #if defined(TF_CORD_SUPPORT)
   Status Read(uint64 offset, size_t n, absl::Cord* cord) const override {
     if (n == 0) {
@@ -124,6 +137,39 @@ class PosixRandomAccessFile : public RandomAccessFile {
     return s;
   }
 #endif
+
+ private:
+  // Reads `scratch[bytes_read..n-1]` through io_uring, resubmitting after
+  // short reads until all `n` bytes are read or EOF is reached.
+  void ContinueReadAsync(PosixIoUring* io_uring, uint64 offset, size_t n,
+                         char* scratch, size_t bytes_read,
+                         ReadCallback done) const {
+    // Some platforms throw EINVAL if asked to read more than fits in a 32-bit
+    // integer, see `Read`.
+    const size_t requested_read_length =
+        std::min<size_t>(n - bytes_read, INT32_MAX);
+    io_uring->SubmitRead(
+        fd_, offset + bytes_read, requested_read_length, scratch + bytes_read,
+        [this, io_uring, offset, n, scratch, bytes_read,
+         done = std::move(done)](int64_t result) mutable {
+          if (result == -EINTR || result == -EAGAIN) {
+            // Retry
+            ContinueReadAsync(io_uring, offset, n, scratch, bytes_read,
+                              std::move(done));
+          } else if (result < 0) {
+            done(IOError(filename_, -result), StringPiece(scratch, bytes_read));
+          } else if (result == 0) {
+            done(Status(absl::StatusCode::kOutOfRange,
+                        "Read less bytes than requested"),
+                 StringPiece(scratch, bytes_read));
+          } else if (bytes_read + result == n) {
+            done(OkStatus(), StringPiece(scratch, n));
+          } else {
+            ContinueReadAsync(io_uring, offset, n, scratch,
+                              bytes_read + result, std::move(done));
+          }
+        });
+  }
 };
 
 class PosixWritableFile : public WritableFile {
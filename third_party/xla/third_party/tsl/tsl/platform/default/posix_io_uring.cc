@@ -0,0 +1,355 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/platform/default/posix_io_uring.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define TSL_HAS_IO_URING 1
+#endif
+#endif
+#endif
+
+#include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
+
+namespace tsl {
+
+namespace {
+
+// Reads synchronously, for when a read cannot be queued on the ring.
+int64_t ReadWithPread(int fd, uint64 offset, size_t n, char* buf) {
+  ssize_t r;
+  do {
+    r = pread(fd, buf, n, static_cast<off_t>(offset));
+  } while (r < 0 && errno == EINTR);
+  return r < 0 ? -errno : r;
+}
+
+}  // namespace
+
+#if defined(TSL_HAS_IO_URING)
+
+namespace {
+
+// Number of entries of the submission ring. The kernel makes the completion
+// ring twice as large.
+constexpr unsigned kNumEntries = 256;
+
+int IoUringEnter(int fd, unsigned to_submit, unsigned min_complete,
+                 unsigned flags) {
+  return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+                 nullptr, 0);
+}
+
+}  // namespace
+
+// The memory-mapped submission and completion rings of an io_uring instance.
+struct PosixIoUring::Ring {
+  int fd = -1;
+  void* sq_ptr = MAP_FAILED;
+  size_t sq_size = 0;
+  void* cq_ptr = MAP_FAILED;
+  size_t cq_size = 0;
+  io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+  size_t sqes_size = 0;
+
+  unsigned* sq_head = nullptr;
+  unsigned* sq_tail = nullptr;
+  unsigned* sq_array = nullptr;
+  unsigned sq_mask = 0;
+  unsigned sq_entries = 0;
+
+  unsigned* cq_head = nullptr;
+  unsigned* cq_tail = nullptr;
+  io_uring_cqe* cqes = nullptr;
+  unsigned cq_mask = 0;
+  unsigned cq_entries = 0;
+
+  ~Ring() {
+    if (sqes != MAP_FAILED) munmap(sqes, sqes_size);
+    if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) munmap(cq_ptr, cq_size);
+    if (sq_ptr != MAP_FAILED) munmap(sq_ptr, sq_size);
+    if (fd >= 0) close(fd);
+  }
+
+  static Status Create(unsigned entries, std::unique_ptr<Ring>* result) {
+    auto ring = std::make_unique<Ring>();
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring->fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0) {
+      return errors::IOError("io_uring_setup", errno);
+    }
+    ring->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_size =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = false;
+#if defined(IORING_FEAT_SINGLE_MMAP)
+    single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+#endif
+    if (single_mmap) {
+      ring->sq_size = ring->cq_size = std::max(ring->sq_size, ring->cq_size);
+    }
+    ring->sq_ptr =
+        mmap(nullptr, ring->sq_size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ptr == MAP_FAILED) {
+      return errors::IOError("mmap of the io_uring submission ring", errno);
+    }
+    if (single_mmap) {
+      ring->cq_ptr = ring->sq_ptr;
+    } else {
+      ring->cq_ptr =
+          mmap(nullptr, ring->cq_size, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+      if (ring->cq_ptr == MAP_FAILED) {
+        return errors::IOError("mmap of the io_uring completion ring", errno);
+      }
+    }
+    ring->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    ring->sqes = static_cast<io_uring_sqe*>(
+        mmap(nullptr, ring->sqes_size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES));
+    if (ring->sqes == MAP_FAILED) {
+      return errors::IOError("mmap of the io_uring submission entries", errno);
+    }
+
+    char* sq = static_cast<char*>(ring->sq_ptr);
+    ring->sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    ring->sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    ring->sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    ring->sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    ring->sq_entries = params.sq_entries;
+
+    char* cq = static_cast<char*>(ring->cq_ptr);
+    ring->cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    ring->cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    ring->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    ring->cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    ring->cq_entries = params.cq_entries;
+
+    *result = std::move(ring);
+    return OkStatus();
+  }
+};
+
+struct PosixIoUring::Request {
+  iovec iov;
+  int fd;
+  uint64 offset;
+  ReadCallback done;
+};
+
+PosixIoUring* PosixIoUring::Get() {
+  static PosixIoUring* io_uring = []() -> PosixIoUring* {
+    if (getenv("TF_DISABLE_IO_URING") != nullptr) {
+      return nullptr;
+    }
+    std::unique_ptr<Ring> ring;
+    Status s = Ring::Create(kNumEntries, &ring);
+    if (!s.ok()) {
+      VLOG(1) << "io_uring is unavailable, asynchronous reads will use pread: "
+              << s;
+      return nullptr;
+    }
+    return new PosixIoUring(std::move(ring));
+  }();
+  return io_uring;
+}
+
+PosixIoUring::PosixIoUring(std::unique_ptr<Ring> ring)
+    : ring_(std::move(ring)) {
+  completion_thread_.reset(Env::Default()->StartThread(
+      ThreadOptions(), "tf_io_uring_completions",
+      [this]() { ReapCompletions(); }));
+}
+
+PosixIoUring::~PosixIoUring() = default;
+
+void PosixIoUring::SubmitRead(int fd, uint64 offset, size_t n, char* buf,
+                              ReadCallback done) {
+  bool queued = false;
+  bool submit = false;
+  {
+    mutex_lock l(mu_);
+    const unsigned tail = *ring_->sq_tail;
+    const unsigned head = __atomic_load_n(ring_->sq_head, __ATOMIC_ACQUIRE);
+    if (reap_error_ == 0 && in_flight_.size() < ring_->cq_entries &&
+        tail - head < ring_->sq_entries) {
+      auto* request = new Request{{buf, n}, fd, offset, std::move(done)};
+      const unsigned index = tail & ring_->sq_mask;
+      io_uring_sqe* sqe = &ring_->sqes[index];
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = IORING_OP_READV;
+      sqe->fd = fd;
+      sqe->off = offset;
+      sqe->addr = reinterpret_cast<uint64>(&request->iov);
+      sqe->len = 1;
+      sqe->user_data = reinterpret_cast<uint64>(request);
+      ring_->sq_array[index] = index;
+      __atomic_store_n(ring_->sq_tail, tail + 1, __ATOMIC_RELEASE);
+      in_flight_.insert(request);
+      queued = true;
+      submit = !submitting_;
+      submitting_ = true;
+    }
+  }
+  if (!queued) {
+    // The rings are full, or completions can no longer be reaped.
+    done(ReadWithPread(fd, offset, n, buf));
+    return;
+  }
+  if (submit) {
+    SubmitQueued();
+  }
+}
+
+void PosixIoUring::SubmitQueued() {
+  std::vector<Request*> rejected;
+  int error = 0;
+  while (true) {
+    unsigned to_submit;
+    {
+      mutex_lock l(mu_);
+      const unsigned tail = *ring_->sq_tail;
+      const unsigned head = __atomic_load_n(ring_->sq_head, __ATOMIC_ACQUIRE);
+      if (error == 0 && reap_error_ != 0) {
+        // Completions can no longer be reaped, so nothing more is submitted.
+        error = reap_error_;
+      }
+      if (error != 0 && head != tail) {
+        // The kernel did not take the remaining entries. No other thread
+        // submits, so they can be taken back from the ring. Those which the
+        // completion thread failed on exit are not served again.
+        for (unsigned i = head; i != tail; ++i) {
+          const io_uring_sqe& sqe =
+              ring_->sqes[ring_->sq_array[i & ring_->sq_mask]];
+          auto* request = reinterpret_cast<Request*>(sqe.user_data);
+          if (in_flight_.erase(request) > 0) {
+            rejected.push_back(request);
+          }
+        }
+        __atomic_store_n(ring_->sq_tail, head, __ATOMIC_RELEASE);
+      }
+      if (error != 0 || head == tail) {
+        submitting_ = false;
+        break;
+      }
+      to_submit = tail - head;
+    }
+    // Entries queued by other threads while this one submits are picked up
+    // by the next iteration.
+    const int ret = IoUringEnter(ring_->fd, to_submit, 0, 0);
+    if (ret < 0 && errno != EINTR) {
+      error = errno;
+    } else if (ret == 0) {
+      error = EAGAIN;
+    }
+  }
+  if (rejected.empty()) {
+    return;
+  }
+  LOG(WARNING) << "io_uring_enter failed to submit reads, reading them with "
+               << "pread instead: " << strerror(error);
+  for (Request* request : rejected) {
+    std::unique_ptr<Request> owned_request(request);
+    owned_request->done(ReadWithPread(
+        request->fd, request->offset, request->iov.iov_len,
+        static_cast<char*>(request->iov.iov_base)));
+  }
+}
+
+void PosixIoUring::ReapCompletions() {
+  std::vector<std::pair<Request*, int64_t>> completed;
+  while (true) {
+    const int ret = IoUringEnter(ring_->fd, 0, 1, IORING_ENTER_GETEVENTS);
+    const int error = ret < 0 && errno != EINTR ? errno : 0;
+    unsigned head = *ring_->cq_head;
+    const unsigned tail = __atomic_load_n(ring_->cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+      const io_uring_cqe& cqe = ring_->cqes[head & ring_->cq_mask];
+      completed.emplace_back(reinterpret_cast<Request*>(cqe.user_data),
+                             cqe.res);
+    }
+    __atomic_store_n(ring_->cq_head, head, __ATOMIC_RELEASE);
+    {
+      mutex_lock l(mu_);
+      for (const auto& completion : completed) {
+        in_flight_.erase(completion.first);
+      }
+      if (error != 0) {
+        // Retrying would spin on the same error, and the outstanding reads
+        // would never complete: fail them, and serve later reads with
+        // `pread`. Entries still queued are taken back by the submitting
+        // thread, if any.
+        reap_error_ = error;
+        for (Request* request : in_flight_) {
+          completed.emplace_back(request, -error);
+        }
+        in_flight_.clear();
+      }
+    }
+    for (const auto& [request, result] : completed) {
+      std::unique_ptr<Request> owned_request(request);
+      owned_request->done(result);
+    }
+    completed.clear();
+    if (error != 0) {
+      LOG(ERROR) << "io_uring_enter failed to wait for completions, reading "
+                 << "with pread from now on: " << strerror(error);
+      return;
+    }
+  }
+}
+
+#else  // defined(TSL_HAS_IO_URING)
+
+struct PosixIoUring::Ring {};
+struct PosixIoUring::Request {};
+
+PosixIoUring* PosixIoUring::Get() { return nullptr; }
+
+PosixIoUring::PosixIoUring(std::unique_ptr<Ring> ring)
+    : ring_(std::move(ring)) {}
+
+PosixIoUring::~PosixIoUring() = default;
+
+void PosixIoUring::SubmitRead(int fd, uint64 offset, size_t n, char* buf,
+                              ReadCallback done) {
+  done(ReadWithPread(fd, offset, n, buf));
+}
+
+void PosixIoUring::SubmitQueued() {}
+
+void PosixIoUring::ReapCompletions() {}
+
+#endif  // defined(TSL_HAS_IO_URING)
+
+}  // namespace tsl
@@ -0,0 +1,96 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_PLATFORM_DEFAULT_POSIX_IO_URING_H_
+#define TENSORFLOW_TSL_PLATFORM_DEFAULT_POSIX_IO_URING_H_
+
+#include <stddef.h>
+
+#include <functional>
+#include <memory>
+#include <unordered_set>
+
+#include "tsl/platform/env.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/types.h"
+
+namespace tsl {
+
+// A process-wide io_uring instance that serves asynchronous reads of posix
+// files.
+//
+// Reads are queued on the submission ring and submitted by one thread at a
+// time, which flushes all queued entries with a single `io_uring_enter`, so
+// reads issued concurrently by several threads are submitted in batches.
+// Entries the kernel refuses are taken back and served with `pread`.
+// Completions are reaped by a dedicated thread, which also runs the
+// callbacks. If waiting for completions fails for a reason other than EINTR,
+// the outstanding reads fail with that error, the thread exits, and all
+// later reads are served with `pread`.
+class PosixIoUring {
+ public:
+  // Called with the number of bytes read, which may be fewer than requested,
+  // or with a negated errno if the read failed.
+  typedef std::function<void(int64_t)> ReadCallback;
+
+  // Returns the shared instance, or nullptr if io_uring is unavailable, e.g.
+  // because the kernel is too old, the syscalls are blocked, or it was
+  // disabled by setting the `TF_DISABLE_IO_URING` environment variable.
+  // The instance is never destroyed.
+  static PosixIoUring* Get();
+
+  // Reads up to `n` bytes at `offset` of `fd` into `buf`, calling `done` from
+  // the completion thread. If the rings are full, the read is instead served
+  // with `pread` and `done` is called before returning. If the kernel refuses
+  // the submission, the read is served with `pread` by the submitting thread.
+  void SubmitRead(int fd, uint64 offset, size_t n, char* buf,
+                  ReadCallback done);
+
+ private:
+  struct Ring;
+  struct Request;
+
+  explicit PosixIoUring(std::unique_ptr<Ring> ring);
+  ~PosixIoUring();
+
+  // Submits the queued entries, including those queued by other threads in
+  // the meantime, until none are left. Reads that cannot be submitted are
+  // served with `pread`.
+  void SubmitQueued();
+
+  // Waits for completions and runs their callbacks. Returns only if waiting
+  // fails, after failing the outstanding reads.
+  void ReapCompletions();
+
+  mutex mu_;
+  const std::unique_ptr<Ring> ring_;
+  // Queued or submitted reads whose completion has not been reaped. Their
+  // number is bounded by the size of the completion ring, so that completions
+  // are never dropped.
+  std::unordered_set<Request*> in_flight_ TF_GUARDED_BY(mu_);
+  // The errno which made the completion thread exit, or 0 while it runs.
+  int reap_error_ TF_GUARDED_BY(mu_) = 0;
+  // Whether a thread is in `SubmitQueued`.
+  bool submitting_ TF_GUARDED_BY(mu_) = false;
+  std::unique_ptr<Thread> completion_thread_;
+
+  PosixIoUring(const PosixIoUring&) = delete;
+  void operator=(const PosixIoUring&) = delete;
+};
+
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_PLATFORM_DEFAULT_POSIX_IO_URING_H_
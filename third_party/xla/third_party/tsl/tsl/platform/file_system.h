@@ -771,6 +771,27 @@ class RandomAccessFile {
   virtual tsl::Status Read(uint64 offset, size_t n, StringPiece* result,
                            char* scratch) const = 0;
 
+  /// \brief Callback of `ReadAsync`, called with the status of the read and
+  /// the data that was read, following the same contract as `Read`.
+  typedef std::function<void(const tsl::Status&, StringPiece)> ReadCallback;
+
+  /// \brief Asynchronously reads up to `n` bytes from the file starting at
+  /// `offset` into `scratch[0..n-1]`, then calls `done`.
+  ///
+  /// `scratch[0..n-1]` and the file must be live until `done` is called.
+  /// `done` may be called before `ReadAsync` returns, or from an internal I/O
+  /// thread, so it should not block.
+  ///
+  /// The default implementation calls `Read` synchronously.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual void ReadAsync(uint64 offset, size_t n, char* scratch,
+                         ReadCallback done) const {
+    StringPiece result;
+    tsl::Status s = Read(offset, n, &result, scratch);
+    done(s, result);
+  }
+
 #if defined(TF_CORD_SUPPORT)
   /// \brief Read up to `n` bytes from the file starting at `offset`.
   virtual tsl::Status Read(uint64 offset, size_t n, absl::Cord* cord) const {
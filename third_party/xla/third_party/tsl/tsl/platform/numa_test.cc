@@ -54,6 +54,8 @@ TEST(Numa, SetNodeAffinity) {
       int affinity_node = port::NUMAGetThreadNodeAffinity();
       EXPECT_EQ(affinity_node, request_node);
     }
+    port::NUMASetThreadNodeAffinity(port::kNUMANoAffinity);
+    EXPECT_EQ(-1, port::NUMAGetThreadNodeAffinity());
   }
 }
 